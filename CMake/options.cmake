@@ -87,6 +87,9 @@ option(ENABLE_MANDELBROT "Enable Mandelbrot AMR miniapp" ON)
 option(ENABLE_VORTEX "Enable Vortex miniapp (experimental)" OFF)
 option(ENABLE_CONDUITTEST "Enable Conduit miniapp (experimental)" OFF)
 option(ENABLE_KRIPKE "Enable Kripke miniapp (experimental)" OFF)
+cmake_dependent_option(ENABLE_BENCH
+  "Enable the sensei_bench synthetic workload benchmark" ON
+  "ENABLE_SENSEI;ENABLE_OPTS;ENABLE_PROFILER" OFF)
 option(SENSEI_USE_EXTERNAL_pugixml "Use external pugixml library" OFF)
 
 message(STATUS "ENABLE_SENSEI=${ENABLE_SENSEI}")
@@ -112,6 +115,7 @@ message(STATUS "ENABLE_OPTS=${ENABLE_OPTS}")
 message(STATUS "ENABLE_OSCILLATORS=${ENABLE_OSCILLATORS}")
 message(STATUS "ENABLE_CONDUITTEST=${ENABLE_CONDUITTEST}")
 message(STATUS "ENABLE_KRIPKE=${ENABLE_KRIPKE}")
+message(STATUS "ENABLE_BENCH=${ENABLE_BENCH}")
 message(STATUS "SENSEI_USE_EXTERNAL_pugixml=${SENSEI_USE_EXTERNAL_pugixml}")
 
 if (ENABLE_ADIOS1 AND ENABLE_ADIOS2)
@@ -0,0 +1,807 @@
+#include "SyntheticDataAdaptor.h"
+#include "SVTKUtils.h"
+#include "Profiler.h"
+#include "Error.h"
+
+#include <svtkAMRBox.h>
+#include <svtkCellArray.h>
+#include <svtkCellData.h>
+#include <svtkCellType.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkObjectFactory.h>
+#include <svtkOverlappingAMR.h>
+#include <svtkPointData.h>
+#include <svtkPoints.h>
+#include <svtkPolyData.h>
+#include <svtkRectilinearGrid.h>
+#include <svtkSmartPointer.h>
+#include <svtkStructuredGrid.h>
+#include <svtkUniformGrid.h>
+#include <svtkUnsignedCharArray.h>
+#include <svtkUnstructuredGrid.h>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace
+{
+// a local block and the lattice its array tuples are laid out on. tuple
+// t corresponds to lattice index (i,j,k) with i varying fastest.
+struct BlockInfo
+{
+  svtkSmartPointer<svtkDataSet> Block;
+  int Owned[6];       // owned cells [lo, hi) in the block's level
+  int Shape[3];       // global number of cells in the block's level
+  int Lattice[6];     // lattice [lo, hi) of the array tuples
+  double X0[3];       // position of lattice index 0
+  double Dx[3];       // lattice spacing
+  bool Refined;       // set if all cells are covered by a finer level
+};
+
+// **************************************************************************
+svtkSmartPointer<svtkDataSet> newBlock(int meshType, const int *lo,
+  const int *hi, const double *dx)
+{
+  // the number of points in each direction
+  int np[3] = {hi[0] - lo[0] + 1, hi[1] - lo[1] + 1, hi[2] - lo[2] + 1};
+  long nPts = long(np[0])*np[1]*np[2];
+
+  switch (meshType)
+    {
+    case SyntheticDataAdaptor::MESH_IMAGE:
+    case SyntheticDataAdaptor::MESH_AMR:
+      {
+      svtkSmartPointer<svtkImageData> im;
+      if (meshType == SyntheticDataAdaptor::MESH_AMR)
+        im = svtkSmartPointer<svtkUniformGrid>::New();
+      else
+        im = svtkSmartPointer<svtkImageData>::New();
+      im->SetOrigin(0.0, 0.0, 0.0);
+      im->SetSpacing(dx[0], dx[1], dx[2]);
+      im->SetExtent(lo[0], hi[0], lo[1], hi[1], lo[2], hi[2]);
+      return im;
+      }
+      break;
+
+    case SyntheticDataAdaptor::MESH_RECTILINEAR:
+      {
+      svtkSmartPointer<svtkRectilinearGrid> rg =
+        svtkSmartPointer<svtkRectilinearGrid>::New();
+
+      rg->SetExtent(lo[0], hi[0], lo[1], hi[1], lo[2], hi[2]);
+
+      svtkDoubleArray *coords[3];
+      for (int d = 0; d < 3; ++d)
+        {
+        coords[d] = svtkDoubleArray::New();
+        coords[d]->SetNumberOfTuples(np[d]);
+        double *pc = coords[d]->GetPointer(0);
+        for (int i = 0; i < np[d]; ++i)
+          pc[i] = (lo[d] + i)*dx[d];
+        }
+
+      rg->SetXCoordinates(coords[0]);
+      rg->SetYCoordinates(coords[1]);
+      rg->SetZCoordinates(coords[2]);
+
+      for (int d = 0; d < 3; ++d)
+        coords[d]->Delete();
+
+      return rg;
+      }
+      break;
+
+    case SyntheticDataAdaptor::MESH_STRUCTURED:
+    case SyntheticDataAdaptor::MESH_UNSTRUCTURED:
+      {
+      // explicit point coordinates, shared by both
+      svtkDoubleArray *xyz = svtkDoubleArray::New();
+      xyz->SetNumberOfComponents(3);
+      xyz->SetNumberOfTuples(nPts);
+      double *pxyz = xyz->GetPointer(0);
+      for (int k = 0; k < np[2]; ++k)
+        for (int j = 0; j < np[1]; ++j)
+          for (int i = 0; i < np[0]; ++i)
+            {
+            pxyz[0] = (lo[0] + i)*dx[0];
+            pxyz[1] = (lo[1] + j)*dx[1];
+            pxyz[2] = (lo[2] + k)*dx[2];
+            pxyz += 3;
+            }
+
+      svtkPoints *pts = svtkPoints::New();
+      pts->SetData(xyz);
+      xyz->Delete();
+
+      if (meshType == SyntheticDataAdaptor::MESH_STRUCTURED)
+        {
+        svtkSmartPointer<svtkStructuredGrid> sg =
+          svtkSmartPointer<svtkStructuredGrid>::New();
+        sg->SetExtent(lo[0], hi[0], lo[1], hi[1], lo[2], hi[2]);
+        sg->SetPoints(pts);
+        pts->Delete();
+        return sg;
+        }
+
+      // hexahedra, in the same order as the cells of a structured mesh
+      svtkSmartPointer<svtkUnstructuredGrid> ug =
+        svtkSmartPointer<svtkUnstructuredGrid>::New();
+
+      ug->SetPoints(pts);
+      pts->Delete();
+
+      int nc[3] = {np[0] - 1, np[1] - 1, np[2] - 1};
+      long nCells = long(nc[0])*nc[1]*nc[2];
+      long npxy = long(np[0])*np[1];
+
+      ug->Allocate(nCells);
+      for (int k = 0; k < nc[2]; ++k)
+        for (int j = 0; j < nc[1]; ++j)
+          for (int i = 0; i < nc[0]; ++i)
+            {
+            svtkIdType p0 = i + j*np[0] + k*npxy;
+            svtkIdType ids[8] = {p0, p0 + 1, p0 + 1 + np[0], p0 + np[0],
+              p0 + npxy, p0 + 1 + npxy, p0 + 1 + np[0] + npxy, p0 + np[0] + npxy};
+            ug->InsertNextCell(SVTK_HEXAHEDRON, 8, ids);
+            }
+
+      return ug;
+      }
+      break;
+
+    case SyntheticDataAdaptor::MESH_POLYDATA:
+      {
+      // one vertex at each cell center
+      int nc[3] = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]};
+      long nCells = long(nc[0])*nc[1]*nc[2];
+
+      svtkDoubleArray *xyz = svtkDoubleArray::New();
+      xyz->SetNumberOfComponents(3);
+      xyz->SetNumberOfTuples(nCells);
+      double *pxyz = xyz->GetPointer(0);
+      for (int k = 0; k < nc[2]; ++k)
+        for (int j = 0; j < nc[1]; ++j)
+          for (int i = 0; i < nc[0]; ++i)
+            {
+            pxyz[0] = (lo[0] + i + 0.5)*dx[0];
+            pxyz[1] = (lo[1] + j + 0.5)*dx[1];
+            pxyz[2] = (lo[2] + k + 0.5)*dx[2];
+            pxyz += 3;
+            }
+
+      svtkPoints *pts = svtkPoints::New();
+      pts->SetData(xyz);
+      xyz->Delete();
+
+      svtkCellArray *verts = svtkCellArray::New();
+      verts->AllocateExact(nCells, nCells);
+      for (svtkIdType i = 0; i < nCells; ++i)
+        verts->InsertNextCell(1, &i);
+
+      svtkSmartPointer<svtkPolyData> pd = svtkSmartPointer<svtkPolyData>::New();
+      pd->SetPoints(pts);
+      pd->SetVerts(verts);
+
+      pts->Delete();
+      verts->Delete();
+
+      return pd;
+      }
+      break;
+    }
+
+  return nullptr;
+}
+
+// **************************************************************************
+void initializeLattice(BlockInfo &info, int meshType, int association,
+  const int *lo, const int *hi)
+{
+  // polydata vertices sit at cell centers, hence both point and cell
+  // arrays are on the cell lattice
+  bool cellLattice = (association == svtkDataObject::CELL) ||
+    (meshType == SyntheticDataAdaptor::MESH_POLYDATA);
+
+  for (int d = 0; d < 3; ++d)
+    {
+    info.Lattice[2*d] = lo[d];
+    info.Lattice[2*d+1] = cellLattice ? hi[d] : hi[d] + 1;
+    info.X0[d] = cellLattice ? (lo[d] + 0.5)*info.Dx[d] : lo[d]*info.Dx[d];
+    }
+}
+
+// **************************************************************************
+void addGhostArrays(BlockInfo &info, int meshType, const int *lo,
+  const int *hi)
+{
+  svtkDataSet *ds = info.Block;
+
+  // cells
+  int nc[3] = {hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]};
+  long nCells = long(nc[0])*nc[1]*nc[2];
+
+  svtkUnsignedCharArray *cg = svtkUnsignedCharArray::New();
+  cg->SetName("svtkGhostType");
+  cg->SetNumberOfTuples(nCells);
+  unsigned char *pcg = cg->GetPointer(0);
+  for (int k = 0; k < nc[2]; ++k)
+    for (int j = 0; j < nc[1]; ++j)
+      for (int i = 0; i < nc[0]; ++i)
+        {
+        int q[3] = {lo[0] + i, lo[1] + j, lo[2] + k};
+        bool owned = true;
+        for (int d = 0; owned && (d < 3); ++d)
+          owned = (q[d] >= info.Owned[2*d]) && (q[d] < info.Owned[2*d+1]);
+        unsigned char g = owned ? 0 : svtkDataSetAttributes::DUPLICATECELL;
+        if (info.Refined)
+          g |= svtkDataSetAttributes::REFINEDCELL;
+        *pcg = g;
+        ++pcg;
+        }
+
+  ds->GetCellData()->AddArray(cg);
+
+  // points. for polydata the points are the cell centers
+  if (meshType == SyntheticDataAdaptor::MESH_POLYDATA)
+    {
+    ds->GetPointData()->AddArray(cg);
+    cg->Delete();
+    return;
+    }
+
+  cg->Delete();
+
+  int np[3] = {nc[0] + 1, nc[1] + 1, nc[2] + 1};
+  long nPts = long(np[0])*np[1]*np[2];
+
+  svtkUnsignedCharArray *pg = svtkUnsignedCharArray::New();
+  pg->SetName("svtkGhostType");
+  pg->SetNumberOfTuples(nPts);
+  unsigned char *ppg = pg->GetPointer(0);
+  for (int k = 0; k < np[2]; ++k)
+    for (int j = 0; j < np[1]; ++j)
+      for (int i = 0; i < np[0]; ++i)
+        {
+        // a point is owned by the block owning the cell to its upper
+        // right, except on the upper boundary of the domain
+        int q[3] = {lo[0] + i, lo[1] + j, lo[2] + k};
+        bool owned = true;
+        for (int d = 0; owned && (d < 3); ++d)
+          owned = ((q[d] >= info.Owned[2*d]) && (q[d] < info.Owned[2*d+1])) ||
+            ((q[d] == info.Owned[2*d+1]) && (q[d] == info.Shape[d]));
+        *ppg = owned ? 0 : svtkDataSetAttributes::DUPLICATEPOINT;
+        ++ppg;
+        }
+
+  ds->GetPointData()->AddArray(pg);
+  pg->Delete();
+}
+
+// **************************************************************************
+long getGeometryBytes(svtkDataObject *dobj)
+{
+  long nBytes = 0;
+
+  svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(dobj);
+  if (!cd)
+    {
+    svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj);
+    if (ds)
+      {
+      nBytes = long(ds->GetActualMemorySize()) -
+        long(ds->GetPointData()->GetActualMemorySize()) -
+        long(ds->GetCellData()->GetActualMemorySize());
+      nBytes = std::max(0l, nBytes)*1024;
+      }
+    return nBytes;
+    }
+
+  svtkCompositeDataIterator *it = cd->NewIterator();
+  it->SetSkipEmptyNodes(1);
+  for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
+    nBytes += getGeometryBytes(it->GetCurrentDataObject());
+  it->Delete();
+
+  return nBytes;
+}
+}
+
+struct SyntheticDataAdaptor::InternalsType
+{
+  InternalsType() : MeshType(MESH_IMAGE), Association(svtkDataObject::CELL),
+    NumberOfArrays(0), NumberOfGhosts(0), BytesMoved(0) {}
+
+  int MeshType;
+  int Association;
+  int NumberOfArrays;
+  int NumberOfGhosts;
+  long BytesMoved;
+  svtkSmartPointer<svtkDataObject> Mesh;
+  std::vector<BlockInfo> Blocks;
+};
+
+//-----------------------------------------------------------------------------
+senseiNewMacro(SyntheticDataAdaptor);
+
+//-----------------------------------------------------------------------------
+SyntheticDataAdaptor::SyntheticDataAdaptor() :
+  Internals(new SyntheticDataAdaptor::InternalsType)
+{
+}
+
+//-----------------------------------------------------------------------------
+SyntheticDataAdaptor::~SyntheticDataAdaptor()
+{
+  delete this->Internals;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::GetMeshType(const std::string &name, int &type)
+{
+  const char *names[] = {"image", "rectilinear", "structured",
+    "unstructured", "polydata", "amr"};
+
+  for (int i = 0; i < 6; ++i)
+    {
+    if (name == names[i])
+      {
+      type = i;
+      return 0;
+      }
+    }
+
+  SENSEI_ERROR("Invalid mesh type \"" << name << "\". Use one of image,"
+    " rectilinear, structured, unstructured, polydata, or amr")
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::GetDistribution(const std::string &name, int &dist)
+{
+  const char *names[] = {"block", "cyclic", "random"};
+
+  for (int i = 0; i < 3; ++i)
+    {
+    if (name == names[i])
+      {
+      dist = i;
+      return 0;
+      }
+    }
+
+  SENSEI_ERROR("Invalid block distribution \"" << name << "\". Use one of"
+    " block, cyclic, or random")
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::Initialize(int meshType, const int shape[3],
+  int nBlocks, int distribution, int nArrays, int association, int nGhosts,
+  unsigned int seed)
+{
+  sensei::TimeEvent<128> event("SyntheticDataAdaptor::Initialize");
+
+  InternalsType &internals = *this->Internals;
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  if (nBlocks < nRanks)
+    {
+    SENSEI_ERROR("Every rank must have a block. " << nBlocks
+      << " blocks is too few for " << nRanks << " ranks")
+    return -1;
+    }
+
+  if ((association != svtkDataObject::POINT) &&
+    (association != svtkDataObject::CELL))
+    {
+    SENSEI_ERROR("Invalid association " << association)
+    return -1;
+    }
+
+  // split the domain into a grid of blocks. directions without cells
+  // to split are not decomposed
+  int dims[3] = {0, 0, 0};
+  for (int d = 0; d < 3; ++d)
+    {
+    if (shape[d] < 1)
+      {
+      SENSEI_ERROR("Invalid shape " << shape[0] << ", "
+        << shape[1] << ", " << shape[2])
+      return -1;
+      }
+    if (shape[d] == 1)
+      dims[d] = 1;
+    }
+
+  MPI_Dims_create(nBlocks, 3, dims);
+
+  for (int d = 0; d < 3; ++d)
+    {
+    if (dims[d] > shape[d])
+      {
+      SENSEI_ERROR("Can't split " << shape[d] << " cells into "
+        << dims[d] << " blocks in direction " << d)
+      return -1;
+      }
+    }
+
+  // assign blocks to ranks
+  std::vector<int> owner(nBlocks);
+  if (distribution == DIST_CYCLIC)
+    {
+    for (int b = 0; b < nBlocks; ++b)
+      owner[b] = b % nRanks;
+    }
+  else
+    {
+    std::vector<int> ids(nBlocks);
+    std::iota(ids.begin(), ids.end(), 0);
+
+    if (distribution == DIST_RANDOM)
+      {
+      std::mt19937 gen(seed);
+      std::shuffle(ids.begin(), ids.end(), gen);
+      }
+
+    for (int b = 0; b < nBlocks; ++b)
+      owner[ids[b]] = long(b)*nRanks/nBlocks;
+    }
+
+  internals.MeshType = meshType;
+  internals.Association = association;
+  internals.NumberOfArrays = nArrays;
+  internals.NumberOfGhosts = meshType == MESH_AMR ? 0 : nGhosts;
+  internals.Blocks.clear();
+
+  // generate the local blocks
+  svtkSmartPointer<svtkMultiBlockDataSet> mb;
+  svtkSmartPointer<svtkOverlappingAMR> amr;
+
+  int nLevels = 1;
+  if (meshType == MESH_AMR)
+    {
+    nLevels = 2;
+    int nBlocksPerLevel[2] = {nBlocks, (nBlocks + 1)/2};
+    double origin[3] = {0.0, 0.0, 0.0};
+
+    amr = svtkSmartPointer<svtkOverlappingAMR>::New();
+    amr->Initialize(2, nBlocksPerLevel);
+    amr->SetOrigin(origin);
+    amr->SetRefinementRatio(0, 2);
+    amr->SetRefinementRatio(1, 2);
+
+    internals.Mesh = amr;
+    }
+  else
+    {
+    mb = svtkSmartPointer<svtkMultiBlockDataSet>::New();
+    mb->SetNumberOfBlocks(nBlocks);
+
+    internals.Mesh = mb;
+    }
+
+  for (int level = 0; level < nLevels; ++level)
+    {
+    int ref = level ? 2 : 1;
+
+    BlockInfo info;
+    for (int d = 0; d < 3; ++d)
+      {
+      info.Shape[d] = ref*shape[d];
+      info.Dx[d] = 1.0/info.Shape[d];
+      }
+
+    if (amr)
+      amr->SetSpacing(level, info.Dx);
+
+    for (int b = 0; b < nBlocks; ++b)
+      {
+      // on the fine level only every other block is present
+      if (level && (b % 2))
+        continue;
+
+      int bid[3] = {b % dims[0], (b / dims[0]) % dims[1],
+        b / (dims[0]*dims[1])};
+
+      int lo[3];
+      int hi[3];
+      for (int d = 0; d < 3; ++d)
+        {
+        info.Owned[2*d] = ref*(long(shape[d])*bid[d]/dims[d]);
+        info.Owned[2*d+1] = ref*(long(shape[d])*(bid[d] + 1)/dims[d]);
+
+        lo[d] = std::max(0, info.Owned[2*d] - internals.NumberOfGhosts);
+        hi[d] = std::min(info.Shape[d], info.Owned[2*d+1] + internals.NumberOfGhosts);
+        }
+
+      int levelId = level ? b/2 : b;
+
+      if (amr)
+        {
+        int boxHi[3] = {hi[0] - 1, hi[1] - 1, hi[2] - 1};
+        amr->SetAMRBox(level, levelId, svtkAMRBox(lo, boxHi));
+        amr->SetAMRBlockSourceIndex(level, levelId, b);
+        }
+
+      if (owner[b] != rank)
+        continue;
+
+      info.Block = newBlock(meshType, lo, hi, info.Dx);
+      info.Refined = amr && !level && !(b % 2);
+
+      initializeLattice(info, meshType, association, lo, hi);
+
+      svtkDataSetAttributes *atts = association == svtkDataObject::CELL ?
+        static_cast<svtkDataSetAttributes*>(info.Block->GetCellData()) :
+        static_cast<svtkDataSetAttributes*>(info.Block->GetPointData());
+
+      long nTups = 1;
+      for (int d = 0; d < 3; ++d)
+        nTups *= info.Lattice[2*d+1] - info.Lattice[2*d];
+
+      for (int i = 0; i < nArrays; ++i)
+        {
+        svtkDoubleArray *da = svtkDoubleArray::New();
+        da->SetName(("array_" + std::to_string(i)).c_str());
+        da->SetNumberOfTuples(nTups);
+        atts->AddArray(da);
+        da->Delete();
+        }
+
+      if (internals.NumberOfGhosts || amr)
+        addGhostArrays(info, meshType, lo, hi);
+
+      if (amr)
+        amr->SetDataSet(level, levelId,
+          static_cast<svtkUniformGrid*>(info.Block.GetPointer()));
+      else
+        mb->SetBlock(b, info.Block);
+
+      internals.Blocks.push_back(info);
+      }
+    }
+
+  this->SetDataObject("mesh", internals.Mesh);
+
+  return this->Update(0, 0.0);
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::Update(long step, double time)
+{
+  sensei::TimeEvent<128> event("SyntheticDataAdaptor::Update");
+
+  InternalsType &internals = *this->Internals;
+
+  const double twoPi = 2.0*M_PI;
+
+  int nBlocks = internals.Blocks.size();
+  for (int b = 0; b < nBlocks; ++b)
+    {
+    BlockInfo &info = internals.Blocks[b];
+
+    svtkDataSetAttributes *atts = internals.Association == svtkDataObject::CELL ?
+      static_cast<svtkDataSetAttributes*>(info.Block->GetCellData()) :
+      static_cast<svtkDataSetAttributes*>(info.Block->GetPointData());
+
+    int n[3] = {info.Lattice[1] - info.Lattice[0],
+      info.Lattice[3] - info.Lattice[2], info.Lattice[5] - info.Lattice[4]};
+
+    // separable, so only the x factor varies with the array and time
+    std::vector<double> fy(n[1]);
+    for (int j = 0; j < n[1]; ++j)
+      fy[j] = cos(twoPi*(info.X0[1] + j*info.Dx[1]));
+
+    std::vector<double> fz(n[2]);
+    for (int k = 0; k < n[2]; ++k)
+      fz[k] = cos(twoPi*(info.X0[2] + k*info.Dx[2]));
+
+    std::vector<double> fx(n[0]);
+
+    for (int a = 0; a < internals.NumberOfArrays; ++a)
+      {
+      svtkDoubleArray *da = static_cast<svtkDoubleArray*>(
+        atts->GetArray(("array_" + std::to_string(a)).c_str()));
+
+      for (int i = 0; i < n[0]; ++i)
+        fx[i] = sin(twoPi*(info.X0[0] + i*info.Dx[0] + 0.1*a + 0.05*time));
+
+      double *pda = da->GetPointer(0);
+      for (int k = 0; k < n[2]; ++k)
+        for (int j = 0; j < n[1]; ++j)
+          {
+          double fyz = fy[j]*fz[k];
+          for (int i = 0; i < n[0]; ++i)
+            pda[i] = fx[i]*fyz + a;
+          pda += n[0];
+          }
+
+      da->Modified();
+      }
+    }
+
+  this->SetDataTimeStep(step);
+  this->SetDataTime(time);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void SyntheticDataAdaptor::GetLocalSize(long &nBlocks, long &nCells)
+{
+  nBlocks = this->Internals->Blocks.size();
+  nCells = 0;
+  for (long b = 0; b < nBlocks; ++b)
+    nCells += this->Internals->Blocks[b].Block->GetNumberOfCells();
+}
+
+//-----------------------------------------------------------------------------
+long SyntheticDataAdaptor::GetBytesMoved()
+{
+  return this->Internals->BytesMoved;
+}
+
+//-----------------------------------------------------------------------------
+void SyntheticDataAdaptor::ResetBytesMoved()
+{
+  this->Internals->BytesMoved = 0;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::GetMesh(const std::string &meshName,
+  bool structureOnly, svtkDataObject *&mesh)
+{
+  if (this->sensei::SVTKDataAdaptor::GetMesh(meshName, structureOnly, mesh))
+    return -1;
+
+  if (!structureOnly)
+    this->Internals->BytesMoved += getGeometryBytes(mesh);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::AddArray(svtkDataObject* mesh,
+  const std::string &meshName, int association, const std::string &arrayName)
+{
+  if (this->sensei::SVTKDataAdaptor::AddArray(mesh, meshName,
+    association, arrayName))
+    return -1;
+
+  this->CountArrayBytes(association, arrayName.c_str());
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::AddGhostNodesArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  if (this->sensei::SVTKDataAdaptor::AddGhostNodesArray(mesh, meshName))
+    return -1;
+
+  this->CountArrayBytes(svtkDataObject::POINT, "svtkGhostType");
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::AddGhostCellsArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  if (this->sensei::SVTKDataAdaptor::AddGhostCellsArray(mesh, meshName))
+    return -1;
+
+  this->CountArrayBytes(svtkDataObject::CELL, "svtkGhostType");
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::GetMeshBlock(const std::string &meshName,
+  long blockId, bool structureOnly, svtkDataObject *&block)
+{
+  if (this->sensei::SVTKDataAdaptor::GetMeshBlock(meshName,
+    blockId, structureOnly, block))
+    return -1;
+
+  if (!structureOnly)
+    this->Internals->BytesMoved += getGeometryBytes(block);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::AddArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association,
+  const std::string &arrayName)
+{
+  if (this->sensei::SVTKDataAdaptor::AddArrayToBlock(block, meshName,
+    blockId, association, arrayName))
+    return -1;
+
+  this->CountBlockArrayBytes(block, association, arrayName.c_str());
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::AddGhostNodesArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  if (this->sensei::SVTKDataAdaptor::AddGhostNodesArrayToBlock(block,
+    meshName, blockId))
+    return -1;
+
+  this->CountBlockArrayBytes(block, svtkDataObject::POINT, "svtkGhostType");
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int SyntheticDataAdaptor::AddGhostCellsArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  if (this->sensei::SVTKDataAdaptor::AddGhostCellsArrayToBlock(block,
+    meshName, blockId))
+    return -1;
+
+  this->CountBlockArrayBytes(block, svtkDataObject::CELL, "svtkGhostType");
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void SyntheticDataAdaptor::CountBlockArrayBytes(svtkDataObject *block,
+  int association, const char *arrayName)
+{
+  svtkDataSet *ds = dynamic_cast<svtkDataSet*>(block);
+  if (!ds)
+    return;
+
+  svtkDataSetAttributes *atts = association == svtkDataObject::CELL ?
+    static_cast<svtkDataSetAttributes*>(ds->GetCellData()) :
+    static_cast<svtkDataSetAttributes*>(ds->GetPointData());
+
+  svtkDataArray *da = atts->GetArray(arrayName);
+  if (da)
+    this->Internals->BytesMoved += long(da->GetNumberOfTuples())*
+      da->GetNumberOfComponents()*da->GetDataTypeSize();
+}
+
+//-----------------------------------------------------------------------------
+void SyntheticDataAdaptor::CountArrayBytes(int association,
+  const char *arrayName)
+{
+  InternalsType &internals = *this->Internals;
+
+  long nBlocks = internals.Blocks.size();
+  for (long b = 0; b < nBlocks; ++b)
+    {
+    svtkDataSet *ds = internals.Blocks[b].Block;
+
+    svtkDataSetAttributes *atts = association == svtkDataObject::CELL ?
+      static_cast<svtkDataSetAttributes*>(ds->GetCellData()) :
+      static_cast<svtkDataSetAttributes*>(ds->GetPointData());
+
+    svtkDataArray *da = atts->GetArray(arrayName);
+    if (da)
+      internals.BytesMoved += long(da->GetNumberOfTuples())*
+        da->GetNumberOfComponents()*da->GetDataTypeSize();
+    }
+}
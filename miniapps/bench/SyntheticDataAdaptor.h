@@ -0,0 +1,115 @@
+#ifndef SyntheticDataAdaptor_h
+#define SyntheticDataAdaptor_h
+
+#include <sensei/SVTKDataAdaptor.h>
+
+#include <string>
+
+class svtkDataObject;
+
+/** Generates synthetic meshes for benchmarking analysis back ends. The
+ * global domain is the unit cube discretized with the given number of
+ * cells. The domain is split into a number of blocks which are
+ * distributed over the MPI ranks. Each block carries a number of double
+ * precision arrays and optionally ghost layers. The mesh, named "mesh", is
+ * served through the sensei::SVTKDataAdaptor API. The number of bytes of
+ * mesh geometry and arrays requested through the API is tallied so that
+ * the data movement of each analysis can be reported.
+ */
+class SyntheticDataAdaptor : public sensei::SVTKDataAdaptor
+{
+public:
+  static SyntheticDataAdaptor *New();
+  senseiTypeMacro(SyntheticDataAdaptor, sensei::SVTKDataAdaptor);
+
+  /// the supported mesh types
+  enum {MESH_IMAGE, MESH_RECTILINEAR, MESH_STRUCTURED,
+    MESH_UNSTRUCTURED, MESH_POLYDATA, MESH_AMR};
+
+  /// the supported block distributions
+  enum {DIST_BLOCK, DIST_CYCLIC, DIST_RANDOM};
+
+  /// convert a mesh type name into an enum. returns zero if successful
+  static int GetMeshType(const std::string &name, int &type);
+
+  /// convert a block distribution name into an enum. returns zero if successful
+  static int GetDistribution(const std::string &name, int &dist);
+
+  /** Generate the mesh. All ranks must have at least one block. For AMR
+   * meshes, every other block is refined by a factor of 2 in a second
+   * level and ghost layers are not generated, rather the covered cells of
+   * the coarse level are marked.
+   *
+   * @param[in] meshType one of the MESH_* enumerations
+   * @param[in] shape the global number of cells in each direction
+   * @param[in] nBlocks the total number of blocks
+   * @param[in] distribution one of the DIST_* enumerations
+   * @param[in] nArrays the number of arrays named array_0 ... array_n-1
+   * @param[in] association svtkDataObject::POINT or svtkDataObject::CELL
+   * @param[in] nGhosts the number of ghost layers
+   * @param[in] seed the seed used for the random distribution
+   * @returns zero if successful
+   */
+  int Initialize(int meshType, const int shape[3], int nBlocks,
+    int distribution, int nArrays, int association, int nGhosts,
+    unsigned int seed);
+
+  /// Update the arrays for the given time step
+  int Update(long step, double time);
+
+  /// Get the number of local blocks and cells
+  void GetLocalSize(long &nBlocks, long &nCells);
+
+  /// Get the number of bytes served since the last reset
+  long GetBytesMoved();
+
+  /// Reset the count of bytes served
+  void ResetBytesMoved();
+
+  // SENSEI API
+  int GetMesh(const std::string &meshName, bool structureOnly,
+    svtkDataObject *&mesh) override;
+
+  using sensei::DataAdaptor::GetMesh;
+
+  int AddArray(svtkDataObject* mesh, const std::string &meshName,
+    int association, const std::string &arrayName) override;
+
+  int AddGhostNodesArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  int AddGhostCellsArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  int GetMeshBlock(const std::string &meshName, long blockId,
+    bool structureOnly, svtkDataObject *&block) override;
+
+  int AddArrayToBlock(svtkDataObject *block, const std::string &meshName,
+    long blockId, int association, const std::string &arrayName) override;
+
+  int AddGhostNodesArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+  int AddGhostCellsArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+protected:
+  SyntheticDataAdaptor();
+  ~SyntheticDataAdaptor();
+
+  SyntheticDataAdaptor(const SyntheticDataAdaptor&) = delete;
+  void operator=(const SyntheticDataAdaptor&) = delete;
+
+  // tally the size of the named array on the local blocks
+  void CountArrayBytes(int association, const char *arrayName);
+
+  // tally the size of the named array on the passed block
+  void CountBlockArrayBytes(svtkDataObject *block, int association,
+    const char *arrayName);
+
+private:
+  struct InternalsType;
+  InternalsType *Internals;
+};
+
+#endif
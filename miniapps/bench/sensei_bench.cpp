@@ -0,0 +1,337 @@
+#include "SyntheticDataAdaptor.h"
+
+#include <ConfigurableAnalysis.h>
+#include <MemoryProfiler.h>
+#include <MPIManager.h>
+#include <XMLUtils.h>
+#include <Profiler.h>
+#include <Error.h>
+
+#include <opts/opts.h>
+#include <pugixml.hpp>
+
+#include <svtkDataObject.h>
+#include <svtkSmartPointer.h>
+
+#include <mpi.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+// run time statistics for one analysis. the execute and finalize times are
+// taken by the profiler from the events of the given names
+struct AnalysisStats
+{
+  AnalysisStats() : BytesMoved(0), PeakMemoryIncrease(0) {}
+
+  std::string Name;
+  std::string ExecuteEvent;
+  std::string FinalizeEvent;
+  svtkSmartPointer<sensei::ConfigurableAnalysis> Analysis;
+  long BytesMoved;
+  long long PeakMemoryIncrease;
+};
+
+// **************************************************************************
+int createAnalyses(MPI_Comm comm, const std::string &fileName,
+  std::vector<AnalysisStats> &analyses)
+{
+  pugi::xml_document doc;
+  if (sensei::XMLUtils::Parse(comm, fileName, doc))
+    {
+    SENSEI_ERROR("Failed to parse \"" << fileName << "\"")
+    return -1;
+    }
+
+  pugi::xml_node root = doc.child("sensei");
+
+  // each enabled analysis and transport is given its own instance of
+  // ConfigurableAnalysis so that its costs can be measured separately
+  for (pugi::xml_node node = root.first_child(); node;
+    node = node.next_sibling())
+    {
+    std::string elem = node.name();
+    if (((elem != "analysis") && (elem != "transport")) ||
+      !node.attribute("enabled").as_int(0))
+      continue;
+
+    pugi::xml_document subDoc;
+    subDoc.append_child("sensei").append_copy(node);
+
+    AnalysisStats stats;
+    stats.Name = elem + ":" + node.attribute("type").value();
+
+    std::ostringstream oss;
+    oss << "sensei_bench::" << analyses.size() << "::" << stats.Name;
+    stats.ExecuteEvent = oss.str() + "::Execute";
+    stats.FinalizeEvent = oss.str() + "::Finalize";
+
+    stats.Analysis = svtkSmartPointer<sensei::ConfigurableAnalysis>::New();
+    stats.Analysis->SetCommunicator(comm);
+
+    if (stats.Analysis->Initialize(subDoc.child("sensei")))
+      {
+      SENSEI_ERROR("Failed to initialize " << stats.Name)
+      // release the analyses created so far
+      analyses.clear();
+      return -1;
+      }
+
+    analyses.push_back(stats);
+    }
+
+  if (analyses.empty())
+    {
+    SENSEI_ERROR("No enabled analyses or transports in \"" << fileName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+// **************************************************************************
+void report(MPI_Comm comm, std::ostream &os, long nSteps,
+  std::vector<AnalysisStats> &analyses, SyntheticDataAdaptor *data)
+{
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  double perStep = nSteps > 0 ? 1.0/nSteps : 0.0;
+
+  if (rank == 0)
+    os << std::left << std::setw(28) << "# analysis"
+      << std::right << std::setw(14) << "exec min (s)"
+      << std::setw(14) << "exec avg (s)" << std::setw(14) << "exec max (s)"
+      << std::setw(14) << "finalize (s)" << std::setw(18) << "bytes/step"
+      << std::setw(18) << "peak RSS +KiB" << std::endl;
+
+  size_t nAnalyses = analyses.size();
+  for (size_t i = 0; i < nAnalyses; ++i)
+    {
+    AnalysisStats &stats = analyses[i];
+
+    long count = 0;
+    double tExec = 0.0;
+    double tLocalFin = 0.0;
+    if (sensei::Profiler::GetEventTime(stats.ExecuteEvent, count, tExec) ||
+      sensei::Profiler::GetEventTime(stats.FinalizeEvent, count, tLocalFin))
+      SENSEI_ERROR("Failed to get the times of " << stats.Name)
+
+    tExec *= perStep;
+
+    double tMin = 0.0;
+    double tMax = 0.0;
+    double tSum = 0.0;
+    double tFin = 0.0;
+    long bytes = stats.BytesMoved*perStep;
+    long bytesSum = 0;
+    long long peakMax = 0;
+
+    MPI_Reduce(&tExec, &tMin, 1, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(&tExec, &tMax, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(&tExec, &tSum, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+    MPI_Reduce(&tLocalFin, &tFin, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+    MPI_Reduce(&bytes, &bytesSum, 1, MPI_LONG, MPI_SUM, 0, comm);
+    MPI_Reduce(&stats.PeakMemoryIncrease, &peakMax, 1,
+      MPI_LONG_LONG, MPI_MAX, 0, comm);
+
+    if (rank == 0)
+      os << std::left << std::setw(28) << stats.Name << std::right
+        << std::setw(14) << tMin << std::setw(14) << tSum/nRanks
+        << std::setw(14) << tMax << std::setw(14) << tFin
+        << std::setw(18) << bytesSum << std::setw(18) << peakMax << std::endl;
+    }
+
+  // per rank memory use and load
+  long long peak = sensei::MemoryProfiler::GetProcPeakMemoryUsed();
+
+  long localSize[2] = {0, 0};
+  data->GetLocalSize(localSize[0], localSize[1]);
+
+  std::vector<long long> peaks(nRanks);
+  std::vector<long> sizes(2*nRanks);
+
+  MPI_Gather(&peak, 1, MPI_LONG_LONG, peaks.data(), 1, MPI_LONG_LONG, 0, comm);
+  MPI_Gather(localSize, 2, MPI_LONG, sizes.data(), 2, MPI_LONG, 0, comm);
+
+  if (rank == 0)
+    {
+    os << std::endl << std::setw(8) << "# rank" << std::setw(18)
+      << "peak RSS (KiB)" << std::setw(10) << "blocks"
+      << std::setw(14) << "cells" << std::endl;
+
+    for (int i = 0; i < nRanks; ++i)
+      os << std::setw(8) << i << std::setw(18) << peaks[i]
+        << std::setw(10) << sizes[2*i] << std::setw(14) << sizes[2*i+1]
+        << std::endl;
+    }
+}
+}
+
+int main(int argc, char **argv)
+{
+  sensei::MPIManager mpiMan(argc, argv);
+
+  MPI_Comm comm = MPI_COMM_WORLD;
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  std::string configFile;
+  std::string meshName = "image";
+  std::string distName = "block";
+  std::string centering = "cell";
+  std::string outFile;
+  int nx = 64;
+  int ny = 64;
+  int nz = 64;
+  int nBlocks = nRanks;
+  int nArrays = 1;
+  int nGhosts = 0;
+  long nSteps = 10;
+  unsigned int seed = 1;
+
+  using namespace opts;
+  Options ops(argc, argv);
+  ops >> Option('f', "config", configFile, "Sensei analysis configuration xml (required)")
+      >> Option('m', "mesh", meshName, "mesh type: image, rectilinear, structured, unstructured, polydata, or amr")
+      >> Option("nx", nx, "global number of cells in the x-direction")
+      >> Option("ny", ny, "global number of cells in the y-direction")
+      >> Option("nz", nz, "global number of cells in the z-direction")
+      >> Option('b', "blocks", nBlocks, "number of blocks. must be greater or equal to the number of MPI ranks")
+      >> Option('d', "distribution", distName, "block distribution: block, cyclic, or random")
+      >> Option('a', "arrays", nArrays, "number of arrays, named array_0 ... array_n-1")
+      >> Option("centering", centering, "array centering: cell or point")
+      >> Option('g', "ghost-layers", nGhosts, "number of ghost layers")
+      >> Option('n', "steps", nSteps, "number of time steps")
+      >> Option("seed", seed, "seed for the random block distribution")
+      >> Option('o', "output", outFile, "file to write the report to. stdout if not set");
+
+  if ((ops >> Present('h', "help", "show help")) || configFile.empty())
+    {
+    if (rank == 0)
+      std::cerr << "Usage: " << argv[0] << " [OPTIONS]\n\n" << ops << std::endl;
+    return 1;
+    }
+
+  int meshType = 0;
+  int distribution = 0;
+  if (SyntheticDataAdaptor::GetMeshType(meshName, meshType) ||
+    SyntheticDataAdaptor::GetDistribution(distName, distribution))
+    return -1;
+
+  if ((centering != "cell") && (centering != "point"))
+    {
+    SENSEI_ERROR("Invalid centering \"" << centering << "\"")
+    return -1;
+    }
+
+  int association = centering == "cell" ?
+    svtkDataObject::CELL : svtkDataObject::POINT;
+
+  // generate the data
+  int shape[3] = {nx, ny, nz};
+
+  SyntheticDataAdaptor *data = SyntheticDataAdaptor::New();
+  if (data->Initialize(meshType, shape, nBlocks, distribution,
+    nArrays, association, nGhosts, seed))
+    {
+    SENSEI_ERROR("Failed to generate the data")
+    data->Delete();
+    return -1;
+    }
+
+  // the analyses are timed by the profiler. unless configured in the
+  // environment only the summary of the events is kept
+  if (!sensei::Profiler::Enabled())
+    {
+    sensei::Profiler::Enable(0x09);
+    sensei::Profiler::Initialize();
+    }
+
+  // configure the analyses
+  std::vector<AnalysisStats> analyses;
+  if (createAnalyses(comm, configFile, analyses))
+    {
+    data->Delete();
+    return -1;
+    }
+
+  size_t nAnalyses = analyses.size();
+
+  // run
+  for (long step = 0; step < nSteps; ++step)
+    {
+    double time = 0.1*step;
+
+    data->Update(step, time);
+
+    for (size_t i = 0; i < nAnalyses; ++i)
+      {
+      AnalysisStats &stats = analyses[i];
+
+      MPI_Barrier(comm);
+
+      data->ResetBytesMoved();
+      long long peak0 = sensei::MemoryProfiler::GetProcPeakMemoryUsed();
+
+      sensei::Profiler::StartEvent(stats.ExecuteEvent.c_str());
+      stats.Analysis->Execute(data, nullptr);
+      sensei::Profiler::EndEvent(stats.ExecuteEvent.c_str());
+
+      stats.BytesMoved += data->GetBytesMoved();
+      stats.PeakMemoryIncrease +=
+        sensei::MemoryProfiler::GetProcPeakMemoryUsed() - peak0;
+      }
+    }
+
+  for (size_t i = 0; i < nAnalyses; ++i)
+    {
+    AnalysisStats &stats = analyses[i];
+
+    MPI_Barrier(comm);
+
+    sensei::Profiler::StartEvent(stats.FinalizeEvent.c_str());
+    stats.Analysis->Finalize();
+    sensei::Profiler::EndEvent(stats.FinalizeEvent.c_str());
+    }
+
+  // report
+  std::ofstream ofs;
+  if ((rank == 0) && !outFile.empty())
+    {
+    ofs.open(outFile);
+    if (!ofs.good())
+      {
+      SENSEI_ERROR("Failed to open \"" << outFile << "\" for writing")
+      MPI_Abort(comm, -1);
+      }
+    }
+
+  std::ostream &os = outFile.empty() ? std::cout : ofs;
+
+  if (rank == 0)
+    os << "# sensei_bench mesh=" << meshName << " shape=" << nx << "x" << ny
+      << "x" << nz << " blocks=" << nBlocks << " distribution=" << distName
+      << " arrays=" << nArrays << " centering=" << centering << " ghosts="
+      << nGhosts << " steps=" << nSteps << " ranks=" << nRanks << std::endl;
+
+  report(comm, os, nSteps, analyses, data);
+
+  analyses.clear();
+
+  data->Delete();
+
+  return 0;
+}
@@ -165,6 +165,61 @@ int MandelbrotDataAdaptor::GetMesh(const std::string &meshName,
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+int MandelbrotDataAdaptor::GetMeshBlock(const std::string &meshName,
+  long blockId, bool structureOnly, svtkDataObject *&block)
+{
+  sensei::TimeEvent<64> event("MandelbrotDataAdaptor::GetMeshBlock");
+
+  // geometry is implicit with block structured amr, hence we can safely
+  // ignore this flag
+  (void)structureOnly;
+
+  block = nullptr;
+
+  if (meshName != "mesh")
+    {
+    SENSEI_ERROR("the miniapp provides meshes named \"mesh\""
+       " you requested \"" << meshName << "\"")
+    return -1;
+    }
+
+  // the block ids are the patch ids
+  simulation_data *sim = this->Internals->sim;
+  patch_t *patch = patch_get_patch(&sim->patch, blockId);
+  if (!patch || (patch->owners[0] != sim->par_rank))
+    {
+    SENSEI_ERROR("patch " << blockId << " is not on this rank")
+    return -1;
+    }
+
+  // problem domain information. this is the same as in GetMesh but is
+  // computed locally so that no communication is needed per block
+  double x0[3] = {sim->patch.window[0], sim->patch.window[2], 0.0};
+  double x1[3] = {sim->patch.window[1], sim->patch.window[3], 0.0};
+
+  int nx0[3] = {sim->patch.logical_extents[1] - sim->patch.logical_extents[0] + 1,
+    sim->patch.logical_extents[3] - sim->patch.logical_extents[2] + 1, 1};
+
+  int j = patch->level;
+  double rfac = j ? j*2 : 1;
+
+  double dx[3] = {(x1[0] - x0[0]) / (nx0[0]*rfac),
+    (x1[1] - x0[1]) / (nx0[1]*rfac), 0.001};
+
+  int ptExt[6] = {patch->logical_extents[0], patch->logical_extents[1] + 1,
+    patch->logical_extents[2], patch->logical_extents[3] + 1, 0, 1};
+
+  svtkUniformGrid *ug = svtkUniformGrid::New();
+  ug->SetOrigin(x0);
+  ug->SetSpacing(dx);
+  ug->SetExtent(ptExt);
+
+  block = ug;
+
+  return 0;
+}
+
 //-----------------------------------------------------------------------------
 int MandelbrotDataAdaptor::AddGhostCellsArray(svtkDataObject* mesh,
     const std::string &meshName)
@@ -178,10 +233,6 @@ int MandelbrotDataAdaptor::AddGhostCellsArray(svtkDataObject* mesh,
     return -1;
     }
 
-  // get the simulation data
-  int np = 0;
-  patch_t **patches = patch_flat_array(&this->Internals->sim->patch, &np);
-
   // walk over all local blocks and zero-copy simulation data into the blocks
   svtkOverlappingAMR *amrMesh = dynamic_cast<svtkOverlappingAMR*>(mesh);
 
@@ -195,38 +246,56 @@ int MandelbrotDataAdaptor::AddGhostCellsArray(svtkDataObject* mesh,
 
     int gid = amrMesh->GetAMRBlockSourceIndex(level, index);
 
-    // get the simulation data
-    patch_t *patch = nullptr;
-    if (patch_find_patch(patches, np, gid, patch))
+    if (this->AddGhostCellsArrayToBlock(it->GetCurrentDataObject(),
+      meshName, gid))
       {
       it->Delete();
-      patch_free_flat_array(patches);
       SENSEI_ERROR("at level " << level << " index " << index << " no patch " << gid);
       return -1;
       }
+    }
 
-    int nxy = patch->nx*patch->ny;
-    svtkUnsignedCharArray *arr = svtkUnsignedCharArray::New();
-    arr->SetName("svtkGhostType");
-    if (patch->blank)
-      {
-      arr->SetArray(patch->blank, nxy, 1);
-      }
-    else
-      {
-      // leaf patches won't have a blank array.
-      arr->SetNumberOfTuples(nxy);
-      memset(arr->GetVoidPointer(0), 0, nxy*sizeof(unsigned char));
-      }
+  it->Delete();
 
-    svtkUniformGrid *block =
-      dynamic_cast<svtkUniformGrid*>(it->GetCurrentDataObject());
-    block->GetCellData()->AddArray(arr);
-    arr->Delete();
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int MandelbrotDataAdaptor::AddGhostCellsArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  if (meshName != "mesh")
+    {
+    SENSEI_ERROR("the miniapp provides meshes named \"mesh\""
+       " you requested \"" << meshName << "\"")
+    return -1;
     }
 
-  it->Delete();
-  patch_free_flat_array(patches);
+  // get the simulation data
+  patch_t *patch = patch_get_patch(&this->Internals->sim->patch, blockId);
+  svtkUniformGrid *ug = dynamic_cast<svtkUniformGrid*>(block);
+  if (!patch || !ug)
+    {
+    SENSEI_ERROR("no patch " << blockId)
+    return -1;
+    }
+
+  int nxy = patch->nx*patch->ny;
+  svtkUnsignedCharArray *arr = svtkUnsignedCharArray::New();
+  arr->SetName("svtkGhostType");
+  if (patch->blank)
+    {
+    arr->SetArray(patch->blank, nxy, 1);
+    }
+  else
+    {
+    // leaf patches won't have a blank array.
+    arr->SetNumberOfTuples(nxy);
+    memset(arr->GetVoidPointer(0), 0, nxy*sizeof(unsigned char));
+    }
+
+  ug->GetCellData()->AddArray(arr);
+  arr->Delete();
 
   return 0;
 }
@@ -245,10 +314,6 @@ int MandelbrotDataAdaptor::AddArray(svtkDataObject* mesh, const std::string &mes
     return 1;
     }
 
-  // get the simulation data
-  int np = 0;
-  patch_t **patches = patch_flat_array(&this->Internals->sim->patch, &np);
-
   // walk over all local blocks and zero-copy simulation data into the blocks
   svtkOverlappingAMR *amrMesh = dynamic_cast<svtkOverlappingAMR*>(mesh);
 
@@ -262,28 +327,49 @@ int MandelbrotDataAdaptor::AddArray(svtkDataObject* mesh, const std::string &mes
 
     int gid = amrMesh->GetAMRBlockSourceIndex(level, index);
 
-    // get the simulation data
-    patch_t *patch = nullptr;
-    if (patch_find_patch(patches, np, gid, patch))
+    if (this->AddArrayToBlock(it->GetCurrentDataObject(), meshName, gid,
+      association, arrayName))
       {
       it->Delete();
-      patch_free_flat_array(patches);
       SENSEI_ERROR("at level " << level << " index " << index << " no patch " << gid);
       return -1;
       }
-
-    // pass it into SVTK
-    svtkUniformGrid *block = dynamic_cast<svtkUniformGrid*>(it->GetCurrentDataObject());
-    svtkUnsignedCharArray *arr = svtkUnsignedCharArray::New();
-    arr->SetName("mandelbrot");
-    arr->SetArray(patch->data, patch->nx*patch->ny, 1);
-    block->GetCellData()->SetScalars(arr);
-    block->GetCellData()->SetActiveScalars("mandelbrot");
-    arr->Delete();
     }
 
   it->Delete();
-  patch_free_flat_array(patches);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int MandelbrotDataAdaptor::AddArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association,
+  const std::string &arrayName)
+{
+  if ((association != svtkDataObject::FIELD_ASSOCIATION_CELLS) ||
+    (arrayName != "mandelbrot") || (meshName != "mesh"))
+    {
+    SENSEI_ERROR("the miniapp provides a cell centered array named \"mandelbrot\" "
+      " on a mesh named \"mesh\"")
+    return 1;
+    }
+
+  // get the simulation data
+  patch_t *patch = patch_get_patch(&this->Internals->sim->patch, blockId);
+  svtkUniformGrid *ug = dynamic_cast<svtkUniformGrid*>(block);
+  if (!patch || !ug)
+    {
+    SENSEI_ERROR("no patch " << blockId)
+    return -1;
+    }
+
+  // pass it into SVTK
+  svtkUnsignedCharArray *arr = svtkUnsignedCharArray::New();
+  arr->SetName("mandelbrot");
+  arr->SetArray(patch->data, patch->nx*patch->ny, 1);
+  ug->GetCellData()->SetScalars(arr);
+  ug->GetCellData()->SetActiveScalars("mandelbrot");
+  arr->Delete();
 
   return 0;
 }
@@ -413,5 +499,5 @@ int MandelbrotDataAdaptor::GetMeshMetadata(unsigned int id,
 int MandelbrotDataAdaptor::ReleaseData()
 {
   sensei::TimeEvent<64> event("MandelbrotDataAdaptor::ReleaseData");
-  return 0;
+  return this->Superclass::ReleaseData();
 }
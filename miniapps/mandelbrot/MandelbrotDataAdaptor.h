@@ -32,6 +32,17 @@ public:
   int AddGhostCellsArray(svtkDataObject* mesh,
     const std::string &meshName) override;
 
+  int GetMeshBlock(const std::string &meshName, long blockId,
+    bool structureOnly, svtkDataObject *&block) override;
+
+  int AddArrayToBlock(svtkDataObject *block, const std::string &meshName,
+    long blockId, int association, const std::string &arrayName) override;
+
+  int AddGhostCellsArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+  bool StreamsMeshBlocks(const std::string &) override { return true; }
+
   int ReleaseData() override;
 
 protected:
@@ -1,5 +1,6 @@
 #include "DataAdaptor.h"
 #include "MeshMetadata.h"
+#include "SVTKUtils.h"
 #include "Error.h"
 
 #include <svtkCellArray.h>
@@ -262,79 +263,16 @@ int newParticleArray(const std::vector<Particle> &particles,
 }
 
 static
-svtkUnsignedCharArray *newGhostCellsArray(int *shape,
-  sdiy::DiscreteBounds &cellExt, int ng)
+void getBlockOwnedExtent(const int *shape, const sdiy::DiscreteBounds &cellExt,
+  int ng, int *ext)
 {
-    // This sim is a:lways 3D.
-    int imin = cellExt.min[0];
-    int jmin = cellExt.min[1];
-    int kmin = cellExt.min[2];
-    int imax = cellExt.max[0];
-    int jmax = cellExt.max[1];
-    int kmax = cellExt.max[2];
-    int nx = imax - imin + 1;
-    int ny = jmax - jmin + 1;
-    int nz = kmax - kmin + 1;
-    int nxny = nx*ny;
-    int ncells = nx*ny*nz;
-
-    svtkUnsignedCharArray *g = svtkUnsignedCharArray::New();
-    g->SetNumberOfTuples(ncells);
-    memset(g->GetVoidPointer(0), 0, sizeof(unsigned char) * ncells);
-    g->SetName("svtkGhostType");
-    unsigned char *gptr = (unsigned char *)g->GetVoidPointer(0);
-    unsigned char ghost = 1;
-
-    if(imin > 0)
-    {
-        // Set the low I faces to ghosts.
-        for(int k = 0; k < nz; ++k)
-        for(int j = 0; j < ny; ++j)
-        for(int i = 0; i < ng; ++i)
-            gptr[k * nxny + j*nx + i] = ghost;
-    }
-    if(imax < shape[0]-1)
-    {
-        // Set the high I faces to ghosts.
-        for(int k = 0; k < nz; ++k)
-        for(int j = 0; j < ny; ++j)
-        for(int i = nx-ng; i < nx; ++i)
-            gptr[k * nxny + j*nx + i] = ghost;
-    }
-    if(jmin > 0)
-    {
-        // Set the low J faces to ghosts.
-        for(int k = 0; k < nz; ++k)
-        for(int j = 0; j < ng; ++j)
-        for(int i = 0; i < nx; ++i)
-            gptr[k * nxny + j*nx + i] = ghost;
-    }
-    if(jmax < shape[1]-1)
-    {
-        // Set the high J faces to ghosts.
-        for(int k = 0; k < nz; ++k)
-        for(int j = ny-ng; j < ny; ++j)
-        for(int i = 0; i < nx; ++i)
-            gptr[k * nxny + j*nx + i] = ghost;
-    }
-    if(kmin > 0)
-    {
-        // Set the low K faces to ghosts.
-        for(int k = 0; k < ng; ++k)
-        for(int j = 0; j < ny; ++j)
-        for(int i = 0; i < nx; ++i)
-            gptr[k * nxny + j*nx + i] = ghost;
-    }
-    if(kmax < shape[2]-1)
+  // the block is ghosted by ng cells on each face that is not on the
+  // boundary of the domain. This sim is always 3D.
+  for (int i = 0; i < 3; ++i)
     {
-        // Set the high K faces to ghosts.
-        for(int k = nz-ng; k < nz; ++k)
-        for(int j = 0; j < ny; ++j)
-        for(int i = 0; i < nx; ++i)
-            gptr[k * nxny + j*nx + i] = ghost;
+    ext[2*i] = cellExt.min[i] + (cellExt.min[i] > 0 ? ng : 0);
+    ext[2*i+1] = cellExt.max[i] - (cellExt.max[i] < shape[i]-1 ? ng : 0);
     }
-
-    return g;
 }
 
 namespace oscillators
@@ -500,46 +438,73 @@ int DataAdaptor::GetMesh(const std::string &meshName, bool structureOnly,
   else
     {
     // the other meshes that have data per block
-    int particleBlocks = meshName == "particles";
-    int unstructuredBlocks = particleBlocks ? 0 : meshName == "ucdmesh";
-
     mb->SetNumberOfBlocks(this->Internals->NumBlocks);
 
     auto it = this->Internals->BlockExtents.begin();
     auto end = this->Internals->BlockExtents.end();
     for (; it != end; ++it)
       {
-      if (particleBlocks)
+      svtkDataObject *blk = nullptr;
+      if (this->GetMeshBlock(meshName, it->first, structureOnly, blk))
         {
-        svtkPolyData *pd =
-          newParticleBlock(this->Internals->ParticleData[it->first],
-          structureOnly);
-
-        mb->SetBlock(it->first, pd);
-        pd->Delete();
-        }
-      else if (unstructuredBlocks)
-        {
-        svtkUnstructuredGrid *ug = newUnstructuredBlock(this->Internals->Origin,
-          this->Internals->Spacing, it->second, structureOnly);
-
-        mb->SetBlock(it->first, ug);
-        ug->Delete();
+        mb->Delete();
+        mesh = nullptr;
+        return -1;
         }
-      else
-        {
-        svtkImageData *id = newCartesianBlock(this->Internals->Origin,
-          this->Internals->Spacing, it->second, structureOnly);
 
-        mb->SetBlock(it->first, id);
-        id->Delete();
-        }
+      mb->SetBlock(it->first, blk);
+      blk->Delete();
       }
     }
 
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+int DataAdaptor::GetMeshBlock(const std::string &meshName, long blockId,
+  bool structureOnly, svtkDataObject *&block)
+{
+  block = nullptr;
+
+  // the oscillators are only on rank 0
+  if (meshName == "oscillators")
+    return this->Superclass::GetMeshBlock(meshName,
+      blockId, structureOnly, block);
+
+  if ((meshName != "mesh") && (meshName != "ucdmesh") &&
+    (meshName != "particles"))
+    {
+    SENSEI_ERROR("the miniapp provides meshes named \"mesh\", \"ucdmesh\","
+      ", \"particles\", and \"oscillators\". you requested \"" << meshName << "\"")
+    return -1;
+    }
+
+  auto it = this->Internals->BlockExtents.find(blockId);
+  if (it == this->Internals->BlockExtents.end())
+    {
+    SENSEI_ERROR("block " << blockId << " is not on this rank")
+    return -1;
+    }
+
+  if (meshName == "particles")
+    {
+    block = newParticleBlock(this->Internals->ParticleData[blockId],
+      structureOnly);
+    }
+  else if (meshName == "ucdmesh")
+    {
+    block = newUnstructuredBlock(this->Internals->Origin,
+      this->Internals->Spacing, it->second, structureOnly);
+    }
+  else
+    {
+    block = newCartesianBlock(this->Internals->Origin,
+      this->Internals->Spacing, it->second, structureOnly);
+    }
+
+  return 0;
+}
+
 //-----------------------------------------------------------------------------
 int DataAdaptor::AddArray(svtkDataObject* mesh, const std::string &meshName,
     int association, const std::string &arrayName)
@@ -620,46 +585,10 @@ int DataAdaptor::AddArray(svtkDataObject* mesh, const std::string &meshName,
     }
   else
     {
-    enum {BLOCK, PARTICLE};
-    int meshId = BLOCK;
-    if ((meshName == "mesh") || (meshName == "ucdmesh"))
-      {
-      meshId = BLOCK;
-      if ((arrayName != "data") || (association != svtkDataObject::CELL))
-        {
-        SENSEI_ERROR("mesh \"" << meshName
-          << "\" only has cell data array named \"data\"")
-        return -1;
-        }
-      }
-    else if (meshName == "particles")
-      {
-      meshId = PARTICLE;
-      if (association != svtkDataObject::POINT)
-        {
-        SENSEI_ERROR("mesh \"particles\" only has point data")
-        return -1;
-        }
-      if ((arrayName != "velocity") && (arrayName != "velocityMagnitude") &&
-        (arrayName != "id"))
-        {
-        SENSEI_ERROR("Invalid particle mesh array \"" << arrayName << "\"")
-        return -1;
-        }
-      }
-    else
-      {
-      SENSEI_ERROR("Invalid mesh name \"" << meshName << "\"")
-      return -1;
-      }
-
     auto it = this->Internals->BlockData.begin();
     auto end = this->Internals->BlockData.end();
     for (; it != end; ++it)
       {
-      // this code is the same for the Cartesian and unstructured blocks
-      // because they both have the same number of cells and are in the
-      // same order
       svtkDataObject *blk = mb->GetBlock(it->first);
       if (!blk)
         {
@@ -667,29 +596,88 @@ int DataAdaptor::AddArray(svtkDataObject* mesh, const std::string &meshName,
         return -1;
         }
 
-      svtkFloatArray *fa = nullptr;
-      svtkDataSetAttributes *dsa = nullptr;
+      if (this->AddArrayToBlock(blk, meshName, it->first,
+        association, arrayName))
+        return -1;
+      }
+    }
 
-      if (meshId == BLOCK)
-        {
-        dsa = blk->GetAttributes(svtkDataObject::CELL);
-        svtkIdType nCells = getBlockNumCells(this->Internals->BlockExtents[it->first]);
+  return 0;
+}
 
-        // zero coopy the array
-        fa = svtkFloatArray::New();
-        fa->SetName("data");
-        fa->SetArray(it->second, nCells, 1);
-        }
-      else
-        {
-        dsa = blk->GetAttributes(svtkDataObject::POINT);
-        newParticleArray(*this->Internals->ParticleData[it->first], arrayName, fa);
-        }
+//-----------------------------------------------------------------------------
+int DataAdaptor::AddArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association,
+  const std::string &arrayName)
+{
+  if (meshName == "oscillators")
+    return this->Superclass::AddArrayToBlock(block, meshName,
+      blockId, association, arrayName);
 
-      dsa->AddArray(fa);
-      fa->Delete();
+  enum {BLOCK, PARTICLE};
+  int meshId = BLOCK;
+  if ((meshName == "mesh") || (meshName == "ucdmesh"))
+    {
+    meshId = BLOCK;
+    if ((arrayName != "data") || (association != svtkDataObject::CELL))
+      {
+      SENSEI_ERROR("mesh \"" << meshName
+        << "\" only has cell data array named \"data\"")
+      return -1;
       }
     }
+  else if (meshName == "particles")
+    {
+    meshId = PARTICLE;
+    if (association != svtkDataObject::POINT)
+      {
+      SENSEI_ERROR("mesh \"particles\" only has point data")
+      return -1;
+      }
+    if ((arrayName != "velocity") && (arrayName != "velocityMagnitude") &&
+      (arrayName != "id"))
+      {
+      SENSEI_ERROR("Invalid particle mesh array \"" << arrayName << "\"")
+      return -1;
+      }
+    }
+  else
+    {
+    SENSEI_ERROR("Invalid mesh name \"" << meshName << "\"")
+    return -1;
+    }
+
+  auto it = this->Internals->BlockData.find(blockId);
+  if (!block || (it == this->Internals->BlockData.end()))
+    {
+    SENSEI_ERROR("block " << blockId << " is not on this rank")
+    return -1;
+    }
+
+  svtkFloatArray *fa = nullptr;
+  svtkDataSetAttributes *dsa = nullptr;
+
+  // this code is the same for the Cartesian and unstructured blocks
+  // because they both have the same number of cells and are in the
+  // same order
+  if (meshId == BLOCK)
+    {
+    dsa = block->GetAttributes(svtkDataObject::CELL);
+    svtkIdType nCells = getBlockNumCells(this->Internals->BlockExtents[blockId]);
+
+    // zero coopy the array
+    fa = svtkFloatArray::New();
+    fa->SetName("data");
+    fa->SetArray(it->second, nCells, 1);
+    }
+  else
+    {
+    dsa = block->GetAttributes(svtkDataObject::POINT);
+    newParticleArray(*this->Internals->ParticleData[blockId], arrayName, fa);
+    }
+
+  dsa->AddArray(fa);
+  fa->Delete();
 
   return 0;
 }
@@ -731,9 +719,6 @@ int DataAdaptor::AddGhostCellsArray(svtkDataObject *mesh, const std::string &mes
     auto end = this->Internals->BlockExtents.end();
     for (; it != end; ++it)
       {
-      // this code is the same for the Cartesian and unstructured blocks
-      // because they both have the same number of cells and are in the
-      // same order
       svtkDataObject *blk = mb->GetBlock(it->first);
       if (!blk)
         {
@@ -741,16 +726,53 @@ int DataAdaptor::AddGhostCellsArray(svtkDataObject *mesh, const std::string &mes
         return -1;
         }
 
-      svtkDataSetAttributes *dsa = blk->GetAttributes(svtkDataObject::CELL);
+      if (this->AddGhostCellsArrayToBlock(blk, meshName, it->first))
+        return -1;
+      }
+    }
 
-      svtkUnsignedCharArray *ga = newGhostCellsArray(this->Internals->Shape,
-        it->second, this->Internals->NumGhostCells);
+  return 0;
+}
 
-      dsa->AddArray(ga);
-      ga->Delete();
-      }
+//----------------------------------------------------------------------------
+int DataAdaptor::AddGhostCellsArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  if (meshName == "oscillators")
+    return this->Superclass::AddGhostCellsArrayToBlock(block,
+      meshName, blockId);
+
+  if ((meshName != "mesh") && (meshName != "ucdmesh") &&
+    (meshName != "particles"))
+    {
+    SENSEI_ERROR("the miniapp provides meshes named \"mesh\", \"ucdmesh\","
+      ", \"particles\", and \"oscillators\". you requested \"" << meshName << "\"")
+    return -1;
     }
 
+  auto it = this->Internals->BlockExtents.find(blockId);
+  if (!block || (it == this->Internals->BlockExtents.end()))
+    {
+    SENSEI_ERROR("block " << blockId << " is not on this rank")
+    return -1;
+    }
+
+  // this code is the same for the Cartesian and unstructured blocks
+  // because they both have the same number of cells and are in the
+  // same order
+  svtkDataSetAttributes *dsa = block->GetAttributes(svtkDataObject::CELL);
+
+  std::array<int,6> ext;
+  std::array<int,6> ownedExt;
+  getBlockExtent(it->second, ext.data());
+  getBlockOwnedExtent(this->Internals->Shape, it->second,
+    this->Internals->NumGhostCells, ownedExt.data());
+
+  svtkUnsignedCharArray *ga = sensei::SVTKUtils::NewGhostCellsArray(ext, ownedExt);
+
+  dsa->AddArray(ga);
+  ga->Delete();
+
   return 0;
 }
 
@@ -876,6 +898,7 @@ int DataAdaptor::GetMeshMetadata(unsigned int id, sensei::MeshMetadataPtr &metad
 
     using ExtentIterator = InternalsType::BlockExtentMap::iterator;
 
+    // the DIY bounds are cell extents, as the metadata requires
     if ((id == 0) && metadata->Flags.BlockExtentsSet())
       {
       std::array<int,6> ext;
@@ -891,6 +914,18 @@ int DataAdaptor::GetMeshMetadata(unsigned int id, sensei::MeshMetadataPtr &metad
         getBlockExtent(it->second, ext.data());
         metadata->BlockExtents.emplace_back(std::move(ext));
         }
+
+      // the cells owned by each block, analyses use these to skip the
+      // ghost cells without requesting the ghost array
+      metadata->BlockOwnedExtents.reserve(nBlocks);
+
+      it = this->Internals->BlockExtents.begin();
+      for (; it != end; ++it)
+        {
+        getBlockOwnedExtent(this->Internals->Shape, it->second,
+          this->Internals->NumGhostCells, ext.data());
+        metadata->BlockOwnedExtents.emplace_back(std::move(ext));
+        }
       }
 
     if (metadata->Flags.BlockBoundsSet())
@@ -972,10 +1007,17 @@ int DataAdaptor::GetMeshMetadata(unsigned int id, sensei::MeshMetadataPtr &metad
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+bool DataAdaptor::StreamsMeshBlocks(const std::string &meshName)
+{
+  // the oscillators are served by the default implementation
+  return meshName != "oscillators";
+}
+
 //-----------------------------------------------------------------------------
 int DataAdaptor::ReleaseData()
 {
-  return 0;
+  return this->Superclass::ReleaseData();
 }
 
 }
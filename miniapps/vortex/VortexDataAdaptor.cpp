@@ -386,5 +386,5 @@ int VortexDataAdaptor::ReleaseData()
 {
   DInternals& internals = (*this->Internals);
   internals.Mesh = NULL;
-  return 0;
+  return this->Superclass::ReleaseData();
 }
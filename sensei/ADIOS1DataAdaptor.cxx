@@ -325,7 +325,7 @@ int ADIOS1DataAdaptor::AddArray(svtkDataObject* mesh,
 int ADIOS1DataAdaptor::ReleaseData()
 {
   TimeEvent<128> mark("ADIOS1DataAdaptor::ReleaseData");
-  return 0;
+  return this->Superclass::ReleaseData();
 }
 
 }
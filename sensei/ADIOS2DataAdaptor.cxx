@@ -348,11 +348,66 @@ int ADIOS2DataAdaptor::AddArray(svtkDataObject* mesh,
   return 0;
 }
 
+//----------------------------------------------------------------------------
+int ADIOS2DataAdaptor::GetMeshBlock(const std::string &meshName,
+  long blockId, bool structureOnly, svtkDataObject *&block)
+{
+  TimeEvent<128> mark("ADIOS2DataAdaptor::GetMeshBlock");
+
+  block = nullptr;
+
+  if (this->Internals->Schema.ReadObjectBlock(this->GetCommunicator(),
+    this->Internals->Stream, meshName, blockId, block, structureOnly))
+    {
+    SENSEI_ERROR("Failed to read block " << blockId << " of mesh \""
+      << meshName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ADIOS2DataAdaptor::AddArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association,
+  const std::string &arrayName)
+{
+  TimeEvent<128> mark("ADIOS2DataAdaptor::AddArrayToBlock");
+
+  if (this->Internals->Schema.ReadArrayBlock(this->GetCommunicator(),
+    this->Internals->Stream, meshName, blockId, association, arrayName,
+    block))
+    {
+    SENSEI_ERROR("Failed to read " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" of block " << blockId
+      << " from mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ADIOS2DataAdaptor::AddGhostNodesArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  return this->AddArrayToBlock(block, meshName, blockId,
+    svtkDataObject::POINT, "svtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int ADIOS2DataAdaptor::AddGhostCellsArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  return this->AddArrayToBlock(block, meshName, blockId,
+    svtkDataObject::CELL, "svtkGhostType");
+}
+
 //----------------------------------------------------------------------------
 int ADIOS2DataAdaptor::ReleaseData()
 {
   TimeEvent<128> mark("ADIOS2DataAdaptor::ReleaseData");
-  return 0;
+  return this->Superclass::ReleaseData();
 }
 
 }
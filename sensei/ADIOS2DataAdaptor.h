@@ -63,6 +63,21 @@ public:
   int AddArray(svtkDataObject* mesh, const std::string &meshName,
     int association, const std::string &arrayName) override;
 
+  /// Reads only the requested block from the stream
+  int GetMeshBlock(const std::string &meshName, long blockId,
+    bool structureOnly, svtkDataObject *&block) override;
+
+  int AddArrayToBlock(svtkDataObject *block, const std::string &meshName,
+    long blockId, int association, const std::string &arrayName) override;
+
+  int AddGhostNodesArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+  int AddGhostCellsArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+  bool StreamsMeshBlocks(const std::string &) override { return true; }
+
   int ReleaseData() override;
 
 protected:
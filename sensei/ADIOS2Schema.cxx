@@ -4029,6 +4029,128 @@ int DataObjectCollectionSchema::ReadArray(MPI_Comm comm,
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int DataObjectCollectionSchema::GetBlockMetadata(unsigned int doid,
+  long block_id, sensei::MeshMetadataPtr &md)
+{
+  sensei::MeshMetadataPtr rmd;
+  if (this->Internals->ReceiverMdMap.GetMeshMetadata(doid, rmd))
+    {
+    SENSEI_ERROR("Failed to get receiver metadata for object " << doid)
+    return -1;
+    }
+
+  if ((block_id < 0) || (block_id >= rmd->NumBlocks))
+    {
+    SENSEI_ERROR("Invalid block " << block_id << " of object " << doid)
+    return -1;
+    }
+
+  // the blocks are read by their owner and skipped by the others while the
+  // offsets into the stream are accumulated. disowning the other blocks
+  // reads only the requested one.
+  md = rmd->NewCopy();
+
+  unsigned int num_blocks = md->NumBlocks;
+  for (unsigned int j = 0; j < num_blocks; ++j)
+    {
+    if (md->BlockIds[j] != block_id)
+      md->BlockOwner[j] = -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataObjectCollectionSchema::ReadObjectBlock(MPI_Comm comm,
+  InputStream &iStream, const std::string &object_name, long block_id,
+  svtkDataObject *&block, bool structure_only)
+{
+  sensei::TimeEvent<128> mark(
+    "senseiADIOS2::DataObjectCollectionSchema::ReadObjectBlock");
+
+  block = nullptr;
+
+  unsigned int doid = 0;
+  sensei::MeshMetadataPtr md;
+  if (this->GetObjectId(comm, object_name, doid) ||
+    this->GetBlockMetadata(doid, block_id, md))
+    {
+    SENSEI_ERROR("Failed to get metadata for block " << block_id
+      << " of \"" << object_name << "\"")
+    return -1;
+    }
+
+  svtkCompositeDataSet *cd = nullptr;
+  int ierr = this->Internals->DataObject.ReadMesh(comm,
+    iStream.Handles, doid, md, cd, structure_only);
+
+  // the object holds the requested block, the others are empty
+  svtkMultiBlockDataSet *mb = dynamic_cast<svtkMultiBlockDataSet*>(cd);
+  if (!ierr && mb)
+    {
+    block = mb->GetBlock(block_id);
+    if (block)
+      block->Register(nullptr);
+    }
+
+  if (cd)
+    cd->Delete();
+
+  if (!block)
+    {
+    SENSEI_ERROR("Failed to read block " << block_id << " of object "
+      << doid << " \"" << object_name << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int DataObjectCollectionSchema::ReadArrayBlock(MPI_Comm comm,
+  InputStream &iStream, const std::string &object_name, long block_id,
+  int association, const std::string &array_name, svtkDataObject *block)
+{
+  sensei::TimeEvent<128> mark(
+    "senseiADIOS2::DataObjectCollectionSchema::ReadArrayBlock");
+
+  unsigned int doid = 0;
+  sensei::MeshMetadataPtr md;
+  if (!block || this->GetObjectId(comm, object_name, doid) ||
+    this->GetBlockMetadata(doid, block_id, md))
+    {
+    SENSEI_ERROR("Failed to get metadata for block " << block_id
+      << " of \"" << object_name << "\"")
+    return -1;
+    }
+
+  // place the block where the readers expect it
+  svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+  mb->SetNumberOfBlocks(md->NumBlocks);
+  mb->SetBlock(block_id, block);
+
+  int ierr = 0;
+  if (array_name.rfind("BlockOwner") != std::string::npos)
+    {
+    ierr = this->ReadArray(comm, iStream, object_name, association,
+      array_name, mb);
+    }
+  else if (this->Internals->DataObject.ReadArray(comm,
+    iStream.Handles, doid, array_name, association, md, mb))
+    {
+    SENSEI_ERROR("Failed to read "
+      << sensei::SVTKUtils::GetAttributesName(association)
+      << " data array \"" << array_name << "\" of block " << block_id
+      << " from object \"" << object_name << "\"")
+    ierr = -1;
+    }
+
+  mb->Delete();
+
+  return ierr;
+}
+
 // --------------------------------------------------------------------------
 int DataObjectCollectionSchema::ReadTimeStep(MPI_Comm comm,
   InputStream &iStream, unsigned long &time_step, double &time)
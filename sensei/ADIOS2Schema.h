@@ -85,6 +85,17 @@ public:
     const std::string &object_name, int association,
     const std::string &array_name, svtkDataObject *dobj);
 
+  // like ReadObject but only the block with the given id is read. the
+  // caller takes ownership of the returned block.
+  int ReadObjectBlock(MPI_Comm comm, InputStream &iStream,
+    const std::string &name, long block_id, svtkDataObject *&block,
+    bool structure_only);
+
+  // read a single array of a block returned from ReadObjectBlock
+  int ReadArrayBlock(MPI_Comm comm, InputStream &iStream,
+    const std::string &object_name, long block_id, int association,
+    const std::string &array_name, svtkDataObject *block);
+
   // returns the current time and time step
   int ReadTimeStep(MPI_Comm comm, InputStream &iStream,
     unsigned long &time_step, double &time);
@@ -94,6 +105,11 @@ private:
   int GetObjectId(MPI_Comm comm,
     const std::string &object_name, unsigned int &doid);
 
+  // get the receiver metadata of object doid with all but the given block
+  // disowned, such that the readers read only that block
+  int GetBlockMetadata(unsigned int doid, long block_id,
+    sensei::MeshMetadataPtr &md);
+
   // generate an array on each block of the object filled with the BlockOwner
   int AddBlockOwnerArray(MPI_Comm comm, const std::string &name, int centering,
     const sensei::MeshMetadataPtr &md, svtkCompositeDataSet *dobj);
@@ -1,28 +1,40 @@
 #include "AnalysisAdaptor.h"
+#include "MPIUtils.h"
 
 namespace sensei
 {
 
 //----------------------------------------------------------------------------
-AnalysisAdaptor::AnalysisAdaptor() : Verbose(0)
+AnalysisAdaptor::AnalysisAdaptor() : Comm(MPI_COMM_NULL), Verbose(0)
 {
-  MPI_Comm_dup(MPI_COMM_WORLD, &this->Comm);
 }
 
 //----------------------------------------------------------------------------
 AnalysisAdaptor::~AnalysisAdaptor()
 {
-  MPI_Comm_free(&this->Comm);
+  MPIUtils::ReleaseCommunicator(this->Comm);
 }
 
 //----------------------------------------------------------------------------
 int AnalysisAdaptor::SetCommunicator(MPI_Comm comm)
 {
-  MPI_Comm_free(&this->Comm);
-  MPI_Comm_dup(comm, &this->Comm);
+  // acquire before releasing so that a shared duplicate survives. adaptors
+  // of the same class share a duplicate
+  MPI_Comm tmp = MPIUtils::AcquireCommunicator(comm, this->GetClassName());
+  MPIUtils::ReleaseCommunicator(this->Comm);
+  this->Comm = tmp;
   return 0;
 }
 
+//----------------------------------------------------------------------------
+MPI_Comm AnalysisAdaptor::GetCommunicator()
+{
+  if (this->Comm == MPI_COMM_NULL)
+    this->Comm = MPIUtils::AcquireCommunicator(MPI_COMM_WORLD,
+      this->GetClassName());
+  return this->Comm;
+}
+
 //----------------------------------------------------------------------------
 void AnalysisAdaptor::PrintSelf(ostream& os, svtkIndent indent)
 {
@@ -37,14 +37,19 @@ public:
 
   /** Set the MPI communicator to be used by the adaptor.
    * The default communicator is a duplicate of MPI_COMMM_WORLD, giving
-   * each adaptor a unique communication space. Users wishing to override
-   * this should set the communicator before doing anything else. Derived
-   * classes should use the communicator returned by GetCommunicator.
+   * the adaptors a communication space separate from the simulation's.
+   * Duplicates are shared by the adaptors of the same class set with the
+   * same communicator, see MPIUtils::AcquireCommunicator. Users wishing to
+   * override this should set the communicator before doing anything else.
+   * Derived classes should use the communicator returned by GetCommunicator.
    */
   virtual int SetCommunicator(MPI_Comm comm);
 
-  /// returns the MPI communicator to be used for all communication
-  MPI_Comm GetCommunicator() { return this->Comm; }
+  /** returns the MPI communicator to be used for all communication. when no
+   * communicator was set the default is duplicated on first use, and that
+   * first call is collective over MPI_COMM_WORLD.
+   */
+  MPI_Comm GetCommunicator();
 
   /** Invokes in situ processing, data movement or I/O. The simulation will
    * call this method when data is ready to be processed. Callers will pass a
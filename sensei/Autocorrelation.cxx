@@ -19,10 +19,16 @@
 #include <svtkStructuredData.h>
 #include <svtkUnsignedCharArray.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include <sdiy/master.hpp>
+#include <sdiy/storage.hpp>
 #include <sdiy/reduce.hpp>
 #include <sdiy/partners/merge.hpp>
 #include <sdiy/io/numpy.hpp>
@@ -76,54 +82,83 @@ struct AutocorrelationImpl
     // init grid with (to - from + 1) in 3D, and window in the 4-th dimension
     values(shape.lift(3, window)),
     corr(shape.lift(3, window))
-  { corr = 0; }
+  { values = 0; corr = 0; }
 
   static void* create()            { return new AutocorrelationImpl; }
   static void destroy(void* b)    { delete static_cast<AutocorrelationImpl*>(b); }
-  void process(float* data, unsigned char *ghostArray)
+
+  // move a block in and out of core
+  static void save(const void* b_, sdiy::BinaryBuffer& bb)
     {
-    GridRef g(data, shape);
+    const AutocorrelationImpl* b = static_cast<const AutocorrelationImpl*>(b_);
+    sdiy::save(bb, b->window);
+    sdiy::save(bb, b->gid);
+    sdiy::save(bb, b->from);
+    sdiy::save(bb, b->to);
+    sdiy::save(bb, b->offset);
+    sdiy::save(bb, b->count);
+    sdiy::save(bb, b->values.data(), b->values.size());
+    sdiy::save(bb, b->corr.data(), b->corr.size());
+    }
 
-    if (ghostArray)
-      {
-      sdiy::GridRef<unsigned char, 3> ghost(ghostArray, shape);
-      // record the values
-      sdiy::for_each(g.shape(), [&](const Vertex& v)
-        {
-        auto gv = (ghost(v) == 0) ? g(v) : 0;
+  static void load(void* b_, sdiy::BinaryBuffer& bb)
+    {
+    AutocorrelationImpl* b = static_cast<AutocorrelationImpl*>(b_);
+    sdiy::load(bb, b->window);
+    sdiy::load(bb, b->gid);
+    sdiy::load(bb, b->from);
+    sdiy::load(bb, b->to);
+    sdiy::load(bb, b->offset);
+    sdiy::load(bb, b->count);
+    b->shape = b->to - b->from + Vertex::one();
+    b->values = Grid(b->shape.lift(3, b->window));
+    b->corr = Grid(b->shape.lift(3, b->window));
+    sdiy::load(bb, b->values.data(), b->values.size());
+    sdiy::load(bb, b->corr.data(), b->corr.size());
+    }
+  // accumulate the correlations of the value gv at the cell with flat index
+  // f. the values and correlations of a cell are contiguous in the grids
+  void update(size_t f, float gv)
+    {
+    size_t q = f*window;
 
-        for (size_t i = 1; i <= window; ++i)
-        {
-        if (i > count) continue;    // during the initial fill, we don't get contributions to some shifts
+    for (size_t i = 1; i <= window; ++i)
+    {
+    if (i > count) continue;    // during the initial fill, we don't get contributions to some shifts
 
-        auto uc = v.lift(3, i-1);
-        auto uv = v.lift(3, (offset + window - i) % window);
-        corr(uc) += values(uv)*gv;
-        }
+    corr(q + i-1) += values(q + (offset + window - i) % window)*gv;
+    }
+
+    values(q + offset) = gv;
+    }
+
+  void process(float* data, unsigned char *ghostArray, const int *ownedExt)
+    {
+    size_t n = values.size()/window;
+
+    if (ownedExt)
+      {
+      // visit only the owned cells. the ghost cells would contribute zeros
+      std::array<int,6> ext = {from[0], to[0], from[1], to[1], from[2], to[2]};
+      std::array<int,6> owned = {ownedExt[0], ownedExt[1], ownedExt[2],
+        ownedExt[3], ownedExt[4], ownedExt[5]};
 
-        auto u = v.lift(3, offset);
-        values(u) = gv;
+      SVTKUtils::ForEachOwnedCell(ext, owned, [&](long f)
+        {
+        update(f, data[f]);
         });
       }
+    else if (ghostArray)
+      {
+      // record the values
+      for (size_t f = 0; f < n; ++f)
+        update(f, (ghostArray[f] == 0) ? data[f] : 0);
+      }
     else
       {
       // record the values
-      sdiy::for_each(g.shape(), [&](const Vertex& v)
-        {
-        auto gv = g(v);
-
-        for (size_t i = 1; i <= window; ++i)
-        {
-        if (i > count) continue;    // during the initial fill, we don't get contributions to some shifts
-
-        auto uc = v.lift(3, i-1);
-        auto uv = v.lift(3, (offset + window - i) % window);
-        corr(uc) += values(uv)*gv;
-        }
-
-        auto u = v.lift(3, offset);
-        values(u) = gv;
-        });
+      for (size_t f = 0; f < n; ++f)
+        update(f, data[f]);
       }
     offset += 1;
     offset %= window;
@@ -141,48 +176,176 @@ struct AutocorrelationImpl
   size_t          count  = 0;
 
 private:
-  AutocorrelationImpl() {}        // here just for create; to let Master manage the blocks (+ if we choose to add OOC later)
+  AutocorrelationImpl() {}        // here just for create; to let Master manage the blocks
 };
 
 //-----------------------------------------------------------------------------
 class Autocorrelation::AInternals
 {
 public:
+  std::unique_ptr<sdiy::FileStorage> Storage;
   std::unique_ptr<sdiy::Master> Master;
   size_t KMax;
   std::string MeshName;
   int Association;
   std::string ArrayName;
   size_t Window;
+  int NumberOfThreads;
   bool BlocksInitialized;
   size_t NumberOfBlocks;
 
+  long MemoryBudget;
+  bool MemoryBudgetWarned;
+
+  long StateMemoryBudget;
+  std::string StateStoragePath;
+  int Limit;
+  int Asynchronous;
+
   AInternals() : KMax(3), Association(svtkDataObject::POINT),
-    Window(10), BlocksInitialized(false), NumberOfBlocks(0) {}
+    Window(10), NumberOfThreads(1), BlocksInitialized(false),
+    NumberOfBlocks(0), MemoryBudget(0), MemoryBudgetWarned(false),
+    StateMemoryBudget(0), Limit(-1), Asynchronous(0)
+    {
+    const char *tmpDir = getenv("TMPDIR");
+    if (tmpDir)
+      this->StateStoragePath = tmpDir;
+    }
 
-  void InitializeBlocks(svtkDataObject* dobj)
+  // create the master. when there is a state memory budget the number of
+  // blocks held in memory is set from the size of the largest local block
+  int InitializeMaster(MPI_Comm comm, const MeshMetadataPtr &mmd)
     {
-    if (this->BlocksInitialized)
+    this->Limit = -1;
+
+    if (this->StateMemoryBudget > 0)
       {
-      return;
+      int rank = 0;
+      MPI_Comm_rank(comm, &rank);
+
+      if (mmd->BlockNumCells.empty())
+        {
+        SENSEI_ERROR("Block sizes are required to enforce the state memory budget")
+        return -1;
+        }
+
+      long maxBytes = 0;
+      long nLocal = 0;
+      size_t nBlocks = mmd->BlockOwner.size();
+      for (size_t i = 0; i < nBlocks; ++i)
+        {
+        if (mmd->BlockOwner[i] != rank)
+          continue;
+
+        long nElem = this->Association == svtkDataObject::POINT ?
+          mmd->BlockNumPoints[i] : mmd->BlockNumCells[i];
+
+        maxBytes = std::max(maxBytes, long(2*this->Window*nElem*sizeof(float)));
+        ++nLocal;
+        }
+
+      if (maxBytes > 0)
+        {
+        long limit = std::max(1l, this->StateMemoryBudget/maxBytes);
+        if (limit < nLocal)
+          this->Limit = limit;
+        }
       }
-    if (svtkImageData* img = svtkImageData::SafeDownCast(dobj))
+
+    if (this->Limit > 0)
       {
-      int ext[6];
-      img->GetExtent(ext);
-      if (this->Association == svtkDataObject::CELL)
+      if (this->StateStoragePath.empty())
         {
+        SENSEI_ERROR("The state memory budget is exceeded and no state"
+          " storage path was set. Set the path or TMPDIR")
+        return -1;
+        }
+
+      this->Storage = make_unique<sdiy::FileStorage>(
+        this->StateStoragePath + "/sensei_autocorrelation.XXXXXX");
+
+      this->Master = make_unique<sdiy::Master>(comm, this->NumberOfThreads,
+        this->Limit, &AutocorrelationImpl::create, &AutocorrelationImpl::destroy,
+        this->Storage.get(), &AutocorrelationImpl::save, &AutocorrelationImpl::load);
+      }
+    else
+      {
+      this->Master = make_unique<sdiy::Master>(comm, this->NumberOfThreads,
+        -1, &AutocorrelationImpl::create, &AutocorrelationImpl::destroy);
+      }
+
+    return 0;
+    }
+
+  // move blocks out of core until there is room for one more, keeping the
+  // block with local id keep
+  void Evict(int keep)
+    {
+    for (int i = 0; (i < int(this->Master->size())) &&
+      (this->Master->in_memory() >= this->Limit); ++i)
+      {
+      if ((i != keep) && this->Master->block(i))
+        this->Master->unload(i);
+      }
+    }
+
+  // get a block, moving it into core if needed
+  AutocorrelationImpl *GetBlock(int lid)
+    {
+    if ((this->Limit > 0) && !this->Master->block(lid))
+      {
+      this->Evict(lid);
+      this->Master->load(lid);
+      }
+    return this->Master->block<AutocorrelationImpl>(lid);
+    }
+
+  // start moving the block with global id bid into core while the block
+  // with global id current is processed. the master is not thread safe,
+  // thus the current block is moved into core and room is made for the
+  // next one before the thread starts. while it runs the current block is
+  // only looked up, which does not modify the master
+  std::thread Prefetch(int bid, int current)
+    {
+    int lid = this->Master->lid(bid);
+    if ((this->Limit < 2) || (lid < 0) || this->Master->block(lid))
+      return std::thread();
+
+    int currentLid = this->Master->lid(current);
+    this->GetBlock(currentLid);
+    this->Evict(currentLid);
+
+    sdiy::Master *master = this->Master.get();
+    return std::thread([master,lid]() { master->load(lid); });
+    }
+
+  void InitializeBlock(int bid, svtkImageData *img)
+    {
+    int ext[6];
+    img->GetExtent(ext);
+    if (this->Association == svtkDataObject::CELL)
+      {
 #if SVTK_MAJOR_VERSION == 6 && SVTK_MINOR_VERSION == 1
-        svtkStructuredData::GetCellExtentFromNodeExtent(ext, ext);
+      svtkStructuredData::GetCellExtentFromNodeExtent(ext, ext);
 #else
-        svtkStructuredData::GetCellExtentFromPointExtent(ext, ext);
+      svtkStructuredData::GetCellExtentFromPointExtent(ext, ext);
 #endif
-        }
-      Vertex from { ext[0], ext[2], ext[4] };
-      Vertex to   { ext[1], ext[3], ext[5] };
-      int bid = this->Master->communicator().rank();
-      AutocorrelationImpl* b = new AutocorrelationImpl(this->Window, bid, from, to);
-      this->Master->add(bid, b, new sdiy::Link);
+      }
+    Vertex from { ext[0], ext[2], ext[4] };
+    Vertex to   { ext[1], ext[3], ext[5] };
+    AutocorrelationImpl* b = new AutocorrelationImpl(this->Window, bid, from, to);
+    this->Master->add(bid, b, new sdiy::Link);
+    }
+
+  void InitializeBlocks(svtkDataObject* dobj)
+    {
+    if (this->BlocksInitialized)
+      {
+      return;
+      }
+    if (svtkImageData* img = svtkImageData::SafeDownCast(dobj))
+      {
+      this->InitializeBlock(this->Master->communicator().rank(), img);
       this->NumberOfBlocks = this->Master->communicator().size();
       }
     else if (svtkCompositeDataSet* cd = svtkCompositeDataSet::SafeDownCast(dobj))
@@ -196,28 +359,133 @@ public:
       for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem(), ++bid)
         {
         if (svtkImageData* id = svtkImageData::SafeDownCast(iter->GetCurrentDataObject()))
-          {
-          int ext[6];
-          id->GetExtent(ext);
-          if (this->Association == svtkDataObject::CELL)
-            {
-#if SVTK_MAJOR_VERSION == 6 && SVTK_MINOR_VERSION == 1
-            svtkStructuredData::GetCellExtentFromNodeExtent(ext, ext);
-#else
-            svtkStructuredData::GetCellExtentFromPointExtent(ext, ext);
-#endif
-            }
-          Vertex from { ext[0], ext[2], ext[4] };
-          Vertex to   { ext[1], ext[3], ext[5] };
-
-          AutocorrelationImpl* b = new AutocorrelationImpl(this->Window, bid, from, to);
-          this->Master->add(bid, b, new sdiy::Link);
-          }
+          this->InitializeBlock(bid, id);
         }
       this->NumberOfBlocks = bid;
       }
     this->BlocksInitialized = true;
     }
+
+  // get the extent of the cells owned by a block from the metadata. returns
+  // false when the ghost array is needed to skip the ghost cells
+  bool GetOwnedExtent(const MeshMetadataPtr &mmd, long bid,
+    std::array<int,6> &ownedExt)
+    {
+    return (this->Association == svtkDataObject::CELL) &&
+      (mmd->MeshType == SVTK_MULTIBLOCK_DATA_SET) &&
+      !SVTKUtils::GetOwnedExtent(mmd, bid, ownedExt);
+    }
+
+  // returns true if all of the local blocks have an owned extent
+  bool HaveOwnedExtents(int rank, const MeshMetadataPtr &mmd)
+    {
+    std::vector<long> blockIds;
+    if (!mmd->Flags.BlockDecompSet() ||
+      SVTKUtils::GetLocalBlockIds(rank, mmd, blockIds))
+      return false;
+
+    std::array<int,6> ownedExt;
+    size_t nBlocks = blockIds.size();
+    for (size_t i = 0; i < nBlocks; ++i)
+      {
+      if (!this->GetOwnedExtent(mmd, blockIds[i], ownedExt))
+        return false;
+      }
+
+    return true;
+    }
+
+  void ProcessBlock(int bid, svtkDataSet *ds, const MeshMetadataPtr &mmd)
+    {
+    int lid = this->Master->lid(bid);
+    AutocorrelationImpl* corr = this->GetBlock(lid);
+    svtkFloatArray* fa = svtkFloatArray::SafeDownCast(
+      ds->GetAttributesAsFieldData(this->Association)->GetArray(this->ArrayName.c_str()));
+    svtkUnsignedCharArray *gc = svtkUnsignedCharArray::SafeDownCast(
+      ds->GetCellData()->GetArray("svtkGhostType"));
+    std::array<int,6> ownedExt;
+    bool owned = !gc && this->GetOwnedExtent(mmd, bid, ownedExt);
+    if (fa)
+      {
+      corr->process(fa->GetPointer(0), gc ? gc->GetPointer(0) : nullptr,
+        owned ? ownedExt.data() : nullptr);
+      }
+    else
+      {
+      SENSEI_ERROR("Current implementation only supports float arrays")
+      abort();
+      }
+    }
+
+  // fetches and processes the local blocks one at a time
+  int ProcessBlocks(DataAdaptor *dataIn, const MeshMetadataPtr &mmd)
+    {
+    int rank = 0;
+    MPI_Comm_rank(dataIn->GetCommunicator(), &rank);
+
+    std::vector<long> blockIds;
+    if (SVTKUtils::GetLocalBlockIds(rank, mmd, blockIds))
+      return -1;
+
+    // the blocks fetched so far are released on every return
+    MeshBlocksGuard guard(dataIn);
+
+    bool ghostCells = mmd->NumGhostCells || SVTKUtils::AMR(mmd);
+    bool ghostNodes = mmd->NumGhostNodes > 0;
+
+    size_t nBlocks = blockIds.size();
+    for (size_t i = 0; i < nBlocks; ++i)
+      {
+      long bid = blockIds[i];
+
+      // the ghost array is not needed when the owned cells are known
+      std::array<int,6> ownedExt;
+      bool ghostBlock = ghostCells && !this->GetOwnedExtent(mmd, bid, ownedExt);
+
+      svtkDataObject *block = nullptr;
+      if (dataIn->GetMeshBlock(this->MeshName, bid, false, block) ||
+        dataIn->AddArrayToBlock(block, this->MeshName, bid,
+          this->Association, this->ArrayName) ||
+        (ghostBlock && dataIn->AddGhostCellsArrayToBlock(block, this->MeshName, bid)) ||
+        (ghostNodes && dataIn->AddGhostNodesArrayToBlock(block, this->MeshName, bid)))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to fetch block "
+          << bid << " of mesh \"" << this->MeshName << "\"")
+        if (block)
+          block->Delete();
+        return -1;
+        }
+
+      svtkImageData *img = svtkImageData::SafeDownCast(block);
+      if (!img)
+        {
+        SENSEI_ERROR("Block " << bid << " is a " << block->GetClassName()
+          << " but svtkImageData is required")
+        block->Delete();
+        return -1;
+        }
+
+      if (!this->BlocksInitialized)
+        this->InitializeBlock(bid, img);
+
+      // overlap reading the next block's state with this block's update
+      std::thread prefetch;
+      if (i + 1 < nBlocks)
+        prefetch = this->Prefetch(blockIds[i+1], bid);
+
+      this->ProcessBlock(bid, img, mmd);
+
+      if (prefetch.joinable())
+        prefetch.join();
+
+      block->Delete();
+      }
+
+    this->NumberOfBlocks = mmd->NumBlocks;
+    this->BlocksInitialized = true;
+
+    return 0;
+    }
 };
 
 //-----------------------------------------------------------------------------
@@ -243,9 +511,9 @@ void Autocorrelation::Initialize(size_t window, const std::string &meshName,
 
   AInternals& internals = (*this->Internals);
 
-  internals.Master = make_unique<sdiy::Master>(this->GetCommunicator(),
-    numThreads, -1, &AutocorrelationImpl::create, &AutocorrelationImpl::destroy);
-
+  // the master is created on the first time step, once the block sizes are
+  // known
+  internals.NumberOfThreads = numThreads;
   internals.MeshName = meshName;
   internals.Association = association;
   internals.ArrayName = arrayname;
@@ -266,22 +534,93 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
 
   AInternals& internals = (*this->Internals);
 
-  // see what the simulation is providing
+  // see what the simulation is providing. the block decomposition and sizes
+  // are needed to enforce the memory budget
+  MeshMetadataFlags flags;
+  if ((internals.MemoryBudget > 0) || (internals.StateMemoryBudget > 0))
+    {
+    flags.SetBlockDecomp();
+    flags.SetBlockSize();
+    }
+
   MeshMetadataMap mdMap;
-  if (mdMap.Initialize(dataIn))
+  if (mdMap.Initialize(dataIn, flags))
     {
     SENSEI_ERROR("Failed to get metadata")
     return false;
     }
 
   // metadata
+  unsigned int meshId = 0;
   MeshMetadataPtr mmd;
-  if (mdMap.GetMeshMetadata(internals.MeshName, mmd))
+  if (mdMap.GetMeshId(internals.MeshName, meshId) ||
+    mdMap.GetMeshMetadata(meshId, mmd))
     {
     SENSEI_ERROR("Failed to get metadata for mesh \"" << internals.MeshName << "\"")
     return false;
     }
 
+  // the extents of the owned cells let the ghost cells of logically
+  // Cartesian blocks be skipped without the ghost array. they are requested
+  // only for the mesh and association where that is possible
+  if ((internals.Association == svtkDataObject::CELL) &&
+    (mmd->MeshType == SVTK_MULTIBLOCK_DATA_SET) &&
+    SVTKUtils::LogicallyCartesian(mmd))
+    {
+    flags.SetBlockDecomp();
+    flags.SetBlockExtents();
+
+    mmd = MeshMetadata::New(flags);
+    if (dataIn->GetMeshMetadata(meshId, mmd) ||
+      mmd->Validate(dataIn->GetCommunicator(), flags))
+      {
+      SENSEI_ERROR("Failed to get the block extents of mesh \""
+        << internals.MeshName << "\"")
+      return false;
+      }
+    }
+
+  if (!internals.Master &&
+    internals.InitializeMaster(this->GetCommunicator(), mmd))
+    {
+    SENSEI_ERROR("Failed to initialize the blocks")
+    return false;
+    }
+
+  // process one block at a time when the local data exceeds the budget
+  if (internals.MemoryBudget > 0)
+    {
+    int rank = 0;
+    MPI_Comm_rank(dataIn->GetCommunicator(), &rank);
+
+    long localBytes = SVTKUtils::GetLocalArraySize(rank, mmd,
+      internals.Association, {internals.ArrayName});
+
+    bool streamBlocks = (localBytes < 0) ||
+      (localBytes > internals.MemoryBudget);
+
+    // blocks served from a copy of the whole mesh do not save memory
+    if (streamBlocks && !dataIn->StreamsMeshBlocks(internals.MeshName))
+      {
+      if ((rank == 0) && !internals.MemoryBudgetWarned)
+        SENSEI_WARNING("The data adaptor does not stream the blocks of mesh \""
+          << internals.MeshName << "\". The memory budget is not enforced")
+      internals.MemoryBudgetWarned = true;
+      streamBlocks = false;
+      }
+
+    if (streamBlocks)
+      {
+      if (internals.ProcessBlocks(dataIn, mmd))
+        {
+        SENSEI_ERROR("Failed to process mesh \"" << internals.MeshName
+          << "\" one block at a time")
+        return false;
+        }
+      return true;
+      }
+    }
+
   // mesh
   svtkDataObject* mesh = nullptr;
   if (dataIn->GetMesh(internals.MeshName, false, mesh))
@@ -299,8 +638,12 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
     return false;
     }
 
-  // ghost cells
+  // ghost cells, not needed when the owned cells of every block are known
+  int rank = 0;
+  MPI_Comm_rank(dataIn->GetCommunicator(), &rank);
+
   if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
+    !internals.HaveOwnedExtents(rank, mmd) &&
     dataIn->AddGhostCellsArray(mesh, internals.MeshName))
     {
     SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add ghost cells.")
@@ -314,7 +657,6 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
     return false;
     }
 
-  const int association = internals.Association;
   internals.InitializeBlocks(mesh);
 
   if (svtkCompositeDataSet* cd = svtkCompositeDataSet::SafeDownCast(mesh))
@@ -323,47 +665,36 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
     iter.TakeReference(cd->NewIterator());
     iter->SkipEmptyNodesOff();
 
+    std::vector<int> bids;
+    std::vector<svtkDataSet*> blocks;
+
     int bid = 0;
     for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem(), ++bid)
       {
       if (svtkDataSet* dataObj = svtkDataSet::SafeDownCast(iter->GetCurrentDataObject()))
         {
-        int lid = internals.Master->lid(static_cast<int>(bid));
-        AutocorrelationImpl* corr = internals.Master->block<AutocorrelationImpl>(lid);
-        svtkFloatArray* fa = svtkFloatArray::SafeDownCast(
-          dataObj->GetAttributesAsFieldData(association)->GetArray(internals.ArrayName.c_str()));
-        svtkUnsignedCharArray *gc = svtkUnsignedCharArray::SafeDownCast(
-          dataObj->GetCellData()->GetArray("svtkGhostType"));
-        if (fa)
-          {
-          corr->process(fa->GetPointer(0), gc ? gc->GetPointer(0) : nullptr);
-          }
-        else
-          {
-          SENSEI_ERROR("Current implementation only supports float arrays")
-          abort();
-          }
+        bids.push_back(bid);
+        blocks.push_back(dataObj);
         }
       }
+
+    size_t nBlocks = bids.size();
+    for (size_t i = 0; i < nBlocks; ++i)
+      {
+      // overlap reading the next block's state with this block's update
+      std::thread prefetch;
+      if (i + 1 < nBlocks)
+        prefetch = internals.Prefetch(bids[i+1], bids[i]);
+
+      internals.ProcessBlock(bids[i], blocks[i], mmd);
+
+      if (prefetch.joinable())
+        prefetch.join();
+      }
     }
   else if (svtkDataSet* ds = svtkDataSet::SafeDownCast(mesh))
     {
-    int bid = internals.Master->communicator().rank();
-    int lid = internals.Master->lid(static_cast<int>(bid));
-    AutocorrelationImpl* corr = internals.Master->block<AutocorrelationImpl>(lid);
-    svtkFloatArray* fa = svtkFloatArray::SafeDownCast(
-      ds->GetAttributesAsFieldData(association)->GetArray(internals.ArrayName.c_str()));
-    svtkUnsignedCharArray *gc = svtkUnsignedCharArray::SafeDownCast(
-      ds->GetCellData()->GetArray("svtkGhostType"));
-    if (fa)
-      {
-      corr->process(fa->GetPointer(0), gc ? gc->GetPointer(0) : nullptr);
-      }
-    else
-      {
-      SENSEI_ERROR("Current implementation only supports float arrays")
-      abort();
-      }
+    internals.ProcessBlock(internals.Master->communicator().rank(), ds, mmd);
     }
 
   mesh->Delete();
@@ -371,6 +702,48 @@ bool Autocorrelation::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
   return true;
 }
 
+//-----------------------------------------------------------------------------
+void Autocorrelation::SetMemoryBudget(long bytes)
+{
+  this->Internals->MemoryBudget = bytes;
+}
+
+//-----------------------------------------------------------------------------
+long Autocorrelation::GetMemoryBudget()
+{
+  return this->Internals->MemoryBudget;
+}
+
+//-----------------------------------------------------------------------------
+void Autocorrelation::SetStateMemoryBudget(long bytes)
+{
+  this->Internals->StateMemoryBudget = bytes;
+}
+
+//-----------------------------------------------------------------------------
+long Autocorrelation::GetStateMemoryBudget()
+{
+  return this->Internals->StateMemoryBudget;
+}
+
+//-----------------------------------------------------------------------------
+void Autocorrelation::SetStateStoragePath(const std::string &path)
+{
+  this->Internals->StateStoragePath = path;
+}
+
+//-----------------------------------------------------------------------------
+void Autocorrelation::SetAsynchronous(int val)
+{
+  this->Internals->Asynchronous = val;
+}
+
+//-----------------------------------------------------------------------------
+int Autocorrelation::GetAsynchronous()
+{
+  return this->Internals->Asynchronous;
+}
+
 //-----------------------------------------------------------------------------
 void Autocorrelation::PrintResults(size_t k_max)
 {
@@ -379,35 +752,82 @@ void Autocorrelation::PrintResults(size_t k_max)
   AInternals& internals = (*this->Internals);
   size_t nblocks = internals.NumberOfBlocks;
 
-    // add up the autocorrellations
-  internals.Master->foreach([](AutocorrelationImpl* b, const sdiy::Master::ProxyWithLink& cp)
-                                     {
-                                        std::vector<float> sums(b->window, 0);
-                                        sdiy::for_each(b->corr.shape(), [&](const Vertex4D& v)
-                                        {
-                                            size_t w = v[3];
-                                            sums[w] += b->corr(v);
-                                        });
-
-                                        cp.all_reduce(sums, add_vectors<float>());
-                                     });
-  internals.Master->exchange();
-  if (internals.Master->communicator().rank() == 0)
-    {
-    // print out the autocorrelations
-    auto result = internals.Master->proxy(0).get<std::vector<float>>();
+  // no time steps were processed
+  if (!internals.Master)
+    return;
+
+  auto printSums = [](const std::vector<float> &result)
+    {
     std::cerr << "Autocorrelations:";
     for (size_t i = 0; i < result.size(); ++i)
       std::cerr << ' ' << result[i];
     std::cerr << std::endl;
-    }
+    };
 
-  internals.Master->foreach(
-    [](AutocorrelationImpl*, const sdiy::Master::ProxyWithLink& cp)
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  std::vector<float> localSums;
+  std::vector<float> sums;
+  MPI_Request sumsReq = MPI_REQUEST_NULL;
+
+  if (internals.Asynchronous)
     {
-    cp.collectives()->clear();
-    });
+    // add up the local autocorrelations and post their sum across ranks. it
+    // completes while the strongest autocorrelations are found below
+    size_t window = internals.Window;
+    localSums.assign(window, 0.0f);
+
+    std::mutex sumsMutex;
+    internals.Master->foreach([&](AutocorrelationImpl* b, const sdiy::Master::ProxyWithLink&)
+      {
+      std::vector<float> blockSums(b->window, 0);
+      sdiy::for_each(b->corr.shape(), [&](const Vertex4D& v)
+        {
+        size_t w = v[3];
+        blockSums[w] += b->corr(v);
+        });
 
+      std::lock_guard<std::mutex> lock(sumsMutex);
+      for (size_t i = 0; i < window; ++i)
+        localSums[i] += blockSums[i];
+      });
+
+    if (rank == 0)
+      sums.resize(window);
+
+    MPI_Ireduce(localSums.data(), sums.data(), window, MPI_FLOAT,
+      MPI_SUM, 0, comm, &sumsReq);
+    }
+  else
+    {
+    // add up the autocorrellations
+    internals.Master->foreach([](AutocorrelationImpl* b, const sdiy::Master::ProxyWithLink& cp)
+                                       {
+                                          std::vector<float> sums(b->window, 0);
+                                          sdiy::for_each(b->corr.shape(), [&](const Vertex4D& v)
+                                          {
+                                              size_t w = v[3];
+                                              sums[w] += b->corr(v);
+                                          });
+
+                                          cp.all_reduce(sums, add_vectors<float>());
+                                       });
+    internals.Master->exchange();
+    if (internals.Master->communicator().rank() == 0)
+      {
+      // print out the autocorrelations
+      printSums(internals.Master->proxy(0).get<std::vector<float>>());
+      }
+
+    internals.Master->foreach(
+      [](AutocorrelationImpl*, const sdiy::Master::ProxyWithLink& cp)
+      {
+      cp.collectives()->clear();
+      });
+    }
 
   // select k strongest autocorrelations for each shift
   sdiy::ContiguousAssigner     assigner(internals.Master->communicator().size(), nblocks);     // NB: this is coupled to main(...) in oscillator.cpp
@@ -480,6 +900,15 @@ void Autocorrelation::PrintResults(size_t k_max)
                       }
                   }
               });
+
+  // complete the sum of the autocorrelations
+  if (internals.Asynchronous)
+    {
+    MPI_Wait(&sumsReq, MPI_STATUS_IGNORE);
+
+    if (rank == 0)
+      printSums(sums);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -32,6 +32,46 @@ public:
     int association, const std::string &arrayName, size_t kMax,
     int numThreads = 1);
 
+  /** Set the number of bytes of simulation data that may be held at once.
+   * When the local data is estimated to exceed the budget the blocks are
+   * fetched and processed one at a time using the DataAdaptor's
+   * block-at-a-time API. The budget is not enforced when the DataAdaptor
+   * does not stream the blocks, see DataAdaptor::StreamsMeshBlocks. The
+   * default of 0 disables the budget.
+   */
+  void SetMemoryBudget(long bytes);
+
+  /// Get the number of bytes of simulation data that may be held at once.
+  long GetMemoryBudget();
+
+  /** Set the number of bytes of autocorrelation state, the window of past
+   * values and correlations kept for each block, that may be held in memory.
+   * When the local blocks need more, idle blocks are written to files and
+   * read back when next processed, with the next block read while the
+   * current one is processed. The default of 0 keeps all blocks in memory.
+   */
+  void SetStateMemoryBudget(long bytes);
+
+  /// Get the number of bytes of autocorrelation state that may be held at once.
+  long GetStateMemoryBudget();
+
+  /** Set the directory blocks are written to when the state memory budget is
+   * exceeded. Node local storage should be used. The default is $TMPDIR.
+   * When TMPDIR is not set the path must be given if the budget is exceeded.
+   */
+  void SetStateStoragePath(const std::string &path);
+
+  /** When set the sum of the autocorrelations across MPI ranks is posted
+   * with a nonblocking collective at Finalize and completed after the
+   * strongest autocorrelations are found, overlapping the two reductions.
+   * The sums are then reported after the strongest autocorrelations. The
+   * default of 0 completes the sum first.
+   */
+  void SetAsynchronous(int val);
+
+  /// Get whether the reductions made at Finalize are overlapped
+  int GetAsynchronous();
+
   /// Incrementally computes autocorrelation on the current simulation state
   bool Execute(DataAdaptor* data, DataAdaptor**) override;
 
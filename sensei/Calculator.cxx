@@ -36,13 +36,15 @@ static void replace_all(std::string& data, const std::string& oldtxt, const std:
 senseiNewMacro(Calculator);
 
 //-----------------------------------------------------------------------------
-Calculator::Calculator()
+Calculator::Calculator() : Association(0),
+  Cache(new SVTKUtils::VTKObjectCache)
 {
 }
 
 //-----------------------------------------------------------------------------
 Calculator::~Calculator()
 {
+  delete this->Cache;
 }
 
 //-----------------------------------------------------------------------------
@@ -119,8 +121,9 @@ bool Calculator::Execute(DataAdaptor* data, DataAdaptor** result)
   replace_all(function, "data_time", std::to_string(time));
   replace_all(function, "data_time_step", std::to_string(step));
 
-  // convert input to VTK
-  vtkDataObject *vmeshIn = SVTKUtils::VTKObjectFactory::New(meshIn);
+  // convert input to VTK, reusing the geometry and arrays that were not
+  // modified since the last time step
+  vtkDataObject *vmeshIn = SVTKUtils::VTKObjectFactory::New(meshIn, this->Cache);
   if (!vmeshIn)
   {
     SENSEI_ERROR("Conversion from " << meshIn->GetClassName() << " to VTK failed")
@@ -146,6 +149,8 @@ bool Calculator::Execute(DataAdaptor* data, DataAdaptor** result)
   vmeshIn->Delete();
   meshIn->Delete();
 
+  this->Cache->ReleaseUnused();
+
   return true;
 }
 
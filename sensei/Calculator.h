@@ -5,6 +5,7 @@
 
 namespace sensei
 {
+namespace SVTKUtils { class VTKObjectCache; }
 
 class SENSEI_EXPORT Calculator : public AnalysisAdaptor
 {
@@ -27,6 +28,7 @@ private:
   std::string MeshName;
   std::string Expression;
   int Association;
+  SVTKUtils::VTKObjectCache *Cache;
 };
 
 }
@@ -348,6 +348,7 @@ senseiNewMacro(CatalystAnalysisAdaptor);
 //-----------------------------------------------------------------------------
 CatalystAnalysisAdaptor::CatalystAnalysisAdaptor()
 {
+  this->Cache = new SVTKUtils::VTKObjectCache;
   this->Initialize();
 }
 
@@ -355,6 +356,7 @@ CatalystAnalysisAdaptor::CatalystAnalysisAdaptor()
 CatalystAnalysisAdaptor::~CatalystAnalysisAdaptor()
 {
   this->Finalize();
+  delete this->Cache;
 }
 
 //-----------------------------------------------------------------------------
@@ -542,8 +544,9 @@ int CatalystAnalysisAdaptor::SelectData(DataAdaptor *dataAdaptor,
           << meshName << "\"")
         }
 
-      // convert from SVTK to VTK
-      vtkDataObject *vdobj = SVTKUtils::VTKObjectFactory::New(dobj);
+      // convert from SVTK to VTK, reusing the geometry and arrays that were
+      // not modified since the last time step
+      vtkDataObject *vdobj = SVTKUtils::VTKObjectFactory::New(dobj, this->Cache);
 
       inDesc->SetGrid(vdobj);
 
@@ -675,6 +678,9 @@ bool CatalystAnalysisAdaptor::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut
           }
         }
       }
+
+    // release the conversions of meshes and arrays not used this time step
+    this->Cache->ReleaseUnused();
     }
 
   return true;
@@ -14,6 +14,7 @@ class svtkDataObject;
 
 namespace sensei
 {
+namespace SVTKUtils { class VTKObjectCache; }
 
 /** An adaptor that invokes ParaView Catalyst. The adaptor is configured via a
  * ParaView generated Catalyst Python script. See AddPythonScriptPipeline.
@@ -83,6 +84,7 @@ private:
   void operator=(const CatalystAnalysisAdaptor&); // Not implemented.
 
   unsigned int Frequency;
+  SVTKUtils::VTKObjectCache *Cache;
 };
 
 }
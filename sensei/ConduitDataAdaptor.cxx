@@ -881,7 +881,7 @@ int ConduitDataAdaptor::ReleaseData()
   this->FieldNames.clear();
   free( this->GlobalBlockDistribution );
 
-  return( 0 );
+  return( this->Superclass::ReleaseData() );
 }
 
 }
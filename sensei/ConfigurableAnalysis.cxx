@@ -3,23 +3,42 @@
 #include <svtkNew.h>
 #include <svtkDataObject.h>
 
+#include <algorithm>
+#include <array>
 #include <vector>
+#include <map>
+#include <limits>
+#include <memory>
 #include <fstream>
 #include <sstream>
 #include <cstdio>
+#include <cstdlib>
 #include <errno.h>
 
 #include "ConfigurableAnalysis.h"
 #include "senseiConfig.h"
 #include "Error.h"
 #include "Profiler.h"
+#include "DataAdaptor.h"
 #include "SVTKUtils.h"
 #include "XMLUtils.h"
 #include "STLUtils.h"
 #include "DataRequirements.h"
+#include "Trigger.h"
+#include "Scheduler.h"
 
 #include "Autocorrelation.h"
 #include "Histogram.h"
+#include "DescriptiveStatistics.h"
+#include "Quantiles.h"
+#include "ParticleDeposition.h"
+#include "RayCastRenderer.h"
+#include "ConnectedComponents.h"
+#include "ParticleAdvection.h"
+#include "TemporalStatistics.h"
+#include "Downsample.h"
+#include "HZOrderWriter.h"
+#include "ReplayAnalysisAdaptor.h"
 #ifdef ENABLE_VTK_IO
 #include "VTKPosthocIO.h"
 #ifdef ENABLE_VTK_MPI
@@ -68,6 +87,8 @@
 
 using AnalysisAdaptorPtr = svtkSmartPointer<sensei::AnalysisAdaptor>;
 using AnalysisAdaptorVector = std::vector<AnalysisAdaptorPtr>;
+using TriggerPtr = std::shared_ptr<sensei::Trigger>;
+using TriggerVector = std::vector<TriggerPtr>;
 
 namespace sensei
 {
@@ -94,6 +115,8 @@ struct ConfigurableAnalysis::InternalsType
   // a status message indicating success/failure is printed
   // by rank 0
   int AddHistogram(pugi::xml_node node);
+  int AddStatistics(pugi::xml_node node);
+  int AddQuantiles(pugi::xml_node node);
   int AddVTKmContour(pugi::xml_node node);
   int AddVTKmVolumeReduction(pugi::xml_node node);
   int AddVTKmCDF(pugi::xml_node node);
@@ -109,12 +132,55 @@ struct ConfigurableAnalysis::InternalsType
   int AddPythonAnalysis(pugi::xml_node node);
   int AddSliceExtract(pugi::xml_node node);
   int AddCalculator(pugi::xml_node node);
+  int AddParticleDeposition(pugi::xml_node node);
+  int AddRayCastRenderer(pugi::xml_node node);
+  int AddConnectedComponents(pugi::xml_node node);
+  int AddParticleAdvection(pugi::xml_node node);
+  int AddTemporalStatistics(pugi::xml_node node);
+  int AddDownsample(pugi::xml_node node);
+  int AddHZOrderWriter(pugi::xml_node node);
+  int AddReplay(pugi::xml_node node);
+
+  // creates and initializes a trigger from xml. a status message
+  // is printed by rank 0
+  int AddTrigger(pugi::xml_node node);
+
+  // associates the trigger named in the node's trigger attribute, if
+  // any, with the analyses added since nAnalyses were present
+  int SetTrigger(pugi::xml_node node, size_t nAnalyses);
+
+  // registers the analyses added since nAnalyses were present with the
+  // scheduler using the priority given in the node's priority attribute
+  int SetPriority(pugi::xml_node node, size_t nAnalyses);
+
+  // records the name given to the output of the analyses added since
+  // nAnalyses were present, and the named output, if any, that they take as
+  // input in place of the simulation's data
+  int SetInput(pugi::xml_node node, size_t nAnalyses);
 
 public:
   // list of all analyses. api calls are forwareded to each
   // analysis in the list
   AnalysisAdaptorVector Analyses;
 
+  // the trigger gating each analysis, indexed in the same order as
+  // Analyses. null if the analysis runs every time step. a trigger may be
+  // shared by several analyses, it is evaluated only once per time step.
+  TriggerVector AnalysisTriggers;
+
+  // the triggers, by name
+  std::map<std::string, TriggerPtr> Triggers;
+
+  // the name of the output of each analysis, and the name of the output
+  // each analysis takes as input, indexed in the same order as Analyses.
+  // empty if the output is not used or the input is the simulation's data.
+  std::vector<std::string> AnalysisOutputs;
+  std::vector<std::string> AnalysisInputs;
+
+  // selects the analyses that run each time step when an in situ time
+  // budget is set. analyses are registered in the same order as Analyses.
+  Scheduler InSituScheduler;
+
   // special analyses. these apear in the above list, however
   // they require special treatment which is simplified by
   // storing an additional pointer.
@@ -186,12 +252,17 @@ int ConfigurableAnalysis::InternalsType::AddHistogram(pugi::xml_node node)
   std::string array = node.attribute("array").value();
   int bins = node.attribute("bins").as_int(10);
   std::string fileName = node.attribute("file").value();
+  long memoryBudget = node.attribute("memory_budget").as_llong(0);
+  int asynchronous = node.attribute("asynchronous").as_int(0);
 
   auto histogram = svtkSmartPointer<Histogram>::New();
 
   if (this->Comm != MPI_COMM_NULL)
     histogram->SetCommunicator(this->Comm);
 
+  histogram->SetMemoryBudget(memoryBudget);
+  histogram->SetAsynchronous(asynchronous);
+
   this->TimeInitialization(histogram, [&]() {
       histogram->Initialize(bins, mesh, association, array, fileName);
       return 0;
@@ -206,6 +277,95 @@ int ConfigurableAnalysis::InternalsType::AddHistogram(pugi::xml_node node)
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddStatistics(pugi::xml_node node)
+{
+  DataRequirements req;
+  if (req.Initialize(node))
+    {
+    SENSEI_ERROR("Failed to initialize DescriptiveStatistics.")
+    return -1;
+    }
+
+  std::string fileName = node.attribute("file").value();
+  int nThreads = node.attribute("n_threads").as_int(1);
+  int verbose = node.attribute("verbose").as_int(0);
+
+  auto stats = svtkSmartPointer<DescriptiveStatistics>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    stats->SetCommunicator(this->Comm);
+
+  stats->SetVerbose(verbose);
+
+  this->TimeInitialization(stats, [&]() {
+      stats->SetDataRequirements(req);
+      stats->SetFileName(fileName);
+      stats->SetNumberOfThreads(nThreads);
+      return 0;
+    });
+  this->Analyses.push_back(stats.GetPointer());
+
+  SENSEI_STATUS("Configured statistics using " << nThreads
+    << " threads writing output to " << (fileName.empty() ? "cout" : "file"))
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddQuantiles(pugi::xml_node node)
+{
+  if (XMLUtils::RequireAttribute(node, "mesh") || XMLUtils::RequireAttribute(node, "array"))
+    {
+    SENSEI_ERROR("Failed to initialize Quantiles");
+    return -1;
+    }
+
+  int association = 0;
+  std::string assocStr = node.attribute("association").as_string("point");
+  if (SVTKUtils::GetAssociation(assocStr, association))
+    {
+    SENSEI_ERROR("Failed to initialize Quantiles");
+    return -1;
+    }
+
+  std::string mesh = node.attribute("mesh").value();
+  std::string array = node.attribute("array").value();
+  int quantiles = node.attribute("quantiles").as_int(11);
+  double compression = node.attribute("compression").as_double(100.0);
+  std::string fileName = node.attribute("file").value();
+
+  // values at which to report the CDF
+  std::vector<double> thresholds;
+  pugi::xml_node thresholdsNode = node.child("thresholds");
+  if (thresholdsNode && XMLUtils::ParseNumeric(thresholdsNode, thresholds))
+    {
+    SENSEI_ERROR("Failed to parse the thresholds")
+    return -1;
+    }
+
+  auto analysis = svtkSmartPointer<Quantiles>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    analysis->SetCommunicator(this->Comm);
+
+  this->TimeInitialization(analysis, [&]() {
+      analysis->Initialize(mesh, association, array, quantiles,
+        compression, fileName);
+      analysis->SetThresholds(thresholds);
+      return 0;
+    });
+  this->Analyses.push_back(analysis.GetPointer());
+
+  SENSEI_STATUS("Configured quantiles with " << quantiles
+    << " quantiles, " << thresholds.size() << " thresholds and compression "
+    << compression << " on " << assocStr
+    << " data array \"" << array << "\" on mesh \"" << mesh
+    << "\" writing output to " << (fileName.empty() ? "cout" : "file"))
+
+  return 0;
+}
+
 // --------------------------------------------------------------------------
 int ConfigurableAnalysis::InternalsType::AddVTKmContour(pugi::xml_node node)
 {
@@ -844,12 +1004,31 @@ int ConfigurableAnalysis::InternalsType::AddAutoCorrelation(pugi::xml_node node)
   int window = node.attribute("window").as_int(10);
   int kMax = node.attribute("k-max").as_int(3);
   int numThreads = node.attribute("n-threads").as_int(1);
+  long memoryBudget = node.attribute("memory-budget").as_llong(0);
+  long stateMemoryBudget = node.attribute("state-memory-budget").as_llong(0);
+  pugi::xml_attribute stateStorageAttr = node.attribute("state-storage-path");
+  int asynchronous = node.attribute("asynchronous").as_int(0);
+
+  // blocks are spilled to files only under a state memory budget. there is
+  // no safe default location for them other than TMPDIR
+  if ((stateMemoryBudget > 0) && !stateStorageAttr && !getenv("TMPDIR"))
+    {
+    SENSEI_ERROR("Failed to initialize Autocorrelation. state-storage-path"
+      " is required with state-memory-budget when TMPDIR is not set")
+    return -1;
+    }
 
   auto adaptor = svtkSmartPointer<Autocorrelation>::New();
 
   if (this->Comm != MPI_COMM_NULL)
     adaptor->SetCommunicator(this->Comm);
 
+  adaptor->SetMemoryBudget(memoryBudget);
+  adaptor->SetStateMemoryBudget(stateMemoryBudget);
+  if (stateStorageAttr)
+    adaptor->SetStateStoragePath(stateStorageAttr.value());
+  adaptor->SetAsynchronous(asynchronous);
+
   this->TimeInitialization(adaptor, [&]() {
     adaptor->Initialize(window, meshName, assoc, arrayName, kMax);
     return 0;
@@ -865,6 +1044,524 @@ int ConfigurableAnalysis::InternalsType::AddAutoCorrelation(pugi::xml_node node)
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddParticleDeposition(pugi::xml_node node)
+{
+  DataRequirements req;
+  std::string meshName;
+  if (req.Initialize(node) || req.GetRequiredMesh(0, meshName))
+    {
+    SENSEI_ERROR("Failed to initialize ParticleDeposition. A mesh is required.")
+    return -1;
+    }
+
+  std::vector<std::string> arrays;
+  req.GetRequiredArrays(meshName, svtkDataObject::POINT, arrays);
+
+  std::string kernelStr = node.attribute("kernel").as_string("cic");
+  int kernel = 0;
+  if (ParticleDeposition::GetKernel(kernelStr, kernel))
+    {
+    SENSEI_ERROR("Failed to initialize ParticleDeposition")
+    return -1;
+    }
+
+  std::array<int,3> res{{64, 64, 64}};
+  pugi::xml_node resNode = node.child("resolution");
+  if (resNode && XMLUtils::ParseNumeric(resNode, res))
+    {
+    SENSEI_ERROR("Failed to parse the resolution")
+    return -1;
+    }
+
+  std::array<double,6> bounds{{0.0, 1.0, 0.0, 1.0, 0.0, 1.0}};
+  pugi::xml_node boundsNode = node.child("bounds");
+  if (boundsNode && XMLUtils::ParseNumeric(boundsNode, bounds))
+    {
+    SENSEI_ERROR("Failed to parse the bounds")
+    return -1;
+    }
+
+  std::string outputMesh = node.attribute("output_mesh").as_string("deposition");
+  int nThreads = node.attribute("n_threads").as_int(1);
+
+  auto adaptor = svtkSmartPointer<ParticleDeposition>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    adaptor->SetCommunicator(this->Comm);
+
+  if (this->TimeInitialization(adaptor, [&]() {
+      adaptor->SetMeshName(meshName);
+      adaptor->SetArrays(arrays);
+      adaptor->SetOutputMeshName(outputMesh);
+      adaptor->SetNumberOfThreads(nThreads);
+      return adaptor->SetKernel(kernel) || adaptor->SetResolution(res) ||
+        (boundsNode && adaptor->SetBounds(bounds));
+    }))
+    return -1;
+
+  this->Analyses.push_back(adaptor.GetPointer());
+
+  SENSEI_STATUS("Configured ParticleDeposition of " << arrays.size()
+    << " arrays from mesh \"" << meshName << "\" onto a " << res[0] << "x"
+    << res[1] << "x" << res[2] << " grid using the " << kernelStr
+    << " kernel and " << nThreads << " threads")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddRayCastRenderer(pugi::xml_node node)
+{
+  if (XMLUtils::RequireAttribute(node, "mesh") || XMLUtils::RequireAttribute(node, "array"))
+    {
+    SENSEI_ERROR("Failed to initialize RayCastRenderer");
+    return -1;
+    }
+
+  std::string meshName = node.attribute("mesh").value();
+  std::string arrayName = node.attribute("array").value();
+
+  std::string assocStr = node.attribute("association").as_string("point");
+  int assoc = 0;
+  if (SVTKUtils::GetAssociation(assocStr, assoc))
+    {
+    SENSEI_ERROR("Failed to initialize RayCastRenderer");
+    return -1;
+    }
+
+  std::string modeStr = node.attribute("mode").as_string("volume");
+  int mode = 0;
+  if (RayCastRenderer::GetMode(modeStr, mode))
+    {
+    SENSEI_ERROR("Failed to initialize RayCastRenderer");
+    return -1;
+    }
+
+  std::array<int,2> size{{512, 512}};
+  pugi::xml_node sizeNode = node.child("image_size");
+  if (sizeNode && XMLUtils::ParseNumeric(sizeNode, size))
+    {
+    SENSEI_ERROR("Failed to parse the image size")
+    return -1;
+    }
+
+  std::array<double,2> range{{0.0, 0.0}};
+  pugi::xml_node rangeNode = node.child("scalar_range");
+  if (rangeNode && XMLUtils::ParseNumeric(rangeNode, range))
+    {
+    SENSEI_ERROR("Failed to parse the scalar range")
+    return -1;
+    }
+
+  std::array<double,9> camera{{0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0}};
+  pugi::xml_node cameraNode = node.child("camera");
+  if (cameraNode && XMLUtils::ParseNumeric(cameraNode, camera))
+    {
+    SENSEI_ERROR("Failed to parse the camera")
+    return -1;
+    }
+
+  std::array<double,3> background{{0.0, 0.0, 0.0}};
+  pugi::xml_node bgNode = node.child("background");
+  if (bgNode && XMLUtils::ParseNumeric(bgNode, background))
+    {
+    SENSEI_ERROR("Failed to parse the background color")
+    return -1;
+    }
+
+  std::string cameraConfig = node.child("camera_config").text().as_string();
+  std::string filePrefix = node.attribute("file").as_string("render");
+  int radix = node.attribute("radix").as_int(2);
+  int nThreads = node.attribute("n_threads").as_int(1);
+  double opacity = node.attribute("opacity").as_double(1.0);
+  double isoValue = node.attribute("value").as_double(0.0);
+  int sliceAxis = node.attribute("slice_axis").as_int(2);
+  double slicePos = node.attribute("slice_position").as_double(0.0);
+  double sampleDist = node.attribute("sample_distance").as_double(0.0);
+  double viewAngle = node.attribute("view_angle").as_double(30.0);
+
+  auto adaptor = svtkSmartPointer<RayCastRenderer>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    adaptor->SetCommunicator(this->Comm);
+
+  if (this->TimeInitialization(adaptor, [&]() {
+      adaptor->SetMeshName(meshName);
+      adaptor->SetArrayName(arrayName);
+      adaptor->SetAssociation(assoc);
+      adaptor->SetOpacity(opacity);
+      adaptor->SetIsoValue(isoValue);
+      adaptor->SetSampleDistance(sampleDist);
+      adaptor->SetViewAngle(viewAngle);
+      adaptor->SetBackground(background);
+      adaptor->SetNumberOfThreads(nThreads);
+      adaptor->SetFilePrefix(filePrefix);
+
+      if (rangeNode)
+        adaptor->SetScalarRange(range[0], range[1]);
+
+      if (cameraNode)
+        adaptor->SetCamera({{camera[0], camera[1], camera[2]}},
+          {{camera[3], camera[4], camera[5]}}, {{camera[6], camera[7], camera[8]}});
+
+      return adaptor->SetMode(mode) || adaptor->SetRadix(radix) ||
+        adaptor->SetImageSize(size[0], size[1]) ||
+        adaptor->SetSlice(sliceAxis, slicePos) ||
+        (!cameraConfig.empty() && adaptor->SetCameraConfig(cameraConfig));
+    }))
+    return -1;
+
+  this->Analyses.push_back(adaptor.GetPointer());
+
+  SENSEI_STATUS("Configured RayCastRenderer " << modeStr << " rendering of "
+    << assocStr << " data array \"" << arrayName << "\" on mesh \""
+    << meshName << "\" " << size[0] << "x" << size[1] << " radix " << radix
+    << " writing to " << filePrefix)
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddConnectedComponents(pugi::xml_node node)
+{
+  if (XMLUtils::RequireAttribute(node, "mesh") || XMLUtils::RequireAttribute(node, "array"))
+    {
+    SENSEI_ERROR("Failed to initialize ConnectedComponents");
+    return -1;
+    }
+
+  std::string meshName = node.attribute("mesh").value();
+  std::string arrayName = node.attribute("array").value();
+
+  std::string assocStr = node.attribute("association").as_string("point");
+  int assoc = 0;
+  if (SVTKUtils::GetAssociation(assocStr, assoc))
+    {
+    SENSEI_ERROR("Failed to initialize ConnectedComponents");
+    return -1;
+    }
+
+  // a comma or space separated list of additional arrays to integrate
+  std::vector<std::string> integrated;
+  std::string intStr = node.attribute("integrate").as_string("");
+  const char *delims = ", \t\n";
+  size_t curr = intStr.find_first_not_of(delims);
+  while (curr != std::string::npos)
+    {
+    size_t next = intStr.find_first_of(delims, curr);
+    integrated.push_back(intStr.substr(curr, next - curr));
+    curr = intStr.find_first_not_of(delims, next);
+    }
+
+  double lower = node.attribute("lower").as_double(0.0);
+  double upper = node.attribute("upper").as_double(std::numeric_limits<double>::max());
+  long minSize = node.attribute("min_size").as_llong(1);
+  std::string fileName = node.attribute("file").value();
+  int nThreads = node.attribute("n_threads").as_int(1);
+
+  auto adaptor = svtkSmartPointer<ConnectedComponents>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    adaptor->SetCommunicator(this->Comm);
+
+  if (this->TimeInitialization(adaptor, [&]() {
+      adaptor->SetMeshName(meshName);
+      adaptor->SetArrayName(arrayName);
+      adaptor->SetIntegratedArrays(integrated);
+      adaptor->SetMinimumSize(minSize);
+      adaptor->SetFileName(fileName);
+      adaptor->SetNumberOfThreads(nThreads);
+      return adaptor->SetAssociation(assoc) || adaptor->SetThreshold(lower, upper);
+    }))
+    return -1;
+
+  this->Analyses.push_back(adaptor.GetPointer());
+
+  SENSEI_STATUS("Configured ConnectedComponents of " << assocStr
+    << " data array \"" << arrayName << "\" on mesh \"" << meshName
+    << "\" in [" << lower << ", " << upper << "] using " << nThreads
+    << " threads")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddParticleAdvection(pugi::xml_node node)
+{
+  if (XMLUtils::RequireAttribute(node, "mesh") || XMLUtils::RequireAttribute(node, "array"))
+    {
+    SENSEI_ERROR("Failed to initialize ParticleAdvection");
+    return -1;
+    }
+
+  std::string meshName = node.attribute("mesh").value();
+  std::string arrayName = node.attribute("array").value();
+
+  std::string assocStr = node.attribute("association").as_string("point");
+  int assoc = 0;
+  if (SVTKUtils::GetAssociation(assocStr, assoc))
+    {
+    SENSEI_ERROR("Failed to initialize ParticleAdvection");
+    return -1;
+    }
+
+  std::string modeStr = node.attribute("mode").as_string("streamline");
+  int mode = 0;
+  if (ParticleAdvection::GetMode(modeStr, mode))
+    {
+    SENSEI_ERROR("Failed to initialize ParticleAdvection");
+    return -1;
+    }
+
+  std::string integStr = node.attribute("integrator").as_string("rk4");
+  int integrator = 0;
+  if (ParticleAdvection::GetIntegrator(integStr, integrator))
+    {
+    SENSEI_ERROR("Failed to initialize ParticleAdvection");
+    return -1;
+    }
+
+  // seeds are given either explicitly or on a lattice
+  std::vector<double> seeds;
+  pugi::xml_node seedsNode = node.child("seeds");
+  if (seedsNode && XMLUtils::ParseNumeric(seedsNode, seeds))
+    {
+    SENSEI_ERROR("Failed to parse the seeds")
+    return -1;
+    }
+
+  std::array<double,6> seedBox{{0.0, 1.0, 0.0, 1.0, 0.0, 1.0}};
+  pugi::xml_node seedBoxNode = node.child("seed_box");
+  if (seedBoxNode && XMLUtils::ParseNumeric(seedBoxNode, seedBox))
+    {
+    SENSEI_ERROR("Failed to parse the seed box")
+    return -1;
+    }
+
+  std::array<int,3> seedRes{{1, 1, 1}};
+  pugi::xml_node seedResNode = node.child("seed_resolution");
+  if (seedResNode && XMLUtils::ParseNumeric(seedResNode, seedRes))
+    {
+    SENSEI_ERROR("Failed to parse the seed resolution")
+    return -1;
+    }
+
+  if (!seedsNode && !seedBoxNode)
+    {
+    SENSEI_ERROR("ParticleAdvection requires either seeds or a seed_box")
+    return -1;
+    }
+
+  double stepSize = node.attribute("step_size").as_double(0.01);
+  long maxSteps = node.attribute("max_steps").as_llong(1000);
+  double terminalSpeed = node.attribute("terminal_speed").as_double(1e-12);
+  std::string outputMesh = node.attribute("output_mesh").as_string("streamlines");
+  int nThreads = node.attribute("n_threads").as_int(1);
+
+  auto adaptor = svtkSmartPointer<ParticleAdvection>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    adaptor->SetCommunicator(this->Comm);
+
+  if (this->TimeInitialization(adaptor, [&]() {
+      adaptor->SetMeshName(meshName);
+      adaptor->SetArrayName(arrayName);
+      adaptor->SetMaximumNumberOfSteps(maxSteps);
+      adaptor->SetTerminalSpeed(terminalSpeed);
+      adaptor->SetOutputMeshName(outputMesh);
+      adaptor->SetNumberOfThreads(nThreads);
+      return adaptor->SetAssociation(assoc) || adaptor->SetMode(mode) ||
+        adaptor->SetIntegrator(integrator) || adaptor->SetStepSize(stepSize) ||
+        (seedsNode ? adaptor->SetSeeds(seeds) : adaptor->SetSeeds(seedBox, seedRes));
+    }))
+    return -1;
+
+  this->Analyses.push_back(adaptor.GetPointer());
+
+  SENSEI_STATUS("Configured ParticleAdvection " << modeStr << "s of "
+    << assocStr << " data array \"" << arrayName << "\" on mesh \""
+    << meshName << "\" using " << integStr << " with step size " << stepSize
+    << " and " << nThreads << " threads")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddTemporalStatistics(pugi::xml_node node)
+{
+  DataRequirements req;
+  if (req.Initialize(node) || req.Empty())
+    {
+    SENSEI_ERROR("Failed to initialize TemporalStatistics. At least one"
+      " mesh and array must be selected")
+    return -1;
+    }
+
+  int interval = node.attribute("interval").as_int(1);
+  int reset = node.attribute("reset").as_int(1);
+  double decay = node.attribute("decay").as_double(0.0);
+  int compensated = node.attribute("compensated").as_int(0);
+  int nThreads = node.attribute("n_threads").as_int(1);
+
+  auto stats = svtkSmartPointer<TemporalStatistics>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    stats->SetCommunicator(this->Comm);
+
+  if (this->TimeInitialization(stats, [&]() {
+      stats->SetDataRequirements(req);
+      stats->SetInterval(interval);
+      stats->SetReset(reset);
+      stats->SetCompensated(compensated);
+      stats->SetNumberOfThreads(nThreads);
+      return stats->SetDecay(decay);
+    }))
+    return -1;
+
+  this->Analyses.push_back(stats.GetPointer());
+
+  SENSEI_STATUS("Configured TemporalStatistics every " << interval
+    << " steps " << (decay > 0.0 ? "exponentially weighted" : "uniformly weighted")
+    << (compensated ? " with compensation" : "") << " using " << nThreads
+    << " threads")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddDownsample(pugi::xml_node node)
+{
+  DataRequirements req;
+  if (req.Initialize(node) || req.Empty())
+    {
+    SENSEI_ERROR("Failed to initialize Downsample. At least one"
+      " mesh and array must be selected")
+    return -1;
+    }
+
+  // a single factor applies to all axes
+  std::vector<int> factor;
+  std::istringstream iss(node.attribute("factor").as_string("2"));
+  for (int f; iss >> f;)
+    factor.push_back(f);
+
+  if (factor.size() == 1)
+    factor.resize(3, factor[0]);
+
+  if (factor.size() != 3)
+    {
+    SENSEI_ERROR("Failed to initialize Downsample. The factor must have"
+      " 1 or 3 values")
+    return -1;
+    }
+
+  std::string modeName = node.attribute("mode").as_string("stride");
+  int maxLevel = node.attribute("max_level").as_int(-1);
+  int nThreads = node.attribute("n_threads").as_int(1);
+
+  int mode = Downsample::MODE_STRIDE;
+  if (Downsample::GetMode(modeName, mode))
+    return -1;
+
+  auto downsample = svtkSmartPointer<Downsample>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    downsample->SetCommunicator(this->Comm);
+
+  if (this->TimeInitialization(downsample, [&]() {
+      downsample->SetDataRequirements(req);
+      downsample->SetMaximumLevel(maxLevel);
+      downsample->SetNumberOfThreads(nThreads);
+      return downsample->SetMode(mode) ||
+        downsample->SetFactor(factor[0], factor[1], factor[2]);
+    }))
+    return -1;
+
+  this->Analyses.push_back(downsample.GetPointer());
+
+  SENSEI_STATUS("Configured Downsample " << modeName << " by " << factor[0]
+    << " " << factor[1] << " " << factor[2] << " max_level " << maxLevel
+    << " using " << nThreads << " threads")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddHZOrderWriter(pugi::xml_node node)
+{
+  DataRequirements req;
+  if (req.Initialize(node) || req.Empty())
+    {
+    SENSEI_ERROR("Failed to initialize HZOrderWriter. At least one"
+      " mesh and array must be selected")
+    return -1;
+    }
+
+  std::string outputDir = node.attribute("output_dir").as_string("./");
+  std::string fileName = node.attribute("file_name").as_string("data");
+  int chunkBits = node.attribute("chunk_bits").as_int(16);
+  int nAggregators = node.attribute("n_aggregators").as_int(0);
+
+  auto writer = svtkSmartPointer<HZOrderWriter>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    writer->SetCommunicator(this->Comm);
+
+  if (this->TimeInitialization(writer, [&]() {
+      writer->SetDataRequirements(req);
+      writer->SetOutputDir(outputDir);
+      writer->SetFileName(fileName);
+      writer->SetNumberOfAggregators(nAggregators);
+      return writer->SetChunkBits(chunkBits);
+    }))
+    return -1;
+
+  this->Analyses.push_back(writer.GetPointer());
+
+  SENSEI_STATUS("Configured HZOrderWriter writing to " << outputDir
+    << " with chunks of 2^" << chunkBits << " samples and "
+    << nAggregators << " aggregators")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddReplay(pugi::xml_node node)
+{
+  // with no requirements everything is recorded
+  DataRequirements req;
+  if (req.Initialize(node))
+    {
+    SENSEI_ERROR("Failed to initialize ReplayAnalysisAdaptor")
+    return -1;
+    }
+
+  std::string outputDir = node.attribute("output_dir").as_string("./");
+  std::string fileName = node.attribute("file_name").as_string("recording");
+  long nSteps = node.attribute("n_steps").as_llong(0);
+
+  auto recorder = svtkSmartPointer<ReplayAnalysisAdaptor>::New();
+
+  if (this->Comm != MPI_COMM_NULL)
+    recorder->SetCommunicator(this->Comm);
+
+  if (this->TimeInitialization(recorder, [&]() {
+      recorder->SetOutputDir(outputDir);
+      recorder->SetFileName(fileName);
+      recorder->SetNumberOfSteps(nSteps);
+      return recorder->SetDataRequirements(req);
+    }))
+    return -1;
+
+  this->Analyses.push_back(recorder.GetPointer());
+
+  SENSEI_STATUS("Configured ReplayAnalysisAdaptor recording to "
+    << outputDir << "/" << fileName << " n_steps " << nSteps)
+
+  return 0;
+}
+
 // --------------------------------------------------------------------------
 int ConfigurableAnalysis::InternalsType::AddPosthocIO(pugi::xml_node node)
 {
@@ -887,6 +1584,7 @@ int ConfigurableAnalysis::InternalsType::AddPosthocIO(pugi::xml_node node)
   std::string ghostArrayName = node.attribute("ghost_array_name").as_string("");
   int verbose = node.attribute("verbose").as_int(0);
   unsigned int frequency = node.attribute("frequency").as_uint(0);
+  long memoryBudget = node.attribute("memory_budget").as_llong(0);
 
   auto adaptor = svtkSmartPointer<VTKPosthocIO>::New();
 
@@ -896,6 +1594,7 @@ int ConfigurableAnalysis::InternalsType::AddPosthocIO(pugi::xml_node node)
   adaptor->SetGhostArrayName(ghostArrayName);
   adaptor->SetVerbose(verbose);
   adaptor->SetFrequency(frequency);
+  adaptor->SetMemoryBudget(memoryBudget);
 
   if (adaptor->SetOutputDir(outputDir) || adaptor->SetMode(mode) ||
     adaptor->SetWriter(writer) || adaptor->SetDataRequirements(req))
@@ -1183,6 +1882,119 @@ int ConfigurableAnalysis::InternalsType::AddCalculator(pugi::xml_node node)
 #endif
 }
 
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::AddTrigger(pugi::xml_node node)
+{
+  TriggerPtr trigger = std::make_shared<Trigger>();
+  if (trigger->Initialize(node))
+    return -1;
+
+  const std::string &name = trigger->GetName();
+  if (this->Triggers.count(name))
+    {
+    SENSEI_ERROR("Duplicate trigger named \"" << name << "\"")
+    return -1;
+    }
+
+  this->Triggers[name] = trigger;
+
+  SENSEI_STATUS("Configured " << trigger->GetTypeName() << " trigger \""
+    << name << "\"")
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::SetTrigger(pugi::xml_node node,
+  size_t nAnalyses)
+{
+  TriggerPtr trigger;
+
+  if (node.attribute("trigger"))
+    {
+    std::string name = node.attribute("trigger").value();
+
+    auto it = this->Triggers.find(name);
+    if (it == this->Triggers.end())
+      {
+      SENSEI_ERROR("No trigger named \"" << name << "\"")
+      return -1;
+      }
+
+    trigger = it->second;
+
+    // adaptors such as Catalyst and Libsim are shared by all of the
+    // elements that configure them, and are only added once
+    if (this->Analyses.size() == nAnalyses)
+      SENSEI_WARNING("Trigger \"" << name << "\" ignored for the \""
+        << node.attribute("type").value() << "\" analysis. The trigger"
+        " must be set on the first element configuring it")
+    }
+
+  this->AnalysisTriggers.resize(this->Analyses.size(), trigger);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::SetPriority(pugi::xml_node node,
+  size_t nAnalyses)
+{
+  int priority = 1;
+
+  pugi::xml_attribute attr = node.attribute("priority");
+  if (attr)
+    {
+    std::string val = attr.value();
+    priority = val == "critical" ? int(Scheduler::CRITICAL) : attr.as_int(-1);
+    if (priority < 0)
+      {
+      SENSEI_ERROR("Invalid priority \"" << val << "\". Use \"critical\""
+        " or a non-negative integer")
+      return -1;
+      }
+    }
+
+  size_t nAdded = this->Analyses.size() - nAnalyses;
+  for (size_t i = 0; i < nAdded; ++i)
+    this->InSituScheduler.AddTask(priority);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int ConfigurableAnalysis::InternalsType::SetInput(pugi::xml_node node,
+  size_t nAnalyses)
+{
+  std::string output = node.attribute("name").value();
+  std::string input = node.attribute("input").value();
+
+  if (!input.empty() && (std::find(this->AnalysisOutputs.begin(),
+    this->AnalysisOutputs.end(), input) == this->AnalysisOutputs.end()))
+    {
+    SENSEI_ERROR("No analysis named \"" << input << "\". The input must"
+      " name an analysis configured before this one")
+    return -1;
+    }
+
+  if (!output.empty() && (std::find(this->AnalysisOutputs.begin(),
+    this->AnalysisOutputs.end(), output) != this->AnalysisOutputs.end()))
+    {
+    SENSEI_ERROR("The name \"" << output << "\" is already in use")
+    return -1;
+    }
+
+  if ((this->Analyses.size() == nAnalyses) && !(output.empty() && input.empty()))
+    SENSEI_WARNING("The name and input of the \""
+      << node.attribute("type").value() << "\" analysis are ignored. They"
+      " must be set on the first element configuring it")
+
+  this->AnalysisOutputs.resize(this->Analyses.size(), output);
+  this->AnalysisInputs.resize(this->Analyses.size(), input);
+
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 senseiNewMacro(ConfigurableAnalysis);
 
@@ -1241,6 +2053,25 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
 {
   TimeEvent<128> event("ConfigurableAnalysis::Initialize");
 
+  // create the triggers that analyses reference by name
+  for (pugi::xml_node node = root.child("trigger");
+    node; node = node.next_sibling("trigger"))
+    {
+    if (this->Internals->AddTrigger(node))
+      {
+      SENSEI_ERROR("Failed to add trigger")
+      MPI_Abort(this->GetCommunicator(), -1);
+      }
+    }
+
+  // configure the in situ time budget
+  pugi::xml_node schedNode = root.child("scheduler");
+  if (schedNode && this->Internals->InSituScheduler.Initialize(schedNode))
+    {
+    SENSEI_ERROR("Failed to initialize the scheduler")
+    MPI_Abort(this->GetCommunicator(), -1);
+    }
+
   // create and configure analysis adaptors
   for (pugi::xml_node node = root.child("analysis");
     node; node = node.next_sibling("analysis"))
@@ -1248,9 +2079,21 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
     if (!node.attribute("enabled").as_int(0))
       continue;
 
+    size_t nAnalyses = this->Internals->Analyses.size();
+
     std::string type = node.attribute("type").value();
     if (!(((type == "histogram") && !this->Internals->AddHistogram(node))
+      || ((type == "statistics") && !this->Internals->AddStatistics(node))
+      || ((type == "quantiles") && !this->Internals->AddQuantiles(node))
       || ((type == "autocorrelation") && !this->Internals->AddAutoCorrelation(node))
+      || ((type == "particle_deposition") && !this->Internals->AddParticleDeposition(node))
+      || ((type == "renderer") && !this->Internals->AddRayCastRenderer(node))
+      || ((type == "connected_components") && !this->Internals->AddConnectedComponents(node))
+      || ((type == "particle_advection") && !this->Internals->AddParticleAdvection(node))
+      || ((type == "temporal_statistics") && !this->Internals->AddTemporalStatistics(node))
+      || ((type == "downsample") && !this->Internals->AddDownsample(node))
+      || ((type == "hz_order") && !this->Internals->AddHZOrderWriter(node))
+      || ((type == "replay") && !this->Internals->AddReplay(node))
       || ((type == "adios1") && !this->Internals->AddAdios1(node))
       || ((type == "adios2") && !this->Internals->AddAdios2(node))
       || ((type == "ascent") && !this->Internals->AddAscent(node))
@@ -1264,7 +2107,10 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
       || ((type == "cdf") && !this->Internals->AddVTKmCDF(node))
       || ((type == "python") && !this->Internals->AddPythonAnalysis(node))
       || ((type == "SliceExtract") && !this->Internals->AddSliceExtract(node))
-      || ((type == "calculator") && !this->Internals->AddCalculator(node))))
+      || ((type == "calculator") && !this->Internals->AddCalculator(node)))
+      || this->Internals->SetTrigger(node, nAnalyses)
+      || this->Internals->SetPriority(node, nAnalyses)
+      || this->Internals->SetInput(node, nAnalyses))
       {
       SENSEI_ERROR("Failed to add \"" << type << "\" analysis")
       MPI_Abort(this->GetCommunicator(), -1);
@@ -1278,10 +2124,16 @@ int ConfigurableAnalysis::Initialize(const pugi::xml_node &root)
     if (!node.attribute("enabled").as_int(0))
       continue;
 
+    size_t nAnalyses = this->Internals->Analyses.size();
+
     std::string type = node.attribute("type").value();
     if (!(((type == "adios1") && !this->Internals->AddAdios1(node))
       || ((type == "adios2") && !this->Internals->AddAdios2(node))
-      || ((type == "hdf5") && !this->Internals->AddHDF5(node))))
+      || ((type == "hdf5") && !this->Internals->AddHDF5(node))
+      || ((type == "replay") && !this->Internals->AddReplay(node)))
+      || this->Internals->SetTrigger(node, nAnalyses)
+      || this->Internals->SetPriority(node, nAnalyses)
+      || this->Internals->SetInput(node, nAnalyses))
       {
       SENSEI_ERROR("Failed to add \"" << type << "\" transport")
       MPI_Abort(this->GetCommunicator(), -1);
@@ -1296,17 +2148,93 @@ bool ConfigurableAnalysis::Execute(DataAdaptor* data, DataAdaptor** dataOut)
 {
   // Currently, we'll assume that only 1 analysis adaptor will generate
   // non-null result to report as the result; in case of multiple, the last one wins.
-  // In future, we can extend the XML
-  // specification to support identifying which analysis generates results of
-  // interest and potentially how results are propagated between analyses.
+  // Analyses given a name in the XML keep their result for the analyses
+  // that name it as their input. These results live until the end of the
+  // time step.
 
   TimeEvent<128> event("ConfigurableAnalysis::Execute");
 
+  MPI_Comm comm = this->GetCommunicator();
+
+  // every trigger is evaluated exactly once per time step, before any
+  // analysis runs. this keeps the state of triggers that depend on the
+  // previous step current when the analyses they gate are skipped or
+  // deferred, and lets analyses sharing a trigger share the cost. the
+  // triggers are visited in name order, which is the same on all ranks,
+  // since evaluation is collective.
+  std::map<Trigger*, bool> fired;
+
+  for (auto &it : this->Internals->Triggers)
+    {
+    Trigger *trigger = it.second.get();
+
+    bool fire = false;
+    if (trigger->Evaluate(comm, data, fire))
+      {
+      SENSEI_ERROR("Failed to evaluate trigger \"" << it.first << "\"")
+      MPI_Abort(comm, -1);
+      }
+
+    fired[trigger] = fire;
+
+    if (this->GetVerbose())
+      SENSEI_STATUS("Step " << data->GetDataTimeStep() << " trigger \""
+        << it.first << "\" " << (fire ? "fired" : "did not fire")
+        << " value " << trigger->GetLastValue())
+    }
+
+  // the results of the named analyses that ran during this time step
+  std::map<std::string, DataAdaptor*> outputs;
+
+  // when a time budget is set select the analyses that run this step
+  Scheduler &scheduler = this->Internals->InSituScheduler;
+
+  // when telemetry is enabled the wall time of each analysis is reported.
+  // every analysis is reported each step so that the records line up
+  // across ranks
+  bool telemetry = Profiler::TelemetryEnabled();
+  std::vector<double> times;
+  if (telemetry)
+    times.resize(this->Internals->Analyses.size(), 0.0);
+
+  std::vector<int> run;
+  if (scheduler.Enabled() && scheduler.Schedule(comm, run))
+    {
+    SENSEI_ERROR("Failed to schedule the analyses")
+    MPI_Abort(comm, -1);
+    }
+
   int ai = 0;
   AnalysisAdaptorVector::iterator iter = this->Internals->Analyses.begin();
   AnalysisAdaptorVector::iterator end = this->Internals->Analyses.end();
   for (; iter != end; ++iter, ++ai)
     {
+    if (!run.empty() && !run[ai])
+      {
+      if (this->GetVerbose())
+        SENSEI_STATUS("Step " << data->GetDataTimeStep() << " deferred "
+          << (*iter)->GetClassName() << " cost " << scheduler.GetCost(ai)
+          << " budget " << scheduler.GetLastBudget())
+      continue;
+      }
+
+    // analyses taking the result of another analysis run only when it
+    // produced one this step
+    DataAdaptor *input = data;
+    const std::string &inputName = this->Internals->AnalysisInputs[ai];
+    if (!inputName.empty())
+      {
+      auto it = outputs.find(inputName);
+      if (it == outputs.end())
+        continue;
+
+      input = it->second;
+      }
+
+    Trigger *trigger = this->Internals->AnalysisTriggers[ai].get();
+    if (trigger && !fired[trigger])
+      continue;
+
     const char* analysisName = nullptr;
     bool logEnabled = Profiler::Enabled();
     if (logEnabled)
@@ -1315,16 +2243,55 @@ bool ConfigurableAnalysis::Execute(DataAdaptor* data, DataAdaptor** dataOut)
       Profiler::StartEvent(analysisName);
       }
 
-    if (!(*iter)->Execute(data, dataOut))
+    double t0 = MPI_Wtime();
+
+    const std::string &outputName = this->Internals->AnalysisOutputs[ai];
+    DataAdaptor *output = nullptr;
+
+    if (!(*iter)->Execute(input, outputName.empty() ? dataOut : &output))
       {
       SENSEI_ERROR("Failed to execute " << (*iter)->GetClassName())
       MPI_Abort(this->GetCommunicator(), -1);
       }
 
+    if (output)
+      outputs[outputName] = output;
+
+    double dt = MPI_Wtime() - t0;
+    scheduler.SetCost(ai, dt);
+
+    if (telemetry)
+      times[ai] = dt;
+
     if (logEnabled)
       Profiler::EndEvent(analysisName);
     }
 
+  scheduler.EndStep();
+
+  for (auto &it : outputs)
+    {
+    it.second->ReleaseData();
+    it.second->Delete();
+    }
+
+  if (telemetry)
+    {
+    int nAnalyses = times.size();
+    for (int i = 0; i < nAnalyses; ++i)
+      {
+      std::ostringstream name;
+      name << this->Internals->Analyses[i]->GetClassName() << "::" << i;
+      Profiler::AddStepTime(name.str(), times[i]);
+      }
+
+    // a failure to report the telemetry does not affect the analyses. all
+    // ranks fail together so the next step stays in sync
+    if (Profiler::EndStep(comm, data->GetDataTimeStep(), data->GetDataTime()))
+      SENSEI_ERROR("Failed to report the telemetry of step "
+        << data->GetDataTimeStep())
+    }
+
   return true;
 }
 
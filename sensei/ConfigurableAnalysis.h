@@ -19,17 +19,29 @@ namespace sensei
  * | Class | Description |
  * | ----- | ----------- |
  * | sensei::Histogram | Computes histograms |
+ * | sensei::DescriptiveStatistics | Computes mean, variance, skewness, kurtosis, min and max |
+ * | sensei::Quantiles | Computes approximate quantiles and CDFs |
  * | sensei::ADIOS2AnalysisAdaptor | The write side of the ADIOS2 transport |
  * | sensei::HDF5AnalysisAdaptor | The write side of the HDF5 transport |
  * | sensei::AscentAnalysisAdaptor | Processes simulation data using Ascent |
  * | sensei::CatalystAnalysisAdaptor | Processes simulation data using ParaView Catalyst |
  * | sensei::LibsimAnalysisAdaptor | Processes simulation data using VisIt Libsim |
  * | sensei::Autocorrelation | Compute autocorrelation of simulation data over time |
+ * | sensei::ParticleDeposition | Deposits particles and their attributes onto a uniform grid |
+ * | sensei::RayCastRenderer | Renders image and rectilinear meshes with sort-last compositing |
+ * | sensei::ConnectedComponents | Finds and reports statistics of thresholded features on image and rectilinear meshes |
+ * | sensei::ParticleAdvection | Traces streamlines and pathlines through vector fields on image and rectilinear meshes |
  * | sensei::VTKPosthocIO | Writes simulation data to disk in a SVTK format |
  * | sensei::VTKAmrWriter | Writes simulation data to disk in a SVTK format |
  * | sensei::PythonAnalysis | Invokes user provided Pythons scripts that process simulation data |
  * | sensei::SliceExtract | Computes planar slices and iso-surfaces on simulation data |
  *
+ * Each analysis may be gated by a sensei::Trigger, declared in a <trigger>
+ * element and referenced by name in the analysis' trigger attribute. The
+ * analysis only runs on time steps where the trigger fires. When an in situ
+ * time budget is given in a <scheduler> element, a sensei::Scheduler uses
+ * the measured cost and the priority attribute of each analysis to select
+ * the analyses that run each time step.
  */
 class SENSEI_EXPORT ConfigurableAnalysis : public AnalysisAdaptor
 {
@@ -1,5 +1,6 @@
 #include "ConfigurableInTransitDataAdaptor.h"
 #include "InTransitDataAdaptor.h"
+#include "ReplayDataAdaptor.h"
 #include "XMLUtils.h"
 #include "Error.h"
 #ifdef ENABLE_ADIOS1
@@ -113,6 +114,10 @@ int ConfigurableInTransitDataAdaptor::Initialize(pugi::xml_node &root)
     adaptor = HDF5DataAdaptor::New();
 #endif
     }
+  else if (type == "replay")
+    {
+    adaptor = ReplayDataAdaptor::New();
+    }
   else if (type == "libis")
     {
 #ifndef ENABLE_LIBIS
@@ -391,6 +396,8 @@ int ConfigurableInTransitDataAdaptor::ReleaseData()
     return -1;
     }
 
+  this->Superclass::ReleaseData();
+
   return this->Internals->Adaptor->ReleaseData();
 }
 
@@ -0,0 +1,1244 @@
+#include "ConnectedComponents.h"
+#include "DataAdaptor.h"
+#include "SVTKDataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkLongArray.h>
+#include <svtkPointData.h>
+#include <svtkRectilinearGrid.h>
+#include <svtkSmartPointer.h>
+#include <svtkUnsignedCharArray.h>
+
+#include <sdiy/master.hpp>
+#include <sdiy/assigner.hpp>
+#include <sdiy/decomposition.hpp>
+#include <sdiy/link.hpp>
+#include <sdiy/reduce.hpp>
+#include <sdiy/partners/merge.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// the layout of the partial statistics of a label. these are merged
+// onto rank 0 as arrays of doubles.
+enum
+{
+  REC_LABEL = 0,    // the global label
+  REC_FIRST = 1,    // the linear index of the first element
+  REC_SIZE = 2,     // the number of elements
+  REC_VOLUME = 3,   // the volume of the elements
+  REC_CENTER = 4,   // the volume weighted sum of the centers, 3 values
+  REC_BOUNDS = 7,   // the bounding box, 6 values
+  REC_MIN = 13,     // the smallest value of the thresholded array
+  REC_MAX = 14,     // the largest value of the thresholded array
+  REC_INTEGRAL = 15 // the integral of each array component
+};
+
+// **************************************************************************
+/** a block of an image or rectilinear mesh. Elements, cells or points, are
+ * addressed by their index in the global index space of the mesh.
+ */
+struct Block
+{
+  Block() : Ext{{0,-1, 0,-1, 0,-1}}, Ghosts(nullptr), Gid(0),
+    NumLabels(0), LabelOffset(0) {}
+
+  long Size(int d) const { return this->Ext[2*d+1] - this->Ext[2*d] + 1; }
+
+  long Size() const { return this->Size(0)*this->Size(1)*this->Size(2); }
+
+  bool Inside(long i, long j, long k) const
+  {
+    return (i >= this->Ext[0]) && (i <= this->Ext[1]) &&
+      (j >= this->Ext[2]) && (j <= this->Ext[3]) &&
+      (k >= this->Ext[4]) && (k <= this->Ext[5]);
+  }
+
+  long Index(long i, long j, long k) const
+  {
+    return ((k - this->Ext[4])*this->Size(1) + j - this->Ext[2])*
+      this->Size(0) + i - this->Ext[0];
+  }
+
+  std::array<long,6> Ext;                // the element extent, inclusive
+  std::array<std::vector<double>,3> Lo;  // the lower bound of each element
+  std::array<std::vector<double>,3> Hi;  // the upper bound of each element
+  std::array<std::vector<double>,3> Mid; // the center of each element
+  std::array<std::vector<double>,3> Wid; // the width of each element
+  std::vector<double> Values;            // the thresholded array
+  std::vector<std::vector<double>> Arrays; // the integrated arrays
+  const unsigned char *Ghosts;
+  long Gid;                              // the global block id
+  std::vector<long> Labels;              // the local label, -1 if not in a feature
+  std::vector<char> Counted;             // set if included in the statistics
+  long NumLabels;
+  long LabelOffset;                      // the global label of local label 0
+  std::vector<long> Equivalences;        // pairs of equivalent global labels
+};
+
+// **************************************************************************
+/// the block passed to sdiy, data is exchanged between ranks
+struct ExchangeBlock
+{
+  static void *create() { return new ExchangeBlock; }
+  static void destroy(void *b) { delete static_cast<ExchangeBlock*>(b); }
+};
+
+// **************************************************************************
+void ToDouble(svtkDataArray *da, std::vector<double> &out)
+{
+  long nTups = da->GetNumberOfTuples();
+  int nComps = da->GetNumberOfComponents();
+  long nVals = nTups*nComps;
+
+  out.resize(nVals);
+
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+      if (aosDa)
+        {
+        const SVTK_TT *pDa = aosDa->GetPointer(0);
+        std::copy(pDa, pDa + nVals, out.begin());
+        }
+      else
+        {
+        for (long i = 0; i < nTups; ++i)
+          for (int j = 0; j < nComps; ++j)
+            out[i*nComps + j] = da->GetComponent(i, j);
+        }
+    );
+    }
+}
+
+// **************************************************************************
+/** set up the element coordinates of one axis of a block from the point
+ * coordinates. A direction with a single point has a single element of
+ * unit width. Points are given the mean width of the cells next to them.
+ */
+void InitializeAxis(const std::vector<double> &x, bool cellData,
+  Block &b, int d)
+{
+  long nPts = x.size();
+  long nElem = (cellData && (nPts > 1)) ? nPts - 1 : nPts;
+
+  b.Lo[d].resize(nElem);
+  b.Hi[d].resize(nElem);
+  b.Mid[d].resize(nElem);
+  b.Wid[d].resize(nElem);
+
+  for (long i = 0; i < nElem; ++i)
+    {
+    if (nPts < 2)
+      {
+      b.Lo[d][i] = x[i];
+      b.Hi[d][i] = x[i];
+      b.Mid[d][i] = x[i];
+      b.Wid[d][i] = 1.0;
+      }
+    else if (cellData)
+      {
+      b.Lo[d][i] = x[i];
+      b.Hi[d][i] = x[i+1];
+      b.Mid[d][i] = 0.5*(x[i] + x[i+1]);
+      b.Wid[d][i] = x[i+1] - x[i];
+      }
+    else
+      {
+      b.Lo[d][i] = x[i];
+      b.Hi[d][i] = x[i];
+      b.Mid[d][i] = x[i];
+      b.Wid[d][i] = i == 0 ? x[1] - x[0] : (i == nPts - 1 ?
+        x[i] - x[i-1] : 0.5*(x[i+1] - x[i-1]));
+      }
+    }
+
+  if (cellData && (nPts > 1))
+    b.Ext[2*d+1] -= 1;
+}
+
+// **************************************************************************
+/// intersect two extents. returns non-zero if they do not overlap
+int Intersect(const std::array<long,6> &a, const std::array<long,6> &b,
+  std::array<long,6> &c)
+{
+  for (int d = 0; d < 3; ++d)
+    {
+    c[2*d] = std::max(a[2*d], b[2*d]);
+    c[2*d+1] = std::min(a[2*d+1], b[2*d+1]);
+    if (c[2*d+1] < c[2*d])
+      return -1;
+    }
+  return 0;
+}
+
+// **************************************************************************
+std::array<long,6> Grow(const std::array<long,6> &ext)
+{
+  return std::array<long,6>{{ext[0] - 1, ext[1] + 1,
+    ext[2] - 1, ext[3] + 1, ext[4] - 1, ext[5] + 1}};
+}
+
+// **************************************************************************
+long Find(std::vector<long> &parent, long q)
+{
+  while (parent[q] != q)
+    {
+    parent[q] = parent[parent[q]];
+    q = parent[q];
+    }
+  return q;
+}
+
+// **************************************************************************
+void Union(std::vector<long> &parent, long p, long q)
+{
+  p = ::Find(parent, p);
+  q = ::Find(parent, q);
+
+  if (p < q)
+    parent[q] = p;
+  else if (q < p)
+    parent[p] = q;
+}
+
+// **************************************************************************
+/** label the elements of a block where lower <= value <= upper. Elements
+ * sharing a face are merged using union-find and the labels are numbered
+ * from 0 in the order of their first element.
+ */
+void Label(Block &b, double lower, double upper)
+{
+  long nx = b.Size(0);
+  long nxy = nx*b.Size(1);
+  long n = b.Size();
+
+  std::vector<long> parent(n, -1);
+
+  for (long k = 0, q = 0; k < b.Size(2); ++k)
+    {
+    for (long j = 0; j < b.Size(1); ++j)
+      {
+      for (long i = 0; i < nx; ++i, ++q)
+        {
+        double v = b.Values[q];
+        if ((v < lower) || (v > upper))
+          continue;
+
+        parent[q] = q;
+
+        if ((i > 0) && (parent[q-1] >= 0))
+          ::Union(parent, q, q-1);
+
+        if ((j > 0) && (parent[q-nx] >= 0))
+          ::Union(parent, q, q-nx);
+
+        if ((k > 0) && (parent[q-nxy] >= 0))
+          ::Union(parent, q, q-nxy);
+        }
+      }
+    }
+
+  // the root of each tree is its first element, hence roots are found
+  // before the elements that point to them
+  b.Labels.assign(n, -1);
+  b.NumLabels = 0;
+  for (long q = 0; q < n; ++q)
+    {
+    if (parent[q] < 0)
+      continue;
+
+    long r = ::Find(parent, q);
+    b.Labels[q] = r == q ? b.NumLabels++ : b.Labels[r];
+    }
+
+  b.Counted.resize(n);
+  for (long q = 0; q < n; ++q)
+    b.Counted[q] = (b.Labels[q] >= 0) && !(b.Ghosts && b.Ghosts[q]);
+}
+
+// **************************************************************************
+/** append the elements of the block in the given extent that are part of
+ * a feature to the buffer. each is sent as the destination block, its
+ * index, its global label, the source block, and its ghost flag.
+ */
+void Pack(const Block &b, const std::array<long,6> &ext, long dest,
+  std::vector<long> &buf)
+{
+  for (long k = ext[4]; k <= ext[5]; ++k)
+    {
+    for (long j = ext[2]; j <= ext[3]; ++j)
+      {
+      for (long i = ext[0]; i <= ext[1]; ++i)
+        {
+        long q = b.Index(i, j, k);
+        if (b.Labels[q] < 0)
+          continue;
+
+        long rec[7] = {dest, i, j, k, b.LabelOffset + b.Labels[q], b.Gid,
+          (b.Ghosts && b.Ghosts[q]) ? 1l : 0l};
+
+        buf.insert(buf.end(), rec, rec + 7);
+        }
+      }
+    }
+}
+
+// **************************************************************************
+/** merge the labels of elements received from a neighbor with those of the
+ * local elements at the same index or sharing a face. Where two blocks both
+ * own the same element, which happens with points where blocks meet, it is
+ * counted only by the block with the smaller id.
+ */
+void Unpack(const std::vector<long> &buf, std::vector<Block> &blocks,
+  long blockOffset)
+{
+  static const long dirs[7][3] = {{0,0,0}, {-1,0,0}, {1,0,0},
+    {0,-1,0}, {0,1,0}, {0,0,-1}, {0,0,1}};
+
+  size_t n = buf.size();
+  for (size_t r = 0; r < n; r += 7)
+    {
+    Block &b = blocks[buf[r] - blockOffset];
+
+    long label = buf[r+4];
+    long srcGid = buf[r+5];
+    bool srcGhost = buf[r+6];
+
+    for (int d = 0; d < 7; ++d)
+      {
+      long i = buf[r+1] + dirs[d][0];
+      long j = buf[r+2] + dirs[d][1];
+      long k = buf[r+3] + dirs[d][2];
+
+      if (!b.Inside(i, j, k))
+        continue;
+
+      long q = b.Index(i, j, k);
+      if (b.Labels[q] < 0)
+        continue;
+
+      b.Equivalences.push_back(b.LabelOffset + b.Labels[q]);
+      b.Equivalences.push_back(label);
+
+      if ((d == 0) && !srcGhost && b.Counted[q] && (srcGid < b.Gid))
+        b.Counted[q] = 0;
+      }
+    }
+}
+
+// **************************************************************************
+/** compute the partial statistics of each label of the block and append
+ * them to the records. whole is the element extent of the mesh, used to
+ * number the elements.
+ */
+void Accumulate(const Block &b, const std::array<long,6> &whole,
+  const std::vector<int> &nComps, int nRec, std::vector<double> &recs)
+{
+  long nLabels = b.NumLabels;
+  std::vector<double> stats(nLabels*nRec, 0.0);
+
+  for (long l = 0; l < nLabels; ++l)
+    {
+    double *s = stats.data() + l*nRec;
+    s[REC_LABEL] = b.LabelOffset + l;
+    s[REC_FIRST] = std::numeric_limits<double>::max();
+    for (int d = 0; d < 3; ++d)
+      {
+      s[REC_BOUNDS + 2*d] = std::numeric_limits<double>::max();
+      s[REC_BOUNDS + 2*d + 1] = std::numeric_limits<double>::lowest();
+      }
+    s[REC_MIN] = std::numeric_limits<double>::max();
+    s[REC_MAX] = std::numeric_limits<double>::lowest();
+    }
+
+  long wnx = whole[1] - whole[0] + 1;
+  long wny = whole[3] - whole[2] + 1;
+  int nArrays = b.Arrays.size();
+
+  for (long k = b.Ext[4], q = 0; k <= b.Ext[5]; ++k)
+    {
+    long kk = k - b.Ext[4];
+    for (long j = b.Ext[2]; j <= b.Ext[3]; ++j)
+      {
+      long jj = j - b.Ext[2];
+      for (long i = b.Ext[0]; i <= b.Ext[1]; ++i, ++q)
+        {
+        if (!b.Counted[q])
+          continue;
+
+        long ii = i - b.Ext[0];
+        double *s = stats.data() + b.Labels[q]*nRec;
+
+        double first = ((k - whole[4])*wny + j - whole[2])*wnx + i - whole[0];
+        double vol = b.Wid[0][ii]*b.Wid[1][jj]*b.Wid[2][kk];
+        double v = b.Values[q];
+
+        s[REC_FIRST] = std::min(s[REC_FIRST], first);
+        s[REC_SIZE] += 1.0;
+        s[REC_VOLUME] += vol;
+        s[REC_CENTER] += vol*b.Mid[0][ii];
+        s[REC_CENTER + 1] += vol*b.Mid[1][jj];
+        s[REC_CENTER + 2] += vol*b.Mid[2][kk];
+        s[REC_BOUNDS] = std::min(s[REC_BOUNDS], b.Lo[0][ii]);
+        s[REC_BOUNDS + 1] = std::max(s[REC_BOUNDS + 1], b.Hi[0][ii]);
+        s[REC_BOUNDS + 2] = std::min(s[REC_BOUNDS + 2], b.Lo[1][jj]);
+        s[REC_BOUNDS + 3] = std::max(s[REC_BOUNDS + 3], b.Hi[1][jj]);
+        s[REC_BOUNDS + 4] = std::min(s[REC_BOUNDS + 4], b.Lo[2][kk]);
+        s[REC_BOUNDS + 5] = std::max(s[REC_BOUNDS + 5], b.Hi[2][kk]);
+        s[REC_MIN] = std::min(s[REC_MIN], v);
+        s[REC_MAX] = std::max(s[REC_MAX], v);
+
+        for (int a = 0, f = REC_INTEGRAL; a < nArrays; ++a)
+          {
+          const double *pa = b.Arrays[a].data() + q*nComps[a];
+          for (int c = 0; c < nComps[a]; ++c, ++f)
+            s[f] += vol*pa[c];
+          }
+        }
+      }
+    }
+
+  // labels made only of ghost or shared elements still take part in the
+  // merge through the equivalences but have nothing to report
+  for (long l = 0; l < nLabels; ++l)
+    {
+    const double *s = stats.data() + l*nRec;
+    if (s[REC_SIZE] > 0.0)
+      recs.insert(recs.end(), s, s + nRec);
+    }
+}
+
+// **************************************************************************
+/// merge the partial statistics of a label into those of a feature
+void Merge(const double *s, int nRec, double *f)
+{
+  f[REC_FIRST] = std::min(f[REC_FIRST], s[REC_FIRST]);
+
+  for (int i = REC_SIZE; i < REC_BOUNDS; ++i)
+    f[i] += s[i];
+
+  for (int d = 0; d < 3; ++d)
+    {
+    f[REC_BOUNDS + 2*d] = std::min(f[REC_BOUNDS + 2*d], s[REC_BOUNDS + 2*d]);
+    f[REC_BOUNDS + 2*d + 1] = std::max(f[REC_BOUNDS + 2*d + 1], s[REC_BOUNDS + 2*d + 1]);
+    }
+
+  f[REC_MIN] = std::min(f[REC_MIN], s[REC_MIN]);
+  f[REC_MAX] = std::max(f[REC_MAX], s[REC_MAX]);
+
+  for (int i = REC_INTEGRAL; i < nRec; ++i)
+    f[i] += s[i];
+}
+
+// **************************************************************************
+/** order the labels of each equivalence and drop the duplicates. Elements
+ * along a block face are touched by several elements of the neighbor, most
+ * with the same pair of labels.
+ */
+void Deduplicate(std::vector<long> &eqs)
+{
+  size_t nEqs = eqs.size()/2;
+
+  std::vector<std::pair<long,long>> pairs;
+  pairs.reserve(nEqs);
+
+  for (size_t i = 0; i < nEqs; ++i)
+    {
+    long a = eqs[2*i];
+    long b = eqs[2*i + 1];
+    if (a != b)
+      pairs.emplace_back(std::min(a, b), std::max(a, b));
+    }
+
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  eqs.resize(2*pairs.size());
+  for (size_t i = 0; i < pairs.size(); ++i)
+    {
+    eqs[2*i] = pairs[i].first;
+    eqs[2*i + 1] = pairs[i].second;
+    }
+}
+
+// **************************************************************************
+/** resolve the equivalences known so far and merge the records of
+ * equivalent labels. The merged record takes the smallest of the labels and
+ * the equivalences are replaced by one pair per merged label, linking it to
+ * that label, so that records and equivalences still to come resolve to it.
+ */
+void MergeFeatures(std::vector<double> &recs, std::vector<long> &eqs, int nRec)
+{
+  // union-find over the labels that appear in the equivalences, indexed
+  // from 0 in the order of the labels
+  std::vector<long> labels(eqs);
+  std::sort(labels.begin(), labels.end());
+  labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+  auto index = [&labels](long label) -> long
+    {
+    auto it = std::lower_bound(labels.begin(), labels.end(), label);
+    return ((it != labels.end()) && (*it == label)) ? it - labels.begin() : -1;
+    };
+
+  long nLabels = labels.size();
+  std::vector<long> parent(nLabels);
+  for (long l = 0; l < nLabels; ++l)
+    parent[l] = l;
+
+  size_t nEqs = eqs.size();
+  for (size_t i = 0; i < nEqs; i += 2)
+    ::Union(parent, index(eqs[i]), index(eqs[i+1]));
+
+  // merge the records by the label of their root
+  std::map<long, std::vector<double>> merged;
+  size_t nVals = recs.size();
+  for (size_t i = 0; i < nVals; i += nRec)
+    {
+    const double *s = recs.data() + i;
+    long label = s[REC_LABEL];
+    long l = index(label);
+    long root = l < 0 ? label : labels[::Find(parent, l)];
+
+    auto it = merged.find(root);
+    if (it == merged.end())
+      {
+      std::vector<double> &f = merged[root];
+      f.assign(s, s + nRec);
+      f[REC_LABEL] = root;
+      }
+    else
+      {
+      ::Merge(s, nRec, it->second.data());
+      }
+    }
+
+  recs.clear();
+  for (auto &m : merged)
+    recs.insert(recs.end(), m.second.begin(), m.second.end());
+
+  // the labels are ordered and the root is the smallest label of a set,
+  // so the pairs stay ordered and unique
+  eqs.clear();
+  for (long l = 0; l < nLabels; ++l)
+    {
+    long r = ::Find(parent, l);
+    if (r != l)
+      {
+      eqs.push_back(labels[r]);
+      eqs.push_back(labels[l]);
+      }
+    }
+}
+
+// **************************************************************************
+/// the records and equivalences of a rank, merged in a reduction
+struct MergeBlock
+{
+  static void *create() { return new MergeBlock; }
+  static void destroy(void *b) { delete static_cast<MergeBlock*>(b); }
+
+  std::vector<double> Recs;
+  std::vector<long> Eqs;
+};
+
+// **************************************************************************
+void Write(FILE *file, long step, double time,
+  const std::vector<sensei::ConnectedComponents::Feature> &features)
+{
+  for (const sensei::ConnectedComponents::Feature &f : features)
+    {
+    fprintf(file, "%ld, %0.10g, %ld, %ld, %0.10g, %0.10g, %0.10g, %0.10g, "
+      "%0.10g, %0.10g, %0.10g, %0.10g, %0.10g, %0.10g, %0.10g, %0.10g",
+      step, time, f.Id, f.Size, f.Volume, f.Centroid[0], f.Centroid[1],
+      f.Centroid[2], f.Bounds[0], f.Bounds[1], f.Bounds[2], f.Bounds[3],
+      f.Bounds[4], f.Bounds[5], f.Min, f.Max);
+
+    for (double v : f.Integrals)
+      fprintf(file, ", %0.10g", v);
+
+    fprintf(file, "\n");
+    }
+}
+
+// **************************************************************************
+void WriteHeader(FILE *file, const std::vector<std::string> &columns)
+{
+  fprintf(file, "# step, time, id, size, volume, x, y, z, x0, x1, y0, y1,"
+    " z0, z1, min, max");
+
+  for (const std::string &col : columns)
+    fprintf(file, ", %s", col.c_str());
+
+  fprintf(file, "\n");
+}
+
+// **************************************************************************
+svtkImageData *NewTable(const std::vector<sensei::ConnectedComponents::Feature> &features,
+  const std::vector<std::string> &columns)
+{
+  long nFeatures = features.size();
+  int nCols = columns.size();
+
+  svtkImageData *table = svtkImageData::New();
+  table->SetDimensions(nFeatures, 1, 1);
+
+  svtkLongArray *ids = svtkLongArray::New();
+  ids->SetName("id");
+  ids->SetNumberOfTuples(nFeatures);
+
+  svtkLongArray *sizes = svtkLongArray::New();
+  sizes->SetName("size");
+  sizes->SetNumberOfTuples(nFeatures);
+
+  svtkDoubleArray *vols = svtkDoubleArray::New();
+  vols->SetName("volume");
+  vols->SetNumberOfTuples(nFeatures);
+
+  svtkDoubleArray *cents = svtkDoubleArray::New();
+  cents->SetName("centroid");
+  cents->SetNumberOfComponents(3);
+  cents->SetNumberOfTuples(nFeatures);
+
+  svtkDoubleArray *bounds = svtkDoubleArray::New();
+  bounds->SetName("bounds");
+  bounds->SetNumberOfComponents(6);
+  bounds->SetNumberOfTuples(nFeatures);
+
+  svtkDoubleArray *mins = svtkDoubleArray::New();
+  mins->SetName("min");
+  mins->SetNumberOfTuples(nFeatures);
+
+  svtkDoubleArray *maxs = svtkDoubleArray::New();
+  maxs->SetName("max");
+  maxs->SetNumberOfTuples(nFeatures);
+
+  std::vector<svtkDoubleArray*> ints(nCols);
+  for (int c = 0; c < nCols; ++c)
+    {
+    ints[c] = svtkDoubleArray::New();
+    ints[c]->SetName(columns[c].c_str());
+    ints[c]->SetNumberOfTuples(nFeatures);
+    }
+
+  for (long i = 0; i < nFeatures; ++i)
+    {
+    const sensei::ConnectedComponents::Feature &f = features[i];
+    ids->SetValue(i, f.Id);
+    sizes->SetValue(i, f.Size);
+    vols->SetValue(i, f.Volume);
+    cents->SetTypedTuple(i, f.Centroid.data());
+    bounds->SetTypedTuple(i, f.Bounds.data());
+    mins->SetValue(i, f.Min);
+    maxs->SetValue(i, f.Max);
+    for (int c = 0; c < nCols; ++c)
+      ints[c]->SetValue(i, f.Integrals[c]);
+    }
+
+  svtkPointData *pd = table->GetPointData();
+
+  svtkDataArray *arrays[] = {ids, sizes, vols, cents, bounds, mins, maxs};
+  for (svtkDataArray *da : arrays)
+    {
+    pd->AddArray(da);
+    da->Delete();
+    }
+
+  for (int c = 0; c < nCols; ++c)
+    {
+    pd->AddArray(ints[c]);
+    ints[c]->Delete();
+    }
+
+  return table;
+}
+}
+
+namespace sensei
+{
+
+//----------------------------------------------------------------------------
+senseiNewMacro(ConnectedComponents);
+
+//----------------------------------------------------------------------------
+ConnectedComponents::ConnectedComponents() : Association(svtkDataObject::POINT),
+  Lower(0.0), Upper(std::numeric_limits<double>::max()), MinimumSize(1),
+  NumberOfThreads(1), HeaderWritten(0)
+{
+}
+
+//----------------------------------------------------------------------------
+ConnectedComponents::~ConnectedComponents()
+{
+}
+
+//----------------------------------------------------------------------------
+int ConnectedComponents::SetAssociation(int association)
+{
+  if ((association != svtkDataObject::POINT) &&
+    (association != svtkDataObject::CELL))
+    {
+    SENSEI_ERROR("Invalid association " << association
+      << ". Only point and cell data are supported")
+    return -1;
+    }
+
+  this->Association = association;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ConnectedComponents::SetThreshold(double lower, double upper)
+{
+  if (upper < lower)
+    {
+    SENSEI_ERROR("Invalid threshold [" << lower << ", " << upper << "]")
+    return -1;
+    }
+
+  this->Lower = lower;
+  this->Upper = upper;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool ConnectedComponents::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("ConnectedComponents::Execute");
+
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  MeshMetadataMap mdMap;
+  MeshMetadataPtr mmd;
+  if (mdMap.Initialize(dataIn) || mdMap.GetMeshMetadata(this->MeshName, mmd))
+    {
+    SENSEI_ERROR("Failed to get metadata for mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  // the thresholded array is integrated first followed by the others. the
+  // number of components comes from the metadata so that ranks without
+  // data agree on the layout of the results.
+  std::vector<std::string> arrays(1, this->ArrayName);
+  for (const std::string &name : this->IntegratedArrays)
+    {
+    if (std::find(arrays.begin(), arrays.end(), name) == arrays.end())
+      arrays.push_back(name);
+    }
+
+  int nArrays = arrays.size();
+  std::vector<int> nComps(nArrays);
+  this->ColumnNames.clear();
+  for (int a = 0; a < nArrays; ++a)
+    {
+    auto it = std::find(mmd->ArrayName.begin(), mmd->ArrayName.end(), arrays[a]);
+    if ((it == mmd->ArrayName.end()) ||
+      (mmd->ArrayCentering[it - mmd->ArrayName.begin()] != this->Association))
+      {
+      SENSEI_ERROR("No " << SVTKUtils::GetAttributesName(this->Association)
+        << " data array named \"" << arrays[a] << "\" on mesh \""
+        << this->MeshName << "\"")
+      return false;
+      }
+
+    nComps[a] = mmd->ArrayComponents[it - mmd->ArrayName.begin()];
+
+    if ((a == 0) && (nComps[a] != 1))
+      {
+      SENSEI_ERROR("The thresholded array \"" << arrays[a] << "\" has "
+        << nComps[a] << " components, a single component is required")
+      return false;
+      }
+
+    for (int c = 0; c < nComps[a]; ++c)
+      this->ColumnNames.push_back(nComps[a] == 1 ? arrays[a] :
+        arrays[a] + "_" + std::to_string(c));
+    }
+
+  int nRec = REC_INTEGRAL + this->ColumnNames.size();
+
+  // get the local blocks
+  svtkDataObject *dobj = nullptr;
+  if (dataIn->GetMesh(this->MeshName, false, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  // the ghost arrays are used in place, hold the mesh until done
+  svtkCompositeDataSetPtr mesh;
+  std::vector<Block> blocks;
+  if (dobj)
+    {
+    bool cellData = this->Association == svtkDataObject::CELL;
+
+    if ((cellData && mmd->NumGhostCells && dataIn->AddGhostCellsArray(dobj, this->MeshName)) ||
+      (!cellData && mmd->NumGhostNodes && dataIn->AddGhostNodesArray(dobj, this->MeshName)))
+      {
+      SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add ghost "
+        << (cellData ? "cells" : "nodes"))
+      dobj->Delete();
+      return false;
+      }
+
+    for (int a = 0; a < nArrays; ++a)
+      {
+      if (dataIn->AddArray(dobj, this->MeshName, this->Association, arrays[a]))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add "
+          << SVTKUtils::GetAttributesName(this->Association)
+          << " data array \"" << arrays[a] << "\"")
+        dobj->Delete();
+        return false;
+        }
+      }
+
+    // the composite wrapper takes ownership
+    mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+
+    svtkSmartPointer<svtkCompositeDataIterator> iter;
+    iter.TakeReference(mesh->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+      svtkDataSet *ds = dynamic_cast<svtkDataSet*>(iter->GetCurrentDataObject());
+
+      Block b;
+      std::array<std::vector<double>,3> x;
+      int ext[6] = {0, -1, 0, -1, 0, -1};
+      if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+        {
+        double x0[3];
+        double dx[3];
+        im->GetExtent(ext);
+        im->GetOrigin(x0);
+        im->GetSpacing(dx);
+
+        for (int d = 0; d < 3; ++d)
+          {
+          for (int i = ext[2*d]; i <= ext[2*d+1]; ++i)
+            x[d].push_back(x0[d] + i*dx[d]);
+          }
+        }
+      else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+        {
+        rg->GetExtent(ext);
+        ::ToDouble(rg->GetXCoordinates(), x[0]);
+        ::ToDouble(rg->GetYCoordinates(), x[1]);
+        ::ToDouble(rg->GetZCoordinates(), x[2]);
+        }
+      else
+        {
+        SENSEI_ERROR("Block " << iter->GetCurrentFlatIndex() << " of mesh \""
+          << this->MeshName << "\" is a " << (ds ? ds->GetClassName() : "nullptr")
+          << ". Only image and rectilinear meshes are supported")
+        return false;
+        }
+
+      if (x[0].empty() || x[1].empty() || x[2].empty())
+        continue;
+
+      for (int d = 0; d < 3; ++d)
+        {
+        b.Ext[2*d] = ext[2*d];
+        b.Ext[2*d+1] = ext[2*d+1];
+        ::InitializeAxis(x[d], cellData, b, d);
+        }
+
+      svtkDataSetAttributes *atts = ds->GetAttributes(this->Association);
+      for (int a = 0; a < nArrays; ++a)
+        {
+        svtkDataArray *da = atts->GetArray(arrays[a].c_str());
+        if (!da || (da->GetNumberOfComponents() != nComps[a]) ||
+          (da->GetNumberOfTuples() != b.Size()))
+          {
+          SENSEI_ERROR("Block " << iter->GetCurrentFlatIndex() << " of mesh \""
+            << this->MeshName << "\" has no " << nComps[a] << " component"
+            " array named \"" << arrays[a] << "\" with " << b.Size() << " values")
+          return false;
+          }
+
+        b.Arrays.emplace_back();
+        ::ToDouble(da, b.Arrays.back());
+        }
+
+      b.Values = b.Arrays[0];
+
+      svtkUnsignedCharArray *ga = dynamic_cast<svtkUnsignedCharArray*>(
+        atts->GetArray("svtkGhostType"));
+      b.Ghosts = ga ? ga->GetPointer(0) : nullptr;
+
+      blocks.push_back(std::move(b));
+      }
+    }
+
+  int nThreads = std::max(1, this->NumberOfThreads);
+  int nBlocks = blocks.size();
+
+  // run the function on the local blocks, each thread processes every
+  // nThreads'th block
+  auto parallelFor = [&](const std::function<void(Block&)> &func)
+  {
+    auto work = [&](int tid)
+    {
+      for (int i = tid; i < nBlocks; i += nThreads)
+        func(blocks[i]);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int i = 1; i < nThreads; ++i)
+      threads.emplace_back(work, i);
+
+    work(0);
+
+    for (int i = 0; i < nThreads - 1; ++i)
+      threads[i].join();
+  };
+
+  // label the local blocks
+  {
+  TimeEvent<128> mark2("ConnectedComponents::Label");
+  parallelFor([&](Block &b) { ::Label(b, this->Lower, this->Upper); });
+  }
+
+  // number the blocks and labels globally, and share the block extents
+  long localCounts[2] = {nBlocks, 0};
+  for (const Block &b : blocks)
+    localCounts[1] += b.NumLabels;
+
+  std::vector<long> counts(2*nRanks);
+  MPI_Allgather(localCounts, 2, MPI_LONG, counts.data(), 2, MPI_LONG, comm);
+
+  std::vector<int> blockCounts(nRanks);
+  std::vector<int> blockOffsets(nRanks + 1, 0);
+  long labelOffset = 0;
+  long nLabels = 0;
+  for (int r = 0; r < nRanks; ++r)
+    {
+    blockCounts[r] = 6*counts[2*r];
+    blockOffsets[r + 1] = blockOffsets[r] + counts[2*r];
+    if (r == rank)
+      labelOffset = nLabels;
+    nLabels += counts[2*r + 1];
+    }
+
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    blocks[i].Gid = blockOffsets[rank] + i;
+    blocks[i].LabelOffset = labelOffset;
+    labelOffset += blocks[i].NumLabels;
+    }
+
+  std::vector<long> localExts(6*nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    std::copy(blocks[i].Ext.begin(), blocks[i].Ext.end(), localExts.begin() + 6*i);
+
+  std::vector<int> extOffsets(nRanks);
+  for (int r = 0; r < nRanks; ++r)
+    extOffsets[r] = 6*blockOffsets[r];
+
+  long nGlobalBlocks = blockOffsets[nRanks];
+  std::vector<std::array<long,6>> exts(nGlobalBlocks);
+  MPI_Allgatherv(localExts.data(), 6*nBlocks, MPI_LONG, exts.data(),
+    blockCounts.data(), extOffsets.data(), MPI_LONG, comm);
+
+  if (nGlobalBlocks == 0)
+    {
+    this->LastResult.clear();
+    SENSEI_WARNING("Mesh \"" << this->MeshName << "\" is empty")
+    return true;
+    }
+
+  // the extent of the whole mesh, used to number the elements
+  std::array<long,6> whole = exts[0];
+  for (const std::array<long,6> &ext : exts)
+    {
+    for (int d = 0; d < 3; ++d)
+      {
+      whole[2*d] = std::min(whole[2*d], ext[2*d]);
+      whole[2*d+1] = std::max(whole[2*d+1], ext[2*d+1]);
+      }
+    }
+
+  // send the elements where each local block meets its neighbors. blocks
+  // on this rank are handled directly.
+  {
+  TimeEvent<128> mark2("ConnectedComponents::Exchange");
+
+  std::map<int, std::vector<long>> sendBufs;
+  int owner = 0;
+  for (long gid = 0; gid < nGlobalBlocks; ++gid)
+    {
+    while (gid >= blockOffsets[owner + 1])
+      ++owner;
+
+    std::array<long,6> grown = ::Grow(exts[gid]);
+
+    for (const Block &b : blocks)
+      {
+      std::array<long,6> ovr;
+      if ((gid == b.Gid) || ::Intersect(b.Ext, grown, ovr))
+        continue;
+
+      ::Pack(b, ovr, gid, sendBufs[owner]);
+      }
+    }
+
+  auto sit = sendBufs.find(rank);
+  if (sit != sendBufs.end())
+    {
+    ::Unpack(sit->second, blocks, blockOffsets[rank]);
+    sendBufs.erase(sit);
+    }
+
+  // neighbors are symmetric, a rank sends to every rank it receives from,
+  // even when there is nothing to send
+  sdiy::Master master(comm, 1, -1, &ExchangeBlock::create,
+    &ExchangeBlock::destroy);
+
+  sdiy::ContiguousAssigner assigner(nRanks, nRanks);
+
+  sdiy::Link *link = new sdiy::Link;
+  for (auto &sb : sendBufs)
+    link->add_neighbor(sdiy::BlockID(sb.first, sb.first));
+
+  master.add(rank, new ExchangeBlock, link);
+
+  master.foreach([&](ExchangeBlock *, const sdiy::Master::ProxyWithLink &cp)
+    {
+    for (int i = 0; i < cp.link()->size(); ++i)
+      {
+      sdiy::BlockID dest = cp.link()->target(i);
+      cp.enqueue(dest, sendBufs[dest.gid]);
+      }
+    });
+
+  master.exchange();
+
+  master.foreach([&](ExchangeBlock *, const sdiy::Master::ProxyWithLink &cp)
+    {
+    for (int i = 0; i < cp.link()->size(); ++i)
+      {
+      std::vector<long> buf;
+      cp.dequeue(cp.link()->target(i).gid, buf);
+      ::Unpack(buf, blocks, blockOffsets[rank]);
+      }
+    });
+  }
+
+  // the partial statistics and the equivalences of the local labels
+  sdiy::Master master(comm, 1, -1, &MergeBlock::create, &MergeBlock::destroy);
+
+  MergeBlock *mb = new MergeBlock;
+  master.add(rank, mb, new sdiy::Link);
+
+  {
+  TimeEvent<128> mark2("ConnectedComponents::Accumulate");
+
+  std::vector<std::vector<double>> blockRecs(nBlocks);
+  parallelFor([&](Block &b)
+    {
+    ::Deduplicate(b.Equivalences);
+    ::Accumulate(b, whole, nComps, nRec, blockRecs[&b - blocks.data()]);
+    });
+
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    mb->Recs.insert(mb->Recs.end(), blockRecs[i].begin(), blockRecs[i].end());
+    mb->Eqs.insert(mb->Eqs.end(), blocks[i].Equivalences.begin(),
+      blocks[i].Equivalences.end());
+    }
+  }
+
+  // merge pairwise up a tree onto rank 0. each rank resolves the labels it
+  // knows of before passing on its records, so only one record per feature
+  // and one equivalence per merged label move in each round
+  TimeEvent<128> mark2("ConnectedComponents::Merge");
+
+  sdiy::ContiguousAssigner assigner(nRanks, nRanks);
+  sdiy::RegularDecomposer<sdiy::DiscreteBounds> decomposer(1,
+    sdiy::interval(0, nRanks - 1), nRanks);
+  sdiy::RegularMergePartners partners(decomposer, 2, true);
+
+  sdiy::reduce(master, assigner, partners,
+    [nRec](void *blk, const sdiy::ReduceProxy &rp, const sdiy::RegularMergePartners &)
+    {
+    MergeBlock *b = static_cast<MergeBlock*>(blk);
+
+    for (int i = 0; i < rp.in_link().size(); ++i)
+      {
+      int gid = rp.in_link().target(i).gid;
+      if (gid == rp.gid())
+        continue;
+
+      std::vector<double> recs;
+      std::vector<long> eqs;
+      rp.dequeue(gid, recs);
+      rp.dequeue(gid, eqs);
+
+      b->Recs.insert(b->Recs.end(), recs.begin(), recs.end());
+      b->Eqs.insert(b->Eqs.end(), eqs.begin(), eqs.end());
+      }
+
+    ::MergeFeatures(b->Recs, b->Eqs, nRec);
+
+    if (rp.out_link().size() && (rp.out_link().target(0).gid != rp.gid()))
+      {
+      rp.enqueue(rp.out_link().target(0), b->Recs);
+      rp.enqueue(rp.out_link().target(0), b->Eqs);
+      b->Recs.clear();
+      b->Eqs.clear();
+      }
+    });
+
+  if (rank == 0)
+    {
+    // the records are now one per feature
+    const std::vector<double> &recs = mb->Recs;
+
+    std::vector<const double*> feats;
+    size_t nVals = recs.size();
+    for (size_t i = 0; i < nVals; i += nRec)
+      {
+      if (recs[i + REC_SIZE] >= this->MinimumSize)
+        feats.push_back(recs.data() + i);
+      }
+
+    std::sort(feats.begin(), feats.end(),
+      [](const double *a, const double *b) -> bool
+      { return a[REC_FIRST] < b[REC_FIRST]; });
+
+    long nFeatures = feats.size();
+    this->LastResult.resize(nFeatures);
+    for (long i = 0; i < nFeatures; ++i)
+      {
+      const double *s = feats[i];
+      Feature &f = this->LastResult[i];
+
+      f.Id = i;
+      f.Size = s[REC_SIZE];
+      f.Volume = s[REC_VOLUME];
+      for (int d = 0; d < 3; ++d)
+        f.Centroid[d] = s[REC_VOLUME] > 0.0 ? s[REC_CENTER + d]/s[REC_VOLUME] : 0.0;
+      std::copy(s + REC_BOUNDS, s + REC_BOUNDS + 6, f.Bounds.begin());
+      f.Min = s[REC_MIN];
+      f.Max = s[REC_MAX];
+      f.Integrals.assign(s + REC_INTEGRAL, s + nRec);
+      }
+
+    if (this->WriteResults(dataIn->GetDataTimeStep(), dataIn->GetDataTime()))
+      return false;
+    }
+
+  // pass the results back as a table
+  if (dataOut)
+    {
+    svtkImageData *table = rank == 0 ?
+      ::NewTable(this->LastResult, this->ColumnNames) : nullptr;
+
+    SVTKDataAdaptor *out = SVTKDataAdaptor::New();
+    out->SetCommunicator(comm);
+    out->SetDataObject("features", table);
+    out->SetDataTimeStep(dataIn->GetDataTimeStep());
+    out->SetDataTime(dataIn->GetDataTime());
+
+    if (table)
+      table->Delete();
+
+    *dataOut = out;
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int ConnectedComponents::WriteResults(long step, double time)
+{
+  TimeEvent<128> mark("ConnectedComponents::WriteResults");
+
+  if (this->FileName.empty())
+    {
+    if (!this->HeaderWritten)
+      {
+      ::WriteHeader(stdout, this->ColumnNames);
+      this->HeaderWritten = 1;
+      }
+
+    ::Write(stdout, step, time, this->LastResult);
+    fflush(stdout);
+
+    return 0;
+    }
+
+  FILE *file = fopen(this->FileName.c_str(), this->HeaderWritten ? "a" : "w");
+  if (!file)
+    {
+    char *estr = strerror(errno);
+    SENSEI_ERROR("Failed to open \"" << this->FileName << "\"" << std::endl << estr)
+    return -1;
+    }
+
+  if (!this->HeaderWritten)
+    {
+    ::WriteHeader(file, this->ColumnNames);
+    this->HeaderWritten = 1;
+    }
+
+  ::Write(file, step, time, this->LastResult);
+
+  fclose(file);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ConnectedComponents::GetFeatures(
+  std::vector<ConnectedComponents::Feature> &features)
+{
+  features = this->LastResult;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ConnectedComponents::Finalize()
+{
+  return 0;
+}
+
+}
@@ -0,0 +1,130 @@
+#ifndef sensei_ConnectedComponents_h
+#define sensei_ConnectedComponents_h
+
+#include "AnalysisAdaptor.h"
+
+#include <mpi.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/** Finds features, the connected regions where a scalar lies within a
+ * threshold range, on image and rectilinear meshes and reports statistics
+ * about each of them. Elements, cells or points, are connected when they
+ * share a face in the index space of the mesh.
+ *
+ * Each block is labeled independently using union-find, with a number of
+ * threads processing blocks in parallel. The labels of the elements where
+ * blocks meet, including any ghost layers, are exchanged with the
+ * neighboring blocks in a single sdiy exchange. The resulting equivalences
+ * and the partial statistics of each label are gathered onto MPI rank 0
+ * where the labels are merged into features. Ghost elements, and points
+ * shared with a neighboring block, contribute to the connectivity but are
+ * counted only once in the statistics.
+ *
+ * For each feature the number of elements, the volume, the volume weighted
+ * centroid, the bounding box, the range of the thresholded array, and the
+ * volume integral of each component of each of the arrays are reported.
+ * Features are numbered in the order of the first of their elements in the
+ * index space of the mesh, so that the numbering does not depend on the
+ * decomposition. Results are written to a CSV file or to stdout, and can
+ * optionally be returned through a DataAdaptor as a mesh named "features".
+ * In that mesh, which is a 1D svtkImageData on rank 0, each point is a row
+ * of the table with one point data array per statistic.
+ */
+class SENSEI_EXPORT ConnectedComponents : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static ConnectedComponents *New();
+
+  senseiTypeMacro(ConnectedComponents, AnalysisAdaptor);
+
+  /// set the name of the mesh to process
+  void SetMeshName(const std::string &meshName) { this->MeshName = meshName; }
+
+  /// set the name of the array that is thresholded
+  void SetArrayName(const std::string &arrayName) { this->ArrayName = arrayName; }
+
+  /** set additional arrays to integrate over each feature. The thresholded
+   * array is always integrated.
+   */
+  void SetIntegratedArrays(const std::vector<std::string> &arrays)
+  { this->IntegratedArrays = arrays; }
+
+  /// set svtkDataObject::POINT or svtkDataObject::CELL. the default is POINT
+  int SetAssociation(int association);
+
+  /** set the threshold range. Elements where lower <= value <= upper
+   * belong to a feature. The default is [0, +inf].
+   */
+  int SetThreshold(double lower, double upper);
+
+  /// set the smallest number of elements in a reported feature. the default is 1
+  void SetMinimumSize(long minSize) { this->MinimumSize = minSize; }
+
+  /** Set the name of the CSV file that results are written to. If not set
+   * the results are written to stdout.
+   */
+  void SetFileName(const std::string &fileName) { this->FileName = fileName; }
+
+  /// Set the number of threads used to label local blocks. The default is 1.
+  void SetNumberOfThreads(int nThreads) { this->NumberOfThreads = nThreads; }
+
+  /// find the features for this time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+  /// the statistics of a single feature
+  struct Feature
+  {
+    Feature() : Id(0), Size(0), Volume(0.0), Centroid{{0.0, 0.0, 0.0}},
+      Bounds{{0.0, 0.0, 0.0, 0.0, 0.0, 0.0}}, Min(0.0), Max(0.0) {}
+
+    long Id;                       ///< the feature number
+    long Size;                     ///< the number of elements
+    double Volume;                 ///< the volume of the elements
+    std::array<double,3> Centroid; ///< the volume weighted center
+    std::array<double,6> Bounds;   ///< the bounding box [x0,x1, y0,y1, z0,z1]
+    double Min;                    ///< the smallest value of the thresholded array
+    double Max;                    ///< the largest value of the thresholded array
+    std::vector<double> Integrals; ///< the integral of each array component
+  };
+
+  /** return the features found by the most recent call to Execute. This is
+   * only valid on MPI rank 0.
+   */
+  int GetFeatures(std::vector<ConnectedComponents::Feature> &features);
+
+protected:
+  ConnectedComponents();
+  ~ConnectedComponents();
+
+  ConnectedComponents(const ConnectedComponents&) = delete;
+  void operator=(const ConnectedComponents&) = delete;
+
+  int WriteResults(long step, double time);
+
+private:
+  std::string MeshName;
+  std::string ArrayName;
+  std::vector<std::string> IntegratedArrays;
+  std::vector<std::string> ColumnNames;
+  int Association;
+  double Lower;
+  double Upper;
+  long MinimumSize;
+  std::string FileName;
+  int NumberOfThreads;
+  int HeaderWritten;
+  std::vector<ConnectedComponents::Feature> LastResult;
+};
+
+}
+
+#endif
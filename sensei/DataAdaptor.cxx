@@ -1,13 +1,21 @@
 #include "DataAdaptor.h"
 #include "MeshMetadata.h"
+#include "MPIUtils.h"
 #include "SVTKUtils.h"
 #include "Error.h"
 
 #include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkAbstractArray.h>
+#include <svtkFieldData.h>
+#include <svtkCellData.h>
+#include <svtkPointData.h>
 #include <svtkCompositeDataSet.h>
 #include <svtkObjectFactory.h>
 
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include <utility>
@@ -17,37 +25,79 @@ namespace sensei
 
 struct DataAdaptor::InternalsType
 {
-  InternalsType() : Time(0.0), TimeStep(0) {}
-  ~InternalsType() {}
+  InternalsType() : Time(0.0), TimeStep(0), BlockMesh(nullptr),
+    BlockMeshStructureOnly(true), BlockGhostCells(false),
+    BlockGhostNodes(false) {}
+
+  ~InternalsType() { this->ClearBlockCache(); }
+
+  // release the mesh cached by the default block-at-a-time implementation
+  void ClearBlockCache();
 
   MeshMetadataFlags Flags;
   std::vector<MeshMetadataPtr> Metadata;
   double Time;
   long TimeStep;
+
+  // state of the default block-at-a-time implementation. the local mesh is
+  // fetched with GetMesh and blocks are served from it.
+  svtkDataObject *BlockMesh;
+  SVTKUtils::BlockMap Blocks;
+  std::string BlockMeshName;
+  bool BlockMeshStructureOnly;
+  std::set<std::pair<int, std::string>> BlockArrays;
+  bool BlockGhostCells;
+  bool BlockGhostNodes;
 };
 
 //----------------------------------------------------------------------------
-DataAdaptor::DataAdaptor()
+void DataAdaptor::InternalsType::ClearBlockCache()
+{
+  if (this->BlockMesh)
+    this->BlockMesh->Delete();
+
+  this->BlockMesh = nullptr;
+  this->Blocks.Clear();
+  this->BlockMeshName.clear();
+  this->BlockMeshStructureOnly = true;
+  this->BlockArrays.clear();
+  this->BlockGhostCells = false;
+  this->BlockGhostNodes = false;
+}
+
+//----------------------------------------------------------------------------
+DataAdaptor::DataAdaptor() : Comm(MPI_COMM_NULL)
 {
-  MPI_Comm_dup(MPI_COMM_WORLD, &this->Comm);
   this->Internals = new InternalsType;
 }
 
 //----------------------------------------------------------------------------
 DataAdaptor::~DataAdaptor()
 {
-  MPI_Comm_free(&this->Comm);
+  MPIUtils::ReleaseCommunicator(this->Comm);
   delete this->Internals;
 }
 
 //----------------------------------------------------------------------------
 int DataAdaptor::SetCommunicator(MPI_Comm comm)
 {
-  MPI_Comm_free(&this->Comm);
-  MPI_Comm_dup(comm, &this->Comm);
+  // acquire before releasing so that a shared duplicate survives. adaptors
+  // of the same class share a duplicate
+  MPI_Comm tmp = MPIUtils::AcquireCommunicator(comm, this->GetClassName());
+  MPIUtils::ReleaseCommunicator(this->Comm);
+  this->Comm = tmp;
   return 0;
 }
 
+//----------------------------------------------------------------------------
+MPI_Comm DataAdaptor::GetCommunicator()
+{
+  if (this->Comm == MPI_COMM_NULL)
+    this->Comm = MPIUtils::AcquireCommunicator(MPI_COMM_WORLD,
+      this->GetClassName());
+  return this->Comm;
+}
+
 //----------------------------------------------------------------------------
 double DataAdaptor::GetDataTime()
 {
@@ -57,6 +107,7 @@ double DataAdaptor::GetDataTime()
 //----------------------------------------------------------------------------
 void DataAdaptor::SetDataTime(double time)
 {
+  this->Internals->ClearBlockCache();
   this->Internals->Time = time;
 }
 
@@ -69,6 +120,7 @@ long DataAdaptor::GetDataTimeStep()
 //----------------------------------------------------------------------------
 void DataAdaptor::SetDataTimeStep(long index)
 {
+  this->Internals->ClearBlockCache();
   this->Internals->TimeStep = index;
 }
 
@@ -102,6 +154,174 @@ int DataAdaptor::AddGhostCellsArray(svtkDataObject*, const std::string &)
   return 0;
 }
 
+//----------------------------------------------------------------------------
+int DataAdaptor::GetMeshBlock(const std::string &meshName, long blockId,
+  bool structureOnly, svtkDataObject *&block)
+{
+  block = nullptr;
+
+  // fetch the local mesh, reusing the cached one when possible
+  InternalsType *internals = this->Internals;
+  if (!internals->BlockMesh || (internals->BlockMeshName != meshName) ||
+    (internals->BlockMeshStructureOnly && !structureOnly))
+    {
+    internals->ClearBlockCache();
+
+    if (this->GetMesh(meshName, structureOnly, internals->BlockMesh))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      return -1;
+      }
+
+    internals->Blocks.Initialize(internals->BlockMesh);
+    internals->BlockMeshName = meshName;
+    internals->BlockMeshStructureOnly = structureOnly;
+    }
+
+  svtkDataSet *source = internals->Blocks.GetBlock(blockId);
+  if (!source)
+    {
+    SENSEI_ERROR("No block " << blockId << " in mesh \""
+      << meshName << "\" on this rank")
+    return -1;
+    }
+
+  // arrays are passed by AddArrayToBlock
+  svtkDataSet *ds = source->NewInstance();
+  ds->CopyStructure(source);
+
+  block = ds;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int DataAdaptor::AddArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association,
+  const std::string &arrayName)
+{
+  InternalsType *internals = this->Internals;
+  if (!internals->BlockMesh || (internals->BlockMeshName != meshName))
+    {
+    SENSEI_ERROR("GetMeshBlock must be called before AddArrayToBlock")
+    return -1;
+    }
+
+  std::pair<int, std::string> key(association, arrayName);
+  if (!internals->BlockArrays.count(key))
+    {
+    if (this->AddArray(internals->BlockMesh, meshName, association, arrayName))
+      {
+      SENSEI_ERROR("Failed to add " << SVTKUtils::GetAttributesName(association)
+        << " data array \"" << arrayName << "\" to mesh \"" << meshName << "\"")
+      return -1;
+      }
+    internals->BlockArrays.insert(key);
+    }
+
+  svtkDataSet *source = internals->Blocks.GetBlock(blockId);
+  svtkDataSet *ds = dynamic_cast<svtkDataSet*>(block);
+  svtkAbstractArray *array = nullptr;
+
+  if (!source || !ds || !(array = SVTKUtils::GetAttributes(source,
+    association)->GetAbstractArray(arrayName.c_str())))
+    {
+    SENSEI_ERROR("Failed to get " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" for block " << blockId)
+    return -1;
+    }
+
+  SVTKUtils::GetAttributes(ds, association)->AddArray(array);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int DataAdaptor::AddGhostNodesArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  InternalsType *internals = this->Internals;
+  if (!internals->BlockMesh || (internals->BlockMeshName != meshName))
+    {
+    SENSEI_ERROR("GetMeshBlock must be called before AddGhostNodesArrayToBlock")
+    return -1;
+    }
+
+  if (!internals->BlockGhostNodes)
+    {
+    if (this->AddGhostNodesArray(internals->BlockMesh, meshName))
+      {
+      SENSEI_ERROR("Failed to add ghost nodes to mesh \"" << meshName << "\"")
+      return -1;
+      }
+    internals->BlockGhostNodes = true;
+    }
+
+  svtkDataSet *source = internals->Blocks.GetBlock(blockId);
+  svtkDataSet *ds = dynamic_cast<svtkDataSet*>(block);
+  if (source && ds)
+    {
+    svtkDataArray *ghosts = source->GetPointData()->GetArray("svtkGhostType");
+    if (ghosts)
+      ds->GetPointData()->AddArray(ghosts);
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int DataAdaptor::AddGhostCellsArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  InternalsType *internals = this->Internals;
+  if (!internals->BlockMesh || (internals->BlockMeshName != meshName))
+    {
+    SENSEI_ERROR("GetMeshBlock must be called before AddGhostCellsArrayToBlock")
+    return -1;
+    }
+
+  if (!internals->BlockGhostCells)
+    {
+    if (this->AddGhostCellsArray(internals->BlockMesh, meshName))
+      {
+      SENSEI_ERROR("Failed to add ghost cells to mesh \"" << meshName << "\"")
+      return -1;
+      }
+    internals->BlockGhostCells = true;
+    }
+
+  svtkDataSet *source = internals->Blocks.GetBlock(blockId);
+  svtkDataSet *ds = dynamic_cast<svtkDataSet*>(block);
+  if (source && ds)
+    {
+    svtkDataArray *ghosts = source->GetCellData()->GetArray("svtkGhostType");
+    if (ghosts)
+      ds->GetCellData()->AddArray(ghosts);
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool DataAdaptor::StreamsMeshBlocks(const std::string &)
+{
+  return false;
+}
+
+//----------------------------------------------------------------------------
+int DataAdaptor::ReleaseMeshBlocks()
+{
+  this->Internals->ClearBlockCache();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int DataAdaptor::ReleaseData()
+{
+  this->Internals->ClearBlockCache();
+  return 0;
+}
+
 //----------------------------------------------------------------------------
 void DataAdaptor::PrintSelf(ostream& os, svtkIndent indent)
 {
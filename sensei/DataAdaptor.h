@@ -31,15 +31,20 @@ public:
   void PrintSelf(ostream& os, svtkIndent indent) override;
 
   /** Set the communicator used by the adaptor. The default communicator is a
-   * duplicate of MPI_COMMM_WORLD, giving each adaptor a unique communication
-   * space. Users wishing to override this should set the communicator before
-   * doing anything else. Derived classes should use the communicator returned
-   * by GetCommunicator.
+   * duplicate of MPI_COMMM_WORLD, giving the adaptors a communication space
+   * separate from the simulation's. Duplicates are shared by the adaptors of
+   * the same class set with the same communicator, see
+   * MPIUtils::AcquireCommunicator. Users wishing to override this should set
+   * the communicator before doing anything else. Derived classes should use
+   * the communicator returned by GetCommunicator.
    */
   virtual int SetCommunicator(MPI_Comm comm);
 
-  /// Get the communicator used by the adaptor.
-  MPI_Comm GetCommunicator() { return this->Comm; }
+  /** Get the communicator used by the adaptor. When no communicator was set
+   * the default is duplicated on first use, and that first call is collective
+   * over MPI_COMM_WORLD.
+   */
+  MPI_Comm GetCommunicator();
 
   /** Gets the number of meshes a simulation can provide.  The caller passes a
    * reference to an integer variable in the first argument upon return this
@@ -130,6 +135,91 @@ public:
   virtual int AddArrays(svtkDataObject* mesh, const std::string &meshName,
     int association, const std::vector<std::string> &arrayNames);
 
+  /** Fetches a single block of the named mesh. Together with AddArrayToBlock,
+   * AddGhostCellsArrayToBlock and AddGhostNodesArrayToBlock this lets a
+   * caller process the local data one block at a time, such that at most one
+   * block is held in memory rather than the entire local domain. The ids of
+   * the local blocks are found in the MeshMetadata::BlockIds when the
+   * metadata is generated with the BlockDecomp flag. See
+   * SVTKUtils::GetLocalBlockIds.
+   *
+   * The default implementation is layered on top of GetMesh and AddArray.
+   * It fetches and caches the entire local mesh and serves blocks from the
+   * cache, hence it does not save memory. Block ids are the flat index of
+   * the block in the svtkMultiBlockDataSet less one, or the flat index of the
+   * block in svtkOverlappingAMR. Implementers are encouraged to override
+   * this method and the other block methods, generating only the requested
+   * block, and to override StreamsMeshBlocks to report that they do.
+   *
+   * @note Callers are to take ownership of the newly allocated block and must
+   * Delete the returned block when finished to prevent a memory leak.
+   * Callers should call ReleaseMeshBlocks when finished with the mesh.
+   *
+   * @param[in] meshName the name of the mesh to access (see GetMeshMetadata)
+   * @param[in] blockId the id of a block owned by this rank
+   * @param[in] structureOnly When set to true the returned block
+   *            may not have any geometry or topology information.
+   * @param[out] block a reference to a pointer where a new VTK object is stored
+   * @returns zero if successful, non zero if an error occurred
+   */
+  virtual int GetMeshBlock(const std::string &meshName, long blockId,
+    bool structureOnly, svtkDataObject *&block);
+
+  /** Fetches the named array from the simulation and adds it to the passed
+   * block. See GetMeshBlock.
+   *
+   * @param[in] block the VTK object returned from GetMeshBlock
+   * @param[in] meshName the name of the mesh on which the array is stored
+   * @param[in] blockId the id of the block passed to GetMeshBlock
+   * @param[in] association field association; one of
+   *            svtkDataObject::FieldAssociations or svtkDataObject::AttributeTypes.
+   * @param[in] arrayName name of the array
+   * @returns zero if successful, non zero if an error occurred
+   */
+  virtual int AddArrayToBlock(svtkDataObject *block, const std::string &meshName,
+    long blockId, int association, const std::string &arrayName);
+
+  /** Adds ghost nodes to the passed block. See GetMeshBlock and
+   * AddGhostNodesArray.
+   *
+   *  @param[in] block the VTK object returned from GetMeshBlock
+   *  @param[in] meshName the name of the mesh to access (see GetMeshMetadata)
+   *  @param[in] blockId the id of the block passed to GetMeshBlock
+   *  @returns zero if successful, non zero if an error occurred
+   */
+  virtual int AddGhostNodesArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId);
+
+  /** Adds ghost cells to the passed block. See GetMeshBlock and
+   * AddGhostCellsArray.
+   *
+   *  @param[in] block the VTK object returned from GetMeshBlock
+   *  @param[in] meshName the name of the mesh to access (see GetMeshMetadata)
+   *  @param[in] blockId the id of the block passed to GetMeshBlock
+   *  @returns zero if successful, non zero if an error occurred
+   */
+  virtual int AddGhostCellsArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId);
+
+  /** Returns true if GetMeshBlock and the other block methods generate only
+   * the requested block of the named mesh. The default implementation
+   * returns false because it caches the entire local mesh. Callers that
+   * process one block at a time to bound their memory use should check
+   * this and fall back to GetMesh when it is false.
+   *
+   * @param[in] meshName the name of the mesh to access (see GetMeshMetadata)
+   * @returns true if blocks are generated one at a time
+   */
+  virtual bool StreamsMeshBlocks(const std::string &meshName);
+
+  /** Release resources held on behalf of the block-at-a-time API. Callers of
+   * GetMeshBlock should call this method when they are finished with the
+   * mesh. The default implementation releases the cached mesh.
+   *
+   * @returns zero if successful, non zero if an error occurred
+   */
+  virtual int ReleaseMeshBlocks();
+
   /** Release data allocated for the current timestep. This method allows implementers to
    * free resources that were used in the conversion of the simulation data.
    * However, note that callers of GetMesh must Delete the returned
@@ -138,11 +228,13 @@ public:
    *
    * @note  The instrumentation (or bridge) code must call this method when
    * done processing a time step to ensure that all resources are released.
-   * Analysis adaptors should not call this method.
+   * Analysis adaptors should not call this method. The default
+   * implementation releases the mesh cached by the block methods, overrides
+   * should call it.
    *
    * @returns zero if successful, non zero if an error occurred
    */
-  virtual int ReleaseData() { return 0; }
+  virtual int ReleaseData();
 
   /// Get the current simulated time.
   virtual double GetDataTime();
@@ -175,5 +267,22 @@ protected:
   MPI_Comm Comm;
 };
 
+/** Calls DataAdaptor::ReleaseMeshBlocks when it goes out of scope, so that
+ * callers of the block-at-a-time API release the resources held for it on
+ * every return.
+ */
+class MeshBlocksGuard
+{
+public:
+  MeshBlocksGuard(DataAdaptor *dataIn) : DataIn(dataIn) {}
+  ~MeshBlocksGuard() { this->DataIn->ReleaseMeshBlocks(); }
+
+  MeshBlocksGuard(const MeshBlocksGuard &) = delete;
+  void operator=(const MeshBlocksGuard &) = delete;
+
+private:
+  DataAdaptor *DataIn;
+};
+
 }
 #endif
@@ -255,6 +255,7 @@ SENSEI_IN_TRANSIT_DATA_ADAPTOR_IGNORE_CPP_API(sensei::##CLASS)
 %naturalvar sensei::MeshMetadata::BlockNumCells;
 %naturalvar sensei::MeshMetadata::BlockCellArraySize;
 %naturalvar sensei::MeshMetadata::BlockExtents;
+%naturalvar sensei::MeshMetadata::BlockOwnedExtents;
 %naturalvar sensei::MeshMetadata::BlockBounds;
 %naturalvar sensei::MeshMetadata::RefRatio;
 %naturalvar sensei::MeshMetadata::BlocksPerLevel;
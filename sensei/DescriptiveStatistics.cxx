@@ -0,0 +1,676 @@
+#include "DescriptiveStatistics.h"
+#include "DataAdaptor.h"
+#include "SVTKDataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkDoubleArray.h>
+#include <svtkFieldData.h>
+#include <svtkImageData.h>
+#include <svtkIntArray.h>
+#include <svtkLongArray.h>
+#include <svtkPointData.h>
+#include <svtkSmartPointer.h>
+#include <svtkStringArray.h>
+#include <svtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// **************************************************************************
+/** The central moments of a set of values, along with the count, min, and
+ * max. The layout is 7 doubles so that it can be sent with a contiguous MPI
+ * type.
+ */
+struct Moments
+{
+  Moments() : N(0.0), Mean(0.0), M2(0.0), M3(0.0), M4(0.0),
+    Min(std::numeric_limits<double>::max()),
+    Max(std::numeric_limits<double>::lowest()) {}
+
+  // add a value using Welford's online update extended to the third and
+  // fourth central moments
+  void Update(double x)
+  {
+    double n1 = this->N;
+    this->N += 1.0;
+    double n = this->N;
+    double delta = x - this->Mean;
+    double deltaN = delta / n;
+    double deltaN2 = deltaN * deltaN;
+    double term1 = delta * deltaN * n1;
+    this->Mean += deltaN;
+    this->M4 += term1 * deltaN2 * (n*n - 3.0*n + 3.0)
+      + 6.0 * deltaN2 * this->M2 - 4.0 * deltaN * this->M3;
+    this->M3 += term1 * deltaN * (n - 2.0) - 3.0 * deltaN * this->M2;
+    this->M2 += term1;
+    this->Min = std::min(this->Min, x);
+    this->Max = std::max(this->Max, x);
+  }
+
+  // combine with the moments of another set using Chan's pairwise update
+  void Merge(const Moments &o)
+  {
+    if (o.N == 0.0)
+      return;
+
+    if (this->N == 0.0)
+      {
+      *this = o;
+      return;
+      }
+
+    double na = this->N;
+    double nb = o.N;
+    double n = na + nb;
+    double delta = o.Mean - this->Mean;
+    double delta2 = delta * delta;
+    double delta3 = delta2 * delta;
+    double delta4 = delta2 * delta2;
+
+    double m2 = this->M2 + o.M2 + delta2 * na * nb / n;
+
+    double m3 = this->M3 + o.M3 + delta3 * na * nb * (na - nb) / (n*n)
+      + 3.0 * delta * (na * o.M2 - nb * this->M2) / n;
+
+    double m4 = this->M4 + o.M4
+      + delta4 * na * nb * (na*na - na*nb + nb*nb) / (n*n*n)
+      + 6.0 * delta2 * (na*na * o.M2 + nb*nb * this->M2) / (n*n)
+      + 4.0 * delta * (na * o.M3 - nb * this->M3) / n;
+
+    this->Mean += delta * nb / n;
+    this->N = n;
+    this->M2 = m2;
+    this->M3 = m3;
+    this->M4 = m4;
+    this->Min = std::min(this->Min, o.Min);
+    this->Max = std::max(this->Max, o.Max);
+  }
+
+  double N;
+  double Mean;
+  double M2;
+  double M3;
+  double M4;
+  double Min;
+  double Max;
+};
+
+// **************************************************************************
+void MergeMoments(void *invec, void *inoutvec, int *len, MPI_Datatype *)
+{
+  const Moments *in = static_cast<const Moments*>(invec);
+  Moments *inout = static_cast<Moments*>(inoutvec);
+  for (int i = 0; i < *len; ++i)
+    {
+    // the reduction is non-commutative, ranks below us are passed in
+    // invec. merge in rank order so results are reproducible.
+    Moments tmp = in[i];
+    tmp.Merge(inout[i]);
+    inout[i] = tmp;
+    }
+}
+
+// **************************************************************************
+/** Accumulate the moments of tuples [i0, i1) of each of nComps components.
+ * Ghost zones flagged in the optional ghost array are skipped. The accessor
+ * returns the value of component j of tuple i.
+ */
+template <typename accessor_t>
+void Accumulate(const accessor_t &value, const unsigned char *ghosts,
+  long i0, long i1, int nComps, Moments *moments)
+{
+  for (long i = i0; i < i1; ++i)
+    {
+    if (ghosts && ghosts[i])
+      continue;
+
+    for (int j = 0; j < nComps; ++j)
+      moments[j].Update(value(i, j));
+    }
+}
+
+// **************************************************************************
+/** Accumulate the moments of nTups tuples of nComps components. The tuples
+ * are split into contiguous ranges, one per thread. Each thread accumulates
+ * privately and the results are merged in thread order so that the result
+ * does not depend on thread scheduling.
+ */
+template <typename accessor_t>
+void Accumulate(const accessor_t &value, const unsigned char *ghosts,
+  long nTups, int nComps, int nThreads, Moments *moments)
+{
+  // don't bother with threads for small blocks
+  nThreads = std::max(1l, std::min<long>(nThreads, nTups / 4096 + 1));
+
+  // one set of moments per thread
+  std::vector<Moments> tmoments(nThreads*nComps);
+
+  auto work = [&](int tid)
+  {
+    long nPer = nTups / nThreads;
+    long nLarge = nTups % nThreads;
+    long i0 = nPer*tid + std::min<long>(tid, nLarge);
+    long i1 = i0 + nPer + (tid < nLarge ? 1 : 0);
+
+    ::Accumulate(value, ghosts, i0, i1, nComps, tmoments.data() + tid*nComps);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads - 1);
+  for (int i = 1; i < nThreads; ++i)
+    threads.emplace_back(work, i);
+
+  work(0);
+
+  for (int i = 0; i < nThreads - 1; ++i)
+    threads[i].join();
+
+  // merge the thread local results in a fixed order
+  for (int i = 0; i < nThreads; ++i)
+    for (int j = 0; j < nComps; ++j)
+      moments[j].Merge(tmoments[i*nComps + j]);
+}
+
+// **************************************************************************
+/// Accumulate the moments of all components of the array
+int Accumulate(svtkDataArray *da, svtkUnsignedCharArray *ga, int nThreads,
+  Moments *moments)
+{
+  long nTups = da->GetNumberOfTuples();
+  int nComps = da->GetNumberOfComponents();
+
+  const unsigned char *ghosts = ga ? ga->GetPointer(0) : nullptr;
+
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+      if (aosDa)
+        {
+        // direct access to contiguous data
+        const SVTK_TT *pDa = aosDa->GetPointer(0);
+        ::Accumulate([pDa,nComps](long i, int j) -> double
+          { return pDa[i*nComps + j]; }, ghosts, nTups, nComps, nThreads,
+          moments);
+        }
+      else
+        {
+        // other layouts go through the virtual API
+        ::Accumulate([da](long i, int j) -> double
+          { return da->GetComponent(i, j); }, ghosts, nTups, nComps,
+          nThreads, moments);
+        }
+    );
+    default:
+      {
+      SENSEI_ERROR("Unsupported dispatch " << da->GetClassName())
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+// **************************************************************************
+void ComputeStatistics(const Moments &m, sensei::DescriptiveStatistics::Data &stats)
+{
+  double n = m.N;
+  stats.Count = n;
+  stats.Mean = m.Mean;
+  stats.Variance = n > 1.0 ? m.M2 / (n - 1.0) : 0.0;
+  stats.Skewness = m.M2 > 0.0 ? std::sqrt(n) * m.M3 / std::pow(m.M2, 1.5) : 0.0;
+  stats.Kurtosis = m.M2 > 0.0 ? n * m.M4 / (m.M2 * m.M2) - 3.0 : 0.0;
+  stats.Min = n > 0.0 ? m.Min : 0.0;
+  stats.Max = n > 0.0 ? m.Max : 0.0;
+}
+
+// **************************************************************************
+void Write(FILE *file, long step, double time,
+  const std::vector<sensei::DescriptiveStatistics::Data> &stats)
+{
+  size_t nStats = stats.size();
+  for (size_t i = 0; i < nStats; ++i)
+    {
+    const sensei::DescriptiveStatistics::Data &s = stats[i];
+    fprintf(file, "%ld, %0.10g, %s, %s, %s, %d, %ld, %0.10g, %0.10g, "
+      "%0.10g, %0.10g, %0.10g, %0.10g\n", step, time, s.MeshName.c_str(),
+      s.ArrayName.c_str(), sensei::SVTKUtils::GetAttributesName(s.Association),
+      s.Component, s.Count, s.Mean, s.Variance, s.Skewness, s.Kurtosis,
+      s.Min, s.Max);
+    }
+}
+
+// **************************************************************************
+svtkImageData *NewTable(const std::vector<sensei::DescriptiveStatistics::Data> &stats)
+{
+  size_t nStats = stats.size();
+
+  svtkImageData *table = svtkImageData::New();
+  table->SetDimensions(nStats, 1, 1);
+
+  svtkStringArray *names = svtkStringArray::New();
+  names->SetName("name");
+  names->SetNumberOfValues(nStats);
+
+  svtkIntArray *comps = svtkIntArray::New();
+  comps->SetName("component");
+  comps->SetNumberOfTuples(nStats);
+
+  svtkLongArray *counts = svtkLongArray::New();
+  counts->SetName("count");
+  counts->SetNumberOfTuples(nStats);
+
+  const char *colNames[] = {"mean", "variance", "skewness",
+    "kurtosis", "min", "max"};
+
+  svtkDoubleArray *cols[6];
+  for (int i = 0; i < 6; ++i)
+    {
+    cols[i] = svtkDoubleArray::New();
+    cols[i]->SetName(colNames[i]);
+    cols[i]->SetNumberOfTuples(nStats);
+    }
+
+  for (size_t i = 0; i < nStats; ++i)
+    {
+    const sensei::DescriptiveStatistics::Data &s = stats[i];
+
+    names->SetValue(i, s.MeshName + "/" +
+      sensei::SVTKUtils::GetAttributesName(s.Association) + "/" + s.ArrayName);
+
+    comps->SetValue(i, s.Component);
+    counts->SetValue(i, s.Count);
+    cols[0]->SetValue(i, s.Mean);
+    cols[1]->SetValue(i, s.Variance);
+    cols[2]->SetValue(i, s.Skewness);
+    cols[3]->SetValue(i, s.Kurtosis);
+    cols[4]->SetValue(i, s.Min);
+    cols[5]->SetValue(i, s.Max);
+    }
+
+  table->GetFieldData()->AddArray(names);
+  names->Delete();
+
+  table->GetPointData()->AddArray(comps);
+  comps->Delete();
+
+  table->GetPointData()->AddArray(counts);
+  counts->Delete();
+
+  for (int i = 0; i < 6; ++i)
+    {
+    table->GetPointData()->AddArray(cols[i]);
+    cols[i]->Delete();
+    }
+
+  return table;
+}
+}
+
+namespace sensei
+{
+//-----------------------------------------------------------------------------
+senseiNewMacro(DescriptiveStatistics);
+
+//-----------------------------------------------------------------------------
+DescriptiveStatistics::DescriptiveStatistics() : NumberOfThreads(1),
+  HeaderWritten(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+DescriptiveStatistics::~DescriptiveStatistics()
+{
+}
+
+//-----------------------------------------------------------------------------
+int DescriptiveStatistics::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int DescriptiveStatistics::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void DescriptiveStatistics::SetFileName(const std::string &fileName)
+{
+  this->FileName = fileName;
+  this->HeaderWritten = 0;
+}
+
+//-----------------------------------------------------------------------------
+void DescriptiveStatistics::SetNumberOfThreads(int nThreads)
+{
+  this->NumberOfThreads = nThreads < 1 ? 1 : nThreads;
+}
+
+//-----------------------------------------------------------------------------
+bool DescriptiveStatistics::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("DescriptiveStatistics::Execute");
+
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // see what the simulation is providing
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(dataIn))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  // if no requirements are given, compute statistics for everything
+  if (this->Requirements.Empty())
+    {
+    if (this->Requirements.Initialize(dataIn, false))
+      {
+      SENSEI_ERROR("Failed to initialze data requirements")
+      return false;
+      }
+
+    if (this->GetVerbose())
+      SENSEI_WARNING("No subset specified. Processing all available arrays")
+    }
+
+  // the moments of every component of every array. these are accumulated
+  // locally and then reduced in a single collective.
+  std::vector<DescriptiveStatistics::Data> stats;
+  std::vector<Moments> moments;
+
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  while (mit)
+    {
+    const std::string &meshName = mit.MeshName();
+
+    MeshMetadataPtr mmd;
+    if (mdMap.GetMeshMetadata(meshName, mmd))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    svtkDataObject *dobj = nullptr;
+    if (dataIn->GetMesh(meshName, true, dobj))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    // it is not an error for a rank to have no data, however all ranks
+    // must participate in the reduction below
+    svtkCompositeDataSetPtr mesh;
+    if (dobj)
+      {
+      if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
+        dataIn->AddGhostCellsArray(dobj, meshName))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add ghost cells.")
+        MPI_Abort(comm, -1);
+        return false;
+        }
+
+      if (mmd->NumGhostNodes && dataIn->AddGhostNodesArray(dobj, meshName))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add ghost nodes.")
+        MPI_Abort(comm, -1);
+        return false;
+        }
+
+      // the composite wrapper takes ownership, dobj is still passed
+      // to the data adaptor when adding arrays
+      mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+      }
+
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(meshName);
+
+    while (ait)
+      {
+      int assoc = ait.Association();
+      const std::string &arrayName = ait.Array();
+
+      // the number of components comes from the metadata so that ranks
+      // without data agree on the size of the reduction
+      auto ait2 = std::find(mmd->ArrayName.begin(),
+        mmd->ArrayName.end(), arrayName);
+
+      if (ait2 == mmd->ArrayName.end())
+        {
+        SENSEI_ERROR("No array named \"" << arrayName << "\" on mesh \""
+          << meshName << "\"")
+        MPI_Abort(comm, -1);
+        return false;
+        }
+
+      int nComps = mmd->ArrayComponents[ait2 - mmd->ArrayName.begin()];
+
+      size_t offs = moments.size();
+      moments.resize(offs + nComps);
+
+      for (int j = 0; j < nComps; ++j)
+        {
+        DescriptiveStatistics::Data s;
+        s.MeshName = meshName;
+        s.ArrayName = arrayName;
+        s.Association = assoc;
+        s.Component = j;
+        stats.push_back(s);
+        }
+
+      if (mesh)
+        {
+        if (dataIn->AddArray(dobj, meshName, assoc, arrayName))
+          {
+          SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add "
+            << SVTKUtils::GetAttributesName(assoc) << " data array \""
+            << arrayName << "\"")
+          MPI_Abort(comm, -1);
+          return false;
+          }
+
+        // blocks are processed concurrently when there are enough of them
+        // to keep the threads busy, otherwise each block is split across the
+        // threads. the results are merged in block order.
+        std::vector<svtkDataSet*> blocks;
+        SVTKUtils::GetLeaves(mesh, blocks);
+
+        int nBlocks = blocks.size();
+        int nOuter = nBlocks >= this->NumberOfThreads ? this->NumberOfThreads : 1;
+        int nInner = nOuter > 1 ? 1 : this->NumberOfThreads;
+
+        SVTKUtils::BlockReduction<std::vector<Moments>> blockMoments(nBlocks,
+          std::vector<Moments>(nComps));
+
+        SVTKUtils::IndexedDatasetFunction accumulate =
+          [&](int leaf, int, svtkDataSet *ds) -> int
+          {
+          svtkFieldData *fd = ds->GetAttributesAsFieldData(assoc);
+
+          svtkDataArray *da = fd ? fd->GetArray(arrayName.c_str()) : nullptr;
+          if (!da)
+            {
+            SENSEI_WARNING("Data block " << leaf << " of mesh \"" << meshName
+              << "\" has no array named \"" << arrayName << "\"")
+            return 0;
+            }
+
+          if (da->GetNumberOfComponents() != nComps)
+            {
+            SENSEI_ERROR("Array \"" << arrayName << "\" has "
+              << da->GetNumberOfComponents() << " components but the metadata"
+              " reports " << nComps)
+            return -1;
+            }
+
+          svtkUnsignedCharArray *ga = dynamic_cast<svtkUnsignedCharArray*>(
+            fd->GetArray("svtkGhostType"));
+
+          if (::Accumulate(da, ga, nInner, blockMoments[leaf].data()))
+            {
+            SENSEI_ERROR("Failed to process array \"" << arrayName
+              << "\" data block " << leaf << " of mesh \"" << meshName << "\"")
+            return -1;
+            }
+
+          return 0;
+          };
+
+        if (SVTKUtils::Apply(mesh, accumulate, nOuter))
+          {
+          MPI_Abort(comm, -1);
+          return false;
+          }
+
+        for (int i = 0; i < nBlocks; ++i)
+          for (int j = 0; j < nComps; ++j)
+            moments[offs + j].Merge(blockMoments[i][j]);
+        }
+
+      ++ait;
+      }
+
+    ++mit;
+    }
+
+  // reduce the moments of all arrays to rank 0 in a single collective
+  int nMoments = moments.size();
+
+  MPI_Datatype momentsType;
+  MPI_Type_contiguous(sizeof(Moments)/sizeof(double), MPI_DOUBLE, &momentsType);
+  MPI_Type_commit(&momentsType);
+
+  MPI_Op mergeOp;
+  MPI_Op_create(MergeMoments, 0, &mergeOp);
+
+  std::vector<Moments> globalMoments(rank == 0 ? nMoments : 0);
+
+  MPI_Reduce(moments.data(), globalMoments.data(), nMoments,
+    momentsType, mergeOp, 0, comm);
+
+  MPI_Op_free(&mergeOp);
+  MPI_Type_free(&momentsType);
+
+  if (rank == 0)
+    {
+    for (int i = 0; i < nMoments; ++i)
+      ::ComputeStatistics(globalMoments[i], stats[i]);
+
+    this->LastResult = stats;
+
+    if (this->WriteResults(dataIn->GetDataTimeStep(), dataIn->GetDataTime()))
+      return false;
+    }
+
+  // pass the results back as a table
+  if (dataOut)
+    {
+    svtkImageData *table = rank == 0 ? ::NewTable(stats) : nullptr;
+
+    SVTKDataAdaptor *out = SVTKDataAdaptor::New();
+    out->SetCommunicator(comm);
+    out->SetDataObject("statistics", table);
+    out->SetDataTimeStep(dataIn->GetDataTimeStep());
+    out->SetDataTime(dataIn->GetDataTime());
+
+    if (table)
+      table->Delete();
+
+    *dataOut = out;
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int DescriptiveStatistics::WriteResults(long step, double time)
+{
+  TimeEvent<128> mark("DescriptiveStatistics::WriteResults");
+
+  if (this->FileName.empty())
+    {
+    if (!this->HeaderWritten)
+      {
+      fprintf(stdout, "# step, time, mesh, array, association, component,"
+        " count, mean, variance, skewness, kurtosis, min, max\n");
+      this->HeaderWritten = 1;
+      }
+
+    ::Write(stdout, step, time, this->LastResult);
+    fflush(stdout);
+
+    return 0;
+    }
+
+  FILE *file = fopen(this->FileName.c_str(), this->HeaderWritten ? "a" : "w");
+  if (!file)
+    {
+    char *estr = strerror(errno);
+    SENSEI_ERROR("Failed to open \"" << this->FileName << "\"" << std::endl << estr)
+    return -1;
+    }
+
+  if (!this->HeaderWritten)
+    {
+    fprintf(file, "# step, time, mesh, array, association, component,"
+      " count, mean, variance, skewness, kurtosis, min, max\n");
+    this->HeaderWritten = 1;
+    }
+
+  ::Write(file, step, time, this->LastResult);
+
+  fclose(file);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int DescriptiveStatistics::GetStatistics(
+  std::vector<DescriptiveStatistics::Data> &stats)
+{
+  stats = this->LastResult;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int DescriptiveStatistics::Finalize()
+{
+  return 0;
+}
+
+}
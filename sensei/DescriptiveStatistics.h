@@ -0,0 +1,99 @@
+#ifndef sensei_DescriptiveStatistics_h
+#define sensei_DescriptiveStatistics_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/** Computes descriptive statistics (count, mean, variance, skewness,
+ * kurtosis, min and max) of any number of arrays and their components in a
+ * single pass over the data. Ghost zones are excluded. Block local moments
+ * are accumulated in parallel by a number of threads using Welford's update
+ * and combined using Chan's pairwise merge. The results for all arrays are
+ * reduced to MPI rank 0 in a single MPI collective. Results are written to a
+ * CSV file or to stdout, and can optionally be returned through a
+ * DataAdaptor as a mesh named "statistics". In that mesh, which is a 1D
+ * svtkImageData on rank 0, each point is a row of the table with one point
+ * data array per statistic.
+ */
+class SENSEI_EXPORT DescriptiveStatistics : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static DescriptiveStatistics *New();
+
+  senseiTypeMacro(DescriptiveStatistics, AnalysisAdaptor);
+
+  /** Set the meshes and arrays to compute statistics for. If none are set
+   * then statistics are computed for all arrays on all meshes.
+   */
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  /// Add a single array to the list of arrays to process.
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  /** Set the name of the CSV file that results are written to. If not set
+   * the results are written to stdout.
+   */
+  void SetFileName(const std::string &fileName);
+
+  /// Set the number of threads used to process local data. The default is 1.
+  void SetNumberOfThreads(int nThreads);
+
+  /// compute the statistics for this time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+  /// the statistics computed for a single component of an array.
+  struct Data
+  {
+    Data() : Association(0), Component(0), Count(0), Mean(0.0),
+      Variance(0.0), Skewness(0.0), Kurtosis(0.0), Min(0.0), Max(0.0) {}
+
+    std::string MeshName;  ///< the mesh the array lives on
+    std::string ArrayName; ///< the array name
+    int Association;       ///< point or cell data
+    int Component;         ///< the array component
+    long Count;            ///< number of non-ghost values
+    double Mean;           ///< the mean
+    double Variance;       ///< the sample variance
+    double Skewness;       ///< the skewness (g1)
+    double Kurtosis;       ///< the excess kurtosis (g2)
+    double Min;            ///< the smallest value
+    double Max;            ///< the largest value
+  };
+
+  /** return the statistics computed by the most recent call to Execute.
+   * This is only valid on MPI rank 0.
+   */
+  int GetStatistics(std::vector<DescriptiveStatistics::Data> &stats);
+
+protected:
+  DescriptiveStatistics();
+  ~DescriptiveStatistics();
+
+  DescriptiveStatistics(const DescriptiveStatistics&) = delete;
+  void operator=(const DescriptiveStatistics&) = delete;
+
+  int WriteResults(long step, double time);
+
+private:
+  DataRequirements Requirements;
+  std::string FileName;
+  int NumberOfThreads;
+  int HeaderWritten;
+  std::vector<DescriptiveStatistics::Data> LastResult;
+};
+
+}
+
+#endif
@@ -0,0 +1,842 @@
+#include "Downsample.h"
+#include "DataAdaptor.h"
+#include "SVTKDataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAMRBox.h>
+#include <svtkAMRInformation.h>
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCellData.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkImageData.h>
+#include <svtkOverlappingAMR.h>
+#include <svtkRectilinearGrid.h>
+#include <svtkSmartPointer.h>
+#include <svtkUniformGrid.h>
+#include <svtkUnsignedCharArray.h>
+
+#include <algorithm>
+#include <climits>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// **************************************************************************
+/** Split [0, n) into contiguous ranges and call f(i0, i1) for each on its
+ * own thread. work is the total cost of the n items, small amounts of work
+ * are not split.
+ */
+template <typename func_t>
+void ParallelFor(long n, long work, int nThreads, const func_t &f)
+{
+  nThreads = std::max(1l, std::min<long>({long(nThreads), work / 16384 + 1, n}));
+
+  auto work_ = [&](int tid)
+  {
+    long nPer = n / nThreads;
+    long nLarge = n % nThreads;
+    long i0 = nPer*tid + std::min<long>(tid, nLarge);
+    long i1 = i0 + nPer + (tid < nLarge ? 1 : 0);
+    f(i0, i1);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads - 1);
+  for (int i = 1; i < nThreads; ++i)
+    threads.emplace_back(work_, i);
+
+  work_(0);
+
+  for (int i = 0; i < nThreads - 1; ++i)
+    threads[i].join();
+}
+
+// **************************************************************************
+inline int FloorDiv(int a, int b)
+{
+  return a >= 0 ? a / b : -((b - 1 - a) / b);
+}
+
+// **************************************************************************
+inline int CeilDiv(int a, int b)
+{
+  return -FloorDiv(-a, b);
+}
+
+// **************************************************************************
+/// where the cells and points of a coarse block come from in the fine block
+struct BlockLayout
+{
+  std::array<int,6> CellExt;         // fine cell extent, including ghosts
+  std::array<int,6> PointExt;        // fine point extent
+  std::array<int,6> CoarseExt;       // coarse cell extent
+  std::array<int,6> CoarsePointExt;  // coarse point extent
+  std::array<int,3> Factor;          // the factor, 1 along flat axes
+
+  long NumberOfCoarseCells() const
+  {
+    return long(this->CoarseExt[1] - this->CoarseExt[0] + 1) *
+      (this->CoarseExt[3] - this->CoarseExt[2] + 1) *
+      (this->CoarseExt[5] - this->CoarseExt[4] + 1);
+  }
+
+  long NumberOfCoarsePoints() const
+  {
+    return long(this->CoarsePointExt[1] - this->CoarsePointExt[0] + 1) *
+      (this->CoarsePointExt[3] - this->CoarsePointExt[2] + 1) *
+      (this->CoarsePointExt[5] - this->CoarsePointExt[4] + 1);
+  }
+};
+
+// **************************************************************************
+/** Coarsen the cell data of a block. Each coarse cell either takes the
+ * value of the first of its fine cells or the average over those of its
+ * fine cells that are in the block.
+ */
+template <typename T>
+void CoarsenCells(const T *in, T *out, int nComps, const BlockLayout &b,
+  int mode, int nThreads)
+{
+  const std::array<int,6> &ext = b.CellExt;
+  const std::array<int,6> &cext = b.CoarseExt;
+  const std::array<int,3> &f = b.Factor;
+
+  long nx = ext[1] - ext[0] + 1;
+  long nxy = nx*(ext[3] - ext[2] + 1);
+
+  long nI = cext[1] - cext[0] + 1;
+  long nJ = cext[3] - cext[2] + 1;
+  long nRows = nJ*(cext[5] - cext[4] + 1);
+
+  long work = nRows*nI*nComps*(mode == sensei::Downsample::MODE_BOX ?
+    f[0]*f[1]*f[2] : 1);
+
+  ParallelFor(nRows, work, nThreads, [&](long r0, long r1)
+    {
+    std::vector<double> sum(nComps);
+
+    for (long r = r0; r < r1; ++r)
+      {
+      int J = cext[2] + r % nJ;
+      int K = cext[4] + r / nJ;
+
+      T *pOut = out + r*nI*nComps;
+
+      if (mode == sensei::Downsample::MODE_STRIDE)
+        {
+        const T *pIn = in + ((K*f[2] - ext[4])*nxy +
+          (J*f[1] - ext[2])*nx + cext[0]*f[0] - ext[0])*nComps;
+
+        long step = f[0]*nComps;
+        for (long I = 0; I < nI; ++I, pIn += step, pOut += nComps)
+          for (int c = 0; c < nComps; ++c)
+            pOut[c] = pIn[c];
+        }
+      else
+        {
+        int j0 = J*f[1];
+        int j1 = std::min(j0 + f[1] - 1, ext[3]);
+        int k0 = K*f[2];
+        int k1 = std::min(k0 + f[2] - 1, ext[5]);
+
+        for (long I = 0; I < nI; ++I, pOut += nComps)
+          {
+          int i0 = (cext[0] + I)*f[0];
+          int i1 = std::min(i0 + f[0] - 1, ext[1]);
+
+          sum.assign(nComps, 0.0);
+          for (int k = k0; k <= k1; ++k)
+            {
+            for (int j = j0; j <= j1; ++j)
+              {
+              const T *pIn = in + ((k - ext[4])*nxy + (j - ext[2])*nx
+                + i0 - ext[0])*nComps;
+
+              for (int i = i0; i <= i1; ++i, pIn += nComps)
+                for (int c = 0; c < nComps; ++c)
+                  sum[c] += pIn[c];
+              }
+            }
+
+          double w = 1.0 / (double(i1 - i0 + 1)*(j1 - j0 + 1)*(k1 - k0 + 1));
+          for (int c = 0; c < nComps; ++c)
+            pOut[c] = static_cast<T>(w*sum[c]);
+          }
+        }
+      }
+    });
+}
+
+// **************************************************************************
+/** Sample the point data of a block at the fine points coincident with the
+ * coarse points. Coarse points past the end of the block take the value of
+ * the last point.
+ */
+template <typename T>
+void SamplePoints(const T *in, T *out, int nComps, const BlockLayout &b,
+  int nThreads)
+{
+  const std::array<int,6> &ext = b.PointExt;
+  const std::array<int,6> &cext = b.CoarsePointExt;
+  const std::array<int,3> &f = b.Factor;
+
+  long nx = ext[1] - ext[0] + 1;
+  long nxy = nx*(ext[3] - ext[2] + 1);
+
+  long nI = cext[1] - cext[0] + 1;
+  long nJ = cext[3] - cext[2] + 1;
+  long nRows = nJ*(cext[5] - cext[4] + 1);
+
+  ParallelFor(nRows, nRows*nI*nComps, nThreads, [&](long r0, long r1)
+    {
+    for (long r = r0; r < r1; ++r)
+      {
+      int j = std::min((cext[2] + int(r % nJ))*f[1], ext[3]);
+      int k = std::min((cext[4] + int(r / nJ))*f[2], ext[5]);
+
+      const T *pRow = in + ((k - ext[4])*nxy + (j - ext[2])*nx - ext[0])*nComps;
+      T *pOut = out + r*nI*nComps;
+
+      for (long I = 0; I < nI; ++I, pOut += nComps)
+        {
+        const T *pIn = pRow + std::min((cext[0] + int(I))*f[0], ext[1])*nComps;
+        for (int c = 0; c < nComps; ++c)
+          pOut[c] = pIn[c];
+        }
+      }
+    });
+}
+
+// **************************************************************************
+/// coarsen a point or cell data array of a block
+svtkDataArray *Coarsen(svtkDataArray *da, int association,
+  const BlockLayout &b, int mode, int nThreads)
+{
+  int nComps = da->GetNumberOfComponents();
+  long nTups = association == svtkDataObject::CELL ?
+    b.NumberOfCoarseCells() : b.NumberOfCoarsePoints();
+
+  svtkDataArray *out = svtkDataArray::CreateDataArray(da->GetDataType());
+  out->SetName(da->GetName());
+  out->SetNumberOfComponents(nComps);
+  out->SetNumberOfTuples(nTups);
+
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+
+      // other layouts are converted
+      svtkAOSDataArrayTemplate<SVTK_TT> *tmp = nullptr;
+      if (!aosDa)
+        {
+        tmp = svtkAOSDataArrayTemplate<SVTK_TT>::New();
+        tmp->DeepCopy(da);
+        aosDa = tmp;
+        }
+
+      SVTK_TT *pOut = static_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>
+        (out)->GetPointer(0);
+
+      if (association == svtkDataObject::CELL)
+        ::CoarsenCells(aosDa->GetPointer(0), pOut, nComps, b, mode, nThreads);
+      else
+        ::SamplePoints(aosDa->GetPointer(0), pOut, nComps, b, nThreads);
+
+      if (tmp)
+        tmp->Delete();
+    );
+    default:
+      {
+      SENSEI_ERROR("Unsupported dispatch " << da->GetClassName())
+      out->Delete();
+      return nullptr;
+      }
+    }
+
+  return out;
+}
+
+// **************************************************************************
+/// the coordinates of the coarse points along one axis of a rectilinear grid
+svtkDataArray *CoarsenCoordinates(svtkDataArray *x, int p0, int f,
+  int q0, int q1)
+{
+  long n = x->GetNumberOfTuples();
+
+  svtkDataArray *xOut = x->NewInstance();
+  xOut->SetNumberOfTuples(q1 - q0 + 1);
+
+  for (int q = q0; q <= q1; ++q)
+    {
+    // points past the end of the block are extrapolated from the last cell
+    long i = long(q)*f - p0;
+    double xq = 0.0;
+    if ((i < n) || (n < 2))
+      xq = x->GetTuple1(std::min(i, n - 1));
+    else
+      xq = x->GetTuple1(n - 1) + (i - n + 1)*(x->GetTuple1(n - 1) -
+        x->GetTuple1(n - 2));
+    xOut->SetTuple1(q - q0, xq);
+    }
+
+  return xOut;
+}
+
+// **************************************************************************
+/// make the geometry of a coarse block
+svtkDataSet *NewCoarseBlock(svtkDataSet *ds, const BlockLayout &b)
+{
+  if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+    {
+    double spacing[3];
+    im->GetSpacing(spacing);
+    for (int i = 0; i < 3; ++i)
+      spacing[i] *= b.Factor[i];
+
+    // svtkUniformGrid is preserved
+    svtkImageData *imOut = im->NewInstance();
+    imOut->SetOrigin(im->GetOrigin());
+    imOut->SetSpacing(spacing);
+    imOut->SetExtent(const_cast<int*>(b.CoarsePointExt.data()));
+    return imOut;
+    }
+  else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+    {
+    const std::array<int,6> &pext = b.PointExt;
+    const std::array<int,6> &cpext = b.CoarsePointExt;
+
+    svtkDataArray *x[3] = {rg->GetXCoordinates(), rg->GetYCoordinates(),
+      rg->GetZCoordinates()};
+
+    svtkDataArray *xOut[3];
+    for (int i = 0; i < 3; ++i)
+      xOut[i] = ::CoarsenCoordinates(x[i], pext[2*i], b.Factor[i],
+        cpext[2*i], cpext[2*i+1]);
+
+    svtkRectilinearGrid *rgOut = svtkRectilinearGrid::New();
+    rgOut->SetExtent(const_cast<int*>(cpext.data()));
+    rgOut->SetXCoordinates(xOut[0]);
+    rgOut->SetYCoordinates(xOut[1]);
+    rgOut->SetZCoordinates(xOut[2]);
+
+    for (int i = 0; i < 3; ++i)
+      xOut[i]->Delete();
+
+    return rgOut;
+    }
+
+  SENSEI_ERROR("Unsupported block type " << ds->GetClassName())
+  return nullptr;
+}
+}
+
+namespace sensei
+{
+//-----------------------------------------------------------------------------
+senseiNewMacro(Downsample);
+
+//-----------------------------------------------------------------------------
+Downsample::Downsample() : Factor{{2, 2, 2}}, Mode(MODE_STRIDE),
+  MaximumLevel(-1), NumberOfThreads(1)
+{
+}
+
+//-----------------------------------------------------------------------------
+Downsample::~Downsample()
+{
+}
+
+//-----------------------------------------------------------------------------
+int Downsample::GetMode(const std::string &name, int &mode)
+{
+  if (name == "stride")
+    {
+    mode = MODE_STRIDE;
+    return 0;
+    }
+  else if (name == "box")
+    {
+    mode = MODE_BOX;
+    return 0;
+    }
+
+  SENSEI_ERROR("Invalid mode \"" << name << "\". The mode must be stride or box")
+  return -1;
+}
+
+//-----------------------------------------------------------------------------
+int Downsample::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Downsample::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Downsample::SetFactor(int fx, int fy, int fz)
+{
+  if ((fx < 1) || (fy < 1) || (fz < 1))
+    {
+    SENSEI_ERROR("Invalid factor " << fx << " " << fy << " " << fz
+      << ". The factor must be at least 1")
+    return -1;
+    }
+
+  this->Factor = {fx, fy, fz};
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Downsample::SetMode(int mode)
+{
+  if ((mode != MODE_STRIDE) && (mode != MODE_BOX))
+    {
+    SENSEI_ERROR("Invalid mode " << mode)
+    return -1;
+    }
+
+  this->Mode = mode;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void Downsample::SetNumberOfThreads(int nThreads)
+{
+  this->NumberOfThreads = nThreads < 1 ? 1 : nThreads;
+}
+
+//-----------------------------------------------------------------------------
+int Downsample::Coarsen(svtkDataObject *mesh, const ArrayList &arrays,
+  svtkDataObject *&meshOut)
+{
+  meshOut = nullptr;
+
+  std::vector<svtkDataSet*> blocks;
+  if (mesh && SVTKUtils::GetLeaves(mesh, blocks))
+    return -1;
+
+  int nBlocks = blocks.size();
+
+  // the extents of the blocks, and the upper end of the owned cells over
+  // all blocks which bounds the last complete coarse cell
+  std::vector<std::array<int,6>> cellExt(nBlocks);
+  std::vector<std::array<int,6>> ownedExt(nBlocks);
+  int localHi[3] = {INT_MIN, INT_MIN, INT_MIN};
+  int hi[3] = {INT_MIN, INT_MIN, INT_MIN};
+
+  int status = 0;
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    if (SVTKUtils::GetOwnedExtent(blocks[i], ownedExt[i]))
+      {
+      SENSEI_ERROR("Unsupported block type " << blocks[i]->GetClassName())
+      status = -1;
+      break;
+      }
+
+    // owned cells that do not form a box can not be split between the
+    // blocks, all of the cells are used
+    SVTKUtils::GetCellExtent(blocks[i], cellExt[i]);
+    if (SVTKUtils::EmptyExtent(ownedExt[i]))
+      ownedExt[i] = cellExt[i];
+
+    for (int j = 0; j < 3; ++j)
+      localHi[j] = std::max(localHi[j], ownedExt[i][2*j+1]);
+    }
+
+  // all ranks take part, including those with no data
+  MPI_Allreduce(localHi, hi, 3, MPI_INT, MPI_MAX, this->GetCommunicator());
+
+  if (status || !mesh)
+    return status;
+
+  // blocks are processed concurrently when there are enough of them to keep
+  // the threads busy, otherwise each block is split across the threads.
+  int nOuter = nBlocks >= this->NumberOfThreads ? this->NumberOfThreads : 1;
+  int nInner = nOuter > 1 ? 1 : this->NumberOfThreads;
+
+  std::vector<svtkDataSet*> blocksOut(nBlocks, nullptr);
+
+  SVTKUtils::IndexedDatasetFunction coarsen =
+    [&](int leaf, int, svtkDataSet *ds) -> int
+    {
+    BlockLayout b;
+    b.CellExt = cellExt[leaf];
+
+    if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+      im->GetExtent(b.PointExt.data());
+    else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+      rg->GetExtent(b.PointExt.data());
+    else
+      {
+      SENSEI_ERROR("Unsupported block type " << ds->GetClassName())
+      return -1;
+      }
+
+    for (int i = 0; i < 3; ++i)
+      {
+      int lo = 2*i;
+      int up = lo + 1;
+
+      if (b.PointExt[lo] == b.PointExt[up])
+        {
+        // a flat axis is kept as is
+        b.Factor[i] = 1;
+        b.CoarseExt[lo] = b.CoarseExt[up] = b.PointExt[lo];
+        b.CoarsePointExt[lo] = b.CoarsePointExt[up] = b.PointExt[lo];
+        }
+      else
+        {
+        // the coarse cells whose first fine cell is owned, and whose fine
+        // cells are all in the mesh
+        int f = this->Factor[i];
+        b.Factor[i] = f;
+        b.CoarseExt[lo] = ::CeilDiv(ownedExt[leaf][lo], f);
+        b.CoarseExt[up] = std::min(::FloorDiv(ownedExt[leaf][up], f),
+          ::FloorDiv(hi[i] + 1, f) - 1);
+        b.CoarsePointExt[lo] = b.CoarseExt[lo];
+        b.CoarsePointExt[up] = b.CoarseExt[up] + 1;
+        }
+      }
+
+    // it is not an error for a block to produce no coarse cells
+    if (SVTKUtils::EmptyExtent(b.CoarseExt))
+      return 0;
+
+    svtkDataSet *dso = ::NewCoarseBlock(ds, b);
+    if (!dso)
+      return -1;
+
+    blocksOut[leaf] = dso;
+
+    for (const auto &array : arrays)
+      {
+      int assoc = array.first;
+      const std::string &arrayName = array.second;
+
+      svtkDataArray *da = ds->GetAttributes(assoc)->GetArray(arrayName.c_str());
+      if (!da)
+        {
+        SENSEI_ERROR("Data block " << leaf << " has no "
+          << SVTKUtils::GetAttributesName(assoc) << " data array named \""
+          << arrayName << "\"")
+        return -1;
+        }
+
+      svtkDataArray *dao = ::Coarsen(da, assoc, b, this->Mode, nInner);
+      if (!dao)
+        return -1;
+
+      dso->GetAttributes(assoc)->AddArray(dao);
+      dao->Delete();
+      }
+
+    return 0;
+    };
+
+  if (SVTKUtils::Apply(mesh, coarsen, nOuter))
+    {
+    for (int i = 0; i < nBlocks; ++i)
+      if (blocksOut[i])
+        blocksOut[i]->Delete();
+    return -1;
+    }
+
+  // place the coarse blocks in a data object with the structure of the input
+  if (svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(mesh))
+    {
+    svtkCompositeDataSet *cdo = cd->NewInstance();
+    cdo->CopyStructure(cd);
+
+    svtkSmartPointer<svtkCompositeDataIterator> it;
+    it.TakeReference(cd->NewIterator());
+
+    int leaf = 0;
+    for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
+      {
+      if (!dynamic_cast<svtkDataSet*>(it->GetCurrentDataObject()))
+        continue;
+
+      cdo->SetDataSet(it, blocksOut[leaf]);
+      if (blocksOut[leaf])
+        blocksOut[leaf]->Delete();
+
+      ++leaf;
+      }
+
+    meshOut = cdo;
+    }
+  else
+    {
+    meshOut = blocksOut[0];
+    }
+
+  // the coarse blocks do not overlap
+  if (meshOut)
+    SVTKUtils::SetGhostLayerMetadata(meshOut, 0, 0);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Downsample::CapLevels(svtkDataObject *mesh, const ArrayList &arrays,
+  svtkDataObject *&meshOut)
+{
+  meshOut = nullptr;
+
+  svtkOverlappingAMR *amr = dynamic_cast<svtkOverlappingAMR*>(mesh);
+  if (!amr)
+    {
+    SENSEI_ERROR("Unsupported mesh type " << mesh->GetClassName())
+    return -1;
+    }
+
+  int nLevels = amr->GetNumberOfLevels();
+  int maxLevel = this->MaximumLevel < 0 ? nLevels - 1 :
+    std::min(this->MaximumLevel, nLevels - 1);
+
+  std::vector<int> blocksPerLevel(maxLevel + 1);
+  for (int i = 0; i <= maxLevel; ++i)
+    blocksPerLevel[i] = amr->GetNumberOfDataSets(i);
+
+  svtkOverlappingAMR *amrOut = svtkOverlappingAMR::New();
+  amrOut->Initialize(maxLevel + 1, blocksPerLevel.data());
+  amrOut->SetGridDescription(amr->GetGridDescription());
+  amrOut->SetOrigin(amr->GetOrigin());
+
+  bool hasRatio = amr->GetAMRInfo()->HasRefinementRatio();
+
+  for (int i = 0; i <= maxLevel; ++i)
+    {
+    double spacing[3];
+    amr->GetSpacing(i, spacing);
+    amrOut->SetSpacing(i, spacing);
+
+    if (hasRatio)
+      amrOut->SetRefinementRatio(i, amr->GetRefinementRatio(i));
+
+    for (int j = 0; j < blocksPerLevel[i]; ++j)
+      {
+      amrOut->SetAMRBox(i, j, amr->GetAMRBox(i, j));
+      amrOut->SetAMRBlockSourceIndex(i, j, amr->GetAMRBlockSourceIndex(i, j));
+
+      svtkUniformGrid *ug = amr->GetDataSet(i, j);
+      if (!ug)
+        continue;
+
+      svtkUniformGrid *ugOut = svtkUniformGrid::New();
+      ugOut->CopyStructure(ug);
+
+      for (const auto &array : arrays)
+        {
+        int assoc = array.first;
+        const std::string &arrayName = array.second;
+
+        svtkDataArray *da = ug->GetAttributes(assoc)->GetArray(arrayName.c_str());
+        if (!da)
+          {
+          SENSEI_ERROR("Level " << i << " block " << j << " has no "
+            << SVTKUtils::GetAttributesName(assoc) << " data array named \""
+            << arrayName << "\"")
+          ugOut->Delete();
+          amrOut->Delete();
+          return -1;
+          }
+
+        ugOut->GetAttributes(assoc)->AddArray(da);
+        }
+
+      // the cells of the new finest level are no longer refined
+      svtkUnsignedCharArray *ghosts = dynamic_cast<svtkUnsignedCharArray*>(
+        ug->GetCellData()->GetArray("svtkGhostType"));
+
+      if (ghosts && (i == maxLevel) && (maxLevel < nLevels - 1))
+        {
+        svtkUnsignedCharArray *ghostsOut = svtkUnsignedCharArray::New();
+        ghostsOut->DeepCopy(ghosts);
+
+        unsigned char *pg = ghostsOut->GetPointer(0);
+        long n = ghostsOut->GetNumberOfTuples();
+        unsigned char mask = ~svtkDataSetAttributes::REFINEDCELL;
+
+        ::ParallelFor(n, n, this->NumberOfThreads, [&](long i0, long i1)
+          {
+          for (long q = i0; q < i1; ++q)
+            pg[q] &= mask;
+          });
+
+        ugOut->GetCellData()->AddArray(ghostsOut);
+        ghostsOut->Delete();
+        }
+      else if (ghosts)
+        {
+        ugOut->GetCellData()->AddArray(ghosts);
+        }
+
+      amrOut->SetDataSet(i, j, ugOut);
+      ugOut->Delete();
+      }
+    }
+
+  meshOut = amrOut;
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool Downsample::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("Downsample::Execute");
+
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  if (this->Requirements.Empty())
+    {
+    SENSEI_ERROR("No arrays were selected")
+    return false;
+    }
+
+  // see what the simulation is providing
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(dataIn))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  SVTKDataAdaptor *out = SVTKDataAdaptor::New();
+  out->SetCommunicator(comm);
+  out->SetDataTimeStep(dataIn->GetDataTimeStep());
+  out->SetDataTime(dataIn->GetDataTime());
+
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  while (mit)
+    {
+    const std::string &meshName = mit.MeshName();
+
+    MeshMetadataPtr mmd;
+    if (mdMap.GetMeshMetadata(meshName, mmd))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+      out->Delete();
+      return false;
+      }
+
+    bool amr = mmd->MeshType == SVTK_OVERLAPPING_AMR;
+    if (!amr && !SVTKUtils::LogicallyCartesian(mmd))
+      {
+      SENSEI_ERROR("Mesh \"" << meshName << "\" is not logically Cartesian")
+      out->Delete();
+      return false;
+      }
+
+    svtkDataObject *dobj = nullptr;
+    if (dataIn->GetMesh(meshName, false, dobj))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      out->Delete();
+      return false;
+      }
+
+    // the ghost cells are needed to find the owned cells, and for AMR the
+    // blanking of refined cells
+    ArrayList arrays;
+    if (dobj)
+      {
+      if ((amr || mmd->NumGhostCells) &&
+        dataIn->AddGhostCellsArray(dobj, meshName))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add ghost cells.")
+        dobj->Delete();
+        out->Delete();
+        return false;
+        }
+
+      ArrayRequirementsIterator ait =
+        this->Requirements.GetArrayRequirementsIterator(meshName);
+
+      while (ait)
+        {
+        int assoc = ait.Association();
+        const std::string &arrayName = ait.Array();
+
+        if (dataIn->AddArray(dobj, meshName, assoc, arrayName))
+          {
+          SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add "
+            << SVTKUtils::GetAttributesName(assoc) << " data array \""
+            << arrayName << "\"")
+          dobj->Delete();
+          out->Delete();
+          return false;
+          }
+
+        arrays.emplace_back(assoc, arrayName);
+
+        ++ait;
+        }
+      }
+
+    // coarsening is collective, ranks without data take part
+    svtkDataObject *meshOut = nullptr;
+    if ((amr && dobj && this->CapLevels(dobj, arrays, meshOut)) ||
+      (!amr && this->Coarsen(dobj, arrays, meshOut)))
+      {
+      SENSEI_ERROR("Failed to downsample mesh \"" << meshName << "\"")
+      if (dobj)
+        dobj->Delete();
+      out->Delete();
+      return false;
+      }
+
+    out->SetDataObject(meshName, meshOut);
+
+    if (meshOut)
+      meshOut->Delete();
+
+    if (dobj)
+      dobj->Delete();
+
+    ++mit;
+    }
+
+  if (dataOut)
+    *dataOut = out;
+  else
+    out->Delete();
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int Downsample::Finalize()
+{
+  return 0;
+}
+
+}
@@ -0,0 +1,112 @@
+#ifndef sensei_Downsample_h
+#define sensei_Downsample_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+
+#include <array>
+#include <mpi.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+class svtkDataObject;
+
+namespace sensei
+{
+
+/** Produces a reduced resolution view of any number of meshes, returned
+ * through the output DataAdaptor for writers and other analyses to consume.
+ * The output meshes have the names of the input meshes and hold the
+ * selected arrays.
+ *
+ * Blocks of svtkImageData and svtkRectilinearGrid are coarsened by an
+ * integer factor along each axis. Coarse cell I covers the fine cells
+ * [I*f, I*f + f - 1] of the global index space and is produced by the block
+ * that owns fine cell I*f, so that each coarse cell is produced exactly once
+ * and the coarse blocks have no ghost cells. Cell data is either sampled
+ * from the first fine cell (MODE_STRIDE) or averaged over the fine cells
+ * (MODE_BOX). A box average reaches into the block's ghost cells, which
+ * gives the same result as on a single block when there are at least f - 1
+ * layers of ghost cells. Point data is sampled. Fine cells at the upper end
+ * of the mesh that do not fill a coarse cell are dropped.
+ *
+ * svtkOverlappingAMR meshes are flattened by dropping the levels above a
+ * maximum level. Cells of the new finest level that were blanked because
+ * they were refined by a dropped level are unblanked.
+ *
+ * Blocks are processed concurrently by a number of threads, and when there
+ * are fewer blocks than threads each block is split across the threads.
+ */
+class SENSEI_EXPORT Downsample : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static Downsample *New();
+
+  senseiTypeMacro(Downsample, AnalysisAdaptor);
+
+  /// the supported modes
+  enum {MODE_STRIDE, MODE_BOX};
+
+  /// convert a mode name, stride or box, into an enum. returns 0 if successful
+  static int GetMode(const std::string &name, int &mode);
+
+  /// Set the meshes and arrays to process.
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  /// Add a single array to the list of arrays to process.
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  /// set the coarsening factor along each axis. the default is 2 2 2
+  int SetFactor(int fx, int fy, int fz);
+
+  /// set how cell data is coarsened. the default is MODE_STRIDE
+  int SetMode(int mode);
+
+  /** set the finest level of AMR meshes kept in the output. The default,
+   * -1, keeps all levels.
+   */
+  void SetMaximumLevel(int level) { this->MaximumLevel = level; }
+
+  /// Set the number of threads used to process local data. The default is 1.
+  void SetNumberOfThreads(int nThreads);
+
+  /// produce the reduced resolution meshes for this time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+protected:
+  Downsample();
+  ~Downsample();
+
+  Downsample(const Downsample&) = delete;
+  void operator=(const Downsample&) = delete;
+
+  // the association and name of the arrays passed to the output
+  using ArrayList = std::vector<std::pair<int, std::string>>;
+
+  // coarsen the blocks of a logically Cartesian mesh. this is collective,
+  // ranks without data pass a null mesh. returns 0 if successful
+  int Coarsen(svtkDataObject *mesh, const ArrayList &arrays,
+    svtkDataObject *&meshOut);
+
+  // drop the levels of an AMR mesh above the maximum level. returns 0 if
+  // successful
+  int CapLevels(svtkDataObject *mesh, const ArrayList &arrays,
+    svtkDataObject *&meshOut);
+
+private:
+  DataRequirements Requirements;
+  std::array<int,3> Factor;
+  int Mode;
+  int MaximumLevel;
+  int NumberOfThreads;
+};
+
+}
+
+#endif
@@ -91,6 +91,9 @@ int HDF5DataAdaptor::OpenStream()
     {
       this->m_HDF5Reader =
         new senseiHDF5::ReadStream(this->GetCommunicator(), m_Streaming);
+
+      if (m_Collective)
+        this->m_HDF5Reader->SetCollectiveTxf();
     }
 
   if (!this->m_HDF5Reader->Init(m_StreamName))
@@ -322,11 +325,114 @@ int HDF5DataAdaptor::AddArray(svtkDataObject* mesh,
   return 0;
 }
 
+//----------------------------------------------------------------------------
+int HDF5DataAdaptor::AddArrays(svtkDataObject* mesh,
+                               const std::string& meshName,
+                               int association,
+                               const std::vector<std::string>& arrayNames)
+{
+  TimeEvent<128> mark("HDF5DataAdaptor::AddArrays");
+
+  if (!mesh)
+    {
+      SENSEI_ERROR("Invalid mesh object");
+      return -1;
+    }
+
+  if (!this->m_HDF5Reader->ReadInArrays(meshName, association, arrayNames, mesh))
+    {
+      SENSEI_ERROR("Failed to read " << SVTKUtils::GetAttributesName(association)
+                                     << " data arrays from mesh \""
+                                     << meshName << "\"");
+      return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int HDF5DataAdaptor::GetMeshBlock(const std::string& meshName,
+                                  long blockId,
+                                  bool structureOnly,
+                                  svtkDataObject*& block)
+{
+  TimeEvent<128> mark("HDF5DataAdaptor::GetMeshBlock");
+
+  if (m_Collective)
+    return this->Superclass::GetMeshBlock(meshName, blockId,
+                                          structureOnly, block);
+
+  block = nullptr;
+
+  if (!this->m_HDF5Reader->ReadMeshBlock(meshName, blockId, block,
+                                         structureOnly))
+    {
+      SENSEI_ERROR("Failed to read block " << blockId << " of mesh \""
+                                           << meshName << "\"");
+      return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int HDF5DataAdaptor::AddArrayToBlock(svtkDataObject* block,
+                                     const std::string& meshName,
+                                     long blockId,
+                                     int association,
+                                     const std::string& arrayName)
+{
+  TimeEvent<128> mark("HDF5DataAdaptor::AddArrayToBlock");
+
+  if (m_Collective)
+    return this->Superclass::AddArrayToBlock(block, meshName, blockId,
+                                             association, arrayName);
+
+  std::vector<std::string> arrayNames(1, arrayName);
+  if (!this->m_HDF5Reader->ReadInBlockArrays(meshName, blockId, association,
+                                             arrayNames, block))
+    {
+      SENSEI_ERROR("Failed to read " << SVTKUtils::GetAttributesName(association)
+                                     << " data array \"" << arrayName
+                                     << "\" of block " << blockId
+                                     << " from mesh \"" << meshName << "\"");
+      return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int HDF5DataAdaptor::AddGhostNodesArrayToBlock(svtkDataObject* block,
+                                               const std::string& meshName,
+                                               long blockId)
+{
+  if (m_Collective)
+    return this->Superclass::AddGhostNodesArrayToBlock(block, meshName,
+                                                       blockId);
+
+  return AddArrayToBlock(block, meshName, blockId, svtkDataObject::POINT,
+                         "svtkGhostType");
+}
+
+//----------------------------------------------------------------------------
+int HDF5DataAdaptor::AddGhostCellsArrayToBlock(svtkDataObject* block,
+                                               const std::string& meshName,
+                                               long blockId)
+{
+  if (m_Collective)
+    return this->Superclass::AddGhostCellsArrayToBlock(block, meshName,
+                                                       blockId);
+
+  return AddArrayToBlock(block, meshName, blockId, svtkDataObject::CELL,
+                         "svtkGhostType");
+}
+
 //----------------------------------------------------------------------------
 int HDF5DataAdaptor::ReleaseData()
 {
   TimeEvent<128> mark("HDF5DataAdaptor::ReleaseData");
-  return 0;
+  return this->Superclass::ReleaseData();
 }
 
 }
@@ -49,6 +49,32 @@ public:
   int AddArray(svtkDataObject *mesh, const std::string &meshName,
                int association, const std::string &arrayName) override;
 
+  // reads the blocks of all of the arrays together
+  int AddArrays(svtkDataObject *mesh, const std::string &meshName,
+                int association,
+                const std::vector<std::string> &arrayNames) override;
+
+  // read a single block from the file. with collective transfers all ranks
+  // must make the same calls, then the blocks are served from the whole
+  // mesh by the default implementation.
+  int GetMeshBlock(const std::string &meshName, long blockId,
+                   bool structureOnly, svtkDataObject *&block) override;
+
+  int AddArrayToBlock(svtkDataObject *block, const std::string &meshName,
+                      long blockId, int association,
+                      const std::string &arrayName) override;
+
+  int AddGhostNodesArrayToBlock(svtkDataObject *block,
+                                const std::string &meshName,
+                                long blockId) override;
+
+  int AddGhostCellsArrayToBlock(svtkDataObject *block,
+                                const std::string &meshName,
+                                long blockId) override;
+
+  bool StreamsMeshBlocks(const std::string &) override
+  { return !m_Collective; }
+
   int ReleaseData() override;
 
   // intransit:
@@ -40,6 +40,8 @@
 #include <svtkUnsignedLongLongArray.h>
 #include <svtkUnstructuredGrid.h>
 
+#include <algorithm>
+#include <cstring>
 #include <map>
 #include <set>
 #include <sstream>
@@ -50,6 +52,13 @@
 
 #include "BlockPartitioner.h"
 
+// H5Dread_multi reads many datasets in a single call
+#if defined(H5_VERSION_GE)
+#if H5_VERSION_GE(1, 14, 0)
+#define SENSEI_HDF5_READ_MULTI
+#endif
+#endif
+
 namespace senseiHDF5
 {
 static const std::string ATTRNAME_TIMESTEP = "timestep";
@@ -760,6 +769,204 @@ bool ReadStream::ReadVar1D(const std::string &name,
   return true;
 }
 
+void ReadStream::BeginReadBatch()
+{
+  m_Batching = true;
+  m_Batch.clear();
+}
+
+void ReadStream::DeclareVar1D(const std::string &name)
+{
+  if(m_Batching)
+    m_Batch[name];
+}
+
+bool ReadStream::QueueVar1D(const std::string &name,
+                            hsize_t s,
+                            hsize_t c,
+                            void *data)
+{
+  if(!m_Batching)
+    return ReadVar1D(name, s, c, data);
+
+  ReadRequest req = { s, c, data };
+  m_Batch[name].push_back(req);
+
+  return true;
+}
+
+bool ReadStream::EndReadBatch()
+{
+  m_Batching = false;
+
+  // the per dataset selections and the buffers they are read into. the
+  // selections are merged into disjoint runs, sorted by position in the
+  // file, which is the order HDF5 fills the memory space in.
+  size_t nVars = m_Batch.size();
+  std::vector<hid_t> varIds(nVars, -1);
+  std::vector<hid_t> memTypes(nVars, -1);
+  std::vector<hid_t> fileSpaces(nVars, -1);
+  std::vector<hid_t> memSpaces(nVars, -1);
+  std::vector<void *> bufs(nVars, nullptr);
+  std::vector<std::vector<char>> staging(nVars);
+
+  bool ok = true;
+  hsize_t bytes = 0;
+
+  std::map<std::string, std::vector<ReadRequest>>::iterator bit =
+    m_Batch.begin();
+
+  for(size_t i = 0; ok && (i < nVars); ++i, ++bit)
+    {
+      varIds[i] = H5Dopen(m_Streamer->m_TimeStepId, bit->first.c_str(), H5P_DEFAULT);
+      if(varIds[i] < 0)
+        {
+          SENSEI_ERROR("Failed to open H5 dataset: " << bit->first);
+          ok = false;
+          break;
+        }
+
+      memTypes[i] = H5Dget_type(varIds[i]);
+      fileSpaces[i] = H5Dget_space(varIds[i]);
+
+      std::vector<ReadRequest> &reqs = bit->second;
+      std::sort(reqs.begin(), reqs.end(),
+                [](const ReadRequest &l, const ReadRequest &r)
+                { return l.m_Start < r.m_Start; });
+
+      // merge overlapping and adjacent selections
+      std::vector<std::pair<hsize_t, hsize_t>> runs;
+      size_t nReqs = 0;
+      void *data = nullptr;
+      for(size_t j = 0; j < reqs.size(); ++j)
+        {
+          if(reqs[j].m_Count == 0)
+            continue;
+
+          ++nReqs;
+          data = reqs[j].m_Data;
+
+          hsize_t s = reqs[j].m_Start;
+          hsize_t e = s + reqs[j].m_Count;
+          if(runs.size() && (s <= runs.back().second))
+            runs.back().second = std::max(runs.back().second, e);
+          else
+            runs.push_back(std::make_pair(s, e));
+        }
+
+      H5Sselect_none(fileSpaces[i]);
+      hsize_t total = 0;
+      for(size_t j = 0; j < runs.size(); ++j)
+        {
+          hsize_t start[1] = { runs[j].first };
+          hsize_t count[1] = { runs[j].second - runs[j].first };
+          H5Sselect_hyperslab(
+            fileSpaces[i], H5S_SELECT_OR, start, NULL, count, NULL);
+          total += count[0];
+        }
+
+      hsize_t memDims[1] = { std::max<hsize_t>(total, 1) };
+      memSpaces[i] = H5Screate_simple(1, memDims, NULL);
+      if(total == 0)
+        H5Sselect_none(memSpaces[i]);
+
+      // a lone request is read in place, otherwise through a staging
+      // buffer that is scattered once the read completes
+      size_t elemSize = H5Tget_size(memTypes[i]);
+      if(nReqs == 1)
+        {
+          bufs[i] = data;
+        }
+      else if(total)
+        {
+          staging[i].resize(total * elemSize);
+          bufs[i] = staging[i].data();
+        }
+      else
+        {
+          bufs[i] = &elemSize;
+        }
+
+      bytes += total * elemSize;
+    }
+
+  if(ok)
+    {
+      std::ostringstream oss;
+      oss << "H5BytesRead=" << bytes;
+      std::string evtName = oss.str();
+      sensei::TimeEvent<128> mark(evtName.c_str());
+
+#if defined(SENSEI_HDF5_READ_MULTI)
+      if(nVars && (H5Dread_multi(nVars, varIds.data(), memTypes.data(),
+            memSpaces.data(), fileSpaces.data(), m_CollectiveTxf,
+            bufs.data()) < 0))
+        {
+          SENSEI_ERROR("Failed to read " << nVars << " H5 datasets");
+          ok = false;
+        }
+#else
+      for(size_t i = 0; i < nVars; ++i)
+        {
+          if(H5Dread(varIds[i], memTypes[i], memSpaces[i], fileSpaces[i],
+                m_CollectiveTxf, bufs[i]) < 0)
+            {
+              SENSEI_ERROR("Failed to read H5 dataset " << i);
+              ok = false;
+            }
+        }
+#endif
+    }
+
+  // scatter the staged data to the requests
+  bit = m_Batch.begin();
+  for(size_t i = 0; ok && (i < nVars); ++i, ++bit)
+    {
+      if(staging[i].empty())
+        continue;
+
+      const std::vector<ReadRequest> &reqs = bit->second;
+      size_t elemSize = H5Tget_size(memTypes[i]);
+
+      // position of each request in the staging buffer
+      hsize_t runStart = 0;
+      hsize_t runEnd = 0;
+      hsize_t stagingOffset = 0;
+      for(size_t j = 0; j < reqs.size(); ++j)
+        {
+          if(reqs[j].m_Count == 0)
+            continue;
+
+          if(reqs[j].m_Start >= runEnd)
+            {
+              stagingOffset += runEnd - runStart;
+              runStart = reqs[j].m_Start;
+            }
+          runEnd = std::max(runEnd, reqs[j].m_Start + reqs[j].m_Count);
+
+          hsize_t pos = stagingOffset + reqs[j].m_Start - runStart;
+          memcpy(reqs[j].m_Data, staging[i].data() + pos * elemSize,
+                 reqs[j].m_Count * elemSize);
+        }
+    }
+
+  for(size_t i = 0; i < nVars; ++i)
+    {
+      if(memSpaces[i] >= 0)
+        H5Sclose(memSpaces[i]);
+      if(fileSpaces[i] >= 0)
+        H5Sclose(fileSpaces[i]);
+      if(memTypes[i] >= 0)
+        H5Tclose(memTypes[i]);
+      if(varIds[i] >= 0)
+        H5Dclose(varIds[i]);
+    }
+
+  m_Batch.clear();
+
+  return ok;
+}
+
 bool ReadStream::ReadBinary(const std::string &name, sensei::BinaryStream &str)
 {
   hid_t varID = H5Dopen(m_Streamer->m_TimeStepId, name.c_str(), H5P_DEFAULT);
@@ -902,17 +1109,140 @@ bool ReadStream::ReadInArray(const std::string &meshName,
   return true;
 }
 
+bool ReadStream::ReadInArrays(const std::string &meshName,
+                              int association,
+                              const std::vector<std::string> &array_names,
+                              svtkDataObject *dobj)
+{
+  unsigned int meshId;
+  if(m_AllMeshInfo.GetMeshId(meshName, meshId) < 0)
+    return false;
+
+  MeshFlow m(dynamic_cast<svtkCompositeDataSet *>(dobj), meshId);
+
+  if(!m.ReadArrays(this, array_names, association))
+    {
+      SENSEI_ERROR("Failed to read "
+                   << sensei::SVTKUtils::GetAttributesName(association)
+                   << " data arrays from object \"" << meshName << "\"");
+      return false;
+    }
+  return true;
+}
+
+bool ReadStream::ReadMeshBlock(const std::string &name,
+                               long blockId,
+                               svtkDataObject *&block,
+                               bool structure_only)
+{
+  block = nullptr;
+
+  unsigned int meshId;
+  if(m_AllMeshInfo.GetMeshId(name, meshId) < 0)
+    return false;
+
+  MeshFlow m(nullptr, meshId, blockId);
+  bool ok = m.ReadFrom(this, structure_only);
+
+  // the object holds the requested block, the others are empty
+  svtkMultiBlockDataSet *mb = dynamic_cast<svtkMultiBlockDataSet *>(m.m_VtkPtr);
+  if(ok && mb && (blockId >= 0) && (blockId < mb->GetNumberOfBlocks()))
+    {
+      block = mb->GetBlock(blockId);
+      if(block)
+        block->Register(nullptr);
+    }
+
+  if(m.m_VtkPtr)
+    m.m_VtkPtr->Delete();
+
+  if(!block)
+    {
+      SENSEI_ERROR("Failed to read block " << blockId << " of object \""
+                   << name << "\"");
+      return false;
+    }
+
+  return true;
+}
+
+bool ReadStream::ReadInBlockArrays(const std::string &meshName,
+                                   long blockId,
+                                   int association,
+                                   const std::vector<std::string> &array_names,
+                                   svtkDataObject *block)
+{
+  unsigned int meshId;
+  if(m_AllMeshInfo.GetMeshId(meshName, meshId) < 0)
+    return false;
+
+  sensei::MeshMetadataPtr md;
+  if(!ReadReceiverMeshMetaData(meshId, md) || (blockId < 0) ||
+      (blockId >= md->NumBlocks) || !block)
+    {
+      SENSEI_ERROR("Invalid block " << blockId << " of object \""
+                   << meshName << "\"");
+      return false;
+    }
+
+  // place the block where the readers expect it
+  svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+  mb->SetNumberOfBlocks(md->NumBlocks);
+  mb->SetBlock(blockId, block);
+
+  MeshFlow m(mb, meshId, blockId);
+  bool ok = m.ReadArrays(this, array_names, association);
+
+  mb->Delete();
+
+  if(!ok)
+    {
+      SENSEI_ERROR("Failed to read "
+                   << sensei::SVTKUtils::GetAttributesName(association)
+                   << " data arrays of block " << blockId << " from object \""
+                   << meshName << "\"");
+      return false;
+    }
+
+  return true;
+}
+
 //
 //
 //
-MeshFlow::MeshFlow(svtkCompositeDataSet *cd, unsigned int meshID)
+MeshFlow::MeshFlow(svtkCompositeDataSet *cd, unsigned int meshID,
+                   long blockID)
   : m_VtkPtr(cd)
   , m_MeshID(meshID)
+  , m_BlockID(blockID)
 {
 }
 
 MeshFlow::~MeshFlow() {}
 
+sensei::MeshMetadataPtr MeshFlow::GetMetadata(ReadStream *input)
+{
+  sensei::MeshMetadataPtr md;
+  input->ReadReceiverMeshMetaData(m_MeshID, md);
+
+  if(!md || (m_BlockID < 0))
+    return md;
+
+  // the blocks are read by their owner and skipped by the others while the
+  // offsets into the file are accumulated. disowning the other blocks reads
+  // only the selected one.
+  sensei::MeshMetadataPtr bmd = md->NewCopy();
+
+  unsigned int num_blocks = bmd->NumBlocks;
+  for(unsigned int j = 0; j < num_blocks; ++j)
+    {
+      if(bmd->BlockIds[j] != m_BlockID)
+        bmd->BlockOwner[j] = -1;
+    }
+
+  return bmd;
+}
+
 bool MeshFlow::ValidateMetaData(const sensei::MeshMetadataPtr &md)
 {
   unsigned int num_arrays = md->NumArrays;
@@ -992,52 +1322,83 @@ bool MeshFlow::ReadArray(ReadStream *reader,
                          const std::string &array_name,
                          int association)
 {
-  if(ReadBlockOwnerArray(reader, array_name, association))
-    return true;
+  return ReadArrays(reader, std::vector<std::string>(1, array_name),
+                    association);
+}
 
-  sensei::MeshMetadataPtr md;
-  reader->ReadReceiverMeshMetaData(m_MeshID, md);
+bool MeshFlow::ReadArrays(ReadStream *reader,
+                          const std::vector<std::string> &array_names,
+                          int association)
+{
+  sensei::MeshMetadataPtr md = this->GetMetadata(reader);
 
-  //unsigned int num_blocks = md->NumBlocks;
   unsigned int num_arrays = md->NumArrays;
 
-  if (array_name == TAG_SVTK_GHOST) {
-    ArrayFlow arrayFlow(m_MeshID, association, md);
-    Load(&arrayFlow, md, reader);
-    return true;
-  }
+  // gather the requested arrays so that all of their blocks are read at once
+  std::vector<ArrayFlow *> arrayFlows;
+  for (size_t k = 0; k < array_names.size(); ++k) {
+    const std::string &array_name = array_names[k];
+
+    if (ReadBlockOwnerArray(reader, array_name, association))
+      continue;
 
-  // read data arrays
-  for (unsigned int i = 0; i < num_arrays; ++i) {
-    // skip all but the requested array
-    if ((association != md->ArrayCentering[i]) ||
-        (array_name != md->ArrayName[i]))
+    if (array_name == TAG_SVTK_GHOST) {
+      arrayFlows.push_back(new ArrayFlow(m_MeshID, association, md));
       continue;
+    }
+
+    // read data arrays
+    for (unsigned int i = 0; i < num_arrays; ++i) {
+      // skip all but the requested array
+      if ((association != md->ArrayCentering[i]) ||
+          (array_name != md->ArrayName[i]))
+        continue;
 
-    ArrayFlow arrayFlow(md, m_MeshID, i);
-    Load(&arrayFlow, md, reader);
+      arrayFlows.push_back(new ArrayFlow(md, m_MeshID, i));
+    }
   }
 
-  return true;
+  bool ok = Load(arrayFlows, md, reader);
+
+  for (size_t k = 0; k < arrayFlows.size(); ++k)
+    delete arrayFlows[k];
+
+  return ok;
 }
 
-void MeshFlow::Load(ArrayFlow *arrayFlowPtr, const sensei::MeshMetadataPtr &md,
+bool MeshFlow::Load(std::vector<ArrayFlow *> &arrayFlows,
+                    const sensei::MeshMetadataPtr &md,
                     ReadStream *reader) {
+  if (arrayFlows.empty())
+    return true;
+
   unsigned int num_blocks = md->NumBlocks;
+  size_t num_flows = arrayFlows.size();
 
   svtkCompositeDataIterator *it = m_VtkPtr->NewIterator();
   it->SetSkipEmptyNodes(0);
   it->InitTraversal();
 
+  reader->BeginReadBatch();
+
+  for (size_t k = 0; k < num_flows; ++k)
+    arrayFlows[k]->declare(reader);
+
+  bool ok = true;
   for (unsigned int j = 0; j < num_blocks; ++j) {
-    if (md->BlockOwner[j] == reader->m_Rank) {
-      arrayFlowPtr->load(j, it, reader);
+    for (size_t k = 0; k < num_flows; ++k) {
+      if (md->BlockOwner[j] == reader->m_Rank)
+        ok &= arrayFlows[k]->load(j, it, reader);
+      arrayFlows[k]->update(j);
     }
-    arrayFlowPtr->update(j);
     it->GoToNextItem();
   }
 
   it->Delete();
+
+  ok &= reader->EndReadBatch();
+
+  return ok;
 }
 
 
@@ -1070,8 +1431,7 @@ bool MeshFlow::Initialize(const sensei::MeshMetadataPtr &md, ReadStream *input)
 
 bool MeshFlow::ReadFrom(ReadStream *input, bool structure_only)
 {
-  sensei::MeshMetadataPtr md;
-  input->ReadReceiverMeshMetaData(m_MeshID, md);
+  sensei::MeshMetadataPtr md = this->GetMetadata(input);
 
   unsigned int num_blocks = md->NumBlocks;
 
@@ -1090,18 +1450,28 @@ bool MeshFlow::ReadFrom(ReadStream *input, bool structure_only)
     it->SetSkipEmptyNodes(0);
     it->InitTraversal();
 
+    input->BeginReadBatch();
+
     WorkerCollection workerPool(md, m_MeshID);
+    workerPool.declare(input);
+
+    bool ok = true;
     for(unsigned int j = 0; j < num_blocks; ++j)
       {
         if(input->m_Rank == md->BlockOwner[j])
           {
-            workerPool.load(j, it, input);
+            ok &= workerPool.load(j, it, input);
           }
         workerPool.update(j);
         it->GoToNextItem();
       }
 
     it->Delete();
+
+    ok &= input->EndReadBatch();
+
+    if(!ok)
+      return false;
   }
 
   return true;
@@ -1254,6 +1624,14 @@ bool WorkerCollection::update(unsigned int block_id)
     }
   return true;
 }
+
+void WorkerCollection::declare(ReadStream *reader)
+{
+  for(size_t i = 0; i < m_Workers.size(); i++)
+    {
+      m_Workers[i]->declare(reader);
+    }
+}
 //
 //
 //
@@ -1339,7 +1717,7 @@ bool ArrayFlow::load(unsigned int block_id,
   array->SetName(GetArrayName().c_str());
   array->SetNumberOfTuples(num_elem_local);
 
-  if(!reader->ReadVar1D(m_ArrayPath, start, count, array->GetVoidPointer(0)))
+  if(!reader->QueueVar1D(m_ArrayPath, start, count, array->GetVoidPointer(0)))
     return false;
 
   // pass to svtk
@@ -1416,6 +1794,11 @@ unsigned long long ArrayFlow::getLocalElement(unsigned int block_id)
           : m_Metadata->BlockNumCells[block_id]);
 }
 
+void ArrayFlow::declare(ReadStream *reader)
+{
+  reader->DeclareVar1D(m_ArrayPath);
+}
+
 bool ArrayFlow::update(unsigned int block_id)
 {
   unsigned long long num_elem_local =
@@ -1882,7 +2265,7 @@ bool PointFlow::load(unsigned int block_id,
   // std::string path = ons + "points";
   // std::string path;
 
-  if(!reader->ReadVar1D(
+  if(!reader->QueueVar1D(
         m_PointVarName, start, count, points->GetVoidPointer(0)))
     return false;
 
@@ -1932,6 +2315,11 @@ bool PointFlow::unload(unsigned int block_id,
   return true;
 }
 
+void PointFlow::declare(ReadStream *reader)
+{
+  reader->DeclareVar1D(m_PointVarName);
+}
+
 bool PointFlow::update(unsigned int j)
 {
   m_BlockOffset += m_Metadata->BlockNumPoints[j];
@@ -2190,13 +2578,13 @@ bool StretchedCartesianFlow::load(unsigned int block_id,
   z_coords->SetNumberOfTuples(local[2]);
   z_coords->SetName("z_coords");
 
-  if(!reader->ReadVar1D(
+  if(!reader->QueueVar1D(
         m_XPath, m_BlockOffset[0], local[0], x_coords->GetVoidPointer(0)))
     return false;
-  if(!reader->ReadVar1D(
+  if(!reader->QueueVar1D(
         m_YPath, m_BlockOffset[1], local[1], y_coords->GetVoidPointer(0)))
     return false;
-  if(!reader->ReadVar1D(
+  if(!reader->QueueVar1D(
         m_ZPath, m_BlockOffset[2], local[2], z_coords->GetVoidPointer(0)))
     return false;
 
@@ -2262,6 +2650,13 @@ bool StretchedCartesianFlow::unload(unsigned int block_id,
   return true;
 }
 
+void StretchedCartesianFlow::declare(ReadStream *reader)
+{
+  reader->DeclareVar1D(m_XPath);
+  reader->DeclareVar1D(m_YPath);
+  reader->DeclareVar1D(m_ZPath);
+}
+
 bool StretchedCartesianFlow::update(unsigned int block_id)
 {
   unsigned long long temp[3];
@@ -10,6 +10,7 @@ typedef struct _ADIOS_FILE ADIOS_FILE;
 #include "hdf5.h"
 //#include <adios_read.h>
 #include <cstdint>
+#include <map>
 #include <mpi.h>
 #include <set>
 #include <string>
@@ -266,6 +267,26 @@ public:
                    const std::string &array_name,
                    svtkDataObject *dobj);
 
+  bool ReadInArrays(const std::string &meshName,
+                    int association,
+                    const std::vector<std::string> &array_names,
+                    svtkDataObject *dobj);
+
+  // read a single block of the named mesh. the caller takes ownership of the
+  // returned block. when collective transfers are enabled all ranks must
+  // read the same number of blocks.
+  bool ReadMeshBlock(const std::string &name,
+                     long blockId,
+                     svtkDataObject *&block,
+                     bool structure_only);
+
+  // read the named arrays of a single block returned from ReadMeshBlock
+  bool ReadInBlockArrays(const std::string &meshName,
+                         long blockId,
+                         int association,
+                         const std::vector<std::string> &array_names,
+                         svtkDataObject *block);
+
   bool ReadNativeAttr(const std::string &name,
                       void *val,
                       hid_t h5Type,
@@ -273,8 +294,29 @@ public:
   bool ReadBinary(const std::string &name, sensei::BinaryStream &str);
   bool ReadVar1D(const std::string &name, hsize_t s, hsize_t c, void *data);
 
+  // batched reads. between BeginReadBatch and EndReadBatch the reads passed
+  // to QueueVar1D are deferred, data must not be accessed until EndReadBatch
+  // returns. EndReadBatch combines the selections on each dataset into one
+  // hyperslab union and reads the datasets in name order, with H5Dread_multi
+  // where available. When collective transfers are enabled all ranks must
+  // make the same calls to DeclareVar1D.
+  void BeginReadBatch();
+  void DeclareVar1D(const std::string &name);
+  bool QueueVar1D(const std::string &name, hsize_t s, hsize_t c, void *data);
+  bool EndReadBatch();
+
 private:
+  struct ReadRequest
+  {
+    hsize_t m_Start;
+    hsize_t m_Count;
+    void *m_Data;
+  };
+
   unsigned int m_TimeStepTotal;
+
+  bool m_Batching = false;
+  std::map<std::string, std::vector<ReadRequest>> m_Batch;
 };
 
 class ArrayFlow;
@@ -285,7 +327,8 @@ class ArrayFlow;
 class MeshFlow
 {
 public:
-  MeshFlow(svtkCompositeDataSet *, unsigned int meshID);
+  // when blockID is not negative only that block is read
+  MeshFlow(svtkCompositeDataSet *, unsigned int meshID, long blockID = -1);
   ~MeshFlow();
 
   bool ReadBlockOwnerArray(ReadStream *input,
@@ -295,6 +338,9 @@ public:
   bool ReadArray(ReadStream *input,
                  const std::string &array_name,
                  int association);
+  bool ReadArrays(ReadStream *input,
+                  const std::vector<std::string> &array_names,
+                  int association);
   bool ReadFrom(ReadStream *StreamPtr, bool structureOnly);
   bool Initialize(const sensei::MeshMetadataPtr &md, ReadStream *input);
 
@@ -305,15 +351,19 @@ public:
 private:
   bool ValidateMetaData(const sensei::MeshMetadataPtr &md);
 
+  // the receiver metadata, with all but the selected block disowned
+  sensei::MeshMetadataPtr GetMetadata(ReadStream *input);
+
   void Unload(ArrayFlow *arrayFlowPtr, 
 	      const sensei::MeshMetadataPtr &md,
               WriteStream *output);
-  void Load(ArrayFlow *arrayFlowPtr, 
-	    const sensei::MeshMetadataPtr &md,
+  bool Load(std::vector<ArrayFlow *> &arrayFlows,
+            const sensei::MeshMetadataPtr &md,
             ReadStream *reader);
 
 
   unsigned int m_MeshID;
+  long m_BlockID;
 };
 
 class SVTKObjectFlow
@@ -328,6 +378,8 @@ public:
   virtual bool unload(unsigned int block_id,
                       svtkCompositeDataIterator *it,
                       WriteStream *output) = 0;
+  // declare the datasets read through ReadStream::QueueVar1D
+  virtual void declare(ReadStream *) {}
 
 protected:
   const sensei::MeshMetadataPtr &m_Metadata;
@@ -360,6 +412,7 @@ public:
               svtkCompositeDataIterator *it,
               WriteStream *input);
   bool update(unsigned int block_id);
+  void declare(ReadStream *input);
 
 protected:
   std::vector<SVTKObjectFlow *> m_Workers;
@@ -384,6 +437,7 @@ public:
 	      svtkCompositeDataIterator *it,
               WriteStream *output);
   bool update(unsigned int block_id);
+  void declare(ReadStream *input);
 
   int GetArrayType();
   const std::string &GetArrayName();
@@ -415,6 +469,7 @@ public:
               svtkCompositeDataIterator *it,
               WriteStream *output);
   bool update(unsigned int block_id);
+  void declare(ReadStream *input);
 
 private:
   unsigned long long m_BlockOffset;
@@ -486,6 +541,7 @@ public:
               svtkCompositeDataIterator *it,
               WriteStream *output);
   bool update(unsigned int);
+  void declare(ReadStream *input);
 
 private:
   void GetLocal(int block_id, unsigned long long (&out)[3]);
@@ -0,0 +1,360 @@
+#include "HZOrder.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkCellData.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include <svtkType.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace sensei
+{
+namespace HZOrder
+{
+
+// --------------------------------------------------------------------------
+Index::Index() : Extent{{0, -1, 0, -1, 0, -1}}, Origin{{0.0, 0.0, 0.0}},
+  Spacing{{1.0, 1.0, 1.0}}, Association(svtkDataObject::POINT),
+  DataType(SVTK_FLOAT), NumberOfComponents(1), ChunkBits(16)
+{
+}
+
+// --------------------------------------------------------------------------
+int Index::Write(const std::string &fileName) const
+{
+  std::ofstream ofs(fileName);
+  if (!ofs.good())
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\" for writing")
+    return -1;
+    }
+
+  ofs.precision(17);
+
+  ofs << "# SENSEI HZ order index" << std::endl
+    << "version 1" << std::endl
+    << "array " << this->ArrayName << std::endl
+    << "association " << SVTKUtils::GetAttributesName(this->Association) << std::endl
+    << "type " << this->DataType << " " << svtkImageScalarTypeNameMacro(this->DataType) << std::endl
+    << "components " << this->NumberOfComponents << std::endl
+    << "extent " << this->Extent[0] << " " << this->Extent[1] << " "
+      << this->Extent[2] << " " << this->Extent[3] << " "
+      << this->Extent[4] << " " << this->Extent[5] << std::endl
+    << "origin " << this->Origin[0] << " " << this->Origin[1] << " "
+      << this->Origin[2] << std::endl
+    << "spacing " << this->Spacing[0] << " " << this->Spacing[1] << " "
+      << this->Spacing[2] << std::endl
+    << "chunk_bits " << this->ChunkBits << std::endl
+    << "data " << this->DataFile << std::endl;
+
+  if (!ofs.good())
+    {
+    SENSEI_ERROR("Failed to write \"" << fileName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Index::Read(const std::string &fileName)
+{
+  std::ifstream ifs(fileName);
+  if (!ifs.good())
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\"")
+    return -1;
+    }
+
+  std::string line;
+  while (std::getline(ifs, line))
+    {
+    std::istringstream iss(line);
+
+    std::string key;
+    if (!(iss >> key) || (key[0] == '#'))
+      continue;
+
+    bool ok = true;
+    if (key == "array")
+      {
+      ok = bool(iss >> this->ArrayName);
+      }
+    else if (key == "association")
+      {
+      std::string assoc;
+      ok = (iss >> assoc) && !SVTKUtils::GetAssociation(assoc, this->Association);
+      }
+    else if (key == "type")
+      {
+      ok = bool(iss >> this->DataType);
+      }
+    else if (key == "components")
+      {
+      ok = bool(iss >> this->NumberOfComponents);
+      }
+    else if (key == "extent")
+      {
+      for (int i = 0; ok && (i < 6); ++i)
+        ok = bool(iss >> this->Extent[i]);
+      }
+    else if (key == "origin")
+      {
+      for (int i = 0; ok && (i < 3); ++i)
+        ok = bool(iss >> this->Origin[i]);
+      }
+    else if (key == "spacing")
+      {
+      for (int i = 0; ok && (i < 3); ++i)
+        ok = bool(iss >> this->Spacing[i]);
+      }
+    else if (key == "chunk_bits")
+      {
+      ok = bool(iss >> this->ChunkBits);
+      }
+    else if (key == "data")
+      {
+      ok = bool(iss >> this->DataFile);
+      }
+
+    if (!ok)
+      {
+      SENSEI_ERROR("Invalid \"" << key << "\" in \"" << fileName << "\"")
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Index::GetBitMask(std::vector<int> &mask) const
+{
+  std::array<int,3> dims;
+  for (int i = 0; i < 3; ++i)
+    dims[i] = this->Extent[2*i+1] - this->Extent[2*i] + 1;
+
+  return HZOrder::GetBitMask(dims, mask);
+}
+
+// --------------------------------------------------------------------------
+int GetBitMask(const std::array<int,3> &dims, std::vector<int> &mask)
+{
+  // the number of bits needed along each axis
+  std::array<int,3> bits = {0, 0, 0};
+  for (int i = 0; i < 3; ++i)
+    while ((1l << bits[i]) < dims[i])
+      ++bits[i];
+
+  mask.clear();
+
+  int nBits = bits[0] + bits[1] + bits[2];
+  for (int i = 0; int(mask.size()) < nBits; i = (i + 1) % 3)
+    {
+    if (bits[i])
+      {
+      mask.push_back(i);
+      --bits[i];
+      }
+    }
+
+  return nBits;
+}
+
+// --------------------------------------------------------------------------
+void GetZTables(const std::vector<int> &mask, const std::array<int,3> &dims,
+  std::array<std::vector<uint64_t>,3> &tables)
+{
+  // the position in the Z-order index of each coordinate bit
+  std::array<std::vector<int>,3> positions;
+  for (size_t p = 0; p < mask.size(); ++p)
+    positions[mask[p]].push_back(p);
+
+  for (int i = 0; i < 3; ++i)
+    {
+    tables[i].resize(dims[i]);
+
+    int nb = positions[i].size();
+    for (int c = 0; c < dims[i]; ++c)
+      {
+      uint64_t z = 0;
+      for (int b = 0; b < nb; ++b)
+        z |= uint64_t((c >> b) & 1) << positions[i][b];
+      tables[i][c] = z;
+      }
+    }
+}
+
+// --------------------------------------------------------------------------
+void GetLevelStride(const std::vector<int> &mask, int level,
+  std::array<int,3> &stride)
+{
+  stride = {1, 1, 1};
+
+  // the samples of the level have the low nBits - level bits of their
+  // Z-order index clear
+  int nLow = int(mask.size()) - level;
+  for (int p = 0; p < nLow; ++p)
+    stride[mask[p]] *= 2;
+}
+
+// --------------------------------------------------------------------------
+int ReadBox(const std::string &indexFile, int level,
+  const std::array<int,6> &box, svtkImageData *&image, long *nChunksRead)
+{
+  image = nullptr;
+
+  Index index;
+  if (index.Read(indexFile))
+    return -1;
+
+  std::vector<int> mask;
+  int nBits = index.GetBitMask(mask);
+
+  if ((level < 0) || (level > nBits))
+    level = nBits;
+
+  std::array<int,3> dims;
+  for (int i = 0; i < 3; ++i)
+    dims[i] = index.Extent[2*i+1] - index.Extent[2*i] + 1;
+
+  std::array<int,3> stride;
+  GetLevelStride(mask, level, stride);
+
+  // the coarse sample extent of the part of the box inside the grid
+  std::array<int,6> cext;
+  for (int i = 0; i < 3; ++i)
+    {
+    int lo = std::max(box[2*i], index.Extent[2*i]) - index.Extent[2*i];
+    int hi = std::min(box[2*i+1], index.Extent[2*i+1]) - index.Extent[2*i];
+    cext[2*i] = (lo + stride[i] - 1) / stride[i];
+    cext[2*i+1] = hi < 0 ? -1 : hi / stride[i];
+    }
+
+  if (SVTKUtils::EmptyExtent(cext))
+    {
+    SENSEI_ERROR("The box does not intersect the grid")
+    return -1;
+    }
+
+  // the data file is relative to the index file
+  std::string dataFile = index.DataFile;
+  size_t slash = indexFile.rfind('/');
+  if ((dataFile[0] != '/') && (slash != std::string::npos))
+    dataFile = indexFile.substr(0, slash + 1) + dataFile;
+
+  std::ifstream ifs(dataFile, std::ios::binary);
+  if (!ifs.good())
+    {
+    SENSEI_ERROR("Failed to open \"" << dataFile << "\"")
+    return -1;
+    }
+
+  int chunkBits = std::min(index.ChunkBits, nBits);
+  long nChunks = 1l << (nBits - chunkBits);
+  long chunkSize = 1l << chunkBits;
+
+  std::vector<int64_t> offsets(nChunks);
+  ifs.read(reinterpret_cast<char*>(offsets.data()), nChunks*sizeof(int64_t));
+
+  svtkDataArray *da = svtkDataArray::CreateDataArray(index.DataType);
+  if (!da)
+    {
+    SENSEI_ERROR("Invalid data type " << index.DataType)
+    return -1;
+    }
+
+  long nx = cext[1] - cext[0] + 1;
+  long ny = cext[3] - cext[2] + 1;
+  long nz = cext[5] - cext[4] + 1;
+
+  da->SetName(index.ArrayName.c_str());
+  da->SetNumberOfComponents(index.NumberOfComponents);
+  da->SetNumberOfTuples(nx*ny*nz);
+
+  long sampleBytes = index.NumberOfComponents * da->GetDataTypeSize();
+  char *pda = static_cast<char*>(da->GetVoidPointer(0));
+
+  std::array<std::vector<uint64_t>,3> zt;
+  GetZTables(mask, dims, zt);
+
+  // read each chunk once, chunks that were not written hold zeros
+  std::map<long, std::vector<char>> chunks;
+  long nRead = 0;
+
+  for (int k = cext[4]; k <= cext[5]; ++k)
+    {
+    for (int j = cext[2]; j <= cext[3]; ++j)
+      {
+      uint64_t zjk = zt[1][j*stride[1]] | zt[2][k*stride[2]];
+      for (int i = cext[0]; i <= cext[1]; ++i, pda += sampleBytes)
+        {
+        uint64_t hz = GetHZIndex(zjk | zt[0][i*stride[0]], nBits);
+        long c = hz >> chunkBits;
+
+        auto it = chunks.find(c);
+        if (it == chunks.end())
+          {
+          std::vector<char> &chunk = chunks[c];
+          chunk.assign(chunkSize*sampleBytes, 0);
+          if (offsets[c] >= 0)
+            {
+            ifs.seekg(offsets[c]);
+            ifs.read(chunk.data(), chunk.size());
+            if (!ifs.good())
+              {
+              SENSEI_ERROR("Failed to read chunk " << c << " of \""
+                << dataFile << "\"")
+              da->Delete();
+              return -1;
+              }
+            ++nRead;
+            }
+          it = chunks.find(c);
+          }
+
+        memcpy(pda, it->second.data() + (hz & (chunkSize - 1))*sampleBytes,
+          sampleBytes);
+        }
+      }
+    }
+
+  // the samples of cell data are the cells of the image
+  bool cells = index.Association == svtkDataObject::CELL;
+
+  image = svtkImageData::New();
+  image->SetExtent(cext[0], cext[1] + (cells ? 1 : 0), cext[2],
+    cext[3] + (cells ? 1 : 0), cext[4], cext[5] + (cells ? 1 : 0));
+
+  double origin[3];
+  double spacing[3];
+  for (int i = 0; i < 3; ++i)
+    {
+    origin[i] = index.Origin[i] + index.Extent[2*i]*index.Spacing[i];
+    spacing[i] = stride[i]*index.Spacing[i];
+    }
+  image->SetOrigin(origin);
+  image->SetSpacing(spacing);
+
+  if (cells)
+    image->GetCellData()->AddArray(da);
+  else
+    image->GetPointData()->AddArray(da);
+  da->Delete();
+
+  if (nChunksRead)
+    *nChunksRead = nRead;
+
+  return 0;
+}
+
+}
+}
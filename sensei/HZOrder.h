@@ -0,0 +1,106 @@
+#ifndef sensei_HZOrder_h
+#define sensei_HZOrder_h
+
+/// @file
+
+#include "senseiConfig.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class svtkImageData;
+
+namespace sensei
+{
+
+/** Hierarchical Z-order (HZ) layout of the samples of a uniform grid, as
+ * used by the IDX format. The sample index space is padded to a power of two
+ * along each axis and the bits of the sample coordinates are interleaved into
+ * a Z-order (Morton) index. The bits are assigned from the least significant
+ * end cycling over the axes that have bits left, so that an axis with more
+ * bits than the others gets its extra bits at the coarse end. The HZ index
+ * reorders the Z-order index by level of detail. Level 0 holds the first
+ * sample, level l > 0 holds the samples with HZ index in [2^(l-1), 2^l), and
+ * the samples of levels 0 through l form a grid subsampled by a power of two
+ * along each axis. Reading a prefix of the HZ ordered data therefore gives a
+ * coarse view of the whole grid.
+ *
+ * The data of an array is stored in a file that starts with a table of the
+ * file offsets of fixed size chunks of HZ ordered samples, -1 for chunks
+ * that hold no samples and were not written, followed by the chunks. A text
+ * index file describes the grid, the layout and the type of the array.
+ */
+namespace HZOrder
+{
+
+/// the description of an HZ ordered array, stored in the index file
+struct SENSEI_EXPORT Index
+{
+  Index();
+
+  /// write the index to a text file. returns 0 if successful
+  int Write(const std::string &fileName) const;
+
+  /// read the index from a text file. returns 0 if successful
+  int Read(const std::string &fileName);
+
+  /// get the number of bits of the HZ index and the axis of each bit
+  int GetBitMask(std::vector<int> &mask) const;
+
+  std::array<int,6> Extent;   ///< the extent of the samples
+  std::array<double,3> Origin;  ///< the origin of the mesh
+  std::array<double,3> Spacing; ///< the spacing of the mesh
+  int Association;            ///< svtkDataObject::POINT or CELL
+  int DataType;               ///< the SVTK data type of the array
+  int NumberOfComponents;     ///< the number of components of the array
+  int ChunkBits;              ///< log2 of the number of samples per chunk
+  std::string ArrayName;      ///< the name of the array
+  std::string DataFile;       ///< the data file, relative to the index file
+};
+
+/** Get the axis of each bit of the Z-order index of a grid with the given
+ * number of samples along each axis, least significant bit first. Returns
+ * the number of bits.
+ */
+SENSEI_EXPORT
+int GetBitMask(const std::array<int,3> &dims, std::vector<int> &mask);
+
+/** Get tables, one per axis, that map a sample coordinate, relative to the
+ * start of the extent, to its bits of the Z-order index.
+ */
+SENSEI_EXPORT
+void GetZTables(const std::vector<int> &mask, const std::array<int,3> &dims,
+  std::array<std::vector<uint64_t>,3> &tables);
+
+/// convert a Z-order index of nBits bits into an HZ index
+inline uint64_t GetHZIndex(uint64_t z, int nBits)
+{
+  uint64_t zz = z | (uint64_t(1) << nBits);
+  return zz >> (__builtin_ctzll(zz) + 1);
+}
+
+/** Get the spacing, in samples, along each axis of the grid formed by the
+ * samples of levels 0 through level.
+ */
+SENSEI_EXPORT
+void GetLevelStride(const std::vector<int> &mask, int level,
+  std::array<int,3> &stride);
+
+/** Read the samples of levels 0 through level that lie in the sample extent
+ * box. Only the chunks holding those samples are read. The samples are
+ * returned in an image with the association of the array, whose spacing is
+ * that of the mesh times the stride of the level. A negative level reads
+ * all levels. The number of chunks read is returned in nChunksRead when it
+ * is not null. Returns 0 if successful.
+ */
+SENSEI_EXPORT
+int ReadBox(const std::string &indexFile, int level,
+  const std::array<int,6> &box, svtkImageData *&image,
+  long *nChunksRead = nullptr);
+
+}
+}
+
+#endif
@@ -0,0 +1,676 @@
+#include "HZOrderWriter.h"
+#include "HZOrder.h"
+#include "DataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkImageData.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+// **************************************************************************
+/** The aggregators own contiguous ranges of chunks. The first nChunks %
+ * nAgg aggregators own one more chunk than the others.
+ */
+struct ChunkMap
+{
+  ChunkMap(long nChunks, int nAgg, int nRanks) : NumberOfChunks(nChunks),
+    NumberOfAggregators(nAgg), NumberOfRanks(nRanks),
+    Size(nChunks / nAgg), NumberLarge(nChunks % nAgg) {}
+
+  // the aggregator that owns a chunk
+  int GetAggregator(long c) const
+  {
+    long nInLarge = this->NumberLarge*(this->Size + 1);
+    return c < nInLarge ? c / (this->Size + 1) :
+      this->NumberLarge + (c - nInLarge) / this->Size;
+  }
+
+  // the rank of an aggregator, spread evenly over the ranks
+  int GetRank(int agg) const
+  {
+    return long(agg)*this->NumberOfRanks / this->NumberOfAggregators;
+  }
+
+  // the chunks [c0, c1) owned by the aggregator on a rank, empty if the rank
+  // is not an aggregator
+  void GetChunks(int rank, long &c0, long &c1) const
+  {
+    c0 = c1 = 0;
+
+    int agg = (long(rank)*this->NumberOfAggregators + this->NumberOfRanks - 1)
+      / this->NumberOfRanks;
+
+    if ((agg >= this->NumberOfAggregators) || (this->GetRank(agg) != rank))
+      return;
+
+    c0 = agg*this->Size + std::min<long>(agg, this->NumberLarge);
+    c1 = c0 + this->Size + (agg < this->NumberLarge ? 1 : 0);
+  }
+
+  long NumberOfChunks;
+  int NumberOfAggregators;
+  int NumberOfRanks;
+  long Size;
+  long NumberLarge;
+};
+
+// **************************************************************************
+// get the flat index of sample (i,j,k) in an array with the given extent
+inline long GetFlatIndex(const std::array<int,6> &ext, int i, int j, int k)
+{
+  long nx = ext[1] - ext[0] + 1;
+  long ny = ext[3] - ext[2] + 1;
+  return (long(k - ext[4])*ny + (j - ext[2]))*nx + (i - ext[0]);
+}
+}
+
+namespace sensei
+{
+//-----------------------------------------------------------------------------
+senseiNewMacro(HZOrderWriter);
+
+//-----------------------------------------------------------------------------
+HZOrderWriter::HZOrderWriter() : OutputDir("./"), FileName("data"),
+  ChunkBits(16), NumberOfAggregators(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+HZOrderWriter::~HZOrderWriter()
+{
+}
+
+//-----------------------------------------------------------------------------
+int HZOrderWriter::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int HZOrderWriter::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int HZOrderWriter::SetChunkBits(int bits)
+{
+  if ((bits < 0) || (bits > 30))
+    {
+    SENSEI_ERROR("Invalid chunk bits " << bits << ". The chunk bits must"
+      " be in [0, 30]")
+    return -1;
+    }
+
+  this->ChunkBits = bits;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void HZOrderWriter::SetNumberOfAggregators(int n)
+{
+  this->NumberOfAggregators = n < 0 ? 0 : n;
+}
+
+//-----------------------------------------------------------------------------
+int HZOrderWriter::WriteArray(const std::string &fileName,
+  const std::vector<svtkImageData*> &blocks,
+  const std::vector<std::array<int,6>> &sampleExt,
+  const std::array<int,6> &wholeExt, const double *origin,
+  const double *spacing, int association, const std::string &arrayName)
+{
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  size_t nBlocks = blocks.size();
+
+  // locate the array in each block. all blocks must have the same type
+  std::vector<svtkDataArray*> arrays;
+  int typeInfo[3] = {-1, -1, 0};
+  for (size_t i = 0; i < nBlocks; ++i)
+    {
+    svtkDataArray *da =
+      blocks[i]->GetAttributes(association)->GetArray(arrayName.c_str());
+
+    if (!da)
+      {
+      SENSEI_ERROR("No " << SVTKUtils::GetAttributesName(association)
+        << " data array named \"" << arrayName << "\"")
+      typeInfo[2] = 1;
+      break;
+      }
+
+    if (i && ((da->GetDataType() != typeInfo[0]) ||
+      (da->GetNumberOfComponents() != typeInfo[1])))
+      {
+      SENSEI_ERROR("Array \"" << arrayName << "\" has a different type or"
+        " number of components in block " << i)
+      typeInfo[2] = 1;
+      break;
+      }
+
+    typeInfo[0] = da->GetDataType();
+    typeInfo[1] = da->GetNumberOfComponents();
+
+    // other layouts are converted
+    if (!da->HasStandardMemoryLayout())
+      {
+      svtkDataArray *tmp = svtkDataArray::CreateDataArray(da->GetDataType());
+      tmp->DeepCopy(da);
+      da = tmp;
+      }
+    else
+      {
+      da->Register(nullptr);
+      }
+
+    arrays.push_back(da);
+    }
+
+  // ranks without data learn the type from the others, and all ranks bail
+  // out together
+  MPI_Allreduce(MPI_IN_PLACE, typeInfo, 3, MPI_INT, MPI_MAX, comm);
+
+  if (typeInfo[2])
+    {
+    for (size_t i = 0; i < arrays.size(); ++i)
+      arrays[i]->UnRegister(nullptr);
+    return -1;
+    }
+
+  int dataType = typeInfo[0];
+  int nComps = typeInfo[1];
+  long sampleBytes = nComps*svtkDataArray::GetDataTypeSize(dataType);
+
+  // the layout
+  std::array<int,3> dims;
+  for (int i = 0; i < 3; ++i)
+    dims[i] = wholeExt[2*i+1] - wholeExt[2*i] + 1;
+
+  std::vector<int> mask;
+  int nBits = HZOrder::GetBitMask(dims, mask);
+
+  int chunkBits = std::min(this->ChunkBits, nBits);
+  long nChunks = 1l << (nBits - chunkBits);
+  long chunkSize = 1l << chunkBits;
+  long chunkBytes = chunkSize*sampleBytes;
+
+  if (chunkBytes > INT_MAX)
+    {
+    SENSEI_ERROR("Chunks of " << chunkBytes << " bytes are too large")
+    for (size_t i = 0; i < nBlocks; ++i)
+      arrays[i]->UnRegister(nullptr);
+    return -1;
+    }
+
+  int nAgg = this->NumberOfAggregators ?
+    std::min(this->NumberOfAggregators, nRanks) : nRanks;
+  nAgg = std::min<long>(nAgg, nChunks);
+
+  ::ChunkMap chunkMap(nChunks, nAgg, nRanks);
+
+  std::array<std::vector<uint64_t>,3> zt;
+  HZOrder::GetZTables(mask, dims, zt);
+
+  // compute the HZ index of each local sample and count the samples sent to
+  // each aggregator
+  long nLocal = 0;
+  for (size_t b = 0; b < nBlocks; ++b)
+    {
+    const std::array<int,6> &ext = sampleExt[b];
+    nLocal += long(ext[1] - ext[0] + 1)*(ext[3] - ext[2] + 1)*(ext[5] - ext[4] + 1);
+    }
+
+  std::vector<uint64_t> hz(nLocal);
+  std::vector<int> sendCounts(nRanks, 0);
+
+  long q = 0;
+  for (size_t b = 0; b < nBlocks; ++b)
+    {
+    const std::array<int,6> &ext = sampleExt[b];
+    for (int k = ext[4]; k <= ext[5]; ++k)
+      {
+      for (int j = ext[2]; j <= ext[3]; ++j)
+        {
+        uint64_t zjk = zt[1][j - wholeExt[2]] | zt[2][k - wholeExt[4]];
+        for (int i = ext[0]; i <= ext[1]; ++i, ++q)
+          {
+          hz[q] = HZOrder::GetHZIndex(zjk | zt[0][i - wholeExt[0]], nBits);
+          sendCounts[chunkMap.GetRank(chunkMap.GetAggregator(hz[q] >> chunkBits))] += 1;
+          }
+        }
+      }
+    }
+
+  std::vector<int> sendDispls(nRanks, 0);
+  for (int i = 1; i < nRanks; ++i)
+    sendDispls[i] = sendDispls[i-1] + sendCounts[i-1];
+
+  // pack the samples by destination
+  std::vector<uint64_t> sendHz(nLocal);
+  std::vector<char> sendValues(nLocal*sampleBytes);
+  std::vector<int> cursor(sendDispls);
+
+  q = 0;
+  for (size_t b = 0; b < nBlocks; ++b)
+    {
+    std::array<int,6> arrayExt;
+    blocks[b]->GetExtent(arrayExt.data());
+    if (association == svtkDataObject::CELL)
+      SVTKUtils::GetCellExtent(blocks[b], arrayExt);
+
+    const char *pda = static_cast<const char*>(arrays[b]->GetVoidPointer(0));
+
+    const std::array<int,6> &ext = sampleExt[b];
+    for (int k = ext[4]; k <= ext[5]; ++k)
+      {
+      for (int j = ext[2]; j <= ext[3]; ++j)
+        {
+        const char *pRow = pda + ::GetFlatIndex(arrayExt, ext[0], j, k)*sampleBytes;
+        for (int i = ext[0]; i <= ext[1]; ++i, ++q, pRow += sampleBytes)
+          {
+          int dest = chunkMap.GetRank(chunkMap.GetAggregator(hz[q] >> chunkBits));
+          int p = cursor[dest]++;
+          sendHz[p] = hz[q];
+          memcpy(sendValues.data() + p*sampleBytes, pRow, sampleBytes);
+          }
+        }
+      }
+    }
+
+  for (size_t i = 0; i < nBlocks; ++i)
+    arrays[i]->UnRegister(nullptr);
+
+  hz = std::vector<uint64_t>();
+
+  // send the samples to the aggregators
+  std::vector<int> recvCounts(nRanks);
+  MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+
+  std::vector<int> recvDispls(nRanks, 0);
+  for (int i = 1; i < nRanks; ++i)
+    recvDispls[i] = recvDispls[i-1] + recvCounts[i-1];
+
+  long nRecv = recvDispls[nRanks-1] + recvCounts[nRanks-1];
+
+  std::vector<uint64_t> recvHz(nRecv);
+  std::vector<char> recvValues(nRecv*sampleBytes);
+
+  MPI_Datatype sampleType;
+  MPI_Type_contiguous(sampleBytes, MPI_BYTE, &sampleType);
+  MPI_Type_commit(&sampleType);
+
+  MPI_Alltoallv(sendHz.data(), sendCounts.data(), sendDispls.data(),
+    MPI_UINT64_T, recvHz.data(), recvCounts.data(), recvDispls.data(),
+    MPI_UINT64_T, comm);
+
+  MPI_Alltoallv(sendValues.data(), sendCounts.data(), sendDispls.data(),
+    sampleType, recvValues.data(), recvCounts.data(), recvDispls.data(),
+    sampleType, comm);
+
+  MPI_Type_free(&sampleType);
+
+  sendHz = std::vector<uint64_t>();
+  sendValues = std::vector<char>();
+
+  // assemble the chunks that hold samples, in order. samples that were
+  // padded or not sent are zero
+  long c0 = 0;
+  long c1 = 0;
+  chunkMap.GetChunks(rank, c0, c1);
+
+  std::vector<long> slot(c1 - c0, -1);
+  for (long i = 0; i < nRecv; ++i)
+    slot[(recvHz[i] >> chunkBits) - c0] = 0;
+
+  long nPresent = 0;
+  for (long c = 0; c < c1 - c0; ++c)
+    if (slot[c] >= 0)
+      slot[c] = nPresent++;
+
+  std::vector<char> chunks(nPresent*chunkBytes, 0);
+  for (long i = 0; i < nRecv; ++i)
+    {
+    long c = (recvHz[i] >> chunkBits) - c0;
+    long off = slot[c]*chunkBytes + (recvHz[i] & (chunkSize - 1))*sampleBytes;
+    memcpy(chunks.data() + off, recvValues.data() + i*sampleBytes, sampleBytes);
+    }
+
+  recvHz = std::vector<uint64_t>();
+  recvValues = std::vector<char>();
+
+  // the aggregators write their chunks one after the other following the
+  // table of chunk offsets
+  long localBytes = nPresent*chunkBytes;
+  long offset = 0;
+  MPI_Exscan(&localBytes, &offset, 1, MPI_LONG, MPI_SUM, comm);
+  if (rank == 0)
+    offset = 0;
+
+  MPI_Offset tableBytes = nChunks*sizeof(int64_t);
+  offset += tableBytes;
+
+  std::vector<int64_t> table(c1 - c0);
+  for (long c = 0; c < c1 - c0; ++c)
+    table[c] = slot[c] < 0 ? -1 : offset + slot[c]*chunkBytes;
+
+  MPI_File fh;
+  if (MPI_File_open(comm, fileName.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY,
+    MPI_INFO_NULL, &fh) != MPI_SUCCESS)
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\" for writing")
+    return -1;
+    }
+
+  // discard the contents of an existing file
+  MPI_File_set_size(fh, 0);
+
+  MPI_Datatype chunkType;
+  MPI_Type_contiguous(chunkBytes, MPI_BYTE, &chunkType);
+  MPI_Type_commit(&chunkType);
+
+  int ierr = MPI_File_write_at_all(fh, c0*sizeof(int64_t), table.data(),
+    table.size(), MPI_INT64_T, MPI_STATUS_IGNORE);
+
+  ierr |= MPI_File_write_at_all(fh, offset, chunks.data(), nPresent,
+    chunkType, MPI_STATUS_IGNORE);
+
+  MPI_Type_free(&chunkType);
+  MPI_File_close(&fh);
+
+  if (ierr != MPI_SUCCESS)
+    {
+    SENSEI_ERROR("Failed to write \"" << fileName << "\"")
+    return -1;
+    }
+
+  // describe the layout
+  if (rank == 0)
+    {
+    HZOrder::Index index;
+    index.Extent = wholeExt;
+    index.Association = association;
+    index.DataType = dataType;
+    index.NumberOfComponents = nComps;
+    index.ChunkBits = chunkBits;
+    index.ArrayName = arrayName;
+    index.DataFile = fileName.substr(fileName.rfind('/') + 1);
+
+    for (int i = 0; i < 3; ++i)
+      {
+      index.Origin[i] = origin[i];
+      index.Spacing[i] = spacing[i];
+      }
+
+    std::string indexFile = fileName.substr(0, fileName.size() - 3) + ".idx";
+    if (index.Write(indexFile))
+      return -1;
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool HZOrderWriter::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("HZOrderWriter::Execute");
+
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  if (this->Requirements.Empty())
+    {
+    SENSEI_ERROR("No arrays were selected")
+    return false;
+    }
+
+  // the block decomposition and the extents of the owned cells
+  MeshMetadataFlags flags;
+  flags.SetBlockDecomp();
+  flags.SetBlockExtents();
+
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(dataIn, flags))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  while (mit)
+    {
+    const std::string &meshName = mit.MeshName();
+
+    MeshMetadataPtr mmd;
+    if (mdMap.GetMeshMetadata(meshName, mmd))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    if (!SVTKUtils::UniformCartesian(mmd))
+      {
+      SENSEI_ERROR("Mesh \"" << meshName << "\" is not a uniform grid")
+      return false;
+      }
+
+    std::vector<long> blockIds;
+    if (SVTKUtils::GetLocalBlockIds(rank, mmd, blockIds))
+      {
+      SENSEI_ERROR("Failed to get the local blocks of mesh \"" << meshName << "\"")
+      return false;
+      }
+
+    // fetch the local blocks and the extents of their owned cells
+    size_t nBlocks = blockIds.size();
+    std::vector<svtkImageData*> blocks;
+    std::vector<std::array<int,6>> ownedExt(nBlocks);
+
+    int status = 0;
+    for (size_t i = 0; (i < nBlocks) && !status; ++i)
+      {
+      long bid = blockIds[i];
+
+      // the ghost array is not needed when the owned cells are known
+      bool haveOwned = !SVTKUtils::GetOwnedExtent(mmd, bid, ownedExt[i]);
+      bool ghostBlock = mmd->NumGhostCells && !haveOwned;
+
+      svtkDataObject *block = nullptr;
+      if (dataIn->GetMeshBlock(meshName, bid, false, block) ||
+        (ghostBlock && dataIn->AddGhostCellsArrayToBlock(block, meshName, bid)))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to fetch block "
+          << bid << " of mesh \"" << meshName << "\"")
+        if (block)
+          block->Delete();
+        status = -1;
+        break;
+        }
+
+      svtkImageData *im = dynamic_cast<svtkImageData*>(block);
+      if (!im)
+        {
+        SENSEI_ERROR("Block " << bid << " is a " << block->GetClassName()
+          << " but svtkImageData is required")
+        block->Delete();
+        status = -1;
+        break;
+        }
+
+      blocks.push_back(im);
+
+      if (!haveOwned && (SVTKUtils::GetOwnedExtent(im, ownedExt[i]) ||
+        SVTKUtils::EmptyExtent(ownedExt[i])))
+        {
+        SENSEI_ERROR("The cells owned by block " << bid << " of mesh \""
+          << meshName << "\" do not form a box")
+        status = -1;
+        break;
+        }
+
+      ArrayRequirementsIterator ait =
+        this->Requirements.GetArrayRequirementsIterator(meshName);
+
+      for (; ait && !status; ++ait)
+        {
+        if (dataIn->AddArrayToBlock(block, meshName, bid, ait.Association(),
+          ait.Array()))
+          {
+          SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add "
+            << SVTKUtils::GetAttributesName(ait.Association())
+            << " data array \"" << ait.Array() << "\"")
+          status = -1;
+          }
+        }
+      }
+
+    dataIn->ReleaseMeshBlocks();
+
+    // the axes along which the mesh is not flat
+    int localInfo[3] = {0, 0, 0};
+    double localGeom[6];
+    for (int j = 0; j < 6; ++j)
+      localGeom[j] = std::numeric_limits<double>::max();
+
+    for (size_t i = 0; i < blocks.size(); ++i)
+      {
+      int pext[6];
+      blocks[i]->GetExtent(pext);
+
+      for (int j = 0; j < 3; ++j)
+        localInfo[j] |= pext[2*j] != pext[2*j+1] ? 1 : 0;
+
+      blocks[i]->GetOrigin(localGeom);
+      blocks[i]->GetSpacing(localGeom + 3);
+      }
+
+    // the status is combined so that all ranks bail out together
+    int globalStatus = 0;
+    MPI_Allreduce(&status, &globalStatus, 1, MPI_INT, MPI_MIN, comm);
+
+    int wholeInfo[3];
+    double geom[6];
+    MPI_Allreduce(localInfo, wholeInfo, 3, MPI_INT, MPI_MAX, comm);
+    MPI_Allreduce(localGeom, geom, 6, MPI_DOUBLE, MPI_MIN, comm);
+
+    // the extent of all cells is the global cell extent from the metadata
+    if (!globalStatus && !mmd->GlobalView && mmd->GlobalizeView(comm))
+      {
+      SENSEI_ERROR("Failed to make a global view of the metadata of mesh \""
+        << meshName << "\"")
+      globalStatus = -1;
+      }
+
+    const std::array<int,6> &wholeCellExt = mmd->Extent;
+
+    if (globalStatus || SVTKUtils::EmptyExtent(wholeCellExt))
+      {
+      if (!globalStatus)
+        SENSEI_ERROR("Mesh \"" << meshName << "\" has no cells")
+      for (size_t i = 0; i < blocks.size(); ++i)
+        blocks[i]->Delete();
+      return false;
+      }
+
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(meshName);
+
+    for (; ait; ++ait)
+      {
+      int assoc = ait.Association();
+      const std::string &arrayName = ait.Array();
+
+      // cell samples are the owned cells. point samples are the points at
+      // the lower corner of the owned cells, and the last points of the
+      // mesh along each axis that is not flat
+      std::array<int,6> wholeExt = wholeCellExt;
+      std::vector<std::array<int,6>> sampleExt(ownedExt.begin(),
+        ownedExt.begin() + blocks.size());
+
+      if (assoc == svtkDataObject::POINT)
+        {
+        for (int j = 0; j < 3; ++j)
+          {
+          if (!wholeInfo[j])
+            continue;
+
+          for (size_t i = 0; i < sampleExt.size(); ++i)
+            if (sampleExt[i][2*j+1] == wholeCellExt[2*j+1])
+              sampleExt[i][2*j+1] += 1;
+
+          wholeExt[2*j+1] += 1;
+          }
+        }
+      else if (assoc != svtkDataObject::CELL)
+        {
+        SENSEI_ERROR("Unsupported association "
+          << SVTKUtils::GetAttributesName(assoc))
+        status = -1;
+        break;
+        }
+
+      std::ostringstream oss;
+      oss << this->OutputDir << "/" << this->FileName << "_" << meshName
+        << "_" << arrayName << "_" << std::setw(6) << std::setfill('0')
+        << dataIn->GetDataTimeStep() << ".hz";
+
+      if (this->WriteArray(oss.str(), blocks, sampleExt, wholeExt, geom,
+        geom + 3, assoc, arrayName))
+        {
+        SENSEI_ERROR("Failed to write " << SVTKUtils::GetAttributesName(assoc)
+          << " data array \"" << arrayName << "\" of mesh \"" << meshName << "\"")
+        status = -1;
+        break;
+        }
+      }
+
+    for (size_t i = 0; i < blocks.size(); ++i)
+      blocks[i]->Delete();
+
+    if (status)
+      return false;
+
+    ++mit;
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int HZOrderWriter::Finalize()
+{
+  return 0;
+}
+
+}
@@ -0,0 +1,95 @@
+#ifndef sensei_HZOrderWriter_h
+#define sensei_HZOrderWriter_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+
+#include <array>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+class svtkImageData;
+
+namespace sensei
+{
+
+/** Writes arrays of uniform grids in the hierarchical Z-order layout
+ * described in HZOrder.h, so that post hoc tools can read a coarse view of
+ * any sub-box by reading a small prefix of the file. The blocks must be
+ * svtkImageData. The extent of the cells owned by each block is taken from
+ * the block extents in the mesh metadata, or from the ghost cell array when
+ * the metadata does not provide it. The extent of the whole grid is the
+ * global cell extent in the mesh metadata.
+ *
+ * The samples are sent to a number of aggregator ranks, each of which is
+ * responsible for a contiguous range of chunks of the HZ ordered data. The
+ * aggregators write the chunks that hold samples, and their part of the
+ * chunk offset table, using collective MPI-IO. Each array of each time step
+ * is written to "<file_name>_<mesh>_<array>_<step>.hz" and described by
+ * an index file of the same name with the extension ".idx".
+ */
+class SENSEI_EXPORT HZOrderWriter : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static HZOrderWriter *New();
+
+  senseiTypeMacro(HZOrderWriter, AnalysisAdaptor);
+
+  /// Set the meshes and arrays to write.
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  /// Add a single array to the list of arrays to write.
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  /// set the directory the files are written to. the default is ./
+  void SetOutputDir(const std::string &dir) { this->OutputDir = dir; }
+
+  /// set the prefix of the file names. the default is data
+  void SetFileName(const std::string &name) { this->FileName = name; }
+
+  /** set log2 of the number of samples in a chunk, the unit of reading and
+   * writing. the default is 16
+   */
+  int SetChunkBits(int bits);
+
+  /** set the number of ranks that write. The default, 0, uses all of the
+   * ranks.
+   */
+  void SetNumberOfAggregators(int n);
+
+  /// write the arrays of this time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+protected:
+  HZOrderWriter();
+  ~HZOrderWriter();
+
+  HZOrderWriter(const HZOrderWriter&) = delete;
+  void operator=(const HZOrderWriter&) = delete;
+
+  // write one array of the local blocks. sampleExt is the extent of the
+  // samples owned by each block and wholeExt the extent of all samples.
+  // this is collective
+  int WriteArray(const std::string &fileName,
+    const std::vector<svtkImageData*> &blocks,
+    const std::vector<std::array<int,6>> &sampleExt,
+    const std::array<int,6> &wholeExt, const double *origin,
+    const double *spacing, int association, const std::string &arrayName);
+
+private:
+  DataRequirements Requirements;
+  std::string OutputDir;
+  std::string FileName;
+  int ChunkBits;
+  int NumberOfAggregators;
+};
+
+}
+
+#endif
@@ -10,12 +10,14 @@
 #include <svtkCompositeDataIterator.h>
 #include <svtkCompositeDataSet.h>
 #include <svtkDataObject.h>
+#include <svtkDataSet.h>
 #include <svtkDataSetAttributes.h>
 #include <svtkObjectFactory.h>
 #include <svtkSmartPointer.h>
 #include <svtkUnsignedCharArray.h>
 
 #include <algorithm>
+#include <array>
 #include <vector>
 
 namespace
@@ -56,6 +58,183 @@ int Write(const std::string &fileName, int step, double time,
   return 0;
 }
 
+// **************************************************************************
+// get the extent of the cells owned by a block from the metadata. returns
+// false when the ghost array is needed to skip the ghost cells
+bool GetOwnedExtent(const sensei::MeshMetadataPtr &mmd, int association,
+  long bid, std::array<int,6> &ownedExt)
+{
+  return (association == svtkDataObject::CELL) &&
+    (mmd->MeshType == SVTK_MULTIBLOCK_DATA_SET) &&
+    !sensei::SVTKUtils::GetOwnedExtent(mmd, bid, ownedExt);
+}
+
+// **************************************************************************
+// returns true if all of the local blocks have an owned extent
+bool HaveOwnedExtents(int rank, const sensei::MeshMetadataPtr &mmd,
+  int association)
+{
+  std::vector<long> blockIds;
+  if (!mmd->Flags.BlockDecompSet() ||
+    sensei::SVTKUtils::GetLocalBlockIds(rank, mmd, blockIds))
+    return false;
+
+  std::array<int,6> ownedExt;
+  size_t nBlocks = blockIds.size();
+  for (size_t i = 0; i < nBlocks; ++i)
+    {
+    if (!GetOwnedExtent(mmd, association, blockIds[i], ownedExt))
+      return false;
+    }
+
+  return true;
+}
+
+// **************************************************************************
+// get the cell extent of a block from the metadata, and check it against the
+// number of cells in the block's array
+int GetBlockCellExtent(const sensei::MeshMetadataPtr &mmd, long bid,
+  long nCells, std::array<int,6> &ext)
+{
+  size_t nBlocks = mmd->BlockExtents.size();
+  if (mmd->BlockIds.size() != nBlocks)
+    return -1;
+
+  for (size_t i = 0; i < nBlocks; ++i)
+    {
+    if (mmd->BlockIds[i] != bid)
+      continue;
+
+    ext = mmd->BlockExtents[i];
+
+    long numCells = long(ext[1] - ext[0] + 1)*long(ext[3] - ext[2] + 1)*
+      long(ext[5] - ext[4] + 1);
+
+    return numCells == nCells ? 0 : -1;
+    }
+
+  return -1;
+}
+
+// **************************************************************************
+// add a block's contribution. ghost cells are skipped using the owned extent
+// when it is known, in which case neither the ghost array nor the block's
+// geometry is fetched and the block's extent comes from the metadata
+int AddLocalData(sensei::HistogramInternals &internals,
+  const sensei::MeshMetadataPtr &mmd, long bid, svtkDataArray *array,
+  svtkUnsignedCharArray *ghostArray, bool owned,
+  const std::array<int,6> &ownedExt)
+{
+  if (owned && !ghostArray)
+    {
+    std::array<int,6> ext;
+    if (GetBlockCellExtent(mmd, bid, array->GetNumberOfTuples(), ext))
+      {
+      SENSEI_ERROR("The extent of block " << bid << " is not consistent"
+        " with its " << array->GetNumberOfTuples() << " cells")
+      return -1;
+      }
+
+    return internals.AddLocalData(array, ext, ownedExt);
+    }
+
+  return internals.AddLocalData(array, ghostArray);
+}
+
+// **************************************************************************
+int ComputeBlocks(sensei::DataAdaptor *data, const sensei::MeshMetadataPtr &mmd,
+  const std::string &meshName, int association, const std::string &arrayName,
+  long memoryBudget, sensei::HistogramInternals &internals)
+{
+  int rank = 0;
+  MPI_Comm_rank(data->GetCommunicator(), &rank);
+
+  std::vector<long> blockIds;
+  if (sensei::SVTKUtils::GetLocalBlockIds(rank, mmd, blockIds))
+    return -1;
+
+  // the blocks fetched so far are released on every return
+  sensei::MeshBlocksGuard guard(data);
+
+  bool ghostCells = mmd->NumGhostCells || sensei::SVTKUtils::AMR(mmd);
+  bool ghostNodes = mmd->NumGhostNodes;
+
+  internals.Initialize();
+
+  // two passes over the blocks. the first finds the range the second bins
+  // the data. each block is fetched at most once per pass, and the blocks
+  // of the first pass that fit in the memory budget are kept for the
+  // second rather than fetched again.
+  size_t nBlocks = blockIds.size();
+  std::vector<svtkSmartPointer<svtkDataObject>> kept(nBlocks);
+  long keptBytes = 0;
+
+  for (int pass = 0; pass < 2; ++pass)
+    {
+    if (pass && (internals.ComputeGlobalRange() ||
+      internals.InitializeHistogram()))
+      return -1;
+
+    for (size_t i = 0; i < nBlocks; ++i)
+      {
+      long bid = blockIds[i];
+
+      // the ghost array is not needed when the owned cells are known
+      std::array<int,6> ownedExt;
+      bool owned = GetOwnedExtent(mmd, association, bid, ownedExt);
+
+      svtkSmartPointer<svtkDataObject> block = kept[i];
+      kept[i] = nullptr;
+
+      if (!block)
+        {
+        svtkDataObject *blk = nullptr;
+        if (data->GetMeshBlock(meshName, bid, true, blk) ||
+          data->AddArrayToBlock(blk, meshName, bid, association, arrayName) ||
+          (ghostCells && !owned && data->AddGhostCellsArrayToBlock(blk, meshName, bid)) ||
+          (ghostNodes && data->AddGhostNodesArrayToBlock(blk, meshName, bid)))
+          {
+          SENSEI_ERROR(<< data->GetClassName() << " failed to fetch block "
+            << bid << " of mesh \"" << meshName << "\"")
+          if (blk)
+            blk->Delete();
+          return -1;
+          }
+        block.TakeReference(blk);
+        }
+
+      svtkFieldData *fd = block->GetAttributesAsFieldData(association);
+
+      svtkDataArray *array = fd->GetArray(arrayName.c_str());
+
+      svtkUnsignedCharArray *ghostArray =
+        dynamic_cast<svtkUnsignedCharArray*>(fd->GetArray("svtkGhostType"));
+
+      int ierr = AddLocalData(internals, mmd, bid, array, ghostArray, owned, ownedExt) ||
+        (pass ? internals.ComputeLocalHistogram() : internals.ComputeLocalRange());
+
+      internals.ClearData();
+
+      if (ierr)
+        {
+        SENSEI_ERROR("Failed to process array \"" << arrayName
+          << "\" data block " << bid << " of mesh \"" << meshName << "\"")
+        return -1;
+        }
+
+      // keep the block for the second pass while the budget allows
+      long nBytes = 1024l*long(block->GetActualMemorySize());
+      if (!pass && (keptBytes + nBytes <= memoryBudget))
+        {
+        kept[i] = block;
+        keptBytes += nBytes;
+        }
+      }
+    }
+
+  return internals.FinalizeHistogram();
+}
+
 // **************************************************************************
 int Write(int step, double time, const std::string &meshName,
   const std::string &arrayName, sensei::Histogram::Data &result)
@@ -88,7 +267,8 @@ senseiNewMacro(Histogram);
 
 //-----------------------------------------------------------------------------
 Histogram::Histogram() : NumberOfBins(0),
-  Association(svtkDataObject::FIELD_ASSOCIATION_POINTS)
+  Association(svtkDataObject::FIELD_ASSOCIATION_POINTS), MemoryBudget(0),
+  MemoryBudgetWarned(false), Asynchronous(0), PendingReport(false), PendingStep(0), PendingTime(0.0)
 {
 }
 
@@ -125,34 +305,98 @@ bool Histogram::Execute(DataAdaptor* data, DataAdaptor** dataOut)
     *dataOut = nullptr;
     }
 
-  // see what the simulation is providing
+  // report the result of the previous step
+  if (this->CompletePending())
+    return false;
+
+  // see what the simulation is providing. the block decomposition and sizes
+  // are needed to enforce the memory budget
+  MeshMetadataFlags flags;
+  if (this->MemoryBudget > 0)
+    {
+    flags.SetBlockDecomp();
+    flags.SetBlockSize();
+    }
+
   MeshMetadataMap mdMap;
-  if (mdMap.Initialize(data))
+  if (mdMap.Initialize(data, flags))
     {
     SENSEI_ERROR("Failed to get metadata")
     return false;
     }
 
   // get the mesh metadata object
+  unsigned int meshId = 0;
   MeshMetadataPtr mmd;
-  if (mdMap.GetMeshMetadata(this->MeshName, mmd))
+  if (mdMap.GetMeshId(this->MeshName, meshId) ||
+    mdMap.GetMeshMetadata(meshId, mmd))
     {
     SENSEI_ERROR("Failed to get metadata for mesh \"" << this->MeshName << "\"")
     return false;
     }
 
-  // get the mesh object
-  svtkDataObject *dobj = nullptr;
-  if (data->GetMesh(this->MeshName, true, dobj))
+  // the extents of the owned cells let the ghost cells of logically
+  // Cartesian blocks be skipped without the ghost array. they are requested
+  // only for the mesh and association where that is possible
+  if ((this->Association == svtkDataObject::CELL) &&
+    (mmd->MeshType == SVTK_MULTIBLOCK_DATA_SET) &&
+    SVTKUtils::LogicallyCartesian(mmd))
     {
-    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
-    return false;
+    flags.SetBlockDecomp();
+    flags.SetBlockExtents();
+
+    mmd = MeshMetadata::New(flags);
+    if (data->GetMeshMetadata(meshId, mmd) ||
+      mmd->Validate(data->GetCommunicator(), flags))
+      {
+      SENSEI_ERROR("Failed to get the block extents of mesh \""
+        << this->MeshName << "\"")
+      return false;
+      }
     }
 
   int rank = 0;
   MPI_Comm comm = this->GetCommunicator();
   MPI_Comm_rank(comm, &rank);
 
+  // process one block at a time when the local data exceeds the budget
+  bool streamBlocks = false;
+  if (this->MemoryBudget > 0)
+    {
+    int dataRank = 0;
+    MPI_Comm_rank(data->GetCommunicator(), &dataRank);
+
+    long localBytes = SVTKUtils::GetLocalArraySize(dataRank, mmd,
+      this->Association, {this->ArrayName});
+
+    streamBlocks = (localBytes < 0) || (localBytes > this->MemoryBudget);
+
+    // blocks served from a copy of the whole mesh do not save memory
+    if (streamBlocks && !data->StreamsMeshBlocks(this->MeshName))
+      {
+      if ((dataRank == 0) && !this->MemoryBudgetWarned)
+        SENSEI_WARNING("The data adaptor does not stream the blocks of mesh \""
+          << this->MeshName << "\". The memory budget is not enforced")
+      this->MemoryBudgetWarned = true;
+      streamBlocks = false;
+      }
+    }
+
+  // when the owned cells of every block are known the ghost array is not
+  // needed
+  int dataRank = 0;
+  MPI_Comm_rank(data->GetCommunicator(), &dataRank);
+
+  bool owned = HaveOwnedExtents(dataRank, mmd, this->Association);
+
+  // get the mesh object
+  svtkDataObject *dobj = nullptr;
+  if (!streamBlocks && data->GetMesh(this->MeshName, true, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
   // TODO : this lets one laod balance across multiple GPU's and CPU's
   // set -1 to execute on the CPU and 0 to N_CUDA_DEVICES -1 to specify
   // the specific GPU to run on.
@@ -176,7 +420,7 @@ bool Histogram::Execute(DataAdaptor* data, DataAdaptor** dataOut)
       << " Computing the histogram on mesh \""
       << this->MeshName << "\" array \"" << this->ArrayName
       << "\" using " << (deviceId < 0 ? "the CPU" : "CUDA GPU ")
-      << aDevId)
+      << aDevId << (streamBlocks ? " one block at a time" : ""))
     }
 
 
@@ -184,96 +428,174 @@ bool Histogram::Execute(DataAdaptor* data, DataAdaptor** dataOut)
   std::shared_ptr<sensei::HistogramInternals>
     internals(new sensei::HistogramInternals(comm, deviceId, this->NumberOfBins));
 
-  if (!dobj)
+  // the reduction is completed at the next step
+  internals->SetNonBlocking(this->Asynchronous);
+
+  if (streamBlocks)
+    {
+    // this is an MPI collective, all MPI ranks must participate.
+    if (::ComputeBlocks(data, mmd, this->MeshName, this->Association,
+      this->ArrayName, this->MemoryBudget, *internals))
+      {
+      SENSEI_ERROR("Failed to compute the histogram for array \""
+        << this->ArrayName << "\" of mesh \"" << this->MeshName << "\"")
+      // abort to prevent deadlock in collective calls
+      MPI_Abort(comm, -1);
+      }
+    }
+  else if (!dobj)
     {
     // it is not an necessarilly an error if all ranks do not have
     // a dataset to process. However, all ranks must participate due
     // to the use of MPI collectives.
     internals->Initialize();
     internals->ComputeHistogram();
-    internals->Clear();
-    return true;
-    }
 
-  // fetch the array that the hiostogram will be computed on
-  if (data->AddArray(dobj, this->MeshName, this->Association, this->ArrayName))
-    {
-    SENSEI_ERROR(<< data->GetClassName() << " failed to add "
-      << (this->Association == svtkDataObject::POINT ? "point" : "cell")
-      << " data array \""  << this->ArrayName << "\"")
+    // hold the calculation until its reduction completes
+    if (this->Asynchronous)
+      {
+      this->Pending = internals;
+      this->PendingReport = false;
+      return true;
+      }
 
-    // abort to avoid deadlocks in collective calls
-    MPI_Abort(comm, -1);
-    return false;
+    internals->Clear();
+    return true;
     }
-
-  // add the ghost zones
-  if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
-    data->AddGhostCellsArray(dobj, this->MeshName))
+  else
     {
-    SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost cells.")
-    // abort to avoid deadlocks in collective calls
-    MPI_Abort(comm, -1);
-    return false;
-    }
+    // fetch the array that the hiostogram will be computed on
+    if (data->AddArray(dobj, this->MeshName, this->Association, this->ArrayName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add "
+        << (this->Association == svtkDataObject::POINT ? "point" : "cell")
+        << " data array \""  << this->ArrayName << "\"")
 
-  if (mmd->NumGhostNodes && data->AddGhostNodesArray(dobj, this->MeshName))
-    {
-    SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
-    // abort to avoid deadlocks in collective calls
-    MPI_Abort(comm, -1);
-    return false;
-    }
+      // abort to avoid deadlocks in collective calls
+      MPI_Abort(comm, -1);
+      return false;
+      }
 
-  // add all blocks of data
-  svtkCompositeDataSetPtr mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
-  svtkSmartPointer<svtkCompositeDataIterator> iter;
-  iter.TakeReference(mesh->NewIterator());
-  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
-    {
-    // get the local mesh
-    svtkDataObject *curObj = iter->GetCurrentDataObject();
+    // add the ghost zones
+    if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) && !owned &&
+      data->AddGhostCellsArray(dobj, this->MeshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost cells.")
+      // abort to avoid deadlocks in collective calls
+      MPI_Abort(comm, -1);
+      return false;
+      }
 
-    // get the array to compute histogram for
-    svtkDataArray* array = this->GetArray(curObj, this->ArrayName);
-    if (!array)
+    if (mmd->NumGhostNodes && data->AddGhostNodesArray(dobj, this->MeshName))
       {
-      SENSEI_WARNING("Data block " << iter->GetCurrentFlatIndex()
-        << " of mesh \"" << this->MeshName << " has no array named \""
-        << this->ArrayName << "\"")
-      continue;
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
+      // abort to avoid deadlocks in collective calls
+      MPI_Abort(comm, -1);
+      return false;
       }
 
-    // and get the ghost cell array
-    svtkUnsignedCharArray *ghostArray = dynamic_cast<svtkUnsignedCharArray*>(
-      this->GetArray(curObj, this->GetGhostArrayName()));
+    // add all blocks of data
+    svtkCompositeDataSetPtr mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+    svtkSmartPointer<svtkCompositeDataIterator> iter;
+    iter.TakeReference(mesh->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+      // get the local mesh
+      svtkDataObject *curObj = iter->GetCurrentDataObject();
 
-    // add this blocks contribution to the calculation
-    if (internals->AddLocalData(array, ghostArray))
+      // get the array to compute histogram for
+      svtkDataArray* array = this->GetArray(curObj, this->ArrayName);
+      if (!array)
+        {
+        SENSEI_WARNING("Data block " << iter->GetCurrentFlatIndex()
+          << " of mesh \"" << this->MeshName << " has no array named \""
+          << this->ArrayName << "\"")
+        continue;
+        }
+
+      // and get the ghost cell array
+      svtkUnsignedCharArray *ghostArray = dynamic_cast<svtkUnsignedCharArray*>(
+        this->GetArray(curObj, this->GetGhostArrayName()));
+
+      // add this blocks contribution to the calculation
+      std::array<int,6> ownedExt;
+      long bid = iter->GetCurrentFlatIndex() - 1;
+      bool blockOwned = owned &&
+        GetOwnedExtent(mmd, this->Association, bid, ownedExt);
+
+      if (::AddLocalData(*internals, mmd, bid, array, ghostArray,
+        blockOwned, ownedExt))
+        {
+        SENSEI_ERROR("Failed to add array \"" << this->ArrayName
+          << "\" data block " << iter->GetCurrentFlatIndex() << " of mesh \""
+          << this->MeshName << "\"")
+        // abort to prevent deadlock in collective calls
+        MPI_Abort(comm, -1);
+        }
+      }
+
+    // compute the histogram. this is an MPI collective, all MPI ranks must participate.
+    // after this call returns MPI rank 0 holds the histogram
+    if (internals->ComputeHistogram())
       {
-      SENSEI_ERROR("Failed to add array \"" << this->ArrayName
-        << "\" data block " << iter->GetCurrentFlatIndex() << " of mesh \""
-        << this->MeshName << "\"")
+      SENSEI_ERROR("Failed to compute the histogram for array \""
+        << this->ArrayName << "\" of mesh \"" << this->MeshName << "\"")
       // abort to prevent deadlock in collective calls
       MPI_Abort(comm, -1);
       }
     }
 
-  // compute the histogram. this is an MPI collective, all MPI ranks must participate.
-  // after this call returns MPI rank 0 holds the histogram
-  if (internals->ComputeHistogram())
+  // the result is reported when the reduction completes at the next step
+  if (this->Asynchronous)
+    {
+    this->Pending = internals;
+    this->PendingReport = true;
+    this->PendingStep = step;
+    this->PendingTime = time;
+    return true;
+    }
+
+  if (this->ReportResult(*internals, step, time))
+    return false;
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int Histogram::CompletePending()
+{
+  if (!this->Pending)
+    return 0;
+
+  std::shared_ptr<HistogramInternals> internals = this->Pending;
+  this->Pending = nullptr;
+
+  if (internals->WaitHistogram())
+    {
+    SENSEI_ERROR("Failed to complete the histogram of step " << this->PendingStep)
+    return -1;
+    }
+
+  if (!this->PendingReport)
     {
-    SENSEI_ERROR("Failed to compute the histogram for array \""
-      << this->ArrayName << "\" of mesh \"" << this->MeshName << "\"")
-    // abort to prevent deadlock in collective calls
-    MPI_Abort(comm, -1);
+    internals->Clear();
+    return 0;
     }
 
+  return this->ReportResult(*internals, this->PendingStep, this->PendingTime);
+}
+
+//-----------------------------------------------------------------------------
+int Histogram::ReportResult(HistogramInternals &internals, int step, double time)
+{
+  int rank = 0;
+  MPI_Comm_rank(this->GetCommunicator(), &rank);
+
   // store a copy of the histogram. this can be acccessed from scripts ofr
   // regression testing etc.
   Histogram::Data result;
 
-  internals->GetHistogram(result.NumberOfBins, result.BinMin,
+  internals.GetHistogram(result.NumberOfBins, result.BinMin,
     result.BinMax, result.BinWidth, result.Histogram);
 
   this->LastResult = result;
@@ -290,14 +612,14 @@ bool Histogram::Execute(DataAdaptor* data, DataAdaptor** dataOut)
       if (::Write(this->FileName, step, time, this->MeshName, this->ArrayName, result))
         {
         SENSEI_ERROR("Failed to write histogram.")
-        return false;
+        return -1;
         }
       }
     }
 
-  internals->Clear();
+  internals.Clear();
 
-  return true;
+  return 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -320,6 +642,10 @@ int Histogram::GetHistogram(Histogram::Data &result)
 //-----------------------------------------------------------------------------
 int Histogram::Finalize()
 {
+  // report the result of the last step
+  if (this->CompletePending())
+    return -1;
+
   return 0;
 }
 
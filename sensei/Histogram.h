@@ -3,6 +3,7 @@
 
 #include "AnalysisAdaptor.h"
 #include <mpi.h>
+#include <memory>
 #include <vector>
 
 class svtkDataObject;
@@ -10,6 +11,7 @@ class svtkDataArray;
 
 namespace sensei
 {
+class HistogramInternals;
 
 /// Computes a histogram in parallel.
 class SENSEI_EXPORT Histogram : public AnalysisAdaptor
@@ -25,6 +27,32 @@ public:
     int association, const std::string& arrayName,
     const std::string &fileName);
 
+  /** Set the number of bytes of simulation data that may be held at once.
+   * When the local data is estimated to exceed the budget the blocks are
+   * fetched and processed one at a time using the DataAdaptor's
+   * block-at-a-time API. This requires two passes over the blocks, one to
+   * find the range and one to bin the data. The blocks of the first pass that
+   * fit in the budget are kept for the second. The budget is not enforced when
+   * the DataAdaptor does not stream the blocks, see
+   * DataAdaptor::StreamsMeshBlocks. The default of 0 disables the budget.
+   */
+  void SetMemoryBudget(long bytes) { this->MemoryBudget = bytes; }
+
+  /// Get the number of bytes of simulation data that may be held at once.
+  long GetMemoryBudget() { return this->MemoryBudget; }
+
+  /** When set the reduction of the histogram across MPI ranks is posted with
+   * a nonblocking collective and completed at the next call to Execute, or
+   * at Finalize, where the result is written. This hides the latency of the
+   * reduction behind the simulation at the cost of reporting results one
+   * step late. GetHistogram then returns the result of the previous step.
+   * The default of 0 reports results in the step they are computed.
+   */
+  void SetAsynchronous(int val) { this->Asynchronous = val; }
+
+  /// Get whether results are reported one step late
+  int GetAsynchronous() { return this->Asynchronous; }
+
   /// compute the histogram for this time step
   bool Execute(DataAdaptor* data, DataAdaptor**) override;
 
@@ -56,12 +84,25 @@ protected:
   static const char *GetGhostArrayName();
   svtkDataArray* GetArray(svtkDataObject* dobj, const std::string& arrayname);
 
+  // complete the reduction of the pending histogram, if any, and report it
+  int CompletePending();
+
+  // store and write the result of a completed calculation
+  int ReportResult(HistogramInternals &internals, int step, double time);
+
   int NumberOfBins;
   std::string MeshName;
   std::string ArrayName;
   int Association;
   std::string FileName;
+  long MemoryBudget;
+  bool MemoryBudgetWarned;
   Histogram::Data LastResult;
+  int Asynchronous;
+  std::shared_ptr<HistogramInternals> Pending;
+  bool PendingReport;
+  int PendingStep;
+  double PendingTime;
 };
 
 }
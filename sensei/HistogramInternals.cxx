@@ -2,6 +2,7 @@
 #include "HistogramInternals.h"
 #include "SVTKUtils.h"
 #include "MemoryUtils.h"
+#include "MPIUtils.h"
 #include "Error.h"
 
 #if defined(ENABLE_CUDA)
@@ -247,24 +248,70 @@ void block_local_histogram(data_t *data, unsigned char *ghosts,
     hist[j] += inc_valid;
     }
 }
+
+/** Computes a histogram on the CPU over the owned cells of a logically
+ * Cartesian block. The histgoram must be pre-initialized to zero multiple
+ * invokations of the kernel accumulate results for new data.
+ *
+ * @param[in] data      the array to calculate the histogram for
+ * @param[in] ext       the cell extent of the block
+ * @param[in] ownedExt  the extent of the cells that are not ghosts
+ * @param[in] minVal    the minimum bin value
+ * @param[in] width     the width of histogram bins
+ * @param[in] nBins     the number of bins + 1.
+ * @param[in,out] hist  the histogram
+ */
+template <typename data_t>
+void block_local_histogram(data_t *data, const std::array<int,6> &ext,
+  const std::array<int,6> &ownedExt, data_t minVal, data_t width,
+  unsigned int *hist, size_t nBins)
+{
+  (void) nBins;
+
+  sensei::SVTKUtils::ForEachOwnedRun(ext, ownedExt, [&](long first, long last)
+    {
+    for (long i = first; i < last; ++i)
+      {
+      // find the bin for this value
+      size_t j = (data[i] - minVal) / width;
+      hist[j] += 1;
+      }
+    });
+}
 }
 
 // --------------------------------------------------------------------------
 HistogramInternals::~HistogramInternals()
-{}
+{
+  // an outstanding reduction must complete before its buffers are released
+  this->WaitHistogram();
+}
 
 // --------------------------------------------------------------------------
 int HistogramInternals::Clear()
 {
+  // an outstanding reduction must complete before its buffers are released
+  this->WaitHistogram();
+
   this->Min = std::numeric_limits<double>::max();
   this->Max = std::numeric_limits<double>::lowest();
   this->Width = 1.0;
   this->DataCache.clear();
   this->GhostCache.clear();
+  this->ExtentCache.clear();
   this->Histogram = nullptr;
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int HistogramInternals::ClearData()
+{
+  this->DataCache.clear();
+  this->GhostCache.clear();
+  this->ExtentCache.clear();
+  return 0;
+}
+
 // --------------------------------------------------------------------------
 int HistogramInternals::Initialize()
 {
@@ -372,7 +419,68 @@ int HistogramInternals::AddLocalData(svtkDataArray *da,
   // cache the GPU accessible pointer for use in the histogram calculation
   this->GhostCache[da] = pGhosts;
 
-  // compute the block min and max
+  return this->CacheData(da);
+}
+
+// --------------------------------------------------------------------------
+int HistogramInternals::AddLocalData(svtkDataArray *da,
+  const std::array<int,6> &ext, const std::array<int,6> &ownedExt)
+{
+#if defined(ENABLE_CUDA)
+  if (this->DeviceId >= 0)
+    {
+    // the CUDA kernels skip ghost zones using a ghost array, generate it
+    svtkUnsignedCharArray *ghosts =
+      sensei::SVTKUtils::NewGhostCellsArray(ext, ownedExt);
+
+    int ierr = this->AddLocalData(da, ghosts);
+
+    ghosts->Delete();
+    return ierr;
+    }
+#endif
+
+  // validate the input
+  if (!da)
+    {
+    SENSEI_ERROR("AddLocalData failed, null data array")
+    return -1;
+    }
+
+  if (da->GetNumberOfComponents() != 1)
+    {
+    SENSEI_ERROR("Histogram on array \""
+      << (da->GetName() ? da->GetName() : "")
+      << "\" cannot be computed because the array has "
+      << da->GetNumberOfComponents() << " components")
+    return -1;
+    }
+
+  long nCells = long(ext[1] - ext[0] + 1)*long(ext[3] - ext[2] + 1)*
+    long(ext[5] - ext[4] + 1);
+
+  if (da->GetNumberOfTuples() != nCells)
+    {
+    SENSEI_ERROR("Histogram on array \""
+      << (da->GetName() ? da->GetName() : "")
+      << "\" cannot be computed because the array has "
+      << da->GetNumberOfTuples() << " values but the extent has "
+      << nCells << " cells")
+    return -1;
+    }
+
+  // the owned cells are visited directly, there is no ghost array
+  this->GhostCache[da] = nullptr;
+  this->ExtentCache[da] = {ext, ownedExt};
+
+  return this->CacheData(da);
+}
+
+// --------------------------------------------------------------------------
+int HistogramInternals::CacheData(svtkDataArray *da)
+{
+  size_t nVals = da->GetNumberOfTuples();
+
   switch (da->GetDataType())
     {
     svtkTemplateMacro(
@@ -420,6 +528,15 @@ int HistogramInternals::ComputeRange()
   this->Min = std::numeric_limits<double>::max();
   this->Max = std::numeric_limits<double>::lowest();
 
+  if (this->ComputeLocalRange() || this->ComputeGlobalRange())
+    return -1;
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramInternals::ComputeLocalRange()
+{
   auto dit = this->DataCache.begin();
   auto git = this->GhostCache.begin();
 
@@ -464,15 +581,33 @@ int HistogramInternals::ComputeRange()
           // calculate range taking into account ghost zones on the CPU
           SVTK_TT *rpDa = pDa.get();
           unsigned char *rpGhosts = pGhosts.get();
-          for (size_t i = 0; i < nVals; ++i)
+          if (rpGhosts)
             {
-            if (rpGhosts[i] == 0)
+            for (size_t i = 0; i < nVals; ++i)
               {
-              SVTK_TT value = rpDa[i];
-              blockMin = std::min(blockMin, value);
-              blockMax = std::max(blockMax, value);
+              if (rpGhosts[i] == 0)
+                {
+                SVTK_TT value = rpDa[i];
+                blockMin = std::min(blockMin, value);
+                blockMax = std::max(blockMax, value);
+                }
               }
             }
+          else
+            {
+            // visit only the owned cells
+            auto &exts = this->ExtentCache[da];
+            sensei::SVTKUtils::ForEachOwnedRun(exts[0], exts[1],
+              [&](long first, long last)
+              {
+              for (long i = first; i < last; ++i)
+                {
+                SVTK_TT value = rpDa[i];
+                blockMin = std::min(blockMin, value);
+                blockMax = std::max(blockMax, value);
+                }
+              });
+            }
 #if defined(SENSEI_DEBUG)
           std::cerr << "HistogramInternals::ComputeRange CPU ["
              << blockMin << ", " << blockMax << "]" << std::endl;
@@ -492,6 +627,12 @@ int HistogramInternals::ComputeRange()
       }
     }
 
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int HistogramInternals::ComputeGlobalRange()
+{
   // check the result
   if (fabs(this->Max - this->Min) < 1.0e-6)
     {
@@ -500,12 +641,15 @@ int HistogramInternals::ComputeRange()
     return -1;
     }
 
-  // compute the min and max across all MPI ranks
-  double gMin = 0.0;
-  double gMax = 0.0;
+  // compute the min and max across all MPI ranks. the min is negated so
+  // that both are found by a single reduction. the range is needed to bin
+  // the data so this reduction cannot be deferred
+  double range[2] = {-this->Min, this->Max};
+
+  MPIUtils::NodeAwareAllreduce(this->Comm, range, 2, MPI_DOUBLE, MPI_MAX);
 
-  MPI_Allreduce(&this->Min, &gMin, 1, MPI_DOUBLE, MPI_MIN, this->Comm);
-  MPI_Allreduce(&this->Max, &gMax, 1, MPI_DOUBLE, MPI_MAX, this->Comm);
+  double gMin = -range[0];
+  double gMax = range[1];
 
   this->Min = gMin;
   this->Max = gMax;
@@ -649,8 +793,17 @@ int HistogramInternals::ComputeLocalHistogram()
 #endif
           // compute the histgram for this block's worth of data on the CPU
           // data is already in the right place, it is moved in AddLocalData
-          HistogramInternalsCPU::block_local_histogram<SVTK_TT>((SVTK_TT*)pDa.get(),
-            pGhosts.get(), nVals, this->Min, this->Width, this->Histogram.get(), nBins);
+          if (pGhosts)
+            {
+            HistogramInternalsCPU::block_local_histogram<SVTK_TT>((SVTK_TT*)pDa.get(),
+              pGhosts.get(), nVals, this->Min, this->Width, this->Histogram.get(), nBins);
+            }
+          else
+            {
+            HistogramInternalsCPU::block_local_histogram<SVTK_TT>((SVTK_TT*)pDa.get(),
+              this->ExtentCache[da][0], this->ExtentCache[da][1], this->Min,
+              this->Width, this->Histogram.get(), nBins);
+            }
 #if defined(ENABLE_CUDA)
           }
 #endif
@@ -700,23 +853,71 @@ int HistogramInternals::FinalizeHistogram()
 
   // finalize the histogram calculation by summing up contributions from each
   // MPI rank to MPI rank 0
-  MPI_Reduce(pHist.get(), tmp, nBins, MPI_UNSIGNED, MPI_SUM, 0, this->Comm);
+  if (this->NonBlocking)
+    {
+    // the local histogram and its CPU accessible copy are held until the
+    // reduction completes
+    this->LocalHistogram = this->Histogram;
+    this->SendBuffer = pHist;
+    this->Histogram = std::shared_ptr<unsigned int>(tmp, free);
 
-  // merge in the extra bin (see earlier comments)
-  if (rank == 0)
-    tmp[this->NumberOfBins - 1] += tmp[this->NumberOfBins];
+    MPI_Ireduce(pHist.get(), tmp, nBins, MPI_UNSIGNED, MPI_SUM, 0,
+      this->Comm, &this->Request);
+
+    return 0;
+    }
+
+  MPIUtils::NodeAwareReduce(this->Comm, pHist.get(), tmp, nBins,
+    MPI_UNSIGNED, MPI_SUM, 0);
 
   // Replace the internal copy of the histogram with the finalized result.
   // only MPI rank 0 has the result after this
   this->Histogram = std::shared_ptr<unsigned int>(tmp, free);
 
+  this->MergeExtraBin();
+
   return 0;
 }
 
+// --------------------------------------------------------------------------
+int HistogramInternals::WaitHistogram()
+{
+  if (this->Request == MPI_REQUEST_NULL)
+    return 0;
+
+  MPI_Wait(&this->Request, MPI_STATUS_IGNORE);
+
+  this->SendBuffer = nullptr;
+  this->LocalHistogram = nullptr;
+
+  this->MergeExtraBin();
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void HistogramInternals::MergeExtraBin()
+{
+  // merge in the extra bin (see earlier comments). only MPI rank 0 has the
+  // result
+  int rank = 0;
+  MPI_Comm_rank(this->Comm, &rank);
+
+  if (rank == 0)
+    {
+    unsigned int *pHist = this->Histogram.get();
+    pHist[this->NumberOfBins - 1] += pHist[this->NumberOfBins];
+    }
+}
+
 // --------------------------------------------------------------------------
 int HistogramInternals::GetHistogram(int &nBins, double &binMin, double &binMax,
   double &binWidth, std::vector<unsigned int> &histogram)
 {
+  // complete a reduction posted in nonblocking mode
+  if (this->WaitHistogram())
+    return -1;
+
   int rank = 0;
   MPI_Comm_rank(this->Comm, &rank);
 
@@ -12,6 +12,7 @@ class svtkDataArray;
 #include <map>
 #include <memory>
 #include <limits>
+#include <array>
 
 namespace sensei
 {
@@ -29,6 +30,25 @@ namespace sensei
  * GetHistogram
  * Clear
  *
+ * Alternatively, the data may be streamed through one block at a time so
+ * that only one block is held in memory. This requires two passes over the
+ * blocks:
+ *
+ * Initialize
+ * AddLocalData, ComputeLocalRange, ClearData (once per local data block)
+ * ComputeGlobalRange
+ * InitializeHistogram
+ * AddLocalData, ComputeLocalHistogram, ClearData (once per local data block)
+ * FinalizeHistogram
+ * GetHistogram
+ * Clear
+ *
+ * When nonblocking mode is enabled FinalizeHistogram, and hence
+ * ComputeHistogram, post the reduction of the local histograms and return
+ * without waiting for it. The reduction is completed by WaitHistogram,
+ * GetHistogram, or Clear, so that other work may be overlapped with it. The
+ * object must be kept alive until the reduction completes.
+ *
  * All methods return 0 if successful.
  */
 class HistogramInternals
@@ -42,7 +62,9 @@ public:
       NumberOfBins(numberOfBins),
       Min(std::numeric_limits<double>::max()),
       Max(std::numeric_limits<double>::lowest()),
-      Width(1.0)
+      Width(1.0),
+      NonBlocking(0),
+      Request(MPI_REQUEST_NULL)
     {}
 
     ~HistogramInternals();
@@ -53,6 +75,13 @@ public:
     /** add block local contributions */
     int AddLocalData(svtkDataArray *da, svtkUnsignedCharArray *ghostArray);
 
+    /** add block local contributions of a cell data array on a logically
+     * Cartesian block. ext is the cell extent of the block and ownedExt the
+     * extent of the cells that are not ghosts. Only the owned cells are
+     * visited, a ghost array is generated only when computing on the GPU */
+    int AddLocalData(svtkDataArray *da, const std::array<int,6> &ext,
+      const std::array<int,6> &ownedExt);
+
     /** compute the histogram. this call uses MPI collectives, all ranks must
      * participate */
     int ComputeHistogram();
@@ -61,12 +90,27 @@ public:
     int GetHistogram(int &nBins, double &binMin, double &binMax,
       double &binWidth, std::vector<unsigned int> &histogram);
 
+    /** when set the reduction made by FinalizeHistogram is posted with a
+     * nonblocking collective and completed by WaitHistogram */
+    void SetNonBlocking(int val) { this->NonBlocking = val; }
+
+    /** complete a reduction posted in nonblocking mode. Returns immediately
+     * if there is none outstanding */
+    int WaitHistogram();
+
     /** free all cached memory and reset all internal parameters */
     int Clear();
 
-private:
-    /** compute the global min and max across all MPI ranks and blocks*/
-    int ComputeRange();
+    /** free the cached block data, the range and histogram are retained */
+    int ClearData();
+
+    /** accumulate the min and max of the currently cached blocks */
+    int ComputeLocalRange();
+
+    /** compute the global min and max across all MPI ranks from the
+     * accumulated local min and max. this call uses MPI collectives, all
+     * ranks must participate */
+    int ComputeGlobalRange();
 
     /** initialize the histogram, must be called after ComputeGlobalRange */
     int InitializeHistogram();
@@ -75,9 +119,21 @@ private:
     int ComputeLocalHistogram();
 
     /** Apply a reduction to locally computed histograms across all ranks.
-     * Result is valid only on rank 0 */
+     * Result is valid only on rank 0. In nonblocking mode the reduction is
+     * posted and this call returns immediately */
     int FinalizeHistogram();
 
+private:
+    /** compute the global min and max across all MPI ranks and blocks*/
+    int ComputeRange();
+
+    /** add the count of the extra bin to the last bin of the reduced
+     * histogram */
+    void MergeExtraBin();
+
+    /** cache a pointer to the array data accessible where the calculation runs */
+    int CacheData(svtkDataArray *da);
+
 private:
   MPI_Comm Comm;
   int DeviceId;
@@ -87,7 +143,12 @@ private:
   double Width;
   std::map<svtkDataArray*, std::shared_ptr<void>> DataCache;
   std::map<svtkDataArray*, std::shared_ptr<unsigned char>> GhostCache;
+  std::map<svtkDataArray*, std::array<std::array<int,6>,2>> ExtentCache;
   std::shared_ptr<unsigned int> Histogram;
+  int NonBlocking;
+  MPI_Request Request;
+  std::shared_ptr<unsigned int> LocalHistogram;
+  std::shared_ptr<unsigned int> SendBuffer;
 };
 
 }
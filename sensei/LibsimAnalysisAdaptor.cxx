@@ -751,13 +751,13 @@ LibsimAnalysisAdaptor::PrivateData::ProcessVisItCommand(int rank)
         if (success == VISIT_OKAY)
         {
             command = VISIT_COMMAND_SUCCESS;
-            MPI_Bcast(&command, 1, MPI_INT, 0, this->Comm);
+            MPI_Bcast(&command, 1, MPI_INT, 0, this->GetCommunicator());
             return 1;
         }
         else
         {
             command = VISIT_COMMAND_FAILURE;
-            MPI_Bcast(&command, 1, MPI_INT, 0, this->Comm);
+            MPI_Bcast(&command, 1, MPI_INT, 0, this->GetCommunicator());
             return 0;
         }
     }
@@ -768,7 +768,7 @@ LibsimAnalysisAdaptor::PrivateData::ProcessVisItCommand(int rank)
          * instruction to the non-rank 0 processes. */
         while (1)
         {
-            MPI_Bcast(&command, 1, MPI_INT, 0, this->Comm);
+            MPI_Bcast(&command, 1, MPI_INT, 0, this->GetCommunicator());
             switch (command)
             {
             case VISIT_COMMAND_PROCESS:
@@ -809,7 +809,7 @@ LibsimAnalysisAdaptor::PrivateData::Execute_Interactive(int rank)
             visitstate = VisItDetectInputWithTimeout(blocking, 200, -1);
         }
         // Broadcast the return value of VisItDetectInput to all procs.
-        MPI_Bcast(&visitstate, 1, MPI_INT, 0, this->Comm);
+        MPI_Bcast(&visitstate, 1, MPI_INT, 0, this->GetCommunicator());
 
         // Do different things depending on the output from VisItDetectInput.
         switch(visitstate)
@@ -1705,7 +1705,7 @@ int LibsimAnalysisAdaptor::PrivateData::GetVariable(int dom,
         return -1;
 
     svtkCompositeDataSetPtr cd =
-      SVTKUtils::AsCompositeData(this->Comm, dobj.GetPointer(), false);
+      SVTKUtils::AsCompositeData(this->GetCommunicator(), dobj.GetPointer(), false);
 
     // see if we already have this array
     svtkCompositeDataIterator *cdit = cd->NewIterator();
@@ -1795,7 +1795,7 @@ int LibsimAnalysisAdaptor::PrivateData::GetMesh(int dom,
         return -1;
 
     svtkCompositeDataSetPtr cd =
-      SVTKUtils::AsCompositeData(this->Comm, dobj.GetPointer(), false);
+      SVTKUtils::AsCompositeData(this->GetCommunicator(), dobj.GetPointer(), false);
 
     // get the block that visit is after
     svtkCompositeDataIterator *cdit = cd->NewIterator();
@@ -0,0 +1,670 @@
+#include "MPIUtils.h"
+#include "Error.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+namespace sensei
+{
+namespace MPIUtils
+{
+
+namespace
+{
+// a pooled duplicate, the communicator it was made from, and the tag it is
+// shared under
+struct PoolEntry
+{
+  MPI_Comm Parent;
+  std::string Tag;
+  MPI_Comm Comm;
+  long RefCount;
+};
+
+// the pooled duplicates of a communicator by tag
+using PoolMap = std::map<std::string, PoolEntry*>;
+
+// attribute keys. the parent communicator holds the map of its pooled
+// duplicates under ParentKey and each duplicate holds its entry under
+// PooledKey
+int ParentKey = MPI_KEYVAL_INVALID;
+int PooledKey = MPI_KEYVAL_INVALID;
+
+// **************************************************************************
+int ParentDeleted(MPI_Comm, int, void *value, void *)
+{
+  // the parent was freed, or the last of its duplicates was released. the
+  // duplicates that remain are still valid.
+  PoolMap *pool = static_cast<PoolMap*>(value);
+  for (auto &it : *pool)
+    it.second->Parent = MPI_COMM_NULL;
+
+  delete pool;
+
+  return MPI_SUCCESS;
+}
+
+// **************************************************************************
+template <typename value_t>
+value_t *GetAttribute(MPI_Comm comm, int key)
+{
+  void *value = nullptr;
+  int found = 0;
+  MPI_Comm_get_attr(comm, key, &value, &found);
+  return found ? static_cast<value_t*>(value) : nullptr;
+}
+
+// the node local and node leader communicators made from a parent
+// communicator, and the shared memory the ranks of a node communicate
+// through. these are cached on the parent under NodeKey
+struct NodeEntry
+{
+  int Hierarchical;         // 0 when every node has a single rank
+  MPI_Comm Node;            // the ranks of the parent on this rank's node
+  MPI_Comm Leaders;         // node rank 0 of each node, null elsewhere
+  int NodeRank;
+  int NodeSize;
+  int NodeId;               // the rank of this node's leader in Leaders
+  int NumberOfNodes;
+  std::vector<int> RankNode;    // the node of each rank of the parent
+  std::vector<int> NodeRanks;   // the parent ranks of each node
+  std::vector<int> NodeOffsets; // where each node starts in NodeRanks
+  MPI_Win Win;
+  char *Shared;
+  MPI_Aint SharedBytes;
+};
+
+int NodeKey = MPI_KEYVAL_INVALID;
+int FinalizeKey = MPI_KEYVAL_INVALID;
+
+// the entries in the order they were made. entries of communicators that
+// are still alive when MPI is finalized are freed in this order, which is
+// the same on all ranks
+std::vector<NodeEntry*> NodeEntries;
+
+// **************************************************************************
+void FreeShared(NodeEntry *entry)
+{
+  if (entry->Win == MPI_WIN_NULL)
+    return;
+
+  MPI_Win_unlock_all(entry->Win);
+  MPI_Win_free(&entry->Win);
+
+  entry->Shared = nullptr;
+  entry->SharedBytes = 0;
+}
+
+// **************************************************************************
+// free the window and communicators of an entry. this is collective over
+// the node
+void FreeNodeComms(NodeEntry *entry)
+{
+  FreeShared(entry);
+
+  if (entry->Node != MPI_COMM_NULL)
+    MPI_Comm_free(&entry->Node);
+
+  if (entry->Leaders != MPI_COMM_NULL)
+    MPI_Comm_free(&entry->Leaders);
+
+  entry->Hierarchical = 0;
+}
+
+// **************************************************************************
+int NodeEntryDeleted(MPI_Comm, int, void *value, void *)
+{
+  // the parent is being freed, this is collective over the parent and
+  // hence over the node and leader communicators
+  NodeEntry *entry = static_cast<NodeEntry*>(value);
+
+  NodeEntries.erase(std::remove(NodeEntries.begin(), NodeEntries.end(),
+    entry), NodeEntries.end());
+
+  FreeNodeComms(entry);
+
+  delete entry;
+
+  return MPI_SUCCESS;
+}
+
+// **************************************************************************
+int FinalizeNodeEntries(MPI_Comm, int, void *, void *)
+{
+  // MPI is being finalized. the windows and communicators of parents that
+  // were not freed must be released while MPI is still usable. the parents
+  // are never freed after this
+  for (NodeEntry *entry : NodeEntries)
+    FreeNodeComms(entry);
+
+  NodeEntries.clear();
+
+  return MPI_SUCCESS;
+}
+
+// **************************************************************************
+int NodeAwareEnabled()
+{
+  static int enabled = -1;
+  if (enabled < 0)
+    {
+    char *tmp = getenv("SENSEI_NODE_AWARE");
+    enabled = tmp ? atoi(tmp) : 1;
+    }
+  return enabled;
+}
+
+// **************************************************************************
+int GetRanksPerNode()
+{
+  static int ranksPerNode = -1;
+  if (ranksPerNode < 0)
+    {
+    char *tmp = getenv("SENSEI_RANKS_PER_NODE");
+    ranksPerNode = tmp ? std::max(0, atoi(tmp)) : 0;
+    }
+  return ranksPerNode;
+}
+
+// **************************************************************************
+int GetNodeAwareMinBytes()
+{
+  static int minBytes = -1;
+  if (minBytes < 0)
+    {
+    char *tmp = getenv("SENSEI_NODE_AWARE_MIN_BYTES");
+    minBytes = tmp ? std::max(0, atoi(tmp)) : 1024;
+    }
+  return minBytes;
+}
+
+// **************************************************************************
+// returns true when a reduction should use the flat MPI collective. the node
+// aware reduction does not combine the contributions in rank order, hence it
+// requires a commutative op. small reductions are latency bound and gain
+// nothing from the extra synchronization of the node aware reduction. the
+// arguments are the same on all ranks so all ranks agree
+bool FlatReduction(int count, MPI_Datatype type, MPI_Op op)
+{
+  int commute = 0;
+  MPI_Op_commutative(op, &commute);
+  if (!commute)
+    return true;
+
+  int typeSize = 0;
+  MPI_Type_size(type, &typeSize);
+
+  return long(count)*typeSize < GetNodeAwareMinBytes();
+}
+
+// **************************************************************************
+// get the cached node communicators of comm, making them the first time.
+// this is collective over comm. returns nullptr when the flat collectives
+// should be used
+NodeEntry *GetNodeEntry(MPI_Comm comm)
+{
+  if ((comm == MPI_COMM_NULL) || !NodeAwareEnabled())
+    return nullptr;
+
+  if (NodeKey == MPI_KEYVAL_INVALID)
+    {
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, NodeEntryDeleted, &NodeKey, nullptr);
+
+    // attributes of MPI_COMM_SELF are deleted first thing in MPI_Finalize
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, FinalizeNodeEntries,
+      &FinalizeKey, nullptr);
+
+    MPI_Comm_set_attr(MPI_COMM_SELF, FinalizeKey, nullptr);
+    }
+
+  void *value = nullptr;
+  int found = 0;
+  MPI_Comm_get_attr(comm, NodeKey, &value, &found);
+  if (found)
+    {
+    NodeEntry *entry = static_cast<NodeEntry*>(value);
+    return entry->Hierarchical ? entry : nullptr;
+    }
+
+  NodeEntry *entry = new NodeEntry{0, MPI_COMM_NULL, MPI_COMM_NULL, 0, 1,
+    0, 1, {}, {}, {}, MPI_WIN_NULL, nullptr, 0};
+
+  int inter = 0;
+  MPI_Comm_test_inter(comm, &inter);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  if (!inter && (nRanks > 1))
+    {
+    // split into the ranks that share memory. nodes may be emulated on a
+    // single node for testing
+    int ranksPerNode = GetRanksPerNode();
+    if (ranksPerNode > 0)
+      MPI_Comm_split(comm, rank/ranksPerNode, rank, &entry->Node);
+    else
+      MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, rank,
+        MPI_INFO_NULL, &entry->Node);
+
+    MPI_Comm_rank(entry->Node, &entry->NodeRank);
+    MPI_Comm_size(entry->Node, &entry->NodeSize);
+
+    // rank 0 of each node communicates with the other nodes
+    MPI_Comm_split(comm, entry->NodeRank ? MPI_UNDEFINED : 0, rank,
+      &entry->Leaders);
+
+    if (entry->Leaders != MPI_COMM_NULL)
+      {
+      MPI_Comm_rank(entry->Leaders, &entry->NodeId);
+      MPI_Comm_size(entry->Leaders, &entry->NumberOfNodes);
+      }
+
+    MPI_Bcast(&entry->NodeId, 1, MPI_INT, 0, entry->Node);
+    MPI_Bcast(&entry->NumberOfNodes, 1, MPI_INT, 0, entry->Node);
+
+    // the ranks of each node. node ranks are ordered as in the parent
+    entry->RankNode.resize(nRanks);
+    MPI_Allgather(&entry->NodeId, 1, MPI_INT, entry->RankNode.data(),
+      1, MPI_INT, comm);
+
+    int nNodes = entry->NumberOfNodes;
+    entry->NodeOffsets.assign(nNodes + 1, 0);
+    for (int i = 0; i < nRanks; ++i)
+      entry->NodeOffsets[entry->RankNode[i] + 1] += 1;
+
+    int maxNodeSize = 0;
+    for (int i = 0; i < nNodes; ++i)
+      {
+      maxNodeSize = std::max(maxNodeSize, entry->NodeOffsets[i + 1]);
+      entry->NodeOffsets[i + 1] += entry->NodeOffsets[i];
+      }
+
+    entry->NodeRanks.resize(nRanks);
+    std::vector<int> next(entry->NodeOffsets.begin(), entry->NodeOffsets.end() - 1);
+    for (int i = 0; i < nRanks; ++i)
+      entry->NodeRanks[next[entry->RankNode[i]]++] = i;
+
+    // with a single rank per node the flat collectives are used
+    entry->Hierarchical = maxNodeSize > 1;
+    }
+
+  if (!entry->Hierarchical)
+    FreeNodeComms(entry);
+
+  MPI_Comm_set_attr(comm, NodeKey, entry);
+
+  if (entry->Hierarchical)
+    NodeEntries.push_back(entry);
+
+  return entry->Hierarchical ? entry : nullptr;
+}
+
+// **************************************************************************
+// make sure the shared memory holds at least nBytes. this is collective over
+// the node and nBytes must be the same on all of its ranks
+void ReserveShared(NodeEntry *entry, MPI_Aint nBytes)
+{
+  if (nBytes <= entry->SharedBytes)
+    return;
+
+  FreeShared(entry);
+
+  // grow geometrically to avoid reallocating as sizes creep up
+  MPI_Aint allocBytes = std::max(nBytes, MPI_Aint(4096));
+  allocBytes = std::max(allocBytes, 2*entry->SharedBytes);
+
+  // the memory is allocated on the node's rank 0 and mapped by the others
+  void *base = nullptr;
+  MPI_Win_allocate_shared(entry->NodeRank ? 0 : allocBytes, 1,
+    MPI_INFO_NULL, entry->Node, &base, &entry->Win);
+
+  MPI_Aint size = 0;
+  int dispUnit = 1;
+  MPI_Win_shared_query(entry->Win, 0, &size, &dispUnit, &base);
+
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, entry->Win);
+
+  entry->Shared = static_cast<char*>(base);
+  entry->SharedBytes = allocBytes;
+}
+
+// **************************************************************************
+// make writes to the shared memory visible to the other ranks of the node
+void SyncShared(NodeEntry *entry)
+{
+  MPI_Win_sync(entry->Win);
+  MPI_Barrier(entry->Node);
+  MPI_Win_sync(entry->Win);
+}
+
+// **************************************************************************
+// reduce the contributions of the ranks of the node, held in consecutive
+// slots of the shared memory, into the first slot. each rank reduces a
+// section of the elements. the op must be commutative, see FlatReduction
+void ReduceShared(NodeEntry *entry, int count, MPI_Datatype type,
+  MPI_Op op, MPI_Aint extent)
+{
+  int nSec = entry->NodeSize;
+  int secSize = count / nSec + (count % nSec ? 1 : 0);
+  int secStart = std::min(count, entry->NodeRank*secSize);
+  int secCount = std::min(count - secStart, secSize);
+
+  if (secCount < 1)
+    return;
+
+  char *out = entry->Shared + secStart*extent;
+  for (int i = 1; i < nSec; ++i)
+    {
+    char *in = entry->Shared + (i*MPI_Aint(count) + secStart)*extent;
+    MPI_Reduce_local(in, out, secCount, type, op);
+    }
+}
+}
+
+// --------------------------------------------------------------------------
+int NodeAwareAllreduce(MPI_Comm comm, void *buf, int count,
+  MPI_Datatype type, MPI_Op op)
+{
+  NodeEntry *entry = nullptr;
+  if (FlatReduction(count, type, op) || !(entry = GetNodeEntry(comm)))
+    return MPI_Allreduce(MPI_IN_PLACE, buf, count, type, op, comm);
+
+  if (count < 1)
+    return MPI_SUCCESS;
+
+  MPI_Aint lb = 0;
+  MPI_Aint extent = 0;
+  MPI_Type_get_extent(type, &lb, &extent);
+
+  MPI_Aint nBytes = count*extent;
+  ReserveShared(entry, entry->NodeSize*nBytes);
+
+  // reduce within the node
+  memcpy(entry->Shared + entry->NodeRank*nBytes, buf, nBytes);
+  SyncShared(entry);
+
+  ReduceShared(entry, count, type, op, extent);
+  SyncShared(entry);
+
+  // then across the nodes
+  int ierr = MPI_SUCCESS;
+  if ((entry->Leaders != MPI_COMM_NULL) && (entry->NumberOfNodes > 1))
+    ierr = MPI_Allreduce(MPI_IN_PLACE, entry->Shared, count, type, op,
+      entry->Leaders);
+
+  SyncShared(entry);
+
+  memcpy(buf, entry->Shared, nBytes);
+
+  // the shared memory is reused by the next call
+  SyncShared(entry);
+
+  return ierr;
+}
+
+// --------------------------------------------------------------------------
+int NodeAwareReduce(MPI_Comm comm, const void *sendBuf, void *recvBuf,
+  int count, MPI_Datatype type, MPI_Op op, int root)
+{
+  NodeEntry *entry = nullptr;
+  if (FlatReduction(count, type, op) || !(entry = GetNodeEntry(comm)))
+    return MPI_Reduce(sendBuf, recvBuf, count, type, op, root, comm);
+
+  if (count < 1)
+    return MPI_SUCCESS;
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  MPI_Aint lb = 0;
+  MPI_Aint extent = 0;
+  MPI_Type_get_extent(type, &lb, &extent);
+
+  MPI_Aint nBytes = count*extent;
+  ReserveShared(entry, entry->NodeSize*nBytes);
+
+  // reduce within the node
+  memcpy(entry->Shared + entry->NodeRank*nBytes, sendBuf, nBytes);
+  SyncShared(entry);
+
+  ReduceShared(entry, count, type, op, extent);
+  SyncShared(entry);
+
+  // then across the nodes to the leader of the root's node
+  int ierr = MPI_SUCCESS;
+  int rootNode = entry->RankNode[root];
+  if ((entry->Leaders != MPI_COMM_NULL) && (entry->NumberOfNodes > 1))
+    {
+    if (entry->NodeId == rootNode)
+      ierr = MPI_Reduce(MPI_IN_PLACE, entry->Shared, count, type, op,
+        rootNode, entry->Leaders);
+    else
+      ierr = MPI_Reduce(entry->Shared, nullptr, count, type, op,
+        rootNode, entry->Leaders);
+    }
+
+  SyncShared(entry);
+
+  if (rank == root)
+    memcpy(recvBuf, entry->Shared, nBytes);
+
+  // the shared memory is reused by the next call
+  SyncShared(entry);
+
+  return ierr;
+}
+
+// --------------------------------------------------------------------------
+int NodeAwareAllgatherv(MPI_Comm comm, const void *lData, int lCount,
+  void *gData, const int *gCounts, const int *gOffsets, MPI_Datatype type)
+{
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  MPI_Aint lb = 0;
+  MPI_Aint extent = 0;
+  MPI_Type_get_extent(type, &lb, &extent);
+
+  NodeEntry *entry = GetNodeEntry(comm);
+  if (!entry)
+    {
+    char *gd = static_cast<char*>(gData) + gOffsets[rank]*extent;
+    if (lCount && (gd != lData))
+      memmove(gd, lData, lCount*extent);
+
+    return MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, gData,
+      gCounts, gOffsets, type, comm);
+    }
+
+  MPI_Aint nTotal = 0;
+  for (int i = 0; i < nRanks; ++i)
+    nTotal = std::max(nTotal, MPI_Aint(gOffsets[i]) + gCounts[i]);
+
+  if (nTotal < 1)
+    return MPI_SUCCESS;
+
+  MPI_Aint nBytes = nTotal*extent;
+  ReserveShared(entry, nBytes);
+
+  // gather within the node
+  if (lCount)
+    memcpy(entry->Shared + gOffsets[rank]*extent, lData, lCount*extent);
+
+  SyncShared(entry);
+
+  // then across the nodes. the leaders exchange the data of their node
+  // packed in node rank order
+  int ierr = MPI_SUCCESS;
+  int nNodes = entry->NumberOfNodes;
+  if ((entry->Leaders != MPI_COMM_NULL) && (nNodes > 1))
+    {
+    std::vector<int> nodeCounts(nNodes, 0);
+    std::vector<int> nodeOffsets(nNodes, 0);
+
+    int nPacked = 0;
+    for (int j = 0; j < nNodes; ++j)
+      {
+      nodeOffsets[j] = nPacked;
+      for (int q = entry->NodeOffsets[j]; q < entry->NodeOffsets[j + 1]; ++q)
+        nodeCounts[j] += gCounts[entry->NodeRanks[q]];
+      nPacked += nodeCounts[j];
+      }
+
+    std::vector<char> packed(std::max(MPI_Aint(1), nPacked*extent));
+
+    // transfer between the shared memory and the packed buffer
+    auto copyNode = [&](int j, bool pack)
+      {
+      char *pd = packed.data() + nodeOffsets[j]*extent;
+      for (int q = entry->NodeOffsets[j]; q < entry->NodeOffsets[j + 1]; ++q)
+        {
+        int r = entry->NodeRanks[q];
+        MPI_Aint n = gCounts[r]*extent;
+        char *sd = entry->Shared + gOffsets[r]*extent;
+        if (pack)
+          memcpy(pd, sd, n);
+        else
+          memcpy(sd, pd, n);
+        pd += n;
+        }
+      };
+
+    copyNode(entry->NodeId, true);
+
+    ierr = MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, packed.data(),
+      nodeCounts.data(), nodeOffsets.data(), type, entry->Leaders);
+
+    for (int j = 0; j < nNodes; ++j)
+      {
+      if (j != entry->NodeId)
+        copyNode(j, false);
+      }
+    }
+
+  SyncShared(entry);
+
+  memcpy(gData, entry->Shared, nBytes);
+
+  // the shared memory is reused by the next call
+  SyncShared(entry);
+
+  return ierr;
+}
+
+// --------------------------------------------------------------------------
+int NodeAwareAllgather(MPI_Comm comm, const void *lData, int count,
+  void *gData, MPI_Datatype type)
+{
+  int nRanks = 1;
+  MPI_Comm_size(comm, &nRanks);
+
+  std::vector<int> gCounts(nRanks, count);
+  std::vector<int> gOffsets(nRanks);
+  for (int i = 0; i < nRanks; ++i)
+    gOffsets[i] = i*count;
+
+  return NodeAwareAllgatherv(comm, lData, count, gData, gCounts.data(),
+    gOffsets.data(), type);
+}
+
+// --------------------------------------------------------------------------
+MPI_Comm AcquireCommunicator(MPI_Comm comm, const std::string &tag)
+{
+  if (comm == MPI_COMM_NULL)
+    return MPI_COMM_NULL;
+
+  if (ParentKey == MPI_KEYVAL_INVALID)
+    {
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, ParentDeleted, &ParentKey, nullptr);
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, MPI_COMM_NULL_DELETE_FN, &PooledKey, nullptr);
+    }
+
+  // a pooled communicator is shared when the tags match, otherwise the
+  // communicator it was made from is used while that exists
+  PoolEntry *entry = GetAttribute<PoolEntry>(comm, PooledKey);
+  if (entry && (entry->Tag == tag))
+    {
+    entry->RefCount += 1;
+    return entry->Comm;
+    }
+
+  if (entry && (entry->Parent != MPI_COMM_NULL))
+    comm = entry->Parent;
+
+  // one that already has a pooled duplicate with this tag
+  PoolMap *pool = GetAttribute<PoolMap>(comm, ParentKey);
+  if (!pool)
+    {
+    pool = new PoolMap;
+    MPI_Comm_set_attr(comm, ParentKey, pool);
+    }
+
+  PoolMap::iterator it = pool->find(tag);
+  if (it != pool->end())
+    {
+    it->second->RefCount += 1;
+    return it->second->Comm;
+    }
+
+  // make a new duplicate
+  entry = new PoolEntry{comm, tag, MPI_COMM_NULL, 1};
+  MPI_Comm_dup(comm, &entry->Comm);
+
+  (*pool)[tag] = entry;
+  MPI_Comm_set_attr(entry->Comm, PooledKey, entry);
+
+  return entry->Comm;
+}
+
+// --------------------------------------------------------------------------
+void ReleaseCommunicator(MPI_Comm &comm)
+{
+  if (comm == MPI_COMM_NULL)
+    return;
+
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (finalized)
+    {
+    comm = MPI_COMM_NULL;
+    return;
+    }
+
+  PoolEntry *entry = PooledKey == MPI_KEYVAL_INVALID ?
+    nullptr : GetAttribute<PoolEntry>(comm, PooledKey);
+
+  if (!entry)
+    {
+    SENSEI_ERROR("The communicator was not acquired from the pool")
+    comm = MPI_COMM_NULL;
+    return;
+    }
+
+  comm = MPI_COMM_NULL;
+
+  entry->RefCount -= 1;
+  if (entry->RefCount > 0)
+    return;
+
+  // the last reference was released
+  if (entry->Parent != MPI_COMM_NULL)
+    {
+    PoolMap *pool = GetAttribute<PoolMap>(entry->Parent, ParentKey);
+    pool->erase(entry->Tag);
+    if (pool->empty())
+      MPI_Comm_delete_attr(entry->Parent, ParentKey);
+    }
+
+  MPI_Comm_free(&entry->Comm);
+
+  delete entry;
+}
+
+}
+}
@@ -3,8 +3,15 @@
 
 /// @file
 
+#include "senseiConfig.h"
+
+#include <mpi.h>
 #include <algorithm>
 #include <limits>
+#include <array>
+#include <string>
+#include <vector>
+#include <utility>
 
 namespace sensei
 {
@@ -13,6 +20,75 @@ namespace sensei
 namespace MPIUtils
 {
 
+/** Returns a duplicate of comm from a reference counted pool. All callers
+ * passing the same communicator and tag share a single duplicate, which is
+ * made the first time the pair is passed and is collective over comm.
+ * Callers with different tags get separate duplicates, so that the messages
+ * and nonblocking collectives of one, which may be in flight from one time
+ * step to the next, can not be matched by another. The adaptors use their
+ * class name as the tag. Passing a communicator that was itself returned by
+ * this function with the same tag shares it without making a duplicate,
+ * with another tag the communicator it was made from is duplicated. The pool
+ * tracks communicators through MPI attributes, so a communicator freed by
+ * the caller is never confused with one created later. Each call must be
+ * paired with a call to ReleaseCommunicator.
+ */
+SENSEI_EXPORT
+MPI_Comm AcquireCommunicator(MPI_Comm comm, const std::string &tag = "");
+
+/** Releases a communicator returned by AcquireCommunicator. The duplicate is
+ * freed when the last reference to it is released. comm is set to
+ * MPI_COMM_NULL. Nothing is done if MPI was already finalized.
+ */
+SENSEI_EXPORT
+void ReleaseCommunicator(MPI_Comm &comm);
+
+/** @name Node aware collectives
+ * Hierarchical versions of MPI collectives. The ranks on each node first
+ * combine their data through a shared memory window, then rank 0 of each
+ * node communicates with the other nodes, and the result is shared through
+ * the window. This reduces the number of messages by the number of ranks
+ * per node. The node and node leader communicators and the window are made
+ * the first time a communicator is passed, which is collective over it, and
+ * are cached on it until it is freed.
+ *
+ * The flat MPI collective is used when every node has a single rank, or
+ * when the environment variable SENSEI_NODE_AWARE is set to 0. Setting
+ * SENSEI_RANKS_PER_NODE emulates nodes of the given number of ranks, this is
+ * for testing on a single node. The arguments are those of the MPI
+ * collective, all return MPI_SUCCESS when successful.
+ *
+ * The reductions combine the contributions of the ranks in an order that
+ * differs from rank order, so they are only node aware for commutative ops.
+ * Non-commutative ops, for instance user ops created with commute set to
+ * false, use the flat MPI_Reduce and MPI_Allreduce. Reductions of fewer than
+ * 1024 bytes also use the flat collective since they are latency bound. The
+ * threshold is set with the environment variable
+ * SENSEI_NODE_AWARE_MIN_BYTES.
+ */
+///@{
+/// an in place MPI_Allreduce
+SENSEI_EXPORT
+int NodeAwareAllreduce(MPI_Comm comm, void *buf, int count,
+  MPI_Datatype type, MPI_Op op);
+
+/// an MPI_Reduce, recvBuf is only used on the root
+SENSEI_EXPORT
+int NodeAwareReduce(MPI_Comm comm, const void *sendBuf, void *recvBuf,
+  int count, MPI_Datatype type, MPI_Op op, int root);
+
+/** an MPI_Allgatherv. lData may point to the local data's position in
+ * gData. The counts and offsets of every rank must be passed */
+SENSEI_EXPORT
+int NodeAwareAllgatherv(MPI_Comm comm, const void *lData, int lCount,
+  void *gData, const int *gCounts, const int *gOffsets, MPI_Datatype type);
+
+/// an MPI_Allgather
+SENSEI_EXPORT
+int NodeAwareAllgather(MPI_Comm comm, const void *lData, int count,
+  void *gData, MPI_Datatype type);
+///@}
+
 
 /// @cond
 
@@ -39,8 +115,8 @@ define_mpi_tt(double, MPI_DOUBLE)
 template<typename cpp_t>
 void GlobalCounts(MPI_Comm comm, std::vector<cpp_t> &vec)
 {
-  MPI_Allreduce(MPI_IN_PLACE, vec.data(), vec.size(),
-      mpi_tt<cpp_t>::datatype(), MPI_SUM, comm);
+  NodeAwareAllreduce(comm, vec.data(), vec.size(),
+      mpi_tt<cpp_t>::datatype(), MPI_SUM);
 }
 
 /** helper function to compute an axis aligned bounding box that bounds a
@@ -90,8 +166,8 @@ void GlobalBounds(MPI_Comm comm, const std::vector<std::array<cpp_t,6>> &lbounds
     gbounds[i] = -gbounds[i];
 
   // find the smallest bounding covering all distributed
-  MPI_Allreduce(MPI_IN_PLACE, gbounds.data(), 6,
-    mpi_tt<cpp_t>::datatype(), MPI_MAX, comm);
+  NodeAwareAllreduce(comm, gbounds.data(), 6,
+    mpi_tt<cpp_t>::datatype(), MPI_MAX);
 
   // because we used MPI_MAX
   for (size_t i = 0; i < 6; i += 2)
@@ -120,8 +196,8 @@ void GlobalRange(MPI_Comm comm, const std::vector<std::array<cpp_t,2>> &lrange,
   grange[0] = -grange[0];
 
   // find the smallest bounding covering all distributed
-  MPI_Allreduce(MPI_IN_PLACE, grange.data(), 2,
-    mpi_tt<cpp_t>::datatype(), MPI_MAX, comm);
+  NodeAwareAllreduce(comm, grange.data(), 2,
+    mpi_tt<cpp_t>::datatype(), MPI_MAX);
 
   // because we used MPI_MAX
   grange[0] = -grange[0];
@@ -135,20 +211,15 @@ template <typename cpp_t>
 void GlobalView(MPI_Comm comm, const std::vector<cpp_t> &ldata,
   std::vector<cpp_t> &gdata)
 {
-  int rank = 0;
   int nRanks = 1;
-
-  MPI_Comm_rank(comm, &rank);
   MPI_Comm_size(comm, &nRanks);
 
   int nLocal = ldata.size();
 
   gdata.resize(nRanks*nLocal);
-  for (int i = 0; i < nLocal; ++i)
-      gdata[nLocal*rank+i] = ldata[i];
 
-  MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
-    gdata.data(), nLocal, mpi_tt<cpp_t>::datatype(), comm);
+  NodeAwareAllgather(comm, ldata.data(), nLocal,
+    gdata.data(), mpi_tt<cpp_t>::datatype());
 }
 
 /* helper function to generate a global view from a local view. A vector of
@@ -163,20 +234,15 @@ void GlobalViewV(MPI_Comm comm, const std::vector<cpp_t> &ldata,
   std::vector<int> &gcounts, std::vector<int> &goffset,
   std::vector<cpp_t> &gdata)
 {
-  int rank = 0;
   int nRanks = 1;
-
-  MPI_Comm_rank(comm, &rank);
   MPI_Comm_size(comm, &nRanks);
 
   gcounts.clear();
   gcounts.resize(nRanks);
 
   int nLocal = ldata.size();
-  gcounts[rank] = nLocal;
 
-  MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
-    gcounts.data(), 1, MPI_INT, comm);
+  NodeAwareAllgather(comm, &nLocal, 1, gcounts.data(), MPI_INT);
 
   goffset.clear();
   goffset.resize(nRanks);
@@ -193,13 +259,8 @@ void GlobalViewV(MPI_Comm comm, const std::vector<cpp_t> &ldata,
 
   gdata.resize(nTotal);
 
-  const cpp_t *ld = ldata.data();
-  cpp_t *gd = gdata.data() + goffset[rank];
-  for (int i = 0; i < nLocal; ++i)
-    gd[i] = ld[i];
-
-  MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, gdata.data(),
-    gcounts.data(), goffset.data(), mpi_tt<cpp_t>::datatype(), comm);
+  NodeAwareAllgatherv(comm, ldata.data(), nLocal, gdata.data(),
+    gcounts.data(), goffset.data(), mpi_tt<cpp_t>::datatype());
 }
 
 /// use this if you don't need counts & offsets
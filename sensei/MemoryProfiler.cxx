@@ -30,6 +30,7 @@
 
 #if defined(__linux)
 #include <fenv.h>
+#include <malloc.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
@@ -680,6 +681,42 @@ long long MemoryProfiler::InternalsType::GetProcMemoryUsed()
 #endif
 }
 
+// --------------------------------------------------------------------------
+long long MemoryProfiler::GetProcPeakMemoryUsed()
+{
+#if defined(__linux) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage))
+    return -1;
+#if defined(__APPLE__)
+  // reported in bytes
+  return usage.ru_maxrss / 1024;
+#else
+  // reported in KiB
+  return usage.ru_maxrss;
+#endif
+#else
+  return -1;
+#endif
+}
+
+// --------------------------------------------------------------------------
+long long MemoryProfiler::GetHeapMemoryUsed()
+{
+#if defined(__GLIBC__) && ((__GLIBC__ > 2) || \
+  ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+  // in use bytes in the arenas plus those allocated with mmap
+  struct mallinfo2 mi = mallinfo2();
+  return mi.uordblks + mi.hblkhd;
+#elif defined(__GLIBC__)
+  // the legacy interface uses int and wraps beyond 2 GiB
+  struct mallinfo mi = mallinfo();
+  return (unsigned int)mi.uordblks + (unsigned int)mi.hblkhd;
+#else
+  return -1;
+#endif
+}
+
 // --------------------------------------------------------------------------
 int MemoryProfiler::InternalsType::InitializeWindowsMemory()
 {
@@ -43,6 +43,16 @@ public:
   void SetFilename(const std::string &filename);
   const char *GetFilename() const;
 
+  // Get the peak resident set size of this process in KiB, or
+  // a negative value if it is not available on this platform.
+  static long long GetProcPeakMemoryUsed();
+
+  // Get the number of bytes currently allocated on the heap by this
+  // process, or a negative value if it is not available on this platform.
+  // This is a process wide quantity and includes allocations made by all
+  // threads.
+  static long long GetHeapMemoryUsed();
+
   friend void *::profile(void *argp);
 
 private:
@@ -99,6 +99,7 @@ int MeshMetadata::ToStream(sensei::BinaryStream &str) const
   str.Pack(this->BlockNumCells);
   str.Pack(this->BlockCellArraySize);
   str.Pack(this->BlockExtents);
+  str.Pack(this->BlockOwnedExtents);
   str.Pack(this->BlockBounds);
   str.Pack(this->BlockArrayRange);
   str.Pack(this->RefRatio);
@@ -142,6 +143,7 @@ int MeshMetadata::FromStream(sensei::BinaryStream &str)
   str.Unpack(this->BlockNumCells);
   str.Unpack(this->BlockCellArraySize);
   str.Unpack(this->BlockExtents);
+  str.Unpack(this->BlockOwnedExtents);
   str.Unpack(this->BlockBounds);
   str.Unpack(this->BlockArrayRange);
   str.Unpack(this->RefRatio);
@@ -184,6 +186,7 @@ int MeshMetadata::ToStream(ostream &str) const
   str << "BlockNumCells = " << this->BlockNumCells << std::endl;
   str << "BlockCellArraySize = " << this->BlockCellArraySize << std::endl;
   str << "BlockExtents = " << this->BlockExtents << std::endl;
+  str << "BlockOwnedExtents = " << this->BlockOwnedExtents << std::endl;
   str << "BlockBounds = " << this->BlockBounds << std::endl;
   str << "BlockArrayRange = " << this->BlockArrayRange << std::endl;
   str << "RefRatio = " << this->RefRatio << std::endl;
@@ -233,9 +236,15 @@ int MeshMetadata::Validate(MPI_Comm comm, const MeshMetadataFlags &requiredFlags
         << " elements but should have " << validSize)
       err = true;
       }
-    if (this->BlockIds.size() != validSize)
+    // for AMR a local view of the block ids may accompany the global view of
+    // the block owners
+    unsigned long localSize = (!haveLocal ? this->NumBlocks :
+      (haveAllLocal ? this->NumBlocksLocal[rank] : this->NumBlocksLocal[0]));
+
+    if ((this->BlockIds.size() != validSize) &&
+      ((this->MeshType != SVTK_OVERLAPPING_AMR) || (this->BlockIds.size() != localSize)))
       {
-      SENSEI_ERROR("Metadata inconsistency. BlockIds has " << this->BlockOwner.size()
+      SENSEI_ERROR("Metadata inconsistency. BlockIds has " << this->BlockIds.size()
         << " elements but should have " << validSize)
       err = true;
       }
@@ -276,6 +285,12 @@ int MeshMetadata::Validate(MPI_Comm comm, const MeshMetadataFlags &requiredFlags
         << " elements but should have " << validSize)
       err = true;
       }
+    if (this->BlockOwnedExtents.size() && (this->BlockOwnedExtents.size() != validSize))
+      {
+      SENSEI_ERROR("Metadata inconsistency. BlockOwnedExtents has " << this->BlockOwnedExtents.size()
+        << " elements but should have " << validSize)
+      err = true;
+      }
     if ((this->MeshType == SVTK_OVERLAPPING_AMR) && (this->BlockLevel.size() != validSize))
       {
       SENSEI_ERROR("Metadata inconsistency. BlockLevel has " << this->BlockLevel.size()
@@ -397,6 +412,7 @@ int MeshMetadata::GlobalizeView(MPI_Comm comm)
     MPIUtils::GlobalViewV(comm, this->BlockNumCells);
     MPIUtils::GlobalViewV(comm, this->BlockCellArraySize);
     MPIUtils::GlobalViewV(comm, this->BlockExtents);
+    MPIUtils::GlobalViewV(comm, this->BlockOwnedExtents);
     MPIUtils::GlobalViewV(comm, this->BlockBounds);
     MPIUtils::GlobalViewV(comm, this->BlockArrayRange);
     MPIUtils::GlobalViewV(comm, this->BlockLevel);
@@ -437,6 +453,7 @@ int MeshMetadata::ClearBlockInfo()
 
   this->BlockBounds.clear();
   this->BlockExtents.clear();
+  this->BlockOwnedExtents.clear();
 
   this->BlockNumPoints.clear();
   this->BlockNumCells.clear();
@@ -493,6 +510,9 @@ int MeshMetadata::CopyBlockInfo(const MeshMetadataPtr &other, int i)
     STLUtils::ReduceRange(obi, this->Extent);
     }
 
+  if (other->BlockOwnedExtents.size())
+    this->BlockOwnedExtents.push_back(other->BlockOwnedExtents[i]);
+
   if (other->BlockArrayRange.size())
     {
     const std::vector<std::array<double,2>> &obari = other->BlockArrayRange[i];
@@ -49,7 +49,12 @@ public:
   bool BlockSizeSet() const { return Flags & SIZE; }
 
   /** set, clear, or check flag to generate block extent arrays
-   * MeshMetadata.BlockExtents
+   * MeshMetadata.BlockExtents and MeshMetadata.BlockOwnedExtents. All extents
+   * in the metadata are cell extents, that is the index of the first and
+   * last cell along each axis, including ghost cells. The point extent of a
+   * logically Cartesian block, as returned by svtkImageData::GetExtent, is
+   * converted with SVTKUtils::GetCellExtent. An axis with a single point
+   * has a single layer of cells.
    */
   void SetBlockExtents(){ Flags |= EXTENTS; }
   /// @copydoc SetBlockExtents
@@ -215,7 +220,9 @@ struct SENSEI_EXPORT MeshMetadata
   std::vector<long> BlockCellArraySize;    ///< cell array size for each block (unstructured, optional)
 
                                                  // note: for AMR BlockExtents and BlockBounds are always global
-  std::vector<std::array<int,6>> BlockExtents;   //< index space extent of each block [i0,i1, j0,j1, k0,k1] (Cartesian, AMR, optional)
+  std::vector<std::array<int,6>> BlockExtents;   //< cell extent of each block [i0,i1, j0,j1, k0,k1] including ghost cells (Cartesian, AMR, optional)
+  std::vector<std::array<int,6>> BlockOwnedExtents; //< cell extent owned by each block, excluding ghost cells. an empty extent
+                                                    // means the owned cells are not a box and the ghost array is needed (Cartesian, optional)
   std::vector<std::array<double,6>> BlockBounds; //< bounds of each block [x0,x1, y0,y1, z0,z1] (all, optional)
 
   std::vector<std::vector<std::array<double,2>>> BlockArrayRange; //< min max of each array on each block.
@@ -240,7 +247,7 @@ protected:
     NumArrays(0), NumGhostCells(0), NumGhostNodes(0), NumLevels(0),
     StaticMesh(0), ArrayName(), ArrayCentering(), ArrayType(),
     ArrayRange(),BlockOwner(), BlockIds(), BlockNumPoints(), BlockNumCells(),
-    BlockCellArraySize(), BlockExtents(), BlockBounds(), BlockArrayRange(),
+    BlockCellArraySize(), BlockExtents(), BlockOwnedExtents(), BlockBounds(), BlockArrayRange(),
     RefRatio(), BlocksPerLevel(), BlockLevel(), PeriodicBoundary(), Flags()
     {}
 };
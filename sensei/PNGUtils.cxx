@@ -0,0 +1,155 @@
+#include "PNGUtils.h"
+#include "Error.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <errno.h>
+#include <vector>
+
+namespace
+{
+// **************************************************************************
+/// the CRC-32 used in PNG chunks
+uint32_t Crc32(uint32_t crc, const unsigned char *buf, size_t n)
+{
+  static uint32_t table[256] = {0};
+  static bool initialized = false;
+  if (!initialized)
+    {
+    for (uint32_t i = 0; i < 256; ++i)
+      {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k)
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+      }
+    initialized = true;
+    }
+
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i)
+    crc = table[(crc ^ buf[i]) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
+
+// **************************************************************************
+/// the Adler-32 checksum used in zlib streams
+uint32_t Adler32(uint32_t adler, const unsigned char *buf, size_t n)
+{
+  uint32_t a = adler & 0xffff;
+  uint32_t b = adler >> 16;
+  for (size_t i = 0; i < n; ++i)
+    {
+    a = (a + buf[i]) % 65521;
+    b = (b + a) % 65521;
+    }
+  return (b << 16) | a;
+}
+
+// **************************************************************************
+void PutU32(std::vector<unsigned char> &buf, uint32_t v)
+{
+  buf.push_back(v >> 24);
+  buf.push_back((v >> 16) & 0xff);
+  buf.push_back((v >> 8) & 0xff);
+  buf.push_back(v & 0xff);
+}
+
+// **************************************************************************
+/// write a chunk, the length, the type, the data and its CRC
+int WriteChunk(FILE *fh, const char *type, const std::vector<unsigned char> &data)
+{
+  std::vector<unsigned char> buf;
+  buf.reserve(data.size() + 12);
+
+  PutU32(buf, data.size());
+  buf.insert(buf.end(), type, type + 4);
+  buf.insert(buf.end(), data.begin(), data.end());
+  PutU32(buf, Crc32(0, buf.data() + 4, data.size() + 4));
+
+  return fwrite(buf.data(), 1, buf.size(), fh) == buf.size() ? 0 : -1;
+}
+}
+
+namespace sensei
+{
+namespace PNGUtils
+{
+
+//----------------------------------------------------------------------------
+int WriteRGBA(const std::string &fileName, int width, int height,
+  const unsigned char *rgba)
+{
+  if ((width < 1) || (height < 1))
+    {
+    SENSEI_ERROR("Invalid image size " << width << "x" << height)
+    return -1;
+    }
+
+  // the header. 8 bits per channel, RGBA, no interlacing
+  std::vector<unsigned char> ihdr;
+  PutU32(ihdr, width);
+  PutU32(ihdr, height);
+  unsigned char ihdrTail[] = {8, 6, 0, 0, 0};
+  ihdr.insert(ihdr.end(), ihdrTail, ihdrTail + 5);
+
+  // the scan lines, each with a leading filter type of 0
+  size_t rowBytes = 4*size_t(width);
+  std::vector<unsigned char> raw((rowBytes + 1)*height);
+  for (int j = 0; j < height; ++j)
+    {
+    unsigned char *row = raw.data() + j*(rowBytes + 1);
+    row[0] = 0;
+    memcpy(row + 1, rgba + j*rowBytes, rowBytes);
+    }
+
+  // a zlib stream of uncompressed deflate blocks of at most 65535 bytes
+  std::vector<unsigned char> idat;
+  idat.reserve(raw.size() + 6 + 5*(raw.size()/65535 + 1));
+  idat.push_back(0x78);
+  idat.push_back(0x01);
+
+  size_t pos = 0;
+  do
+    {
+    size_t n = std::min<size_t>(65535, raw.size() - pos);
+    bool last = (pos + n) == raw.size();
+    idat.push_back(last ? 1 : 0);
+    idat.push_back(n & 0xff);
+    idat.push_back(n >> 8);
+    idat.push_back(~n & 0xff);
+    idat.push_back((~n >> 8) & 0xff);
+    idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + n);
+    pos += n;
+    }
+  while (pos < raw.size());
+
+  PutU32(idat, Adler32(1, raw.data(), raw.size()));
+
+  FILE *fh = fopen(fileName.c_str(), "wb");
+  if (!fh)
+    {
+    const char *estr = strerror(errno);
+    SENSEI_ERROR("Failed to open \"" << fileName << "\" " << estr)
+    return -1;
+    }
+
+  const unsigned char sig[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+  if ((fwrite(sig, 1, 8, fh) != 8) || WriteChunk(fh, "IHDR", ihdr) ||
+    WriteChunk(fh, "IDAT", idat) ||
+    WriteChunk(fh, "IEND", std::vector<unsigned char>()))
+    {
+    SENSEI_ERROR("Failed to write \"" << fileName << "\"")
+    fclose(fh);
+    return -1;
+    }
+
+  fclose(fh);
+  return 0;
+}
+
+}
+}
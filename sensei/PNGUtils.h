@@ -0,0 +1,30 @@
+#ifndef sensei_PNGUtils_h
+#define sensei_PNGUtils_h
+
+/// @file
+
+#include "senseiConfig.h"
+
+#include <string>
+
+namespace sensei
+{
+
+/** A collection of functions for writing PNG images without external
+ * dependencies. The image data is stored uncompressed, which is fast and
+ * simple at the cost of larger files.
+ */
+namespace PNGUtils
+{
+
+/** Write an 8 bit per channel RGBA image. The pixels are stored row by row
+ * starting at the top of the image. Returns zero if successful.
+ */
+SENSEI_EXPORT
+int WriteRGBA(const std::string &fileName, int width, int height,
+  const unsigned char *rgba);
+
+}
+}
+
+#endif
@@ -0,0 +1,965 @@
+#include "ParticleAdvection.h"
+#include "DataAdaptor.h"
+#include "SVTKDataAdaptor.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCellArray.h>
+#include <svtkCellData.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkDoubleArray.h>
+#include <svtkFunctionSet.h>
+#include <svtkIdTypeArray.h>
+#include <svtkImageData.h>
+#include <svtkLongArray.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkObjectFactory.h>
+#include <svtkPointData.h>
+#include <svtkPoints.h>
+#include <svtkPolyData.h>
+#include <svtkRectilinearGrid.h>
+#include <svtkRungeKutta2.h>
+#include <svtkRungeKutta4.h>
+#include <svtkRungeKutta45.h>
+#include <svtkSmartPointer.h>
+
+#include <sdiy/master.hpp>
+#include <sdiy/assigner.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// the state of a particle after it has been traced on a rank
+enum {PARTICLE_DONE, PARTICLE_LEAVING, PARTICLE_PAUSED};
+
+// **************************************************************************
+/// a block of an image or rectilinear mesh and the vector field on it
+struct Block
+{
+  Block() : CellData(false), Bounds{{0.0, 0.0, 0.0, 0.0, 0.0, 0.0}} {}
+
+  bool Contains(const double *p) const
+  {
+    return (p[0] >= this->Bounds[0]) && (p[0] <= this->Bounds[1]) &&
+      (p[1] >= this->Bounds[2]) && (p[1] <= this->Bounds[3]) &&
+      (p[2] >= this->Bounds[4]) && (p[2] <= this->Bounds[5]);
+  }
+
+  std::array<std::vector<double>,3> X;
+  std::vector<double> Values;
+  bool CellData;
+  std::array<double,6> Bounds;
+};
+
+// **************************************************************************
+/** locate the interval of the coordinate array containing p. The result is
+ * clamped to the array so that points on the boundary are handled.
+ */
+void Locate(const std::vector<double> &x, double p, long &i, double &f)
+{
+  long n = x.size();
+  if (n < 2)
+    {
+    i = 0;
+    f = 0.0;
+    return;
+    }
+
+  i = std::upper_bound(x.begin(), x.end(), p) - x.begin() - 1;
+  i = std::max(0l, std::min(i, n - 2));
+
+  f = (p - x[i])/(x[i+1] - x[i]);
+  f = std::max(0.0, std::min(f, 1.0));
+}
+
+// **************************************************************************
+/** evaluate the vector field at a point. point data is interpolated
+ * trilinearly, cell data takes the value of the cell containing the point.
+ */
+void Evaluate(const Block &b, const double *p, double *v)
+{
+  long i[3];
+  double f[3];
+  for (int d = 0; d < 3; ++d)
+    Locate(b.X[d], p[d], i[d], f[d]);
+
+  long nx = b.X[0].size();
+  long ny = b.X[1].size();
+  long nz = b.X[2].size();
+
+  if (b.CellData)
+    {
+    long cnx = std::max(nx - 1, 1l);
+    long cny = std::max(ny - 1, 1l);
+    const double *c = b.Values.data() + 3*((i[2]*cny + i[1])*cnx + i[0]);
+    v[0] = c[0];
+    v[1] = c[1];
+    v[2] = c[2];
+    return;
+    }
+
+  long di = nx > 1 ? 3 : 0;
+  long dj = ny > 1 ? 3*nx : 0;
+  long dk = nz > 1 ? 3*nx*ny : 0;
+
+  // the trilinear weights of the 8 corners
+  double w[8];
+  for (int c = 0; c < 8; ++c)
+    {
+    w[c] = ((c & 1) ? f[0] : 1.0 - f[0]) * ((c & 2) ? f[1] : 1.0 - f[1]) *
+      ((c & 4) ? f[2] : 1.0 - f[2]);
+    }
+
+  const double *v0 = b.Values.data() + 3*((i[2]*ny + i[1])*nx + i[0]);
+  const long offs[8] = {0, di, dj, dj + di, dk, dk + di, dk + dj, dk + dj + di};
+
+  for (int d = 0; d < 3; ++d)
+    {
+    double s = 0.0;
+    for (int c = 0; c < 8; ++c)
+      s += w[c]*v0[offs[c] + d];
+    v[d] = s;
+    }
+}
+
+// **************************************************************************
+/** find the block containing the point, checking the hint first. returns
+ * -1 if no block contains the point.
+ */
+int FindBlock(const std::vector<Block> &blocks, const double *p, int hint)
+{
+  if ((hint >= 0) && blocks[hint].Contains(p))
+    return hint;
+
+  int nBlocks = blocks.size();
+  for (int i = 0; i < nBlocks; ++i)
+    {
+    if (blocks[i].Contains(p))
+      return i;
+    }
+
+  return -1;
+}
+
+// **************************************************************************
+/** the vector field on a rank's blocks as seen by the SVTK integrators. The
+ * independent variables are x, y, z, and t. Points outside of the rank's
+ * blocks are reported as out of the domain.
+ */
+class VelocityField : public svtkFunctionSet
+{
+public:
+  static VelocityField *New();
+  svtkTypeMacro(VelocityField, svtkFunctionSet);
+
+  void SetBlocks(const std::vector<Block> *blocks) { this->Blocks = blocks; }
+
+  using svtkFunctionSet::FunctionValues;
+
+  int FunctionValues(double *x, double *f) override
+  {
+    this->Current = ::FindBlock(*this->Blocks, x, this->Current);
+    if (this->Current < 0)
+      return 0;
+
+    ::Evaluate((*this->Blocks)[this->Current], x, f);
+    return 1;
+  }
+
+  int Current;
+
+protected:
+  VelocityField() : Current(-1), Blocks(nullptr)
+  {
+    this->NumFuncs = 3;
+    this->NumIndepVars = 4;
+  }
+
+  ~VelocityField() override {}
+
+private:
+  VelocityField(const VelocityField&) = delete;
+  void operator=(const VelocityField&) = delete;
+
+  const std::vector<Block> *Blocks;
+};
+
+svtkStandardNewMacro(VelocityField);
+
+// **************************************************************************
+/// the pieces of the paths traced by a thread
+struct Paths
+{
+  void Append(const Paths &other)
+  {
+    long pointOffset = this->Time.size();
+    for (long off : other.Offsets)
+      this->Offsets.push_back(off + pointOffset);
+    this->Points.insert(this->Points.end(), other.Points.begin(), other.Points.end());
+    this->Time.insert(this->Time.end(), other.Time.begin(), other.Time.end());
+    this->SeedIds.insert(this->SeedIds.end(), other.SeedIds.begin(), other.SeedIds.end());
+  }
+
+  std::vector<double> Points;
+  std::vector<double> Time;
+  std::vector<long> Offsets; // the first point of each piece
+  std::vector<long> SeedIds;
+};
+
+// **************************************************************************
+/// the parameters of the integration
+struct TraceParams
+{
+  double StepSize;
+  long MaxSteps;
+  double TerminalSpeed;
+  double EndTime;
+};
+
+// **************************************************************************
+/** trace particles [i0, i1) until each is terminated, leaves the blocks of
+ * this rank, or reaches the end time. The pieces of the paths are appended
+ * to the output and the state of each particle is returned.
+ */
+void Trace(const std::vector<Block> &blocks, svtkInitialValueProblemSolver *solver,
+  VelocityField *field, const TraceParams &params,
+  sensei::ParticleAdvection::Particles &p, long i0, long i1,
+  std::vector<int> &state, Paths &out)
+{
+  double tol = 1e-12*std::max(1.0, std::abs(params.EndTime));
+
+  for (long i = i0; i < i1; ++i)
+    {
+    double x[3] = {p.X[i], p.Y[i], p.Z[i]};
+    double t = p.T[i];
+    long steps = p.Steps[i];
+
+    int b = ::FindBlock(blocks, x, -1);
+    if (b < 0)
+      {
+      state[i] = PARTICLE_LEAVING;
+      continue;
+      }
+
+    long first = out.Time.size();
+    out.Points.insert(out.Points.end(), x, x + 3);
+    out.Time.push_back(t);
+
+    while (1)
+      {
+      if (steps >= params.MaxSteps)
+        {
+        state[i] = PARTICLE_DONE;
+        break;
+        }
+
+      if (params.EndTime - t <= tol)
+        {
+        state[i] = PARTICLE_PAUSED;
+        break;
+        }
+
+      double v[3];
+      ::Evaluate(blocks[b], x, v);
+
+      double speed = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+      if (speed < params.TerminalSpeed)
+        {
+        state[i] = PARTICLE_DONE;
+        break;
+        }
+
+      double h = std::min(params.StepSize, params.EndTime - t);
+      double xn[3];
+      double err = 0.0;
+
+      field->Current = b;
+      int ierr = solver->ComputeNextStep(x, v, xn, t, h, 0.0, err);
+      if (ierr == svtkInitialValueProblemSolver::OUT_OF_DOMAIN)
+        {
+        // a stage of the step left the blocks of this rank, take an Euler
+        // step out of the block instead
+        for (int d = 0; d < 3; ++d)
+          xn[d] = x[d] + h*v[d];
+        }
+      else if (ierr)
+        {
+        state[i] = PARTICLE_DONE;
+        break;
+        }
+
+      std::copy(xn, xn + 3, x);
+      t += h;
+      steps += 1;
+
+      out.Points.insert(out.Points.end(), x, x + 3);
+      out.Time.push_back(t);
+
+      b = ::FindBlock(blocks, x, b);
+      if (b < 0)
+        {
+        state[i] = PARTICLE_LEAVING;
+        break;
+        }
+      }
+
+    // keep pieces with at least one segment
+    if (long(out.Time.size()) - first > 1)
+      {
+      out.Offsets.push_back(first);
+      out.SeedIds.push_back(p.Id[i]);
+      }
+    else
+      {
+      out.Points.resize(3*first);
+      out.Time.resize(first);
+      }
+
+    p.X[i] = x[0];
+    p.Y[i] = x[1];
+    p.Z[i] = x[2];
+    p.T[i] = t;
+    p.Steps[i] = steps;
+    }
+}
+
+// **************************************************************************
+/// the block passed to sdiy, particles are exchanged between ranks
+struct ExchangeBlock
+{
+  static void *create() { return new ExchangeBlock; }
+  static void destroy(void *b) { delete static_cast<ExchangeBlock*>(b); }
+};
+
+// **************************************************************************
+void ToDouble(svtkDataArray *da, std::vector<double> &out)
+{
+  long nTups = da->GetNumberOfTuples();
+  int nComps = da->GetNumberOfComponents();
+  long nVals = nTups*nComps;
+
+  out.resize(nVals);
+
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+      if (aosDa)
+        {
+        const SVTK_TT *pDa = aosDa->GetPointer(0);
+        std::copy(pDa, pDa + nVals, out.begin());
+        }
+      else
+        {
+        for (long i = 0; i < nTups; ++i)
+          for (int j = 0; j < nComps; ++j)
+            out[i*nComps + j] = da->GetComponent(i, j);
+        }
+    );
+    }
+}
+
+// **************************************************************************
+svtkPolyData *NewPolyData(const Paths &paths)
+{
+  long nPts = paths.Time.size();
+  long nLines = paths.Offsets.size();
+
+  svtkDoubleArray *coords = svtkDoubleArray::New();
+  coords->SetNumberOfComponents(3);
+  coords->SetNumberOfTuples(nPts);
+  std::copy(paths.Points.begin(), paths.Points.end(), coords->GetPointer(0));
+
+  svtkPoints *pts = svtkPoints::New();
+  pts->SetData(coords);
+  coords->Delete();
+
+  svtkIdTypeArray *conn = svtkIdTypeArray::New();
+  conn->SetNumberOfTuples(nPts);
+  for (long i = 0; i < nPts; ++i)
+    conn->SetValue(i, i);
+
+  svtkIdTypeArray *offs = svtkIdTypeArray::New();
+  offs->SetNumberOfTuples(nLines + 1);
+  for (long i = 0; i < nLines; ++i)
+    offs->SetValue(i, paths.Offsets[i]);
+  offs->SetValue(nLines, nPts);
+
+  svtkCellArray *lines = svtkCellArray::New();
+  lines->SetData(offs, conn);
+  offs->Delete();
+  conn->Delete();
+
+  svtkDoubleArray *time = svtkDoubleArray::New();
+  time->SetName("time");
+  time->SetNumberOfTuples(nPts);
+  std::copy(paths.Time.begin(), paths.Time.end(), time->GetPointer(0));
+
+  svtkLongArray *ids = svtkLongArray::New();
+  ids->SetName("seed_id");
+  ids->SetNumberOfTuples(nLines);
+  std::copy(paths.SeedIds.begin(), paths.SeedIds.end(), ids->GetPointer(0));
+
+  svtkPolyData *pd = svtkPolyData::New();
+  pd->SetPoints(pts);
+  pd->SetLines(lines);
+  pd->GetPointData()->AddArray(time);
+  pd->GetCellData()->AddArray(ids);
+
+  pts->Delete();
+  lines->Delete();
+  time->Delete();
+  ids->Delete();
+
+  return pd;
+}
+}
+
+namespace sensei
+{
+
+//----------------------------------------------------------------------------
+void ParticleAdvection::Particles::Append(const Particles &other, long i)
+{
+  this->X.push_back(other.X[i]);
+  this->Y.push_back(other.Y[i]);
+  this->Z.push_back(other.Z[i]);
+  this->T.push_back(other.T[i]);
+  this->Id.push_back(other.Id[i]);
+  this->Steps.push_back(other.Steps[i]);
+}
+
+//----------------------------------------------------------------------------
+void ParticleAdvection::Particles::Clear()
+{
+  this->X.clear();
+  this->Y.clear();
+  this->Z.clear();
+  this->T.clear();
+  this->Id.clear();
+  this->Steps.clear();
+}
+
+//----------------------------------------------------------------------------
+senseiNewMacro(ParticleAdvection);
+
+//----------------------------------------------------------------------------
+ParticleAdvection::ParticleAdvection() : OutputMeshName("streamlines"),
+  Association(svtkDataObject::POINT), Integrator(INTEGRATOR_RK4),
+  Mode(MODE_STREAMLINE), StepSize(0.01), MaximumNumberOfSteps(1000),
+  TerminalSpeed(1e-12), NumberOfThreads(1), Seeded(false)
+{
+}
+
+//----------------------------------------------------------------------------
+ParticleAdvection::~ParticleAdvection()
+{
+}
+
+//----------------------------------------------------------------------------
+int ParticleAdvection::GetIntegrator(const std::string &name, int &integrator)
+{
+  if (name == "rk2")
+    {
+    integrator = INTEGRATOR_RK2;
+    }
+  else if (name == "rk4")
+    {
+    integrator = INTEGRATOR_RK4;
+    }
+  else if (name == "rk45")
+    {
+    integrator = INTEGRATOR_RK45;
+    }
+  else
+    {
+    SENSEI_ERROR("Invalid integrator \"" << name << "\". Use one of rk2,"
+      " rk4, or rk45")
+    return -1;
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleAdvection::GetMode(const std::string &name, int &mode)
+{
+  if (name == "streamline")
+    {
+    mode = MODE_STREAMLINE;
+    }
+  else if (name == "pathline")
+    {
+    mode = MODE_PATHLINE;
+    }
+  else
+    {
+    SENSEI_ERROR("Invalid mode \"" << name << "\". Use one of streamline"
+      " or pathline")
+    return -1;
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleAdvection::SetAssociation(int association)
+{
+  if ((association != svtkDataObject::POINT) &&
+    (association != svtkDataObject::CELL))
+    {
+    SENSEI_ERROR("Invalid association " << association
+      << ". Only point and cell data are supported")
+    return -1;
+    }
+
+  this->Association = association;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleAdvection::SetIntegrator(int integrator)
+{
+  if ((integrator < INTEGRATOR_RK2) || (integrator > INTEGRATOR_RK45))
+    {
+    SENSEI_ERROR("Invalid integrator " << integrator)
+    return -1;
+    }
+
+  this->Integrator = integrator;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleAdvection::SetMode(int mode)
+{
+  if ((mode != MODE_STREAMLINE) && (mode != MODE_PATHLINE))
+    {
+    SENSEI_ERROR("Invalid mode " << mode)
+    return -1;
+    }
+
+  this->Mode = mode;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleAdvection::SetSeeds(const std::vector<double> &seeds)
+{
+  if (seeds.size() % 3)
+    {
+    SENSEI_ERROR("Seeds must be given as 3 coordinates per seed")
+    return -1;
+    }
+
+  this->Seeds = seeds;
+  this->Seeded = false;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleAdvection::SetSeeds(const std::array<double,6> &bounds,
+  const std::array<int,3> &res)
+{
+  if ((res[0] < 1) || (res[1] < 1) || (res[2] < 1))
+    {
+    SENSEI_ERROR("Invalid seed resolution " << res[0] << ", " << res[1]
+      << ", " << res[2])
+    return -1;
+    }
+
+  std::vector<double> seeds;
+  for (int k = 0; k < res[2]; ++k)
+    {
+    for (int j = 0; j < res[1]; ++j)
+      {
+      for (int i = 0; i < res[0]; ++i)
+        {
+        int idx[3] = {i, j, k};
+        for (int d = 0; d < 3; ++d)
+          {
+          double u = res[d] > 1 ? double(idx[d])/(res[d] - 1) : 0.5;
+          seeds.push_back(bounds[2*d] + u*(bounds[2*d+1] - bounds[2*d]));
+          }
+        }
+      }
+    }
+
+  return this->SetSeeds(seeds);
+}
+
+//----------------------------------------------------------------------------
+int ParticleAdvection::SetStepSize(double stepSize)
+{
+  if (!(stepSize > 0.0))
+    {
+    SENSEI_ERROR("Invalid step size " << stepSize)
+    return -1;
+    }
+
+  this->StepSize = stepSize;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+long ParticleAdvection::GetNumberOfParticles()
+{
+  return this->Active.Size();
+}
+
+//----------------------------------------------------------------------------
+bool ParticleAdvection::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("ParticleAdvection::Execute");
+
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  // get the local blocks
+  svtkDataObject *dobj = nullptr;
+  if (dataIn->GetMesh(this->MeshName, false, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  std::vector<Block> blocks;
+  if (dobj)
+    {
+    if (dataIn->AddArray(dobj, this->MeshName, this->Association, this->ArrayName))
+      {
+      SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add "
+        << SVTKUtils::GetAttributesName(this->Association)
+        << " data array \"" << this->ArrayName << "\"")
+      dobj->Delete();
+      return false;
+      }
+
+    // the composite wrapper takes ownership
+    svtkCompositeDataSetPtr mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+
+    svtkSmartPointer<svtkCompositeDataIterator> iter;
+    iter.TakeReference(mesh->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+      svtkDataSet *ds = dynamic_cast<svtkDataSet*>(iter->GetCurrentDataObject());
+
+      Block b;
+      if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+        {
+        int ext[6];
+        double x0[3];
+        double dx[3];
+        im->GetExtent(ext);
+        im->GetOrigin(x0);
+        im->GetSpacing(dx);
+
+        for (int d = 0; d < 3; ++d)
+          {
+          for (int i = ext[2*d]; i <= ext[2*d+1]; ++i)
+            b.X[d].push_back(x0[d] + i*dx[d]);
+          }
+        }
+      else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+        {
+        ::ToDouble(rg->GetXCoordinates(), b.X[0]);
+        ::ToDouble(rg->GetYCoordinates(), b.X[1]);
+        ::ToDouble(rg->GetZCoordinates(), b.X[2]);
+        }
+      else
+        {
+        SENSEI_ERROR("Block " << iter->GetCurrentFlatIndex() << " of mesh \""
+          << this->MeshName << "\" is a " << (ds ? ds->GetClassName() : "nullptr")
+          << ". Only image and rectilinear meshes are supported")
+        return false;
+        }
+
+      if (b.X[0].empty() || b.X[1].empty() || b.X[2].empty())
+        continue;
+
+      svtkDataArray *da = ds->GetAttributes(this->Association)->GetArray(
+        this->ArrayName.c_str());
+      if (!da || (da->GetNumberOfComponents() != 3))
+        {
+        SENSEI_ERROR("Block " << iter->GetCurrentFlatIndex() << " of mesh \""
+          << this->MeshName << "\" has no 3 component array named \""
+          << this->ArrayName << "\"")
+        return false;
+        }
+
+      ::ToDouble(da, b.Values);
+      b.CellData = this->Association == svtkDataObject::CELL;
+
+      for (int d = 0; d < 3; ++d)
+        {
+        b.Bounds[2*d] = b.X[d].front();
+        b.Bounds[2*d+1] = b.X[d].back();
+        }
+
+      blocks.push_back(std::move(b));
+      }
+    }
+
+  // share the bounds of all blocks. particles leaving a rank are sent to
+  // the owner of the first block that contains them
+  int nBlocks = blocks.size();
+  std::vector<int> blockCounts(nRanks);
+  MPI_Allgather(&nBlocks, 1, MPI_INT, blockCounts.data(), 1, MPI_INT, comm);
+
+  std::vector<int> bdsCounts(nRanks);
+  std::vector<int> bdsOffsets(nRanks + 1, 0);
+  std::vector<int> blockOwner;
+  for (int r = 0; r < nRanks; ++r)
+    {
+    bdsCounts[r] = 6*blockCounts[r];
+    bdsOffsets[r + 1] = bdsOffsets[r] + bdsCounts[r];
+    blockOwner.insert(blockOwner.end(), blockCounts[r], r);
+    }
+
+  std::vector<double> localBds(6*nBlocks);
+  for (int i = 0; i < nBlocks; ++i)
+    std::copy(blocks[i].Bounds.begin(), blocks[i].Bounds.end(), localBds.begin() + 6*i);
+
+  int nGlobalBlocks = blockOwner.size();
+  std::vector<Block> globalBlocks(nGlobalBlocks);
+  std::vector<double> globalBds(6*nGlobalBlocks);
+  MPI_Allgatherv(localBds.data(), 6*nBlocks, MPI_DOUBLE, globalBds.data(),
+    bdsCounts.data(), bdsOffsets.data(), MPI_DOUBLE, comm);
+
+  for (int i = 0; i < nGlobalBlocks; ++i)
+    std::copy(globalBds.begin() + 6*i, globalBds.begin() + 6*(i + 1),
+      globalBlocks[i].Bounds.begin());
+
+  // the particles to trace. in streamline mode the seeds are released each
+  // time step, in pathline mode only the first
+  double time = dataIn->GetDataTime();
+
+  Particles particles;
+  if ((this->Mode == MODE_STREAMLINE) || !this->Seeded)
+    {
+    long nSeeds = this->Seeds.size()/3;
+    for (long i = 0; i < nSeeds; ++i)
+      {
+      const double *x = this->Seeds.data() + 3*i;
+
+      int gb = ::FindBlock(globalBlocks, x, -1);
+      if ((gb < 0) || (blockOwner[gb] != rank))
+        continue;
+
+      particles.X.push_back(x[0]);
+      particles.Y.push_back(x[1]);
+      particles.Z.push_back(x[2]);
+      particles.T.push_back(this->Mode == MODE_STREAMLINE ? 0.0 : time);
+      particles.Id.push_back(i);
+      particles.Steps.push_back(0);
+      }
+
+    this->Seeded = true;
+    }
+
+  if (this->Mode == MODE_PATHLINE)
+    {
+    for (long i = 0; i < this->Active.Size(); ++i)
+      particles.Append(this->Active, i);
+    this->Active.Clear();
+    }
+
+  TraceParams params;
+  params.StepSize = this->StepSize;
+  params.MaxSteps = this->MaximumNumberOfSteps;
+  params.TerminalSpeed = this->TerminalSpeed;
+  params.EndTime = this->Mode == MODE_STREAMLINE ?
+    std::numeric_limits<double>::max() : time;
+
+  // an integrator per thread, the SVTK integrators are not thread safe
+  int nThreads = std::max(1, this->NumberOfThreads);
+
+  std::vector<svtkSmartPointer<svtkInitialValueProblemSolver>> solvers(nThreads);
+  std::vector<svtkSmartPointer<VelocityField>> fields(nThreads);
+  for (int t = 0; t < nThreads; ++t)
+    {
+    if (this->Integrator == INTEGRATOR_RK2)
+      solvers[t] = svtkSmartPointer<svtkRungeKutta2>::New();
+    else if (this->Integrator == INTEGRATOR_RK45)
+      solvers[t] = svtkSmartPointer<svtkRungeKutta45>::New();
+    else
+      solvers[t] = svtkSmartPointer<svtkRungeKutta4>::New();
+
+    fields[t] = svtkSmartPointer<VelocityField>::New();
+    fields[t]->SetBlocks(&blocks);
+    solvers[t]->SetFunctionSet(fields[t]);
+    }
+
+  sdiy::Master master(comm, 1, -1, &ExchangeBlock::create,
+    &ExchangeBlock::destroy);
+
+  sdiy::ContiguousAssigner assigner(nRanks, nRanks);
+
+  master.add(rank, new ExchangeBlock, new sdiy::Link);
+
+  // trace in rounds until no particles remain. each round the local
+  // particles are traced and those leaving are sent to their new owners.
+  Paths paths;
+  long nRounds = 0;
+  while (1)
+    {
+    long nLocal = particles.Size();
+    std::vector<int> state(nLocal);
+    std::vector<Paths> threadPaths(nThreads);
+
+    {
+    TimeEvent<128> mark2("ParticleAdvection::Trace");
+
+    auto work = [&](int tid)
+    {
+      long nPer = nLocal / nThreads;
+      long nLarge = nLocal % nThreads;
+      long i0 = nPer*tid + std::min<long>(tid, nLarge);
+      long i1 = i0 + nPer + (tid < nLarge ? 1 : 0);
+
+      ::Trace(blocks, solvers[tid], fields[tid], params, particles,
+        i0, i1, state, threadPaths[tid]);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int i = 1; i < nThreads; ++i)
+      threads.emplace_back(work, i);
+
+    work(0);
+
+    for (int i = 0; i < nThreads - 1; ++i)
+      threads[i].join();
+    }
+
+    for (int t = 0; t < nThreads; ++t)
+      paths.Append(threadPaths[t]);
+
+    // sort the particles by what happens next
+    std::map<int, Particles> outgoing;
+    for (long i = 0; i < nLocal; ++i)
+      {
+      if (state[i] == PARTICLE_PAUSED)
+        {
+        this->Active.Append(particles, i);
+        }
+      else if (state[i] == PARTICLE_LEAVING)
+        {
+        double x[3] = {particles.X[i], particles.Y[i], particles.Z[i]};
+        int gb = ::FindBlock(globalBlocks, x, -1);
+        if ((gb >= 0) && (blockOwner[gb] != rank))
+          outgoing[blockOwner[gb]].Append(particles, i);
+        }
+      }
+
+    particles.Clear();
+
+    TimeEvent<128> mark2("ParticleAdvection::Exchange");
+
+    master.foreach([&](ExchangeBlock *, const sdiy::Master::ProxyWithLink &cp)
+      {
+      for (auto &og : outgoing)
+        {
+        sdiy::BlockID dest(og.first, assigner.rank(og.first));
+        const Particles &p = og.second;
+        cp.enqueue(dest, p.X);
+        cp.enqueue(dest, p.Y);
+        cp.enqueue(dest, p.Z);
+        cp.enqueue(dest, p.T);
+        cp.enqueue(dest, p.Id);
+        cp.enqueue(dest, p.Steps);
+        }
+      });
+
+    master.exchange(true);
+
+    master.foreach([&](ExchangeBlock *, const sdiy::Master::ProxyWithLink &cp)
+      {
+      std::vector<int> in;
+      cp.incoming(in);
+
+      for (int gid : in)
+        {
+        if (!cp.incoming(gid))
+          continue;
+
+        Particles p;
+        cp.dequeue(gid, p.X);
+        cp.dequeue(gid, p.Y);
+        cp.dequeue(gid, p.Z);
+        cp.dequeue(gid, p.T);
+        cp.dequeue(gid, p.Id);
+        cp.dequeue(gid, p.Steps);
+
+        for (long i = 0; i < p.Size(); ++i)
+          particles.Append(p, i);
+        }
+      });
+
+    // count the particles left to trace
+    long nActive = particles.Size();
+    long nGlobalActive = 0;
+    MPI_Allreduce(&nActive, &nGlobalActive, 1, MPI_LONG, MPI_SUM, comm);
+
+    ++nRounds;
+
+    if (nGlobalActive == 0)
+      break;
+    }
+
+  if (this->GetVerbose() && (rank == 0))
+    {
+    SENSEI_STATUS("ParticleAdvection traced " << this->Seeds.size()/3
+      << " seeds in " << nRounds << " rounds")
+    }
+
+  // pass the paths back as polydata with one block per rank
+  if (dataOut)
+    {
+    svtkPolyData *pd = ::NewPolyData(paths);
+
+    svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+    mb->SetNumberOfBlocks(nRanks);
+    mb->SetBlock(rank, pd);
+    pd->Delete();
+
+    SVTKDataAdaptor *out = SVTKDataAdaptor::New();
+    out->SetCommunicator(comm);
+    out->SetDataObject(this->OutputMeshName, mb);
+    out->SetDataTimeStep(dataIn->GetDataTimeStep());
+    out->SetDataTime(dataIn->GetDataTime());
+    mb->Delete();
+
+    *dataOut = out;
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleAdvection::Finalize()
+{
+  return 0;
+}
+
+}
@@ -0,0 +1,139 @@
+#ifndef sensei_ParticleAdvection_h
+#define sensei_ParticleAdvection_h
+
+#include "AnalysisAdaptor.h"
+
+#include <mpi.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/** Traces particles through a vector field on image and rectilinear meshes
+ * using the SVTK Runge-Kutta integrators. Point data is interpolated
+ * trilinearly, cell data is constant over each cell.
+ *
+ * In streamline mode the field is frozen at each time step and particles
+ * are released from the seeds and traced until they leave the mesh, slow
+ * below the terminal speed, or take the maximum number of steps. In
+ * pathline mode particles are released once, persist from one time step to
+ * the next, and each time step are advanced to the current simulation time.
+ *
+ * Particles are stored as a structure of arrays and each rank traces those
+ * in its blocks, a batch per thread. Particles leaving a rank's blocks are
+ * sent to the rank owning the block that they entered using sdiy. Tracing
+ * proceeds in rounds, with the number of particles left to trace counted
+ * globally after each round, until none remain.
+ *
+ * The path taken by each particle is returned through a DataAdaptor as a
+ * multiblock mesh with one svtkPolyData block per rank. Each polyline is the
+ * piece of a path traced by one rank during one time step and carries the
+ * id of the seed in a cell data array named "seed_id". The integration time
+ * at each point is stored in a point data array named "time".
+ */
+class SENSEI_EXPORT ParticleAdvection : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static ParticleAdvection *New();
+
+  senseiTypeMacro(ParticleAdvection, AnalysisAdaptor);
+
+  /// the supported integrators
+  enum {INTEGRATOR_RK2, INTEGRATOR_RK4, INTEGRATOR_RK45};
+
+  /// the supported modes
+  enum {MODE_STREAMLINE, MODE_PATHLINE};
+
+  /// convert an integrator name, rk2, rk4, or rk45 into an enum. returns 0 if successful
+  static int GetIntegrator(const std::string &name, int &integrator);
+
+  /// convert a mode name, streamline or pathline, into an enum. returns 0 if successful
+  static int GetMode(const std::string &name, int &mode);
+
+  /// set the name of the mesh and its 3 component vector array
+  void SetMeshName(const std::string &meshName) { this->MeshName = meshName; }
+  void SetArrayName(const std::string &arrayName) { this->ArrayName = arrayName; }
+
+  /// set svtkDataObject::POINT or svtkDataObject::CELL. the default is POINT
+  int SetAssociation(int association);
+
+  /// set the integrator. the default is INTEGRATOR_RK4
+  int SetIntegrator(int integrator);
+
+  /// set the mode. the default is MODE_STREAMLINE
+  int SetMode(int mode);
+
+  /// set the seeds, 3 coordinates per seed
+  int SetSeeds(const std::vector<double> &seeds);
+
+  /// place seeds on a regular lattice with the given number of seeds in each direction
+  int SetSeeds(const std::array<double,6> &bounds, const std::array<int,3> &res);
+
+  /// set the integration step size. the default is 0.01
+  int SetStepSize(double stepSize);
+
+  /// set the largest number of steps a particle takes. the default is 1000
+  void SetMaximumNumberOfSteps(long maxSteps) { this->MaximumNumberOfSteps = maxSteps; }
+
+  /// set the speed below which particles are terminated. the default is 1e-12
+  void SetTerminalSpeed(double speed) { this->TerminalSpeed = speed; }
+
+  /// set the name of the output mesh. the default is "streamlines"
+  void SetOutputMeshName(const std::string &name) { this->OutputMeshName = name; }
+
+  /// set the number of threads used to trace local particles. the default is 1.
+  void SetNumberOfThreads(int nThreads) { this->NumberOfThreads = nThreads; }
+
+  /// return the number of particles held by this rank in pathline mode
+  long GetNumberOfParticles();
+
+  /// trace the particles for this time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+  /// the particles held by a rank, stored as a structure of arrays
+  struct Particles
+  {
+    long Size() const { return this->Id.size(); }
+    void Append(const Particles &other, long i);
+    void Clear();
+
+    std::vector<double> X;   ///< the x coordinate
+    std::vector<double> Y;   ///< the y coordinate
+    std::vector<double> Z;   ///< the z coordinate
+    std::vector<double> T;   ///< the integration time
+    std::vector<long> Id;    ///< the id of the seed
+    std::vector<long> Steps; ///< the number of steps taken
+  };
+
+protected:
+  ParticleAdvection();
+  ~ParticleAdvection();
+
+  ParticleAdvection(const ParticleAdvection&) = delete;
+  void operator=(const ParticleAdvection&) = delete;
+
+private:
+  std::string MeshName;
+  std::string ArrayName;
+  std::string OutputMeshName;
+  int Association;
+  int Integrator;
+  int Mode;
+  double StepSize;
+  long MaximumNumberOfSteps;
+  double TerminalSpeed;
+  int NumberOfThreads;
+  std::vector<double> Seeds;
+  bool Seeded;
+  Particles Active;
+};
+
+}
+
+#endif
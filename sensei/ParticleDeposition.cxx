@@ -0,0 +1,801 @@
+#include "ParticleDeposition.h"
+#include "DataAdaptor.h"
+#include "SVTKDataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCellData.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkPointSet.h>
+#include <svtkPoints.h>
+#include <svtkSmartPointer.h>
+#include <svtkUnsignedCharArray.h>
+
+#include <sdiy/master.hpp>
+#include <sdiy/assigner.hpp>
+#include <sdiy/decomposition.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// **************************************************************************
+/** A patch of the grid covering the cells [i0,i1, j0,j1, k0,k1] (inclusive)
+ * holding a number of fields. The first field is the sum of the kernel
+ * weights, the others are the weighted sums of each component of each
+ * deposited array. The fields are stored one after another.
+ */
+struct Patch
+{
+  Patch() : Extent{{0,-1, 0,-1, 0,-1}}, NumFields(0) {}
+
+  void Initialize(const std::array<long,6> &ext, int nFields)
+  {
+    this->Extent = ext;
+    this->NumFields = nFields;
+    this->Data.assign(this->Size()*nFields, 0.0);
+  }
+
+  bool Empty() const
+  {
+    return (this->Extent[1] < this->Extent[0]) ||
+      (this->Extent[3] < this->Extent[2]) || (this->Extent[5] < this->Extent[4]);
+  }
+
+  long Size(int d) const { return this->Extent[2*d+1] - this->Extent[2*d] + 1; }
+
+  long Size() const
+  {
+    return this->Empty() ? 0 : this->Size(0)*this->Size(1)*this->Size(2);
+  }
+
+  long Index(long i, long j, long k) const
+  {
+    return ((k - this->Extent[4])*this->Size(1) + j - this->Extent[2])*
+      this->Size(0) + i - this->Extent[0];
+  }
+
+  // add the values of the other patch where the two overlap
+  void Add(const Patch &other)
+  {
+    std::array<long,6> ext;
+    if (Intersect(this->Extent, other.Extent, ext))
+      return;
+
+    long n = this->Size();
+    long on = other.Size();
+
+    for (int f = 0; f < this->NumFields; ++f)
+      {
+      double *dst = this->Data.data() + f*n;
+      const double *src = other.Data.data() + f*on;
+
+      for (long k = ext[4]; k <= ext[5]; ++k)
+        for (long j = ext[2]; j <= ext[3]; ++j)
+          for (long i = ext[0]; i <= ext[1]; ++i)
+            dst[this->Index(i,j,k)] += src[other.Index(i,j,k)];
+      }
+  }
+
+  // intersect two extents. returns non-zero if they do not overlap
+  static int Intersect(const std::array<long,6> &a,
+    const std::array<long,6> &b, std::array<long,6> &c)
+  {
+    for (int d = 0; d < 3; ++d)
+      {
+      c[2*d] = std::max(a[2*d], b[2*d]);
+      c[2*d+1] = std::min(a[2*d+1], b[2*d+1]);
+      if (c[2*d+1] < c[2*d])
+        return -1;
+      }
+    return 0;
+  }
+
+  std::array<long,6> Extent;
+  int NumFields;
+  std::vector<double> Data;
+};
+
+// **************************************************************************
+/// the block of the output grid owned by a rank
+struct DepositionBlock
+{
+  static void *create() { return new DepositionBlock; }
+  static void destroy(void *b) { delete static_cast<DepositionBlock*>(b); }
+
+  Patch Grid;
+};
+
+// **************************************************************************
+/** Get the cells a particle at index space coordinate u, where cell i is
+ * centered on u = i, contributes to and the weights. Returns the number of
+ * cells, which start at i0.
+ */
+int GetWeights(int kernel, double u, long &i0, double *w)
+{
+  switch (kernel)
+    {
+    case sensei::ParticleDeposition::KERNEL_NGP:
+      {
+      i0 = std::floor(u + 0.5);
+      w[0] = 1.0;
+      return 1;
+      }
+    case sensei::ParticleDeposition::KERNEL_CIC:
+      {
+      i0 = std::floor(u);
+      double f = u - i0;
+      w[0] = 1.0 - f;
+      w[1] = f;
+      return 2;
+      }
+    case sensei::ParticleDeposition::KERNEL_TSC:
+      {
+      long i = std::floor(u + 0.5);
+      double d = u - i;
+      i0 = i - 1;
+      w[0] = 0.5*(0.5 - d)*(0.5 - d);
+      w[1] = 0.75 - d*d;
+      w[2] = 0.5*(0.5 + d)*(0.5 + d);
+      return 3;
+      }
+    }
+  return 0;
+}
+
+// **************************************************************************
+/// the particles of one local block converted to double precision
+struct Particles
+{
+  Particles() : NumParticles(0), Ghosts(nullptr) {}
+
+  long NumParticles;
+  std::vector<double> Points;
+  std::vector<std::vector<double>> Arrays;
+  const unsigned char *Ghosts;
+};
+
+// **************************************************************************
+void ToDouble(svtkDataArray *da, std::vector<double> &out)
+{
+  long nTups = da->GetNumberOfTuples();
+  int nComps = da->GetNumberOfComponents();
+  long nVals = nTups*nComps;
+
+  out.resize(nVals);
+
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+      if (aosDa)
+        {
+        const SVTK_TT *pDa = aosDa->GetPointer(0);
+        std::copy(pDa, pDa + nVals, out.begin());
+        }
+      else
+        {
+        for (long i = 0; i < nTups; ++i)
+          for (int j = 0; j < nComps; ++j)
+            out[i*nComps + j] = da->GetComponent(i, j);
+        }
+    );
+    }
+}
+
+// **************************************************************************
+/// deposit particles [p0, p1) onto the patch
+void Deposit(int kernel, const std::array<int,3> &res,
+  const std::array<double,6> &bounds, const std::array<double,3> &dx,
+  const std::vector<int> &nComps, const Particles &parts, long p0, long p1,
+  Patch &patch)
+{
+  long n = patch.Size();
+  int nArrays = nComps.size();
+
+  for (long p = p0; p < p1; ++p)
+    {
+    if (parts.Ghosts && parts.Ghosts[p])
+      continue;
+
+    const double *x = parts.Points.data() + 3*p;
+
+    long i0[3] = {0, 0, 0};
+    double w[3][3] = {{1.0, 0.0, 0.0}, {1.0, 0.0, 0.0}, {1.0, 0.0, 0.0}};
+    int nw[3] = {1, 1, 1};
+
+    bool outside = false;
+    for (int d = 0; d < 3; ++d)
+      {
+      if ((x[d] < bounds[2*d]) || (x[d] > bounds[2*d+1]))
+        {
+        outside = true;
+        break;
+        }
+
+      // a single cell in this direction, the dimension is collapsed
+      if (res[d] > 1)
+        nw[d] = GetWeights(kernel, (x[d] - bounds[2*d])/dx[d] - 0.5, i0[d], w[d]);
+      }
+
+    if (outside)
+      continue;
+
+    // the weight falling outside of the grid, at the edges of the stencil
+    // or for a particle on the upper bound, is folded back into the
+    // boundary cells so that the mass is conserved
+    for (int kk = 0; kk < nw[2]; ++kk)
+      {
+      long k = std::max(0l, std::min(long(res[2]) - 1, i0[2] + kk));
+
+      for (int jj = 0; jj < nw[1]; ++jj)
+        {
+        long j = std::max(0l, std::min(long(res[1]) - 1, i0[1] + jj));
+
+        for (int ii = 0; ii < nw[0]; ++ii)
+          {
+          long i = std::max(0l, std::min(long(res[0]) - 1, i0[0] + ii));
+
+          double ww = w[0][ii]*w[1][jj]*w[2][kk];
+          long q = patch.Index(i, j, k);
+
+          double *data = patch.Data.data();
+          data[q] += ww;
+
+          long f = 1;
+          for (int a = 0; a < nArrays; ++a)
+            {
+            const double *vals = parts.Arrays[a].data() + nComps[a]*p;
+            for (int c = 0; c < nComps[a]; ++c, ++f)
+              data[f*n + q] += ww*vals[c];
+            }
+          }
+        }
+      }
+    }
+}
+}
+
+namespace sensei
+{
+
+//----------------------------------------------------------------------------
+senseiNewMacro(ParticleDeposition);
+
+//----------------------------------------------------------------------------
+ParticleDeposition::ParticleDeposition() : MeshName("particles"),
+  Arrays(), OutputMeshName("deposition"), Kernel(KERNEL_CIC),
+  NumberOfThreads(1), HaveBounds(false), Resolution{{64, 64, 64}},
+  Bounds{{0.0, 1.0, 0.0, 1.0, 0.0, 1.0}}
+{
+}
+
+//----------------------------------------------------------------------------
+ParticleDeposition::~ParticleDeposition()
+{
+}
+
+//----------------------------------------------------------------------------
+int ParticleDeposition::GetKernel(const std::string &name, int &kernel)
+{
+  if ((name == "ngp") || (name == "NGP"))
+    {
+    kernel = KERNEL_NGP;
+    }
+  else if ((name == "cic") || (name == "CIC"))
+    {
+    kernel = KERNEL_CIC;
+    }
+  else if ((name == "tsc") || (name == "TSC"))
+    {
+    kernel = KERNEL_TSC;
+    }
+  else
+    {
+    SENSEI_ERROR("Invalid kernel \"" << name << "\". Use one of ngp, cic, or tsc")
+    return -1;
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleDeposition::SetKernel(int kernel)
+{
+  if ((kernel != KERNEL_NGP) && (kernel != KERNEL_CIC) && (kernel != KERNEL_TSC))
+    {
+    SENSEI_ERROR("Invalid kernel " << kernel)
+    return -1;
+    }
+
+  this->Kernel = kernel;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleDeposition::SetResolution(const std::array<int,3> &res)
+{
+  if ((res[0] < 1) || (res[1] < 1) || (res[2] < 1))
+    {
+    SENSEI_ERROR("Invalid resolution " << res[0] << ", " << res[1]
+      << ", " << res[2])
+    return -1;
+    }
+
+  this->Resolution = res;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ParticleDeposition::SetBounds(const std::array<double,6> &bounds)
+{
+  for (int d = 0; d < 3; ++d)
+    {
+    if (!(bounds[2*d+1] > bounds[2*d]))
+      {
+      SENSEI_ERROR("Invalid bounds in direction " << d << " ["
+        << bounds[2*d] << ", " << bounds[2*d+1] << "]")
+      return -1;
+      }
+    }
+
+  this->Bounds = bounds;
+  this->HaveBounds = true;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool ParticleDeposition::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("ParticleDeposition::Execute");
+
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  MeshMetadataMap mdMap;
+  MeshMetadataPtr mmd;
+  if (mdMap.Initialize(dataIn) || mdMap.GetMeshMetadata(this->MeshName, mmd))
+    {
+    SENSEI_ERROR("Failed to get metadata for mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  // the number of components comes from the metadata so that ranks
+  // without data agree on the number of fields
+  int nArrays = this->Arrays.size();
+  std::vector<int> nComps(nArrays);
+  int nFields = 1;
+  for (int a = 0; a < nArrays; ++a)
+    {
+    auto it = std::find(mmd->ArrayName.begin(), mmd->ArrayName.end(),
+      this->Arrays[a]);
+
+    if (it == mmd->ArrayName.end())
+      {
+      SENSEI_ERROR("No array named \"" << this->Arrays[a] << "\" on mesh \""
+        << this->MeshName << "\"")
+      return false;
+      }
+
+    nComps[a] = mmd->ArrayComponents[it - mmd->ArrayName.begin()];
+    nFields += nComps[a];
+    }
+
+  // get the local particles
+  svtkDataObject *dobj = nullptr;
+  if (dataIn->GetMesh(this->MeshName, false, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  // the ghost arrays are used in place, hold the mesh until done
+  svtkCompositeDataSetPtr mesh;
+  std::vector<Particles> parts;
+  if (dobj)
+    {
+    if (mmd->NumGhostNodes && dataIn->AddGhostNodesArray(dobj, this->MeshName))
+      {
+      SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add ghost nodes.")
+      dobj->Delete();
+      return false;
+      }
+
+    for (int a = 0; a < nArrays; ++a)
+      {
+      if (dataIn->AddArray(dobj, this->MeshName, svtkDataObject::POINT,
+        this->Arrays[a]))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add point"
+          " data array \"" << this->Arrays[a] << "\"")
+        dobj->Delete();
+        return false;
+        }
+      }
+
+    // the composite wrapper takes ownership
+    mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+
+    svtkSmartPointer<svtkCompositeDataIterator> iter;
+    iter.TakeReference(mesh->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+      svtkPointSet *ps = dynamic_cast<svtkPointSet*>(iter->GetCurrentDataObject());
+      if (!ps)
+        {
+        SENSEI_ERROR("Block " << iter->GetCurrentFlatIndex() << " of mesh \""
+          << this->MeshName << "\" is not a point set")
+        return false;
+        }
+
+      if (!ps->GetPoints() || !ps->GetNumberOfPoints())
+        continue;
+
+      Particles p;
+      p.NumParticles = ps->GetNumberOfPoints();
+      ::ToDouble(ps->GetPoints()->GetData(), p.Points);
+
+      svtkPointData *pd = ps->GetPointData();
+      for (int a = 0; a < nArrays; ++a)
+        {
+        svtkDataArray *da = pd->GetArray(this->Arrays[a].c_str());
+        if (!da || (da->GetNumberOfComponents() != nComps[a]))
+          {
+          SENSEI_ERROR("Block " << iter->GetCurrentFlatIndex() << " of mesh \""
+            << this->MeshName << "\" has no " << nComps[a] << " component"
+            " array named \"" << this->Arrays[a] << "\"")
+          return false;
+          }
+
+        p.Arrays.emplace_back();
+        ::ToDouble(da, p.Arrays.back());
+        }
+
+      svtkUnsignedCharArray *ga = dynamic_cast<svtkUnsignedCharArray*>(
+        pd->GetArray("svtkGhostType"));
+      p.Ghosts = ga ? ga->GetPointer(0) : nullptr;
+
+      parts.push_back(std::move(p));
+      }
+    }
+
+  // the bounds of the grid, by default those of the particles
+  std::array<double,6> bounds = this->Bounds;
+  if (!this->HaveBounds)
+    {
+    double localBds[6];
+    for (int d = 0; d < 3; ++d)
+      {
+      localBds[2*d] = std::numeric_limits<double>::lowest();
+      localBds[2*d+1] = std::numeric_limits<double>::lowest();
+      }
+
+    for (const Particles &p : parts)
+      {
+      for (long i = 0; i < p.NumParticles; ++i)
+        {
+        for (int d = 0; d < 3; ++d)
+          {
+          double x = p.Points[3*i + d];
+          localBds[2*d] = std::max(localBds[2*d], -x);
+          localBds[2*d+1] = std::max(localBds[2*d+1], x);
+          }
+        }
+      }
+
+    // reduce the bounds in a single collective
+    double globalBds[6];
+    MPI_Allreduce(localBds, globalBds, 6, MPI_DOUBLE, MPI_MAX, comm);
+
+    for (int d = 0; d < 3; ++d)
+      {
+      bounds[2*d] = -globalBds[2*d];
+      bounds[2*d+1] = globalBds[2*d+1];
+
+      // no particles at all, or all of them in a plane
+      if (globalBds[2*d+1] == std::numeric_limits<double>::lowest())
+        {
+        bounds[2*d] = 0.0;
+        bounds[2*d+1] = 1.0;
+        }
+      else if (!(bounds[2*d+1] > bounds[2*d]))
+        {
+        bounds[2*d] -= 0.5;
+        bounds[2*d+1] += 0.5;
+        }
+      }
+    }
+
+  const std::array<int,3> &res = this->Resolution;
+
+  std::array<double,3> dx;
+  for (int d = 0; d < 3; ++d)
+    dx[d] = (bounds[2*d+1] - bounds[2*d])/res[d];
+
+  // the patch of the grid covered by the local particles and the support
+  // of the kernel
+  std::array<long,6> ext{{std::numeric_limits<long>::max(), -1,
+    std::numeric_limits<long>::max(), -1, std::numeric_limits<long>::max(), -1}};
+
+  for (const Particles &p : parts)
+    {
+    for (long i = 0; i < p.NumParticles; ++i)
+      {
+      for (int d = 0; d < 3; ++d)
+        {
+        long c = std::floor((p.Points[3*i + d] - bounds[2*d])/dx[d]);
+        ext[2*d] = std::min(ext[2*d], c - 2);
+        ext[2*d+1] = std::max(ext[2*d+1], c + 2);
+        }
+      }
+    }
+
+  for (int d = 0; d < 3; ++d)
+    {
+    ext[2*d] = std::max(ext[2*d], 0l);
+    ext[2*d+1] = std::min(ext[2*d+1], long(res[d] - 1));
+    }
+
+  // deposit the local particles. each thread has a private patch and
+  // deposits a contiguous range of the particles in each block.
+  int nThreads = std::max(1, this->NumberOfThreads);
+
+  std::vector<Patch> patches(nThreads);
+  for (int t = 0; t < nThreads; ++t)
+    patches[t].Initialize(ext, nFields);
+
+  if (!patches[0].Empty())
+    {
+    TimeEvent<128> mark2("ParticleDeposition::Deposit");
+
+    auto work = [&](int tid)
+    {
+      for (const Particles &p : parts)
+        {
+        long nPer = p.NumParticles / nThreads;
+        long nLarge = p.NumParticles % nThreads;
+        long p0 = nPer*tid + std::min<long>(tid, nLarge);
+        long p1 = p0 + nPer + (tid < nLarge ? 1 : 0);
+
+        ::Deposit(this->Kernel, res, bounds, dx, nComps, p, p0, p1,
+          patches[tid]);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int i = 1; i < nThreads; ++i)
+      threads.emplace_back(work, i);
+
+    work(0);
+
+    for (int i = 0; i < nThreads - 1; ++i)
+      threads[i].join();
+
+    // merge the thread private patches in a fixed order
+    for (int t = 1; t < nThreads; ++t)
+      patches[0].Add(patches[t]);
+    }
+
+  Patch &local = patches[0];
+
+  // decompose the grid into one block per rank and sum the patches onto
+  // the blocks they overlap
+  TimeEvent<128> mark3("ParticleDeposition::Reduce");
+
+  sdiy::Master master(comm, 1, -1, &DepositionBlock::create,
+    &DepositionBlock::destroy);
+
+  sdiy::ContiguousAssigner assigner(nRanks, nRanks);
+
+  sdiy::DiscreteBounds domain;
+  for (int d = 0; d < 3; ++d)
+    {
+    domain.min[d] = 0;
+    domain.max[d] = res[d] - 1;
+    }
+
+  // don't split directions with a single cell
+  std::vector<int> divs(3, 0);
+  for (int d = 0; d < 3; ++d)
+    divs[d] = res[d] > 1 ? 0 : 1;
+
+  sdiy::RegularDecomposer<sdiy::DiscreteBounds> decomposer(3, domain, nRanks,
+    sdiy::RegularDecomposer<sdiy::DiscreteBounds>::BoolVector(),
+    sdiy::RegularDecomposer<sdiy::DiscreteBounds>::BoolVector(),
+    sdiy::RegularDecomposer<sdiy::DiscreteBounds>::CoordinateVector(), divs);
+
+  decomposer.decompose(rank, assigner,
+    [&](int gid, const sdiy::DiscreteBounds &core, const sdiy::DiscreteBounds &,
+      const sdiy::DiscreteBounds &, const sdiy::RegularGridLink &)
+    {
+    DepositionBlock *b = new DepositionBlock;
+
+    std::array<long,6> bext;
+    for (int d = 0; d < 3; ++d)
+      {
+      bext[2*d] = core.min[d];
+      bext[2*d+1] = core.max[d];
+      }
+
+    b->Grid.Initialize(bext, nFields);
+
+    master.add(gid, b, new sdiy::Link);
+    });
+
+  master.foreach([&](DepositionBlock *, const sdiy::Master::ProxyWithLink &cp)
+    {
+    if (local.Empty())
+      return;
+
+    // the decomposition is regular, the blocks overlapping the patch are
+    // those between the blocks holding its first and last cells
+    std::array<int,3> first;
+    std::array<int,3> last;
+    for (int d = 0; d < 3; ++d)
+      {
+      first[d] = local.Extent[2*d];
+      last[d] = local.Extent[2*d+1];
+      }
+
+    std::vector<int> lo(3);
+    std::vector<int> hi(3);
+    for (int d = 0; d < 3; ++d)
+      {
+      int top = 0;
+      int bottom = 0;
+      decomposer.top_bottom(top, lo[d], first, d);
+      decomposer.top_bottom(hi[d], bottom, last, d);
+      }
+
+    std::vector<int> coords(3);
+    for (coords[2] = lo[2]; coords[2] < hi[2]; ++coords[2])
+      for (coords[1] = lo[1]; coords[1] < hi[1]; ++coords[1])
+        for (coords[0] = lo[0]; coords[0] < hi[0]; ++coords[0])
+          {
+          int gid = decomposer.coords_to_gid(coords);
+
+          sdiy::DiscreteBounds gb;
+          decomposer.fill_bounds(gb, coords);
+
+          std::array<long,6> gext;
+          for (int d = 0; d < 3; ++d)
+            {
+            gext[2*d] = gb.min[d];
+            gext[2*d+1] = gb.max[d];
+            }
+
+          std::array<long,6> sext;
+          if (Patch::Intersect(local.Extent, gext, sext))
+            continue;
+
+          Patch sub;
+          sub.Initialize(sext, nFields);
+          sub.Add(local);
+
+          std::vector<long> subExt(sext.begin(), sext.end());
+
+          sdiy::BlockID dest(gid, assigner.rank(gid));
+          cp.enqueue(dest, subExt);
+          cp.enqueue(dest, sub.Data);
+          }
+    });
+
+  master.exchange(true);
+
+  master.foreach([&](DepositionBlock *b, const sdiy::Master::ProxyWithLink &cp)
+    {
+    std::vector<int> in;
+    cp.incoming(in);
+
+    for (int gid : in)
+      {
+      if (!cp.incoming(gid))
+        continue;
+
+      std::vector<long> subExt;
+      Patch sub;
+      cp.dequeue(gid, subExt);
+      cp.dequeue(gid, sub.Data);
+
+      std::copy(subExt.begin(), subExt.end(), sub.Extent.begin());
+      sub.NumFields = nFields;
+
+      b->Grid.Add(sub);
+      }
+    });
+
+  // pass the results back as an image with one block per rank
+  if (dataOut)
+    {
+    DepositionBlock *b = master.block<DepositionBlock>(0);
+    const Patch &grid = b->Grid;
+
+    long n = grid.Size();
+    double cellVol = dx[0]*dx[1]*dx[2];
+
+    svtkImageData *im = svtkImageData::New();
+    im->SetDimensions(grid.Size(0) + 1, grid.Size(1) + 1, grid.Size(2) + 1);
+    im->SetSpacing(dx[0], dx[1], dx[2]);
+    im->SetOrigin(bounds[0] + grid.Extent[0]*dx[0],
+      bounds[2] + grid.Extent[2]*dx[1], bounds[4] + grid.Extent[4]*dx[2]);
+
+    const double *wsum = grid.Data.data();
+
+    svtkDoubleArray *density = svtkDoubleArray::New();
+    density->SetName("density");
+    density->SetNumberOfTuples(n);
+    double *pDensity = density->GetPointer(0);
+    for (long q = 0; q < n; ++q)
+      pDensity[q] = wsum[q]/cellVol;
+    im->GetCellData()->AddArray(density);
+    density->Delete();
+
+    // the kernel weighted average of each array
+    long f = 1;
+    for (int a = 0; a < nArrays; ++a)
+      {
+      svtkDoubleArray *avg = svtkDoubleArray::New();
+      avg->SetName(this->Arrays[a].c_str());
+      avg->SetNumberOfComponents(nComps[a]);
+      avg->SetNumberOfTuples(n);
+      double *pAvg = avg->GetPointer(0);
+      for (int c = 0; c < nComps[a]; ++c, ++f)
+        {
+        const double *vsum = grid.Data.data() + f*n;
+        for (long q = 0; q < n; ++q)
+          pAvg[q*nComps[a] + c] = wsum[q] > 0.0 ? vsum[q]/wsum[q] : 0.0;
+        }
+      im->GetCellData()->AddArray(avg);
+      avg->Delete();
+      }
+
+    svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+    mb->SetNumberOfBlocks(nRanks);
+    mb->SetBlock(rank, im);
+    im->Delete();
+
+    SVTKDataAdaptor *out = SVTKDataAdaptor::New();
+    out->SetCommunicator(comm);
+    out->SetDataObject(this->OutputMeshName, mb);
+    out->SetDataTimeStep(dataIn->GetDataTimeStep());
+    out->SetDataTime(dataIn->GetDataTime());
+    mb->Delete();
+
+    *dataOut = out;
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int ParticleDeposition::Finalize()
+{
+  return 0;
+}
+
+}
@@ -0,0 +1,95 @@
+#ifndef sensei_ParticleDeposition_h
+#define sensei_ParticleDeposition_h
+
+#include "AnalysisAdaptor.h"
+
+#include <mpi.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/** Deposits particles onto a uniform grid. Each particle is spread over
+ * the cells near it using one of the nearest grid point (NGP), cloud in
+ * cell (CIC), or triangular shaped cloud (TSC) kernels. The deposited
+ * density, the kernel weighted number of particles per unit volume, is
+ * computed along with the kernel weighted average of any number of particle
+ * point data arrays. Ghost particles are skipped.
+ *
+ * Each rank deposits its local particles into a patch of the grid covering
+ * them, using a number of threads each with a private patch. The grid is
+ * decomposed into one block per rank and the patches are summed onto the
+ * blocks they overlap in a single sdiy exchange. The result is returned
+ * through a DataAdaptor as a multiblock mesh with one svtkImageData block
+ * per rank carrying cell data arrays named "density" and the names of the
+ * deposited arrays, so that it can be passed to writers and other analyses.
+ */
+class SENSEI_EXPORT ParticleDeposition : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static ParticleDeposition *New();
+
+  senseiTypeMacro(ParticleDeposition, AnalysisAdaptor);
+
+  /// the supported kernels
+  enum {KERNEL_NGP, KERNEL_CIC, KERNEL_TSC};
+
+  /// convert a kernel name, ngp, cic, or tsc, into an enum. returns 0 if successful
+  static int GetKernel(const std::string &name, int &kernel);
+
+  /// set the name of the particle mesh
+  void SetMeshName(const std::string &meshName) { this->MeshName = meshName; }
+
+  /// set the point data arrays to deposit. if none are set only the density is computed.
+  void SetArrays(const std::vector<std::string> &arrays) { this->Arrays = arrays; }
+
+  /// set the kernel. one of KERNEL_NGP, KERNEL_CIC, or KERNEL_TSC. the default is CIC
+  int SetKernel(int kernel);
+
+  /// set the number of grid cells in each direction. the default is 64^3.
+  int SetResolution(const std::array<int,3> &res);
+
+  /** set the spatial bounds of the grid [x0,x1, y0,y1, z0,z1]. If not set
+   * the bounds of the particles are used. Particles outside of the bounds
+   * are skipped. The weight a kernel places outside of the grid is added to
+   * the boundary cells, hence the mass of the particles inside of the bounds
+   * is conserved.
+   */
+  int SetBounds(const std::array<double,6> &bounds);
+
+  /// set the name of the output mesh. the default is "deposition"
+  void SetOutputMeshName(const std::string &name) { this->OutputMeshName = name; }
+
+  /// set the number of threads used to deposit local particles. the default is 1.
+  void SetNumberOfThreads(int nThreads) { this->NumberOfThreads = nThreads; }
+
+  /// deposit the particles for this time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+protected:
+  ParticleDeposition();
+  ~ParticleDeposition();
+
+  ParticleDeposition(const ParticleDeposition&) = delete;
+  void operator=(const ParticleDeposition&) = delete;
+
+private:
+  std::string MeshName;
+  std::vector<std::string> Arrays;
+  std::string OutputMeshName;
+  int Kernel;
+  int NumberOfThreads;
+  bool HaveBounds;
+  std::array<int,3> Resolution;
+  std::array<double,6> Bounds;
+};
+
+}
+
+#endif
@@ -1,8 +1,14 @@
 #include "Profiler.h"
 #include "MemoryProfiler.h"
+#include "MPIUtils.h"
 #include "Error.h"
 
 #include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
 #include <fstream>
 #include <cstdlib>
 #include <cstring>
@@ -13,13 +19,17 @@
 #include <cstdlib>
 #include <cstdio>
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <list>
+#include <set>
 #include <vector>
 #include <iomanip>
 #include <limits>
 #include <unordered_map>
 #include <mutex>
+#include <atomic>
 
 namespace impl
 {
@@ -50,6 +60,14 @@ struct Event
   // how deep is the Event stack
   int Depth;
 
+  // when memory attribution is enabled, the heap bytes in use at the start
+  // of the Event, the most seen at any Event boundary during the Event,
+  // and the process peak RSS in KiB at the start of the Event. on
+  // completion these hold the net change in heap bytes, the heap high
+  // water mark relative to the start, and the increase in peak RSS.
+  long long Heap[2];
+  long long PeakRSS;
+
   // the thread id that generated the Event
   std::thread::id Tid;
 };
@@ -62,7 +80,95 @@ static MPI_Comm comm = MPI_COMM_NULL;
 
 static int loggingEnabled = 0x00;
 
+// bit in loggingEnabled that turns on per-event memory attribution
+static const int memoryAttribution = 0x04;
+
+// bit in loggingEnabled that turns on summary mode
+static const int summaryMode = 0x08;
+
 static std::string timerLogFile = "timer.csv";
+static std::string summaryLogFile = "timer_summary.csv";
+
+// in summary mode the ranks that are a multiple of this keep the full
+// trace. 0 keeps none
+static int traceStride = 0;
+
+// set when the events of this rank are kept for the timer log
+static bool traceEvents = true;
+
+// the duration histograms of summary mode. bucket i counts durations in
+// [2^(minBucketExp + i - 1), 2^(minBucketExp + i)) seconds, the first and
+// last buckets being open ended
+static const int numBuckets = 32;
+static const int minBucketExp = -20;
+
+// the durations of the events of a given name
+struct Summary
+{
+  Summary() : Count(0), Total(0.0),
+    Min(std::numeric_limits<double>::max()),
+    Max(std::numeric_limits<double>::lowest()), Buckets{} {}
+
+  // add an event's duration
+  void Add(double dt);
+
+  long Count;
+  double Total;
+  double Min;
+  double Max;
+  long Buckets[numBuckets];
+};
+
+using summaryMapType = std::unordered_map<std::string, Summary>;
+static summaryMapType eventSummary;
+
+// bit in loggingEnabled that turns on the per-step telemetry stream
+static const int telemetryMode = 0x10;
+
+// where the per-step records go, a file or when prefixed with unix: the
+// path of a Unix domain socket
+static std::string telemetryStream = "telemetry.csv";
+
+// the wall time of each named activity during the current step, in the
+// order they were first added
+static std::vector<std::string> stepNames;
+static std::vector<double> stepTimes;
+
+// bytes moved by events ending during the current step
+static std::atomic<long long> stepBytes(0);
+
+// the per-step record stream. this is only used on rank 0
+struct Telemetry
+{
+  Telemetry() : File(nullptr), Socket(-1), Warned(false) {}
+
+  // send a record, opening the stream as needed. the header is sent when
+  // the stream is opened and whenever the names change
+  int Send(const std::vector<std::string> &names, const std::string &header,
+    const std::string &record);
+
+  // close the stream
+  void Close();
+
+  // connect the socket, it is non-blocking so that a slow or missing
+  // collector does not stall the run
+  int Connect(const std::string &path);
+
+  // send as much of the pending output as the socket will take
+  int Drain();
+
+  FILE *File;
+  int Socket;
+  bool Warned;
+  std::string Pending;
+  std::vector<std::string> Names;
+};
+
+// the most output held for a socket that is not keeping up. records are
+// dropped beyond this
+static const size_t maxPendingBytes = 1 << 20;
+
+static Telemetry telemetry;
 
 using eventLogType = std::list<impl::Event>;
 using threadMapType = std::unordered_map<std::thread::id, eventLogType>;
@@ -85,10 +191,291 @@ static double getSystemTime()
 
 // --------------------------------------------------------------------------
 Event::Event() : Time{0,0,0}, NumBytes(-1ll), Depth(0),
-  Tid(std::this_thread::get_id())
+  Heap{-1ll,-1ll}, PeakRSS(-1ll), Tid(std::this_thread::get_id())
 {
 }
 
+// --------------------------------------------------------------------------
+void Summary::Add(double dt)
+{
+  this->Count += 1;
+  this->Total += dt;
+  this->Min = std::min(this->Min, dt);
+  this->Max = std::max(this->Max, dt);
+
+  int bucket = 0;
+  if (dt > 0.0)
+    {
+    int e = int(std::floor(std::log2(dt)));
+    bucket = std::max(0, std::min(numBuckets - 1, e - minBucketExp + 1));
+    }
+
+  this->Buckets[bucket] += 1;
+}
+
+// --------------------------------------------------------------------------
+// a value and the rank holding it, the layout of MPI_DOUBLE_INT
+struct ValueRank
+{
+  double Value;
+  int Rank;
+};
+
+// --------------------------------------------------------------------------
+// reduce the summaries across ranks, rank 0 writes the result. comm may be
+// MPI_COMM_NULL when MPI is not in use
+static int WriteSummary(MPI_Comm comm)
+{
+  int rank = 0;
+#if defined(SENSEI_HAS_MPI)
+  if (comm != MPI_COMM_NULL)
+    MPI_Comm_rank(comm, &rank);
+#endif
+
+  // the union of the event names logged on each rank
+  std::vector<char> names;
+  for (const auto &it : eventSummary)
+    names.insert(names.end(), it.first.c_str(), it.first.c_str() + it.first.size() + 1);
+
+#if defined(SENSEI_HAS_MPI)
+  if (comm != MPI_COMM_NULL)
+    sensei::MPIUtils::GlobalViewV(comm, names);
+#endif
+
+  std::set<std::string> nameSet;
+  for (size_t i = 0; i < names.size(); i += strlen(names.data() + i) + 1)
+    nameSet.insert(names.data() + i);
+
+  std::vector<std::string> eventNames(nameSet.begin(), nameSet.end());
+  int nNames = eventNames.size();
+
+  // the count, the number of ranks, and the histogram of each event, the
+  // total duration, and the max and negated min with the ranks holding them
+  const int nCounts = numBuckets + 2;
+  std::vector<long> counts(nNames*nCounts, 0);
+  std::vector<double> totals(nNames, 0.0);
+  std::vector<ValueRank> extrema(2*nNames,
+    ValueRank{std::numeric_limits<double>::lowest(), rank});
+
+  for (int i = 0; i < nNames; ++i)
+    {
+    summaryMapType::iterator it = eventSummary.find(eventNames[i]);
+    if (it == eventSummary.end())
+      continue;
+
+    const Summary &sum = it->second;
+    long *pc = counts.data() + i*nCounts;
+    pc[0] = sum.Count;
+    pc[1] = 1;
+    for (int j = 0; j < numBuckets; ++j)
+      pc[j + 2] = sum.Buckets[j];
+
+    totals[i] = sum.Total;
+    extrema[i].Value = sum.Max;
+    extrema[nNames + i].Value = -sum.Min;
+    }
+
+#if defined(SENSEI_HAS_MPI)
+  if (comm != MPI_COMM_NULL)
+    {
+    std::vector<long> gcounts(counts.size());
+    std::vector<double> gtotals(totals.size());
+    std::vector<ValueRank> gextrema(extrema.size());
+
+    sensei::MPIUtils::NodeAwareReduce(comm, counts.data(), gcounts.data(),
+      counts.size(), MPI_LONG, MPI_SUM, 0);
+
+    sensei::MPIUtils::NodeAwareReduce(comm, totals.data(), gtotals.data(),
+      totals.size(), MPI_DOUBLE, MPI_SUM, 0);
+
+    sensei::MPIUtils::NodeAwareReduce(comm, extrema.data(), gextrema.data(),
+      extrema.size(), MPI_DOUBLE_INT, MPI_MAXLOC, 0);
+
+    counts.swap(gcounts);
+    totals.swap(gtotals);
+    extrema.swap(gextrema);
+    }
+#endif
+
+  if (rank != 0)
+    return 0;
+
+  // the most expensive events first
+  std::vector<int> order(nNames);
+  for (int i = 0; i < nNames; ++i)
+    order[i] = i;
+
+  std::sort(order.begin(), order.end(),
+    [&totals](int a, int b) { return totals[a] > totals[b]; });
+
+  std::ostringstream oss;
+  oss << "# name, count, ranks, total, mean, min, min rank, max, max rank, 0";
+  for (int j = 1; j < numBuckets; ++j)
+    oss << ", 2^" << minBucketExp + j - 1;
+  oss << std::endl;
+
+  for (int q = 0; q < nNames; ++q)
+    {
+    int i = order[q];
+    const long *pc = counts.data() + i*nCounts;
+    oss << "\"" << eventNames[i] << "\", " << pc[0] << ", " << pc[1] << ", "
+      << totals[i] << ", " << (pc[0] ? totals[i]/pc[0] : 0.0) << ", "
+      << -extrema[nNames + i].Value << ", " << extrema[nNames + i].Rank << ", "
+      << extrema[i].Value << ", " << extrema[i].Rank;
+    for (int j = 0; j < numBuckets; ++j)
+      oss << ", " << pc[j + 2];
+    oss << std::endl;
+    }
+
+  return sensei::Profiler::WriteCStdio(summaryLogFile.c_str(), "w", oss.str());
+}
+
+// --------------------------------------------------------------------------
+int Telemetry::Connect(const std::string &path)
+{
+  struct sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path))
+    {
+    SENSEI_ERROR("The socket path \"" << path << "\" is too long")
+    return -1;
+    }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+  int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0)
+    return -1;
+
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+
+  if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)))
+    {
+    int err = errno;
+    close(sock);
+    errno = err;
+    return -1;
+    }
+
+  this->Socket = sock;
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Telemetry::Drain()
+{
+  size_t nSent = 0;
+  size_t nBytes = this->Pending.size();
+  while (nSent < nBytes)
+    {
+    ssize_t n = send(this->Socket, this->Pending.data() + nSent,
+      nBytes - nSent, MSG_DONTWAIT | MSG_NOSIGNAL);
+
+    if (n < 0)
+      {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
+        break;
+
+      // the collector went away
+      this->Pending.erase(0, nSent);
+      return -1;
+      }
+
+    nSent += n;
+    }
+
+  this->Pending.erase(0, nSent);
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+void Telemetry::Close()
+{
+  if (this->File)
+    fclose(this->File);
+
+  if (this->Socket >= 0)
+    close(this->Socket);
+
+  this->File = nullptr;
+  this->Socket = -1;
+  this->Pending.clear();
+  this->Names.clear();
+}
+
+// --------------------------------------------------------------------------
+int Telemetry::Send(const std::vector<std::string> &names,
+  const std::string &header, const std::string &record)
+{
+  bool useSocket = telemetryStream.compare(0, 5, "unix:") == 0;
+
+  // open the stream. a collector may start after the run, connecting is
+  // tried again at each step
+  if (!this->File && (this->Socket < 0))
+    {
+    if (useSocket)
+      {
+      if (this->Connect(telemetryStream.substr(5)))
+        {
+        if (!this->Warned)
+          SENSEI_WARNING("Failed to connect to the telemetry collector at \""
+            << telemetryStream.substr(5) << "\". " << strerror(errno))
+        this->Warned = true;
+        return -1;
+        }
+      }
+    else if (!(this->File = fopen(telemetryStream.c_str(), "w")))
+      {
+      if (!this->Warned)
+        SENSEI_WARNING("Failed to open the telemetry stream \""
+          << telemetryStream << "\". " << strerror(errno))
+      this->Warned = true;
+      return -1;
+      }
+
+    this->Names.clear();
+    }
+
+  std::string out;
+  if (names != this->Names)
+    {
+    out = header;
+    this->Names = names;
+    }
+
+  out += record;
+
+  if (this->File)
+    {
+    // flush each record so that a collector tailing the file sees it
+    if ((fwrite(out.data(), 1, out.size(), this->File) != out.size()) ||
+      fflush(this->File))
+      {
+      SENSEI_WARNING("Failed to write the telemetry stream \""
+        << telemetryStream << "\". " << strerror(errno))
+      this->Close();
+      return -1;
+      }
+    return 0;
+    }
+
+  // a collector that is not keeping up loses records, not the run. records
+  // are dropped whole so that the stream stays line oriented
+  if (this->Pending.size() + out.size() <= maxPendingBytes)
+    this->Pending += out;
+  else
+    this->Names.clear();
+
+  if (this->Drain())
+    {
+    this->Close();
+    return -1;
+    }
+
+  return 0;
+}
+
 //-----------------------------------------------------------------------------
 void Event::ToStream(std::ostream &str) const
 {
@@ -104,7 +491,11 @@ void Event::ToStream(std::ostream &str) const
   str << rank << ", " << this->Tid << ", \"" << this->Name << "\", "
     << this->Time[START] << ", " << this->Time[END] << ", "
     << this->Time[DELTA] << ", " << this->NumBytes  << ", "
-    << this->Depth << std::endl;
+    << this->Depth;
+  if (impl::loggingEnabled & impl::memoryAttribution)
+    str << ", " << this->Heap[0] << ", " << this->Heap[1]
+      << ", " << this->PeakRSS;
+  str << std::endl;
 #else
   (void)str;
 #endif
@@ -125,10 +516,10 @@ void Profiler::SetCommunicator(MPI_Comm comm)
   MPI_Initialized(&ok);
   if (ok)
     {
-    if (impl::comm != MPI_COMM_NULL)
-      MPI_Comm_free(&impl::comm);
-
-    MPI_Comm_dup(comm, &impl::comm);
+    // the profiler's reductions get a duplicate separate from the adaptors'
+    MPI_Comm tmp = MPIUtils::AcquireCommunicator(comm, "Profiler");
+    MPIUtils::ReleaseCommunicator(impl::comm);
+    impl::comm = tmp;
     }
 #else
   (void)comm;
@@ -145,6 +536,36 @@ void Profiler::SetTimerLogFile(const std::string &file)
 #endif
 }
 
+// ----------------------------------------------------------------------------
+void Profiler::SetSummaryLogFile(const std::string &file)
+{
+#if defined(ENABLE_PROFILER)
+  impl::summaryLogFile = file;
+#else
+  (void)file;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+void Profiler::SetTraceStride(int stride)
+{
+#if defined(ENABLE_PROFILER)
+  impl::traceStride = stride;
+#else
+  (void)stride;
+#endif
+}
+
+// ----------------------------------------------------------------------------
+void Profiler::SetTelemetryStream(const std::string &dest)
+{
+#if defined(ENABLE_PROFILER)
+  impl::telemetryStream = dest;
+#else
+  (void)dest;
+#endif
+}
+
 // ----------------------------------------------------------------------------
 void Profiler::SetMemProfLogFile(const std::string &file)
 {
@@ -250,6 +671,15 @@ int Profiler::Initialize()
   if ((tmp = getenv("PROFILER_LOG_FILE")))
     impl::timerLogFile = tmp;
 
+  if ((tmp = getenv("PROFILER_SUMMARY_FILE")))
+    impl::summaryLogFile = tmp;
+
+  if ((tmp = getenv("PROFILER_TRACE_STRIDE")))
+    impl::traceStride = atoi(tmp);
+
+  if ((tmp = getenv("PROFILER_TELEMETRY")))
+    impl::telemetryStream = tmp;
+
   if ((tmp = getenv("MEMPROF_LOG_FILE")))
     impl::memProf.SetFilename(tmp);
 
@@ -259,12 +689,25 @@ int Profiler::Initialize()
   if (impl::loggingEnabled & 0x02)
     impl::memProf.Initialize();
 
+  // in summary mode only a sample of the ranks keep the full trace
+  impl::traceEvents = !(impl::loggingEnabled & impl::summaryMode) ||
+    ((impl::traceStride > 0) && ((rank % impl::traceStride) == 0));
+
+  if (!impl::traceEvents)
+    impl::eventLog.clear();
+
   // report what options are in use
   if ((rank == 0) && impl::loggingEnabled)
     std::cerr << "Profiler configured with Event logging "
       << (impl::loggingEnabled & 0x01 ? "enabled" : "disabled")
       << " and memory logging " << (impl::loggingEnabled & 0x02 ? "enabled" : "disabled")
+      << ", memory attribution " << (impl::loggingEnabled & impl::memoryAttribution ? "enabled" : "disabled")
+      << ", summary mode " << (impl::loggingEnabled & impl::summaryMode ? "enabled" : "disabled")
+      << ", trace stride " << impl::traceStride
+      << ", telemetry " << (impl::loggingEnabled & impl::telemetryMode ? "enabled" : "disabled")
       << ", timer log file \"" << impl::timerLogFile
+      << "\", summary file \"" << impl::summaryLogFile
+      << "\", telemetry stream \"" << impl::telemetryStream
       << "\", memory profiler log file \"" << impl::memProf.GetFilename()
       << "\", sampling interval " << impl::memProf.GetInterval()
       << " seconds" << std::endl;
@@ -289,10 +732,9 @@ int Profiler::WriteMpiIo(MPI_Comm comm, const char *fileName,
     MPI_Comm_size(comm, &nRanks);
 
     std::vector<long> gsizes(nRanks);
-    gsizes[rank] = nBytes;
 
-    MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
-      gsizes.data(), 1, MPI_LONG, impl::comm);
+    MPIUtils::NodeAwareAllgather(impl::comm, &nBytes, 1,
+      gsizes.data(), MPI_LONG);
 
     long offset = 0;
     for (int i = 0; i < rank; ++i)
@@ -330,6 +772,14 @@ int Profiler::WriteMpiIo(MPI_Comm comm, const char *fileName,
 int Profiler::Flush()
 {
 #if defined(ENABLE_PROFILER)
+  // in summary mode events are appended only by ranks that keep the trace
+  if (!impl::traceEvents || ((impl::loggingEnabled & impl::summaryMode) &&
+    (impl::traceStride < 1)))
+    {
+    impl::eventLog.clear();
+    return 0;
+    }
+
   std::ostringstream oss;
   Profiler::ToStream(oss);
   Profiler::WriteCStdio(impl::timerLogFile.c_str(), "a", oss.str());
@@ -381,6 +831,14 @@ int Profiler::Finalize()
   int ok = 0;
 #if defined(SENSEI_HAS_MPI)
   MPI_Initialized(&ok);
+
+  // nothing to do if already finalized. MPIManager calls Finalize when it
+  // goes out of scope and miniapps such as the oscillator call it before
+  // that. a second pass would rewrite the timer log with the events cleared
+  // by the first and release the communicator again. the communicator is
+  // released last, so a null one marks a finished pass
+  if (ok && (impl::comm == MPI_COMM_NULL))
+    return 0;
 #endif
 
   if (impl::loggingEnabled & 0x01)
@@ -391,23 +849,47 @@ int Profiler::Finalize()
       MPI_Comm_rank(impl::comm, &rank);
 #endif
 
-    // serialize the logged events in CSV format
-    std::ostringstream oss;
+    // reduce and write the summary
+    bool summary = impl::loggingEnabled & impl::summaryMode;
+    if (summary)
+      {
+      impl::WriteSummary(ok ? impl::comm : MPI_COMM_NULL);
+      impl::eventSummary.clear();
+      }
+
+    // in summary mode the trace is written only when it was kept by some
+    // of the ranks
+    if (!summary || (impl::traceStride > 0))
+      {
+      // serialize the logged events in CSV format
+      std::ostringstream oss;
+
+      if (rank == 0)
+        {
+        oss << "# rank, thread, Name, start Time, end Time, delta, bytes, Depth";
+        if (impl::loggingEnabled & impl::memoryAttribution)
+          oss << ", heap delta, heap high water, peak RSS delta";
+        oss << std::endl;
+        }
 
-    if (rank == 0)
-      oss << "# rank, thread, Name, start Time, end Time, delta, bytes, Depth" << std::endl;
+      if (impl::traceEvents)
+        Profiler::ToStream(oss);
 
-    Profiler::ToStream(oss);
+      if (ok)
+        Profiler::WriteMpiIo(impl::comm, impl::timerLogFile.c_str(), oss.str());
+      else
+        Profiler::WriteCStdio(impl::timerLogFile.c_str(), "w", oss.str());
+      }
 
     // free up resources
     impl::eventLog.clear();
-
-    if (ok)
-      Profiler::WriteMpiIo(impl::comm, impl::timerLogFile.c_str(), oss.str());
-    else
-      Profiler::WriteCStdio(impl::timerLogFile.c_str(), "w", oss.str());
     }
 
+  // close the telemetry stream
+  impl::telemetry.Close();
+  impl::stepNames.clear();
+  impl::stepTimes.clear();
+
   // output the memory use profile and clean up resources
   if (impl::loggingEnabled & 0x02)
     impl::memProf.Finalize();
@@ -415,7 +897,7 @@ int Profiler::Finalize()
   // free up other resources
 #if defined(SENSEI_HAS_MPI)
   if (ok)
-    MPI_Comm_free(&impl::comm);
+    MPIUtils::ReleaseCommunicator(impl::comm);
 #endif
 #endif
   return 0;
@@ -432,6 +914,16 @@ bool Profiler::Enabled()
 #endif
 }
 
+//-----------------------------------------------------------------------------
+bool Profiler::TelemetryEnabled()
+{
+#if defined(ENABLE_PROFILER)
+  return impl::loggingEnabled & impl::telemetryMode;
+#else
+  return false;
+#endif
+}
+
 //-----------------------------------------------------------------------------
 void Profiler::Enable(int arg)
 {
@@ -460,11 +952,26 @@ int Profiler::StartEvent(const char* eventname, long long nbytes)
     {
     impl::Event evt;
     evt.Name = eventname;
-    evt.Time[impl::Event::START] = impl::getSystemTime();
     evt.NumBytes = nbytes;
 
+    // sample memory before the start time so that the cost of doing so
+    // is not included
+    if (impl::loggingEnabled & impl::memoryAttribution)
+      {
+      evt.Heap[0] = evt.Heap[1] = MemoryProfiler::GetHeapMemoryUsed();
+      evt.PeakRSS = MemoryProfiler::GetProcPeakMemoryUsed();
+      }
+
+    evt.Time[impl::Event::START] = impl::getSystemTime();
+
     std::lock_guard<std::mutex> lock(impl::eventLogMutex);
-    impl::activeEvents[evt.Tid].push_back(evt);
+    impl::eventLogType &active = impl::activeEvents[evt.Tid];
+
+    // the enclosing event's high water mark
+    if (!active.empty() && (active.back().Heap[1] < evt.Heap[0]))
+      active.back().Heap[1] = evt.Heap[0];
+
+    active.push_back(evt);
     }
 #else
   (void)eventname;
@@ -477,11 +984,22 @@ int Profiler::StartEvent(const char* eventname, long long nbytes)
 int Profiler::EndEvent(const char* eventname, long long nbytes)
 {
 #if defined(ENABLE_PROFILER)
+  if ((impl::loggingEnabled & impl::telemetryMode) && (nbytes > 0))
+    impl::stepBytes += nbytes;
+
   if (impl::loggingEnabled & 0x01)
     {
     // get end Time
     double endTime = impl::getSystemTime();
 
+    long long heap = -1ll;
+    long long peakRSS = -1ll;
+    if (impl::loggingEnabled & impl::memoryAttribution)
+      {
+      heap = MemoryProfiler::GetHeapMemoryUsed();
+      peakRSS = MemoryProfiler::GetProcPeakMemoryUsed();
+      }
+
     // get this thread's Event log
     std::thread::id tid = std::this_thread::get_id();
 
@@ -512,7 +1030,25 @@ int Profiler::EndEvent(const char* eventname, long long nbytes)
     evt.NumBytes = nbytes;
     evt.Depth = iter->second.size();
 
-    impl::eventLog.emplace_back(std::move(evt));
+    if (impl::loggingEnabled & impl::memoryAttribution)
+      {
+      long long highWater = std::max(evt.Heap[1], heap);
+
+      // pass the high water mark to the enclosing event
+      if (!iter->second.empty() && (iter->second.back().Heap[1] < highWater))
+        iter->second.back().Heap[1] = highWater;
+
+      evt.Heap[1] = highWater - evt.Heap[0];
+      evt.Heap[0] = heap - evt.Heap[0];
+      evt.PeakRSS = peakRSS - evt.PeakRSS;
+      }
+
+    // in summary mode durations are summarized as they are logged
+    if (impl::loggingEnabled & impl::summaryMode)
+      impl::eventSummary[evt.Name].Add(evt.Time[impl::Event::DELTA]);
+
+    if (impl::traceEvents)
+      impl::eventLog.emplace_back(std::move(evt));
     }
 #else
   (void)eventname;
@@ -521,4 +1057,206 @@ int Profiler::EndEvent(const char* eventname, long long nbytes)
   return 0;
 }
 
+//-----------------------------------------------------------------------------
+int Profiler::GetEventTime(const std::string &name, long &count, double &total)
+{
+  count = 0;
+  total = 0.0;
+#if defined(ENABLE_PROFILER)
+  if (!(impl::loggingEnabled & 0x01))
+    return -1;
+
+  std::lock_guard<std::mutex> lock(impl::eventLogMutex);
+  if (impl::loggingEnabled & impl::summaryMode)
+    {
+    impl::summaryMapType::iterator it = impl::eventSummary.find(name);
+    if (it != impl::eventSummary.end())
+      {
+      count = it->second.Count;
+      total = it->second.Total;
+      }
+    }
+  else
+    {
+    for (const impl::Event &evt : impl::eventLog)
+      {
+      if (evt.Name == name)
+        {
+        count += 1;
+        total += evt.Time[impl::Event::DELTA];
+        }
+      }
+    }
+
+  return 0;
+#else
+  (void)name;
+  return -1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+int Profiler::AddStepTime(const std::string &name, double seconds)
+{
+#if defined(ENABLE_PROFILER)
+  if (impl::loggingEnabled & impl::telemetryMode)
+    {
+    size_t n = impl::stepNames.size();
+    size_t i = 0;
+    while ((i < n) && (impl::stepNames[i] != name))
+      ++i;
+
+    if (i == n)
+      {
+      impl::stepNames.push_back(name);
+      impl::stepTimes.push_back(0.0);
+      }
+
+    impl::stepTimes[i] += seconds;
+    }
+#else
+  (void)name;
+  (void)seconds;
+#endif
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Profiler::EndStep(MPI_Comm comm, long step, double time)
+{
+#if defined(ENABLE_PROFILER)
+  if (!(impl::loggingEnabled & impl::telemetryMode))
+    return 0;
+
+  int nNames = impl::stepNames.size();
+
+  int rank = 0;
+  int nRanks = 1;
+#if defined(SENSEI_HAS_MPI)
+  if (comm != MPI_COMM_NULL)
+    {
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &nRanks);
+
+    // the columns are reduced by position, hence all ranks must have the
+    // same activities in the same order. this is checked before the values
+    // are reduced, using the number of activities and a hash of their
+    // names in order. the max of x and of ~x give the max and min of x
+    uint64_t hash = 14695981039346656037ull;
+    for (int i = 0; i < nNames; ++i)
+      {
+      const std::string &name = impl::stepNames[i];
+      size_t n = name.size() + 1;
+      for (size_t j = 0; j < n; ++j)
+        {
+        hash ^= (unsigned char)name.c_str()[j];
+        hash *= 1099511628211ull;
+        }
+      }
+
+    long long layout[4] = {nNames, ~(long long)nNames,
+      (long long)hash, ~(long long)hash};
+
+    MPI_Allreduce(MPI_IN_PLACE, layout, 4, MPI_LONG_LONG, MPI_MAX, comm);
+
+    if ((layout[0] != ~layout[1]) || (layout[2] != ~layout[3]))
+      {
+      if (rank == 0)
+        {
+        std::ostringstream oss;
+        if (layout[0] != ~layout[1])
+          oss << "from " << ~layout[1] << " to " << layout[0] << " activities";
+        else
+          oss << "in name or order";
+
+        SENSEI_ERROR("Step " << step << " the timed activities differ across"
+          " ranks " << oss.str() << ". No record was sent")
+        }
+
+      impl::stepBytes = 0;
+      std::fill(impl::stepTimes.begin(), impl::stepTimes.end(), 0.0);
+      return -1;
+      }
+    }
+#else
+  (void)comm;
+#endif
+
+  // the local values, the wall time of each activity, their total, the
+  // bytes moved, and the peak RSS
+  int nVals = nNames + 3;
+
+  std::vector<double> vals(nVals);
+  double total = 0.0;
+  for (int i = 0; i < nNames; ++i)
+    {
+    vals[i] = impl::stepTimes[i];
+    total += impl::stepTimes[i];
+    }
+
+  vals[nNames] = total;
+  vals[nNames + 1] = impl::stepBytes.exchange(0);
+  vals[nNames + 2] = MemoryProfiler::GetProcPeakMemoryUsed();
+
+  // the activities are kept between steps so that the records have the
+  // same layout, while the times start over
+  std::fill(impl::stepTimes.begin(), impl::stepTimes.end(), 0.0);
+
+  // the max and negated min, and the sum
+  std::vector<double> ext(2*nVals);
+  for (int i = 0; i < nVals; ++i)
+    {
+    ext[i] = vals[i];
+    ext[nVals + i] = -vals[i];
+    }
+
+#if defined(SENSEI_HAS_MPI)
+  if (comm != MPI_COMM_NULL)
+    {
+    std::vector<double> gext(ext.size());
+    std::vector<double> gvals(vals.size());
+
+    MPIUtils::NodeAwareReduce(comm, ext.data(), gext.data(), ext.size(),
+      MPI_DOUBLE, MPI_MAX, 0);
+
+    MPIUtils::NodeAwareReduce(comm, vals.data(), gvals.data(), vals.size(),
+      MPI_DOUBLE, MPI_SUM, 0);
+
+    ext.swap(gext);
+    vals.swap(gvals);
+    }
+#endif
+
+  if (rank != 0)
+    return 0;
+
+  // the header names the columns, it is sent again when they change
+  std::ostringstream hss;
+  hss << "# step, time, wall time";
+  for (int i = 0; i < nNames + 3; ++i)
+    {
+    const char *name = i < nNames ? impl::stepNames[i].c_str() :
+      (i == nNames ? "total" : (i == nNames + 1 ? "bytes" : "peak RSS"));
+
+    hss << ", \"" << name << "\" min, \"" << name << "\" max, \""
+      << name << "\" mean";
+    }
+  hss << std::endl;
+
+  std::ostringstream rss;
+  rss << step << ", " << time << ", " << std::fixed << std::setprecision(3)
+    << impl::getSystemTime() << std::defaultfloat << std::setprecision(6);
+  for (int i = 0; i < nNames + 3; ++i)
+    rss << ", " << -ext[nVals + i] << ", " << ext[i] << ", " << vals[i]/nRanks;
+  rss << std::endl;
+
+  impl::telemetry.Send(impl::stepNames, hss.str(), rss.str());
+#else
+  (void)comm;
+  (void)step;
+  (void)time;
+#endif
+  return 0;
+}
+
 }
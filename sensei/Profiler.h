@@ -28,15 +28,56 @@ public:
   //   PROFILER_ENABLE     : bit mask turns on or off logging,
   //               0x01 -- event profiling enabled
   //               0x02 -- memory profiling enabled
+  //               0x04 -- per-event memory attribution enabled
+  //               0x08 -- summary mode enabled
+  //               0x10 -- per-step telemetry enabled
   //   PROFILER_LOG_FILE   : path to write timer log to
+  //   PROFILER_SUMMARY_FILE : path to write the summary to
+  //   PROFILER_TRACE_STRIDE : in summary mode, every n-th rank logs events
+  //   PROFILER_TELEMETRY  : file or unix:<socket path> to stream telemetry to
   //   MEMPROF_LOG_FILE    : path to write memory profiler log to
   //   MEMPROF_INTERVAL    : number of seconds between memory recordings
   //
+  //
+  // When per-event memory attribution is enabled, in addition to event
+  // profiling, the heap bytes in use (from mallinfo2) and the process peak
+  // RSS are sampled at each event's start and end. The net change in heap
+  // bytes, the heap high water mark relative to the start, and the increase
+  // in peak RSS (KiB) are reported as additional columns in the timer log.
+  // The high water mark is the largest value seen at the boundaries of the
+  // event and the events nested in it, hence a transient peak between
+  // boundaries is only captured by the peak RSS. These are process wide
+  // quantities, and include allocations made concurrently by other threads.
+  //
+  // In summary mode, in addition to event profiling, the durations of the
+  // events of each name are summarized across ranks as they are logged. The
+  // count, the number of ranks logging it, total, mean, min, and max along
+  // with the ranks holding the min and max, and a histogram of durations
+  // with power of 2 buckets from 2^-20 to 2^10 seconds are written by rank 0
+  // to a small CSV file. The full trace is kept and written to the timer log
+  // only by ranks that are a multiple of the trace stride, by default none.
+  // This keeps the cost and size of the output independent of the number of
+  // ranks and the length of the run.
+  //
+  // When telemetry is enabled a record is sent by rank 0 at the end of each
+  // step, see EndStep, rather than only at Finalize. Each record is a CSV
+  // line holding the step, simulation time, and wall clock time, followed by
+  // the min, max, and mean across ranks of the wall time of each activity
+  // added with AddStepTime, their total, the bytes passed to EndEvent, and
+  // the peak RSS in KiB. A header line starting with # names the columns,
+  // and is sent again whenever they change. The destination is a file that
+  // is flushed after each record, or when prefixed with unix: the path of a
+  // Unix domain socket a collector listens on. The socket is written without
+  // blocking, when the collector is missing or not keeping up records are
+  // dropped and the run continues. This works independently of the other
+  // modes.
+  //
   static int Initialize();
 
   // Finalize the log. this is where logs are written and cleanup occurs.
   // All processes in the communicator must call, and it must be called
-  // prior to MPI_Finalize.
+  // prior to MPI_Finalize. When MPI is initialized calls after the first
+  // do nothing.
   static int Finalize();
 
   // this can occur after MPI_Finalize. It should only be called by rank 0.
@@ -54,6 +95,23 @@ public:
   // default value; Timer.csv
   static void SetTimerLogFile(const std::string &fileName);
 
+  // Sets the path to write the summary to in summary mode
+  // overriden by PROFILER_SUMMARY_FILE environment variable
+  // default value: timer_summary.csv
+  static void SetSummaryLogFile(const std::string &fileName);
+
+  // Sets the stride of the ranks that keep and write the full trace in
+  // summary mode. 0 disables the trace
+  // overriden by PROFILER_TRACE_STRIDE environment variable
+  // default value: 0
+  static void SetTraceStride(int stride);
+
+  // Sets where telemetry records are sent, a file or unix:<path> for a Unix
+  // domain socket
+  // overriden by PROFILER_TELEMETRY environment variable
+  // default value: telemetry.csv
+  static void SetTelemetryStream(const std::string &dest);
+
   // Sets the path to write the timer log to
   // overriden by MEMPROF_LOG_FILE environment variable
   // default value: MemProfLog.csv
@@ -72,6 +130,26 @@ public:
   // return true if loggin is enabled.
   static bool Enabled();
 
+  // return true if telemetry is enabled.
+  static bool TelemetryEnabled();
+
+  // Add the wall time spent in the named activity to the current step's
+  // telemetry record. Activities must be added in the same order on all
+  // ranks, and once added are reported, as 0 when not added, in every
+  // following step.
+  static int AddStepTime(const std::string &name, double seconds);
+
+  // End the current step, reducing the telemetry across the ranks of comm
+  // and sending the record from rank 0. This is a collective call with
+  // respect to comm. When the activities differ across ranks no record is
+  // sent and all ranks return -1.
+  static int EndStep(MPI_Comm comm, long step, double time);
+
+  // Get the number of events of the given name ended on this rank and their
+  // total duration in seconds, from the summary in summary mode and from the
+  // trace otherwise. Returns -1 when event profiling is not enabled.
+  static int GetEventTime(const std::string &name, long &count, double &total);
+
   // @brief Log start of an event.
   //
   // This marks the beginning of a event that must be logged.  The @arg
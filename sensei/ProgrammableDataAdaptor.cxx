@@ -117,6 +117,8 @@ int ProgrammableDataAdaptor::AddArray(svtkDataObject* mesh,
 //----------------------------------------------------------------------------
 int ProgrammableDataAdaptor::ReleaseData()
 {
+  this->Superclass::ReleaseData();
+
   if (this->ReleaseDataCallback)
     return this->ReleaseDataCallback();
 
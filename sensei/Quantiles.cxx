@@ -0,0 +1,322 @@
+#include "Quantiles.h"
+#include "TDigest.h"
+#include "DataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkFieldData.h>
+#include <svtkSmartPointer.h>
+#include <svtkUnsignedCharArray.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+// **************************************************************************
+int AddLocalData(svtkDataArray *da, svtkUnsignedCharArray *ga,
+  sensei::TDigest &digest)
+{
+  if (da->GetNumberOfComponents() != 1)
+    {
+    SENSEI_ERROR("Quantiles of multi-component arrays are not supported")
+    return -1;
+    }
+
+  long nVals = da->GetNumberOfTuples();
+  const unsigned char *pGa = ga ? ga->GetPointer(0) : nullptr;
+
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+      if (aosDa)
+        {
+        const SVTK_TT *pDa = aosDa->GetPointer(0);
+        for (long i = 0; i < nVals; ++i)
+          {
+          if (!pGa || !pGa[i])
+            digest.Add(pDa[i]);
+          }
+        }
+      else
+        {
+        for (long i = 0; i < nVals; ++i)
+          {
+          if (!pGa || !pGa[i])
+            digest.Add(da->GetComponent(i, 0));
+          }
+        }
+    );
+    default:
+      {
+      SENSEI_ERROR("Unsupported dispatch " << da->GetClassName())
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+// **************************************************************************
+void Write(FILE *file, long step, double time, const std::string &meshName,
+  const std::string &arrayName, const sensei::Quantiles::Data &result)
+{
+  size_t nq = result.Quantile.size();
+  for (size_t i = 0; i < nq; ++i)
+    {
+    fprintf(file, "%ld, %0.10g, %s, %s, %ld, quantile, %0.6g, %0.10g\n", step,
+      time, meshName.c_str(), arrayName.c_str(), result.Count,
+      result.Quantile[i], result.Value[i]);
+    }
+
+  // the CDF at the thresholds are points on the same curve, the kind column
+  // tells them apart from the quantiles
+  size_t nt = result.Threshold.size();
+  for (size_t i = 0; i < nt; ++i)
+    {
+    fprintf(file, "%ld, %0.10g, %s, %s, %ld, cdf, %0.6g, %0.10g\n", step,
+      time, meshName.c_str(), arrayName.c_str(), result.Count,
+      result.Probability[i], result.Threshold[i]);
+    }
+}
+}
+
+namespace sensei
+{
+//-----------------------------------------------------------------------------
+senseiNewMacro(Quantiles);
+
+//-----------------------------------------------------------------------------
+Quantiles::Quantiles() : Association(svtkDataObject::FIELD_ASSOCIATION_POINTS),
+  NumberOfQuantiles(11), Compression(100.0), HeaderWritten(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+Quantiles::~Quantiles()
+{
+}
+
+//-----------------------------------------------------------------------------
+void Quantiles::Initialize(const std::string &meshName, int association,
+  const std::string &arrayName, int numberOfQuantiles, double compression,
+  const std::string &fileName)
+{
+  this->MeshName = meshName;
+  this->Association = association;
+  this->ArrayName = arrayName;
+  this->NumberOfQuantiles = numberOfQuantiles < 2 ? 2 : numberOfQuantiles;
+  this->Compression = compression;
+  this->FileName = fileName;
+  this->HeaderWritten = 0;
+}
+
+//-----------------------------------------------------------------------------
+void Quantiles::SetThresholds(const std::vector<double> &thresholds)
+{
+  this->Thresholds = thresholds;
+}
+
+//-----------------------------------------------------------------------------
+bool Quantiles::Execute(DataAdaptor* data, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("Quantiles::Execute");
+
+  // we do not return anything
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  // see what the simulation is providing
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(data))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  // get the mesh metadata object
+  MeshMetadataPtr mmd;
+  if (mdMap.GetMeshMetadata(this->MeshName, mmd))
+    {
+    SENSEI_ERROR("Failed to get metadata for mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  // get the mesh object
+  svtkDataObject *dobj = nullptr;
+  if (data->GetMesh(this->MeshName, true, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  int rank = 0;
+  MPI_Comm comm = this->GetCommunicator();
+  MPI_Comm_rank(comm, &rank);
+
+  TDigest digest(this->Compression);
+
+  // it is not an necessarilly an error if all ranks do not have a dataset
+  // to process. However, all ranks must participate in the reduction.
+  if (dobj)
+    {
+    // fetch the array
+    if (data->AddArray(dobj, this->MeshName, this->Association, this->ArrayName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add "
+        << SVTKUtils::GetAttributesName(this->Association)
+        << " data array \""  << this->ArrayName << "\"")
+      MPI_Abort(comm, -1);
+      return false;
+      }
+
+    // add the ghost zones
+    if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
+      data->AddGhostCellsArray(dobj, this->MeshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost cells.")
+      MPI_Abort(comm, -1);
+      return false;
+      }
+
+    if (mmd->NumGhostNodes && data->AddGhostNodesArray(dobj, this->MeshName))
+      {
+      SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
+      MPI_Abort(comm, -1);
+      return false;
+      }
+
+    // add all blocks of data to the digest
+    svtkCompositeDataSetPtr mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+    svtkSmartPointer<svtkCompositeDataIterator> iter;
+    iter.TakeReference(mesh->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+      svtkDataObject *curObj = iter->GetCurrentDataObject();
+
+      svtkDataArray* array = this->GetArray(curObj, this->ArrayName);
+      if (!array)
+        {
+        SENSEI_WARNING("Data block " << iter->GetCurrentFlatIndex()
+          << " of mesh \"" << this->MeshName << " has no array named \""
+          << this->ArrayName << "\"")
+        continue;
+        }
+
+      svtkUnsignedCharArray *ghostArray = dynamic_cast<svtkUnsignedCharArray*>(
+        this->GetArray(curObj, "svtkGhostType"));
+
+      if (::AddLocalData(array, ghostArray, digest))
+        {
+        SENSEI_ERROR("Failed to add array \"" << this->ArrayName
+          << "\" data block " << iter->GetCurrentFlatIndex() << " of mesh \""
+          << this->MeshName << "\"")
+        MPI_Abort(comm, -1);
+        return false;
+        }
+      }
+    }
+
+  // merge the digests. this is an MPI collective, all MPI ranks must
+  // participate. after this call returns MPI rank 0 holds the result
+  if (digest.Reduce(comm, 0))
+    {
+    SENSEI_ERROR("Failed to reduce the quantiles of array \""
+      << this->ArrayName << "\" of mesh \"" << this->MeshName << "\"")
+    MPI_Abort(comm, -1);
+    return false;
+    }
+
+  if (rank == 0)
+    {
+    Quantiles::Data result;
+    result.Count = digest.GetCount();
+    result.Min = result.Count ? digest.GetMin() : 0.0;
+    result.Max = result.Count ? digest.GetMax() : 0.0;
+
+    result.Quantile.resize(this->NumberOfQuantiles);
+    result.Value.resize(this->NumberOfQuantiles);
+    for (int i = 0; i < this->NumberOfQuantiles; ++i)
+      {
+      double q = double(i) / double(this->NumberOfQuantiles - 1);
+      result.Quantile[i] = q;
+      result.Value[i] = digest.Quantile(q);
+      }
+
+    size_t nThresholds = this->Thresholds.size();
+    result.Threshold = this->Thresholds;
+    result.Probability.resize(nThresholds);
+    for (size_t i = 0; i < nThresholds; ++i)
+      result.Probability[i] = digest.CDF(this->Thresholds[i]);
+
+    this->LastResult = result;
+
+    // write the results
+    long step = data->GetDataTimeStep();
+    double time = data->GetDataTime();
+
+    FILE *file = stdout;
+    if (!this->FileName.empty() && !(file =
+      fopen(this->FileName.c_str(), this->HeaderWritten ? "a" : "w")))
+      {
+      char *estr = strerror(errno);
+      SENSEI_ERROR("Failed to open \"" << this->FileName << "\""
+        << std::endl << estr)
+      return false;
+      }
+
+    if (!this->HeaderWritten)
+      {
+      fprintf(file, "# step, time, mesh, array, count, kind, probability, value\n");
+      this->HeaderWritten = 1;
+      }
+
+    ::Write(file, step, time, this->MeshName, this->ArrayName, result);
+
+    if (file == stdout)
+      fflush(file);
+    else
+      fclose(file);
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+svtkDataArray* Quantiles::GetArray(svtkDataObject* dobj, const std::string& arrayname)
+{
+  if (svtkFieldData* fd = dobj->GetAttributesAsFieldData(this->Association))
+    {
+    return fd->GetArray(arrayname.c_str());
+    }
+  return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+int Quantiles::GetQuantiles(Quantiles::Data &result)
+{
+  result = this->LastResult;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int Quantiles::Finalize()
+{
+  return 0;
+}
+
+}
@@ -0,0 +1,91 @@
+#ifndef sensei_Quantiles_h
+#define sensei_Quantiles_h
+
+#include "AnalysisAdaptor.h"
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+class svtkDataObject;
+class svtkDataArray;
+
+namespace sensei
+{
+
+/** Computes approximate quantiles, and thus the CDF, of an array in parallel.
+ * Each rank builds a t-digest (see sensei::TDigest) of its local, non-ghost,
+ * values in a single pass with bounded memory. The digests are merged to
+ * rank 0 in a single MPI reduction. The accuracy is controlled by the
+ * compression parameter, the memory used is proportional to it and
+ * independent of the number of values.
+ */
+class SENSEI_EXPORT Quantiles : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static Quantiles* New();
+
+  senseiTypeMacro(Quantiles, AnalysisAdaptor);
+
+  /** initialize for the run. The quantiles reported are numberOfQuantiles
+   * evenly spaced values from 0 to 1 inclusive. If a file name is given the
+   * results are appended to it as CSV, otherwise they are written to stdout.
+   * The columns are step, time, mesh, array, count, kind, probability and
+   * value. Rows of kind quantile hold a quantile and its value, rows of kind
+   * cdf hold the CDF at a threshold and the threshold.
+   */
+  void Initialize(const std::string &meshName, int association,
+    const std::string &arrayName, int numberOfQuantiles,
+    double compression, const std::string &fileName);
+
+  /** set values at which to report the CDF, the estimated fraction of
+   * values less than or equal to each. The default is none.
+   */
+  void SetThresholds(const std::vector<double> &thresholds);
+
+  /// compute the quantiles for this time step
+  bool Execute(DataAdaptor* data, DataAdaptor**) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+  /// the computed quantiles may be accessed through the following data structure.
+  struct Data
+  {
+      Data() : Count(0), Min(0.0), Max(0.0) {}
+
+      long Count;                   ///< The number of non-ghost values
+      double Min;                   ///< The smallest value
+      double Max;                   ///< The largest value
+      std::vector<double> Quantile; ///< The quantiles in [0, 1]
+      std::vector<double> Value;    ///< The value at each quantile
+      std::vector<double> Threshold;   ///< The values at which the CDF is reported
+      std::vector<double> Probability; ///< The CDF at each threshold
+  };
+
+  /// return the quantiles computed by the most recent call to Execute
+  int GetQuantiles(Quantiles::Data &data);
+
+protected:
+  Quantiles();
+  ~Quantiles();
+
+  Quantiles(const Quantiles&) = delete;
+  void operator=(const Quantiles&) = delete;
+
+  svtkDataArray* GetArray(svtkDataObject* dobj, const std::string& arrayname);
+
+  std::string MeshName;
+  std::string ArrayName;
+  int Association;
+  int NumberOfQuantiles;
+  double Compression;
+  std::vector<double> Thresholds;
+  std::string FileName;
+  int HeaderWritten;
+  Quantiles::Data LastResult;
+};
+
+}
+
+#endif
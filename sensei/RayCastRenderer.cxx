@@ -0,0 +1,1093 @@
+#include "RayCastRenderer.h"
+#include "DataAdaptor.h"
+#include "PNGUtils.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkImageData.h>
+#include <svtkRectilinearGrid.h>
+#include <svtkSmartPointer.h>
+
+#include <sdiy/master.hpp>
+#include <sdiy/assigner.hpp>
+#include <sdiy/decomposition.hpp>
+#include <sdiy/reduce.hpp>
+#include <sdiy/partners/swap.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+using Vec3 = std::array<double,3>;
+
+// **************************************************************************
+Vec3 operator+(const Vec3 &a, const Vec3 &b)
+{
+  return Vec3{{a[0] + b[0], a[1] + b[1], a[2] + b[2]}};
+}
+
+// **************************************************************************
+Vec3 operator-(const Vec3 &a, const Vec3 &b)
+{
+  return Vec3{{a[0] - b[0], a[1] - b[1], a[2] - b[2]}};
+}
+
+// **************************************************************************
+Vec3 operator*(double s, const Vec3 &a)
+{
+  return Vec3{{s*a[0], s*a[1], s*a[2]}};
+}
+
+// **************************************************************************
+double Dot(const Vec3 &a, const Vec3 &b)
+{
+  return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+}
+
+// **************************************************************************
+Vec3 Cross(const Vec3 &a, const Vec3 &b)
+{
+  return Vec3{{a[1]*b[2] - a[2]*b[1], a[2]*b[0] - a[0]*b[2],
+    a[0]*b[1] - a[1]*b[0]}};
+}
+
+// **************************************************************************
+Vec3 Normalize(const Vec3 &a)
+{
+  double len = std::sqrt(Dot(a, a));
+  return len > 0.0 ? (1.0/len)*a : a;
+}
+
+// **************************************************************************
+/// rotate a point about an axis through the center by an angle in degrees
+Vec3 Rotate(const Vec3 &axis, double angle, const Vec3 &center, const Vec3 &point)
+{
+  double theta = M_PI*angle/180.0;
+  double c = std::cos(theta);
+  double s = std::sin(theta);
+
+  Vec3 k = Normalize(axis);
+  Vec3 v = point - center;
+
+  // Rodrigues' rotation formula
+  Vec3 r = c*v + s*Cross(k, v) + ((1.0 - c)*Dot(k, v))*k;
+
+  return r + center;
+}
+
+// **************************************************************************
+/// a block of an image or rectilinear mesh and the scalar to render
+struct Block
+{
+  Block() : CellData(false), Bounds{{0.0, 0.0, 0.0, 0.0, 0.0, 0.0}} {}
+
+  std::array<std::vector<double>,3> X;
+  std::vector<double> Values;
+  bool CellData;
+  std::array<double,6> Bounds;
+};
+
+// **************************************************************************
+/** locate the interval of the coordinate array containing p. The result is
+ * clamped to the array so that points on the boundary, or just outside of it,
+ * are handled.
+ */
+void Locate(const std::vector<double> &x, double p, long &i, double &f)
+{
+  long n = x.size();
+  if (n < 2)
+    {
+    i = 0;
+    f = 0.0;
+    return;
+    }
+
+  i = std::upper_bound(x.begin(), x.end(), p) - x.begin() - 1;
+  i = std::max(0l, std::min(i, n - 2));
+
+  f = (p - x[i])/(x[i+1] - x[i]);
+  f = std::max(0.0, std::min(f, 1.0));
+}
+
+// **************************************************************************
+/** sample the scalar at a point. point data is interpolated trilinearly,
+ * cell data takes the value of the cell containing the point.
+ */
+double Sample(const Block &b, const Vec3 &p)
+{
+  long i[3];
+  double f[3];
+  for (int d = 0; d < 3; ++d)
+    Locate(b.X[d], p[d], i[d], f[d]);
+
+  long nx = b.X[0].size();
+  long ny = b.X[1].size();
+  long nz = b.X[2].size();
+
+  if (b.CellData)
+    {
+    long cnx = std::max(nx - 1, 1l);
+    long cny = std::max(ny - 1, 1l);
+    return b.Values[(i[2]*cny + i[1])*cnx + i[0]];
+    }
+
+  long di = nx > 1 ? 1 : 0;
+  long dj = ny > 1 ? nx : 0;
+  long dk = nz > 1 ? nx*ny : 0;
+
+  const double *v = b.Values.data() + (i[2]*ny + i[1])*nx + i[0];
+
+  double c00 = v[0]*(1.0 - f[0]) + v[di]*f[0];
+  double c10 = v[dj]*(1.0 - f[0]) + v[dj + di]*f[0];
+  double c01 = v[dk]*(1.0 - f[0]) + v[dk + di]*f[0];
+  double c11 = v[dk + dj]*(1.0 - f[0]) + v[dk + dj + di]*f[0];
+
+  double c0 = c00*(1.0 - f[1]) + c10*f[1];
+  double c1 = c01*(1.0 - f[1]) + c11*f[1];
+
+  return c0*(1.0 - f[2]) + c1*f[2];
+}
+
+// **************************************************************************
+/// intersect a ray with a box. returns true if the ray enters the box
+bool Intersect(const std::array<double,6> &bds, const Vec3 &o, const Vec3 &dir,
+  double &t0, double &t1)
+{
+  t0 = 0.0;
+  t1 = std::numeric_limits<double>::max();
+
+  for (int d = 0; d < 3; ++d)
+    {
+    if (std::abs(dir[d]) < 1e-300)
+      {
+      if ((o[d] < bds[2*d]) || (o[d] > bds[2*d+1]))
+        return false;
+      continue;
+      }
+
+    double ta = (bds[2*d] - o[d])/dir[d];
+    double tb = (bds[2*d+1] - o[d])/dir[d];
+    if (ta > tb)
+      std::swap(ta, tb);
+
+    t0 = std::max(t0, ta);
+    t1 = std::min(t1, tb);
+
+    if (t1 < t0)
+      return false;
+    }
+
+  return true;
+}
+
+// **************************************************************************
+/// a diverging blue to red color map
+Vec3 ColorMap(double t)
+{
+  static const Vec3 cm[3] = {{{0.230, 0.299, 0.754}},
+    {{0.865, 0.865, 0.865}}, {{0.706, 0.016, 0.150}}};
+
+  t = std::max(0.0, std::min(t, 1.0));
+
+  int i = t < 0.5 ? 0 : 1;
+  double f = 2.0*t - i;
+
+  return (1.0 - f)*cm[i] + f*cm[i+1];
+}
+
+// the number of floats per pixel, premultiplied r, g, b, the opacity, and
+// the depth of the nearest contribution
+constexpr int PIXEL_SIZE = 5;
+
+// **************************************************************************
+/// composite pixel b into pixel a. the nearest of the two is in front
+void Composite(float *a, const float *b)
+{
+  if (b[3] <= 0.0f)
+    return;
+
+  if (a[3] <= 0.0f)
+    {
+    for (int i = 0; i < PIXEL_SIZE; ++i)
+      a[i] = b[i];
+    return;
+    }
+
+  const float *f = a[4] <= b[4] ? a : b;
+  const float *k = a[4] <= b[4] ? b : a;
+
+  float t = 1.0f - f[3];
+
+  float out[PIXEL_SIZE] = {f[0] + t*k[0], f[1] + t*k[1], f[2] + t*k[2],
+    f[3] + t*k[3], f[4]};
+
+  for (int i = 0; i < PIXEL_SIZE; ++i)
+    a[i] = out[i];
+}
+
+// **************************************************************************
+/// composite pixel b, which is behind, into pixel a
+void Over(float *a, const float *b)
+{
+  float t = 1.0f - a[3];
+  for (int i = 0; i < 4; ++i)
+    a[i] += t*b[i];
+  a[4] = std::min(a[4], b[4]);
+}
+
+// **************************************************************************
+/// assigns block ids to ranks in the order of their visibility
+class VisibilityAssigner : public sdiy::StaticAssigner
+{
+public:
+  VisibilityAssigner(int nRanks) : sdiy::StaticAssigner(nRanks, nRanks),
+    Order(nRanks)
+  {
+    for (int i = 0; i < nRanks; ++i)
+      this->Order[i] = i;
+  }
+
+  int rank(int gid) const override { return this->Order[gid]; }
+
+  void local_gids(int rank, std::vector<int> &gids) const override
+  {
+    gids.assign(1, std::find(this->Order.begin(), this->Order.end(), rank)
+      - this->Order.begin());
+  }
+
+  // the rank holding each block
+  std::vector<int> Order;
+};
+
+// **************************************************************************
+/// copy the first component of an array into a vector of doubles
+void ToDouble(svtkDataArray *da, std::vector<double> &out)
+{
+  long nTups = da->GetNumberOfTuples();
+  int nComps = da->GetNumberOfComponents();
+
+  out.resize(nTups);
+
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+      if (aosDa)
+        {
+        const SVTK_TT *pDa = aosDa->GetPointer(0);
+        for (long i = 0; i < nTups; ++i)
+          out[i] = pDa[i*nComps];
+        }
+      else
+        {
+        for (long i = 0; i < nTups; ++i)
+          out[i] = da->GetComponent(i, 0);
+        }
+    );
+    }
+}
+
+// **************************************************************************
+/// a piece of the image, pixels [Begin, End), during compositing
+struct ImageBlock
+{
+  static void *create() { return new ImageBlock; }
+  static void destroy(void *b) { delete static_cast<ImageBlock*>(b); }
+
+  ImageBlock() : Begin(0), End(0) {}
+
+  long Begin;
+  long End;
+  std::vector<float> Pixels;
+};
+
+// **************************************************************************
+/// the state shared by the threads casting rays
+struct RenderState
+{
+  int Mode;
+  int Width;
+  int Height;
+  double Lo;
+  double Hi;
+  double Opacity;
+  double IsoValue;
+  int SliceAxis;
+  double SlicePosition;
+  double Step;
+  Vec3 Position;
+  Vec3 Dir;
+  Vec3 Right;
+  Vec3 Up;
+  double TanHalf;
+};
+
+// **************************************************************************
+/// cast a ray through a block. returns true if the ray hit something
+bool CastRay(const RenderState &rs, const Block &b, const Vec3 &dir, float *px)
+{
+  double t0 = 0.0;
+  double t1 = 0.0;
+
+  if (rs.Mode == sensei::RayCastRenderer::MODE_SLICE)
+    {
+    int a = rs.SliceAxis;
+    if (std::abs(dir[a]) < 1e-300)
+      return false;
+
+    double t = (rs.SlicePosition - rs.Position[a])/dir[a];
+    if (t < 0.0)
+      return false;
+
+    Vec3 p = rs.Position + t*dir;
+    for (int d = 0; d < 3; ++d)
+      {
+      double eps = 1e-9*(b.Bounds[2*d+1] - b.Bounds[2*d]);
+      if ((p[d] < b.Bounds[2*d] - eps) || (p[d] > b.Bounds[2*d+1] + eps))
+        return false;
+      }
+
+    Vec3 c = ColorMap((Sample(b, p) - rs.Lo)/(rs.Hi - rs.Lo));
+
+    px[0] = c[0];
+    px[1] = c[1];
+    px[2] = c[2];
+    px[3] = 1.0f;
+    px[4] = t;
+
+    return true;
+    }
+
+  if (!Intersect(b.Bounds, rs.Position, dir, t0, t1))
+    return false;
+
+  if (rs.Mode == sensei::RayCastRenderer::MODE_VOLUME)
+    {
+    // front to back emission absorption. the samples are placed at the same
+    // distances along the ray in all blocks so that the result does not
+    // depend on the decomposition
+    double rgba[4] = {0.0, 0.0, 0.0, 0.0};
+    double k0 = std::ceil(t0/rs.Step - 0.5);
+    for (double t = (k0 + 0.5)*rs.Step; (t < t1) && (rgba[3] < 0.995); t += rs.Step)
+      {
+      double s = (Sample(b, rs.Position + t*dir) - rs.Lo)/(rs.Hi - rs.Lo);
+      s = std::max(0.0, std::min(s, 1.0));
+
+      double alpha = 1.0 - std::exp(-rs.Opacity*s*rs.Step);
+      double w = (1.0 - rgba[3])*alpha;
+
+      Vec3 c = ColorMap(s);
+
+      rgba[0] += w*c[0];
+      rgba[1] += w*c[1];
+      rgba[2] += w*c[2];
+      rgba[3] += w;
+      }
+
+    if (rgba[3] <= 0.0)
+      return false;
+
+    px[0] = rgba[0];
+    px[1] = rgba[1];
+    px[2] = rgba[2];
+    px[3] = rgba[3];
+    px[4] = t0;
+
+    return true;
+    }
+
+  // the first crossing of the isovalue. as above the samples are placed at
+  // the same distances in all blocks, plus the points where the ray enters
+  // and leaves the block
+  double tPrev = t0;
+  double sPrev = Sample(b, rs.Position + t0*dir) - rs.IsoValue;
+  double k = std::floor(t0/rs.Step);
+  while (tPrev < t1)
+    {
+    k += 1.0;
+    double t = std::min(k*rs.Step, t1);
+    double s = Sample(b, rs.Position + t*dir) - rs.IsoValue;
+
+    if (((sPrev <= 0.0) && (s >= 0.0)) || ((sPrev >= 0.0) && (s <= 0.0)))
+      {
+      double tHit = s == sPrev ? tPrev : tPrev + sPrev/(sPrev - s)*(t - tPrev);
+      Vec3 p = rs.Position + tHit*dir;
+
+      // shade with a head light using the gradient as the normal. the
+      // differences are one sided at the faces of the block
+      Vec3 grad;
+      double h = 0.5*rs.Step;
+      for (int d = 0; d < 3; ++d)
+        {
+        Vec3 pa = p;
+        Vec3 pb = p;
+        pa[d] = std::max(p[d] - h, b.Bounds[2*d]);
+        pb[d] = std::min(p[d] + h, b.Bounds[2*d+1]);
+        grad[d] = pb[d] > pa[d] ? (Sample(b, pb) - Sample(b, pa))/(pb[d] - pa[d]) : 0.0;
+        }
+
+      double len = std::sqrt(Dot(grad, grad));
+      double shade = len > 0.0 ? 0.2 + 0.8*std::abs(Dot(grad, dir))/len : 1.0;
+
+      Vec3 c = ColorMap((rs.IsoValue - rs.Lo)/(rs.Hi - rs.Lo));
+
+      px[0] = shade*c[0];
+      px[1] = shade*c[1];
+      px[2] = shade*c[2];
+      px[3] = 1.0f;
+      px[4] = tHit;
+
+      return true;
+      }
+
+    tPrev = t;
+    sPrev = s;
+    }
+
+  return false;
+}
+
+// **************************************************************************
+/// render rows [j0, j1) of the local blocks
+void Render(const RenderState &rs, const std::vector<Block> &blocks,
+  long j0, long j1, float *pixels)
+{
+  double aspect = double(rs.Width)/rs.Height;
+
+  float frag[PIXEL_SIZE];
+
+  for (long j = j0; j < j1; ++j)
+    {
+    double sy = (1.0 - 2.0*(j + 0.5)/rs.Height)*rs.TanHalf;
+
+    for (long i = 0; i < rs.Width; ++i)
+      {
+      double sx = (2.0*(i + 0.5)/rs.Width - 1.0)*rs.TanHalf*aspect;
+
+      Vec3 dir = Normalize(rs.Dir + sx*rs.Right + sy*rs.Up);
+
+      float *px = pixels + PIXEL_SIZE*(j*rs.Width + i);
+
+      size_t nBlocks = blocks.size();
+      for (size_t q = 0; q < nBlocks; ++q)
+        {
+        if (CastRay(rs, blocks[q], dir, frag))
+          Composite(px, frag);
+        }
+      }
+    }
+}
+}
+
+namespace sensei
+{
+
+//----------------------------------------------------------------------------
+senseiNewMacro(RayCastRenderer);
+
+//----------------------------------------------------------------------------
+RayCastRenderer::RayCastRenderer() : MeshName("mesh"), ArrayName(),
+  Association(svtkDataObject::POINT), Mode(MODE_VOLUME), Width(512),
+  Height(512), HaveScalarRange(false), ScalarRange{{0.0, 1.0}}, Opacity(1.0),
+  IsoValue(0.0), SliceAxis(2), SlicePosition(0.0), SampleDistance(0.0),
+  Background{{0.0, 0.0, 0.0}}, HaveCamera(false),
+  Camera{{0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0}}, Views(),
+  ViewAngle(30.0), Radix(2), NumberOfThreads(1), FilePrefix(), Image()
+{
+}
+
+//----------------------------------------------------------------------------
+RayCastRenderer::~RayCastRenderer()
+{
+}
+
+//----------------------------------------------------------------------------
+int RayCastRenderer::GetMode(const std::string &name, int &mode)
+{
+  if (name == "volume")
+    {
+    mode = MODE_VOLUME;
+    }
+  else if (name == "isosurface")
+    {
+    mode = MODE_ISOSURFACE;
+    }
+  else if (name == "slice")
+    {
+    mode = MODE_SLICE;
+    }
+  else
+    {
+    SENSEI_ERROR("Invalid mode \"" << name << "\". Use one of volume,"
+      " isosurface, or slice")
+    return -1;
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int RayCastRenderer::SetMode(int mode)
+{
+  if ((mode != MODE_VOLUME) && (mode != MODE_ISOSURFACE) && (mode != MODE_SLICE))
+    {
+    SENSEI_ERROR("Invalid mode " << mode)
+    return -1;
+    }
+
+  this->Mode = mode;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int RayCastRenderer::SetImageSize(int width, int height)
+{
+  if ((width < 1) || (height < 1))
+    {
+    SENSEI_ERROR("Invalid image size " << width << "x" << height)
+    return -1;
+    }
+
+  this->Width = width;
+  this->Height = height;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void RayCastRenderer::SetScalarRange(double lo, double hi)
+{
+  this->ScalarRange = {{lo, hi}};
+  this->HaveScalarRange = true;
+}
+
+//----------------------------------------------------------------------------
+int RayCastRenderer::SetSlice(int axis, double position)
+{
+  if ((axis < 0) || (axis > 2))
+    {
+    SENSEI_ERROR("Invalid slice axis " << axis)
+    return -1;
+    }
+
+  this->SliceAxis = axis;
+  this->SlicePosition = position;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void RayCastRenderer::SetCamera(const std::array<double,3> &position,
+  const std::array<double,3> &focalPoint, const std::array<double,3> &viewUp)
+{
+  for (int i = 0; i < 3; ++i)
+    {
+    this->Camera[i] = position[i];
+    this->Camera[3 + i] = focalPoint[i];
+    this->Camera[6 + i] = viewUp[i];
+    }
+
+  this->HaveCamera = true;
+}
+
+//----------------------------------------------------------------------------
+int RayCastRenderer::SetCameraConfig(const std::string &config)
+{
+  this->Views.clear();
+
+  std::vector<std::string> args;
+  std::istringstream iss(config);
+  std::string arg;
+  while (std::getline(iss, arg, ':'))
+    args.push_back(arg);
+
+  if (args.empty() || (args[0] == "none"))
+    return 0;
+
+  std::vector<std::vector<double>> vals;
+  for (size_t i = 1; i < args.size(); ++i)
+    {
+    vals.emplace_back();
+    std::istringstream vss(args[i]);
+    std::string val;
+    while (std::getline(vss, val, ','))
+      vals.back().push_back(atof(val.c_str()));
+    }
+
+  if ((args[0] != "spherical") || (vals.size() != 5) || (vals[0].size() != 3) ||
+    (vals[1].size() != 3) || (vals[2].size() != 3))
+    {
+    SENSEI_ERROR("Invalid camera configuration \"" << config << "\". Expected"
+      " spherical:fx,fy,fz:px,py,pz:ux,uy,uz:phi0,phi1,...:theta0,theta1,...")
+    return -1;
+    }
+
+  Vec3 focal{{vals[0][0], vals[0][1], vals[0][2]}};
+  Vec3 position{{vals[1][0], vals[1][1], vals[1][2]}};
+  Vec3 viewUp{{vals[2][0], vals[2][1], vals[2][2]}};
+
+  // the same orbit as sensei::CinemaHelper. rotate about the view up by phi
+  // then about the horizontal axis by theta
+  Vec3 center{{0.0, 0.0, 0.0}};
+  for (double theta : vals[4])
+    {
+    for (double phi : vals[3])
+      {
+      Vec3 phiPos = Rotate(viewUp, -phi, focal, position);
+      Vec3 thetaAxis = Normalize(Cross(viewUp, focal - phiPos));
+      Vec3 pos = Rotate(thetaAxis, theta, focal, phiPos);
+      Vec3 up = Rotate(thetaAxis, theta, center, viewUp);
+
+      std::array<double,9> view;
+      for (int i = 0; i < 3; ++i)
+        {
+        view[i] = pos[i];
+        view[3 + i] = focal[i];
+        view[6 + i] = up[i];
+        }
+
+      this->Views.push_back(view);
+      }
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int RayCastRenderer::SetRadix(int k)
+{
+  if (k < 2)
+    {
+    SENSEI_ERROR("Invalid radix " << k << ". The radix must be at least 2")
+    return -1;
+    }
+
+  this->Radix = k;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool RayCastRenderer::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("RayCastRenderer::Execute");
+
+  // we do not return anything
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  // get the local blocks
+  svtkDataObject *dobj = nullptr;
+  if (dataIn->GetMesh(this->MeshName, false, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << this->MeshName << "\"")
+    return false;
+    }
+
+  std::vector<Block> blocks;
+  if (dobj)
+    {
+    if (dataIn->AddArray(dobj, this->MeshName, this->Association, this->ArrayName))
+      {
+      SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add "
+        << SVTKUtils::GetAttributesName(this->Association)
+        << " data array \"" << this->ArrayName << "\"")
+      dobj->Delete();
+      return false;
+      }
+
+    // the composite wrapper takes ownership
+    svtkCompositeDataSetPtr mesh = SVTKUtils::AsCompositeData(comm, dobj, true);
+
+    svtkSmartPointer<svtkCompositeDataIterator> iter;
+    iter.TakeReference(mesh->NewIterator());
+    for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+      {
+      svtkDataSet *ds = dynamic_cast<svtkDataSet*>(iter->GetCurrentDataObject());
+
+      Block b;
+      if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+        {
+        int ext[6];
+        double x0[3];
+        double dx[3];
+        im->GetExtent(ext);
+        im->GetOrigin(x0);
+        im->GetSpacing(dx);
+
+        for (int d = 0; d < 3; ++d)
+          {
+          for (int i = ext[2*d]; i <= ext[2*d+1]; ++i)
+            b.X[d].push_back(x0[d] + i*dx[d]);
+          }
+        }
+      else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+        {
+        ::ToDouble(rg->GetXCoordinates(), b.X[0]);
+        ::ToDouble(rg->GetYCoordinates(), b.X[1]);
+        ::ToDouble(rg->GetZCoordinates(), b.X[2]);
+        }
+      else
+        {
+        SENSEI_ERROR("Block " << iter->GetCurrentFlatIndex() << " of mesh \""
+          << this->MeshName << "\" is a " << (ds ? ds->GetClassName() : "nullptr")
+          << ". Only image and rectilinear meshes are supported")
+        return false;
+        }
+
+      if (b.X[0].empty() || b.X[1].empty() || b.X[2].empty())
+        continue;
+
+      svtkDataArray *da = ds->GetAttributes(this->Association)->GetArray(
+        this->ArrayName.c_str());
+      if (!da)
+        {
+        SENSEI_ERROR("Block " << iter->GetCurrentFlatIndex() << " of mesh \""
+          << this->MeshName << "\" has no array named \"" << this->ArrayName << "\"")
+        return false;
+        }
+
+      ::ToDouble(da, b.Values);
+      b.CellData = this->Association == svtkDataObject::CELL;
+
+      for (int d = 0; d < 3; ++d)
+        {
+        b.Bounds[2*d] = b.X[d].front();
+        b.Bounds[2*d+1] = b.X[d].back();
+        }
+
+      blocks.push_back(std::move(b));
+      }
+    }
+
+  // the scalar range, the bounds, and the smallest grid spacing are reduced
+  // with max in a single collective
+  double localVals[9];
+  for (int i = 0; i < 9; ++i)
+    localVals[i] = std::numeric_limits<double>::lowest();
+
+  for (const Block &b : blocks)
+    {
+    for (double v : b.Values)
+      {
+      localVals[0] = std::max(localVals[0], -v);
+      localVals[1] = std::max(localVals[1], v);
+      }
+
+    for (int d = 0; d < 3; ++d)
+      {
+      localVals[2 + 2*d] = std::max(localVals[2 + 2*d], -b.Bounds[2*d]);
+      localVals[3 + 2*d] = std::max(localVals[3 + 2*d], b.Bounds[2*d+1]);
+
+      long n = b.X[d].size();
+      for (long i = 1; i < n; ++i)
+        localVals[8] = std::max(localVals[8], b.X[d][i-1] - b.X[d][i]);
+      }
+    }
+
+  double globalVals[9];
+  MPI_Allreduce(localVals, globalVals, 9, MPI_DOUBLE, MPI_MAX, comm);
+
+  if (globalVals[1] == std::numeric_limits<double>::lowest())
+    {
+    SENSEI_WARNING("Nothing to render, mesh \"" << this->MeshName
+      << "\" is empty")
+    return true;
+    }
+
+  // the bounds of each rank's data, used to order the ranks by visibility
+  std::array<double,6> localBds{{1.0, -1.0, 1.0, -1.0, 1.0, -1.0}};
+  for (const Block &b : blocks)
+    {
+    bool first = localBds[1] < localBds[0];
+    for (int d = 0; d < 3; ++d)
+      {
+      localBds[2*d] = first ? b.Bounds[2*d] : std::min(localBds[2*d], b.Bounds[2*d]);
+      localBds[2*d+1] = first ? b.Bounds[2*d+1] : std::max(localBds[2*d+1], b.Bounds[2*d+1]);
+      }
+    }
+
+  std::vector<double> rankBounds(6*nRanks);
+  MPI_Allgather(localBds.data(), 6, MPI_DOUBLE, rankBounds.data(), 6,
+    MPI_DOUBLE, comm);
+
+  RenderState rs;
+  rs.Mode = this->Mode;
+  rs.Width = this->Width;
+  rs.Height = this->Height;
+  rs.Lo = this->HaveScalarRange ? this->ScalarRange[0] : -globalVals[0];
+  rs.Hi = this->HaveScalarRange ? this->ScalarRange[1] : globalVals[1];
+  if (!(rs.Hi > rs.Lo))
+    rs.Hi = rs.Lo + 1.0;
+  rs.Opacity = this->Opacity;
+  rs.IsoValue = this->IsoValue;
+  rs.SliceAxis = this->SliceAxis;
+  rs.SlicePosition = this->SlicePosition;
+  rs.TanHalf = std::tan(0.5*M_PI*this->ViewAngle/180.0);
+
+  double minSpacing = -globalVals[8];
+  rs.Step = this->SampleDistance > 0.0 ? this->SampleDistance :
+    (minSpacing > 0.0 ? 0.5*minSpacing : 1.0);
+
+  // the views to render. by default look down the z-axis at the whole mesh
+  std::vector<std::array<double,9>> views = this->Views;
+  if (views.empty() && this->HaveCamera)
+    {
+    views.push_back(this->Camera);
+    }
+  else if (views.empty())
+    {
+    Vec3 center;
+    double diag = 0.0;
+    for (int d = 0; d < 3; ++d)
+      {
+      double lo = -globalVals[2 + 2*d];
+      double hi = globalVals[3 + 2*d];
+      center[d] = 0.5*(lo + hi);
+      diag += (hi - lo)*(hi - lo);
+      }
+    diag = std::sqrt(diag);
+
+    double dist = 0.5*diag/std::sin(0.5*M_PI*this->ViewAngle/180.0);
+
+    views.push_back({{center[0], center[1], center[2] + dist,
+      center[0], center[1], center[2], 0.0, 1.0, 0.0}});
+    }
+
+  long nPix = long(this->Width)*this->Height;
+  int nThreads = std::max(1, this->NumberOfThreads);
+
+  int nViews = views.size();
+  for (int v = 0; v < nViews; ++v)
+    {
+    const std::array<double,9> &view = views[v];
+
+    rs.Position = Vec3{{view[0], view[1], view[2]}};
+    rs.Dir = Normalize(Vec3{{view[3], view[4], view[5]}} - rs.Position);
+    rs.Right = Normalize(Cross(rs.Dir, Vec3{{view[6], view[7], view[8]}}));
+    rs.Up = Cross(rs.Right, rs.Dir);
+
+    // cast rays through the local blocks
+    std::vector<float> pixels(PIXEL_SIZE*nPix, 0.0f);
+    {
+    TimeEvent<128> mark2("RayCastRenderer::Render");
+
+    auto work = [&](int tid)
+    {
+      long nPer = this->Height / nThreads;
+      long nLarge = this->Height % nThreads;
+      long j0 = nPer*tid + std::min<long>(tid, nLarge);
+      long j1 = j0 + nPer + (tid < nLarge ? 1 : 0);
+
+      ::Render(rs, blocks, j0, j1, pixels.data());
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nThreads - 1);
+    for (int i = 1; i < nThreads; ++i)
+      threads.emplace_back(work, i);
+
+    work(0);
+
+    for (int i = 0; i < nThreads - 1; ++i)
+      threads[i].join();
+    }
+
+    // composite. the ranks are ordered front to back by the distance from
+    // the camera to the center of their data, and the sdiy block ids follow
+    // that order so that each group of partners covers a contiguous range
+    // of depths. in each round the piece of the image is split among the
+    // members of the group, each keeping one part and receiving the
+    // matching part from the others.
+    TimeEvent<128> mark3("RayCastRenderer::Composite");
+
+    std::vector<double> dist(nRanks);
+    for (int i = 0; i < nRanks; ++i)
+      {
+      const double *bds = rankBounds.data() + 6*i;
+      if (bds[1] < bds[0])
+        {
+        dist[i] = std::numeric_limits<double>::max();
+        continue;
+        }
+
+      Vec3 c{{0.5*(bds[0] + bds[1]), 0.5*(bds[2] + bds[3]), 0.5*(bds[4] + bds[5])}};
+      Vec3 dc = c - rs.Position;
+      dist[i] = Dot(dc, dc);
+      }
+
+    VisibilityAssigner assigner(nRanks);
+    std::stable_sort(assigner.Order.begin(), assigner.Order.end(),
+      [&dist](int a, int b) -> bool { return dist[a] < dist[b]; });
+
+    int gid = std::find(assigner.Order.begin(), assigner.Order.end(), rank)
+      - assigner.Order.begin();
+
+    sdiy::Master master(comm, 1, -1, &ImageBlock::create, &ImageBlock::destroy);
+
+    ImageBlock *ib = new ImageBlock;
+    ib->Begin = 0;
+    ib->End = nPix;
+    ib->Pixels.swap(pixels);
+    master.add(gid, ib, new sdiy::Link);
+
+    sdiy::DiscreteBounds domain;
+    domain.min[0] = 0;
+    domain.max[0] = nRanks - 1;
+
+    sdiy::RegularDecomposer<sdiy::DiscreteBounds> decomposer(1, domain, nRanks);
+    sdiy::RegularSwapPartners partners(decomposer, this->Radix, true);
+
+    bool depthTest = this->Mode != MODE_VOLUME;
+
+    sdiy::reduce(master, assigner, partners,
+      [depthTest](ImageBlock *b, const sdiy::ReduceProxy &rp,
+        const sdiy::RegularSwapPartners &)
+      {
+      // blend the parts of the group front to back, in the order of the
+      // block ids. surfaces are opaque and use the depth instead.
+      std::vector<int> gids;
+      int nIn = rp.in_link().size();
+      for (int i = 0; i < nIn; ++i)
+        gids.push_back(rp.in_link().target(i).gid);
+
+      if (nIn)
+        {
+        if (std::find(gids.begin(), gids.end(), rp.gid()) == gids.end())
+          gids.push_back(rp.gid());
+
+        std::sort(gids.begin(), gids.end());
+
+        long n = b->End - b->Begin;
+        std::vector<float> out(PIXEL_SIZE*n, 0.0f);
+        for (int gid : gids)
+          {
+          std::vector<float> in;
+          if (gid == rp.gid())
+            in.swap(b->Pixels);
+          else
+            rp.dequeue(gid, in);
+
+          for (long p = 0; p < n; ++p)
+            {
+            if (depthTest)
+              Composite(out.data() + PIXEL_SIZE*p, in.data() + PIXEL_SIZE*p);
+            else
+              Over(out.data() + PIXEL_SIZE*p, in.data() + PIXEL_SIZE*p);
+            }
+          }
+
+        b->Pixels.swap(out);
+        }
+
+      // split the piece among the members of the next group
+      int nOut = rp.out_link().size();
+      if (!nOut)
+        return;
+
+      long n = b->End - b->Begin;
+      long begin = b->Begin;
+      long end = b->End;
+      std::vector<float> keep;
+      for (int i = 0; i < nOut; ++i)
+        {
+        long p0 = n*i/nOut;
+        long p1 = n*(i + 1)/nOut;
+
+        std::vector<float> part(b->Pixels.begin() + PIXEL_SIZE*p0,
+          b->Pixels.begin() + PIXEL_SIZE*p1);
+
+        sdiy::BlockID dest = rp.out_link().target(i);
+        if (dest.gid == rp.gid())
+          {
+          begin = b->Begin + p0;
+          end = b->Begin + p1;
+          keep.swap(part);
+          }
+        else
+          {
+          rp.enqueue(dest, part);
+          }
+        }
+
+      b->Begin = begin;
+      b->End = end;
+      b->Pixels.swap(keep);
+      });
+
+    // blend with the background and gather the pieces on rank 0
+    ImageBlock *b = master.block<ImageBlock>(0);
+
+    long n = b->End - b->Begin;
+    std::vector<unsigned char> piece(4*n);
+    for (long p = 0; p < n; ++p)
+      {
+      const float *px = b->Pixels.data() + PIXEL_SIZE*p;
+      for (int c = 0; c < 3; ++c)
+        {
+        double val = px[c] + (1.0 - px[3])*this->Background[c];
+        piece[4*p + c] = std::max(0.0, std::min(255.0, std::round(255.0*val)));
+        }
+      piece[4*p + 3] = 255;
+      }
+
+    int range[2] = {int(4*b->Begin), int(4*n)};
+    std::vector<int> ranges(2*nRanks);
+    MPI_Gather(range, 2, MPI_INT, ranges.data(), 2, MPI_INT, 0, comm);
+
+    std::vector<int> counts(nRanks);
+    std::vector<int> displs(nRanks);
+    for (int i = 0; i < nRanks; ++i)
+      {
+      displs[i] = ranges[2*i];
+      counts[i] = ranges[2*i + 1];
+      }
+
+    if (rank == 0)
+      this->Image.resize(4*nPix);
+
+    MPI_Gatherv(piece.data(), 4*n, MPI_UNSIGNED_CHAR, this->Image.data(),
+      counts.data(), displs.data(), MPI_UNSIGNED_CHAR, 0, comm);
+
+    if ((rank == 0) && !this->FilePrefix.empty())
+      {
+      std::ostringstream oss;
+      oss << this->FilePrefix << "_" << dataIn->GetDataTimeStep()
+        << "_" << v << ".png";
+
+      if (PNGUtils::WriteRGBA(oss.str(), this->Width, this->Height,
+        this->Image.data()))
+        {
+        SENSEI_ERROR("Failed to write image \"" << oss.str() << "\"")
+        return false;
+        }
+      }
+    }
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int RayCastRenderer::Finalize()
+{
+  return 0;
+}
+
+}
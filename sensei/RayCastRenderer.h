@@ -0,0 +1,153 @@
+#ifndef sensei_RayCastRenderer_h
+#define sensei_RayCastRenderer_h
+
+#include "AnalysisAdaptor.h"
+
+#include <mpi.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/** A lightweight CPU renderer for image and rectilinear meshes that has no
+ * dependencies beyond SENSEI itself. A scalar array is rendered by ray
+ * casting either as a volume, as an isosurface, or as an axis aligned slice.
+ *
+ * Rendering is sort-last. Each rank ray casts its local blocks into a full
+ * size image in which each pixel carries a premultiplied color, an opacity,
+ * and the distance along the ray to the nearest contribution. The images are
+ * then composited with sdiy's swap reduction, binary-swap when the radix is 2
+ * and radix-k otherwise. In each round a rank exchanges a part of its image
+ * with its partners, so that the work and the message sizes shrink with each
+ * round and no rank ever receives more than an image's worth of data.
+ * Pixels are blended front to back in the order of their depth, which is
+ * exact when the blocks of each rank are crossed by each ray in one
+ * contiguous run as is the case with the usual regular decompositions. The
+ * pieces of the final image are gathered on rank 0 and written as PNG.
+ *
+ * The camera is either positioned automatically to view the whole mesh, or
+ * set explicitly. A series of views orbiting the focal point can be given
+ * using the same "spherical" camera configuration as sensei::CinemaHelper.
+ */
+class SENSEI_EXPORT RayCastRenderer : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static RayCastRenderer *New();
+
+  senseiTypeMacro(RayCastRenderer, AnalysisAdaptor);
+
+  /// the supported rendering modes
+  enum {MODE_VOLUME, MODE_ISOSURFACE, MODE_SLICE};
+
+  /// convert a mode name, volume, isosurface, or slice into an enum. returns 0 if successful
+  static int GetMode(const std::string &name, int &mode);
+
+  /// set the mesh and the array to render
+  void SetMeshName(const std::string &name) { this->MeshName = name; }
+  void SetArrayName(const std::string &name) { this->ArrayName = name; }
+  void SetAssociation(int assoc) { this->Association = assoc; }
+
+  /// set the rendering mode. the default is MODE_VOLUME
+  int SetMode(int mode);
+
+  /// set the size of the image in pixels. the default is 512x512
+  int SetImageSize(int width, int height);
+
+  /** Set the range of scalar values mapped onto the color map. If not set
+   * the range of the data is used.
+   */
+  void SetScalarRange(double lo, double hi);
+
+  /** Set the opacity per unit length of the largest scalar value used in
+   * volume rendering. Opacity increases linearly with the scalar value.
+   */
+  void SetOpacity(double opacity) { this->Opacity = opacity; }
+
+  /// set the value of the isosurface
+  void SetIsoValue(double val) { this->IsoValue = val; }
+
+  /// set the axis (0, 1, or 2) and the position of the slice
+  int SetSlice(int axis, double position);
+
+  /** Set the distance between samples along each ray. If not set half of
+   * the smallest grid spacing is used.
+   */
+  void SetSampleDistance(double dist) { this->SampleDistance = dist; }
+
+  /// set the background color. the default is black
+  void SetBackground(const std::array<double,3> &rgb) { this->Background = rgb; }
+
+  /// set an explicit camera
+  void SetCamera(const std::array<double,3> &position,
+    const std::array<double,3> &focalPoint, const std::array<double,3> &viewUp);
+
+  /// set the vertical field of view in degrees. the default is 30
+  void SetViewAngle(double angle) { this->ViewAngle = angle; }
+
+  /** Set a series of views using a sensei::CinemaHelper camera configuration
+   * of the form "spherical:fx,fy,fz:px,py,pz:ux,uy,uz:phi0,phi1,...:theta0,...".
+   * One image is made for each combination of the angles, which are in
+   * degrees. Returns 0 if successful.
+   */
+  int SetCameraConfig(const std::string &config);
+
+  /// set the number of partners in each round of compositing. the default is 2
+  int SetRadix(int k);
+
+  /// set the number of threads used to cast rays. the default is 1
+  void SetNumberOfThreads(int nThreads) { this->NumberOfThreads = nThreads; }
+
+  /** Set the prefix of the output files. Images are written to
+   * <prefix>_<step>_<view>.png. If empty no files are written.
+   */
+  void SetFilePrefix(const std::string &prefix) { this->FilePrefix = prefix; }
+
+  /** Get the most recently rendered image, 8 bit RGBA, row by row starting
+   * at the top. This is only valid on rank 0.
+   */
+  const std::vector<unsigned char> &GetImage() const { return this->Image; }
+
+  /// render the current time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+protected:
+  RayCastRenderer();
+  ~RayCastRenderer();
+
+  RayCastRenderer(const RayCastRenderer&) = delete;
+  void operator=(const RayCastRenderer&) = delete;
+
+private:
+  std::string MeshName;
+  std::string ArrayName;
+  int Association;
+  int Mode;
+  int Width;
+  int Height;
+  bool HaveScalarRange;
+  std::array<double,2> ScalarRange;
+  double Opacity;
+  double IsoValue;
+  int SliceAxis;
+  double SlicePosition;
+  double SampleDistance;
+  std::array<double,3> Background;
+  bool HaveCamera;
+  std::array<double,9> Camera;
+  std::vector<std::array<double,9>> Views;
+  double ViewAngle;
+  int Radix;
+  int NumberOfThreads;
+  std::string FilePrefix;
+  std::vector<unsigned char> Image;
+};
+
+}
+
+#endif
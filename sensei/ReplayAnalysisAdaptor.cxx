@@ -0,0 +1,391 @@
+#include "ReplayAnalysisAdaptor.h"
+#include "DataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkCellData.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkOverlappingAMR.h>
+#include <svtkAMRBox.h>
+#include <svtkPointData.h>
+#include <svtkSmartPointer.h>
+#include <svtkUniformGridAMR.h>
+#include <svtkUniformGridAMRDataIterator.h>
+
+#include <mpi.h>
+
+namespace
+{
+// **************************************************************************
+// record the levels of an AMR mesh
+void GetAMRRecord(svtkOverlappingAMR *amr, sensei::ReplaySchema::AMRRecord &rec)
+{
+  int nLevels = amr->GetNumberOfLevels();
+
+  double *origin = amr->GetOrigin();
+  rec.Origin = {{origin[0], origin[1], origin[2]}};
+  rec.GridDescription = amr->GetGridDescription();
+
+  rec.BlocksPerLevel.resize(nLevels);
+  rec.RefinementRatio.resize(nLevels);
+  rec.Spacing.resize(nLevels);
+  rec.Boxes.clear();
+  rec.SourceIndex.clear();
+
+  for (int i = 0; i < nLevels; ++i)
+    {
+    int nBlocks = amr->GetNumberOfDataSets(i);
+
+    rec.BlocksPerLevel[i] = nBlocks;
+    rec.RefinementRatio[i] = amr->GetRefinementRatio(i);
+    amr->GetSpacing(i, rec.Spacing[i].data());
+
+    for (int j = 0; j < nBlocks; ++j)
+      {
+      const svtkAMRBox &box = amr->GetAMRBox(i, j);
+
+      std::array<int,6> corners;
+      box.GetDimensions(corners.data(), corners.data() + 3);
+
+      rec.Boxes.push_back(corners);
+      rec.SourceIndex.push_back(amr->GetAMRBlockSourceIndex(i, j));
+      }
+    }
+}
+}
+
+namespace sensei
+{
+//-----------------------------------------------------------------------------
+senseiNewMacro(ReplayAnalysisAdaptor);
+
+//-----------------------------------------------------------------------------
+ReplayAnalysisAdaptor::ReplayAnalysisAdaptor() : OutputDir("./"),
+  FileName("recording"), NumberOfSteps(0), StepsWritten(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+ReplayAnalysisAdaptor::~ReplayAnalysisAdaptor()
+{
+}
+
+//-----------------------------------------------------------------------------
+int ReplayAnalysisAdaptor::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ReplayAnalysisAdaptor::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool ReplayAnalysisAdaptor::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("ReplayAnalysisAdaptor::Execute");
+
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  if ((this->NumberOfSteps > 0) && (this->StepsWritten >= this->NumberOfSteps))
+    return true;
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  // when nothing was selected everything is recorded
+  if (this->Requirements.Empty() &&
+    this->Requirements.Initialize(dataIn, false))
+    {
+    SENSEI_ERROR("Failed to initialize data requirements")
+    return false;
+    }
+
+  // the streams are created on the first time step
+  if (!this->Writer)
+    {
+    std::string prefix = this->OutputDir + "/" + this->FileName;
+
+    this->Writer.reset(new ReplaySchema::Writer);
+    int status = this->Writer->Open(ReplaySchema::GetFileName(prefix, rank),
+      rank, nRanks);
+
+    int globalStatus = 0;
+    MPI_Allreduce(&status, &globalStatus, 1, MPI_INT, MPI_MIN, comm);
+
+    if (globalStatus)
+      {
+      this->Writer.reset();
+      return false;
+      }
+    }
+
+  if (this->WriteStep(dataIn))
+    return false;
+
+  this->StepsWritten += 1;
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int ReplayAnalysisAdaptor::WriteStep(DataAdaptor *dataIn)
+{
+  MPI_Comm comm = this->GetCommunicator();
+
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // the metadata is served by the replay as it was recorded, so as much of
+  // it as is commonly used is requested
+  MeshMetadataFlags flags;
+  flags.SetBlockDecomp();
+  flags.SetBlockSize();
+
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(dataIn, flags))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return -1;
+    }
+
+  ReplaySchema::StepRecord step;
+  step.TimeStep = dataIn->GetDataTimeStep();
+  step.Time = dataIn->GetDataTime();
+
+  // gather the metadata first, making a global view is collective
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  for (; mit; ++mit)
+    {
+    const std::string &meshName = mit.MeshName();
+
+    unsigned int meshId = 0;
+    MeshMetadataPtr md;
+    if (mdMap.GetMeshId(meshName, meshId) || mdMap.GetMeshMetadata(meshId, md))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+      return -1;
+      }
+
+    // the extents of logically Cartesian and AMR blocks
+    if (SVTKUtils::LogicallyCartesian(md) || SVTKUtils::AMR(md))
+      {
+      MeshMetadataFlags extFlags = flags;
+      extFlags.SetBlockExtents();
+
+      md = MeshMetadata::New(extFlags);
+      if (dataIn->GetMeshMetadata(meshId, md))
+        {
+        SENSEI_ERROR("Failed to get block extents for mesh \""
+          << meshName << "\"")
+        return -1;
+        }
+      }
+
+    if (!md->GlobalView && md->GlobalizeView(comm))
+      {
+      SENSEI_ERROR("Failed to make a global view of the metadata of mesh \""
+        << meshName << "\"")
+      return -1;
+      }
+
+    step.Meshes.emplace_back();
+    step.Meshes.back().Metadata = md;
+    }
+
+  // write the local blocks
+  if (this->Writer->BeginStep())
+    return -1;
+
+  int status = 0;
+  size_t nMeshes = step.Meshes.size();
+  for (size_t q = 0; (q < nMeshes) && !status; ++q)
+    {
+    ReplaySchema::MeshRecord &mrec = step.Meshes[q];
+    MeshMetadataPtr &md = mrec.Metadata;
+    const std::string &meshName = md->MeshName;
+
+    // fetch the mesh, its ghost zones and the requested arrays
+    svtkDataObject *mesh = nullptr;
+    if (dataIn->GetMesh(meshName, false, mesh))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      status = -1;
+      break;
+      }
+
+    if ((md->NumGhostCells || SVTKUtils::AMR(md)) &&
+      dataIn->AddGhostCellsArray(mesh, meshName))
+      {
+      SENSEI_ERROR("Failed to get ghost cells for mesh \"" << meshName << "\"")
+      status = -1;
+      }
+
+    if (!status && md->NumGhostNodes &&
+      dataIn->AddGhostNodesArray(mesh, meshName))
+      {
+      SENSEI_ERROR("Failed to get ghost nodes for mesh \"" << meshName << "\"")
+      status = -1;
+      }
+
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(meshName);
+
+    for (; ait && !status; ++ait)
+      {
+      if (dataIn->AddArray(mesh, meshName, ait.Association(), ait.Array()))
+        {
+        SENSEI_ERROR("Failed to add " << SVTKUtils::GetAttributesName(ait.Association())
+          << " data array \"" << ait.Array() << "\" to mesh \"" << meshName << "\"")
+        status = -1;
+        }
+      }
+
+    mrec.ObjectType = mesh ? mesh->GetDataObjectType() : SVTK_MULTIBLOCK_DATA_SET;
+
+    if (svtkOverlappingAMR *amr = dynamic_cast<svtkOverlappingAMR*>(mesh))
+      ::GetAMRRecord(amr, mrec.AMR);
+
+    BlockStructureMap &structure = this->StaticStructure[meshName];
+
+    auto writeBlock = [&](svtkDataSet *ds, long id, int level, int index) -> int
+      {
+      mrec.Blocks.emplace_back();
+      ReplaySchema::BlockRecord &brec = mrec.Blocks.back();
+
+      brec.Id = id;
+      brec.Level = level;
+      brec.Index = index;
+
+      // the structure of static meshes is written once
+      auto sit = structure.find(id);
+      if (md->StaticMesh && (sit != structure.end()))
+        {
+        const ReplaySchema::BlockRecord &srec = sit->second;
+        brec.Type = srec.Type;
+        brec.Extent = srec.Extent;
+        brec.Origin = srec.Origin;
+        brec.Spacing = srec.Spacing;
+        brec.Structure = srec.Structure;
+        }
+      else
+        {
+        if (this->Writer->WriteStructure(ds, brec))
+          {
+          SENSEI_ERROR("Failed to record block " << id << " of mesh \""
+            << meshName << "\"")
+          return -1;
+          }
+
+        if (md->StaticMesh)
+          structure[id] = brec;
+        }
+
+      // all of the point and cell data
+      int assocs[2] = {svtkDataObject::POINT, svtkDataObject::CELL};
+      for (int j = 0; j < 2; ++j)
+        {
+        svtkDataSetAttributes *atts = ds->GetAttributes(assocs[j]);
+        int nArrays = atts->GetNumberOfArrays();
+        for (int i = 0; i < nArrays; ++i)
+          {
+          svtkDataArray *da = atts->GetArray(i);
+          if (!da || !da->GetName())
+            continue;
+
+          brec.Arrays.emplace_back();
+          if (this->Writer->WriteArray(da, da->GetName(), assocs[j],
+            brec.Arrays.back()))
+            return -1;
+          }
+        }
+
+      return 0;
+      };
+
+    // record the local blocks. the block ids are those of the DataAdaptor
+    // block API, the flat index less one for multiblocks and the flat index
+    // for AMR. a rank holding a single dataset holds block rank
+    svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(mesh);
+    svtkDataSet *ds = dynamic_cast<svtkDataSet*>(mesh);
+    if (!status && cd)
+      {
+      long bidShift = dynamic_cast<svtkUniformGridAMR*>(cd) ? 0 : 1;
+
+      svtkSmartPointer<svtkCompositeDataIterator> it;
+      it.TakeReference(cd->NewIterator());
+      it->SetSkipEmptyNodes(1);
+
+      for (it->InitTraversal(); !it->IsDoneWithTraversal() && !status;
+        it->GoToNextItem())
+        {
+        svtkDataSet *block = dynamic_cast<svtkDataSet*>(it->GetCurrentDataObject());
+        if (!block)
+          continue;
+
+        int level = 0;
+        int index = 0;
+        if (svtkUniformGridAMRDataIterator *amrIt =
+          dynamic_cast<svtkUniformGridAMRDataIterator*>(it.Get()))
+          {
+          level = amrIt->GetCurrentLevel();
+          index = amrIt->GetCurrentIndex();
+          }
+
+        status = writeBlock(block, long(it->GetCurrentFlatIndex()) - bidShift,
+          level, index);
+        }
+      }
+    else if (!status && ds)
+      {
+      status = writeBlock(ds, rank, 0, 0);
+      }
+
+    if (mesh)
+      mesh->Delete();
+    }
+
+  // a time step that is not ended is ignored by the reader
+  if (status || this->Writer->EndStep(step))
+    {
+    SENSEI_ERROR("Failed to record time step " << step.TimeStep)
+    return -1;
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int ReplayAnalysisAdaptor::Finalize()
+{
+  if (this->Writer)
+    {
+    this->Writer->Close();
+    this->Writer.reset();
+    }
+  return 0;
+}
+
+}
@@ -0,0 +1,86 @@
+#ifndef sensei_ReplayAnalysisAdaptor_h
+#define sensei_ReplayAnalysisAdaptor_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+#include "ReplaySchema.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/** The write side of the replay transport. Records the meshes and arrays
+ * served by the simulation's data adaptor, along with their metadata, for a
+ * number of time steps so that the ReplayDataAdaptor can serve them back to
+ * any analysis without running the simulation. This is useful for
+ * benchmarking and tuning analyses and transports against production data,
+ * and for reproducing performance problems.
+ *
+ * Each rank appends to its own stream, "<file_name>_<rank>.replay", in the
+ * layout described in ReplaySchema.h. No communication is needed to write,
+ * apart from gathering a global view of the metadata. The structure of the
+ * blocks of meshes flagged as static in their metadata is written once.
+ */
+class SENSEI_EXPORT ReplayAnalysisAdaptor : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static ReplayAnalysisAdaptor *New();
+
+  senseiTypeMacro(ReplayAnalysisAdaptor, AnalysisAdaptor);
+
+  /** Set the meshes and arrays to record. When none are set every mesh and
+   * array the simulation provides is recorded.
+   */
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  /// Add a set of arrays to record.
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  /// set the directory the streams are written to. the default is ./
+  void SetOutputDir(const std::string &dir) { this->OutputDir = dir; }
+
+  /// set the prefix of the stream names. the default is recording
+  void SetFileName(const std::string &name) { this->FileName = name; }
+
+  /** set the number of time steps to record. later time steps are
+   * ignored. The default, 0, records every time step.
+   */
+  void SetNumberOfSteps(long n) { this->NumberOfSteps = n; }
+
+  /// record the current time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// close the streams
+  int Finalize() override;
+
+protected:
+  ReplayAnalysisAdaptor();
+  ~ReplayAnalysisAdaptor();
+
+  ReplayAnalysisAdaptor(const ReplayAnalysisAdaptor&) = delete;
+  void operator=(const ReplayAnalysisAdaptor&) = delete;
+
+  // record the meshes of one time step. this is local to the rank
+  int WriteStep(DataAdaptor *data);
+
+private:
+  using BlockStructureMap = std::map<long, ReplaySchema::BlockRecord>;
+
+  DataRequirements Requirements;
+  std::string OutputDir;
+  std::string FileName;
+  long NumberOfSteps;
+  long StepsWritten;
+  std::unique_ptr<ReplaySchema::Writer> Writer;
+  std::map<std::string, BlockStructureMap> StaticStructure;
+};
+
+}
+
+#endif
@@ -0,0 +1,624 @@
+#include "ReplayDataAdaptor.h"
+#include "BlockPartitioner.h"
+#include "MeshMetadata.h"
+#include "Partitioner.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkOverlappingAMR.h>
+#include <svtkSmartPointer.h>
+#include <svtkUniformGrid.h>
+
+#include <pugixml.hpp>
+
+#include <mpi.h>
+
+namespace
+{
+// **************************************************************************
+// true for the types of meshes made of blocks
+bool Composite(int type)
+{
+  switch (type)
+    {
+    case SVTK_MULTIBLOCK_DATA_SET:
+    case SVTK_MULTIPIECE_DATA_SET:
+    case SVTK_OVERLAPPING_AMR:
+    case SVTK_NON_OVERLAPPING_AMR:
+    case SVTK_UNIFORM_GRID_AMR:
+    case SVTK_HIERARCHICAL_BOX_DATA_SET:
+      return true;
+    }
+  return false;
+}
+}
+
+namespace sensei
+{
+//----------------------------------------------------------------------------
+senseiNewMacro(ReplayDataAdaptor);
+
+//----------------------------------------------------------------------------
+ReplayDataAdaptor::ReplayDataAdaptor() : UserPartitioner(false),
+  StepIndex(0), Primary(nullptr)
+{
+}
+
+//----------------------------------------------------------------------------
+ReplayDataAdaptor::~ReplayDataAdaptor()
+{
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::Initialize(pugi::xml_node &node)
+{
+  TimeEvent<128> mark("ReplayDataAdaptor::Initialize");
+
+  if (this->InTransitDataAdaptor::Initialize(node))
+    return -1;
+
+  this->UserPartitioner = bool(node.child("partitioner"));
+
+  pugi::xml_attribute fileName = node.attribute("file_name");
+  if (fileName)
+    this->FileName = fileName.value();
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+void ReplayDataAdaptor::SetPartitioner(const sensei::PartitionerPtr &partitioner)
+{
+  this->InTransitDataAdaptor::SetPartitioner(partitioner);
+  this->UserPartitioner = true;
+}
+
+//----------------------------------------------------------------------------
+ReplaySchema::Reader *ReplayDataAdaptor::GetReader(int rank)
+{
+  if ((rank < 0) || (rank >= int(this->Readers.size())))
+    {
+    SENSEI_ERROR("Invalid recording rank " << rank << ". The recording was"
+      " made on " << this->Readers.size() << " ranks")
+    return nullptr;
+    }
+
+  // the streams are mapped when they are first needed
+  ReaderPtr &reader = this->Readers[rank];
+  if (!reader)
+    {
+    const std::string &prefix = this->GetConnectionInfo().empty() ?
+      this->FileName : this->GetConnectionInfo();
+
+    reader.reset(new ReplaySchema::Reader);
+    if (reader->Open(ReplaySchema::GetFileName(prefix, rank)))
+      {
+      reader.reset();
+      return nullptr;
+      }
+    }
+
+  // and kept in step with the others
+  if ((reader->GetStepIndex() != this->StepIndex) &&
+    reader->Seek(this->StepIndex))
+    {
+    SENSEI_ERROR("The recording of rank " << rank << " has no time step "
+      << this->StepIndex)
+    return nullptr;
+    }
+
+  return reader.get();
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::OpenStream()
+{
+  TimeEvent<128> mark("ReplayDataAdaptor::OpenStream");
+
+  const std::string &prefix = this->GetConnectionInfo().empty() ?
+    this->FileName : this->GetConnectionInfo();
+
+  if (prefix.empty())
+    {
+    SENSEI_ERROR("The name of the recording was not set")
+    return -1;
+    }
+
+  int rank = 0;
+  MPI_Comm_rank(this->GetCommunicator(), &rank);
+
+  // the stream of rank 0 tells how many ranks made the recording
+  ReaderPtr reader(new ReplaySchema::Reader);
+  if (reader->Open(ReplaySchema::GetFileName(prefix, 0)))
+    return -1;
+
+  int nRecRanks = reader->GetNumberOfRanks();
+
+  this->StepIndex = 0;
+  this->Readers.clear();
+  this->Readers.resize(nRecRanks);
+  this->Readers[0] = std::move(reader);
+  this->Metadata.clear();
+  this->BlockSource.clear();
+
+  // the time and metadata are served from the recording of a single rank
+  if (!(this->Primary = this->GetReader(rank % nRecRanks)) ||
+    !this->Primary->Good())
+    {
+    SENSEI_ERROR("The recording \"" << prefix << "\" has no time steps")
+    return -1;
+    }
+
+  this->SetDataTimeStep(this->Primary->GetStep().TimeStep);
+  this->SetDataTime(this->Primary->GetStep().Time);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::StreamGood()
+{
+  return (this->Primary && this->Primary->Good()) ? 0 : -1;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::AdvanceStream()
+{
+  TimeEvent<128> mark("ReplayDataAdaptor::AdvanceStream");
+
+  this->Metadata.clear();
+  this->BlockSource.clear();
+
+  // all ranks stop together, even if the streams have different lengths
+  int atEnd = (!this->Primary || this->Primary->Seek(this->StepIndex + 1)) ? 1 : 0;
+  MPI_Allreduce(MPI_IN_PLACE, &atEnd, 1, MPI_INT, MPI_MAX, this->GetCommunicator());
+
+  if (atEnd)
+    return -1;
+
+  this->StepIndex += 1;
+
+  this->SetDataTimeStep(this->Primary->GetStep().TimeStep);
+  this->SetDataTime(this->Primary->GetStep().Time);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::CloseStream()
+{
+  // the streams stay mapped, analyses may hold on to the arrays
+  this->Primary = nullptr;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::Finalize()
+{
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::GetNumberOfMeshes(unsigned int &numMeshes)
+{
+  numMeshes = 0;
+
+  if (!this->Primary)
+    {
+    SENSEI_ERROR("The stream is not open")
+    return -1;
+    }
+
+  numMeshes = this->Primary->GetStep().Meshes.size();
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::GetMeshIndex(const std::string &meshName,
+  unsigned int &id)
+{
+  if (!this->Primary)
+    {
+    SENSEI_ERROR("The stream is not open")
+    return -1;
+    }
+
+  const std::vector<ReplaySchema::MeshRecord> &meshes =
+    this->Primary->GetStep().Meshes;
+
+  unsigned int nMeshes = meshes.size();
+  for (id = 0; id < nMeshes; ++id)
+    {
+    if (meshes[id].Metadata->MeshName == meshName)
+      return 0;
+    }
+
+  SENSEI_ERROR("No mesh named \"" << meshName << "\" was recorded")
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::GetSenderMeshMetadata(unsigned int id,
+  MeshMetadataPtr &metadata)
+{
+  unsigned int nMeshes = 0;
+  if (this->GetNumberOfMeshes(nMeshes))
+    return -1;
+
+  if (id >= nMeshes)
+    {
+    SENSEI_ERROR("Mesh index " << id << " is out of bounds. "
+      << nMeshes << " meshes were recorded")
+    return -1;
+    }
+
+  metadata = this->Primary->GetStep().Meshes[id].Metadata;
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::GetMeshMetadata(unsigned int id,
+  MeshMetadataPtr &metadata)
+{
+  TimeEvent<128> mark("ReplayDataAdaptor::GetMeshMetadata");
+
+  // an analysis told us how the data should land
+  if (!this->GetReceiverMeshMetadata(id, metadata))
+    return 0;
+
+  auto it = this->Metadata.find(id);
+  if (it != this->Metadata.end())
+    {
+    metadata = it->second;
+    return 0;
+    }
+
+  MeshMetadataPtr senderMd;
+  if (this->GetSenderMeshMetadata(id, senderMd))
+    return -1;
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  int nRanks = 1;
+  MPI_Comm_size(comm, &nRanks);
+
+  // serve the blocks where they were recorded, or use the partitioner
+  MeshMetadataPtr recverMd;
+  if (!this->UserPartitioner && (nRanks == int(this->Readers.size())))
+    {
+    recverMd = senderMd->NewCopy();
+    }
+  else
+    {
+    PartitionerPtr part = this->GetPartitioner();
+    if (!part)
+      part = BlockPartitioner::New();
+
+    if (part->GetPartition(comm, senderMd, recverMd))
+      {
+      SENSEI_ERROR("Failed to partition mesh \"" << senderMd->MeshName << "\"")
+      return -1;
+      }
+    }
+
+  this->Metadata[id] = recverMd;
+  metadata = recverMd;
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::GetLocalBlockIds(const std::string &meshName,
+  std::vector<long> &ids)
+{
+  unsigned int id = 0;
+  MeshMetadataPtr md;
+  if (this->GetMeshIndex(meshName, id) || this->GetMeshMetadata(id, md))
+    return -1;
+
+  int rank = 0;
+  MPI_Comm_rank(this->GetCommunicator(), &rank);
+
+  return SVTKUtils::GetLocalBlockIds(rank, md, ids);
+}
+
+//----------------------------------------------------------------------------
+const ReplaySchema::BlockRecord *ReplayDataAdaptor::GetBlockRecord(
+  const std::string &meshName, long blockId, ReplaySchema::Reader *&reader)
+{
+  reader = nullptr;
+
+  // the rank that recorded each block
+  auto sit = this->BlockSource.find(meshName);
+  if (sit == this->BlockSource.end())
+    {
+    unsigned int id = 0;
+    MeshMetadataPtr md;
+    if (this->GetMeshIndex(meshName, id) || this->GetSenderMeshMetadata(id, md))
+      return nullptr;
+
+    std::map<long, int> &src = this->BlockSource[meshName];
+
+    size_t nBlocks = md->BlockIds.size();
+    for (size_t i = 0; i < nBlocks; ++i)
+      src[md->BlockIds[i]] = md->BlockOwner[i];
+
+    sit = this->BlockSource.find(meshName);
+    }
+
+  auto bit = sit->second.find(blockId);
+  if (bit == sit->second.end())
+    {
+    SENSEI_ERROR("Mesh \"" << meshName << "\" has no block " << blockId)
+    return nullptr;
+    }
+
+  if (!(reader = this->GetReader(bit->second)))
+    return nullptr;
+
+  const ReplaySchema::MeshRecord *mrec = reader->GetStep().GetMesh(meshName);
+  const ReplaySchema::BlockRecord *brec = mrec ? mrec->GetBlock(blockId) : nullptr;
+  if (!brec)
+    {
+    SENSEI_ERROR("Block " << blockId << " of mesh \"" << meshName
+      << "\" was not recorded by rank " << bit->second)
+    return nullptr;
+    }
+
+  return brec;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::GetMesh(const std::string &meshName,
+  bool structureOnly, svtkDataObject *&mesh)
+{
+  TimeEvent<128> mark("ReplayDataAdaptor::GetMesh");
+
+  (void)structureOnly;
+  mesh = nullptr;
+
+  unsigned int id = 0;
+  MeshMetadataPtr md;
+  std::vector<long> ids;
+  if (this->GetMeshIndex(meshName, id) || this->GetMeshMetadata(id, md) ||
+    this->GetLocalBlockIds(meshName, ids))
+    {
+    SENSEI_ERROR("Failed to get the local blocks of mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  const ReplaySchema::MeshRecord &mrec = this->Primary->GetStep().Meshes[id];
+
+  // AMR meshes are rebuilt from the recorded levels
+  svtkOverlappingAMR *amr = nullptr;
+  svtkMultiBlockDataSet *mb = nullptr;
+  if (mrec.ObjectType == SVTK_OVERLAPPING_AMR)
+    {
+    amr = ReplaySchema::Reader::NewAMR(mrec.AMR);
+    mesh = amr;
+    }
+  else if (::Composite(mrec.ObjectType) || (ids.size() != 1) ||
+    (md->BlockOwner != mrec.Metadata->BlockOwner))
+    {
+    // a dataset is served as recorded when it lands where it was
+    // recorded, everything else is served as a multiblock
+    mb = svtkMultiBlockDataSet::New();
+    mb->SetNumberOfBlocks(md->NumBlocks);
+    mesh = mb;
+    }
+
+  size_t nIds = ids.size();
+  for (size_t i = 0; i < nIds; ++i)
+    {
+    ReplaySchema::Reader *reader = nullptr;
+    const ReplaySchema::BlockRecord *brec =
+      this->GetBlockRecord(meshName, ids[i], reader);
+
+    svtkDataSet *ds = brec ? reader->NewBlock(*brec) : nullptr;
+    if (!ds)
+      {
+      SENSEI_ERROR("Failed to get block " << ids[i] << " of mesh \""
+        << meshName << "\"")
+      if (mesh)
+        mesh->Delete();
+      mesh = nullptr;
+      return -1;
+      }
+
+    if (amr)
+      {
+      amr->SetDataSet(brec->Level, brec->Index, dynamic_cast<svtkUniformGrid*>(ds));
+      ds->Delete();
+      }
+    else if (mb)
+      {
+      if (ids[i] >= long(mb->GetNumberOfBlocks()))
+        mb->SetNumberOfBlocks(ids[i] + 1);
+
+      mb->SetBlock(ids[i], ds);
+      ds->Delete();
+      }
+    else
+      {
+      mesh = ds;
+      }
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::AttachArray(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association,
+  const std::string &arrayName, bool required)
+{
+  svtkDataSet *ds = dynamic_cast<svtkDataSet*>(block);
+  if (!ds)
+    {
+    SENSEI_ERROR("Block " << blockId << " of mesh \"" << meshName
+      << "\" is not a dataset")
+    return -1;
+    }
+
+  ReplaySchema::Reader *reader = nullptr;
+  const ReplaySchema::BlockRecord *brec =
+    this->GetBlockRecord(meshName, blockId, reader);
+
+  if (!brec)
+    return -1;
+
+  const ReplaySchema::ArrayRecord *arec = brec->GetArray(association, arrayName);
+  if (!arec)
+    {
+    if (!required)
+      return 0;
+
+    SENSEI_ERROR("No " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" was recorded on block "
+      << blockId << " of mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  svtkDataArray *da = reader->NewArray(*arec);
+  if (!da)
+    return -1;
+
+  ds->GetAttributes(association)->AddArray(da);
+  da->Delete();
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::AddArray(svtkDataObject *mesh,
+  const std::string &meshName, int association, const std::string &arrayName)
+{
+  TimeEvent<128> mark("ReplayDataAdaptor::AddArray");
+
+  std::vector<long> ids;
+  if (this->GetLocalBlockIds(meshName, ids))
+    return -1;
+
+  SVTKUtils::BlockMap blocks;
+  blocks.Initialize(mesh);
+
+  size_t nIds = ids.size();
+  for (size_t i = 0; i < nIds; ++i)
+    {
+    if (this->AttachArray(blocks.GetBlock(ids[i]), meshName,
+      ids[i], association, arrayName, true))
+      return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::AddGhostNodesArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  std::vector<long> ids;
+  if (this->GetLocalBlockIds(meshName, ids))
+    return -1;
+
+  SVTKUtils::BlockMap blocks;
+  blocks.Initialize(mesh);
+
+  size_t nIds = ids.size();
+  for (size_t i = 0; i < nIds; ++i)
+    {
+    if (this->AttachArray(blocks.GetBlock(ids[i]), meshName,
+      ids[i], svtkDataObject::POINT, "svtkGhostType", false))
+      return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::AddGhostCellsArray(svtkDataObject *mesh,
+  const std::string &meshName)
+{
+  std::vector<long> ids;
+  if (this->GetLocalBlockIds(meshName, ids))
+    return -1;
+
+  SVTKUtils::BlockMap blocks;
+  blocks.Initialize(mesh);
+
+  size_t nIds = ids.size();
+  for (size_t i = 0; i < nIds; ++i)
+    {
+    if (this->AttachArray(blocks.GetBlock(ids[i]), meshName,
+      ids[i], svtkDataObject::CELL, "svtkGhostType", false))
+      return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::GetMeshBlock(const std::string &meshName,
+  long blockId, bool structureOnly, svtkDataObject *&block)
+{
+  (void)structureOnly;
+  block = nullptr;
+
+  ReplaySchema::Reader *reader = nullptr;
+  const ReplaySchema::BlockRecord *brec =
+    this->GetBlockRecord(meshName, blockId, reader);
+
+  if (!brec || !(block = reader->NewBlock(*brec)))
+    {
+    SENSEI_ERROR("Failed to get block " << blockId << " of mesh \""
+      << meshName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::AddArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association,
+  const std::string &arrayName)
+{
+  return this->AttachArray(block, meshName, blockId, association,
+    arrayName, true);
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::AddGhostNodesArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  return this->AttachArray(block, meshName, blockId, svtkDataObject::POINT,
+    "svtkGhostType", false);
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::AddGhostCellsArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  return this->AttachArray(block, meshName, blockId, svtkDataObject::CELL,
+    "svtkGhostType", false);
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::ReleaseMeshBlocks()
+{
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int ReplayDataAdaptor::ReleaseData()
+{
+  return this->Superclass::ReleaseData();
+}
+
+}
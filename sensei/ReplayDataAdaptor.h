@@ -0,0 +1,142 @@
+#ifndef sensei_ReplayDataAdaptor_h
+#define sensei_ReplayDataAdaptor_h
+
+#include "InTransitDataAdaptor.h"
+#include "ReplaySchema.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sensei
+{
+
+/** The read side of the replay transport. Serves the time steps recorded by
+ * the ReplayAnalysisAdaptor, so that analyses and transports can be run,
+ * benchmarked, and tuned against production data without running the
+ * simulation. The recordings are mapped into memory and the arrays are
+ * passed to the analysis zero copy.
+ *
+ * When run on the number of ranks that made the recording, and no
+ * partitioner is given, each rank serves the blocks it recorded and the
+ * metadata is served exactly as it was recorded. Otherwise the blocks are
+ * distributed by the partitioner, the sender metadata being that recorded.
+ * In that case the block ids of the recorded metadata must be those of the
+ * DataAdaptor block API, the flat index less one of multiblock datasets and
+ * the flat index of AMR datasets.
+ *
+ * The recordings stay mapped until the adaptor is destroyed, so that the
+ * arrays held by analyses remain valid after the stream is closed.
+ */
+class SENSEI_EXPORT ReplayDataAdaptor : public InTransitDataAdaptor
+{
+public:
+  /// allocates a new instance
+  static ReplayDataAdaptor *New();
+
+  senseiTypeMacro(ReplayDataAdaptor, InTransitDataAdaptor);
+
+  /** set the prefix of the recording, the output_dir and file_name of the
+   * ReplayAnalysisAdaptor that wrote it joined by a /. Connection info, when
+   * given, overrides this.
+   */
+  void SetFileName(const std::string &prefix) { this->FileName = prefix; }
+
+  /** Initialize from XML. The prefix of the recording is given by the
+   * file_name attribute. An optional partitioner element selects how the
+   * blocks are distributed.
+   */
+  int Initialize(pugi::xml_node &node) override;
+
+  /// setting a partitioner disables serving the blocks as recorded
+  void SetPartitioner(const sensei::PartitionerPtr &partitioner) override;
+
+  /// @name in transit control API
+  /// @{
+  int GetSenderMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+  int OpenStream() override;
+  int CloseStream() override;
+  int AdvanceStream() override;
+  int StreamGood() override;
+  int Finalize() override;
+  /// @}
+
+  /// @name data adaptor API
+  /// @{
+  int GetNumberOfMeshes(unsigned int &numMeshes) override;
+
+  int GetMeshMetadata(unsigned int id, MeshMetadataPtr &metadata) override;
+
+  int GetMesh(const std::string &meshName, bool structureOnly,
+    svtkDataObject *&mesh) override;
+
+  int AddGhostNodesArray(svtkDataObject *mesh,
+    const std::string &meshName) override;
+
+  int AddGhostCellsArray(svtkDataObject *mesh,
+    const std::string &meshName) override;
+
+  int AddArray(svtkDataObject *mesh, const std::string &meshName,
+    int association, const std::string &arrayName) override;
+
+  int GetMeshBlock(const std::string &meshName, long blockId,
+    bool structureOnly, svtkDataObject *&block) override;
+
+  int AddArrayToBlock(svtkDataObject *block, const std::string &meshName,
+    long blockId, int association, const std::string &arrayName) override;
+
+  int AddGhostNodesArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+  int AddGhostCellsArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+  bool StreamsMeshBlocks(const std::string &) override { return true; }
+
+  int ReleaseMeshBlocks() override;
+
+  int ReleaseData() override;
+  /// @}
+
+protected:
+  ReplayDataAdaptor();
+  ~ReplayDataAdaptor();
+
+  ReplayDataAdaptor(const ReplayDataAdaptor&) = delete;
+  void operator=(const ReplayDataAdaptor&) = delete;
+
+  // get the stream of a recording rank, positioned on the current time step
+  ReplaySchema::Reader *GetReader(int rank);
+
+  // get the index of a mesh in the current time step
+  int GetMeshIndex(const std::string &meshName, unsigned int &id);
+
+  // get the record of a block from the stream of the rank that recorded it
+  const ReplaySchema::BlockRecord *GetBlockRecord(const std::string &meshName,
+    long blockId, ReplaySchema::Reader *&reader);
+
+  // get the ids of the blocks this rank serves
+  int GetLocalBlockIds(const std::string &meshName, std::vector<long> &ids);
+
+  // attach a recorded array to a block. arrays that were not recorded are
+  // skipped unless they are required
+  int AttachArray(svtkDataObject *block, const std::string &meshName,
+    long blockId, int association, const std::string &arrayName,
+    bool required);
+
+private:
+  using ReaderPtr = std::unique_ptr<ReplaySchema::Reader>;
+
+  std::string FileName;
+  bool UserPartitioner;
+  long StepIndex;
+  std::vector<ReaderPtr> Readers;
+  ReplaySchema::Reader *Primary;
+  std::map<unsigned int, MeshMetadataPtr> Metadata;
+  std::map<std::string, std::map<long, int>> BlockSource;
+};
+
+}
+
+#endif
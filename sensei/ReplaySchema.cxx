@@ -0,0 +1,675 @@
+#include "ReplaySchema.h"
+#include "Error.h"
+
+#include <svtkAMRBox.h>
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCellArray.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkImageData.h>
+#include <svtkOverlappingAMR.h>
+#include <svtkPoints.h>
+#include <svtkPolyData.h>
+#include <svtkRectilinearGrid.h>
+#include <svtkSmartPointer.h>
+#include <svtkStructuredGrid.h>
+#include <svtkStructuredPoints.h>
+#include <svtkUniformGrid.h>
+#include <svtkUnsignedCharArray.h>
+#include <svtkUnstructuredGrid.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sensei
+{
+namespace ReplaySchema
+{
+
+// --------------------------------------------------------------------------
+void ArrayRecord::ToStream(BinaryStream &str) const
+{
+  str.Pack(this->Name);
+  str.Pack(this->Association);
+  str.Pack(this->Type);
+  str.Pack(this->NumberOfComponents);
+  str.Pack(this->NumberOfTuples);
+  str.Pack(this->Offset);
+}
+
+// --------------------------------------------------------------------------
+void ArrayRecord::FromStream(BinaryStream &str)
+{
+  str.Unpack(this->Name);
+  str.Unpack(this->Association);
+  str.Unpack(this->Type);
+  str.Unpack(this->NumberOfComponents);
+  str.Unpack(this->NumberOfTuples);
+  str.Unpack(this->Offset);
+}
+
+// --------------------------------------------------------------------------
+template <typename record_t>
+void PackRecords(BinaryStream &str, const std::vector<record_t> &recs)
+{
+  unsigned long n = recs.size();
+  str.Pack(n);
+  for (unsigned long i = 0; i < n; ++i)
+    recs[i].ToStream(str);
+}
+
+// --------------------------------------------------------------------------
+template <typename record_t>
+void UnpackRecords(BinaryStream &str, std::vector<record_t> &recs)
+{
+  unsigned long n = 0;
+  str.Unpack(n);
+  recs.resize(n);
+  for (unsigned long i = 0; i < n; ++i)
+    recs[i].FromStream(str);
+}
+
+// --------------------------------------------------------------------------
+void BlockRecord::ToStream(BinaryStream &str) const
+{
+  str.Pack(this->Id);
+  str.Pack(this->Type);
+  str.Pack(this->Level);
+  str.Pack(this->Index);
+  str.Pack(this->Extent);
+  str.Pack(this->Origin);
+  str.Pack(this->Spacing);
+  PackRecords(str, this->Structure);
+  PackRecords(str, this->Arrays);
+}
+
+// --------------------------------------------------------------------------
+void BlockRecord::FromStream(BinaryStream &str)
+{
+  str.Unpack(this->Id);
+  str.Unpack(this->Type);
+  str.Unpack(this->Level);
+  str.Unpack(this->Index);
+  str.Unpack(this->Extent);
+  str.Unpack(this->Origin);
+  str.Unpack(this->Spacing);
+  UnpackRecords(str, this->Structure);
+  UnpackRecords(str, this->Arrays);
+}
+
+// --------------------------------------------------------------------------
+const ArrayRecord *BlockRecord::GetArray(int association,
+  const std::string &name) const
+{
+  for (const ArrayRecord &rec : this->Arrays)
+    {
+    if ((rec.Association == association) && (rec.Name == name))
+      return &rec;
+    }
+  return nullptr;
+}
+
+// --------------------------------------------------------------------------
+void AMRRecord::ToStream(BinaryStream &str) const
+{
+  str.Pack(this->Origin);
+  str.Pack(this->GridDescription);
+  str.Pack(this->BlocksPerLevel);
+  str.Pack(this->RefinementRatio);
+  str.Pack(this->Spacing);
+  str.Pack(this->Boxes);
+  str.Pack(this->SourceIndex);
+}
+
+// --------------------------------------------------------------------------
+void AMRRecord::FromStream(BinaryStream &str)
+{
+  str.Unpack(this->Origin);
+  str.Unpack(this->GridDescription);
+  str.Unpack(this->BlocksPerLevel);
+  str.Unpack(this->RefinementRatio);
+  str.Unpack(this->Spacing);
+  str.Unpack(this->Boxes);
+  str.Unpack(this->SourceIndex);
+}
+
+// --------------------------------------------------------------------------
+void MeshRecord::ToStream(BinaryStream &str) const
+{
+  this->Metadata->ToStream(str);
+  str.Pack(this->ObjectType);
+  this->AMR.ToStream(str);
+  PackRecords(str, this->Blocks);
+}
+
+// --------------------------------------------------------------------------
+void MeshRecord::FromStream(BinaryStream &str)
+{
+  this->Metadata = MeshMetadata::New();
+  this->Metadata->FromStream(str);
+  str.Unpack(this->ObjectType);
+  this->AMR.FromStream(str);
+  UnpackRecords(str, this->Blocks);
+
+  this->BlockIndex.clear();
+  for (size_t i = 0; i < this->Blocks.size(); ++i)
+    this->BlockIndex[this->Blocks[i].Id] = i;
+}
+
+// --------------------------------------------------------------------------
+const BlockRecord *MeshRecord::GetBlock(long id) const
+{
+  auto it = this->BlockIndex.find(id);
+  if (it == this->BlockIndex.end())
+    return nullptr;
+  return &this->Blocks[it->second];
+}
+
+// --------------------------------------------------------------------------
+void StepRecord::ToStream(BinaryStream &str) const
+{
+  str.Pack(this->TimeStep);
+  str.Pack(this->Time);
+  PackRecords(str, this->Meshes);
+}
+
+// --------------------------------------------------------------------------
+void StepRecord::FromStream(BinaryStream &str)
+{
+  str.Unpack(this->TimeStep);
+  str.Unpack(this->Time);
+  UnpackRecords(str, this->Meshes);
+}
+
+// --------------------------------------------------------------------------
+const MeshRecord *StepRecord::GetMesh(const std::string &name) const
+{
+  for (const MeshRecord &rec : this->Meshes)
+    {
+    if (rec.Metadata->MeshName == name)
+      return &rec;
+    }
+  return nullptr;
+}
+
+// --------------------------------------------------------------------------
+std::string GetFileName(const std::string &prefix, int rank)
+{
+  std::ostringstream oss;
+  oss << prefix << "_" << std::setw(6) << std::setfill('0') << rank << ".replay";
+  return oss.str();
+}
+
+// --------------------------------------------------------------------------
+int Writer::Open(const std::string &fileName, int rank, int nRanks)
+{
+  this->Stream.open(fileName, std::ios::binary | std::ios::trunc);
+  if (!this->Stream.good())
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\" for writing")
+    return -1;
+    }
+
+  uint64_t header[4] = {FileTag, Version, uint64_t(rank), uint64_t(nRanks)};
+  this->Stream.write(reinterpret_cast<char*>(header), sizeof(header));
+  this->Pos = sizeof(header);
+
+  return this->Stream.good() ? 0 : -1;
+}
+
+// --------------------------------------------------------------------------
+int Writer::Close()
+{
+  if (this->Stream.is_open())
+    this->Stream.close();
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Writer::Pad(uint64_t alignment)
+{
+  static const char zeros[Alignment] = {0};
+
+  uint64_t n = (alignment - this->Pos % alignment) % alignment;
+  this->Stream.write(zeros, n);
+  this->Pos += n;
+
+  return this->Stream.good() ? 0 : -1;
+}
+
+// --------------------------------------------------------------------------
+int Writer::BeginStep()
+{
+  // the header is filled in when the step is complete, so that a reader
+  // ignores a partially written step
+  this->StepPos = this->Pos;
+
+  uint64_t header[4] = {0, 0, 0, 0};
+  this->Stream.write(reinterpret_cast<char*>(header), sizeof(header));
+  this->Pos += sizeof(header);
+
+  return this->Stream.good() ? 0 : -1;
+}
+
+// --------------------------------------------------------------------------
+int Writer::WriteArray(svtkDataArray *da, const std::string &name,
+  int association, ArrayRecord &rec)
+{
+  // the data is written as a single contiguous run of tuples
+  svtkSmartPointer<svtkDataArray> tmp = da;
+  if (!da->HasStandardMemoryLayout())
+    {
+    tmp.TakeReference(svtkDataArray::CreateDataArray(da->GetDataType()));
+    tmp->DeepCopy(da);
+    }
+
+  rec.Name = name;
+  rec.Association = association;
+  rec.Type = tmp->GetDataType();
+  rec.NumberOfComponents = tmp->GetNumberOfComponents();
+  rec.NumberOfTuples = tmp->GetNumberOfTuples();
+
+  if (this->Pad(Alignment))
+    return -1;
+
+  rec.Offset = this->Pos;
+
+  uint64_t nBytes = uint64_t(rec.NumberOfTuples) *
+    rec.NumberOfComponents * tmp->GetDataTypeSize();
+
+  if (nBytes)
+    this->Stream.write(static_cast<char*>(tmp->GetVoidPointer(0)), nBytes);
+
+  this->Pos += nBytes;
+
+  if (!this->Stream.good())
+    {
+    SENSEI_ERROR("Failed to write array \"" << name << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Writer::WriteStructure(svtkDataSet *ds, BlockRecord &rec)
+{
+  rec.Type = ds->GetDataObjectType();
+  rec.Structure.clear();
+
+  auto writeArray = [&](svtkDataArray *da, const char *name) -> int
+    {
+    if (!da)
+      return 0;
+    rec.Structure.emplace_back();
+    return this->WriteArray(da, name, -1, rec.Structure.back());
+    };
+
+  auto writeCells = [&](svtkCellArray *ca, const std::string &name) -> int
+    {
+    if (!ca)
+      return 0;
+    return writeArray(ca->GetOffsetsArray(), (name + "offsets").c_str()) ||
+      writeArray(ca->GetConnectivityArray(), (name + "connectivity").c_str());
+    };
+
+  if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+    {
+    im->GetExtent(rec.Extent.data());
+    im->GetOrigin(rec.Origin.data());
+    im->GetSpacing(rec.Spacing.data());
+    return 0;
+    }
+  else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+    {
+    rg->GetExtent(rec.Extent.data());
+    return writeArray(rg->GetXCoordinates(), "x") ||
+      writeArray(rg->GetYCoordinates(), "y") ||
+      writeArray(rg->GetZCoordinates(), "z");
+    }
+  else if (svtkStructuredGrid *sg = dynamic_cast<svtkStructuredGrid*>(ds))
+    {
+    sg->GetExtent(rec.Extent.data());
+    return sg->GetPoints() && writeArray(sg->GetPoints()->GetData(), "points");
+    }
+  else if (svtkUnstructuredGrid *ug = dynamic_cast<svtkUnstructuredGrid*>(ds))
+    {
+    return (ug->GetPoints() && writeArray(ug->GetPoints()->GetData(), "points")) ||
+      writeArray(ug->GetCellTypesArray(), "types") || writeCells(ug->GetCells(), "");
+    }
+  else if (svtkPolyData *pd = dynamic_cast<svtkPolyData*>(ds))
+    {
+    return (pd->GetPoints() && writeArray(pd->GetPoints()->GetData(), "points")) ||
+      writeCells(pd->GetVerts(), "verts_") || writeCells(pd->GetLines(), "lines_") ||
+      writeCells(pd->GetPolys(), "polys_") || writeCells(pd->GetStrips(), "strips_");
+    }
+
+  SENSEI_ERROR("Recording blocks of type " << ds->GetClassName()
+    << " is not supported")
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+int Writer::EndStep(const StepRecord &step)
+{
+  BinaryStream str;
+  step.ToStream(str);
+
+  if (this->Pad(sizeof(uint64_t)))
+    return -1;
+
+  uint64_t dirPos = this->Pos;
+  uint64_t dirSize = str.Size();
+
+  this->Stream.write(reinterpret_cast<const char*>(str.GetData()), dirSize);
+  this->Pos += dirSize;
+
+  // the step is complete, fill in its header
+  uint64_t header[4] = {StepTag, dirPos, dirSize, this->Pos};
+
+  this->Stream.seekp(this->StepPos);
+  this->Stream.write(reinterpret_cast<char*>(header), sizeof(header));
+  this->Stream.seekp(this->Pos);
+  this->Stream.flush();
+
+  if (!this->Stream.good())
+    {
+    SENSEI_ERROR("Failed to write time step " << step.TimeStep)
+    return -1;
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Reader::Open(const std::string &fileName)
+{
+  this->Close();
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\". " << strerror(errno))
+    return -1;
+    }
+
+  struct stat st;
+  if (fstat(fd, &st) || (st.st_size < 4*long(sizeof(uint64_t))))
+    {
+    SENSEI_ERROR("\"" << fileName << "\" is not a SENSEI recording")
+    close(fd);
+    return -1;
+    }
+
+  // the mapping is private and writable so that analyses may modify the
+  // arrays they are passed without touching the file
+  void *data = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE, fd, 0);
+
+  close(fd);
+
+  if (data == MAP_FAILED)
+    {
+    SENSEI_ERROR("Failed to map \"" << fileName << "\". " << strerror(errno))
+    return -1;
+    }
+
+  this->FileName = fileName;
+  this->Data = static_cast<char*>(data);
+  this->Size = st.st_size;
+
+  const uint64_t *header = reinterpret_cast<uint64_t*>(this->Data);
+  if ((header[0] != FileTag) || (header[1] != Version))
+    {
+    SENSEI_ERROR("\"" << fileName << "\" is not a SENSEI recording of version "
+      << Version)
+    this->Close();
+    return -1;
+    }
+
+  this->NumberOfRanks = header[3];
+
+  this->StepIndex = 0;
+  this->Valid = !this->ReadStep(4*sizeof(uint64_t), true);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Reader::Close()
+{
+  if (this->Data)
+    munmap(this->Data, this->Size);
+
+  this->Data = nullptr;
+  this->Size = 0;
+  this->Valid = false;
+  this->StepIndex = -1;
+  this->Step = StepRecord();
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Reader::ReadStep(uint64_t pos, bool parse)
+{
+  if (pos + 4*sizeof(uint64_t) > this->Size)
+    return -1;
+
+  const uint64_t *header = reinterpret_cast<uint64_t*>(this->Data + pos);
+  if ((header[0] != StepTag) || (header[1] + header[2] > this->Size) ||
+    (header[3] > this->Size))
+    return -1;
+
+  this->StepPos = pos;
+  this->NextPos = header[3];
+
+  if (parse)
+    {
+    BinaryStream str;
+    str.Pack(this->Data + header[1], header[2]);
+    str.SetReadPos(0);
+
+    this->Step = StepRecord();
+    this->Step.FromStream(str);
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int Reader::Advance()
+{
+  return this->Seek(this->StepIndex + 1);
+}
+
+// --------------------------------------------------------------------------
+int Reader::Seek(long stepIndex)
+{
+  if (!this->Valid || (stepIndex < this->StepIndex))
+    return -1;
+
+  // walk the step headers, parsing only the directory of the last step
+  while (this->Valid && (this->StepIndex < stepIndex))
+    {
+    this->StepIndex += 1;
+    this->Valid = !this->ReadStep(this->NextPos, this->StepIndex == stepIndex);
+    }
+
+  return this->Valid ? 0 : -1;
+}
+
+// --------------------------------------------------------------------------
+svtkDataArray *Reader::NewArray(const ArrayRecord &rec) const
+{
+  svtkDataArray *da = svtkDataArray::CreateDataArray(rec.Type);
+  if (!da)
+    {
+    SENSEI_ERROR("Array \"" << rec.Name << "\" has invalid type " << rec.Type)
+    return nullptr;
+    }
+
+  da->SetName(rec.Name.c_str());
+  da->SetNumberOfComponents(rec.NumberOfComponents);
+
+  svtkIdType nVals = svtkIdType(rec.NumberOfTuples) * rec.NumberOfComponents;
+  if (!nVals)
+    return da;
+
+  if (rec.Offset + uint64_t(nVals)*da->GetDataTypeSize() > this->Size)
+    {
+    SENSEI_ERROR("Array \"" << rec.Name << "\" extends past the end of \""
+      << this->FileName << "\"")
+    da->Delete();
+    return nullptr;
+    }
+
+  switch (rec.Type)
+    {
+    svtkTemplateMacro(
+      static_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da)->SetArray(
+        reinterpret_cast<SVTK_TT*>(this->Data + rec.Offset), nVals, 1);
+      );
+    default:
+      SENSEI_ERROR("Array \"" << rec.Name << "\" has invalid type " << rec.Type)
+      da->Delete();
+      return nullptr;
+    }
+
+  return da;
+}
+
+// --------------------------------------------------------------------------
+svtkDataSet *Reader::NewBlock(const BlockRecord &rec) const
+{
+  // wrap the named structure array
+  auto getArray = [&](const std::string &name) -> svtkSmartPointer<svtkDataArray>
+    {
+    svtkSmartPointer<svtkDataArray> da;
+    for (const ArrayRecord &arec : rec.Structure)
+      {
+      if (arec.Name == name)
+        {
+        da.TakeReference(this->NewArray(arec));
+        break;
+        }
+      }
+    return da;
+    };
+
+  auto getPoints = [&]() -> svtkSmartPointer<svtkPoints>
+    {
+    svtkSmartPointer<svtkPoints> pts;
+    if (svtkSmartPointer<svtkDataArray> da = getArray("points"))
+      {
+      pts = svtkSmartPointer<svtkPoints>::New();
+      pts->SetData(da);
+      }
+    return pts;
+    };
+
+  auto getCells = [&](const std::string &name) -> svtkSmartPointer<svtkCellArray>
+    {
+    svtkSmartPointer<svtkCellArray> ca;
+    svtkSmartPointer<svtkDataArray> offs = getArray(name + "offsets");
+    svtkSmartPointer<svtkDataArray> conn = getArray(name + "connectivity");
+    if (offs && conn)
+      {
+      ca = svtkSmartPointer<svtkCellArray>::New();
+      ca->SetData(offs, conn);
+      }
+    return ca;
+    };
+
+  switch (rec.Type)
+    {
+    case SVTK_IMAGE_DATA:
+    case SVTK_UNIFORM_GRID:
+    case SVTK_STRUCTURED_POINTS:
+      {
+      svtkImageData *im = rec.Type == SVTK_UNIFORM_GRID ? svtkUniformGrid::New() :
+        (rec.Type == SVTK_STRUCTURED_POINTS ? svtkStructuredPoints::New() :
+        svtkImageData::New());
+      im->SetExtent(const_cast<int*>(rec.Extent.data()));
+      im->SetOrigin(rec.Origin.data());
+      im->SetSpacing(rec.Spacing.data());
+      return im;
+      }
+    case SVTK_RECTILINEAR_GRID:
+      {
+      svtkRectilinearGrid *rg = svtkRectilinearGrid::New();
+      rg->SetExtent(const_cast<int*>(rec.Extent.data()));
+      rg->SetXCoordinates(getArray("x"));
+      rg->SetYCoordinates(getArray("y"));
+      rg->SetZCoordinates(getArray("z"));
+      return rg;
+      }
+    case SVTK_STRUCTURED_GRID:
+      {
+      svtkStructuredGrid *sg = svtkStructuredGrid::New();
+      sg->SetExtent(const_cast<int*>(rec.Extent.data()));
+      sg->SetPoints(getPoints());
+      return sg;
+      }
+    case SVTK_UNSTRUCTURED_GRID:
+      {
+      svtkUnstructuredGrid *ug = svtkUnstructuredGrid::New();
+      ug->SetPoints(getPoints());
+      svtkSmartPointer<svtkDataArray> types = getArray("types");
+      svtkSmartPointer<svtkCellArray> cells = getCells("");
+      if (types && cells)
+        ug->SetCells(static_cast<svtkUnsignedCharArray*>(types.Get()), cells);
+      return ug;
+      }
+    case SVTK_POLY_DATA:
+      {
+      svtkPolyData *pd = svtkPolyData::New();
+      pd->SetPoints(getPoints());
+      pd->SetVerts(getCells("verts_"));
+      pd->SetLines(getCells("lines_"));
+      pd->SetPolys(getCells("polys_"));
+      pd->SetStrips(getCells("strips_"));
+      return pd;
+      }
+    }
+
+  SENSEI_ERROR("Block " << rec.Id << " has unsupported type " << rec.Type)
+  return nullptr;
+}
+
+// --------------------------------------------------------------------------
+svtkOverlappingAMR *Reader::NewAMR(const AMRRecord &rec)
+{
+  int nLevels = rec.BlocksPerLevel.size();
+
+  svtkOverlappingAMR *amr = svtkOverlappingAMR::New();
+  amr->Initialize(nLevels, rec.BlocksPerLevel.data());
+  amr->SetOrigin(rec.Origin.data());
+  amr->SetGridDescription(rec.GridDescription);
+
+  int q = 0;
+  for (int i = 0; i < nLevels; ++i)
+    {
+    amr->SetSpacing(i, rec.Spacing[i].data());
+    amr->SetRefinementRatio(i, rec.RefinementRatio[i]);
+
+    for (int j = 0; j < rec.BlocksPerLevel[i]; ++j, ++q)
+      {
+      const int *box = rec.Boxes[q].data();
+      amr->SetAMRBox(i, j, svtkAMRBox(box, box + 3));
+      amr->SetAMRBlockSourceIndex(i, j, rec.SourceIndex[q]);
+      }
+    }
+
+  return amr;
+}
+
+}
+}
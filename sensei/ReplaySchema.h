@@ -0,0 +1,248 @@
+#ifndef sensei_ReplaySchema_h
+#define sensei_ReplaySchema_h
+
+/// @file
+
+#include "senseiConfig.h"
+#include "MeshMetadata.h"
+#include "BinaryStream.h"
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+class svtkDataArray;
+class svtkDataSet;
+class svtkOverlappingAMR;
+
+namespace sensei
+{
+
+/** The layout of the recordings written by the ReplayAnalysisAdaptor and
+ * served by the ReplayDataAdaptor. Each rank writes its own stream. The
+ * stream starts with a header followed by the time steps. A time step starts
+ * with a fixed size header giving the location of its directory and of the
+ * next time step, followed by the data of the arrays, each aligned to
+ * ReplaySchema::Alignment bytes, followed by the directory. The directory is
+ * a BinaryStream describing the meshes, blocks and arrays of the step, with
+ * the absolute file offset of the data of each array. The structure of the
+ * blocks of static meshes is written on the first step only, later steps
+ * refer to it. The alignment lets a reader that maps the stream into memory
+ * pass the arrays to SVTK zero copy.
+ */
+namespace ReplaySchema
+{
+
+/// the alignment, in bytes, of the data of each array
+constexpr uint64_t Alignment = 64;
+
+/// identifies the stream and each time step
+constexpr uint64_t FileTag = 0x59414c5045524e53ul;
+constexpr uint64_t StepTag = 0x5045545345524e53ul;
+
+/// the version of the layout
+constexpr uint64_t Version = 1;
+
+/// an array of a block, or of the structure of a block
+struct SENSEI_EXPORT ArrayRecord
+{
+  ArrayRecord() : Association(-1), Type(0), NumberOfComponents(1),
+    NumberOfTuples(0), Offset(0) {}
+
+  void ToStream(BinaryStream &str) const;
+  void FromStream(BinaryStream &str);
+
+  std::string Name;         ///< the array name
+  int Association;          ///< svtkDataObject::POINT, CELL, or -1
+  int Type;                 ///< the SVTK data type
+  int NumberOfComponents;   ///< the number of components
+  long NumberOfTuples;      ///< the number of tuples
+  uint64_t Offset;          ///< the file offset of the data
+};
+
+/// a block of a mesh
+struct SENSEI_EXPORT BlockRecord
+{
+  BlockRecord() : Id(0), Type(0), Level(0), Index(0),
+    Extent{{0, -1, 0, -1, 0, -1}}, Origin{{0., 0., 0.}},
+    Spacing{{1., 1., 1.}} {}
+
+  void ToStream(BinaryStream &str) const;
+  void FromStream(BinaryStream &str);
+
+  /// find an array. returns null if it was not recorded
+  const ArrayRecord *GetArray(int association, const std::string &name) const;
+
+  long Id;                          ///< the block id
+  int Type;                         ///< the SVTK data object type
+  int Level;                        ///< the AMR level
+  int Index;                        ///< the index of the block in the level
+  std::array<int,6> Extent;         ///< point extent of structured blocks
+  std::array<double,3> Origin;      ///< origin of image data
+  std::array<double,3> Spacing;     ///< spacing of image data
+  std::vector<ArrayRecord> Structure; ///< coordinates and topology
+  std::vector<ArrayRecord> Arrays;  ///< the point and cell data
+};
+
+/// the description of the levels of an AMR mesh, shared by all ranks
+struct SENSEI_EXPORT AMRRecord
+{
+  AMRRecord() : Origin{{0., 0., 0.}}, GridDescription(0) {}
+
+  void ToStream(BinaryStream &str) const;
+  void FromStream(BinaryStream &str);
+
+  std::array<double,3> Origin;
+  int GridDescription;
+  std::vector<int> BlocksPerLevel;
+  std::vector<int> RefinementRatio;
+  std::vector<std::array<double,3>> Spacing;
+  std::vector<std::array<int,6>> Boxes;   ///< lo and hi corners, level by level
+  std::vector<int> SourceIndex;
+};
+
+/// a mesh of a time step
+struct SENSEI_EXPORT MeshRecord
+{
+  MeshRecord() : ObjectType(0) {}
+
+  void ToStream(BinaryStream &str) const;
+  void FromStream(BinaryStream &str);
+
+  /// find a block. returns null if it was not recorded on this rank
+  const BlockRecord *GetBlock(long id) const;
+
+  MeshMetadataPtr Metadata;   ///< global view of the sender's metadata
+  int ObjectType;             ///< the SVTK type of the mesh
+  AMRRecord AMR;              ///< the levels of AMR meshes
+  std::vector<BlockRecord> Blocks;  ///< the blocks recorded on this rank
+  std::map<long, size_t> BlockIndex;
+};
+
+/// the directory of a time step
+struct SENSEI_EXPORT StepRecord
+{
+  StepRecord() : TimeStep(0), Time(0.) {}
+
+  void ToStream(BinaryStream &str) const;
+  void FromStream(BinaryStream &str);
+
+  /// find a mesh. returns null if it was not recorded
+  const MeshRecord *GetMesh(const std::string &name) const;
+
+  long TimeStep;
+  double Time;
+  std::vector<MeshRecord> Meshes;
+};
+
+/// get the name of the stream of a rank
+SENSEI_EXPORT
+std::string GetFileName(const std::string &prefix, int rank);
+
+/// appends time steps to the stream of a rank
+class SENSEI_EXPORT Writer
+{
+public:
+  Writer() : Pos(0), StepPos(0) {}
+  ~Writer() { this->Close(); }
+
+  /// create the stream. returns 0 if successful
+  int Open(const std::string &fileName, int rank, int nRanks);
+
+  /// close the stream
+  int Close();
+
+  /// start a time step
+  int BeginStep();
+
+  /** write the data of an array, filling in its record. Arrays that do not
+   * use the standard memory layout are copied.
+   */
+  int WriteArray(svtkDataArray *da, const std::string &name,
+    int association, ArrayRecord &rec);
+
+  /** write the coordinates and topology of a block, filling in its record.
+   * Image data, rectilinear, structured, and unstructured grids, and poly
+   * data are supported.
+   */
+  int WriteStructure(svtkDataSet *ds, BlockRecord &rec);
+
+  /// write the directory and finish the time step
+  int EndStep(const StepRecord &step);
+
+private:
+  int Pad(uint64_t alignment);
+
+  std::ofstream Stream;
+  uint64_t Pos;
+  uint64_t StepPos;
+};
+
+/// serves the time steps of a stream mapped into memory
+class SENSEI_EXPORT Reader
+{
+public:
+  Reader() : Data(nullptr), Size(0), NumberOfRanks(0), Valid(false),
+    StepIndex(-1), StepPos(0), NextPos(0) {}
+
+  ~Reader() { this->Close(); }
+
+  Reader(const Reader&) = delete;
+  void operator=(const Reader&) = delete;
+
+  /// map the stream and read the first time step. returns 0 if successful
+  int Open(const std::string &fileName);
+
+  /// unmap the stream. arrays served from it are no longer valid
+  int Close();
+
+  /// the number of ranks that wrote the recording
+  int GetNumberOfRanks() const { return this->NumberOfRanks; }
+
+  /// true while the current time step is valid
+  bool Good() const { return this->Valid; }
+
+  /// the index of the current time step, counting from 0
+  long GetStepIndex() const { return this->StepIndex; }
+
+  /// move to the next time step. returns non-zero at the end of the stream
+  int Advance();
+
+  /// move forward to the time step with the given index
+  int Seek(long stepIndex);
+
+  /// the directory of the current time step
+  const StepRecord &GetStep() const { return this->Step; }
+
+  /// wrap recorded data in a new SVTK array, zero copy
+  svtkDataArray *NewArray(const ArrayRecord &rec) const;
+
+  /// create a new block from its recorded structure
+  svtkDataSet *NewBlock(const BlockRecord &rec) const;
+
+  /// create a new AMR mesh from the recorded levels, with no blocks
+  static svtkOverlappingAMR *NewAMR(const AMRRecord &rec);
+
+private:
+  // read the header of the time step at pos, and its directory when parse
+  // is set. returns non-zero when there is no complete time step at pos
+  int ReadStep(uint64_t pos, bool parse);
+
+  std::string FileName;
+  char *Data;
+  uint64_t Size;
+  int NumberOfRanks;
+  bool Valid;
+  long StepIndex;
+  uint64_t StepPos;
+  uint64_t NextPos;
+  StepRecord Step;
+};
+
+}
+}
+
+#endif
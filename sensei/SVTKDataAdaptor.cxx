@@ -35,9 +35,28 @@ namespace sensei
 
 struct SVTKDataAdaptor::InternalsType
 {
+  // look up a block of the named mesh, indexing the mesh on first use
+  svtkDataSet *GetBlock(const std::string &meshName, svtkDataObject *dobj,
+    long blockId);
+
   MeshMapType MeshMap;
+  std::map<std::string, SVTKUtils::BlockMap> BlockMaps;
 };
 
+//----------------------------------------------------------------------------
+svtkDataSet *SVTKDataAdaptor::InternalsType::GetBlock(
+  const std::string &meshName, svtkDataObject *dobj, long blockId)
+{
+  auto it = this->BlockMaps.find(meshName);
+  if (it == this->BlockMaps.end())
+    {
+    it = this->BlockMaps.emplace(meshName, SVTKUtils::BlockMap()).first;
+    it->second.Initialize(dobj);
+    }
+
+  return it->second.GetBlock(blockId);
+}
+
 //----------------------------------------------------------------------------
 senseiNewMacro(SVTKDataAdaptor);
 
@@ -59,6 +78,7 @@ void SVTKDataAdaptor::SetDataObject(const std::string &meshName,
 {
   this->Internals->MeshMap[meshName] =
     SVTKUtils::AsCompositeData(this->GetCommunicator(), dobj, false);
+  this->Internals->BlockMaps.erase(meshName);
 }
 
 //----------------------------------------------------------------------------
@@ -154,12 +174,16 @@ int SVTKDataAdaptor::GetMesh(const std::string &meshName, bool structureOnly,
     svtkCompositeDataSet *cdo = cd->NewInstance();
     cdo->CopyStructure(cd);
 
+    // AMR requires the grid description of its blocks to be consistent.
+    // the structure of a uniform grid is only a few values, so copy it
+    bool amr = dynamic_cast<svtkOverlappingAMR*>(cd);
+
     svtkCompositeDataIterator *cdit = cd->NewIterator();
     while (!cdit->IsDoneWithTraversal())
       {
       svtkDataObject *dobj = cd->GetDataSet(cdit);
       svtkDataObject *dobjo = dobj->NewInstance();
-      if (!structureOnly)
+      if (!structureOnly || amr)
         {
         if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj))
           {
@@ -200,9 +224,10 @@ int SVTKDataAdaptor::GetMesh(const std::string &meshName, bool structureOnly,
 int SVTKDataAdaptor::AddArray(svtkDataObject* mesh, const std::string &meshName,
   int association, const std::string &arrayName)
 {
-  // define helper function to add the array to the mesh
-  SVTKUtils::BinaryDatasetFunction addArray =
-    [&](svtkDataSet *ds, svtkDataSet *dsOut) -> int
+  // define helper function to add the array to the mesh. blocks are
+  // independent and may be processed concurrently.
+  SVTKUtils::IndexedBinaryDatasetFunction addArray =
+    [&](int, int, svtkDataSet *ds, svtkDataSet *dsOut) -> int
     {
     svtkFieldData *dsa = SVTKUtils::GetAttributes(ds, association);
     svtkFieldData *dsaOut = SVTKUtils::GetAttributes(dsOut, association);
@@ -239,6 +264,172 @@ int SVTKDataAdaptor::AddArray(svtkDataObject* mesh, const std::string &meshName,
   return 0;
 }
 
+//----------------------------------------------------------------------------
+int SVTKDataAdaptor::AddGhostArray(svtkDataObject* mesh,
+  const std::string &meshName, int association)
+{
+  // define helper function to add the ghost array to the mesh. blocks
+  // without ghost zones are skipped. blocks are independent and may be
+  // processed concurrently.
+  SVTKUtils::IndexedBinaryDatasetFunction addArray =
+    [&](int, int, svtkDataSet *ds, svtkDataSet *dsOut) -> int
+    {
+    svtkFieldData *dsa = SVTKUtils::GetAttributes(ds, association);
+    svtkFieldData *dsaOut = SVTKUtils::GetAttributes(dsOut, association);
+
+    svtkDataArray *da = dsa->GetArray("svtkGhostType");
+    if (da)
+      dsaOut->AddArray(da);
+
+    return 0;
+    };
+
+  // get the cached copy of the mesh
+  svtkDataObject *dobj = nullptr;
+  if (this->GetDataObject(meshName, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  // apply the helper function
+  if (SVTKUtils::Apply(dobj, mesh, addArray))
+    {
+    SENSEI_ERROR("Failed to add ghost " << SVTKUtils::GetAttributesName(association)
+      << " to mesh \"" << meshName  << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SVTKDataAdaptor::AddGhostNodesArray(svtkDataObject* mesh,
+  const std::string &meshName)
+{
+  return this->AddGhostArray(mesh, meshName, svtkDataObject::POINT);
+}
+
+//----------------------------------------------------------------------------
+int SVTKDataAdaptor::AddGhostCellsArray(svtkDataObject* mesh,
+  const std::string &meshName)
+{
+  return this->AddGhostArray(mesh, meshName, svtkDataObject::CELL);
+}
+
+//----------------------------------------------------------------------------
+int SVTKDataAdaptor::GetMeshBlock(const std::string &meshName, long blockId,
+  bool structureOnly, svtkDataObject *&block)
+{
+  block = nullptr;
+
+  svtkDataObject *dobj = nullptr;
+  if (this->GetDataObject(meshName, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  svtkDataSet *ds = this->Internals->GetBlock(meshName, dobj, blockId);
+  if (!ds)
+    {
+    SENSEI_ERROR("No block " << blockId << " in mesh \""
+      << meshName << "\" on this rank")
+    return -1;
+    }
+
+  svtkDataSet *dsOut = ds->NewInstance();
+
+  if (!structureOnly)
+    dsOut->CopyStructure(ds);
+
+  block = dsOut;
+  // caller takes ownership
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SVTKDataAdaptor::AddArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association,
+  const std::string &arrayName)
+{
+  svtkDataObject *dobj = nullptr;
+  if (this->GetDataObject(meshName, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  svtkDataSet *ds = this->Internals->GetBlock(meshName, dobj, blockId);
+  svtkDataSet *dsOut = dynamic_cast<svtkDataSet*>(block);
+  if (!ds || !dsOut)
+    {
+    SENSEI_ERROR("No block " << blockId << " in mesh \""
+      << meshName << "\" on this rank")
+    return -1;
+    }
+
+  svtkDataArray *da =
+    SVTKUtils::GetAttributes(ds, association)->GetArray(arrayName.c_str());
+  if (!da)
+    {
+    SENSEI_ERROR("No " << SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\" in block " << blockId
+      << " of mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  SVTKUtils::GetAttributes(dsOut, association)->AddArray(da);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SVTKDataAdaptor::AddGhostArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId, int association)
+{
+  svtkDataObject *dobj = nullptr;
+  if (this->GetDataObject(meshName, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  svtkDataSet *ds = this->Internals->GetBlock(meshName, dobj, blockId);
+  svtkDataSet *dsOut = dynamic_cast<svtkDataSet*>(block);
+  if (!ds || !dsOut)
+    {
+    SENSEI_ERROR("No block " << blockId << " in mesh \""
+      << meshName << "\" on this rank")
+    return -1;
+    }
+
+  // blocks without ghost zones are skipped
+  svtkDataArray *da =
+    SVTKUtils::GetAttributes(ds, association)->GetArray("svtkGhostType");
+  if (da)
+    SVTKUtils::GetAttributes(dsOut, association)->AddArray(da);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int SVTKDataAdaptor::AddGhostNodesArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  return this->AddGhostArrayToBlock(block, meshName, blockId,
+    svtkDataObject::POINT);
+}
+
+//----------------------------------------------------------------------------
+int SVTKDataAdaptor::AddGhostCellsArrayToBlock(svtkDataObject *block,
+  const std::string &meshName, long blockId)
+{
+  return this->AddGhostArrayToBlock(block, meshName, blockId,
+    svtkDataObject::CELL);
+}
+
 // TODO
 /*
 //----------------------------------------------------------------------------
@@ -329,7 +520,8 @@ int SVTKDataAdaptor::GetArrayName(const std::string &meshName, int association,
 int SVTKDataAdaptor::ReleaseData()
 {
   this->Internals->MeshMap.clear();
-  return 0;
+  this->Internals->BlockMaps.clear();
+  return this->Superclass::ReleaseData();
 }
 
 }
@@ -53,8 +53,43 @@ public:
   int AddArray(svtkDataObject* mesh, const std::string &meshName,
     int association, const std::string &arrayName) override;
 
+  /// Passes the "svtkGhostType" point data array, if present, to the mesh
+  int AddGhostNodesArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  /// Passes the "svtkGhostType" cell data array, if present, to the mesh
+  int AddGhostCellsArray(svtkDataObject* mesh,
+    const std::string &meshName) override;
+
+  /// Copies the structure of the requested block
+  int GetMeshBlock(const std::string &meshName, long blockId,
+    bool structureOnly, svtkDataObject *&block) override;
+
+  /// Passes the named array of the requested block
+  int AddArrayToBlock(svtkDataObject *block, const std::string &meshName,
+    long blockId, int association, const std::string &arrayName) override;
+
+  /// Passes the "svtkGhostType" point data array, if present, to the block
+  int AddGhostNodesArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+  /// Passes the "svtkGhostType" cell data array, if present, to the block
+  int AddGhostCellsArrayToBlock(svtkDataObject *block,
+    const std::string &meshName, long blockId) override;
+
+  /// The blocks are served from the mesh held in memory
+  bool StreamsMeshBlocks(const std::string &) override { return true; }
+
   int ReleaseData() override;
 
+  // adds the ghost array with the given association
+  int AddGhostArray(svtkDataObject* mesh, const std::string &meshName,
+    int association);
+
+  // adds the ghost array with the given association to a single block
+  int AddGhostArrayToBlock(svtkDataObject *block, const std::string &meshName,
+    long blockId, int association);
+
 protected:
   SVTKDataAdaptor();
   ~SVTKDataAdaptor();
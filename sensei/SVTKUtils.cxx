@@ -119,6 +119,10 @@
 #endif
 
 #include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
 #include <functional>
 #include <mpi.h>
 
@@ -560,6 +564,172 @@ int Apply(svtkDataObject *dobj, DatasetFunction &func)
   return 0;
 }
 
+// the number of threads used by the threaded variants of Apply, initialized
+// from the environment on first use
+static int NumberOfThreads = 0;
+
+//----------------------------------------------------------------------------
+void SetNumberOfThreads(int nThreads)
+{
+  NumberOfThreads = std::max(1, nThreads);
+}
+
+//----------------------------------------------------------------------------
+int GetNumberOfThreads()
+{
+  if (NumberOfThreads < 1)
+    {
+    char *tmp = getenv("SENSEI_SVTK_UTILS_THREADS");
+    NumberOfThreads = tmp ? std::max(1, atoi(tmp)) : 1;
+    }
+  return NumberOfThreads;
+}
+
+//----------------------------------------------------------------------------
+static
+int GetLeaves(svtkCompositeDataSet *cd, svtkCompositeDataSet *cdo,
+  std::vector<svtkDataSet*> &leaves, std::vector<svtkDataSet*> &leavesOut)
+{
+  svtkCompositeDataIteratorPtr cdit;
+  cdit.TakeReference(cd->NewIterator());
+  while (!cdit->IsDoneWithTraversal())
+    {
+    svtkDataObject *obj = cd->GetDataSet(cdit);
+    svtkDataObject *objOut = cdo ? cdo->GetDataSet(cdit) : nullptr;
+
+    // recurse through nested composite datasets
+    if (svtkCompositeDataSet *cdn = dynamic_cast<svtkCompositeDataSet*>(obj))
+      {
+      svtkCompositeDataSet *cdnOut = static_cast<svtkCompositeDataSet*>(objOut);
+      if (GetLeaves(cdn, cdnOut, leaves, leavesOut))
+        return -1;
+      }
+    else if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(obj))
+      {
+      leaves.push_back(ds);
+      if (cdo)
+        leavesOut.push_back(static_cast<svtkDataSet*>(objOut));
+      }
+    else if (obj)
+      {
+      SENSEI_ERROR("Can't apply to " << obj->GetClassName())
+      return -1;
+      }
+    cdit->GoToNextItem();
+    }
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int GetLeaves(svtkDataObject *dobj, svtkDataObject *dobjo,
+  std::vector<svtkDataSet*> &leaves, std::vector<svtkDataSet*> &leavesOut)
+{
+  if (svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(dobj))
+    {
+    svtkCompositeDataSet *cdo = static_cast<svtkCompositeDataSet*>(dobjo);
+    return GetLeaves(cd, cdo, leaves, leavesOut);
+    }
+  else if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj))
+    {
+    leaves.push_back(ds);
+    if (dobjo)
+      leavesOut.push_back(static_cast<svtkDataSet*>(dobjo));
+    return 0;
+    }
+
+  SENSEI_ERROR("Unsupoorted data object type "
+    << (dobj ? dobj->GetClassName() : "nullptr"))
+  return -1;
+}
+
+//----------------------------------------------------------------------------
+int GetLeaves(svtkDataObject *dobj, std::vector<svtkDataSet*> &leaves)
+{
+  std::vector<svtkDataSet*> leavesOut;
+  return GetLeaves(dobj, nullptr, leaves, leavesOut);
+}
+
+//----------------------------------------------------------------------------
+static
+int ParallelApply(int nLeaves, int nThreads,
+  const std::function<int(int,int)> &func)
+{
+  if (nThreads < 1)
+    nThreads = GetNumberOfThreads();
+
+  nThreads = std::max(1, std::min(nThreads, nLeaves));
+
+  // leaves are handed out one at a time so that threads finishing early
+  // take on more of the work. 0 running, 1 stopped, -1 failed
+  std::atomic<int> next(0);
+  std::atomic<int> status(0);
+
+  auto work = [&](int thread)
+    {
+    int leaf = 0;
+    while (!status.load() && ((leaf = next++) < nLeaves))
+      {
+      int ret = func(leaf, thread);
+      if (ret < 0)
+        {
+        SENSEI_ERROR("Function failed in apply at leaf " << leaf)
+        status = -1;
+        }
+      else if (ret > 0)
+        {
+        int running = 0;
+        status.compare_exchange_strong(running, 1);
+        }
+      }
+    };
+
+  std::vector<std::thread> threads;
+  for (int i = 1; i < nThreads; ++i)
+    threads.emplace_back(work, i);
+
+  work(0);
+
+  for (std::thread &thread : threads)
+    thread.join();
+
+  return status.load();
+}
+
+//----------------------------------------------------------------------------
+template <typename T>
+void Append(std::vector<T> &dest, std::vector<T> &src)
+{
+  dest.insert(dest.end(), std::make_move_iterator(src.begin()),
+    std::make_move_iterator(src.end()));
+}
+
+//----------------------------------------------------------------------------
+int Apply(svtkDataObject *dobj, IndexedDatasetFunction &func, int nThreads)
+{
+  std::vector<svtkDataSet*> leaves;
+  if (GetLeaves(dobj, leaves))
+    return -1;
+
+  return ParallelApply(leaves.size(), nThreads,
+    [&](int leaf, int thread) -> int { return func(leaf, thread, leaves[leaf]); });
+}
+
+//----------------------------------------------------------------------------
+int Apply(svtkDataObject *dobj, svtkDataObject *dobjo,
+  IndexedBinaryDatasetFunction &func, int nThreads)
+{
+  std::vector<svtkDataSet*> leaves;
+  std::vector<svtkDataSet*> leavesOut;
+  if (GetLeaves(dobj, dobjo, leaves, leavesOut))
+    return -1;
+
+  return ParallelApply(leaves.size(), nThreads,
+    [&](int leaf, int thread) -> int
+    {
+    return func(leaf, thread, leaves[leaf], leavesOut[leaf]);
+    });
+}
+
 //----------------------------------------------------------------------------
 int GetGhostLayerMetadata(svtkDataObject *mesh,
   int &nGhostCellLayers, int &nGhostNodeLayers)
@@ -664,6 +834,7 @@ int GetBlockMetadata(int rank, int id, svtkDataSet *ds,
   std::vector<int> &blockIds, std::vector<long> &blockPoints,
   std::vector<long> &blockCells, std::vector<long> &blockCellArraySize,
   std::vector<std::array<int,6>> &blockExtents,
+  std::vector<std::array<int,6>> &blockOwnedExtents,
   std::vector<std::array<double,6>> &blockBounds,
   std::vector<std::vector<std::array<double,2>>> &blockArrayRange)
 {
@@ -703,21 +874,17 @@ int GetBlockMetadata(int rank, int id, svtkDataSet *ds,
 
   if (flags.BlockExtentsSet())
     {
-    std::array<int,6> ext = {1, 0, 1, 0, 1, 0};
-    if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
-      {
-      im->GetExtent(ext.data());
-      }
-    else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
-      {
-      rg->GetExtent(ext.data());
-      }
-    else if (svtkStructuredGrid *sg = dynamic_cast<svtkStructuredGrid*>(ds))
-      {
-      sg->GetExtent(ext.data());
-      }
+    // the metadata holds cell extents, see MeshMetadataFlags::SetBlockExtents
+    std::array<int,6> ext;
+    GetCellExtent(ds, ext);
     blockExtents.emplace_back(std::move(ext));
 
+    // the owned cells, so that analyses can skip ghost cells without the
+    // ghost array
+    std::array<int,6> ownedExt;
+    GetOwnedExtent(ds, ownedExt);
+    blockOwnedExtents.emplace_back(std::move(ownedExt));
+
     // TODO -- for AMR meshes extract blocvk level
     }
 
@@ -749,7 +916,8 @@ int GetBlockMetadata(int rank, int id, svtkDataSet *ds, MeshMetadataPtr metadata
     return GetBlockMetadata(rank, id, ds, metadata->Flags,
       metadata->BlockOwner, metadata->BlockIds, metadata->BlockNumPoints,
       metadata->BlockNumCells, metadata->BlockCellArraySize,
-      metadata->BlockExtents, metadata->BlockBounds, metadata->BlockArrayRange);
+      metadata->BlockExtents, metadata->BlockOwnedExtents, metadata->BlockBounds,
+      metadata->BlockArrayRange);
 }
 
 // --------------------------------------------------------------------------
@@ -783,24 +951,24 @@ int GetMetadata(MPI_Comm comm, svtkCompositeDataSet *cd, MeshMetadataPtr metadat
   int numBlocksLocal = 0;
   cdit->SetSkipEmptyNodes(0);
 
+  // AMR flat indices start at 0, multiblock flat indices start at 1
+  int bidShift = amrds ? 0 : 1;
+
+  std::vector<svtkDataSet*> blocks;
+  std::vector<int> blockIds;
+
   for (cdit->InitTraversal(); !cdit->IsDoneWithTraversal(); cdit->GoToNextItem())
     {
     numBlocks += 1;
 
     svtkDataObject *dobj = cd->GetDataSet(cdit);
-    int bid = std::max(0, int(cdit->GetCurrentFlatIndex() - 1));
+    int bid = std::max(0, int(cdit->GetCurrentFlatIndex()) - bidShift);
 
     if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj))
       {
       numBlocksLocal += 1;
-
-      if (SVTKUtils::GetBlockMetadata(rank, bid, ds, metadata))
-        {
-        SENSEI_ERROR("Failed to get block metadata for block "
-         << cdit->GetCurrentFlatIndex())
-        cdit->Delete();
-        return -1;
-        }
+      blocks.push_back(ds);
+      blockIds.push_back(bid);
       }
     }
 
@@ -809,6 +977,38 @@ int GetMetadata(MPI_Comm comm, svtkCompositeDataSet *cd, MeshMetadataPtr metadat
   metadata->NumBlocksLocal = {numBlocksLocal};
   cdit->Delete();
 
+  // the blocks are independent, gather their metadata concurrently and
+  // append it in block order
+  BlockReduction<MeshMetadataPtr> blockMd(numBlocksLocal, nullptr);
+
+  auto getBlockMetadata = [&](int leaf, int) -> int
+    {
+    blockMd[leaf] = MeshMetadata::New(metadata->Flags);
+    if (SVTKUtils::GetBlockMetadata(rank, blockIds[leaf], blocks[leaf], blockMd[leaf]))
+      {
+      SENSEI_ERROR("Failed to get block metadata for block " << blockIds[leaf])
+      return -1;
+      }
+    return 0;
+    };
+
+  if (ParallelApply(numBlocksLocal, -1, getBlockMetadata))
+    return -1;
+
+  for (int i = 0; i < numBlocksLocal; ++i)
+    {
+    MeshMetadataPtr &md = blockMd[i];
+    Append(metadata->BlockOwner, md->BlockOwner);
+    Append(metadata->BlockIds, md->BlockIds);
+    Append(metadata->BlockNumPoints, md->BlockNumPoints);
+    Append(metadata->BlockNumCells, md->BlockNumCells);
+    Append(metadata->BlockCellArraySize, md->BlockCellArraySize);
+    Append(metadata->BlockExtents, md->BlockExtents);
+    Append(metadata->BlockOwnedExtents, md->BlockOwnedExtents);
+    Append(metadata->BlockBounds, md->BlockBounds);
+    Append(metadata->BlockArrayRange, md->BlockArrayRange);
+    }
+
   // get global bounds and extents
   if (metadata->Flags.BlockBoundsSet())
     MPIUtils::GlobalBounds(comm, metadata->BlockBounds, metadata->Bounds);
@@ -822,6 +1022,9 @@ int GetMetadata(MPI_Comm comm, svtkCompositeDataSet *cd, MeshMetadataPtr metadat
     if (metadata->Flags.BlockDecompSet())
       MPIUtils::GlobalViewV(comm, metadata->BlockOwner);
 
+    // covered cells are masked on AMR blocks, the ghost array is required
+    metadata->BlockOwnedExtents.clear();
+
     // these are all always global views
     metadata->NumLevels = amrds->GetNumberOfLevels();
     metadata->BlockLevel.resize(metadata->NumBlocks);
@@ -921,6 +1124,276 @@ svtkCompositeDataSetPtr AsCompositeData(MPI_Comm comm,
   return cd;
 }
 
+// --------------------------------------------------------------------------
+svtkDataSet *GetBlock(svtkDataObject *mesh, long blockId)
+{
+  if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(mesh))
+    return ds;
+
+  svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(mesh);
+  if (!cd)
+    return nullptr;
+
+  // AMR flat indices start at 0, multiblock flat indices start at 1
+  long bidShift = dynamic_cast<svtkUniformGridAMR*>(cd) ? 0 : 1;
+
+  svtkCompositeDataIteratorPtr it;
+  it.TakeReference(cd->NewIterator());
+  it->SetSkipEmptyNodes(1);
+
+  for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
+    {
+    if (long(it->GetCurrentFlatIndex()) - bidShift == blockId)
+      return dynamic_cast<svtkDataSet*>(it->GetCurrentDataObject());
+    }
+
+  return nullptr;
+}
+
+// --------------------------------------------------------------------------
+void BlockMap::Initialize(svtkDataObject *mesh)
+{
+  this->Clear();
+
+  if ((this->Single = dynamic_cast<svtkDataSet*>(mesh)))
+    return;
+
+  svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(mesh);
+  if (!cd)
+    return;
+
+  // AMR flat indices start at 0, multiblock flat indices start at 1
+  long bidShift = dynamic_cast<svtkUniformGridAMR*>(cd) ? 0 : 1;
+
+  svtkCompositeDataIteratorPtr it;
+  it.TakeReference(cd->NewIterator());
+  it->SetSkipEmptyNodes(1);
+
+  for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
+    {
+    if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(it->GetCurrentDataObject()))
+      this->Blocks[long(it->GetCurrentFlatIndex()) - bidShift] = ds;
+    }
+}
+
+// --------------------------------------------------------------------------
+svtkDataSet *BlockMap::GetBlock(long blockId) const
+{
+  if (this->Single)
+    return this->Single;
+
+  auto it = this->Blocks.find(blockId);
+  return it == this->Blocks.end() ? nullptr : it->second;
+}
+
+// --------------------------------------------------------------------------
+void BlockMap::Clear()
+{
+  this->Single = nullptr;
+  this->Blocks.clear();
+}
+
+// --------------------------------------------------------------------------
+int GetLocalBlockIds(int rank, const MeshMetadataPtr &md,
+  std::vector<long> &ids)
+{
+  ids.clear();
+
+  if (!md->Flags.BlockDecompSet())
+    {
+    SENSEI_ERROR("Metadata for mesh \"" << md->MeshName
+      << "\" is missing the block decomposition")
+    return -1;
+    }
+
+  size_t nIds = md->BlockIds.size();
+
+  // with a local view all of the blocks are local. a global view of block
+  // owner may accompany a local view of block ids as in the case of AMR
+  if (md->BlockOwner.size() != nIds)
+    {
+    ids.assign(md->BlockIds.begin(), md->BlockIds.end());
+    return 0;
+    }
+
+  for (size_t i = 0; i < nIds; ++i)
+    {
+    if (md->BlockOwner[i] == rank)
+      ids.push_back(md->BlockIds[i]);
+    }
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+long GetLocalArraySize(int rank, const MeshMetadataPtr &md,
+  int association, const std::vector<std::string> &arrayNames)
+{
+  if (!md->Flags.BlockSizeSet())
+    return -1;
+
+  const std::vector<long> &blockSize = association == svtkDataObject::POINT ?
+    md->BlockNumPoints : md->BlockNumCells;
+
+  // filter by owner when given a global view
+  bool global = md->BlockOwner.size() == blockSize.size();
+
+  long nElem = 0;
+  size_t nBlocks = blockSize.size();
+  for (size_t i = 0; i < nBlocks; ++i)
+    {
+    if (!global || (md->BlockOwner[i] == rank))
+      nElem += blockSize[i];
+    }
+
+  long elemSize = 0;
+  size_t nNames = arrayNames.size();
+  for (size_t j = 0; j < nNames; ++j)
+    {
+    for (int i = 0; i < md->NumArrays; ++i)
+      {
+      if ((md->ArrayName[i] == arrayNames[j]) &&
+        (md->ArrayCentering[i] == association))
+        {
+        elemSize += md->ArrayComponents[i]*Size(md->ArrayType[i]);
+        break;
+        }
+      }
+    }
+
+  return nElem*elemSize;
+}
+
+// --------------------------------------------------------------------------
+int GetCellExtent(svtkDataSet *ds, std::array<int,6> &ext)
+{
+  if (svtkImageData *im = dynamic_cast<svtkImageData*>(ds))
+    {
+    im->GetExtent(ext.data());
+    }
+  else if (svtkRectilinearGrid *rg = dynamic_cast<svtkRectilinearGrid*>(ds))
+    {
+    rg->GetExtent(ext.data());
+    }
+  else if (svtkStructuredGrid *sg = dynamic_cast<svtkStructuredGrid*>(ds))
+    {
+    sg->GetExtent(ext.data());
+    }
+  else
+    {
+    ext = {1, 0, 1, 0, 1, 0};
+    return -1;
+    }
+
+  // convert from points to cells. a direction with a single point has a
+  // single layer of cells
+  for (int i = 0; i < 6; i += 2)
+    ext[i+1] = std::max(ext[i], ext[i+1] - 1);
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int GetOwnedExtent(svtkDataSet *ds, std::array<int,6> &ownedExt)
+{
+  std::array<int,6> ext;
+  if (GetCellExtent(ds, ext))
+    {
+    ownedExt = ext;
+    return -1;
+    }
+
+  svtkUnsignedCharArray *ghosts = dynamic_cast<svtkUnsignedCharArray*>(
+    ds->GetCellData()->GetArray("svtkGhostType"));
+
+  if (!ghosts)
+    {
+    ownedExt = ext;
+    return 0;
+    }
+
+  // find the bounding box of the owned cells
+  ownedExt = {ext[1], ext[0], ext[3], ext[2], ext[5], ext[4]};
+
+  const unsigned char *pg = ghosts->GetPointer(0);
+  long nOwned = 0;
+  long q = 0;
+  for (int k = ext[4]; k <= ext[5]; ++k)
+    {
+    for (int j = ext[2]; j <= ext[3]; ++j)
+      {
+      for (int i = ext[0]; i <= ext[1]; ++i, ++q)
+        {
+        if (pg[q] == 0)
+          {
+          ownedExt[0] = std::min(ownedExt[0], i);
+          ownedExt[1] = std::max(ownedExt[1], i);
+          ownedExt[2] = std::min(ownedExt[2], j);
+          ownedExt[3] = std::max(ownedExt[3], j);
+          ownedExt[4] = std::min(ownedExt[4], k);
+          ownedExt[5] = std::max(ownedExt[5], k);
+          ++nOwned;
+          }
+        }
+      }
+    }
+
+  // the owned cells must fill the box for the extent to describe them
+  long nBox = EmptyExtent(ownedExt) ? 0 :
+    long(ownedExt[1] - ownedExt[0] + 1)*long(ownedExt[3] - ownedExt[2] + 1)*
+    long(ownedExt[5] - ownedExt[4] + 1);
+
+  if (!nOwned || (nOwned != nBox))
+    ownedExt = {1, 0, 1, 0, 1, 0};
+
+  return 0;
+}
+
+// --------------------------------------------------------------------------
+int GetOwnedExtent(const MeshMetadataPtr &md, long blockId,
+  std::array<int,6> &ownedExt)
+{
+  size_t nBlocks = md->BlockOwnedExtents.size();
+  if (!nBlocks || (md->BlockIds.size() != nBlocks))
+    return -1;
+
+  for (size_t i = 0; i < nBlocks; ++i)
+    {
+    if (md->BlockIds[i] == blockId)
+      {
+      ownedExt = md->BlockOwnedExtents[i];
+      return EmptyExtent(ownedExt) ? -1 : 0;
+      }
+    }
+
+  return -1;
+}
+
+// --------------------------------------------------------------------------
+svtkUnsignedCharArray *NewGhostCellsArray(const std::array<int,6> &ext,
+  const std::array<int,6> &ownedExt)
+{
+  long nCells = long(ext[1] - ext[0] + 1)*long(ext[3] - ext[2] + 1)*
+    long(ext[5] - ext[4] + 1);
+
+  svtkUnsignedCharArray *ghosts = svtkUnsignedCharArray::New();
+  ghosts->SetName("svtkGhostType");
+  ghosts->SetNumberOfTuples(nCells);
+
+  unsigned char *pg = ghosts->GetPointer(0);
+  memset(pg, 1, nCells);
+
+  if (!EmptyExtent(ownedExt))
+    {
+    ForEachOwnedRun(ext, ownedExt, [pg](long first, long last)
+      {
+      memset(pg + first, 0, last - first);
+      });
+    }
+
+  return ghosts;
+}
+
 /*
 int arrayCpy(void *&wptr, svtkDataArray *da)
 {
@@ -1408,6 +1881,83 @@ declareVtkAOSDataArrayTT(float, vtkFloatArray)
 declareVtkAOSDataArrayTT(double, vtkDoubleArray)
 #endif
 
+// --------------------------------------------------------------------------
+VTKObjectCache::~VTKObjectCache()
+{
+  this->Clear();
+}
+
+// --------------------------------------------------------------------------
+vtkObjectBase *VTKObjectCache::Find(svtkObjectBase *objIn, svtkMTimeType mtime)
+{
+  auto it = this->Entries.find(objIn);
+  if ((it == this->Entries.end()) || (it->second.MTime != mtime))
+  {
+    ++this->NumberOfMisses;
+    return nullptr;
+  }
+
+  ++this->NumberOfHits;
+  it->second.Used = true;
+  return it->second.Object;
+}
+
+// --------------------------------------------------------------------------
+void VTKObjectCache::Insert(svtkObjectBase *objIn, svtkMTimeType mtime,
+  vtkObjectBase *objOut)
+{
+#if !defined(ENABLE_VTK_CORE)
+  (void)objIn;
+  (void)mtime;
+  (void)objOut;
+#else
+  objOut->Register(nullptr);
+
+  auto it = this->Entries.find(objIn);
+  if (it != this->Entries.end())
+  {
+    // replace the stale object
+    it->second.Object->Delete();
+    it->second = Entry{objOut, mtime, true};
+  }
+  else
+  {
+    this->Entries[objIn] = Entry{objOut, mtime, true};
+  }
+#endif
+}
+
+// --------------------------------------------------------------------------
+void VTKObjectCache::ReleaseUnused()
+{
+  auto it = this->Entries.begin();
+  while (it != this->Entries.end())
+  {
+    if (it->second.Used)
+    {
+      it->second.Used = false;
+      ++it;
+    }
+    else
+    {
+#if defined(ENABLE_VTK_CORE)
+      it->second.Object->Delete();
+#endif
+      it = this->Entries.erase(it);
+    }
+  }
+}
+
+// --------------------------------------------------------------------------
+void VTKObjectCache::Clear()
+{
+#if defined(ENABLE_VTK_CORE)
+  for (auto &entry : this->Entries)
+    entry.second.Object->Delete();
+#endif
+  this->Entries.clear();
+}
+
 // --------------------------------------------------------------------------
 vtkTypeInt64Array *VTKObjectFactory::New(svtkTypeInt64Array *daIn)
 {
@@ -1483,10 +2033,11 @@ vtkTypeInt32Array *VTKObjectFactory::New(svtkTypeInt32Array *daIn)
 }
 
 // --------------------------------------------------------------------------
-vtkDataArray *VTKObjectFactory::New(svtkDataArray *daIn)
+vtkDataArray *VTKObjectFactory::New(svtkDataArray *daIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)daIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1496,6 +2047,19 @@ vtkDataArray *VTKObjectFactory::New(svtkDataArray *daIn)
     return nullptr;
   }
 
+  // reuse the previous conversion if the array was not modified since
+  svtkMTimeType mtime = daIn->GetMTime();
+  if (cache)
+  {
+    if (vtkObjectBase *obj = cache->Find(daIn, mtime))
+    {
+      vtkDataArray *daOut = static_cast<vtkDataArray*>(obj);
+      daOut->SetName(daIn->GetName());
+      daOut->Register(nullptr);
+      return daOut;
+    }
+  }
+
   vtkDataArray *daOut = nullptr;
 
   size_t nTups = daIn->GetNumberOfTuples();
@@ -1552,15 +2116,19 @@ vtkDataArray *VTKObjectFactory::New(svtkDataArray *daIn)
   daOut->AddObserver(vtkCommand::DeleteEvent, cc);
   cc->Delete();
 
+  if (cache)
+    cache->Insert(daIn, mtime, daOut);
+
   return daOut;
 #endif
 }
 
 // --------------------------------------------------------------------------
-vtkCellArray *VTKObjectFactory::New(svtkCellArray *caIn)
+vtkCellArray *VTKObjectFactory::New(svtkCellArray *caIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)caIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1570,6 +2138,23 @@ vtkCellArray *VTKObjectFactory::New(svtkCellArray *caIn)
     return nullptr;
   }
 
+  // reuse the previous conversion if neither the cells nor the offsets and
+  // connectivity arrays were modified since. the svtkCellArray does not
+  // track the modification of its arrays
+  svtkMTimeType mtime = std::max(caIn->GetMTime(),
+    std::max(caIn->GetOffsetsArray()->GetMTime(),
+    caIn->GetConnectivityArray()->GetMTime()));
+
+  if (cache)
+  {
+    if (vtkObjectBase *obj = cache->Find(caIn, mtime))
+    {
+      vtkCellArray *caOut = static_cast<vtkCellArray*>(obj);
+      caOut->Register(nullptr);
+      return caOut;
+    }
+  }
+
   vtkCellArray *caOut = vtkCellArray::New();
 
   // zero-copy only works if the array types exactly match, the svtkCellArray
@@ -1618,41 +2203,47 @@ vtkCellArray *VTKObjectFactory::New(svtkCellArray *caIn)
     conn->Delete();
   }
 
+  if (cache)
+    cache->Insert(caIn, mtime, caOut);
+
   return caOut;
 #endif
 }
 
 // --------------------------------------------------------------------------
-vtkCellData *VTKObjectFactory::New(svtkCellData *cdIn)
+vtkCellData *VTKObjectFactory::New(svtkCellData *cdIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)cdIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
   return static_cast<vtkCellData*>
-    (VTKObjectFactory::New(static_cast<svtkFieldData*>(cdIn)));
+    (VTKObjectFactory::New(static_cast<svtkFieldData*>(cdIn), cache));
 #endif
 }
 
 // --------------------------------------------------------------------------
-vtkPointData *VTKObjectFactory::New(svtkPointData *pdIn)
+vtkPointData *VTKObjectFactory::New(svtkPointData *pdIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)pdIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
   return static_cast<vtkPointData*>
-    (VTKObjectFactory::New(static_cast<svtkFieldData*>(pdIn)));
+    (VTKObjectFactory::New(static_cast<svtkFieldData*>(pdIn), cache));
 #endif
 }
 
 // --------------------------------------------------------------------------
-vtkFieldData *VTKObjectFactory::New(svtkFieldData *fdIn)
+vtkFieldData *VTKObjectFactory::New(svtkFieldData *fdIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)fdIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1681,7 +2272,7 @@ vtkFieldData *VTKObjectFactory::New(svtkFieldData *fdIn)
   int nArrays = fdIn->GetNumberOfArrays();
   for (int i = 0; i < nArrays; ++i)
   {
-    vtkDataArray *ai = VTKObjectFactory::New(fdIn->GetArray(i));
+    vtkDataArray *ai = VTKObjectFactory::New(fdIn->GetArray(i), cache);
     if (!ai)
     {
       SENSEI_ERROR("Array " << i << " was not transfered")
@@ -1704,10 +2295,11 @@ vtkFieldData *VTKObjectFactory::New(svtkFieldData *fdIn)
 }
 
 // --------------------------------------------------------------------------
-vtkPoints *VTKObjectFactory::New(svtkPoints *ptsIn)
+vtkPoints *VTKObjectFactory::New(svtkPoints *ptsIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)ptsIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1717,7 +2309,19 @@ vtkPoints *VTKObjectFactory::New(svtkPoints *ptsIn)
     return nullptr;
   }
 
-  vtkDataArray *pts = VTKObjectFactory::New(ptsIn->GetData());
+  // reuse the previous conversion if the points were not modified since
+  svtkMTimeType mtime = ptsIn->GetMTime();
+  if (cache)
+  {
+    if (vtkObjectBase *obj = cache->Find(ptsIn, mtime))
+    {
+      vtkPoints *ptsOut = static_cast<vtkPoints*>(obj);
+      ptsOut->Register(nullptr);
+      return ptsOut;
+    }
+  }
+
+  vtkDataArray *pts = VTKObjectFactory::New(ptsIn->GetData(), cache);
   if (!pts)
   {
     SENSEI_ERROR("Failed to create a vtkPoints from the give "
@@ -1729,15 +2333,19 @@ vtkPoints *VTKObjectFactory::New(svtkPoints *ptsIn)
   ptsOut->SetData(pts);
   pts->Delete();
 
+  if (cache)
+    cache->Insert(ptsIn, mtime, ptsOut);
+
   return ptsOut;
 #endif
 }
 
 // --------------------------------------------------------------------------
-vtkImageData *VTKObjectFactory::New(svtkImageData *idIn)
+vtkImageData *VTKObjectFactory::New(svtkImageData *idIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)idIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1755,7 +2363,7 @@ vtkImageData *VTKObjectFactory::New(svtkImageData *idIn)
   idOut->SetOrigin(idIn->GetOrigin());
 
   // point data arrays
-  vtkPointData *pd = VTKObjectFactory::New(idIn->GetPointData());
+  vtkPointData *pd = VTKObjectFactory::New(idIn->GetPointData(), cache);
   if (!pd)
   {
     SENSEI_ERROR("Failed to transfer vtkPointData")
@@ -1766,7 +2374,7 @@ vtkImageData *VTKObjectFactory::New(svtkImageData *idIn)
   pd->Delete();
 
   // cell data arrays
-  vtkCellData *cd = VTKObjectFactory::New(idIn->GetCellData());
+  vtkCellData *cd = VTKObjectFactory::New(idIn->GetCellData(), cache);
   if (!cd)
   {
     SENSEI_ERROR("Failed to transfer vtkCellData")
@@ -1781,10 +2389,11 @@ vtkImageData *VTKObjectFactory::New(svtkImageData *idIn)
 }
 
 // --------------------------------------------------------------------------
-vtkUniformGrid *VTKObjectFactory::New(svtkUniformGrid *ugIn)
+vtkUniformGrid *VTKObjectFactory::New(svtkUniformGrid *ugIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)ugIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1802,7 +2411,7 @@ vtkUniformGrid *VTKObjectFactory::New(svtkUniformGrid *ugIn)
   ugOut->SetOrigin(ugIn->GetOrigin());
 
   // point data arrays
-  vtkPointData *pd = VTKObjectFactory::New(ugIn->GetPointData());
+  vtkPointData *pd = VTKObjectFactory::New(ugIn->GetPointData(), cache);
   if (!pd)
   {
     SENSEI_ERROR("Failed to transfer vtkPointData")
@@ -1813,7 +2422,7 @@ vtkUniformGrid *VTKObjectFactory::New(svtkUniformGrid *ugIn)
   pd->Delete();
 
   // cell data arrays
-  vtkCellData *cd = VTKObjectFactory::New(ugIn->GetCellData());
+  vtkCellData *cd = VTKObjectFactory::New(ugIn->GetCellData(), cache);
   if (!cd)
   {
     SENSEI_ERROR("Failed to transfer vtkCellData")
@@ -1828,10 +2437,11 @@ vtkUniformGrid *VTKObjectFactory::New(svtkUniformGrid *ugIn)
 }
 
 // --------------------------------------------------------------------------
-vtkRectilinearGrid *VTKObjectFactory::New(svtkRectilinearGrid *rgIn)
+vtkRectilinearGrid *VTKObjectFactory::New(svtkRectilinearGrid *rgIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)rgIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1847,7 +2457,7 @@ vtkRectilinearGrid *VTKObjectFactory::New(svtkRectilinearGrid *rgIn)
   rgOut->SetExtent(rgIn->GetExtent());
 
   // x coordinates
-  vtkDataArray *x = VTKObjectFactory::New(rgIn->GetXCoordinates());
+  vtkDataArray *x = VTKObjectFactory::New(rgIn->GetXCoordinates(), cache);
   if (!x)
   {
     SENSEI_ERROR("Failed to transfer x coordinates")
@@ -1858,7 +2468,7 @@ vtkRectilinearGrid *VTKObjectFactory::New(svtkRectilinearGrid *rgIn)
   x->Delete();
 
   // y coordinates
-  vtkDataArray *y = VTKObjectFactory::New(rgIn->GetYCoordinates());
+  vtkDataArray *y = VTKObjectFactory::New(rgIn->GetYCoordinates(), cache);
   if (!y)
   {
     SENSEI_ERROR("Failed to transfer y coordinates")
@@ -1869,7 +2479,7 @@ vtkRectilinearGrid *VTKObjectFactory::New(svtkRectilinearGrid *rgIn)
   y->Delete();
 
   // z coordinates
-  vtkDataArray *z = VTKObjectFactory::New(rgIn->GetZCoordinates());
+  vtkDataArray *z = VTKObjectFactory::New(rgIn->GetZCoordinates(), cache);
   if (!z)
   {
     SENSEI_ERROR("Failed to transfer z coordinates")
@@ -1880,7 +2490,7 @@ vtkRectilinearGrid *VTKObjectFactory::New(svtkRectilinearGrid *rgIn)
   z->Delete();
 
   // point data arrays
-  vtkPointData *pd = VTKObjectFactory::New(rgIn->GetPointData());
+  vtkPointData *pd = VTKObjectFactory::New(rgIn->GetPointData(), cache);
   if (!pd)
   {
     SENSEI_ERROR("Failed to transfer vtkPointData")
@@ -1891,7 +2501,7 @@ vtkRectilinearGrid *VTKObjectFactory::New(svtkRectilinearGrid *rgIn)
   pd->Delete();
 
   // cell data arrays
-  vtkCellData *cd = VTKObjectFactory::New(rgIn->GetCellData());
+  vtkCellData *cd = VTKObjectFactory::New(rgIn->GetCellData(), cache);
   if (!cd)
   {
     SENSEI_ERROR("Failed to transfer vtkCellData")
@@ -1906,10 +2516,11 @@ vtkRectilinearGrid *VTKObjectFactory::New(svtkRectilinearGrid *rgIn)
 }
 
 // --------------------------------------------------------------------------
-vtkStructuredGrid *VTKObjectFactory::New(svtkStructuredGrid *sgIn)
+vtkStructuredGrid *VTKObjectFactory::New(svtkStructuredGrid *sgIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)sgIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1925,7 +2536,7 @@ vtkStructuredGrid *VTKObjectFactory::New(svtkStructuredGrid *sgIn)
   sgOut->SetExtent(sgIn->GetExtent());
 
   // points
-  vtkPoints *pts = VTKObjectFactory::New(sgIn->GetPoints());
+  vtkPoints *pts = VTKObjectFactory::New(sgIn->GetPoints(), cache);
   if (!pts)
   {
     SENSEI_ERROR("Failed to transfer points of the svtkStructuredGrid")
@@ -1934,7 +2545,7 @@ vtkStructuredGrid *VTKObjectFactory::New(svtkStructuredGrid *sgIn)
   }
 
   // point data arrays
-  vtkPointData *pd = VTKObjectFactory::New(sgIn->GetPointData());
+  vtkPointData *pd = VTKObjectFactory::New(sgIn->GetPointData(), cache);
   if (!pd)
   {
     SENSEI_ERROR("Failed to transfer vtkPointData")
@@ -1945,7 +2556,7 @@ vtkStructuredGrid *VTKObjectFactory::New(svtkStructuredGrid *sgIn)
   pd->Delete();
 
   // cell data arrays
-  vtkCellData *cd = VTKObjectFactory::New(sgIn->GetCellData());
+  vtkCellData *cd = VTKObjectFactory::New(sgIn->GetCellData(), cache);
   if (!cd)
   {
     SENSEI_ERROR("Failed to transfer vtkCellData")
@@ -1960,10 +2571,11 @@ vtkStructuredGrid *VTKObjectFactory::New(svtkStructuredGrid *sgIn)
 }
 
 // --------------------------------------------------------------------------
-vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
+vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)pdIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -1976,7 +2588,7 @@ vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
   vtkPolyData *pdOut = vtkPolyData::New();
 
   // points
-  vtkPoints *pts = VTKObjectFactory::New(pdIn->GetPoints());
+  vtkPoints *pts = VTKObjectFactory::New(pdIn->GetPoints(), cache);
   if (!pts)
   {
     SENSEI_ERROR("Failed to transfer points of the svtkPolyData")
@@ -1987,7 +2599,7 @@ vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
   pts->Delete();
 
   // vert cells
-  vtkCellArray *verts = VTKObjectFactory::New(pdIn->GetVerts());
+  vtkCellArray *verts = VTKObjectFactory::New(pdIn->GetVerts(), cache);
   if (!verts)
   {
     SENSEI_ERROR("Failed to transfer verts of the svtkPolyData")
@@ -1998,7 +2610,7 @@ vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
   verts->Delete();
 
   // line cells
-  vtkCellArray *lines = VTKObjectFactory::New(pdIn->GetLines());
+  vtkCellArray *lines = VTKObjectFactory::New(pdIn->GetLines(), cache);
   if (!lines)
   {
     SENSEI_ERROR("Failed to transfer lines of the svtkPolyData")
@@ -2009,7 +2621,7 @@ vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
   lines->Delete();
 
   // poly cells
-  vtkCellArray *polys = VTKObjectFactory::New(pdIn->GetPolys());
+  vtkCellArray *polys = VTKObjectFactory::New(pdIn->GetPolys(), cache);
   if (!polys)
   {
     SENSEI_ERROR("Failed to transfer polys of the svtkPolyData")
@@ -2020,7 +2632,7 @@ vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
   polys->Delete();
 
   // strip cells
-  vtkCellArray *strips = VTKObjectFactory::New(pdIn->GetStrips());
+  vtkCellArray *strips = VTKObjectFactory::New(pdIn->GetStrips(), cache);
   if (!strips)
   {
     SENSEI_ERROR("Failed to transfer strips of the svtkPolyData")
@@ -2031,7 +2643,7 @@ vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
   strips->Delete();
 
   // point data arrays
-  vtkPointData *pd = VTKObjectFactory::New(pdIn->GetPointData());
+  vtkPointData *pd = VTKObjectFactory::New(pdIn->GetPointData(), cache);
   if (!pd)
   {
     SENSEI_ERROR("Failed to transfer vtkPointData")
@@ -2042,7 +2654,7 @@ vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
   pd->Delete();
 
   // cell data arrays
-  vtkCellData *cd = VTKObjectFactory::New(pdIn->GetCellData());
+  vtkCellData *cd = VTKObjectFactory::New(pdIn->GetCellData(), cache);
   if (!cd)
   {
     SENSEI_ERROR("Failed to transfer vtkCellData")
@@ -2057,10 +2669,11 @@ vtkPolyData *VTKObjectFactory::New(svtkPolyData *pdIn)
 }
 
 // --------------------------------------------------------------------------
-vtkUnstructuredGrid *VTKObjectFactory::New(svtkUnstructuredGrid *ugIn)
+vtkUnstructuredGrid *VTKObjectFactory::New(svtkUnstructuredGrid *ugIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)ugIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -2074,7 +2687,7 @@ vtkUnstructuredGrid *VTKObjectFactory::New(svtkUnstructuredGrid *ugIn)
 
   // cell types
   vtkUnsignedCharArray *ct =
-    dynamic_cast<vtkUnsignedCharArray*>(VTKObjectFactory::New(ugIn->GetCellTypesArray()));
+    dynamic_cast<vtkUnsignedCharArray*>(VTKObjectFactory::New(ugIn->GetCellTypesArray(), cache));
 
   if (!ct)
   {
@@ -2084,7 +2697,7 @@ vtkUnstructuredGrid *VTKObjectFactory::New(svtkUnstructuredGrid *ugIn)
   }
 
   // cells
-  vtkCellArray *cells = VTKObjectFactory::New(ugIn->GetCells());
+  vtkCellArray *cells = VTKObjectFactory::New(ugIn->GetCells(), cache);
   if (!cells)
   {
     SENSEI_ERROR("Failed to transfer cells from svtkUnstructuredGrid")
@@ -2097,7 +2710,7 @@ vtkUnstructuredGrid *VTKObjectFactory::New(svtkUnstructuredGrid *ugIn)
   cells->Delete();
 
   // points
-  vtkPoints *pts = VTKObjectFactory::New(ugIn->GetPoints());
+  vtkPoints *pts = VTKObjectFactory::New(ugIn->GetPoints(), cache);
   if (!pts)
   {
     SENSEI_ERROR("Failed to transfer points of the svtkPolyData")
@@ -2108,7 +2721,7 @@ vtkUnstructuredGrid *VTKObjectFactory::New(svtkUnstructuredGrid *ugIn)
   pts->Delete();
 
   // point data arrays
-  vtkPointData *pd = VTKObjectFactory::New(ugIn->GetPointData());
+  vtkPointData *pd = VTKObjectFactory::New(ugIn->GetPointData(), cache);
   if (!pd)
   {
     SENSEI_ERROR("Failed to transfer vtkPointData")
@@ -2119,7 +2732,7 @@ vtkUnstructuredGrid *VTKObjectFactory::New(svtkUnstructuredGrid *ugIn)
   pd->Delete();
 
   // cell data arrays
-  vtkCellData *cd = VTKObjectFactory::New(ugIn->GetCellData());
+  vtkCellData *cd = VTKObjectFactory::New(ugIn->GetCellData(), cache);
   if (!cd)
   {
     SENSEI_ERROR("Failed to transfer vtkCellData")
@@ -2134,10 +2747,11 @@ vtkUnstructuredGrid *VTKObjectFactory::New(svtkUnstructuredGrid *ugIn)
 }
 
 // --------------------------------------------------------------------------
-vtkMultiBlockDataSet *VTKObjectFactory::New(svtkMultiBlockDataSet *mbIn)
+vtkMultiBlockDataSet *VTKObjectFactory::New(svtkMultiBlockDataSet *mbIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)mbIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -2159,7 +2773,7 @@ vtkMultiBlockDataSet *VTKObjectFactory::New(svtkMultiBlockDataSet *mbIn)
     svtkDataSet *dsIn = dynamic_cast<svtkDataSet*>(mbIn->GetBlock(i));
     if (dsIn)
     {
-      vtkDataSet *dsOut = VTKObjectFactory::New(dsIn);
+      vtkDataSet *dsOut = VTKObjectFactory::New(dsIn, cache);
       if (!dsOut)
       {
         SENSEI_ERROR("Failed to transfer block "
@@ -2177,10 +2791,11 @@ vtkMultiBlockDataSet *VTKObjectFactory::New(svtkMultiBlockDataSet *mbIn)
 }
 
 // --------------------------------------------------------------------------
-vtkOverlappingAMR *VTKObjectFactory::New(svtkOverlappingAMR *amrIn)
+vtkOverlappingAMR *VTKObjectFactory::New(svtkOverlappingAMR *amrIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)amrIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -2234,7 +2849,7 @@ vtkOverlappingAMR *VTKObjectFactory::New(svtkOverlappingAMR *amrIn)
       svtkUniformGrid *ugIn = amrIn->GetDataSet(i, j);
       if (ugIn)
       {
-        vtkUniformGrid *ugOut = VTKObjectFactory::New(ugIn);
+        vtkUniformGrid *ugOut = VTKObjectFactory::New(ugIn, cache);
         if (!ugOut)
         {
           SENSEI_ERROR("Failed to convert AMR block at level "
@@ -2253,10 +2868,11 @@ vtkOverlappingAMR *VTKObjectFactory::New(svtkOverlappingAMR *amrIn)
 }
 
 // --------------------------------------------------------------------------
-vtkDataObject *VTKObjectFactory::New(svtkDataObject *objIn)
+vtkDataObject *VTKObjectFactory::New(svtkDataObject *objIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)objIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -2272,15 +2888,15 @@ vtkDataObject *VTKObjectFactory::New(svtkDataObject *objIn)
 
   if ((dsIn = dynamic_cast<svtkDataSet*>(objIn)))
   {
-    return static_cast<vtkDataObject*>(VTKObjectFactory::New(dsIn));
+    return static_cast<vtkDataObject*>(VTKObjectFactory::New(dsIn, cache));
   }
   else if ((mbIn = dynamic_cast<svtkMultiBlockDataSet*>(objIn)))
   {
-    return static_cast<vtkDataObject*>(VTKObjectFactory::New(mbIn));
+    return static_cast<vtkDataObject*>(VTKObjectFactory::New(mbIn, cache));
   }
   else if ((amrIn = dynamic_cast<svtkOverlappingAMR*>(objIn)))
   {
-    return static_cast<vtkDataObject*>(VTKObjectFactory::New(amrIn));
+    return static_cast<vtkDataObject*>(VTKObjectFactory::New(amrIn, cache));
   }
 
   SENSEI_ERROR("Failed to construct a VTK object from the given "
@@ -2291,10 +2907,11 @@ vtkDataObject *VTKObjectFactory::New(svtkDataObject *objIn)
 }
 
 // --------------------------------------------------------------------------
-vtkDataSet *VTKObjectFactory::New(svtkDataSet *dsIn)
+vtkDataSet *VTKObjectFactory::New(svtkDataSet *dsIn, VTKObjectCache *cache)
 {
 #if !defined(ENABLE_VTK_CORE)
   (void)dsIn;
+  (void)cache;
   SENSEI_ERROR("Conversion from SVTK to VTK is not available in this build")
   return nullptr;
 #else
@@ -2313,27 +2930,27 @@ vtkDataSet *VTKObjectFactory::New(svtkDataSet *dsIn)
 
   if ((idIn = dynamic_cast<svtkImageData*>(dsIn)))
   {
-    return VTKObjectFactory::New(idIn);
+    return VTKObjectFactory::New(idIn, cache);
   }
   else if ((ungIn = dynamic_cast<svtkUniformGrid*>(dsIn)))
   {
-    return VTKObjectFactory::New(ungIn);
+    return VTKObjectFactory::New(ungIn, cache);
   }
   else if ((rgIn = dynamic_cast<svtkRectilinearGrid*>(dsIn)))
   {
-    return VTKObjectFactory::New(rgIn);
+    return VTKObjectFactory::New(rgIn, cache);
   }
   else if ((sgIn = dynamic_cast<svtkStructuredGrid*>(dsIn)))
   {
-    return VTKObjectFactory::New(sgIn);
+    return VTKObjectFactory::New(sgIn, cache);
   }
   else if ((pdIn = dynamic_cast<svtkPolyData*>(dsIn)))
   {
-    return VTKObjectFactory::New(pdIn);
+    return VTKObjectFactory::New(pdIn, cache);
   }
   else if ((ugIn = dynamic_cast<svtkUnstructuredGrid*>(dsIn)))
   {
-    return VTKObjectFactory::New(ugIn);
+    return VTKObjectFactory::New(ugIn, cache);
   }
 
   SENSEI_ERROR("Failed to construct a VTK object from the given "
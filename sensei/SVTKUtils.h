@@ -12,6 +12,7 @@ class svtkFieldData;
 class svtkCellData;
 class svtkPointData;
 class svtkDataArray;
+class svtkUnsignedCharArray;
 class svtkTypeInt64Array;
 class svtkTypeInt32Array;
 class svtkCellArray;
@@ -44,6 +45,7 @@ class vtkMultiBlockDataSet;
 class vtkOverlappingAMR;
 class vtkDataObject;
 class vtkDataSet;
+class vtkObjectBase;
 
 #include <svtkDataArray.h>
 #include <svtkAOSDataArrayTemplate.h>
@@ -53,7 +55,10 @@ class vtkDataSet;
 #include <svtkAOSDataArrayTemplate.h>
 #include <svtkCellArray.h>
 
+#include <algorithm>
+#include <array>
 #include <functional>
+#include <map>
 #include <vector>
 #include <mpi.h>
 
@@ -178,6 +183,113 @@ using DatasetFunction = std::function<int(svtkDataSet*)>;
 SENSEI_EXPORT
 int Apply(svtkDataObject *dobj, DatasetFunction &func);
 
+/** Set the number of threads used by the threaded variants of Apply when
+ * none is passed. The default is 1, or the value of the environment
+ * variable SENSEI_SVTK_UTILS_THREADS when it is set.
+ */
+SENSEI_EXPORT
+void SetNumberOfThreads(int nThreads);
+
+/// @copydoc SetNumberOfThreads
+SENSEI_EXPORT
+int GetNumberOfThreads();
+
+/** Gather the leaf datasets of a data object in the order that a composite
+ * data iterator visits them. Empty leaves are skipped. If output is passed
+ * the structurally equivalent leaves of the output are gathered too.
+ */
+SENSEI_EXPORT
+int GetLeaves(svtkDataObject *dobj, std::vector<svtkDataSet*> &leaves);
+
+/// @copydoc GetLeaves
+SENSEI_EXPORT
+int GetLeaves(svtkDataObject *input, svtkDataObject *output,
+  std::vector<svtkDataSet*> &leaves, std::vector<svtkDataSet*> &leavesOut);
+
+/** A callback that processes the leaf with the given index, counted in
+ * iteration order, on the thread with the given id. Calls for different
+ * leaves may run concurrently. return 0 for success, > zero to stop without
+ * error, < zero to stop with error
+ */
+using IndexedDatasetFunction = std::function<int(int leaf, int thread,
+  svtkDataSet*)>;
+
+/// @copydoc IndexedDatasetFunction
+using IndexedBinaryDatasetFunction = std::function<int(int leaf, int thread,
+  svtkDataSet*, svtkDataSet*)>;
+
+/** Applies the function to the leaves of the data object concurrently. The
+ * leaves are handed out one at a time to nThreads threads, or to
+ * GetNumberOfThreads() threads when nThreads < 1. When the function stops
+ * the traversal, leaves not yet started are skipped. Results that depend on
+ * the order of the leaves should be stored per leaf, see BlockReduction.
+ */
+SENSEI_EXPORT
+int Apply(svtkDataObject *dobj, IndexedDatasetFunction &func, int nThreads = -1);
+
+/// @copydoc Apply(svtkDataObject*,IndexedDatasetFunction&,int)
+SENSEI_EXPORT
+int Apply(svtkDataObject *input, svtkDataObject *output,
+  IndexedBinaryDatasetFunction &func, int nThreads = -1);
+
+/** Holds one value per thread for accumulating into from the threaded
+ * variants of Apply without locking. The values are combined in thread
+ * order, which gives the same result for any assignment of leaves to threads
+ * only if the operation is associative and commutative.
+ */
+template <typename T>
+class ThreadReduction
+{
+public:
+  ThreadReduction(int nThreads, const T &init) :
+    Values(std::max(1, nThreads), init) {}
+
+  /// the value of the given thread
+  T &operator[](int thread) { return this->Values[thread]; }
+
+  /// combine the values of all threads
+  template <typename Op>
+  T Reduce(T result, Op op) const
+  {
+    for (const T &val : this->Values)
+      result = op(result, val);
+    return result;
+  }
+
+private:
+  std::vector<T> Values;
+};
+
+/** Holds one value per leaf, filled concurrently by the threaded variants of
+ * Apply. The values are combined in leaf order, so that results such as
+ * floating point sums or appended lists do not depend on the number of
+ * threads.
+ */
+template <typename T>
+class BlockReduction
+{
+public:
+  BlockReduction(int nBlocks, const T &init) : Values(nBlocks, init) {}
+
+  /// the value of the given leaf
+  T &operator[](int leaf) { return this->Values[leaf]; }
+
+  /// the number of leaves
+  int Size() const { return this->Values.size(); }
+
+  /// combine the values of all leaves in order
+  template <typename Op>
+  T Reduce(T result, Op op) const
+  {
+    for (const T &val : this->Values)
+      result = op(result, val);
+    return result;
+  }
+
+private:
+  std::vector<T> Values;
+};
+
 /// Store ghost layer metadata in the mesh
 SENSEI_EXPORT
 int SetGhostLayerMetadata(svtkDataObject *mesh,
@@ -207,6 +319,55 @@ SENSEI_EXPORT
 svtkCompositeDataSetPtr AsCompositeData(MPI_Comm comm,
   svtkDataObject *dobj, bool take = true);
 
+/** Locate a local block by its id. Block ids of svtkMultiBlockDataSet are
+ * the flat index less one, block ids of svtkOverlappingAMR are the flat index,
+ * and a svtkDataSet is treated as a single block. Returns nullptr if the
+ * block is not present.
+ */
+SENSEI_EXPORT
+svtkDataSet *GetBlock(svtkDataObject *mesh, long blockId);
+
+/** An index of the local blocks of a mesh by block id, built with a single
+ * pass over the mesh. GetBlock scans the mesh on each call, use this instead
+ * when looking up many blocks. Block ids are as in GetBlock. The index does
+ * not hold references to the blocks, it must be rebuilt when the mesh
+ * changes.
+ */
+class SENSEI_EXPORT BlockMap
+{
+public:
+  BlockMap() : Single(nullptr) {}
+
+  /// index the blocks of the mesh, replacing the current contents
+  void Initialize(svtkDataObject *mesh);
+
+  /// returns the block with the given id, or nullptr if it is not present
+  svtkDataSet *GetBlock(long blockId) const;
+
+  /// forget the indexed blocks
+  void Clear();
+
+private:
+  svtkDataSet *Single;                  // a dataset matches any id
+  std::map<long, svtkDataSet*> Blocks;
+};
+
+/** Get the ids of the blocks owned by the given rank. The metadata must have
+ * been generated with the BlockDecomp flag. Works with both the global and
+ * local views of the metadata.
+ */
+SENSEI_EXPORT
+int GetLocalBlockIds(int rank, const MeshMetadataPtr &md,
+  std::vector<long> &ids);
+
+/** Estimate the size in bytes of the named arrays on the blocks owned by the
+ * given rank. The metadata must have been generated with the BlockSize flag,
+ * if it was not -1 is returned.
+ */
+SENSEI_EXPORT
+long GetLocalArraySize(int rank, const MeshMetadataPtr &md,
+  int association, const std::vector<std::string> &arrayNames);
+
 /// Return true if the mesh or block type is AMR
 inline bool AMR(const MeshMetadataPtr &md)
 {
@@ -254,6 +415,83 @@ inline bool LogicallyCartesian(const MeshMetadataPtr &md)
   return Structured(md) || UniformCartesian(md) || StretchedCartesian(md);
 }
 
+/// Return true if a cell extent [i0,i1, j0,j1, k0,k1] holds no cells
+inline bool EmptyExtent(const std::array<int,6> &ext)
+{
+  return (ext[1] < ext[0]) || (ext[3] < ext[2]) || (ext[5] < ext[4]);
+}
+
+/** Get the cell extent [i0,i1, j0,j1, k0,k1] of a logically Cartesian block.
+ * Returns non-zero if the block is not logically Cartesian.
+ */
+SENSEI_EXPORT
+int GetCellExtent(svtkDataSet *ds, std::array<int,6> &ext);
+
+/** Get the extent of the cells owned by a logically Cartesian block, that is
+ * those not marked in its svtkGhostType cell array. Without a ghost array all
+ * of the cells are owned. If the owned cells do not form a box the returned
+ * extent is empty. Returns non-zero if the block is not logically Cartesian.
+ */
+SENSEI_EXPORT
+int GetOwnedExtent(svtkDataSet *ds, std::array<int,6> &ownedExt);
+
+/** Look up the cell extent owned by a block in the metadata. The metadata
+ * must have been generated with the BlockDecomp and BlockExtents flags.
+ * Returns non-zero when no owned extent is available for the block, in which
+ * case the svtkGhostType array must be used to identify the ghost cells.
+ */
+SENSEI_EXPORT
+int GetOwnedExtent(const MeshMetadataPtr &md, long blockId,
+  std::array<int,6> &ownedExt);
+
+/** Visit the cells owned by a logically Cartesian block without a ghost
+ * array. ext is the cell extent of the block and ownedExt the owned cell
+ * extent. The function is called as f(first, last) once for each row of
+ * owned cells, where first and last bound the flat indices of the row's
+ * cells in the block's cell data arrays [first, last).
+ */
+template <typename func_t>
+void ForEachOwnedRun(const std::array<int,6> &ext,
+  const std::array<int,6> &ownedExt, func_t &&f)
+{
+  long nx = ext[1] - ext[0] + 1;
+  long nxy = nx*(ext[3] - ext[2] + 1);
+  long nRun = ownedExt[1] - ownedExt[0] + 1;
+
+  for (int k = ownedExt[4]; k <= ownedExt[5]; ++k)
+    {
+    long kOff = (k - ext[4])*nxy + ownedExt[0] - ext[0];
+    for (int j = ownedExt[2]; j <= ownedExt[3]; ++j)
+      {
+      long first = kOff + (j - ext[2])*nx;
+      f(first, first + nRun);
+      }
+    }
+}
+
+/** Visit the cells owned by a logically Cartesian block without a ghost
+ * array. The function is called as f(i) with the flat index of each owned
+ * cell.
+ */
+template <typename func_t>
+void ForEachOwnedCell(const std::array<int,6> &ext,
+  const std::array<int,6> &ownedExt, func_t &&f)
+{
+  ForEachOwnedRun(ext, ownedExt, [&](long first, long last)
+    {
+    for (long i = first; i < last; ++i)
+      f(i);
+    });
+}
+
+/** Generate the svtkGhostType cell array of a logically Cartesian block from
+ * its cell extent and owned cell extent, for consumers that need the mask.
+ * The caller takes ownership of the returned array.
+ */
+SENSEI_EXPORT
+svtkUnsignedCharArray *NewGhostCellsArray(const std::array<int,6> &ext,
+  const std::array<int,6> &ownedExt);
+
 // rank 0 writes a dataset for visualizing the domain decomp
 SENSEI_EXPORT
 int WriteDomainDecomp(MPI_Comm comm, const sensei::MeshMetadataPtr &md,
@@ -334,6 +572,62 @@ void UnpackCells(size_t nc, ARRAY_TT *coIn, ARRAY_TT *ccIn,
   ccOut->Delete();
 }
 
+/** Caches VTK objects constructed by VTKObjectFactory so that they can be
+ * reused from one time step to the next. Points, cell arrays, and data arrays
+ * are cached, keyed by the SVTK object they were constructed from, and are
+ * reused as long as that object's modification time is unchanged. Data sets
+ * are always constructed anew, thus for a static mesh only arrays that are
+ * new or were modified are converted each time step. Each cached object
+ * holds a reference to the SVTK object it was constructed from. Call
+ * ReleaseUnused once per time step to release objects that were not used
+ * since the previous call. The cache is not thread safe.
+ */
+class SENSEI_EXPORT VTKObjectCache
+{
+public:
+  VTKObjectCache() : NumberOfHits(0), NumberOfMisses(0) {}
+  ~VTKObjectCache();
+
+  VTKObjectCache(const VTKObjectCache&) = delete;
+  void operator=(const VTKObjectCache&) = delete;
+
+  /** returns the object constructed from objIn, or nullptr if there is none
+   * or objIn was modified after it was constructed. The returned object is
+   * owned by the cache.
+   */
+  vtkObjectBase *Find(svtkObjectBase *objIn, svtkMTimeType mtime);
+
+  /// adds an object constructed from objIn. the cache holds a reference to it.
+  void Insert(svtkObjectBase *objIn, svtkMTimeType mtime, vtkObjectBase *objOut);
+
+  /// releases objects that were not used since the last call
+  void ReleaseUnused();
+
+  /// releases all objects
+  void Clear();
+
+  /// returns the number of cached objects
+  size_t GetSize() const { return this->Entries.size(); }
+
+  /// returns the number of lookups that found an object
+  long GetNumberOfHits() const { return this->NumberOfHits; }
+
+  /// returns the number of lookups that did not
+  long GetNumberOfMisses() const { return this->NumberOfMisses; }
+
+private:
+  struct Entry
+  {
+    vtkObjectBase *Object;
+    svtkMTimeType MTime;
+    bool Used;
+  };
+
+  std::map<svtkObjectBase*, Entry> Entries;
+  long NumberOfHits;
+  long NumberOfMisses;
+};
+
 /** Constructs VTK objects from SVTK objects enabling the use of VTK filters
  * and ParaView Catalyst on SVTK data. The factory currently supports a
  * limitted number of VTK objects but can be expanded as needed.
@@ -347,9 +641,10 @@ public:
      * Data is zero-copy transfered. A references to the passed SVTK
      * svtkDataArray held by the newly cretaed VTK vtkDataArray ensuring
      * propper life time. It is the callers responsibility to Delete the
-     * returned vtkDataArray instance when finished.
+     * returned vtkDataArray instance when finished. When a cache is passed
+     * an unmodified array converted earlier is returned instead.
      */
-    static vtkDataArray *New(svtkDataArray *daIn);
+    static vtkDataArray *New(svtkDataArray *daIn, VTKObjectCache *cache = nullptr);
 
     /// overload for 64 bit cell arrays
     static vtkTypeInt64Array *New(svtkTypeInt64Array *daIn);
@@ -363,51 +658,52 @@ public:
      * vtkDataArray transfered are held by the VTK object ensuring propper life
      * time. It is the callers responsibility to Delete the returned
      * vtkDataObject when finished. See the overloaded New methods for a list of
-     * implemented data objects.
+     * implemented data objects. When a cache is passed the points, cells, and
+     * arrays of unmodified objects converted earlier are reused.
      */
-    static vtkDataObject *New(svtkDataObject *objIn);
+    static vtkDataObject *New(svtkDataObject *objIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkDataSet *New(svtkDataSet *dsIn);
+    static vtkDataSet *New(svtkDataSet *dsIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkCellArray *New(svtkCellArray *caIn);
+    static vtkCellArray *New(svtkCellArray *caIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkFieldData *New(svtkFieldData *fdIn);
+    static vtkFieldData *New(svtkFieldData *fdIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkPointData *New(svtkPointData *fdIn);
+    static vtkPointData *New(svtkPointData *fdIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkCellData *New(svtkCellData *fdIn);
+    static vtkCellData *New(svtkCellData *fdIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkPoints *New(svtkPoints *ptsIn);
+    static vtkPoints *New(svtkPoints *ptsIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkImageData *New(svtkImageData *idIn);
+    static vtkImageData *New(svtkImageData *idIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkUniformGrid *New(svtkUniformGrid *idIn);
+    static vtkUniformGrid *New(svtkUniformGrid *idIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkRectilinearGrid *New(svtkRectilinearGrid *rgIn);
+    static vtkRectilinearGrid *New(svtkRectilinearGrid *rgIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkStructuredGrid *New(svtkStructuredGrid *sgIn);
+    static vtkStructuredGrid *New(svtkStructuredGrid *sgIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkPolyData *New(svtkPolyData *pdIn);
+    static vtkPolyData *New(svtkPolyData *pdIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkUnstructuredGrid *New(svtkUnstructuredGrid *ugIn);
+    static vtkUnstructuredGrid *New(svtkUnstructuredGrid *ugIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkMultiBlockDataSet *New(svtkMultiBlockDataSet *mbIn);
+    static vtkMultiBlockDataSet *New(svtkMultiBlockDataSet *mbIn, VTKObjectCache *cache = nullptr);
 
     /// @copydoc New(svtkDataObject*)
-    static vtkOverlappingAMR *New(svtkOverlappingAMR *amrIn);
+    static vtkOverlappingAMR *New(svtkOverlappingAMR *amrIn, VTKObjectCache *cache = nullptr);
 };
 
 
@@ -0,0 +1,169 @@
+#include "Scheduler.h"
+#include "Profiler.h"
+#include "Error.h"
+
+#include <pugixml.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace sensei
+{
+
+//----------------------------------------------------------------------------
+Scheduler::Scheduler() : TimeBudget(0.0), TimeFraction(0.0), Smoothing(0.5),
+  MaxDeferrals(10), EndStepTime(-1.0), LastBudget(0.0)
+{
+}
+
+//----------------------------------------------------------------------------
+Scheduler::~Scheduler()
+{
+}
+
+//----------------------------------------------------------------------------
+int Scheduler::Initialize(const pugi::xml_node &node)
+{
+  this->TimeBudget = node.attribute("time_budget").as_double(0.0);
+  this->TimeFraction = node.attribute("time_fraction").as_double(0.0);
+  this->Smoothing = node.attribute("smoothing").as_double(0.5);
+  this->MaxDeferrals = node.attribute("max_deferrals").as_llong(10);
+
+  if (!this->Enabled())
+    {
+    SENSEI_ERROR("The scheduler requires a positive time_budget"
+      " and/or time_fraction")
+    return -1;
+    }
+
+  if ((this->Smoothing <= 0.0) || (this->Smoothing > 1.0))
+    {
+    SENSEI_ERROR("The scheduler smoothing " << this->Smoothing
+      << " must be in (0, 1]")
+    return -1;
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+bool Scheduler::Enabled() const
+{
+  return (this->TimeBudget > 0.0) || (this->TimeFraction > 0.0);
+}
+
+//----------------------------------------------------------------------------
+int Scheduler::AddTask(int priority)
+{
+  int id = this->Priority.size();
+
+  this->Priority.push_back(priority);
+  this->LocalCost.push_back(-1.0);
+  this->GlobalCost.push_back(-1.0);
+  this->Deferred.push_back(0);
+
+  return id;
+}
+
+//----------------------------------------------------------------------------
+void Scheduler::SetCost(int task, double seconds)
+{
+  double &cost = this->LocalCost[task];
+
+  cost = cost < 0.0 ? seconds :
+    this->Smoothing*seconds + (1.0 - this->Smoothing)*cost;
+}
+
+//----------------------------------------------------------------------------
+void Scheduler::EndStep()
+{
+  this->EndStepTime = MPI_Wtime();
+}
+
+//----------------------------------------------------------------------------
+int Scheduler::Schedule(MPI_Comm comm, std::vector<int> &run)
+{
+  TimeEvent<128> mark("Scheduler::Schedule");
+
+  int nTasks = this->Priority.size();
+
+  run.assign(nTasks, 1);
+
+  if (!this->Enabled())
+    return 0;
+
+  // the time spent in the solver since the last step, and the cost of each
+  // analysis. the slowest rank determines the run time so these are
+  // reduced with max in a single collective. values not yet measured are
+  // negative.
+  std::vector<double> localVals(nTasks + 1);
+  localVals[0] = this->EndStepTime < 0.0 ? -1.0 : MPI_Wtime() - this->EndStepTime;
+  for (int i = 0; i < nTasks; ++i)
+    localVals[i + 1] = this->LocalCost[i];
+
+  std::vector<double> globalVals(nTasks + 1);
+  MPI_Allreduce(localVals.data(), globalVals.data(), nTasks + 1,
+    MPI_DOUBLE, MPI_MAX, comm);
+
+  double solverTime = globalVals[0];
+  for (int i = 0; i < nTasks; ++i)
+    this->GlobalCost[i] = globalVals[i + 1];
+
+  // the budget for this step
+  double budget = std::numeric_limits<double>::max();
+
+  if (this->TimeBudget > 0.0)
+    budget = this->TimeBudget;
+
+  if ((this->TimeFraction > 0.0) && (solverTime > 0.0))
+    budget = std::min(budget, this->TimeFraction*solverTime);
+
+  this->LastBudget = budget;
+
+  // critical analyses always run
+  double remaining = budget;
+  std::vector<int> optional;
+  for (int i = 0; i < nTasks; ++i)
+    {
+    if (this->Priority[i] <= Scheduler::CRITICAL)
+      remaining -= std::max(0.0, this->GlobalCost[i]);
+    else
+      optional.push_back(i);
+    }
+
+  // the others in order of priority, then the longest deferred
+  std::stable_sort(optional.begin(), optional.end(),
+    [this](int a, int b) -> bool
+    {
+    if (this->Priority[a] != this->Priority[b])
+      return this->Priority[a] < this->Priority[b];
+    return this->Deferred[a] > this->Deferred[b];
+    });
+
+  size_t nOptional = optional.size();
+  for (size_t j = 0; j < nOptional; ++j)
+    {
+    int i = optional[j];
+    double cost = this->GlobalCost[i];
+
+    // the cost is only measured when the analysis runs. the estimate of
+    // one deferred for long is stale and it is run to refresh it
+    bool stale = (this->MaxDeferrals > 0) &&
+      (this->Deferred[i] >= this->MaxDeferrals);
+
+    if ((cost < 0.0) || (cost <= remaining) || stale)
+      {
+      remaining -= std::max(0.0, cost);
+      this->Deferred[i] = 0;
+      }
+    else
+      {
+      run[i] = 0;
+      this->Deferred[i] += 1;
+      }
+    }
+
+  return 0;
+}
+
+}
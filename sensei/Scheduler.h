@@ -0,0 +1,126 @@
+#ifndef sensei_Scheduler_h
+#define sensei_Scheduler_h
+
+#include "senseiConfig.h"
+
+#include <mpi.h>
+#include <vector>
+
+/// @cond
+namespace pugi { class xml_node; }
+/// @endcond
+
+namespace sensei
+{
+
+/** Selects which of a set of analyses run at each time step so that the
+ * time spent in situ fits within a budget. The budget is either a fixed
+ * number of seconds per time step, or a fraction of the time the solver
+ * spent between successive time steps. The cost of each analysis is an
+ * exponential moving average of its measured run time on the slowest rank.
+ *
+ * Each analysis has a priority. Critical analyses, priority 0, always run
+ * and their cost is charged to the budget first. The remaining analyses
+ * are considered in order of priority, lower values first, and among
+ * analyses with equal priority those that have been deferred the longest
+ * go first. An analysis runs when its cost fits in what remains of the
+ * budget, otherwise it is deferred. Analyses that have not yet been
+ * measured always run so that their cost can be learned. An analysis
+ * deferred a given number of consecutive steps is run regardless, so that
+ * its cost is measured again and a single slow step does not starve it.
+ * The effect is that the frequency of optional analyses adapts to their
+ * cost.
+ *
+ * The measured costs and the solver time are combined in a single small
+ * MPI reduction per time step, and the selection is computed identically on
+ * all ranks from the reduced values, hence the decisions are consistent.
+ */
+class SENSEI_EXPORT Scheduler
+{
+public:
+  /// the priority of analyses that always run
+  enum {CRITICAL = 0};
+
+  Scheduler();
+  ~Scheduler();
+
+  /** Initialize from a <scheduler> XML element. The supported attributes
+   * are time_budget (seconds per step), time_fraction (fraction of solver
+   * time), smoothing, and max_deferrals. Returns zero if successful.
+   */
+  int Initialize(const pugi::xml_node &node);
+
+  /** Set a fixed budget in seconds per time step. Zero or less disables the
+   * fixed budget.
+   */
+  void SetTimeBudget(double seconds) { this->TimeBudget = seconds; }
+  double GetTimeBudget() const { return this->TimeBudget; }
+
+  /** Set the budget as a fraction of the time the solver spent since the
+   * last time step. Zero or less disables the fractional budget. When both a
+   * fixed and a fractional budget are set the smaller is used.
+   */
+  void SetTimeFraction(double fraction) { this->TimeFraction = fraction; }
+  double GetTimeFraction() const { return this->TimeFraction; }
+
+  /** Set the weight given to the most recent measurement in the moving
+   * average of each analysis' cost. The default is 0.5.
+   */
+  void SetSmoothing(double alpha) { this->Smoothing = alpha; }
+
+  /** Set the number of consecutive steps an optional analysis may be
+   * deferred before it is run to measure its cost again. Zero or less never
+   * forces a run. The default is 10.
+   */
+  void SetMaxDeferrals(long n) { this->MaxDeferrals = n; }
+  long GetMaxDeferrals() const { return this->MaxDeferrals; }
+
+  /// returns true if a budget has been set
+  bool Enabled() const;
+
+  /// add an analysis with the given priority. returns its id.
+  int AddTask(int priority);
+
+  /// returns the number of analyses
+  int GetNumberOfTasks() const { return this->Priority.size(); }
+
+  /** Decide which analyses run this time step. This is a collective
+   * operation, the result is the same on all ranks. Returns zero if
+   * successful.
+   */
+  int Schedule(MPI_Comm comm, std::vector<int> &run);
+
+  /// record the measured run time in seconds of an analysis
+  void SetCost(int task, double seconds);
+
+  /** Mark the end of in situ processing for the current time step. The time
+   * until the next call to Schedule is attributed to the solver.
+   */
+  void EndStep();
+
+  /// get the current estimate of the cost of an analysis in seconds
+  double GetCost(int task) const { return this->GlobalCost[task]; }
+
+  /// get the budget used in the most recent call to Schedule
+  double GetLastBudget() const { return this->LastBudget; }
+
+protected:
+  Scheduler(const Scheduler&) = delete;
+  void operator=(const Scheduler&) = delete;
+
+private:
+  double TimeBudget;
+  double TimeFraction;
+  double Smoothing;
+  long MaxDeferrals;
+  double EndStepTime;
+  double LastBudget;
+  std::vector<int> Priority;
+  std::vector<double> LocalCost;
+  std::vector<double> GlobalCost;
+  std::vector<long> Deferred;
+};
+
+}
+
+#endif
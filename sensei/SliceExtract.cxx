@@ -55,6 +55,7 @@ struct SliceExtract::InternalsType
   PlanarSlicePartitionerPtr SlicePartitioner;
   int EnableWriter;
   VTKPosthocIOPtr Writer;
+  SVTKUtils::VTKObjectCache Cache;
 };
 
 
@@ -549,8 +550,10 @@ int SliceExtract::IsoSurface(svtkCompositeDataSet *input,
 
     svtkDataObject *dobjIn = it->GetCurrentDataObject();
 
-    // convert to VTK
-    vtkDataObject *vdobjIn = SVTKUtils::VTKObjectFactory::New(dobjIn);
+    // convert to VTK, reusing the geometry and arrays that were not modified
+    // since the last time step
+    vtkDataObject *vdobjIn = SVTKUtils::VTKObjectFactory::New(dobjIn,
+      &this->Internals->Cache);
 
     // run the pipeline on the block
     if (arrayCen == svtkDataObject::CELL)
@@ -575,6 +578,8 @@ int SliceExtract::IsoSurface(svtkCompositeDataSet *input,
 
   it->Delete();
 
+  this->Internals->Cache.ReleaseUnused();
+
   output = mbds;
 
   return 0;
@@ -615,8 +620,10 @@ int SliceExtract::Slice(svtkCompositeDataSet *input,
     unsigned int bid = it->GetCurrentFlatIndex() - 1;
     svtkDataObject *dobjIn = it->GetCurrentDataObject();
 
-    // convert to VTK
-    vtkDataObject *vdobjIn = SVTKUtils::VTKObjectFactory::New(dobjIn);
+    // convert to VTK, reusing the geometry and arrays that were not modified
+    // since the last time step
+    vtkDataObject *vdobjIn = SVTKUtils::VTKObjectFactory::New(dobjIn,
+      &this->Internals->Cache);
 
     // set up and run the pipeline
     slice->SetInputData(vdobjIn);
@@ -638,6 +645,8 @@ int SliceExtract::Slice(svtkCompositeDataSet *input,
 
   it->Delete();
 
+  this->Internals->Cache.ReleaseUnused();
+
   output = mbds;
 
   return 0;
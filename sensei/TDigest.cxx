@@ -0,0 +1,428 @@
+#include "TDigest.h"
+#include "Error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// **************************************************************************
+// the k1 scale function, maps quantile to k
+inline double kScale(double q, double compression)
+{
+  q = std::max(0.0, std::min(1.0, q));
+  return compression / (2.0 * M_PI) * std::asin(2.0 * q - 1.0);
+}
+
+// **************************************************************************
+// the inverse of the k1 scale function, maps k to quantile
+inline double qScale(double k, double compression)
+{
+  double kMax = compression / 4.0;
+  if (k >= kMax)
+    return 1.0;
+  return (std::sin(k * 2.0 * M_PI / compression) + 1.0) / 2.0;
+}
+
+// **************************************************************************
+void MergeDigests(void *invec, void *inoutvec, int *len, MPI_Datatype *dt)
+{
+  int typeSize = 0;
+  MPI_Type_size(*dt, &typeSize);
+  size_t nPer = typeSize / sizeof(double);
+
+  const double *in = static_cast<const double*>(invec);
+  double *inout = static_cast<double*>(inoutvec);
+
+  for (int i = 0; i < *len; ++i)
+    {
+    // the op is non-commutative, invec holds lower ranks. merging in rank
+    // order makes the results reproducible.
+    sensei::TDigest a;
+    sensei::TDigest b;
+    a.Unpack(in + i*nPer);
+    b.Unpack(inout + i*nPer);
+    a.Merge(b);
+    a.Pack(inout + i*nPer);
+    }
+}
+}
+
+namespace sensei
+{
+//-----------------------------------------------------------------------------
+TDigest::TDigest() : Compression(100.0), BufferSize(500), TotalWeight(0.0),
+  Min(std::numeric_limits<double>::max()),
+  Max(std::numeric_limits<double>::lowest())
+{
+}
+
+//-----------------------------------------------------------------------------
+TDigest::TDigest(double compression) : TDigest()
+{
+  this->SetCompression(compression);
+}
+
+//-----------------------------------------------------------------------------
+void TDigest::SetCompression(double compression)
+{
+  this->Compression = std::max(10.0, compression);
+  this->BufferSize = 5*size_t(this->Compression);
+  this->Compress();
+}
+
+//-----------------------------------------------------------------------------
+void TDigest::Add(double x, double w)
+{
+  if (w <= 0.0)
+    return;
+
+  this->Compress();
+
+  std::vector<double> means(1, x);
+  std::vector<double> weights(1, w);
+  this->MergeCentroids(means, weights);
+}
+
+//-----------------------------------------------------------------------------
+void TDigest::Merge(const TDigest &other)
+{
+  this->Compress();
+
+  std::vector<double> means(other.Means);
+  std::vector<double> weights(other.Weights);
+
+  // pick up the other's unmerged values
+  size_t nBuf = other.Buffer.size();
+  if (nBuf)
+    {
+    std::vector<double> buf(other.Buffer);
+    std::sort(buf.begin(), buf.end());
+
+    std::vector<double> tmpMeans(means.size() + nBuf);
+    std::vector<double> tmpWeights(means.size() + nBuf);
+
+    size_t i = 0, j = 0, k = 0;
+    while ((i < means.size()) || (j < nBuf))
+      {
+      if ((j >= nBuf) || ((i < means.size()) && (means[i] <= buf[j])))
+        {
+        tmpMeans[k] = means[i];
+        tmpWeights[k] = weights[i];
+        ++i;
+        }
+      else
+        {
+        tmpMeans[k] = buf[j];
+        tmpWeights[k] = 1.0;
+        ++j;
+        }
+      ++k;
+      }
+
+    means.swap(tmpMeans);
+    weights.swap(tmpWeights);
+    }
+
+  this->MergeCentroids(means, weights);
+
+  // centroid means are not the extremes
+  this->Min = std::min(this->Min, other.Min);
+  this->Max = std::max(this->Max, other.Max);
+}
+
+//-----------------------------------------------------------------------------
+void TDigest::Compress()
+{
+  if (this->Buffer.empty())
+    return;
+
+  std::sort(this->Buffer.begin(), this->Buffer.end());
+
+  std::vector<double> weights(this->Buffer.size(), 1.0);
+  std::vector<double> means;
+  means.swap(this->Buffer);
+
+  this->MergeCentroids(means, weights);
+}
+
+//-----------------------------------------------------------------------------
+void TDigest::MergeCentroids(std::vector<double> &means,
+  std::vector<double> &weights)
+{
+  size_t nIn = means.size();
+  if (nIn == 0)
+    return;
+
+  // update the range and total
+  this->Min = std::min(this->Min, means[0]);
+  this->Max = std::max(this->Max, means[nIn - 1]);
+
+  for (size_t i = 0; i < nIn; ++i)
+    this->TotalWeight += weights[i];
+
+  // merge the two sorted lists
+  size_t nCur = this->Means.size();
+  size_t nAll = nCur + nIn;
+
+  std::vector<double> allMeans(nAll);
+  std::vector<double> allWeights(nAll);
+
+  size_t i = 0, j = 0, k = 0;
+  while ((i < nCur) || (j < nIn))
+    {
+    if ((j >= nIn) || ((i < nCur) && (this->Means[i] <= means[j])))
+      {
+      allMeans[k] = this->Means[i];
+      allWeights[k] = this->Weights[i];
+      ++i;
+      }
+    else
+      {
+      allMeans[k] = means[j];
+      allWeights[k] = weights[j];
+      ++j;
+      }
+    ++k;
+    }
+
+  // greedily combine adjacent centroids as long as the combined centroid
+  // spans no more than one unit of k
+  double totalWeight = this->TotalWeight;
+
+  this->Means.clear();
+  this->Weights.clear();
+
+  double curMean = allMeans[0];
+  double curWeight = allWeights[0];
+  double wSoFar = 0.0;
+  double wLimit = totalWeight *
+    qScale(kScale(0.0, this->Compression) + 1.0, this->Compression);
+
+  for (size_t q = 1; q < nAll; ++q)
+    {
+    double w = allWeights[q];
+    if (wSoFar + curWeight + w <= wLimit)
+      {
+      curWeight += w;
+      curMean += (allMeans[q] - curMean) * w / curWeight;
+      }
+    else
+      {
+      wSoFar += curWeight;
+      this->Means.push_back(curMean);
+      this->Weights.push_back(curWeight);
+
+      wLimit = totalWeight * qScale(kScale(wSoFar / totalWeight,
+        this->Compression) + 1.0, this->Compression);
+
+      curMean = allMeans[q];
+      curWeight = w;
+      }
+    }
+
+  this->Means.push_back(curMean);
+  this->Weights.push_back(curWeight);
+}
+
+//-----------------------------------------------------------------------------
+void TDigest::Clear()
+{
+  this->TotalWeight = 0.0;
+  this->Min = std::numeric_limits<double>::max();
+  this->Max = std::numeric_limits<double>::lowest();
+  this->Means.clear();
+  this->Weights.clear();
+  this->Buffer.clear();
+}
+
+//-----------------------------------------------------------------------------
+double TDigest::GetCount()
+{
+  this->Compress();
+  return this->TotalWeight;
+}
+
+//-----------------------------------------------------------------------------
+size_t TDigest::GetNumberOfCentroids()
+{
+  this->Compress();
+  return this->Means.size();
+}
+
+//-----------------------------------------------------------------------------
+double TDigest::Quantile(double q)
+{
+  this->Compress();
+
+  size_t n = this->Means.size();
+  if (n == 0)
+    return std::numeric_limits<double>::quiet_NaN();
+
+  if (q <= 0.0)
+    return this->Min;
+
+  if (q >= 1.0)
+    return this->Max;
+
+  // the target rank. each centroid is located at the middle of its weight,
+  // the min and max are at the ends.
+  double index = q * this->TotalWeight;
+
+  double left = 0.0;
+  double leftVal = this->Min;
+  double wSoFar = 0.0;
+
+  for (size_t i = 0; i < n; ++i)
+    {
+    double center = wSoFar + this->Weights[i] / 2.0;
+    if (index <= center)
+      {
+      double frac = center > left ? (index - left) / (center - left) : 1.0;
+      return leftVal + frac * (this->Means[i] - leftVal);
+      }
+    left = center;
+    leftVal = this->Means[i];
+    wSoFar += this->Weights[i];
+    }
+
+  double right = this->TotalWeight;
+  double frac = right > left ? (index - left) / (right - left) : 1.0;
+  return leftVal + frac * (this->Max - leftVal);
+}
+
+//-----------------------------------------------------------------------------
+double TDigest::CDF(double x)
+{
+  this->Compress();
+
+  size_t n = this->Means.size();
+  if (n == 0)
+    return std::numeric_limits<double>::quiet_NaN();
+
+  if (x < this->Min)
+    return 0.0;
+
+  if (x >= this->Max)
+    return 1.0;
+
+  double left = 0.0;
+  double leftVal = this->Min;
+  double wSoFar = 0.0;
+
+  for (size_t i = 0; i < n; ++i)
+    {
+    double center = wSoFar + this->Weights[i] / 2.0;
+    if (x < this->Means[i])
+      {
+      double dx = this->Means[i] - leftVal;
+      double frac = dx > 0.0 ? (x - leftVal) / dx : 1.0;
+      return (left + frac * (center - left)) / this->TotalWeight;
+      }
+    left = center;
+    leftVal = this->Means[i];
+    wSoFar += this->Weights[i];
+    }
+
+  double dx = this->Max - leftVal;
+  double frac = dx > 0.0 ? (x - leftVal) / dx : 1.0;
+  return (left + frac * (this->TotalWeight - left)) / this->TotalWeight;
+}
+
+//-----------------------------------------------------------------------------
+size_t TDigest::GetPackedSize(double compression)
+{
+  // header: compression, number of centroids, total weight, min, max
+  // followed by the means and weights. the k1 scale function spans
+  // compression/2 units of k and any two adjacent centroids span more
+  // than one unit, thus there are at most compression + 2 centroids
+  size_t maxCentroids = size_t(std::ceil(std::max(10.0, compression))) + 2;
+  return 5 + 2*maxCentroids;
+}
+
+//-----------------------------------------------------------------------------
+int TDigest::Pack(double *buf)
+{
+  this->Compress();
+
+  size_t n = this->Means.size();
+  size_t maxCentroids = (GetPackedSize(this->Compression) - 5) / 2;
+  if (n > maxCentroids)
+    {
+    SENSEI_ERROR("The digest has " << n << " centroids but at most "
+      << maxCentroids << " can be packed")
+    return -1;
+    }
+
+  buf[0] = this->Compression;
+  buf[1] = n;
+  buf[2] = this->TotalWeight;
+  buf[3] = this->Min;
+  buf[4] = this->Max;
+
+  std::copy(this->Means.begin(), this->Means.end(), buf + 5);
+  std::copy(this->Weights.begin(), this->Weights.end(), buf + 5 + maxCentroids);
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int TDigest::Unpack(const double *buf)
+{
+  this->Compression = buf[0];
+  this->BufferSize = 5*size_t(this->Compression);
+
+  size_t n = buf[1];
+  size_t maxCentroids = (GetPackedSize(this->Compression) - 5) / 2;
+
+  this->TotalWeight = buf[2];
+  this->Min = buf[3];
+  this->Max = buf[4];
+
+  this->Means.assign(buf + 5, buf + 5 + n);
+  this->Weights.assign(buf + 5 + maxCentroids, buf + 5 + maxCentroids + n);
+  this->Buffer.clear();
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int TDigest::Reduce(MPI_Comm comm, int root)
+{
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  // all ranks send a fixed size message so that the reduction can be done
+  // by a single MPI_Reduce with a user defined merge operation.
+  size_t packedSize = GetPackedSize(this->Compression);
+
+  std::vector<double> sendBuf(packedSize);
+  if (this->Pack(sendBuf.data()))
+    {
+    SENSEI_ERROR("Failed to pack the digest")
+    return -1;
+    }
+
+  MPI_Datatype digestType;
+  MPI_Type_contiguous(packedSize, MPI_DOUBLE, &digestType);
+  MPI_Type_commit(&digestType);
+
+  MPI_Op mergeOp;
+  MPI_Op_create(MergeDigests, 0, &mergeOp);
+
+  std::vector<double> recvBuf(rank == root ? packedSize : 0);
+
+  MPI_Reduce(sendBuf.data(), recvBuf.data(), 1, digestType,
+    mergeOp, root, comm);
+
+  MPI_Op_free(&mergeOp);
+  MPI_Type_free(&digestType);
+
+  if (rank == root)
+    this->Unpack(recvBuf.data());
+
+  return 0;
+}
+
+}
@@ -0,0 +1,109 @@
+#ifndef sensei_TDigest_h
+#define sensei_TDigest_h
+
+#include "senseiConfig.h"
+
+#include <mpi.h>
+#include <cstddef>
+#include <vector>
+
+namespace sensei
+{
+
+/** A mergeable sketch of a distribution (a merging t-digest) used for
+ * computing approximate quantiles and CDFs in bounded memory. Values are
+ * buffered and periodically merged into a sorted set of weighted centroids.
+ * The size of the centroids is limited by the k1 scale function, so that
+ * centroids near the tails are small and the relative accuracy of extreme
+ * quantiles is high. The compression parameter controls the accuracy. At
+ * most Compression + 2 centroids are retained. The error in a quantile
+ * estimate is roughly proportional to q(1-q)/Compression.
+ *
+ * Digests computed on different MPI ranks are combined with the Reduce
+ * method, which uses a single MPI_Reduce.
+ */
+class SENSEI_EXPORT TDigest
+{
+public:
+  TDigest();
+  TDigest(double compression);
+
+  /// Set the accuracy parameter. Larger values are more accurate.
+  void SetCompression(double compression);
+  double GetCompression() const { return this->Compression; }
+
+  /// Add a value
+  void Add(double x)
+  {
+    this->Buffer.push_back(x);
+    if (this->Buffer.size() >= this->BufferSize)
+      this->Compress();
+  }
+
+  /// Add a value with the given weight
+  void Add(double x, double w);
+
+  /// Merge the contents of another digest into this one
+  void Merge(const TDigest &other);
+
+  /// Merge buffered values into the centroids
+  void Compress();
+
+  /// Clear the contents of the digest
+  void Clear();
+
+  /// Get the estimated value at quantile q in [0, 1]
+  double Quantile(double q);
+
+  /// Get the estimated fraction of values less than or equal to x
+  double CDF(double x);
+
+  /// Get the number of values added
+  double GetCount();
+
+  /// Get the smallest value added
+  double GetMin() const { return this->Min; }
+
+  /// Get the largest value added
+  double GetMax() const { return this->Max; }
+
+  /// Get the number of centroids in use
+  size_t GetNumberOfCentroids();
+
+  /** Reduce the digest across all ranks in comm to the root rank. On the
+   * root rank the digest will hold the global result. This is an MPI
+   * collective and all ranks must use the same compression.
+   */
+  int Reduce(MPI_Comm comm, int root);
+
+  /** Get the number of doubles needed to serialize a digest with the given
+   * compression.
+   */
+  static size_t GetPackedSize(double compression);
+
+  /** Serialize the digest into buf, which must have space for
+   * GetPackedSize(compression) doubles.
+   */
+  int Pack(double *buf);
+
+  /// Deserialize a digest that was serialized with Pack
+  int Unpack(const double *buf);
+
+private:
+  // merge sorted (mean, weight) pairs into the centroids
+  void MergeCentroids(std::vector<double> &means, std::vector<double> &weights);
+
+private:
+  double Compression;
+  size_t BufferSize;
+  double TotalWeight;
+  double Min;
+  double Max;
+  std::vector<double> Means;
+  std::vector<double> Weights;
+  std::vector<double> Buffer;
+};
+
+}
+
+#endif
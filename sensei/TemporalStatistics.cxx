@@ -0,0 +1,658 @@
+#include "TemporalStatistics.h"
+#include "DataAdaptor.h"
+#include "SVTKDataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "Error.h"
+
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkDataSet.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkFieldData.h>
+#include <svtkFloatArray.h>
+#include <svtkSmartPointer.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using BlockState = sensei::TemporalStatistics::BlockState;
+using ArrayState = sensei::TemporalStatistics::ArrayState;
+
+namespace
+{
+// **************************************************************************
+/** Split [0, n) into contiguous ranges and call f(i0, i1) for each on its
+ * own thread. Small ranges are not split.
+ */
+template <typename func_t>
+void ParallelFor(long n, int nThreads, const func_t &f)
+{
+  nThreads = std::max(1l, std::min<long>(nThreads, n / 16384 + 1));
+
+  auto work = [&](int tid)
+  {
+    long nPer = n / nThreads;
+    long nLarge = n % nThreads;
+    long i0 = nPer*tid + std::min<long>(tid, nLarge);
+    long i1 = i0 + nPer + (tid < nLarge ? 1 : 0);
+    f(i0, i1);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads - 1);
+  for (int i = 1; i < nThreads; ++i)
+    threads.emplace_back(work, i);
+
+  work(0);
+
+  for (int i = 0; i < nThreads - 1; ++i)
+    threads[i].join();
+}
+
+// **************************************************************************
+/// start the statistics from the values [i0, i1)
+template <typename T>
+void Initialize(const T *x, long i0, long i1, float *mean, float *m2,
+  float *mn, float *mx, float *meanC, float *m2C)
+{
+  for (long i = i0; i < i1; ++i)
+    {
+    float xi = x[i];
+    mean[i] = xi;
+    m2[i] = 0.0f;
+    mn[i] = xi;
+    mx[i] = xi;
+    }
+
+  // the compensation starts with the part of the value lost in the
+  // conversion to float
+  if (meanC)
+    {
+    for (long i = i0; i < i1; ++i)
+      {
+      meanC[i] = mean[i] - x[i];
+      m2C[i] = 0.0f;
+      }
+    }
+}
+
+// **************************************************************************
+/** Fold the values [i0, i1) into the statistics. With w = 1/n this is
+ * Welford's update of the mean and the sum of squared differences. With w a
+ * fixed weight this is the exponentially weighted mean and variance, where
+ * the variance is written as an increment so that it can be compensated.
+ * The branches depend only on template parameters so that the loops
+ * vectorize.
+ */
+template <typename T, bool weighted, bool compensated>
+void Update(const T * __restrict__ x, long i0, long i1, float w,
+  float * __restrict__ mean, float * __restrict__ m2, float * __restrict__ mn,
+  float * __restrict__ mx, float * __restrict__ meanC,
+  float * __restrict__ m2C)
+{
+  float w1 = 1.0f - w;
+  for (long i = i0; i < i1; ++i)
+    {
+    // the difference is taken in the precision of the input, and includes
+    // the compensation, so that offsets large relative to the variation are
+    // not rounded away
+    T xi = x[i];
+    float mi = mean[i];
+    float delta = compensated ? (xi - mi) + meanC[i] : xi - mi;
+    float dMean = w*delta;
+
+    float dM2 = weighted ? w1*delta*dMean - w*m2[i] : delta*(delta - dMean);
+
+    if (compensated)
+      {
+      float y = dMean - meanC[i];
+      float t = mi + y;
+      meanC[i] = (t - mi) - y;
+      mean[i] = t;
+
+      float m2i = m2[i];
+      y = dM2 - m2C[i];
+      t = m2i + y;
+      m2C[i] = (t - m2i) - y;
+      m2[i] = t;
+      }
+    else
+      {
+      mean[i] = mi + dMean;
+      m2[i] += dM2;
+      }
+
+    float xf = xi;
+    mn[i] = xf < mn[i] ? xf : mn[i];
+    mx[i] = xf > mx[i] ? xf : mx[i];
+    }
+}
+
+// **************************************************************************
+/** Fold the n-th set of values of a block into its statistics, using
+ * nThreads threads.
+ */
+template <typename T>
+void Update(const T *x, long n, double decay, int compensated, int nThreads,
+  BlockState &b)
+{
+  long size = b.Size;
+
+  if (n == 1)
+    {
+    b.Mean.resize(size);
+    b.M2.resize(size);
+    b.Min.resize(size);
+    b.Max.resize(size);
+    b.MeanC.resize(compensated ? size : 0);
+    b.M2C.resize(compensated ? size : 0);
+    }
+
+  float *mean = b.Mean.data();
+  float *m2 = b.M2.data();
+  float *mn = b.Min.data();
+  float *mx = b.Max.data();
+  float *meanC = compensated ? b.MeanC.data() : nullptr;
+  float *m2C = compensated ? b.M2C.data() : nullptr;
+
+  bool weighted = decay > 0.0;
+  float w = weighted ? decay : 1.0/n;
+
+  ParallelFor(size, nThreads, [&](long i0, long i1)
+    {
+    if (n == 1)
+      ::Initialize(x, i0, i1, mean, m2, mn, mx, meanC, m2C);
+    else if (weighted && compensated)
+      ::Update<T, true, true>(x, i0, i1, w, mean, m2, mn, mx, meanC, m2C);
+    else if (weighted)
+      ::Update<T, true, false>(x, i0, i1, w, mean, m2, mn, mx, meanC, m2C);
+    else if (compensated)
+      ::Update<T, false, true>(x, i0, i1, w, mean, m2, mn, mx, meanC, m2C);
+    else
+      ::Update<T, false, false>(x, i0, i1, w, mean, m2, mn, mx, meanC, m2C);
+    });
+}
+
+// **************************************************************************
+/// Fold the values of the array into the statistics
+int Update(svtkDataArray *da, long n, double decay, int compensated,
+  int nThreads, BlockState &b)
+{
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+      if (aosDa)
+        {
+        // direct access to contiguous data
+        ::Update(aosDa->GetPointer(0), n, decay, compensated, nThreads, b);
+        }
+      else
+        {
+        // other layouts are converted
+        svtkFloatArray *tmp = svtkFloatArray::New();
+        tmp->DeepCopy(da);
+        ::Update(tmp->GetPointer(0), n, decay, compensated, nThreads, b);
+        tmp->Delete();
+        }
+    );
+    default:
+      {
+      SENSEI_ERROR("Unsupported dispatch " << da->GetClassName())
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+// **************************************************************************
+/// copy the ghost zone arrays of the input to the output
+void CopyGhosts(svtkDataSet *ds, svtkDataSet *dso)
+{
+  int assocs[] = {svtkDataObject::POINT, svtkDataObject::CELL};
+  for (int i = 0; i < 2; ++i)
+    {
+    svtkDataArray *ga = ds->GetAttributes(assocs[i])->GetArray("svtkGhostType");
+    if (ga)
+      dso->GetAttributes(assocs[i])->AddArray(ga);
+    }
+}
+
+// **************************************************************************
+/** Make a data object with the same structure as the input, sharing its
+ * geometry and ghost zone arrays but no other arrays.
+ */
+svtkDataObject *NewStructure(svtkDataObject *dobj)
+{
+  if (svtkCompositeDataSet *cd = dynamic_cast<svtkCompositeDataSet*>(dobj))
+    {
+    svtkCompositeDataSet *cdo = cd->NewInstance();
+    cdo->CopyStructure(cd);
+
+    svtkSmartPointer<svtkCompositeDataIterator> it;
+    it.TakeReference(cd->NewIterator());
+    for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
+      {
+      svtkDataSet *ds = dynamic_cast<svtkDataSet*>(it->GetCurrentDataObject());
+      if (!ds)
+        continue;
+
+      svtkDataSet *dso = ds->NewInstance();
+      dso->CopyStructure(ds);
+      ::CopyGhosts(ds, dso);
+
+      cdo->SetDataSet(it, dso);
+      dso->Delete();
+      }
+
+    return cdo;
+    }
+  else if (svtkDataSet *ds = dynamic_cast<svtkDataSet*>(dobj))
+    {
+    svtkDataSet *dso = ds->NewInstance();
+    dso->CopyStructure(ds);
+    ::CopyGhosts(ds, dso);
+    return dso;
+    }
+
+  SENSEI_ERROR("Unsupoorted data object type " << dobj->GetClassName())
+  return nullptr;
+}
+
+// **************************************************************************
+svtkFloatArray *NewArray(const std::string &name, int nComps, long nTups)
+{
+  svtkFloatArray *fa = svtkFloatArray::New();
+  fa->SetName(name.c_str());
+  fa->SetNumberOfComponents(nComps);
+  fa->SetNumberOfTuples(nTups);
+  return fa;
+}
+}
+
+namespace sensei
+{
+//-----------------------------------------------------------------------------
+senseiNewMacro(TemporalStatistics);
+
+//-----------------------------------------------------------------------------
+TemporalStatistics::TemporalStatistics() : Interval(1), Reset(1),
+  Decay(0.0), Compensated(0), NumberOfThreads(1), StepCount(0)
+{
+}
+
+//-----------------------------------------------------------------------------
+TemporalStatistics::~TemporalStatistics()
+{
+}
+
+//-----------------------------------------------------------------------------
+int TemporalStatistics::SetDataRequirements(const DataRequirements &reqs)
+{
+  this->Requirements = reqs;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int TemporalStatistics::AddDataRequirement(const std::string &meshName,
+  int association, const std::vector<std::string> &arrays)
+{
+  this->Requirements.AddRequirement(meshName, association, arrays);
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void TemporalStatistics::SetInterval(int interval)
+{
+  this->Interval = interval < 1 ? 1 : interval;
+}
+
+//-----------------------------------------------------------------------------
+void TemporalStatistics::SetReset(int reset)
+{
+  this->Reset = reset;
+}
+
+//-----------------------------------------------------------------------------
+int TemporalStatistics::SetDecay(double decay)
+{
+  if ((decay < 0.0) || (decay > 1.0))
+    {
+    SENSEI_ERROR("Invalid decay " << decay << ". The decay must be in [0, 1]")
+    return -1;
+    }
+
+  this->Decay = decay;
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+void TemporalStatistics::SetCompensated(int compensated)
+{
+  this->Compensated = compensated;
+}
+
+//-----------------------------------------------------------------------------
+void TemporalStatistics::SetNumberOfThreads(int nThreads)
+{
+  this->NumberOfThreads = nThreads < 1 ? 1 : nThreads;
+}
+
+//-----------------------------------------------------------------------------
+int TemporalStatistics::Update(svtkDataObject *mesh,
+  const std::string &meshName, int association, const std::string &arrayName,
+  ArrayState &state)
+{
+  std::vector<svtkDataSet*> blocks;
+  if (SVTKUtils::GetLeaves(mesh, blocks))
+    return -1;
+
+  size_t nBlocks = blocks.size();
+
+  // locate the array in each block and check that the mesh did not change
+  std::vector<svtkDataArray*> arrays(nBlocks);
+  int nComps = 0;
+  bool restart = state.Blocks.size() != nBlocks;
+
+  for (size_t i = 0; i < nBlocks; ++i)
+    {
+    svtkFieldData *fd = blocks[i]->GetAttributesAsFieldData(association);
+
+    svtkDataArray *da = fd ? fd->GetArray(arrayName.c_str()) : nullptr;
+    if (!da)
+      {
+      SENSEI_ERROR("Data block " << i << " of mesh \"" << meshName
+        << "\" has no array named \"" << arrayName << "\"")
+      return -1;
+      }
+
+    if (i && (da->GetNumberOfComponents() != nComps))
+      {
+      SENSEI_ERROR("Array \"" << arrayName << "\" has a different number"
+        " of components in data block " << i)
+      return -1;
+      }
+
+    nComps = da->GetNumberOfComponents();
+    arrays[i] = da;
+
+    long size = da->GetNumberOfTuples() * nComps;
+    restart |= !restart && (state.Blocks[i].Size != size);
+    }
+
+  if (restart)
+    {
+    if (state.Count)
+      SENSEI_WARNING("Mesh \"" << meshName << "\" changed. Restarting the"
+        " statistics of array \"" << arrayName << "\"")
+
+    state.Count = 0;
+    state.Blocks.assign(nBlocks, BlockState());
+
+    for (size_t i = 0; i < nBlocks; ++i)
+      state.Blocks[i].Size = arrays[i]->GetNumberOfTuples() * nComps;
+    }
+
+  state.Association = association;
+  state.NumberOfComponents = nComps;
+
+  long n = state.Count + 1;
+
+  // blocks are processed concurrently when there are enough of them to keep
+  // the threads busy, otherwise each block is split across the threads.
+  int nOuter = int(nBlocks) >= this->NumberOfThreads ? this->NumberOfThreads : 1;
+  int nInner = nOuter > 1 ? 1 : this->NumberOfThreads;
+
+  SVTKUtils::IndexedDatasetFunction update =
+    [&](int leaf, int, svtkDataSet *) -> int
+    {
+    return ::Update(arrays[leaf], n, this->Decay, this->Compensated,
+      nInner, state.Blocks[leaf]);
+    };
+
+  if (SVTKUtils::Apply(mesh, update, nOuter))
+    {
+    SENSEI_ERROR("Failed to update the statistics of array \""
+      << arrayName << "\" on mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  state.Count = n;
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int TemporalStatistics::AddArrays(svtkDataObject *meshOut,
+  const std::string &arrayName, const ArrayState &state)
+{
+  int nComps = state.NumberOfComponents;
+
+  // for the uniform weighting convert the sum of squared differences to the
+  // sample variance
+  bool weighted = this->Decay > 0.0;
+  float scale = weighted ? 1.0f :
+    (state.Count > 1 ? 1.0f / (state.Count - 1) : 0.0f);
+
+  SVTKUtils::IndexedDatasetFunction addArrays =
+    [&](int leaf, int, svtkDataSet *ds) -> int
+    {
+    const BlockState &b = state.Blocks[leaf];
+    long nTups = nComps ? b.Size / nComps : 0;
+
+    svtkFloatArray *mean = ::NewArray(arrayName + "_mean", nComps, nTups);
+    svtkFloatArray *mn = ::NewArray(arrayName + "_min", nComps, nTups);
+    svtkFloatArray *mx = ::NewArray(arrayName + "_max", nComps, nTups);
+    svtkFloatArray *var = ::NewArray(arrayName + "_variance", nComps, nTups);
+
+    float *pMean = mean->GetPointer(0);
+    if (b.MeanC.empty())
+      std::copy(b.Mean.begin(), b.Mean.end(), pMean);
+    else
+      for (long i = 0; i < b.Size; ++i)
+        pMean[i] = b.Mean[i] - b.MeanC[i];
+
+    std::copy(b.Min.begin(), b.Min.end(), mn->GetPointer(0));
+    std::copy(b.Max.begin(), b.Max.end(), mx->GetPointer(0));
+
+    float *pVar = var->GetPointer(0);
+    for (long i = 0; i < b.Size; ++i)
+      pVar[i] = scale * b.M2[i];
+
+    svtkDataSetAttributes *atts = ds->GetAttributes(state.Association);
+
+    svtkFloatArray *arrays[] = {mean, mn, mx, var};
+    for (int i = 0; i < 4; ++i)
+      {
+      atts->AddArray(arrays[i]);
+      arrays[i]->Delete();
+      }
+
+    return 0;
+    };
+
+  std::vector<svtkDataSet*> blocks;
+  if (SVTKUtils::GetLeaves(meshOut, blocks) ||
+    (blocks.size() != state.Blocks.size()) ||
+    SVTKUtils::Apply(meshOut, addArrays, this->NumberOfThreads))
+    {
+    SENSEI_ERROR("Failed to add the statistics of array \"" << arrayName << "\"")
+    return -1;
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+bool TemporalStatistics::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
+{
+  TimeEvent<128> mark("TemporalStatistics::Execute");
+
+  if (dataOut)
+    {
+    *dataOut = nullptr;
+    }
+
+  MPI_Comm comm = this->GetCommunicator();
+
+  if (this->Requirements.Empty())
+    {
+    SENSEI_ERROR("No arrays were selected")
+    return false;
+    }
+
+  // see what the simulation is providing
+  MeshMetadataMap mdMap;
+  if (mdMap.Initialize(dataIn))
+    {
+    SENSEI_ERROR("Failed to get metadata")
+    return false;
+    }
+
+  // the geometry is only needed on the steps that produce output
+  this->StepCount += 1;
+  bool emit = (this->StepCount % this->Interval) == 0;
+
+  SVTKDataAdaptor *out = nullptr;
+  if (emit && dataOut)
+    {
+    out = SVTKDataAdaptor::New();
+    out->SetCommunicator(comm);
+    out->SetDataTimeStep(dataIn->GetDataTimeStep());
+    out->SetDataTime(dataIn->GetDataTime());
+    }
+
+  MeshRequirementsIterator mit =
+    this->Requirements.GetMeshRequirementsIterator();
+
+  while (mit)
+    {
+    const std::string &meshName = mit.MeshName();
+
+    MeshMetadataPtr mmd;
+    if (mdMap.GetMeshMetadata(meshName, mmd))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+      if (out)
+        out->Delete();
+      return false;
+      }
+
+    svtkDataObject *dobj = nullptr;
+    if (dataIn->GetMesh(meshName, !out, dobj))
+      {
+      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+      if (out)
+        out->Delete();
+      return false;
+      }
+
+    // it is not an error for a rank to have no data
+    svtkDataObject *meshOut = nullptr;
+    if (dobj && out)
+      {
+      if (mmd->NumGhostCells && dataIn->AddGhostCellsArray(dobj, meshName))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add ghost cells.")
+        dobj->Delete();
+        out->Delete();
+        return false;
+        }
+
+      if (mmd->NumGhostNodes && dataIn->AddGhostNodesArray(dobj, meshName))
+        {
+        SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add ghost nodes.")
+        dobj->Delete();
+        out->Delete();
+        return false;
+        }
+
+      if (!(meshOut = ::NewStructure(dobj)))
+        {
+        dobj->Delete();
+        out->Delete();
+        return false;
+        }
+
+      SVTKUtils::SetGhostLayerMetadata(meshOut,
+        mmd->NumGhostCells, mmd->NumGhostNodes);
+      }
+
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(meshName);
+
+    while (ait)
+      {
+      int assoc = ait.Association();
+      const std::string &arrayName = ait.Array();
+
+      ArrayState &state = this->State[meshName][ArrayKey(assoc, arrayName)];
+
+      if (dobj)
+        {
+        if (dataIn->AddArray(dobj, meshName, assoc, arrayName))
+          {
+          SENSEI_ERROR(<< dataIn->GetClassName() << " failed to add "
+            << SVTKUtils::GetAttributesName(assoc) << " data array \""
+            << arrayName << "\"")
+          if (meshOut)
+            meshOut->Delete();
+          dobj->Delete();
+          if (out)
+            out->Delete();
+          return false;
+          }
+
+        if (this->Update(dobj, meshName, assoc, arrayName, state) ||
+          (meshOut && this->AddArrays(meshOut, arrayName, state)))
+          {
+          if (meshOut)
+            meshOut->Delete();
+          dobj->Delete();
+          if (out)
+            out->Delete();
+          return false;
+          }
+        }
+
+      if (emit && this->Reset)
+        state.Count = 0;
+
+      ++ait;
+      }
+
+    if (out)
+      out->SetDataObject(meshName, meshOut);
+
+    if (meshOut)
+      meshOut->Delete();
+
+    if (dobj)
+      dobj->Delete();
+
+    ++mit;
+    }
+
+  if (out)
+    *dataOut = out;
+
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int TemporalStatistics::Finalize()
+{
+  this->State.clear();
+  return 0;
+}
+
+}
@@ -0,0 +1,136 @@
+#ifndef sensei_TemporalStatistics_h
+#define sensei_TemporalStatistics_h
+
+#include "AnalysisAdaptor.h"
+#include "DataRequirements.h"
+
+#include <map>
+#include <mpi.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+class svtkDataObject;
+
+namespace sensei
+{
+
+/** Computes per point or per cell statistics (mean, min, max, and variance)
+ * of any number of arrays over time. Each time step the values of the
+ * selected arrays are folded into running statistics held in single
+ * precision, using Welford's update or, when a decay is set, an
+ * exponentially weighted mean and variance. Kahan compensation of the mean
+ * and variance may be enabled to limit the round off accumulated over long
+ * runs. Blocks are updated in parallel by a number of threads.
+ *
+ * Every interval time steps the statistics are returned through the output
+ * DataAdaptor, otherwise no output is produced. The output holds a mesh,
+ * with the same name and structure as the input, for each of the selected
+ * meshes. The statistics of array "x" are returned in the arrays "x_mean",
+ * "x_min", "x_max" and "x_variance" with the association of "x". By default
+ * the statistics are reset after they are returned, so that each output
+ * summarizes the steps since the previous one.
+ *
+ * The mesh must be static, when the number of blocks or the size of a block
+ * changes the statistics of the array are restarted.
+ */
+class SENSEI_EXPORT TemporalStatistics : public AnalysisAdaptor
+{
+public:
+  /// allocates a new instance
+  static TemporalStatistics *New();
+
+  senseiTypeMacro(TemporalStatistics, AnalysisAdaptor);
+
+  /// Set the meshes and arrays to compute statistics for.
+  int SetDataRequirements(const DataRequirements &reqs);
+
+  /// Add a single array to the list of arrays to process.
+  int AddDataRequirement(const std::string &meshName,
+    int association, const std::vector<std::string> &arrays);
+
+  /** Set the number of time steps between outputs. The default is 1, which
+   * returns the statistics every step.
+   */
+  void SetInterval(int interval);
+
+  /** When set, the default, the statistics are restarted after they are
+   * returned. Otherwise they accumulate over the whole run.
+   */
+  void SetReset(int reset);
+
+  /** Set the weight, in (0, 1], of the newest value in an exponentially
+   * weighted mean and variance. The default, 0, weights all values equally.
+   */
+  int SetDecay(double decay);
+
+  /// Enable Kahan compensated updates of the mean and variance.
+  void SetCompensated(int compensated);
+
+  /// Set the number of threads used to process local data. The default is 1.
+  void SetNumberOfThreads(int nThreads);
+
+  /// update the statistics with this time step
+  bool Execute(DataAdaptor *data, DataAdaptor **dataOut) override;
+
+  /// finalize the run
+  int Finalize() override;
+
+  /// the running statistics of a single block of an array
+  struct BlockState
+  {
+    BlockState() : Size(0) {}
+
+    long Size;                 ///< number of values, tuples times components
+    std::vector<float> Mean;   ///< the mean
+    std::vector<float> M2;     ///< the sum of squared differences, or variance
+    std::vector<float> Min;    ///< the smallest value
+    std::vector<float> Max;    ///< the largest value
+    std::vector<float> MeanC;  ///< compensation of the mean
+    std::vector<float> M2C;    ///< compensation of M2
+  };
+
+  /// the running statistics of all blocks of an array
+  struct ArrayState
+  {
+    ArrayState() : Association(0), NumberOfComponents(0), Count(0) {}
+
+    int Association;
+    int NumberOfComponents;
+    long Count;                     ///< number of time steps accumulated
+    std::vector<BlockState> Blocks; ///< indexed by leaf in iteration order
+  };
+
+protected:
+  TemporalStatistics();
+  ~TemporalStatistics();
+
+  TemporalStatistics(const TemporalStatistics&) = delete;
+  void operator=(const TemporalStatistics&) = delete;
+
+  // fold the values of the array into its running statistics
+  int Update(svtkDataObject *mesh, const std::string &meshName,
+    int association, const std::string &arrayName, ArrayState &state);
+
+  // add the statistics of the array to the output mesh
+  int AddArrays(svtkDataObject *meshOut, const std::string &arrayName,
+    const ArrayState &state);
+
+  using ArrayKey = std::pair<int, std::string>;
+
+private:
+  DataRequirements Requirements;
+  int Interval;
+  int Reset;
+  double Decay;
+  int Compensated;
+  int NumberOfThreads;
+  long StepCount;
+
+  // the state of each array, by mesh and by association and array
+  std::map<std::string, std::map<ArrayKey, ArrayState>> State;
+};
+
+}
+
+#endif
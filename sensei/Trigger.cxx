@@ -0,0 +1,497 @@
+#include "Trigger.h"
+#include "DataAdaptor.h"
+#include "MeshMetadata.h"
+#include "MeshMetadataMap.h"
+#include "Profiler.h"
+#include "SVTKUtils.h"
+#include "XMLUtils.h"
+#include "Error.h"
+
+#include <svtkAOSDataArrayTemplate.h>
+#include <svtkCompositeDataIterator.h>
+#include <svtkCompositeDataSet.h>
+#include <svtkDataArray.h>
+#include <svtkDataObject.h>
+#include <svtkFieldData.h>
+#include <svtkSmartPointer.h>
+#include <svtkUnsignedCharArray.h>
+
+#include <pugixml.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// **************************************************************************
+/** Accumulate the min, max, and sum of squares of all components of the
+ * tuples not flagged as ghosts. The accessor returns component j of tuple i.
+ */
+template <typename accessor_t>
+void Accumulate(const accessor_t &value, const unsigned char *ghosts,
+  long nTups, int nComps, double &minVal, double &maxVal, double &sumSq)
+{
+  for (long i = 0; i < nTups; ++i)
+    {
+    if (ghosts && ghosts[i])
+      continue;
+
+    for (int j = 0; j < nComps; ++j)
+      {
+      double val = value(i, j);
+      minVal = std::min(minVal, val);
+      maxVal = std::max(maxVal, val);
+      sumSq += val*val;
+      }
+    }
+}
+
+// **************************************************************************
+int Accumulate(svtkDataArray *da, svtkUnsignedCharArray *ga,
+  double &minVal, double &maxVal, double &sumSq)
+{
+  long nTups = da->GetNumberOfTuples();
+  int nComps = da->GetNumberOfComponents();
+
+  const unsigned char *ghosts = ga ? ga->GetPointer(0) : nullptr;
+
+  switch (da->GetDataType())
+    {
+    svtkTemplateMacro(
+      svtkAOSDataArrayTemplate<SVTK_TT> *aosDa =
+        dynamic_cast<svtkAOSDataArrayTemplate<SVTK_TT>*>(da);
+      if (aosDa)
+        {
+        const SVTK_TT *pDa = aosDa->GetPointer(0);
+        ::Accumulate([pDa,nComps](long i, int j) -> double
+          { return pDa[i*nComps + j]; }, ghosts, nTups, nComps,
+          minVal, maxVal, sumSq);
+        }
+      else
+        {
+        ::Accumulate([da](long i, int j) -> double
+          { return da->GetComponent(i, j); }, ghosts, nTups, nComps,
+          minVal, maxVal, sumSq);
+        }
+    );
+    default:
+      {
+      SENSEI_ERROR("Unsupported dispatch " << da->GetClassName())
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+// **************************************************************************
+/** Make a pass over the local blocks of the named array computing the min,
+ * max, and sum of squares of the values. Ranks without data return the
+ * identity of each of the reductions.
+ */
+int Accumulate(MPI_Comm comm, sensei::DataAdaptor *data,
+  const std::string &meshName, int association, const std::string &arrayName,
+  double &minVal, double &maxVal, double &sumSq)
+{
+  minVal = std::numeric_limits<double>::max();
+  maxVal = std::numeric_limits<double>::lowest();
+  sumSq = 0.0;
+
+  sensei::MeshMetadataMap mdMap;
+  sensei::MeshMetadataPtr mmd;
+  if (mdMap.Initialize(data) || mdMap.GetMeshMetadata(meshName, mmd))
+    {
+    SENSEI_ERROR("Failed to get metadata for mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  svtkDataObject *dobj = nullptr;
+  if (data->GetMesh(meshName, true, dobj))
+    {
+    SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
+    return -1;
+    }
+
+  // it is not an error for a rank to have no data
+  if (!dobj)
+    return 0;
+
+  if ((association == svtkDataObject::CELL) &&
+    (mmd->NumGhostCells || sensei::SVTKUtils::AMR(mmd)) &&
+    data->AddGhostCellsArray(dobj, meshName))
+    {
+    SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost cells.")
+    dobj->Delete();
+    return -1;
+    }
+
+  if ((association == svtkDataObject::POINT) && mmd->NumGhostNodes &&
+    data->AddGhostNodesArray(dobj, meshName))
+    {
+    SENSEI_ERROR(<< data->GetClassName() << " failed to add ghost nodes.")
+    dobj->Delete();
+    return -1;
+    }
+
+  if (data->AddArray(dobj, meshName, association, arrayName))
+    {
+    SENSEI_ERROR(<< data->GetClassName() << " failed to add "
+      << sensei::SVTKUtils::GetAttributesName(association)
+      << " data array \"" << arrayName << "\"")
+    dobj->Delete();
+    return -1;
+    }
+
+  // the composite wrapper takes ownership
+  svtkCompositeDataSetPtr mesh =
+    sensei::SVTKUtils::AsCompositeData(comm, dobj, true);
+
+  svtkSmartPointer<svtkCompositeDataIterator> iter;
+  iter.TakeReference(mesh->NewIterator());
+  for (iter->InitTraversal(); !iter->IsDoneWithTraversal(); iter->GoToNextItem())
+    {
+    svtkFieldData *fd =
+      iter->GetCurrentDataObject()->GetAttributesAsFieldData(association);
+
+    svtkDataArray *da = fd ? fd->GetArray(arrayName.c_str()) : nullptr;
+    if (!da)
+      {
+      SENSEI_ERROR("Data block " << iter->GetCurrentFlatIndex()
+        << " of mesh \"" << meshName << "\" has no array named \""
+        << arrayName << "\"")
+      return -1;
+      }
+
+    svtkUnsignedCharArray *ga = dynamic_cast<svtkUnsignedCharArray*>(
+      fd->GetArray("svtkGhostType"));
+
+    if (::Accumulate(da, ga, minVal, maxVal, sumSq))
+      return -1;
+    }
+
+  return 0;
+}
+}
+
+namespace sensei
+{
+
+//----------------------------------------------------------------------------
+Trigger::Trigger() : Name(), Type(Trigger::INTERVAL), MeshName(),
+  ArrayName(), Association(svtkDataObject::POINT), UseMetadata(false),
+  OnCrossing(false), WasOutside(false), HaveAbove(false), Above(0.0),
+  HaveBelow(false), Below(0.0), Threshold(0.0), Interval(0.0),
+  HaveFired(false), LastFiredNorm(0.0), LastFiredTime(0.0), LastValue(0.0)
+{
+}
+
+//----------------------------------------------------------------------------
+Trigger::~Trigger()
+{
+}
+
+//----------------------------------------------------------------------------
+void Trigger::SetArray(const std::string &meshName, int association,
+  const std::string &arrayName)
+{
+  this->MeshName = meshName;
+  this->Association = association;
+  this->ArrayName = arrayName;
+}
+
+//----------------------------------------------------------------------------
+void Trigger::SetAbove(double above)
+{
+  this->HaveAbove = true;
+  this->Above = above;
+}
+
+//----------------------------------------------------------------------------
+void Trigger::SetBelow(double below)
+{
+  this->HaveBelow = true;
+  this->Below = below;
+}
+
+//----------------------------------------------------------------------------
+const char *Trigger::GetTypeName() const
+{
+  switch (this->Type)
+    {
+    case Trigger::RANGE: return "range";
+    case Trigger::NORM_CHANGE: return "norm_change";
+    case Trigger::INTERVAL: return "interval";
+    }
+  return "unknown";
+}
+
+//----------------------------------------------------------------------------
+int Trigger::Initialize(const pugi::xml_node &node)
+{
+  if (XMLUtils::RequireAttribute(node, "name") ||
+    XMLUtils::RequireAttribute(node, "type"))
+    {
+    SENSEI_ERROR("Failed to initialize Trigger")
+    return -1;
+    }
+
+  this->Name = node.attribute("name").value();
+
+  std::string type = node.attribute("type").value();
+  if (type == "range")
+    {
+    this->Type = Trigger::RANGE;
+    }
+  else if (type == "norm_change")
+    {
+    this->Type = Trigger::NORM_CHANGE;
+    }
+  else if (type == "interval")
+    {
+    this->Type = Trigger::INTERVAL;
+    }
+  else
+    {
+    SENSEI_ERROR("Trigger \"" << this->Name << "\" has invalid type \""
+      << type << "\". Use one of range, norm_change, or interval")
+    return -1;
+    }
+
+  if (this->Type == Trigger::INTERVAL)
+    {
+    if (XMLUtils::RequireAttribute(node, "interval"))
+      {
+      SENSEI_ERROR("Failed to initialize Trigger \"" << this->Name << "\"")
+      return -1;
+      }
+
+    this->Interval = node.attribute("interval").as_double();
+    return 0;
+    }
+
+  if (XMLUtils::RequireAttribute(node, "mesh") ||
+    XMLUtils::RequireAttribute(node, "array"))
+    {
+    SENSEI_ERROR("Failed to initialize Trigger \"" << this->Name << "\"")
+    return -1;
+    }
+
+  int association = 0;
+  std::string assocStr = node.attribute("association").as_string("point");
+  if (SVTKUtils::GetAssociation(assocStr, association))
+    {
+    SENSEI_ERROR("Failed to initialize Trigger \"" << this->Name << "\"")
+    return -1;
+    }
+
+  this->SetArray(node.attribute("mesh").value(), association,
+    node.attribute("array").value());
+
+  if (this->Type == Trigger::RANGE)
+    {
+    if (!node.attribute("above") && !node.attribute("below"))
+      {
+      SENSEI_ERROR("Trigger \"" << this->Name << "\" of type range"
+        " requires one or both of the above and below attributes")
+      return -1;
+      }
+
+    if (node.attribute("above"))
+      this->SetAbove(node.attribute("above").as_double());
+
+    if (node.attribute("below"))
+      this->SetBelow(node.attribute("below").as_double());
+
+    this->UseMetadata = node.attribute("use_metadata").as_int(0);
+    this->OnCrossing = node.attribute("on_crossing").as_int(0);
+    }
+  else
+    {
+    if (XMLUtils::RequireAttribute(node, "threshold"))
+      {
+      SENSEI_ERROR("Failed to initialize Trigger \"" << this->Name << "\"")
+      return -1;
+      }
+
+    this->Threshold = node.attribute("threshold").as_double();
+    }
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int Trigger::ComputeRange(MPI_Comm comm, DataAdaptor *data, double range[2])
+{
+  double minVal = std::numeric_limits<double>::max();
+  double maxVal = std::numeric_limits<double>::lowest();
+
+  bool haveRange = false;
+
+  // use the per-block ranges the simulation provides
+  if (this->UseMetadata)
+    {
+    MeshMetadataFlags flags;
+    flags.SetBlockArrayRange();
+
+    MeshMetadataMap mdMap;
+    MeshMetadataPtr mmd;
+    if (mdMap.Initialize(data, flags) ||
+      mdMap.GetMeshMetadata(this->MeshName, mmd))
+      {
+      SENSEI_ERROR("Failed to get metadata for mesh \""
+        << this->MeshName << "\"")
+      return -1;
+      }
+
+    auto it = std::find(mmd->ArrayName.begin(), mmd->ArrayName.end(),
+      this->ArrayName);
+
+    if (it == mmd->ArrayName.end())
+      {
+      SENSEI_ERROR("No array named \"" << this->ArrayName
+        << "\" on mesh \"" << this->MeshName << "\"")
+      return -1;
+      }
+
+    size_t idx = it - mmd->ArrayName.begin();
+
+    // the local view holds the local blocks only
+    int localHave = mmd->Flags.BlockArrayRangeSet();
+    int nBlocks = mmd->BlockArrayRange.size();
+    for (int i = 0; localHave && (i < nBlocks); ++i)
+      {
+      if (mmd->BlockArrayRange[i].size() <= idx)
+        {
+        localHave = 0;
+        break;
+        }
+
+      const std::array<double,2> &rng = mmd->BlockArrayRange[i][idx];
+      minVal = std::min(minVal, rng[0]);
+      maxVal = std::max(maxVal, rng[1]);
+      }
+
+    // all ranks must agree about falling back to the data
+    int have = 0;
+    MPI_Allreduce(&localHave, &have, 1, MPI_INT, MPI_MIN, comm);
+    haveRange = have;
+    }
+
+  if (!haveRange)
+    {
+    double sumSq = 0.0;
+    if (::Accumulate(comm, data, this->MeshName, this->Association,
+      this->ArrayName, minVal, maxVal, sumSq))
+      return -1;
+    }
+
+  // reduce both bounds in a single collective
+  double localRange[2] = {-minVal, maxVal};
+  MPI_Allreduce(localRange, range, 2, MPI_DOUBLE, MPI_MAX, comm);
+  range[0] = -range[0];
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int Trigger::ComputeNorm(MPI_Comm comm, DataAdaptor *data, double &norm)
+{
+  double minVal = 0.0;
+  double maxVal = 0.0;
+  double sumSq = 0.0;
+
+  if (::Accumulate(comm, data, this->MeshName, this->Association,
+    this->ArrayName, minVal, maxVal, sumSq))
+    return -1;
+
+  double globalSumSq = 0.0;
+  MPI_Allreduce(&sumSq, &globalSumSq, 1, MPI_DOUBLE, MPI_SUM, comm);
+
+  norm = std::sqrt(globalSumSq);
+
+  return 0;
+}
+
+//----------------------------------------------------------------------------
+int Trigger::Evaluate(MPI_Comm comm, DataAdaptor *data, bool &fire)
+{
+  TimeEvent<128> mark("Trigger::Evaluate");
+
+  fire = false;
+
+  switch (this->Type)
+    {
+    case Trigger::RANGE:
+      {
+      double range[2] = {0.0, 0.0};
+      if (this->ComputeRange(comm, data, range))
+        {
+        SENSEI_ERROR("Failed to evaluate trigger \"" << this->Name << "\"")
+        return -1;
+        }
+
+      bool outside = (this->HaveAbove && (range[1] >= this->Above)) ||
+        (this->HaveBelow && (range[0] <= this->Below));
+
+      // level-triggered unless set to fire only on crossing a threshold
+      fire = outside && !(this->OnCrossing && this->WasOutside);
+
+      this->WasOutside = outside;
+
+      this->LastValue = this->HaveAbove ? range[1] : range[0];
+      break;
+      }
+    case Trigger::NORM_CHANGE:
+      {
+      double norm = 0.0;
+      if (this->ComputeNorm(comm, data, norm))
+        {
+        SENSEI_ERROR("Failed to evaluate trigger \"" << this->Name << "\"")
+        return -1;
+        }
+
+      double change = std::numeric_limits<double>::max();
+      if (this->HaveFired)
+        {
+        double ref = std::fabs(this->LastFiredNorm);
+        double delta = std::fabs(norm - this->LastFiredNorm);
+        change = ref > 0.0 ? delta/ref :
+          (delta > 0.0 ? std::numeric_limits<double>::max() : 0.0);
+        }
+
+      fire = change >= this->Threshold;
+
+      this->LastValue = change;
+
+      if (fire)
+        this->LastFiredNorm = norm;
+      break;
+      }
+    case Trigger::INTERVAL:
+      {
+      double time = data->GetDataTime();
+
+      fire = !this->HaveFired ||
+        (time - this->LastFiredTime >= this->Interval);
+
+      this->LastValue = this->HaveFired ? time - this->LastFiredTime : 0.0;
+
+      if (fire)
+        this->LastFiredTime = time;
+      break;
+      }
+    default:
+      {
+      SENSEI_ERROR("Trigger \"" << this->Name << "\" has invalid type "
+        << this->Type)
+      return -1;
+      }
+    }
+
+  this->HaveFired = this->HaveFired || fire;
+
+  return 0;
+}
+
+}
@@ -0,0 +1,141 @@
+#ifndef sensei_Trigger_h
+#define sensei_Trigger_h
+
+#include "senseiConfig.h"
+
+#include <mpi.h>
+#include <string>
+
+/// @cond
+namespace pugi { class xml_node; }
+/// @endcond
+
+namespace sensei
+{
+class DataAdaptor;
+
+/** A cheap, data driven predicate used to decide if an analysis should run
+ * at the current time step. The following predicates are supported:
+ *
+ * | Type | Fires when |
+ * | ---- | ---------- |
+ * | RANGE | the global range of an array is at or above an upper threshold or at or below a lower threshold |
+ * | NORM_CHANGE | the relative change of the global L2 norm of an array since the last time the trigger fired is at least the threshold |
+ * | INTERVAL | the simulation time elapsed since the last time the trigger fired is at least the interval |
+ *
+ * The RANGE predicate is evaluated from the per-block array ranges in the
+ * mesh metadata when the simulation provides them and otherwise from a
+ * single pass over the array. The NORM_CHANGE predicate makes a single pass
+ * over the array. Ghost zones are excluded. In both cases the local results
+ * are combined in a single MPI collective so that all ranks agree. The
+ * NORM_CHANGE and INTERVAL predicates always fire the first time they are
+ * evaluated.
+ *
+ * The RANGE predicate is level-triggered by default: it fires on every time
+ * step the range is outside of the thresholds, not only on the step where it
+ * crosses them. When SetOnCrossing is set it fires only on the time steps
+ * where the range goes outside of the thresholds after being inside of them
+ * on the previous evaluation, or on the first evaluation.
+ */
+class SENSEI_EXPORT Trigger
+{
+public:
+  /// the supported predicates
+  enum {RANGE, NORM_CHANGE, INTERVAL};
+
+  Trigger();
+  ~Trigger();
+
+  /** Initialize from a <trigger> XML element. The supported attributes are:
+   * name, type ("range", "norm_change", or "interval"), mesh, array,
+   * association, above, below, use_metadata, on_crossing, threshold, and
+   * interval.
+   * Returns zero if successful.
+   */
+  int Initialize(const pugi::xml_node &node);
+
+  /// set/get the name used to reference the trigger
+  void SetName(const std::string &name) { this->Name = name; }
+  const std::string &GetName() const { return this->Name; }
+
+  /// set/get the predicate. one of RANGE, NORM_CHANGE, or INTERVAL
+  void SetType(int type) { this->Type = type; }
+  int GetType() const { return this->Type; }
+
+  /// set the array the RANGE and NORM_CHANGE predicates are evaluated on
+  void SetArray(const std::string &meshName, int association,
+    const std::string &arrayName);
+
+  /** set the thresholds for the RANGE predicate. the trigger fires when the
+   * global maximum is greater than or equal to above or the global minimum
+   * is less than or equal to below.
+   */
+  void SetAbove(double above);
+  void SetBelow(double below);
+
+  /** when set the RANGE predicate is evaluated from the per-block array
+   * ranges in the mesh metadata rather than from the array. This is only
+   * cheaper when the simulation tracks the ranges. If any rank does not
+   * provide the ranges the array is used. The default is false.
+   */
+  void SetUseMetadata(bool val) { this->UseMetadata = val; }
+
+  /** when set the RANGE predicate fires only when the range crosses a
+   * threshold, rather than on every time step it is beyond one. The
+   * default is false.
+   */
+  void SetOnCrossing(bool val) { this->OnCrossing = val; }
+
+  /// set the relative change threshold for the NORM_CHANGE predicate
+  void SetThreshold(double threshold) { this->Threshold = threshold; }
+
+  /// set the simulation time interval for the INTERVAL predicate
+  void SetInterval(double interval) { this->Interval = interval; }
+
+  /** Evaluate the predicate on the current time step. This is a collective
+   * operation and the result is the same on all ranks. The state used by
+   * the NORM_CHANGE and INTERVAL predicates, and by the RANGE predicate
+   * when it fires on crossing, is updated on each call, hence this should
+   * be called once per time step. Returns zero if
+   * successful.
+   */
+  int Evaluate(MPI_Comm comm, DataAdaptor *data, bool &fire);
+
+  /// get the value the predicate was last evaluated on, for reporting
+  double GetLastValue() const { return this->LastValue; }
+
+  /// returns the name of the predicate
+  const char *GetTypeName() const;
+
+protected:
+  Trigger(const Trigger&) = delete;
+  void operator=(const Trigger&) = delete;
+
+  // compute the global range and L2 norm of the array
+  int ComputeRange(MPI_Comm comm, DataAdaptor *data, double range[2]);
+  int ComputeNorm(MPI_Comm comm, DataAdaptor *data, double &norm);
+
+private:
+  std::string Name;
+  int Type;
+  std::string MeshName;
+  std::string ArrayName;
+  int Association;
+  bool UseMetadata;
+  bool OnCrossing;
+  bool WasOutside;
+  bool HaveAbove;
+  double Above;
+  bool HaveBelow;
+  double Below;
+  double Threshold;
+  double Interval;
+  bool HaveFired;
+  double LastFiredNorm;
+  double LastFiredTime;
+  double LastValue;
+};
+
+}
+
+#endif
@@ -98,12 +98,16 @@ senseiNewMacro(VTKPosthocIO);
 
 //-----------------------------------------------------------------------------
 VTKPosthocIO::VTKPosthocIO() :
-  Frequency(1), OutputDir("./"), Mode(MODE_PARAVIEW), Writer(WRITER_VTK_XML)
+  Frequency(1), OutputDir("./"), Mode(MODE_PARAVIEW), Writer(WRITER_VTK_XML),
+  MemoryBudget(0), MemoryBudgetWarned(false),
+  Cache(new SVTKUtils::VTKObjectCache)
 {}
 
 //-----------------------------------------------------------------------------
 VTKPosthocIO::~VTKPosthocIO()
-{}
+{
+  delete this->Cache;
+}
 
 //-----------------------------------------------------------------------------
 int VTKPosthocIO::SetOutputDir(const std::string &outputDir)
@@ -313,137 +317,138 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
     if (!mmd->GlobalView)
       mmd->GlobalizeView(this->GetCommunicator());
 
-    // get the mesh
-    svtkDataObject* dobj = nullptr;
-    if (dataIn->GetMesh(meshName, mit.StructureOnly(), dobj))
+    // process one block at a time when the local data exceeds the budget
+    bool streamBlocks = false;
+    if (this->MemoryBudget > 0)
       {
-      SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
-      return false;
-      }
+      int dataRank = 0;
+      MPI_Comm_rank(dataIn->GetCommunicator(), &dataRank);
 
-    // add the ghost cell arrays to the mesh
-    if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
-      dataIn->AddGhostCellsArray(dobj, meshName))
-      {
-      SENSEI_ERROR("Failed to get ghost cells for mesh \"" << meshName << "\"")
-      return false;
-      }
+      long localBytes = 0;
+      ArrayRequirementsIterator ait =
+        this->Requirements.GetArrayRequirementsIterator(meshName);
 
-    // add the ghost node arrays to the mesh
-    if (mmd->NumGhostNodes && dataIn->AddGhostNodesArray(dobj, meshName))
-      {
-      SENSEI_ERROR("Failed to get ghost nodes for mesh \"" << meshName << "\"")
-      return false;
-      }
+      for (; ait && (localBytes >= 0); ++ait)
+        localBytes += SVTKUtils::GetLocalArraySize(dataRank, mmd,
+          ait.Association(), {ait.Array()});
 
-    // add the required arrays
-    ArrayRequirementsIterator ait =
-      this->Requirements.GetArrayRequirementsIterator(meshName);
+      streamBlocks = (localBytes < 0) || (localBytes > this->MemoryBudget);
 
-    while (ait)
-      {
-      if (dataIn->AddArray(dobj, mit.MeshName(),
-         ait.Association(), ait.Array()))
+      // blocks served from a copy of the whole mesh do not save memory
+      if (streamBlocks && !dataIn->StreamsMeshBlocks(meshName))
         {
-        SENSEI_ERROR("Failed to add "
-          << SVTKUtils::GetAttributesName(ait.Association())
-          << " data array \"" << ait.Array() << "\" to mesh \""
-          << meshName << "\"")
-        return false;
+        if ((dataRank == 0) && !this->MemoryBudgetWarned)
+          SENSEI_WARNING("The data adaptor does not stream the blocks of mesh \""
+            << meshName << "\". The memory budget is not enforced")
+        this->MemoryBudgetWarned = true;
+        streamBlocks = false;
         }
-      ++ait;
       }
 
-    // This class does not use SVTK's parallel writers because at this
-    // time those writers gather some data to rank 0 and this results
-    // in OOM crashes when run with 45k cores on Cori.
-
-    // make sure we have composite dataset if not create one
-    svtkCompositeDataSetPtr cd =
-      SVTKUtils::AsCompositeData(this->GetCommunicator(), dobj, false);
-
-    svtkCompositeDataIterator *it = cd->NewIterator();
-    it->SetSkipEmptyNodes(1);
-    it->InitTraversal();
-
-    // figure out block distribution, assume that it does not change, and
-    // that block types are homgeneous
-    if (!it->IsDoneWithTraversal() && !this->HaveBlockInfo[meshName])
+    if (streamBlocks)
       {
-      this->BlockExt[meshName] = this->Writer == VTKPosthocIO::WRITER_VTK_LEGACY ?
-        ".svtk" : getBlockExtension(it->GetCurrentDataObject());
-
-      this->HaveBlockInfo[meshName] = 1;
+      if (this->WriteBlocks(dataIn, mmd, meshName, mit.StructureOnly()))
+        {
+        SENSEI_ERROR("Failed to write the blocks of mesh \"" << meshName << "\"")
+        return false;
+        }
       }
-
-    // amr meshes indices start from 0 while multiblock starts at 1
-    long bidShift = 1;
-    if (dynamic_cast<svtkUniformGridAMR*>(cd.GetPointer()))
-      bidShift = 0;
-
-    // write the blocks
-    for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
+    else
       {
-      svtkDataSet *ds = dynamic_cast<svtkDataSet*>(it->GetCurrentDataObject());
-      if (!ds)
+      // get the mesh
+      svtkDataObject* dobj = nullptr;
+      if (dataIn->GetMesh(meshName, mit.StructureOnly(), dobj))
         {
-        // this should never happen
-        SENSEI_ERROR("Block at " << it->GetCurrentFlatIndex() << " is null")
+        SENSEI_ERROR("Failed to get mesh \"" << meshName << "\"")
         return false;
         }
 
-      // skip writing blocks that have no data
-      if (ds->GetNumberOfCells() < 1)
-        continue;
-
-      long blockId = it->GetCurrentFlatIndex() - bidShift;
-
-      if (blockId < 0)
+      // add the ghost cell arrays to the mesh
+      if ((mmd->NumGhostCells || SVTKUtils::AMR(mmd)) &&
+        dataIn->AddGhostCellsArray(dobj, meshName))
         {
-        // this should never happen
-        SENSEI_ERROR("Negative index! Dataset is " << cd->GetClassName())
+        SENSEI_ERROR("Failed to get ghost cells for mesh \"" << meshName << "\"")
         return false;
         }
 
-      std::string fileName =
-        getBlockFileName(this->OutputDir, meshName, blockId,
-          this->FileId[meshName], this->BlockExt[meshName]);
-
-
-      // convert from SVTK to VTK
-      vtkDataSet *vds = SVTKUtils::VTKObjectFactory::New(ds);
-
-      vtkDataArray *ga = vds->GetCellData()->GetArray("vtkGhostType");
-      if (ga)
+      // add the ghost node arrays to the mesh
+      if (mmd->NumGhostNodes && dataIn->AddGhostNodesArray(dobj, meshName))
         {
-        ga->SetName(this->GetGhostArrayName().c_str());
-        vds->UpdateCellGhostArrayCache();
+        SENSEI_ERROR("Failed to get ghost nodes for mesh \"" << meshName << "\"")
+        return false;
         }
 
-      if (this->Writer == VTKPosthocIO::WRITER_VTK_LEGACY)
+      // add the required arrays
+      ArrayRequirementsIterator ait =
+        this->Requirements.GetArrayRequirementsIterator(meshName);
+
+      while (ait)
         {
-        vtkDataSetWriter *writer = vtkDataSetWriter::New();
-        writer->SetInputData(vds);
-        writer->SetFileName(fileName.c_str());
-        writer->SetFileTypeToBinary();
-        writer->Write();
-        writer->Delete();
+        if (dataIn->AddArray(dobj, mit.MeshName(),
+           ait.Association(), ait.Array()))
+          {
+          SENSEI_ERROR("Failed to add "
+            << SVTKUtils::GetAttributesName(ait.Association())
+            << " data array \"" << ait.Array() << "\" to mesh \""
+            << meshName << "\"")
+          return false;
+          }
+        ++ait;
         }
-      else
+
+      // This class does not use SVTK's parallel writers because at this
+      // time those writers gather some data to rank 0 and this results
+      // in OOM crashes when run with 45k cores on Cori.
+
+      // make sure we have composite dataset if not create one
+      svtkCompositeDataSetPtr cd =
+        SVTKUtils::AsCompositeData(this->GetCommunicator(), dobj, false);
+
+      svtkCompositeDataIterator *it = cd->NewIterator();
+      it->SetSkipEmptyNodes(1);
+
+      // amr meshes indices start from 0 while multiblock starts at 1
+      long bidShift = 1;
+      if (dynamic_cast<svtkUniformGridAMR*>(cd.GetPointer()))
+        bidShift = 0;
+
+      // write the blocks
+      for (it->InitTraversal(); !it->IsDoneWithTraversal(); it->GoToNextItem())
         {
-        vtkXMLDataSetWriter *writer = vtkXMLDataSetWriter::New();
-        writer->SetInputData(vds);
-        writer->SetDataModeToAppended();
-        writer->EncodeAppendedDataOff();
-        writer->SetCompressorTypeToNone();
-        writer->SetFileName(fileName.c_str());
-        writer->Write();
-        writer->Delete();
+        svtkDataSet *ds = dynamic_cast<svtkDataSet*>(it->GetCurrentDataObject());
+        if (!ds)
+          {
+          // this should never happen
+          SENSEI_ERROR("Block at " << it->GetCurrentFlatIndex() << " is null")
+          it->Delete();
+          dobj->Delete();
+          return false;
+          }
+
+        long blockId = it->GetCurrentFlatIndex() - bidShift;
+
+        if (blockId < 0)
+          {
+          // this should never happen
+          SENSEI_ERROR("Negative index! Dataset is " << cd->GetClassName())
+          it->Delete();
+          dobj->Delete();
+          return false;
+          }
+
+        if (this->WriteBlock(meshName, blockId, ds, true))
+          {
+          SENSEI_ERROR("Failed to write block " << blockId << " of mesh \""
+            << meshName << "\"")
+          it->Delete();
+          dobj->Delete();
+          return false;
+          }
         }
+      it->Delete();
 
-      vds->Delete();
+      dobj->Delete();
       }
-    it->Delete();
 
     // we count empty steps
     NameMap<long>::iterator fidIt = this->FileId.find(meshName);
@@ -467,16 +472,163 @@ bool VTKPosthocIO::Execute(DataAdaptor* dataIn, DataAdaptor** dataOut)
       this->Metadata[meshName].push_back(mmd);
       }
 
-    dobj->Delete();
-
     ++mit;
     }
 
   dataIn->ReleaseData();
 
+  // release the conversions of meshes and arrays that were not written this
+  // time step
+  this->Cache->ReleaseUnused();
+
   return true;
 }
 
+//-----------------------------------------------------------------------------
+int VTKPosthocIO::WriteBlocks(DataAdaptor *dataIn, const MeshMetadataPtr &mmd,
+  const std::string &meshName, bool structureOnly)
+{
+  int rank = 0;
+  MPI_Comm_rank(dataIn->GetCommunicator(), &rank);
+
+  std::vector<long> blockIds;
+  if (SVTKUtils::GetLocalBlockIds(rank, mmd, blockIds))
+    return -1;
+
+  // the blocks fetched so far are released on every return
+  MeshBlocksGuard guard(dataIn);
+
+  bool ghostCells = mmd->NumGhostCells || SVTKUtils::AMR(mmd);
+  bool ghostNodes = mmd->NumGhostNodes;
+
+  size_t nBlocks = blockIds.size();
+  for (size_t i = 0; i < nBlocks; ++i)
+    {
+    long bid = blockIds[i];
+
+    svtkDataObject *block = nullptr;
+    if (dataIn->GetMeshBlock(meshName, bid, structureOnly, block) ||
+      (ghostCells && dataIn->AddGhostCellsArrayToBlock(block, meshName, bid)) ||
+      (ghostNodes && dataIn->AddGhostNodesArrayToBlock(block, meshName, bid)))
+      {
+      SENSEI_ERROR("Failed to get block " << bid << " of mesh \""
+        << meshName << "\"")
+      if (block)
+        block->Delete();
+      return -1;
+      }
+
+    // add the required arrays
+    ArrayRequirementsIterator ait =
+      this->Requirements.GetArrayRequirementsIterator(meshName);
+
+    for (; ait; ++ait)
+      {
+      if (dataIn->AddArrayToBlock(block, meshName, bid,
+         ait.Association(), ait.Array()))
+        {
+        SENSEI_ERROR("Failed to add "
+          << SVTKUtils::GetAttributesName(ait.Association())
+          << " data array \"" << ait.Array() << "\" to block " << bid
+          << " of mesh \"" << meshName << "\"")
+        block->Delete();
+        return -1;
+        }
+      }
+
+    svtkDataSet *ds = dynamic_cast<svtkDataSet*>(block);
+    if (!ds)
+      {
+      SENSEI_ERROR("Block " << bid << " of mesh \"" << meshName
+        << "\" is not a dataset")
+      block->Delete();
+      return -1;
+      }
+
+    if (this->WriteBlock(meshName, bid, ds))
+      {
+      SENSEI_ERROR("Failed to write block " << bid << " of mesh \""
+        << meshName << "\"")
+      block->Delete();
+      return -1;
+      }
+
+    block->Delete();
+    }
+
+  return 0;
+}
+
+//-----------------------------------------------------------------------------
+int VTKPosthocIO::WriteBlock(const std::string &meshName, long blockId,
+  svtkDataSet *ds, bool cache)
+{
+  // figure out block distribution, assume that it does not change, and
+  // that block types are homgeneous
+  if (!this->HaveBlockInfo[meshName])
+    {
+    this->BlockExt[meshName] = this->Writer == VTKPosthocIO::WRITER_VTK_LEGACY ?
+      ".svtk" : getBlockExtension(ds);
+
+    this->HaveBlockInfo[meshName] = 1;
+    }
+
+  // skip writing blocks that have no data
+  if (ds->GetNumberOfCells() < 1)
+    return 0;
+
+  std::string fileName =
+    getBlockFileName(this->OutputDir, meshName, blockId,
+      this->FileId[meshName], this->BlockExt[meshName]);
+
+  // convert from SVTK to VTK. blocks that are streamed are not cached since
+  // the cache would hold them all in memory
+  vtkDataSet *vds = SVTKUtils::VTKObjectFactory::New(ds,
+    cache ? this->Cache : nullptr);
+  if (!vds)
+    {
+    SENSEI_ERROR("Failed to convert block " << blockId << " of mesh \""
+      << meshName << "\" to VTK")
+    return -1;
+    }
+
+  vtkDataArray *ga = vds->GetCellData()->GetArray("vtkGhostType");
+  if (ga)
+    {
+    ga->SetName(this->GetGhostArrayName().c_str());
+    vds->UpdateCellGhostArrayCache();
+    }
+
+  int status = 0;
+  if (this->Writer == VTKPosthocIO::WRITER_VTK_LEGACY)
+    {
+    vtkDataSetWriter *writer = vtkDataSetWriter::New();
+    writer->SetInputData(vds);
+    writer->SetFileName(fileName.c_str());
+    writer->SetFileTypeToBinary();
+    status = writer->Write() ? 0 : -1;
+    writer->Delete();
+    }
+  else
+    {
+    vtkXMLDataSetWriter *writer = vtkXMLDataSetWriter::New();
+    writer->SetInputData(vds);
+    writer->SetDataModeToAppended();
+    writer->EncodeAppendedDataOff();
+    writer->SetCompressorTypeToNone();
+    writer->SetFileName(fileName.c_str());
+    status = writer->Write() ? 0 : -1;
+    writer->Delete();
+    }
+
+  vds->Delete();
+
+  if (status)
+    SENSEI_ERROR("Failed to write \"" << fileName << "\"")
+
+  return status;
+}
+
 //-----------------------------------------------------------------------------
 int VTKPosthocIO::Finalize()
 {
@@ -11,9 +11,12 @@
 #include <vector>
 #include <string>
 
+class svtkDataSet;
 
 namespace sensei
 {
+namespace SVTKUtils { class VTKObjectCache; }
+
 class VTKPosthocIO;
 using VTKPosthocIOPtr = svtkSmartPointer<VTKPosthocIO>;
 
@@ -91,6 +94,15 @@ public:
   /// Controls how many calls to Execute do nothing between actual I/O
   int SetFrequency(unsigned int frequency);
 
+  /** Set the number of bytes of simulation data that may be held at once.
+   * When the local data is estimated to exceed the budget the blocks are
+   * fetched and written one at a time using the DataAdaptor's
+   * block-at-a-time API. The budget is not enforced when the DataAdaptor
+   * does not stream the blocks, see DataAdaptor::StreamsMeshBlocks. The
+   * default of 0 disables the budget.
+   */
+  void SetMemoryBudget(long bytes) { this->MemoryBudget = bytes; }
+
   /// @}
 
   bool Execute(DataAdaptor* data, DataAdaptor**) override;
@@ -104,6 +116,15 @@ protected:
   VTKPosthocIO(const VTKPosthocIO&) = delete;
   void operator=(const VTKPosthocIO&) = delete;
 
+  // fetch and write the local blocks of the mesh one at a time
+  int WriteBlocks(DataAdaptor *dataIn, const MeshMetadataPtr &mmd,
+    const std::string &meshName, bool structureOnly);
+
+  // write a single block. when cache is set the conversion to VTK reuses
+  // the points, cells, and arrays of the previous time step
+  int WriteBlock(const std::string &meshName, long blockId, svtkDataSet *ds,
+    bool cache = false);
+
 private:
 #if !defined(SWIG)
   unsigned int Frequency;
@@ -112,6 +133,9 @@ private:
   int Mode;
   int Writer;
   std::string GhostArrayName;
+  long MemoryBudget;
+  bool MemoryBudgetWarned;
+  SVTKUtils::VTKObjectCache *Cache;
 
   template<typename T>
   using NameMap = std::map<std::string, T>;
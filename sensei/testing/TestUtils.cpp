@@ -0,0 +1,42 @@
+#include "TestUtils.h"
+
+#include <svtkDataObject.h>
+#include <svtkMultiBlockDataSet.h>
+
+#include <sstream>
+
+namespace sensei
+{
+namespace TestUtils
+{
+
+// --------------------------------------------------------------------------
+svtkMultiBlockDataSet *NewTwoBlocksPerRank(int rank, int nRanks,
+  const BlockFactory &newBlock)
+{
+  svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+  mb->SetNumberOfBlocks(2*nRanks);
+
+  for (int b = 2*rank; b < 2*rank + 2; ++b)
+    {
+    svtkDataObject *dobj = newBlock(b);
+    mb->SetBlock(b, dobj);
+    dobj->Delete();
+    }
+
+  return mb;
+}
+
+// --------------------------------------------------------------------------
+std::vector<std::string> Split(const std::string &line)
+{
+  std::vector<std::string> cols;
+  std::istringstream lss(line);
+  std::string col;
+  while (std::getline(lss, col, ','))
+    cols.push_back(col);
+  return cols;
+}
+
+}
+}
@@ -0,0 +1,37 @@
+#ifndef sensei_TestUtils_h
+#define sensei_TestUtils_h
+
+/// @file
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class svtkDataObject;
+class svtkMultiBlockDataSet;
+
+namespace sensei
+{
+/// Helpers shared by the tests
+namespace TestUtils
+{
+
+/** Makes the block with the given global index. The caller takes ownership
+ * of the returned block.
+ */
+using BlockFactory = std::function<svtkDataObject*(int block)>;
+
+/** Makes a multiblock of 2*nRanks blocks in which this rank holds the
+ * blocks 2*rank and 2*rank + 1, made by newBlock. The other blocks are
+ * empty. The caller takes ownership of the returned multiblock.
+ */
+svtkMultiBlockDataSet *NewTwoBlocksPerRank(int rank, int nRanks,
+  const BlockFactory &newBlock);
+
+/// Splits a line of CSV at the commas. Spaces are kept.
+std::vector<std::string> Split(const std::string &line);
+
+}
+}
+
+#endif
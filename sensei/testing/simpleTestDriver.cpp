@@ -71,7 +71,7 @@ int getMeshMetadata(unsigned int i, sensei::MeshMetadataPtr &mdp)
   mdp->BlockIds = {0};
   mdp->BlockOwner = {rank};
   mdp->BlockBounds = {{0.0, 1.0, 0.0, 1.0, double(rank), double(rank+1)}};
-  mdp->BlockExtents = {{0, gnx, 0, gny, rank, rank+1}};
+  mdp->BlockExtents = {{0, gnx-1, 0, gny-1, rank, rank}};
   mdp->BlockNumCells = {gnx*gny};
   mdp->BlockNumPoints = {2*gnx*gny};
 
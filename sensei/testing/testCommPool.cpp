@@ -0,0 +1,143 @@
+#include <iostream>
+#include <mpi.h>
+#include "Error.h"
+#include "MPIUtils.h"
+#include "SVTKDataAdaptor.h"
+#include "Histogram.h"
+
+// check that comm is a duplicate of parent
+bool isDuplicate(MPI_Comm comm, MPI_Comm parent)
+{
+  if ((comm == MPI_COMM_NULL) || (comm == parent))
+    return false;
+
+  int result = MPI_UNEQUAL;
+  MPI_Comm_compare(comm, parent, &result);
+  return result == MPI_CONGRUENT;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  int status = 0;
+
+  // adaptors of the same class using the default communicator share one
+  // duplicate of world, adaptors of other classes get their own
+  sensei::SVTKDataAdaptor *da = sensei::SVTKDataAdaptor::New();
+  sensei::Histogram *ha = sensei::Histogram::New();
+
+  MPI_Comm world = da->GetCommunicator();
+  MPI_Comm histWorld = ha->GetCommunicator();
+  if (!isDuplicate(world, MPI_COMM_WORLD) ||
+    !isDuplicate(histWorld, MPI_COMM_WORLD) || (histWorld == world))
+    {
+    SENSEI_ERROR("The default communicator is shared across classes")
+    status = -1;
+    }
+
+  // setting a pooled communicator shares it within the class
+  sensei::SVTKDataAdaptor *da2 = sensei::SVTKDataAdaptor::New();
+  da2->SetCommunicator(world);
+  if (da2->GetCommunicator() != world)
+    {
+    SENSEI_ERROR("A pooled communicator was duplicated")
+    status = -1;
+    }
+
+  // and gives the class's duplicate of its parent to other classes
+  sensei::Histogram *ha2 = sensei::Histogram::New();
+  ha2->SetCommunicator(world);
+  if (ha2->GetCommunicator() != histWorld)
+    {
+    SENSEI_ERROR("A pooled communicator was shared across classes")
+    status = -1;
+    }
+  ha2->Delete();
+
+  // callers with distinct tags get distinct duplicates
+  MPI_Comm tagged = sensei::MPIUtils::AcquireCommunicator(MPI_COMM_WORLD, "test");
+  if (!isDuplicate(tagged, MPI_COMM_WORLD) || (tagged == world) ||
+    (tagged == histWorld))
+    {
+    SENSEI_ERROR("The tagged duplicate is shared")
+    status = -1;
+    }
+  sensei::MPIUtils::ReleaseCommunicator(tagged);
+
+  // the duplicate survives until the last reference is released
+  da->Delete();
+  ha->Delete();
+
+  int size = 0;
+  MPI_Comm_size(da2->GetCommunicator(), &size);
+  int worldSize = 0;
+  MPI_Comm_size(MPI_COMM_WORLD, &worldSize);
+  if (size != worldSize)
+    {
+    SENSEI_ERROR("The shared communicator was freed")
+    status = -1;
+    }
+
+  // other communicators get their own duplicate, shared in the same way
+  MPI_Comm split = MPI_COMM_NULL;
+  MPI_Comm_split(MPI_COMM_WORLD, rank % 2, rank, &split);
+
+  da2->SetCommunicator(split);
+  ha = sensei::Histogram::New();
+  ha->SetCommunicator(split);
+
+  sensei::SVTKDataAdaptor *da3 = sensei::SVTKDataAdaptor::New();
+  da3->SetCommunicator(split);
+
+  MPI_Comm splitDup = da2->GetCommunicator();
+  if (!isDuplicate(splitDup, split) || (da3->GetCommunicator() != splitDup) ||
+    !isDuplicate(ha->GetCommunicator(), split) || (splitDup == world))
+    {
+    SENSEI_ERROR("The split communicator is not shared")
+    status = -1;
+    }
+
+  da3->Delete();
+
+  // communication on the shared duplicate does not interfere with the parent
+  int sum = 0;
+  MPI_Allreduce(&rank, &sum, 1, MPI_INT, MPI_SUM, ha->GetCommunicator());
+
+  ha->Delete();
+  da2->Delete();
+
+  // once released a new duplicate is made
+  MPI_Comm dup = sensei::MPIUtils::AcquireCommunicator(split);
+  if (!isDuplicate(dup, split))
+    {
+    SENSEI_ERROR("Failed to duplicate the split communicator")
+    status = -1;
+    }
+  sensei::MPIUtils::ReleaseCommunicator(dup);
+
+  // the parent may be freed before the duplicate
+  dup = sensei::MPIUtils::AcquireCommunicator(split);
+  MPI_Comm_free(&split);
+  MPI_Barrier(dup);
+  sensei::MPIUtils::ReleaseCommunicator(dup);
+
+  if (dup != MPI_COMM_NULL)
+    {
+    SENSEI_ERROR("The released communicator was not reset")
+    status = -1;
+    }
+
+  int globalStatus = 0;
+  MPI_Allreduce(&status, &globalStatus, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+  if ((rank == 0) && !globalStatus)
+    std::cerr << "Communicator pool passed" << std::endl;
+
+  MPI_Finalize();
+
+  return globalStatus ? -1 : 0;
+}
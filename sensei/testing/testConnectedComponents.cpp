@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <svtkCellData.h>
+#include <svtkDataObject.h>
+#include <svtkDataSetAttributes.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkUnsignedCharArray.h>
+#include "ConnectedComponents.h"
+#include "Error.h"
+#include "SVTKDataAdaptor.h"
+#include "TestUtils.h"
+
+// the number of cells in each direction of the global mesh
+const int gN[3] = {24, 20, 16};
+
+// the features, boxes of cells or points [i0,i1, j0,j1, k0,k1]. the
+// second and third boxes are the arms of a U joined by the fourth at the
+// top, so they are connected only through the slab holding the top. the
+// last two touch only along an edge and are separate features.
+const int gBoxes[6][6] = {{2,5, 2,17, 1,14},
+  {10,12, 3,5, 1,14}, {16,18, 3,5, 1,14}, {13,15, 3,5, 14,14},
+  {20,20, 15,15, 8,8}, {21,21, 16,16, 8,8}};
+
+// the expected sizes of the features when there is no decomposition
+const long gSizes[4] = {896, 261, 1, 1};
+
+double field(int i, int j, int k)
+{
+  for (int b = 0; b < 6; ++b)
+    {
+    const int *box = gBoxes[b];
+    if ((i >= box[0]) && (i <= box[1]) && (j >= box[2]) &&
+      (j <= box[3]) && (k >= box[4]) && (k <= box[5]))
+      return 1.0 + 0.01*i + 0.001*k;
+    }
+  return 0.0;
+}
+
+// an image holding elements in the given extent. nGhost layers of ghost
+// cells are added within the whole mesh.
+svtkImageData *newImage(const std::array<int,6> &ownExt, bool cellData,
+  int nGhost)
+{
+  std::array<int,6> ext = ownExt;
+  for (int d = 0; d < 3; ++d)
+    {
+    int nMax = cellData ? gN[d] - 1 : gN[d];
+    ext[2*d] = std::max(0, ext[2*d] - nGhost);
+    ext[2*d+1] = std::min(nMax, ext[2*d+1] + nGhost);
+    }
+
+  svtkImageData *im = svtkImageData::New();
+  im->SetOrigin(0.0, 0.0, 0.0);
+  im->SetSpacing(0.5, 0.25, 0.125);
+  im->SetExtent(ext[0], ext[1] + (cellData ? 1 : 0), ext[2],
+    ext[3] + (cellData ? 1 : 0), ext[4], ext[5] + (cellData ? 1 : 0));
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetName("data");
+
+  svtkDoubleArray *ones = svtkDoubleArray::New();
+  ones->SetName("ones");
+  ones->SetNumberOfComponents(2);
+
+  svtkUnsignedCharArray *ga = svtkUnsignedCharArray::New();
+  ga->SetName("svtkGhostType");
+
+  for (int k = ext[4]; k <= ext[5]; ++k)
+    {
+    for (int j = ext[2]; j <= ext[3]; ++j)
+      {
+      for (int i = ext[0]; i <= ext[1]; ++i)
+        {
+        da->InsertNextValue(field(i, j, k));
+
+        double one[2] = {1.0, 2.0};
+        ones->InsertNextTypedTuple(one);
+
+        bool ghost = (i < ownExt[0]) || (i > ownExt[1]) || (j < ownExt[2]) ||
+          (j > ownExt[3]) || (k < ownExt[4]) || (k > ownExt[5]);
+        ga->InsertNextValue(ghost ? svtkDataSetAttributes::DUPLICATECELL : 0);
+        }
+      }
+    }
+
+  svtkDataSetAttributes *atts = cellData ?
+    static_cast<svtkDataSetAttributes*>(im->GetCellData()) :
+    static_cast<svtkDataSetAttributes*>(im->GetPointData());
+
+  atts->AddArray(da);
+  atts->AddArray(ones);
+
+  if (nGhost)
+    atts->AddArray(ga);
+
+  da->Delete();
+  ones->Delete();
+  ga->Delete();
+
+  return im;
+}
+
+// a multiblock with two blocks per rank. the mesh is split into slabs along
+// z, one per rank, and each slab is split in two along x. when decompose
+// is false all of the mesh is placed in one block.
+svtkMultiBlockDataSet *newMesh(int rank, int nRanks, bool decompose,
+  bool cellData, int nGhost)
+{
+  int n[3];
+  for (int d = 0; d < 3; ++d)
+    n[d] = cellData ? gN[d] : gN[d] + 1;
+
+  if (!decompose)
+    {
+    svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+    mb->SetNumberOfBlocks(1);
+    svtkImageData *im = newImage({{0, n[0] - 1, 0, n[1] - 1, 0, n[2] - 1}},
+      cellData, 0);
+    mb->SetBlock(0, im);
+    im->Delete();
+    return mb;
+    }
+
+  // points where blocks meet are held by both of them
+  int overlap = cellData ? 0 : 1;
+
+  int k0 = rank*n[2]/nRanks;
+  int k1 = (rank + 1)*n[2]/nRanks - 1 + overlap;
+  k1 = std::min(k1, n[2] - 1);
+
+  int iMid = n[0]/2;
+
+  return sensei::TestUtils::NewTwoBlocksPerRank(rank, nRanks,
+    [&](int b) -> svtkDataObject*
+    {
+    if (b % 2)
+      return newImage({{iMid, n[0] - 1, 0, n[1] - 1, k0, k1}},
+        cellData, nGhost);
+
+    return newImage({{0, iMid - 1 + overlap, 0, n[1] - 1, k0, k1}},
+      cellData, nGhost);
+    });
+}
+
+int findFeatures(MPI_Comm comm, svtkMultiBlockDataSet *mb, bool cellData,
+  const std::string &fileName, std::vector<sensei::ConnectedComponents::Feature> &features)
+{
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetCommunicator(comm);
+  dataAdaptor->SetDataObject("mesh", mb);
+  dataAdaptor->SetDataTimeStep(0);
+  dataAdaptor->SetDataTime(0.0);
+
+  sensei::ConnectedComponents *cc = sensei::ConnectedComponents::New();
+  cc->SetCommunicator(comm);
+  cc->SetMeshName("mesh");
+  cc->SetArrayName("data");
+  cc->SetIntegratedArrays({"ones"});
+  cc->SetAssociation(cellData ? svtkDataObject::CELL : svtkDataObject::POINT);
+  cc->SetThreshold(0.5, 2.0);
+  cc->SetNumberOfThreads(2);
+  cc->SetFileName(fileName);
+
+  int status = cc->Execute(dataAdaptor, nullptr) ? 0 : -1;
+
+  cc->GetFeatures(features);
+  cc->Finalize();
+  cc->Delete();
+
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+
+  return status;
+}
+
+bool equal(double a, double b)
+{
+  return std::abs(a - b) <= 1e-9*std::max(1.0, std::abs(a));
+}
+
+int compare(const char *label,
+  const std::vector<sensei::ConnectedComponents::Feature> &par,
+  const std::vector<sensei::ConnectedComponents::Feature> &ref)
+{
+  if (par.size() != ref.size())
+    {
+    SENSEI_ERROR(<< label << " found " << par.size() << " features, expected "
+      << ref.size())
+    return -1;
+    }
+
+  for (size_t i = 0; i < par.size(); ++i)
+    {
+    const sensei::ConnectedComponents::Feature &p = par[i];
+    const sensei::ConnectedComponents::Feature &r = ref[i];
+
+    bool same = (p.Id == r.Id) && (p.Size == r.Size) &&
+      equal(p.Volume, r.Volume) && equal(p.Min, r.Min) &&
+      equal(p.Max, r.Max) && (p.Integrals.size() == r.Integrals.size());
+
+    for (int d = 0; d < 3; ++d)
+      same = same && equal(p.Centroid[d], r.Centroid[d]);
+
+    for (int d = 0; d < 6; ++d)
+      same = same && equal(p.Bounds[d], r.Bounds[d]);
+
+    for (size_t c = 0; same && (c < p.Integrals.size()); ++c)
+      same = equal(p.Integrals[c], r.Integrals[c]);
+
+    if (!same)
+      {
+      SENSEI_ERROR(<< label << " feature " << i << " of size " << p.Size
+        << " volume " << p.Volume << " differs from the serial result of size "
+        << r.Size << " volume " << r.Volume)
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int status = 0;
+
+  std::string refFile = "testConnectedComponents_" + std::to_string(rank) + ".csv";
+  std::string parFile = "testConnectedComponents.csv";
+
+  const char *labels[3] = {"cells", "cells with ghosts", "points"};
+  const bool cellData[3] = {true, true, false};
+  const int nGhost[3] = {0, 1, 0};
+
+  for (int t = 0; t < 3; ++t)
+    {
+    // the reference, computed by each rank on the whole mesh
+    std::vector<sensei::ConnectedComponents::Feature> ref;
+    svtkMultiBlockDataSet *whole = newMesh(0, 1, false, cellData[t], 0);
+    status |= findFeatures(MPI_COMM_SELF, whole, cellData[t], refFile, ref);
+    whole->Delete();
+
+    std::vector<sensei::ConnectedComponents::Feature> par;
+    svtkMultiBlockDataSet *mb = newMesh(rank, nRanks, true, cellData[t], nGhost[t]);
+    status |= findFeatures(MPI_COMM_WORLD, mb, cellData[t], parFile, par);
+    mb->Delete();
+
+    if (rank == 0)
+      {
+      status |= compare(labels[t], par, ref);
+
+      // the sizes are known for cells
+      if (cellData[t])
+        {
+        for (size_t i = 0; i < 4; ++i)
+          {
+          if ((ref.size() != 4) || (ref[i].Size != gSizes[i]) ||
+            !equal(ref[i].Volume, ref[i].Size*0.5*0.25*0.125) ||
+            !equal(ref[i].Integrals[1], ref[i].Volume) ||
+            !equal(ref[i].Integrals[2], 2.0*ref[i].Volume))
+            {
+            SENSEI_ERROR(<< labels[t] << " feature " << i << " is wrong")
+            status = -1;
+            break;
+            }
+          }
+        }
+      }
+    }
+
+  remove(refFile.c_str());
+
+  if (rank == 0)
+    remove(parFile.c_str());
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
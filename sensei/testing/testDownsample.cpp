@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <svtkCellData.h>
+#include <svtkDataArray.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkRectilinearGrid.h>
+#include <svtkUnsignedCharArray.h>
+#include "Downsample.h"
+#include "Error.h"
+#include "SVTKDataAdaptor.h"
+#include "SVTKUtils.h"
+#include "TestUtils.h"
+
+// the global cell extent, none of the dimensions is a multiple of the factor
+const std::array<int,6> gExt = {0, 10, 0, 8, 0, 5};
+
+// the factor and the number of ghost layers needed for an exact box filter
+const int gFactor[3] = {3, 2, 2};
+const int gGhosts = 2;
+
+// the value of the cell or point (i,j,k), and a second component
+double value(int i, int j, int k, int c)
+{
+  double v = i + 100.0*j + 10000.0*k;
+  return c ? -v : v;
+}
+
+// the coordinate of a point of the rectilinear grid
+double coord(int i, int axis)
+{
+  return 0.5*i + 0.01*i*i + axis;
+}
+
+svtkDoubleArray *newArray(const char *name, const std::array<int,6> &ext)
+{
+  long nx = ext[1] - ext[0] + 1;
+  long ny = ext[3] - ext[2] + 1;
+  long nz = ext[5] - ext[4] + 1;
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetName(name);
+  da->SetNumberOfComponents(2);
+  da->SetNumberOfTuples(nx*ny*nz);
+
+  long q = 0;
+  for (int k = ext[4]; k <= ext[5]; ++k)
+    for (int j = ext[2]; j <= ext[3]; ++j)
+      for (int i = ext[0]; i <= ext[1]; ++i, ++q)
+        for (int c = 0; c < 2; ++c)
+          da->SetTypedComponent(q, c, value(i, j, k, c));
+
+  return da;
+}
+
+// a block of the global extent split along x into nBlocks slabs, with ghost
+// cells
+svtkDataSet *newBlock(int block, int nBlocks, bool rectilinear)
+{
+  int nx = gExt[1] - gExt[0] + 1;
+
+  std::array<int,6> owned = gExt;
+  owned[0] = gExt[0] + block*nx/nBlocks;
+  owned[1] = gExt[0] + (block + 1)*nx/nBlocks - 1;
+
+  std::array<int,6> ext = owned;
+  for (int i = 0; i < 3; ++i)
+    {
+    ext[2*i] = std::max(gExt[2*i], owned[2*i] - gGhosts);
+    ext[2*i+1] = std::min(gExt[2*i+1], owned[2*i+1] + gGhosts);
+    }
+
+  std::array<int,6> pext = ext;
+  for (int i = 0; i < 3; ++i)
+    pext[2*i+1] += 1;
+
+  svtkDataSet *ds = nullptr;
+  if (rectilinear)
+    {
+    svtkRectilinearGrid *rg = svtkRectilinearGrid::New();
+    rg->SetExtent(pext.data());
+
+    svtkDoubleArray *x[3];
+    for (int i = 0; i < 3; ++i)
+      {
+      x[i] = svtkDoubleArray::New();
+      for (int p = pext[2*i]; p <= pext[2*i+1]; ++p)
+        x[i]->InsertNextValue(coord(p, i));
+      }
+
+    rg->SetXCoordinates(x[0]);
+    rg->SetYCoordinates(x[1]);
+    rg->SetZCoordinates(x[2]);
+
+    for (int i = 0; i < 3; ++i)
+      x[i]->Delete();
+
+    ds = rg;
+    }
+  else
+    {
+    svtkImageData *im = svtkImageData::New();
+    im->SetOrigin(0.5, 1.0, 2.0);
+    im->SetSpacing(0.1, 0.2, 0.3);
+    im->SetExtent(pext.data());
+    ds = im;
+    }
+
+  svtkDoubleArray *da = newArray("data", ext);
+  ds->GetCellData()->AddArray(da);
+  da->Delete();
+
+  svtkDoubleArray *pda = newArray("pdata", pext);
+  ds->GetPointData()->AddArray(pda);
+  pda->Delete();
+
+  svtkUnsignedCharArray *ghosts = sensei::SVTKUtils::NewGhostCellsArray(ext, owned);
+  ds->GetCellData()->AddArray(ghosts);
+  ghosts->Delete();
+
+  return ds;
+}
+
+// a multiblock with two blocks per rank
+svtkMultiBlockDataSet *newMesh(int rank, int nRanks, bool rectilinear)
+{
+  svtkMultiBlockDataSet *mb = sensei::TestUtils::NewTwoBlocksPerRank(rank,
+    nRanks, [&](int b) -> svtkDataObject*
+    { return newBlock(b, 2*nRanks, rectilinear); });
+
+  sensei::SVTKUtils::SetGhostLayerMetadata(mb, gGhosts, 0);
+
+  return mb;
+}
+
+// the value of coarse cell (I,J,K) computed on a single block without ghosts
+double coarseValue(int I, int J, int K, int c, int mode)
+{
+  if (mode == sensei::Downsample::MODE_STRIDE)
+    return value(I*gFactor[0], J*gFactor[1], K*gFactor[2], c);
+
+  double sum = 0.0;
+  for (int k = K*gFactor[2]; k < (K + 1)*gFactor[2]; ++k)
+    for (int j = J*gFactor[1]; j < (J + 1)*gFactor[1]; ++j)
+      for (int i = I*gFactor[0]; i < (I + 1)*gFactor[0]; ++i)
+        sum += value(i, j, k, c);
+
+  return sum / (gFactor[0]*gFactor[1]*gFactor[2]);
+}
+
+// check the coarse blocks against the single block reference
+int validate(const char *label, sensei::DataAdaptor *dataOut, int mode,
+  bool rectilinear, long &nCells)
+{
+  svtkDataObject *dobj = nullptr;
+  if (dataOut->GetMesh("mesh", false, dobj) ||
+    dataOut->AddArray(dobj, "mesh", svtkDataObject::CELL, "data") ||
+    dataOut->AddArray(dobj, "mesh", svtkDataObject::POINT, "pdata"))
+    {
+    SENSEI_ERROR(<< label << " has no mesh")
+    return -1;
+    }
+
+  std::vector<svtkDataSet*> blocks;
+  sensei::SVTKUtils::GetLeaves(dobj, blocks);
+
+  int status = 0;
+  nCells = 0;
+  for (size_t b = 0; (b < blocks.size()) && !status; ++b)
+    {
+    svtkDataSet *ds = blocks[b];
+
+    if (ds->GetCellData()->GetArray("svtkGhostType"))
+      {
+      SENSEI_ERROR(<< label << " block " << b << " has ghost cells")
+      status = -1;
+      }
+
+    std::array<int,6> pext;
+    if (rectilinear)
+      static_cast<svtkRectilinearGrid*>(ds)->GetExtent(pext.data());
+    else
+      static_cast<svtkImageData*>(ds)->GetExtent(pext.data());
+
+    // the cells
+    svtkDataArray *da = ds->GetCellData()->GetArray("data");
+    long q = 0;
+    for (int K = pext[4]; K < pext[5]; ++K)
+      for (int J = pext[2]; J < pext[3]; ++J)
+        for (int I = pext[0]; I < pext[1]; ++I, ++q)
+          for (int c = 0; c < 2; ++c)
+            {
+            double expected = coarseValue(I, J, K, c, mode);
+            double actual = da->GetComponent(q, c);
+            if (std::abs(actual - expected) > 1.0e-9*std::abs(expected))
+              {
+              SENSEI_ERROR(<< label << " cell " << I << ", " << J << ", " << K
+                << " component " << c << " is " << actual << " expected " << expected)
+              status = -1;
+              }
+            }
+
+    nCells += q;
+
+    // the points are sampled, and coincide with fine points
+    svtkDataArray *pda = ds->GetPointData()->GetArray("pdata");
+    q = 0;
+    for (int K = pext[4]; K <= pext[5]; ++K)
+      for (int J = pext[2]; J <= pext[3]; ++J)
+        for (int I = pext[0]; I <= pext[1]; ++I, ++q)
+          {
+          int i = I*gFactor[0];
+          int j = J*gFactor[1];
+          int k = K*gFactor[2];
+
+          double x[3];
+          ds->GetPoint(q, x);
+
+          double expectedX[3] = {0.5 + 0.1*i, 1.0 + 0.2*j, 2.0 + 0.3*k};
+          if (rectilinear)
+            {
+            expectedX[0] = coord(i, 0);
+            expectedX[1] = coord(j, 1);
+            expectedX[2] = coord(k, 2);
+            }
+
+          if ((pda->GetComponent(q, 0) != value(i, j, k, 0)) ||
+            (std::abs(x[0] - expectedX[0]) > 1.0e-9) ||
+            (std::abs(x[1] - expectedX[1]) > 1.0e-9) ||
+            (std::abs(x[2] - expectedX[2]) > 1.0e-9))
+            {
+            SENSEI_ERROR(<< label << " point " << I << ", " << J << ", " << K
+              << " is " << pda->GetComponent(q, 0) << " at " << x[0] << ", "
+              << x[1] << ", " << x[2])
+            status = -1;
+            }
+          }
+    }
+
+  dobj->Delete();
+
+  return status;
+}
+
+int run(const char *label, int rank, int nRanks, int mode, bool rectilinear)
+{
+  sensei::Downsample *ds = sensei::Downsample::New();
+  ds->SetCommunicator(MPI_COMM_WORLD);
+  ds->AddDataRequirement("mesh", svtkDataObject::CELL,
+    std::vector<std::string>({"data"}));
+  ds->AddDataRequirement("mesh", svtkDataObject::POINT,
+    std::vector<std::string>({"pdata"}));
+  ds->SetFactor(gFactor[0], gFactor[1], gFactor[2]);
+  ds->SetMode(mode);
+  ds->SetNumberOfThreads(3);
+
+  svtkMultiBlockDataSet *mb = newMesh(rank, nRanks, rectilinear);
+
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetCommunicator(MPI_COMM_WORLD);
+  dataAdaptor->SetDataObject("mesh", mb);
+  mb->Delete();
+
+  int status = 0;
+  sensei::DataAdaptor *dataOut = nullptr;
+  if (!ds->Execute(dataAdaptor, &dataOut) || !dataOut)
+    {
+    SENSEI_ERROR(<< label << " failed")
+    MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+
+  long nCells = 0;
+  status |= validate(label, dataOut, mode, rectilinear, nCells);
+
+  // each complete coarse cell is produced once
+  long nTotal = 0;
+  MPI_Allreduce(&nCells, &nTotal, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+  long nExpected = 1;
+  for (int i = 0; i < 3; ++i)
+    nExpected *= (gExt[2*i+1] - gExt[2*i] + 1) / gFactor[i];
+
+  if (nTotal != nExpected)
+    {
+    SENSEI_ERROR(<< label << " produced " << nTotal << " coarse cells, expected "
+      << nExpected)
+    status = -1;
+    }
+
+  dataOut->ReleaseData();
+  dataOut->Delete();
+
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+
+  ds->Finalize();
+  ds->Delete();
+
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int status = 0;
+
+  status |= run("image stride", rank, nRanks, sensei::Downsample::MODE_STRIDE, false);
+  status |= run("image box", rank, nRanks, sensei::Downsample::MODE_BOX, false);
+  status |= run("rectilinear stride", rank, nRanks, sensei::Downsample::MODE_STRIDE, true);
+  status |= run("rectilinear box", rank, nRanks, sensei::Downsample::MODE_BOX, true);
+
+  if (!status && (rank == 0))
+    std::cerr << "Downsample passed" << std::endl;
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <svtkCellData.h>
+#include <svtkDataArray.h>
+#include <svtkDoubleArray.h>
+#include <svtkFloatArray.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkUnsignedCharArray.h>
+#include "Error.h"
+#include "HZOrder.h"
+#include "HZOrderWriter.h"
+#include "SVTKDataAdaptor.h"
+#include "SVTKUtils.h"
+
+// the global cell extent, none of the dimensions is a power of two
+const std::array<int,6> gExt = {0, 12, 0, 9, 0, 6};
+
+const double gOrigin[3] = {0.5, 1.0, 2.0};
+const double gSpacing[3] = {0.1, 0.2, 0.3};
+
+// the value of the cell or point (i,j,k)
+double value(int i, int j, int k, int c)
+{
+  double v = i + 100.0*j + 10000.0*k;
+  return c ? -v : v;
+}
+
+// a block of the global extent split along x into nBlocks slabs, with a
+// layer of ghost cells
+svtkImageData *newBlock(int block, int nBlocks)
+{
+  int nx = gExt[1] - gExt[0] + 1;
+
+  std::array<int,6> owned = gExt;
+  owned[0] = gExt[0] + block*nx/nBlocks;
+  owned[1] = gExt[0] + (block + 1)*nx/nBlocks - 1;
+
+  std::array<int,6> ext = owned;
+  for (int i = 0; i < 3; ++i)
+    {
+    ext[2*i] = std::max(gExt[2*i], owned[2*i] - 1);
+    ext[2*i+1] = std::min(gExt[2*i+1], owned[2*i+1] + 1);
+    }
+
+  svtkImageData *im = svtkImageData::New();
+  im->SetOrigin(gOrigin[0], gOrigin[1], gOrigin[2]);
+  im->SetSpacing(gSpacing[0], gSpacing[1], gSpacing[2]);
+  im->SetExtent(ext[0], ext[1] + 1, ext[2], ext[3] + 1, ext[4], ext[5] + 1);
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetName("data");
+  da->SetNumberOfComponents(2);
+  for (int k = ext[4]; k <= ext[5]; ++k)
+    for (int j = ext[2]; j <= ext[3]; ++j)
+      for (int i = ext[0]; i <= ext[1]; ++i)
+        {
+        double v[2] = {value(i, j, k, 0), value(i, j, k, 1)};
+        da->InsertNextTuple(v);
+        }
+  im->GetCellData()->AddArray(da);
+  da->Delete();
+
+  svtkFloatArray *pda = svtkFloatArray::New();
+  pda->SetName("pdata");
+  for (int k = ext[4]; k <= ext[5] + 1; ++k)
+    for (int j = ext[2]; j <= ext[3] + 1; ++j)
+      for (int i = ext[0]; i <= ext[1] + 1; ++i)
+        pda->InsertNextValue(value(i, j, k, 0));
+  im->GetPointData()->AddArray(pda);
+  pda->Delete();
+
+  svtkUnsignedCharArray *ghosts = sensei::SVTKUtils::NewGhostCellsArray(ext, owned);
+  im->GetCellData()->AddArray(ghosts);
+  ghosts->Delete();
+
+  return im;
+}
+
+// the HZ index is a permutation of the Z-order index ordered by level
+int checkIndex()
+{
+  std::array<int,3> dims = {5, 3, 1};
+
+  std::vector<int> mask;
+  int nBits = sensei::HZOrder::GetBitMask(dims, mask);
+
+  std::array<std::vector<uint64_t>,3> zt;
+  sensei::HZOrder::GetZTables(mask, dims, zt);
+
+  std::set<uint64_t> hzs;
+  for (int j = 0; j < dims[1]; ++j)
+    for (int i = 0; i < dims[0]; ++i)
+      {
+      uint64_t hz = sensei::HZOrder::GetHZIndex(zt[0][i] | zt[1][j], nBits);
+      if ((hz >= (1ul << nBits)) || ((hz == 0) != ((i == 0) && (j == 0))))
+        {
+        SENSEI_ERROR("Sample " << i << ", " << j << " has HZ index " << hz)
+        return -1;
+        }
+      hzs.insert(hz);
+      }
+
+  if ((nBits != 5) || (hzs.size() != 15))
+    {
+    SENSEI_ERROR("HZ index is not a permutation")
+    return -1;
+    }
+
+  return 0;
+}
+
+// read a box at a level and compare to the values written
+int checkRead(const std::string &indexFile, int level,
+  const std::array<int,6> &box, bool cells, long maxChunks)
+{
+  svtkImageData *im = nullptr;
+  long nChunks = 0;
+  if (sensei::HZOrder::ReadBox(indexFile, level, box, im, &nChunks))
+    {
+    SENSEI_ERROR("Failed to read \"" << indexFile << "\"")
+    return -1;
+    }
+
+  sensei::HZOrder::Index index;
+  index.Read(indexFile);
+
+  std::vector<int> mask;
+  index.GetBitMask(mask);
+
+  std::array<int,3> stride;
+  sensei::HZOrder::GetLevelStride(mask, level < 0 ? mask.size() : level, stride);
+
+  int ext[6];
+  im->GetExtent(ext);
+  if (cells)
+    for (int i = 0; i < 3; ++i)
+      ext[2*i+1] -= 1;
+
+  svtkDataArray *da = cells ? im->GetCellData()->GetArray("data") :
+    im->GetPointData()->GetArray("pdata");
+
+  int status = 0;
+  long q = 0;
+  for (int K = ext[4]; K <= ext[5]; ++K)
+    for (int J = ext[2]; J <= ext[3]; ++J)
+      for (int I = ext[0]; I <= ext[1]; ++I, ++q)
+        {
+        int i = I*stride[0];
+        int j = J*stride[1];
+        int k = K*stride[2];
+
+        bool inBox = (i >= box[0]) && (i <= box[1]) && (j >= box[2]) &&
+          (j <= box[3]) && (k >= box[4]) && (k <= box[5]);
+
+        int ijk[3] = {I, J, K};
+        double x[3];
+        im->GetPoint(im->ComputePointId(ijk), x);
+
+        bool posOk = (std::abs(x[0] - (gOrigin[0] + i*gSpacing[0])) < 1.0e-9) &&
+          (std::abs(x[1] - (gOrigin[1] + j*gSpacing[1])) < 1.0e-9) &&
+          (std::abs(x[2] - (gOrigin[2] + k*gSpacing[2])) < 1.0e-9);
+
+        for (int c = 0; c < da->GetNumberOfComponents(); ++c)
+          {
+          if (!inBox || !posOk || (da->GetComponent(q, c) != value(i, j, k, c)))
+            {
+            SENSEI_ERROR(<< indexFile << " level " << level << " sample "
+              << i << ", " << j << ", " << k << " is " << da->GetComponent(q, c)
+              << " at " << x[0] << ", " << x[1] << ", " << x[2])
+            status = -1;
+            }
+          }
+        }
+
+  if (nChunks > maxChunks)
+    {
+    SENSEI_ERROR(<< indexFile << " level " << level << " read " << nChunks
+      << " chunks, expected at most " << maxChunks)
+    status = -1;
+    }
+
+  im->Delete();
+
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int status = checkIndex();
+
+  // two blocks per rank
+  svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+  mb->SetNumberOfBlocks(2*nRanks);
+  for (int b = 0; b < 2; ++b)
+    {
+    svtkImageData *im = newBlock(2*rank + b, 2*nRanks);
+    mb->SetBlock(2*rank + b, im);
+    im->Delete();
+    }
+  sensei::SVTKUtils::SetGhostLayerMetadata(mb, 1, 0);
+
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetCommunicator(MPI_COMM_WORLD);
+  dataAdaptor->SetDataObject("mesh", mb);
+  dataAdaptor->SetDataTimeStep(3);
+  mb->Delete();
+
+  sensei::HZOrderWriter *writer = sensei::HZOrderWriter::New();
+  writer->SetCommunicator(MPI_COMM_WORLD);
+  writer->AddDataRequirement("mesh", svtkDataObject::CELL,
+    std::vector<std::string>({"data"}));
+  writer->AddDataRequirement("mesh", svtkDataObject::POINT,
+    std::vector<std::string>({"pdata"}));
+  writer->SetFileName("testHZOrder");
+  writer->SetChunkBits(5);
+  writer->SetNumberOfAggregators(2);
+
+  if (!writer->Execute(dataAdaptor, nullptr))
+    {
+    SENSEI_ERROR("Failed to write")
+    MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+
+  writer->Finalize();
+  writer->Delete();
+
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  if (rank == 0)
+    {
+    // 13 x 10 x 7 cells take 4 + 4 + 3 bits, 64 chunks of 32 samples
+    std::string cellIndex = "./testHZOrder_mesh_data_000003.idx";
+    status |= checkRead(cellIndex, -1, gExt, true, 64);
+
+    // the first 8 levels are in the first 8 chunks
+    std::array<int,6> box = {2, 11, 1, 8, 0, 6};
+    status |= checkRead(cellIndex, 8, box, true, 8);
+    status |= checkRead(cellIndex, 0, gExt, true, 1);
+
+    // 14 x 11 x 8 points
+    std::array<int,6> pointExt = {0, 13, 0, 10, 0, 7};
+    std::string pointIndex = "./testHZOrder_mesh_pdata_000003.idx";
+    status |= checkRead(pointIndex, -1, pointExt, false, 64);
+    status |= checkRead(pointIndex, 6, box, false, 2);
+    }
+
+  MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  if (!status && (rank == 0))
+    std::cerr << "HZOrder passed" << std::endl;
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
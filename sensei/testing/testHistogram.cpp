@@ -1,4 +1,5 @@
 #include <random>
+#include <cstdlib>
 #include <iostream>
 #include <mpi.h>
 #include <svtkDoubleArray.h>
@@ -132,16 +133,44 @@ int main(int argc, char **argv)
   analysisAdaptor->Initialize(gNBins, "mesh", svtkDataObject::POINT,
      "normal", "");
 
+  // an optional memory budget in bytes. when the budget is exceeded the
+  // blocks are processed one at a time.
+  if (argc > 1)
+    analysisAdaptor->SetMemoryBudget(atol(argv[1]));
+
+  // optionally complete the reduction at finalize, the result is then
+  // reported one step late
+  int asynchronous = argc > 2 ? atoi(argv[2]) : 0;
+  analysisAdaptor->SetAsynchronous(asynchronous);
+
   analysisAdaptor->Execute(dataAdaptor, nullptr);
   dataAdaptor->Delete();
 
-
   sensei::Histogram::Data result;
-  analysisAdaptor->GetHistogram(result);
+  int status = 0;
+
+  if (asynchronous)
+    {
+    // nothing is reported until the reduction completes
+    analysisAdaptor->GetHistogram(result);
+    if (!result.Histogram.empty())
+      {
+      SENSEI_ERROR("The histogram was reported before the reduction completed")
+      status = -1;
+      }
+
+    analysisAdaptor->Finalize();
+    analysisAdaptor->GetHistogram(result);
+    }
+  else
+    {
+    analysisAdaptor->GetHistogram(result);
+    analysisAdaptor->Finalize();
+    }
 
-  int status = validateHistogram(result.BinMin, result.BinMax, result.Histogram);
+  if (!status)
+    status = validateHistogram(result.BinMin, result.BinMax, result.Histogram);
 
-  analysisAdaptor->Finalize();
   analysisAdaptor->Delete();
 
   MPI_Finalize();
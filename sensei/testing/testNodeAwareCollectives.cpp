@@ -0,0 +1,189 @@
+#include <array>
+#include <iostream>
+#include <vector>
+#include <mpi.h>
+#include "Error.h"
+#include "MPIUtils.h"
+
+// a non-commutative op that keeps its left operand, the reduction is the
+// value of the first rank
+void keepFirst(void *in, void *inout, int *len, MPI_Datatype *)
+{
+  long *pin = static_cast<long*>(in);
+  long *pinout = static_cast<long*>(inout);
+  for (int i = 0; i < *len; ++i)
+    pinout[i] = pin[i];
+}
+
+// check the node aware collectives against values computed locally. nodes
+// can be emulated on a single node by setting SENSEI_RANKS_PER_NODE
+int testCollectives(MPI_Comm comm)
+{
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nRanks);
+
+  int status = 0;
+
+  // repeat with growing sizes so that the shared memory is reallocated
+  for (int pass = 0; pass < 3; ++pass)
+    {
+    int n = 1 + pass*1000;
+
+    // sums
+    std::vector<long> counts(n);
+    for (int i = 0; i < n; ++i)
+      counts[i] = rank + i;
+
+    sensei::MPIUtils::GlobalCounts(comm, counts);
+
+    for (int i = 0; i < n; ++i)
+      {
+      long expect = long(nRanks)*(nRanks - 1)/2 + long(nRanks)*i;
+      if (counts[i] != expect)
+        {
+        SENSEI_ERROR("GlobalCounts value " << i << " is " << counts[i]
+          << " expected " << expect)
+        status = -1;
+        break;
+        }
+      }
+
+    // reduction to a root that is not rank 0
+    int root = nRanks - 1;
+    std::vector<int> vals(n, rank + 1);
+    std::vector<int> sums(n, 0);
+
+    sensei::MPIUtils::NodeAwareReduce(comm, vals.data(), sums.data(), n,
+      MPI_INT, MPI_SUM, root);
+
+    if ((rank == root) && (sums[n-1] != nRanks*(nRanks + 1)/2))
+      {
+      SENSEI_ERROR("NodeAwareReduce result is " << sums[n-1] << " expected "
+        << nRanks*(nRanks + 1)/2)
+      status = -1;
+      }
+
+    // reductions with a non-commutative op are done in rank order
+    std::vector<long> firsts(n, rank + 1);
+
+    MPI_Op first = MPI_OP_NULL;
+    MPI_Op_create(keepFirst, 0, &first);
+
+    sensei::MPIUtils::NodeAwareAllreduce(comm, firsts.data(), n, MPI_LONG,
+      first);
+
+    MPI_Op_free(&first);
+
+    if ((firsts[0] != 1) || (firsts[n-1] != 1))
+      {
+      SENSEI_ERROR("NodeAwareAllreduce with a non-commutative op gave "
+        << firsts[n-1] << " expected 1")
+      status = -1;
+      }
+
+    // a variable number of items per rank, some ranks have none
+    int nLocal = (rank % 3)*(pass + 1);
+    std::vector<double> ldata(nLocal, double(rank));
+    std::vector<int> gcounts, goffsets;
+    std::vector<double> gdata;
+
+    sensei::MPIUtils::GlobalViewV(comm, ldata, gcounts, goffsets, gdata);
+
+    long q = 0;
+    for (int r = 0; (r < nRanks) && !status; ++r)
+      {
+      int nr = (r % 3)*(pass + 1);
+      if ((gcounts[r] != nr) || (goffsets[r] != q))
+        {
+        SENSEI_ERROR("GlobalViewV count or offset of rank " << r << " is wrong")
+        status = -1;
+        }
+
+      for (int i = 0; (i < nr) && !status; ++i, ++q)
+        {
+        if (gdata[q] != double(r))
+          {
+          SENSEI_ERROR("GlobalViewV item " << q << " is " << gdata[q]
+            << " expected " << r)
+          status = -1;
+          }
+        }
+      }
+
+    if (!status && (long(gdata.size()) != q))
+      {
+      SENSEI_ERROR("GlobalViewV returned " << gdata.size()
+        << " items expected " << q)
+      status = -1;
+      }
+    }
+
+  // bounds and ranges
+  std::vector<std::array<int,6>> lbounds{{{-rank, rank, 0, 2*rank, rank, rank + 1}}};
+  std::array<int,6> gbounds;
+  sensei::MPIUtils::GlobalBounds(comm, lbounds, gbounds);
+
+  std::array<int,6> ebounds{{-(nRanks - 1), nRanks - 1, 0, 2*(nRanks - 1), 0, nRanks}};
+  if (gbounds != ebounds)
+    {
+    SENSEI_ERROR("GlobalBounds is wrong")
+    status = -1;
+    }
+
+  std::vector<std::array<double,2>> lrange{{{double(rank), 2.0*rank}}};
+  std::array<double,2> grange;
+  sensei::MPIUtils::GlobalRange(comm, lrange, grange);
+
+  if ((grange[0] != 0.0) || (grange[1] != 2.0*(nRanks - 1)))
+    {
+    SENSEI_ERROR("GlobalRange is wrong")
+    status = -1;
+    }
+
+  // a fixed number of items per rank
+  std::vector<int> lview{rank, -rank};
+  std::vector<int> gview;
+  sensei::MPIUtils::GlobalView(comm, lview, gview);
+
+  for (int r = 0; (r < nRanks) && !status; ++r)
+    {
+    if ((gview[2*r] != r) || (gview[2*r + 1] != -r))
+      {
+      SENSEI_ERROR("GlobalView is wrong at rank " << r)
+      status = -1;
+      }
+    }
+
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+  // the communicators are cached on world and on a communicator that is
+  // freed while cached
+  int status = testCollectives(MPI_COMM_WORLD);
+
+  MPI_Comm split = MPI_COMM_NULL;
+  MPI_Comm_split(MPI_COMM_WORLD, rank % 2, rank, &split);
+
+  status |= testCollectives(split);
+
+  MPI_Comm_free(&split);
+
+  int globalStatus = 0;
+  MPI_Allreduce(&status, &globalStatus, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+  if ((rank == 0) && !globalStatus)
+    std::cerr << "Node aware collectives passed" << std::endl;
+
+  MPI_Finalize();
+
+  return globalStatus;
+}
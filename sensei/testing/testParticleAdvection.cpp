@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <mpi.h>
+#include <svtkCellData.h>
+#include <svtkDataArray.h>
+#include <svtkDoubleArray.h>
+#include <svtkIdList.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkPolyData.h>
+#include "Error.h"
+#include "ParticleAdvection.h"
+#include "SVTKDataAdaptor.h"
+#include "TestUtils.h"
+
+// the number of cells in each direction of the global mesh
+const int gN = 16;
+
+// the step size and the vertical velocity
+const double gH = 0.05;
+const double gW = 0.1;
+
+// the seeds, on a line through the axis of rotation
+const double gSeeds[3][3] = {{0.3, 0.5, 0.05}, {0.5, 0.5, 0.05}, {0.7, 0.5, 0.05}};
+
+// a helical flow, rotation about the vertical line through (0.5, 0.5) and a
+// constant vertical velocity. trilinear interpolation is exact.
+void field(double x, double y, double z, double *v)
+{
+  (void)z;
+  v[0] = -(y - 0.5);
+  v[1] = x - 0.5;
+  v[2] = gW;
+}
+
+// where a seed is at time t
+void path(const double *x0, double t, double *x)
+{
+  double dx = x0[0] - 0.5;
+  double dy = x0[1] - 0.5;
+  x[0] = 0.5 + dx*std::cos(t) - dy*std::sin(t);
+  x[1] = 0.5 + dx*std::sin(t) + dy*std::cos(t);
+  x[2] = x0[2] + gW*t;
+}
+
+// the unit cube split into slabs along z, one per rank, each split in two
+// along x. blocks share the points where they meet.
+svtkMultiBlockDataSet *newMesh(int rank, int nRanks)
+{
+  double dx = 1.0/gN;
+
+  int k0 = rank*gN/nRanks;
+  int k1 = (rank + 1)*gN/nRanks;
+  int iMid = gN/2;
+  int iExt[2][2] = {{0, iMid}, {iMid, gN}};
+
+  return sensei::TestUtils::NewTwoBlocksPerRank(rank, nRanks,
+    [&](int block) -> svtkDataObject*
+    {
+    int b = block % 2;
+
+    svtkImageData *im = svtkImageData::New();
+    im->SetOrigin(0.0, 0.0, 0.0);
+    im->SetSpacing(dx, dx, dx);
+    im->SetExtent(iExt[b][0], iExt[b][1], 0, gN, k0, k1);
+
+    svtkDoubleArray *da = svtkDoubleArray::New();
+    da->SetName("velocity");
+    da->SetNumberOfComponents(3);
+    da->SetNumberOfTuples(im->GetNumberOfPoints());
+
+    long q = 0;
+    for (int k = k0; k <= k1; ++k)
+      for (int j = 0; j <= gN; ++j)
+        for (int i = iExt[b][0]; i <= iExt[b][1]; ++i, ++q)
+          field(i*dx, j*dx, k*dx, da->GetPointer(3*q));
+
+    im->GetPointData()->AddArray(da);
+    da->Delete();
+
+    return im;
+    });
+}
+
+// compare the paths computed by this rank to the exact ones. the largest
+// time reached by each seed is returned
+int validate(const char *label, sensei::DataAdaptor *dataOut, int rank,
+  double tol, std::vector<double> &maxTime)
+{
+  svtkDataObject *dobj = nullptr;
+  if (dataOut->GetMesh("streamlines", false, dobj) ||
+    dataOut->AddArray(dobj, "streamlines", svtkDataObject::POINT, "time") ||
+    dataOut->AddArray(dobj, "streamlines", svtkDataObject::CELL, "seed_id"))
+    {
+    SENSEI_ERROR("Failed to get the " << label)
+    return -1;
+    }
+
+  svtkMultiBlockDataSet *mb = dynamic_cast<svtkMultiBlockDataSet*>(dobj);
+  svtkPolyData *pd = mb ? dynamic_cast<svtkPolyData*>(mb->GetBlock(rank)) : nullptr;
+  if (!pd)
+    {
+    SENSEI_ERROR("The " << label << " are not a multiblock of polydata")
+    dobj->Delete();
+    return -1;
+    }
+
+  svtkDataArray *time = pd->GetPointData()->GetArray("time");
+  svtkDataArray *ids = pd->GetCellData()->GetArray("seed_id");
+
+  int status = 0;
+  double maxErr = 0.0;
+  maxTime.assign(3, 0.0);
+
+  svtkIdList *ptIds = svtkIdList::New();
+  long nLines = pd->GetNumberOfCells();
+  for (long c = 0; c < nLines; ++c)
+    {
+    long seed = ids->GetTuple1(c);
+    pd->GetCellPoints(c, ptIds);
+
+    for (svtkIdType p = 0; p < ptIds->GetNumberOfIds(); ++p)
+      {
+      svtkIdType pid = ptIds->GetId(p);
+      double t = time->GetTuple1(pid);
+
+      double x[3];
+      double xe[3];
+      pd->GetPoint(pid, x);
+      path(gSeeds[seed], t, xe);
+
+      for (int d = 0; d < 3; ++d)
+        maxErr = std::max(maxErr, std::abs(x[d] - xe[d]));
+
+      maxTime[seed] = std::max(maxTime[seed], t);
+      }
+    }
+  ptIds->Delete();
+
+  if (maxErr > tol)
+    {
+    SENSEI_ERROR(<< label << " differ from the exact paths by " << maxErr)
+    status = -1;
+    }
+
+  dobj->Delete();
+
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  svtkMultiBlockDataSet *mb = newMesh(rank, nRanks);
+
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetCommunicator(MPI_COMM_WORLD);
+  dataAdaptor->SetDataObject("mesh", mb);
+  mb->Delete();
+
+  std::vector<double> seeds(&gSeeds[0][0], &gSeeds[0][0] + 9);
+
+  int status = 0;
+
+  // streamlines. particles leave through the top at time 9.5 or take
+  // the maximum number of steps
+  const char *integrators[] = {"rk2", "rk4", "rk45"};
+  const double tols[] = {2e-2, 2e-3, 2e-3};
+  for (int q = 0; q < 3; ++q)
+    {
+    int integrator = 0;
+    sensei::ParticleAdvection::GetIntegrator(integrators[q], integrator);
+
+    sensei::ParticleAdvection *adv = sensei::ParticleAdvection::New();
+    adv->SetCommunicator(MPI_COMM_WORLD);
+    adv->SetMeshName("mesh");
+    adv->SetArrayName("velocity");
+    adv->SetIntegrator(integrator);
+    adv->SetSeeds(seeds);
+    adv->SetStepSize(gH);
+    adv->SetMaximumNumberOfSteps(q == 2 ? 100 : 1000);
+    adv->SetNumberOfThreads(2);
+
+    dataAdaptor->SetDataTimeStep(0);
+    dataAdaptor->SetDataTime(0.0);
+
+    sensei::DataAdaptor *dataOut = nullptr;
+    if (!adv->Execute(dataAdaptor, &dataOut) || !dataOut)
+      {
+      SENSEI_ERROR("Streamlines using " << integrators[q] << " failed")
+      MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+
+    std::vector<double> maxTime;
+    status |= validate("streamlines", dataOut, rank, tols[q], maxTime);
+
+    std::vector<double> globalMaxTime(3);
+    MPI_Allreduce(maxTime.data(), globalMaxTime.data(), 3, MPI_DOUBLE,
+      MPI_MAX, MPI_COMM_WORLD);
+
+    // the seeds all reach the top, or stop after 100 steps
+    double expected = q == 2 ? 100*gH : 0.95/gW;
+    for (int s = 0; s < 3; ++s)
+      {
+      if ((globalMaxTime[s] < expected - 1e-6) ||
+        (globalMaxTime[s] > expected + gH + 1e-6))
+        {
+        SENSEI_ERROR(<< integrators[q] << " seed " << s << " reached time "
+          << globalMaxTime[s] << " expected " << expected)
+        status = -1;
+        }
+      }
+
+    if (rank == 0)
+      std::cerr << integrators[q] << " streamlines reached time "
+        << globalMaxTime[0] << ", " << globalMaxTime[1] << ", "
+        << globalMaxTime[2] << std::endl;
+
+    dataOut->Delete();
+    adv->Delete();
+    }
+
+  // pathlines. the particles persist across time steps and are advanced
+  // to the time of each step
+  sensei::ParticleAdvection *adv = sensei::ParticleAdvection::New();
+  adv->SetCommunicator(MPI_COMM_WORLD);
+  adv->SetMeshName("mesh");
+  adv->SetArrayName("velocity");
+  adv->SetMode(sensei::ParticleAdvection::MODE_PATHLINE);
+  adv->SetSeeds(seeds);
+  adv->SetStepSize(gH);
+
+  for (int step = 0; step < 4; ++step)
+    {
+    double time = 1.5*step;
+    dataAdaptor->SetDataTimeStep(step);
+    dataAdaptor->SetDataTime(time);
+
+    sensei::DataAdaptor *dataOut = nullptr;
+    if (!adv->Execute(dataAdaptor, &dataOut) || !dataOut)
+      {
+      SENSEI_ERROR("Pathlines failed")
+      MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+
+    std::vector<double> maxTime;
+    status |= validate("pathlines", dataOut, rank, 2e-3, maxTime);
+
+    dataOut->Delete();
+
+    // every particle is held by exactly one rank
+    long nLocal = adv->GetNumberOfParticles();
+    long nGlobal = 0;
+    MPI_Allreduce(&nLocal, &nGlobal, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+
+    std::vector<double> globalMaxTime(3);
+    MPI_Allreduce(maxTime.data(), globalMaxTime.data(), 3, MPI_DOUBLE,
+      MPI_MAX, MPI_COMM_WORLD);
+
+    if ((nGlobal != 3) || (step && (std::abs(globalMaxTime[0] - time) > 1e-9)))
+      {
+      SENSEI_ERROR("Step " << step << " has " << nGlobal << " particles at time "
+        << globalMaxTime[0] << " expected 3 at time " << time)
+      status = -1;
+      }
+    }
+
+  adv->Finalize();
+  adv->Delete();
+
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
@@ -0,0 +1,194 @@
+#include <cmath>
+#include <iostream>
+#include <mpi.h>
+#include <svtkCellArray.h>
+#include <svtkCellData.h>
+#include <svtkDataArray.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkPoints.h>
+#include <svtkPolyData.h>
+#include "Error.h"
+#include "ParticleDeposition.h"
+#include "SVTKDataAdaptor.h"
+
+// a simple pseudo random sequence, the same on all platforms
+double rnd(unsigned long &state)
+{
+  state = 6364136223846793005ul*state + 1442695040888963407ul;
+  return double(state >> 11)/double(1ul << 53);
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  // particles inside of the unit cube. with the unit cube as the bounds the
+  // kernels do not reach past the edge of the grid. the id array is used to
+  // check that the attributes are conserved, the two component array is
+  // constant so its average is known everywhere particles were deposited
+  long nLocal = 1000;
+  unsigned long state = 1234 + rank;
+
+  svtkPoints *pts = svtkPoints::New();
+  pts->SetDataTypeToDouble();
+  pts->SetNumberOfPoints(nLocal);
+
+  svtkDoubleArray *ids = svtkDoubleArray::New();
+  ids->SetName("id");
+  ids->SetNumberOfTuples(nLocal);
+
+  svtkDoubleArray *vec = svtkDoubleArray::New();
+  vec->SetName("vec");
+  vec->SetNumberOfComponents(2);
+  vec->SetNumberOfTuples(nLocal);
+
+  double idSum = 0.0;
+  for (long i = 0; i < nLocal; ++i)
+    {
+    double x = 0.2 + 0.6*rnd(state);
+    double y = 0.2 + 0.6*rnd(state);
+    double z = 0.2 + 0.6*rnd(state);
+    pts->SetPoint(i, x, y, z);
+
+    double id = rank*nLocal + i;
+    ids->SetValue(i, id);
+    idSum += id;
+
+    vec->SetTypedComponent(i, 0, 2.0);
+    vec->SetTypedComponent(i, 1, -3.0);
+    }
+
+  double globalIdSum = 0.0;
+  MPI_Allreduce(&idSum, &globalIdSum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+  svtkPolyData *pd = svtkPolyData::New();
+  pd->SetPoints(pts);
+  pd->GetPointData()->AddArray(ids);
+  pd->GetPointData()->AddArray(vec);
+  pts->Delete();
+  ids->Delete();
+  vec->Delete();
+
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetCommunicator(MPI_COMM_WORLD);
+  dataAdaptor->SetDataObject("particles", pd);
+  dataAdaptor->SetDataTimeStep(0);
+  dataAdaptor->SetDataTime(0.0);
+  pd->Delete();
+
+  int status = 0;
+
+  // each kernel, first with bounds enclosing the particles then with the
+  // default bounds, those of the particles. with the default bounds the
+  // kernels reach past the grid, and a particle lies on the upper bound
+  const char *kernels[] = {"ngp", "cic", "tsc"};
+  for (int qq = 0; qq < 6; ++qq)
+    {
+    int q = qq % 3;
+    bool defaultBounds = qq > 2;
+    const char *boundsName = defaultBounds ? "default bounds" : "bounds";
+
+    int kernel = 0;
+    sensei::ParticleDeposition::GetKernel(kernels[q], kernel);
+
+    sensei::ParticleDeposition *dep = sensei::ParticleDeposition::New();
+    dep->SetCommunicator(MPI_COMM_WORLD);
+    dep->SetMeshName("particles");
+    dep->SetArrays({"id", "vec"});
+    dep->SetKernel(kernel);
+    dep->SetResolution({{16, 12, 8}});
+    if (!defaultBounds)
+      dep->SetBounds({{0.0, 1.0, 0.0, 1.0, 0.0, 1.0}});
+    dep->SetNumberOfThreads(3);
+
+    sensei::DataAdaptor *dataOut = nullptr;
+    if (!dep->Execute(dataAdaptor, &dataOut) || !dataOut)
+      {
+      SENSEI_ERROR("Deposition with the " << kernels[q] << " kernel failed")
+      MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+
+    svtkDataObject *dobj = nullptr;
+    if (dataOut->GetMesh("deposition", false, dobj) ||
+      dataOut->AddArray(dobj, "deposition", svtkDataObject::CELL, "density") ||
+      dataOut->AddArray(dobj, "deposition", svtkDataObject::CELL, "id") ||
+      dataOut->AddArray(dobj, "deposition", svtkDataObject::CELL, "vec"))
+      {
+      SENSEI_ERROR("Failed to get the deposited data")
+      MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+
+    svtkMultiBlockDataSet *mb = dynamic_cast<svtkMultiBlockDataSet*>(dobj);
+    svtkImageData *im = mb ? dynamic_cast<svtkImageData*>(mb->GetBlock(rank)) : nullptr;
+    if (!im)
+      {
+      SENSEI_ERROR("The output is not a multiblock of image data")
+      MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+
+    svtkDataArray *density = im->GetCellData()->GetArray("density");
+    svtkDataArray *idAvg = im->GetCellData()->GetArray("id");
+    svtkDataArray *vecAvg = im->GetCellData()->GetArray("vec");
+
+    double dx[3];
+    im->GetSpacing(dx);
+    double cellVol = dx[0]*dx[1]*dx[2];
+
+    // the mass and the sum of the ids must be conserved
+    double sums[2] = {0.0, 0.0};
+    long nCells = im->GetNumberOfCells();
+    for (long i = 0; i < nCells; ++i)
+      {
+      double mass = density->GetTuple1(i)*cellVol;
+      sums[0] += mass;
+      sums[1] += mass*idAvg->GetTuple1(i);
+
+      if ((mass > 0.0) && ((std::abs(vecAvg->GetComponent(i, 0) - 2.0) > 1e-10) ||
+        (std::abs(vecAvg->GetComponent(i, 1) + 3.0) > 1e-10)))
+        {
+        SENSEI_ERROR(<< kernels[q] << " cell " << i << " wrong average "
+          << vecAvg->GetComponent(i, 0) << ", " << vecAvg->GetComponent(i, 1))
+        status = -1;
+        break;
+        }
+      }
+
+    double globalSums[2] = {0.0, 0.0};
+    MPI_Allreduce(sums, globalSums, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+
+    double nParticles = nRanks*nLocal;
+    if ((std::abs(globalSums[0] - nParticles) > 1e-8*nParticles) ||
+      (std::abs(globalSums[1] - globalIdSum) > 1e-8*globalIdSum))
+      {
+      SENSEI_ERROR(<< kernels[q] << " with " << boundsName << " deposited "
+        << globalSums[0] << " particles with id sum " << globalSums[1] << " expected " << nParticles
+        << " and " << globalIdSum)
+      status = -1;
+      }
+
+    if (rank == 0)
+      std::cerr << kernels[q] << " with " << boundsName << " deposited "
+        << globalSums[0] << " of "
+        << nParticles << " particles" << std::endl;
+
+    dobj->Delete();
+    dataOut->Delete();
+    dep->Delete();
+    }
+
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
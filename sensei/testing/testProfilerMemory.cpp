@@ -0,0 +1,114 @@
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "Error.h"
+#include "MemoryProfiler.h"
+#include "Profiler.h"
+
+// global so that the compiler can not elide the allocation
+char *gBuffer = nullptr;
+
+// allocate and touch nBytes inside an event, then hold it until the
+// enclosing event ends
+void allocate(long nBytes)
+{
+  sensei::TimeEvent<64> event("allocate");
+  gBuffer = new char[nBytes];
+  memset(gBuffer, 1, nBytes);
+}
+
+// allocate and release nBytes inside an event
+void transient(long nBytes)
+{
+  sensei::TimeEvent<64> event("transient");
+  allocate(nBytes);
+  delete [] gBuffer;
+  gBuffer = nullptr;
+}
+
+// find the event in the log and parse the memory columns
+int getMemory(const std::string &log, const std::string &name,
+  long long &heapDelta, long long &heapHighWater)
+{
+  std::istringstream iss(log);
+  std::string line;
+  while (std::getline(iss, line))
+    {
+    if (line.find("\"" + name + "\"") == std::string::npos)
+      continue;
+
+    // the memory columns are the last three
+    std::vector<std::string> cols;
+    std::istringstream lss(line);
+    std::string col;
+    while (std::getline(lss, col, ','))
+      cols.push_back(col);
+
+    if (cols.size() != 11)
+      {
+      SENSEI_ERROR("Wrong number of columns in \"" << line << "\"")
+      return -1;
+      }
+
+    heapDelta = std::stoll(cols[8]);
+    heapHighWater = std::stoll(cols[9]);
+    return 0;
+    }
+
+  SENSEI_ERROR("No event named \"" << name << "\"")
+  return -1;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  if (sensei::MemoryProfiler::GetHeapMemoryUsed() < 0)
+    {
+    std::cerr << "Heap memory use is not available, skipping" << std::endl;
+    MPI_Finalize();
+    return 0;
+    }
+
+  sensei::Profiler::Enable(0x05);
+  sensei::Profiler::Initialize();
+
+  long nBytes = 16l*1024*1024;
+  transient(nBytes);
+
+  std::ostringstream oss;
+  sensei::Profiler::ToStream(oss);
+  std::string log = oss.str();
+
+  long long allocDelta = 0, allocHighWater = 0;
+  long long transDelta = 0, transHighWater = 0;
+  int status = 0;
+
+  if (getMemory(log, "allocate", allocDelta, allocHighWater) ||
+    getMemory(log, "transient", transDelta, transHighWater))
+    {
+    status = -1;
+    }
+  else if ((allocDelta < nBytes) || (allocHighWater < nBytes))
+    {
+    SENSEI_ERROR("The allocate event should own the allocation. delta="
+      << allocDelta << " high water=" << allocHighWater)
+    status = -1;
+    }
+  else if ((transDelta >= nBytes) || (transHighWater < nBytes))
+    {
+    SENSEI_ERROR("The transient event should have a peak but no net"
+      " allocation. delta=" << transDelta << " high water=" << transHighWater)
+    status = -1;
+    }
+
+  sensei::Profiler::Disable();
+  sensei::Profiler::Finalize();
+
+  MPI_Finalize();
+
+  return status;
+}
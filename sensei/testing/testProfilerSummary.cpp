@@ -0,0 +1,164 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mpi.h>
+#include "Error.h"
+#include "Profiler.h"
+#include "TestUtils.h"
+
+// find the row of the named event in the summary
+int getSummary(const std::string &fileName, const std::string &name,
+  std::vector<std::string> &cols)
+{
+  std::ifstream ifs(fileName);
+  std::string line;
+  while (std::getline(ifs, line))
+    {
+    if (line.find("\"" + name + "\"") != 0)
+      continue;
+
+    cols = sensei::TestUtils::Split(line);
+    if (cols.size() != 41)
+      {
+      SENSEI_ERROR("Wrong number of columns in \"" << line << "\"")
+      return -1;
+      }
+
+    return 0;
+    }
+
+  SENSEI_ERROR("No summary of event \"" << name << "\"")
+  return -1;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  std::string prefix = argc > 1 ? argv[1] : "testProfilerSummary";
+  std::string summaryFile = prefix + "_summary.csv";
+  std::string traceFile = prefix + "_trace.csv";
+
+  // summarize, keeping the trace of every other rank
+  sensei::Profiler::SetCommunicator(MPI_COMM_WORLD);
+  sensei::Profiler::SetTimerLogFile(traceFile);
+  sensei::Profiler::SetSummaryLogFile(summaryFile);
+  sensei::Profiler::SetTraceStride(2);
+  sensei::Profiler::Enable(0x09);
+  sensei::Profiler::Initialize();
+
+  // each rank times rank + 1 events, the higher ranks taking longer
+  for (int i = 0; i <= rank; ++i)
+    {
+    sensei::TimeEvent<64> event("work");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2*(rank + 1)));
+    }
+
+  // an event on one rank only
+  if (rank == nRanks - 1)
+    {
+    sensei::TimeEvent<64> event("last rank");
+    }
+
+  // the local durations are available before the summary is reduced
+  int status = 0;
+  long localCount = 0;
+  double localTotal = 0.0;
+  if (sensei::Profiler::GetEventTime("work", localCount, localTotal) ||
+    (localCount != rank + 1) || (localTotal < 2.0e-3*(rank + 1)*(rank + 1)))
+    {
+    SENSEI_ERROR("Wrong local time for \"work\" count=" << localCount
+      << " total=" << localTotal)
+    status = -1;
+    }
+
+  sensei::Profiler::Finalize();
+
+  if (rank == 0)
+    {
+    std::vector<std::string> cols;
+    if (getSummary(summaryFile, "work", cols))
+      {
+      status = -1;
+      }
+    else
+      {
+      long count = std::stol(cols[1]);
+      int ranks = std::stoi(cols[2]);
+      double minTime = std::stod(cols[5]);
+      int minRank = std::stoi(cols[6]);
+      double maxTime = std::stod(cols[7]);
+      int maxRank = std::stoi(cols[8]);
+
+      long nBucket = 0;
+      for (int j = 9; j < 41; ++j)
+        nBucket += std::stol(cols[j]);
+
+      if ((count != long(nRanks)*(nRanks + 1)/2) || (ranks != nRanks) ||
+        (nBucket != count))
+        {
+        SENSEI_ERROR("Wrong counts for \"work\" count=" << count
+          << " ranks=" << ranks << " histogram=" << nBucket)
+        status = -1;
+        }
+
+      if ((minRank != 0) || (maxRank != nRanks - 1) || (minTime > maxTime) ||
+        (minTime < 2.0e-3))
+        {
+        SENSEI_ERROR("Wrong extrema for \"work\" min=" << minTime << " on "
+          << minRank << " max=" << maxTime << " on " << maxRank)
+        status = -1;
+        }
+      }
+
+    if (getSummary(summaryFile, "last rank", cols) ||
+      (std::stoi(cols[2]) != 1) || (std::stoi(cols[6]) != nRanks - 1))
+      {
+      SENSEI_ERROR("Wrong summary for \"last rank\"")
+      status = -1;
+      }
+
+    // the trace holds the events of the sampled ranks only
+    std::ifstream ifs(traceFile);
+    std::string line;
+    long nEvents = 0;
+    while (std::getline(ifs, line))
+      {
+      if (line[0] == '#')
+        continue;
+
+      int evtRank = std::stoi(sensei::TestUtils::Split(line)[0]);
+      if (evtRank % 2)
+        {
+        SENSEI_ERROR("Rank " << evtRank << " was not sampled but is in the trace")
+        status = -1;
+        break;
+        }
+
+      nEvents += 1;
+      }
+
+    if (nEvents < 1)
+      {
+      SENSEI_ERROR("The trace is empty")
+      status = -1;
+      }
+    }
+
+  MPI_Allreduce(MPI_IN_PLACE, &status, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+  if ((rank == 0) && !status)
+    std::cerr << "Profiler summary passed" << std::endl;
+
+  MPI_Finalize();
+
+  return status;
+}
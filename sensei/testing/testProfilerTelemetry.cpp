@@ -0,0 +1,225 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <mpi.h>
+#include "Error.h"
+#include "Profiler.h"
+#include "TestUtils.h"
+
+// check the records, there is a header, one line per step, and the values
+// are reduced across ranks
+int checkRecords(const std::string &text, int nSteps, int nRanks)
+{
+  std::istringstream iss(text);
+  std::string line;
+  int nHeaders = 0;
+  int step = 0;
+  while (std::getline(iss, line))
+    {
+    if (line[0] == '#')
+      {
+      nHeaders += 1;
+      continue;
+      }
+
+    // step, time, wall, and min, max, mean of work, io from the second
+    // step on, total, bytes, and RSS
+    int nActive = step ? 2 : 1;
+    std::vector<std::string> cols = sensei::TestUtils::Split(line);
+    if (int(cols.size()) != 3 + 3*(nActive + 3))
+      {
+      SENSEI_ERROR("Wrong number of columns in \"" << line << "\"")
+      return -1;
+      }
+
+    if (std::stol(cols[0]) != step)
+      {
+      SENSEI_ERROR("Record " << step << " is for step " << cols[0])
+      return -1;
+      }
+
+    // rank r works for 2*(r + 1) ms, io is only added in odd steps
+    double workMin = std::stod(cols[3]);
+    double workMax = std::stod(cols[4]);
+    double ioMax = step ? std::stod(cols[7]) : 0.0;
+    if ((workMin < 2.0e-3) || (workMax < 2.0e-3*nRanks) ||
+      ((step % 2) && (ioMax <= 0.0)) || (!(step % 2) && (ioMax != 0.0)))
+      {
+      SENSEI_ERROR("Wrong times at step " << step << " work " << workMin
+        << " " << workMax << " io " << ioMax)
+      return -1;
+      }
+
+    // rank r moves r + 1 bytes per step
+    int q = 3 + 3*(nActive + 1);
+    double bytesMin = std::stod(cols[q]);
+    double bytesMax = std::stod(cols[q + 1]);
+    double bytesMean = std::stod(cols[q + 2]);
+    if ((bytesMin != 1.0) || (bytesMax != nRanks) ||
+      (std::abs(bytesMean - 0.5*(nRanks + 1)) > 1.0e-6))
+      {
+      SENSEI_ERROR("Wrong bytes at step " << step << " " << bytesMin << " "
+        << bytesMax << " " << bytesMean)
+      return -1;
+      }
+
+    step += 1;
+    }
+
+  // the activities change after the first step
+  if ((nHeaders != 2) || (step != nSteps))
+    {
+    SENSEI_ERROR("Found " << nHeaders << " headers and " << step
+      << " records, expected 2 and " << nSteps)
+    return -1;
+    }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  std::string prefix = argc > 1 ? argv[1] : "testProfilerTelemetry";
+  bool useSocket = (argc > 2) && (strcmp(argv[2], "socket") == 0);
+  bool mismatch = (argc > 2) && (strcmp(argv[2], "mismatch") == 0);
+
+  // rank 0 stands in for the collector
+  std::string dest = prefix + "_telemetry.csv";
+  int listener = -1;
+  if (useSocket)
+    {
+    std::string path = prefix + "_telemetry.sock";
+    dest = "unix:" + path;
+
+    if (rank == 0)
+      {
+      unlink(path.c_str());
+
+      struct sockaddr_un addr;
+      memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+      listener = socket(AF_UNIX, SOCK_STREAM, 0);
+      if ((listener < 0) || bind(listener, (struct sockaddr*)&addr,
+        sizeof(addr)) || listen(listener, 1))
+        {
+        SENSEI_ERROR("Failed to listen on \"" << path << "\"")
+        MPI_Abort(MPI_COMM_WORLD, -1);
+        }
+      }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+  // telemetry alone, no events are logged
+  sensei::Profiler::SetCommunicator(MPI_COMM_WORLD);
+  sensei::Profiler::SetTelemetryStream(dest);
+  sensei::Profiler::Enable(0x10);
+  sensei::Profiler::Initialize();
+
+  // the activities are added in a different order on odd ranks. no record
+  // is made and all ranks report it, rather than reducing mismatched values
+  if (mismatch)
+    {
+    const char *names[2] = {"a", "b"};
+    sensei::Profiler::AddStepTime(names[rank % 2], 1.0);
+    sensei::Profiler::AddStepTime(names[(rank + 1) % 2], 2.0);
+
+    int status = sensei::Profiler::EndStep(MPI_COMM_WORLD, 0, 0.0) ? 0 : -1;
+
+    sensei::Profiler::Finalize();
+
+    std::ifstream ifs(dest);
+    if ((rank == 0) && ifs.good() && (ifs.peek() != EOF))
+      {
+      SENSEI_ERROR("A record was made from mismatched activities")
+      status = -1;
+      }
+
+    int globalStatus = 0;
+    MPI_Allreduce(&status, &globalStatus, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+    if ((rank == 0) && !globalStatus)
+      std::cerr << "Profiler telemetry passed" << std::endl;
+
+    MPI_Finalize();
+
+    return globalStatus;
+    }
+
+  int nSteps = 4;
+  for (int step = 0; step < nSteps; ++step)
+    {
+    auto t0 = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2*(rank + 1)));
+    std::chrono::duration<double> dt = std::chrono::steady_clock::now() - t0;
+
+    sensei::Profiler::AddStepTime("work", dt.count());
+
+    if (step % 2)
+      sensei::Profiler::AddStepTime("io", 1.0e-3);
+
+    sensei::Profiler::StartEvent("write");
+    sensei::Profiler::EndEvent("write", rank + 1);
+
+    sensei::Profiler::EndStep(MPI_COMM_WORLD, step, 0.5*step);
+    }
+
+  sensei::Profiler::Finalize();
+
+  int status = 0;
+  if (rank == 0)
+    {
+    std::string text;
+    if (useSocket)
+      {
+      // the records are held in the socket until accepted
+      int sock = accept(listener, nullptr, nullptr);
+      char buf[4096];
+      ssize_t n = 0;
+      while ((sock >= 0) && ((n = read(sock, buf, sizeof(buf))) > 0))
+        text.append(buf, n);
+
+      if (sock >= 0)
+        close(sock);
+      close(listener);
+      unlink(dest.substr(5).c_str());
+      }
+    else
+      {
+      std::ifstream ifs(dest);
+      std::ostringstream oss;
+      oss << ifs.rdbuf();
+      text = oss.str();
+      }
+
+    status = checkRecords(text, nSteps, nRanks);
+    }
+
+  MPI_Bcast(&status, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  if ((rank == 0) && !status)
+    std::cerr << "Profiler telemetry passed" << std::endl;
+
+  MPI_Finalize();
+
+  return status;
+}
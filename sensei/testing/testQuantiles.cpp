@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include "Error.h"
+#include "Quantiles.h"
+#include "SVTKDataAdaptor.h"
+
+// the global sequence is a permutation of 0, 1, ..., gSequenceLen - 1 so
+// that the value at quantile q is q*(gSequenceLen - 1)
+long gSequenceLen = 100000;
+long gStride = 7919;
+
+int validate(const sensei::Quantiles::Data &result, int nQuantiles)
+{
+  if (result.Count != gSequenceLen)
+    {
+    SENSEI_ERROR("Wrong count " << result.Count << " expected " << gSequenceLen)
+    return -1;
+    }
+
+  if ((result.Min != 0.0) || (result.Max != gSequenceLen - 1))
+    {
+    SENSEI_ERROR("Wrong range [" << result.Min << ", " << result.Max << "]")
+    return -1;
+    }
+
+  if ((int(result.Quantile.size()) != nQuantiles) ||
+    (int(result.Value.size()) != nQuantiles))
+    {
+    SENSEI_ERROR("Wrong number of quantiles " << result.Quantile.size())
+    return -1;
+    }
+
+  // with a compression of 100 the estimates are well within 1% of the range
+  double tol = 0.01 * gSequenceLen;
+  for (int i = 0; i < nQuantiles; ++i)
+    {
+    double expected = result.Quantile[i] * (gSequenceLen - 1);
+    if (std::fabs(result.Value[i] - expected) > tol)
+      {
+      SENSEI_ERROR("Quantile " << result.Quantile[i] << " is "
+        << result.Value[i] << " expected " << expected)
+      return -1;
+      }
+    }
+
+  // the fraction of the sequence less than or equal to x is (x + 1)/n
+  size_t nThresholds = result.Threshold.size();
+  if (result.Probability.size() != nThresholds)
+    {
+    SENSEI_ERROR("Wrong number of CDF values " << result.Probability.size())
+    return -1;
+    }
+
+  for (size_t i = 0; i < nThresholds; ++i)
+    {
+    double x = result.Threshold[i];
+    double expected = std::min(1.0, std::max(0.0,
+      (std::floor(x) + 1.0) / gSequenceLen));
+    if (std::fabs(result.Probability[i] - expected) > 0.01)
+      {
+      SENSEI_ERROR("CDF at " << x << " is " << result.Probability[i]
+        << " expected " << expected)
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+// parses the CSV written over nSteps steps and checks each row against the
+// result. quantile and cdf rows are told apart by the kind column
+int validateFile(const std::string &fileName,
+  const sensei::Quantiles::Data &result, int nSteps)
+{
+  std::ifstream file(fileName);
+  if (!file)
+    {
+    SENSEI_ERROR("Failed to open \"" << fileName << "\"")
+    return -1;
+    }
+
+  int nHeaders = 0;
+  std::vector<int> nQuantileRows(nSteps, 0);
+  std::vector<int> nCDFRows(nSteps, 0);
+
+  std::string line;
+  while (std::getline(file, line))
+    {
+    if (line.empty())
+      continue;
+
+    if (line[0] == '#')
+      {
+      ++nHeaders;
+      continue;
+      }
+
+    std::vector<std::string> cols;
+    std::istringstream iss(line);
+    std::string col;
+    while (std::getline(iss, col, ','))
+      cols.push_back(col.substr(col.find_first_not_of(' ')));
+
+    long step = -1;
+    if ((cols.size() != 8) || ((step = std::stol(cols[0])) < 0) ||
+      (step >= nSteps) || (cols[2] != "mesh") || (cols[3] != "uniform") ||
+      (std::stol(cols[4]) != result.Count))
+      {
+      SENSEI_ERROR("Malformed row \"" << line << "\"")
+      return -1;
+      }
+
+    double p = std::stod(cols[6]);
+    double v = std::stod(cols[7]);
+
+    if (cols[5] == "quantile")
+      {
+      int i = nQuantileRows[step]++;
+      if ((i >= int(result.Quantile.size())) ||
+        (std::fabs(p - result.Quantile[i]) > 1e-6) ||
+        (std::fabs(v - result.Value[i]) > 1e-6*gSequenceLen))
+        {
+        SENSEI_ERROR("Quantile row \"" << line << "\" does not match the result")
+        return -1;
+        }
+      }
+    else if (cols[5] == "cdf")
+      {
+      int i = nCDFRows[step]++;
+      if ((i >= int(result.Threshold.size())) ||
+        (std::fabs(p - result.Probability[i]) > 1e-6) ||
+        (v != result.Threshold[i]))
+        {
+        SENSEI_ERROR("CDF row \"" << line << "\" does not match the result")
+        return -1;
+        }
+      }
+    else
+      {
+      SENSEI_ERROR("Unknown kind \"" << cols[5] << "\"")
+      return -1;
+      }
+    }
+
+  if (nHeaders != 1)
+    {
+    SENSEI_ERROR("Found " << nHeaders << " headers, expected 1")
+    return -1;
+    }
+
+  for (int i = 0; i < nSteps; ++i)
+    {
+    if ((nQuantileRows[i] != int(result.Quantile.size())) ||
+      (nCDFRows[i] != int(result.Threshold.size())))
+      {
+      SENSEI_ERROR("Step " << i << " has " << nQuantileRows[i]
+        << " quantile rows and " << nCDFRows[i] << " cdf rows")
+      return -1;
+      }
+    }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  // partition the sequence
+  long blockSize = gSequenceLen/nRanks;
+  long nLarge = gSequenceLen%nRanks;
+  long nLocal = blockSize + (rank < nLarge ? 1 : 0);
+  long start = rank*blockSize + (rank < nLarge ? rank : nLarge);
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetNumberOfTuples(nLocal);
+  da->SetName("uniform");
+  for (long i = 0; i < nLocal; ++i)
+    da->SetValue(i, ((start + i)*gStride) % gSequenceLen);
+
+  svtkImageData *im = svtkImageData::New();
+  im->SetDimensions(nLocal, 1, 1);
+  im->GetPointData()->AddArray(da);
+  da->Delete();
+
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetDataObject("mesh", im);
+  im->Delete();
+
+  int nQuantiles = 21;
+  int nSteps = 2;
+
+  std::string fileName = "testQuantiles_" + std::to_string(nRanks) + ".csv";
+
+  sensei::Quantiles *analysisAdaptor = sensei::Quantiles::New();
+  analysisAdaptor->Initialize("mesh", svtkDataObject::POINT, "uniform",
+    nQuantiles, 100.0, fileName);
+
+  // including values outside of the range
+  std::vector<double> thresholds{-1.0, 10.0, 0.25*gSequenceLen,
+    0.5*gSequenceLen, 0.9*gSequenceLen, 0.999*gSequenceLen, 2.0*gSequenceLen};
+  analysisAdaptor->SetThresholds(thresholds);
+
+  for (int i = 0; i < nSteps; ++i)
+    {
+    dataAdaptor->SetDataTimeStep(i);
+    dataAdaptor->SetDataTime(i);
+    analysisAdaptor->Execute(dataAdaptor, nullptr);
+    }
+  dataAdaptor->Delete();
+
+  int status = 0;
+  if (rank == 0)
+    {
+    sensei::Quantiles::Data result;
+    analysisAdaptor->GetQuantiles(result);
+    status = validate(result, nQuantiles);
+
+    if (!status && (result.Threshold != thresholds))
+      {
+      SENSEI_ERROR("Wrong thresholds")
+      status = -1;
+      }
+
+    if (!status)
+      status = validateFile(fileName, result, nSteps);
+    }
+
+  analysisAdaptor->Finalize();
+  analysisAdaptor->Delete();
+
+  MPI_Finalize();
+
+  return status;
+}
@@ -0,0 +1,221 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include <svtkRectilinearGrid.h>
+#include "Error.h"
+#include "RayCastRenderer.h"
+#include "SVTKDataAdaptor.h"
+
+// the number of cells in each direction of the global mesh
+const int gN = 32;
+
+// the distance from the center of the unit cube
+double field(double x, double y, double z)
+{
+  return std::sqrt((x - 0.5)*(x - 0.5) + (y - 0.4)*(y - 0.4) + (z - 0.6)*(z - 0.6));
+}
+
+// a slab of points [k0, k1] along the z-axis as image data
+svtkDataObject *newImage(int k0, int k1)
+{
+  double dx = 1.0/gN;
+
+  svtkImageData *im = svtkImageData::New();
+  im->SetOrigin(0.0, 0.0, 0.0);
+  im->SetSpacing(dx, dx, dx);
+  im->SetExtent(0, gN, 0, gN, k0, k1);
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetName("data");
+  da->SetNumberOfTuples(im->GetNumberOfPoints());
+
+  long q = 0;
+  for (int k = k0; k <= k1; ++k)
+    for (int j = 0; j <= gN; ++j)
+      for (int i = 0; i <= gN; ++i, ++q)
+        da->SetValue(q, field(i*dx, j*dx, k*dx));
+
+  im->GetPointData()->AddArray(da);
+  da->Delete();
+
+  return im;
+}
+
+// the whole mesh as a rectilinear grid
+svtkDataObject *newRectilinear()
+{
+  double dx = 1.0/gN;
+
+  svtkDoubleArray *x = svtkDoubleArray::New();
+  x->SetNumberOfTuples(gN + 1);
+  for (int i = 0; i <= gN; ++i)
+    x->SetValue(i, i*dx);
+
+  svtkRectilinearGrid *rg = svtkRectilinearGrid::New();
+  rg->SetDimensions(gN + 1, gN + 1, gN + 1);
+  rg->SetXCoordinates(x);
+  rg->SetYCoordinates(x);
+  rg->SetZCoordinates(x);
+  x->Delete();
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetName("data");
+  da->SetNumberOfTuples(rg->GetNumberOfPoints());
+
+  long q = 0;
+  for (int k = 0; k <= gN; ++k)
+    for (int j = 0; j <= gN; ++j)
+      for (int i = 0; i <= gN; ++i, ++q)
+        da->SetValue(q, field(i*dx, j*dx, k*dx));
+
+  rg->GetPointData()->AddArray(da);
+  da->Delete();
+
+  return rg;
+}
+
+// render the mesh, returns the image on rank 0
+std::vector<unsigned char> render(MPI_Comm comm, svtkDataObject *mesh,
+  int mode, const std::string &camera, int radix, const std::string &prefix)
+{
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetCommunicator(comm);
+  dataAdaptor->SetDataObject("mesh", mesh);
+  dataAdaptor->SetDataTimeStep(0);
+  dataAdaptor->SetDataTime(0.0);
+
+  sensei::RayCastRenderer *renderer = sensei::RayCastRenderer::New();
+  renderer->SetCommunicator(comm);
+  renderer->SetMeshName("mesh");
+  renderer->SetArrayName("data");
+  renderer->SetMode(mode);
+  renderer->SetImageSize(96, 64);
+  renderer->SetScalarRange(0.0, 0.8);
+  renderer->SetOpacity(4.0);
+  renderer->SetIsoValue(0.3);
+  renderer->SetSlice(2, 0.55);
+  renderer->SetCameraConfig(camera);
+  renderer->SetNumberOfThreads(2);
+  renderer->SetRadix(radix);
+  renderer->SetFilePrefix(prefix);
+
+  if (!renderer->Execute(dataAdaptor, nullptr))
+    {
+    SENSEI_ERROR("Failed to render")
+    MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+
+  std::vector<unsigned char> image = renderer->GetImage();
+
+  renderer->Finalize();
+  renderer->Delete();
+
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+
+  return image;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  // the number of partners in each round of compositing
+  int radix = argc > 1 ? atoi(argv[1]) : 0;
+  radix = radix < 2 ? 2 : radix;
+
+  // each rank has a slab of the mesh. the slabs share their boundary points
+  int k0 = rank*gN/nRanks;
+  int k1 = (rank + 1)*gN/nRanks;
+
+  svtkDataObject *slab = newImage(k0, k1);
+  // the adaptors are created collectively on the world communicator, hence
+  // all ranks render the whole mesh on their own
+  svtkDataObject *whole = newRectilinear();
+
+  const char *modeNames[] = {"volume", "isosurface", "slice"};
+  const char *cameras[] = {"none", "spherical:0.5,0.5,0.5:0.5,0.5,3:0,1,0:45:30"};
+
+  int status = 0;
+  for (int mode = 0; mode < 3; ++mode)
+    {
+    for (int cam = 0; cam < 2; ++cam)
+      {
+      // render in parallel, and the whole mesh serially, and compare.
+      // without ghost cells the isosurface normals are one sided differences
+      // at the faces of the blocks so small differences are expected there
+      std::string prefix = (mode == 1) && (cam == 1) ? "testRayCastRenderer" : "";
+
+      std::vector<unsigned char> par =
+        render(MPI_COMM_WORLD, slab, mode, cameras[cam], radix, prefix);
+
+      std::vector<unsigned char> ref =
+        render(MPI_COMM_SELF, whole, mode, cameras[cam], 2, "");
+
+      if (rank == 0)
+        {
+        long n = ref.size();
+        long nDiff = 0;
+        long nLit = 0;
+        int maxDiff = 0;
+        for (long i = 0; i < n; ++i)
+          {
+          int diff = std::abs(int(par[i]) - int(ref[i]));
+          maxDiff = std::max(maxDiff, diff);
+          nDiff += diff > 2 ? 1 : 0;
+          nLit += (i % 4 != 3) && ref[i] ? 1 : 0;
+          }
+
+        std::cerr << modeNames[mode] << " view " << cam << " " << nLit
+          << " lit values, max difference " << maxDiff << std::endl;
+
+        int tol = mode == sensei::RayCastRenderer::MODE_ISOSURFACE ? 8 : 2;
+        if ((n != 4*96*64) || (maxDiff > tol) || (nDiff > n/100) || (nLit < n/50))
+          {
+          SENSEI_ERROR(<< modeNames[mode] << " view " << cam << " the parallel"
+            " image differs from the serial one in " << nDiff << " values, by"
+            " at most " << maxDiff)
+          status = -1;
+          }
+        }
+      }
+    }
+
+  // check that the image was written
+  if (rank == 0)
+    {
+    unsigned char sig[8] = {0};
+    FILE *fh = fopen("testRayCastRenderer_0_0.png", "rb");
+    if (!fh || (fread(sig, 1, 8, fh) != 8) || (sig[1] != 'P') ||
+      (sig[2] != 'N') || (sig[3] != 'G'))
+      {
+      SENSEI_ERROR("The PNG image was not written")
+      status = -1;
+      }
+
+    if (fh)
+      fclose(fh);
+
+    remove("testRayCastRenderer_0_0.png");
+    }
+
+  slab->Delete();
+  whole->Delete();
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
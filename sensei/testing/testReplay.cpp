@@ -0,0 +1,400 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <svtkCellArray.h>
+#include <svtkCellData.h>
+#include <svtkDataArray.h>
+#include <svtkDoubleArray.h>
+#include <svtkFloatArray.h>
+#include <svtkIdList.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkPoints.h>
+#include <svtkUnstructuredGrid.h>
+#include "Error.h"
+#include "MeshMetadata.h"
+#include "ProgrammableDataAdaptor.h"
+#include "ReplayAnalysisAdaptor.h"
+#include "ReplayDataAdaptor.h"
+#include "ReplaySchema.h"
+#include "SVTKUtils.h"
+#include "TestUtils.h"
+
+const int gNumSteps = 3;
+
+// the value of element i of block b at step s
+double value(int s, int b, int i, int c)
+{
+  double v = s + 10.0*b + 1000.0*i;
+  return c ? -v : v;
+}
+
+// even blocks are image data, odd blocks are unstructured grids of two
+// tetrahedra. the structure does not change in time, the arrays do
+svtkDataSet *newBlock(int s, int b)
+{
+  svtkDataSet *ds = nullptr;
+  if (b % 2 == 0)
+    {
+    svtkImageData *im = svtkImageData::New();
+    im->SetOrigin(b, 0.0, 0.0);
+    im->SetSpacing(0.5, 0.25, 1.0);
+    im->SetExtent(0, 3, 0, 2, 0, 1);
+    ds = im;
+    }
+  else
+    {
+    double x[5][3] = {{0., 0., 0.}, {1., 0., 0.}, {0., 1., 0.},
+      {0., 0., 1.}, {1., 1., 1.}};
+
+    svtkPoints *pts = svtkPoints::New();
+    for (int i = 0; i < 5; ++i)
+      pts->InsertNextPoint(x[i][0] + b, x[i][1], x[i][2]);
+
+    svtkUnstructuredGrid *ug = svtkUnstructuredGrid::New();
+    ug->SetPoints(pts);
+    pts->Delete();
+
+    svtkIdType cells[2][4] = {{0, 1, 2, 3}, {1, 2, 3, 4}};
+    ug->Allocate(2);
+    for (int i = 0; i < 2; ++i)
+      ug->InsertNextCell(SVTK_TETRA, 4, cells[i]);
+
+    ds = ug;
+    }
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetName("data");
+  da->SetNumberOfComponents(2);
+  for (svtkIdType i = 0; i < ds->GetNumberOfCells(); ++i)
+    {
+    double v[2] = {value(s, b, i, 0), value(s, b, i, 1)};
+    da->InsertNextTuple(v);
+    }
+  ds->GetCellData()->AddArray(da);
+  da->Delete();
+
+  svtkFloatArray *pda = svtkFloatArray::New();
+  pda->SetName("pdata");
+  for (svtkIdType i = 0; i < ds->GetNumberOfPoints(); ++i)
+    pda->InsertNextValue(value(s, b, i, 0));
+  ds->GetPointData()->AddArray(pda);
+  pda->Delete();
+
+  return ds;
+}
+
+// the blocks 2*rank and 2*rank + 1 of step s
+svtkMultiBlockDataSet *newMesh(int s, int rank, int nRanks)
+{
+  return sensei::TestUtils::NewTwoBlocksPerRank(rank, nRanks,
+    [&](int b) -> svtkDataObject* { return newBlock(s, b); });
+}
+
+// compare the structure and arrays of a replayed block to the original
+int checkBlock(svtkDataSet *ds, int s, int b)
+{
+  if (!ds)
+    {
+    SENSEI_ERROR("Block " << b << " of step " << s << " is missing")
+    return -1;
+    }
+
+  svtkDataSet *ref = newBlock(s, b);
+  int status = 0;
+
+  if ((ds->GetDataObjectType() != ref->GetDataObjectType()) ||
+    (ds->GetNumberOfPoints() != ref->GetNumberOfPoints()) ||
+    (ds->GetNumberOfCells() != ref->GetNumberOfCells()))
+    {
+    SENSEI_ERROR("Block " << b << " of step " << s << " has the wrong structure")
+    ref->Delete();
+    return -1;
+    }
+
+  for (svtkIdType i = 0; i < ref->GetNumberOfPoints(); ++i)
+    {
+    double x[3], y[3];
+    ds->GetPoint(i, x);
+    ref->GetPoint(i, y);
+    if ((x[0] != y[0]) || (x[1] != y[1]) || (x[2] != y[2]))
+      {
+      SENSEI_ERROR("Block " << b << " point " << i << " is at " << x[0]
+        << ", " << x[1] << ", " << x[2])
+      status = -1;
+      }
+    }
+
+  svtkIdList *ids = svtkIdList::New();
+  svtkIdList *refIds = svtkIdList::New();
+  for (svtkIdType i = 0; i < ref->GetNumberOfCells(); ++i)
+    {
+    ds->GetCellPoints(i, ids);
+    ref->GetCellPoints(i, refIds);
+    bool same = ids->GetNumberOfIds() == refIds->GetNumberOfIds();
+    for (svtkIdType j = 0; same && (j < ids->GetNumberOfIds()); ++j)
+      same = ids->GetId(j) == refIds->GetId(j);
+    if (!same || (ds->GetCellType(i) != ref->GetCellType(i)))
+      {
+      SENSEI_ERROR("Block " << b << " cell " << i << " differs")
+      status = -1;
+      }
+    }
+  ids->Delete();
+  refIds->Delete();
+
+  int assocs[2] = {svtkDataObject::POINT, svtkDataObject::CELL};
+  const char *names[2] = {"pdata", "data"};
+  for (int q = 0; q < 2; ++q)
+    {
+    svtkDataArray *da = ds->GetAttributes(assocs[q])->GetArray(names[q]);
+    svtkDataArray *refDa = ref->GetAttributes(assocs[q])->GetArray(names[q]);
+    if (!da || (da->GetDataType() != refDa->GetDataType()) ||
+      (da->GetNumberOfTuples() != refDa->GetNumberOfTuples()) ||
+      (da->GetNumberOfComponents() != refDa->GetNumberOfComponents()))
+      {
+      SENSEI_ERROR("Block " << b << " of step " << s << " array \""
+        << names[q] << "\" is missing or has the wrong type")
+      status = -1;
+      continue;
+      }
+
+    // served zero copy from the mapped, aligned recording
+    if (reinterpret_cast<uintptr_t>(da->GetVoidPointer(0)) %
+      sensei::ReplaySchema::Alignment)
+      {
+      SENSEI_ERROR("Block " << b << " array \"" << names[q] << "\" is not aligned")
+      status = -1;
+      }
+
+    for (svtkIdType i = 0; i < refDa->GetNumberOfTuples(); ++i)
+      for (int c = 0; c < refDa->GetNumberOfComponents(); ++c)
+        {
+        if (da->GetComponent(i, c) != refDa->GetComponent(i, c))
+          {
+          SENSEI_ERROR("Block " << b << " of step " << s << " array \""
+            << names[q] << "\" value " << i << " is " << da->GetComponent(i, c))
+          status = -1;
+          }
+        }
+    }
+
+  ref->Delete();
+
+  return status;
+}
+
+// serve the whole recording, checking every block this rank receives
+int checkReplay(MPI_Comm comm, int nRecRanks)
+{
+  int rank = 0;
+  MPI_Comm_rank(comm, &rank);
+
+  sensei::ReplayDataAdaptor *replay = sensei::ReplayDataAdaptor::New();
+  replay->SetCommunicator(comm);
+  replay->SetFileName("./testReplay");
+
+  if (replay->OpenStream())
+    {
+    replay->Delete();
+    return -1;
+    }
+
+  int status = 0;
+  int s = 0;
+  do
+    {
+    if ((replay->GetDataTimeStep() != 10 + s) ||
+      (replay->GetDataTime() != 0.5*s))
+      {
+      SENSEI_ERROR("Step " << s << " has time step " << replay->GetDataTimeStep()
+        << " time " << replay->GetDataTime())
+      status = -1;
+      }
+
+    sensei::MeshMetadataPtr md = sensei::MeshMetadata::New();
+    if (replay->GetMeshMetadata(0, md) || (md->MeshName != "mesh") ||
+      (md->NumBlocks != 2*nRecRanks) || !md->StaticMesh)
+      {
+      SENSEI_ERROR("The metadata of step " << s << " is wrong")
+      status = -1;
+      break;
+      }
+
+    std::vector<long> ids;
+    sensei::SVTKUtils::GetLocalBlockIds(rank, md, ids);
+
+    svtkDataObject *mesh = nullptr;
+    if (replay->GetMesh("mesh", false, mesh) ||
+      replay->AddGhostCellsArray(mesh, "mesh") ||
+      replay->AddArray(mesh, "mesh", svtkDataObject::POINT, "pdata") ||
+      replay->AddArray(mesh, "mesh", svtkDataObject::CELL, "data"))
+      {
+      SENSEI_ERROR("Failed to replay step " << s)
+      status = -1;
+      break;
+      }
+
+    for (size_t i = 0; i < ids.size(); ++i)
+      {
+      svtkDataSet *ds = sensei::SVTKUtils::GetBlock(mesh, ids[i]);
+      status |= checkBlock(ds, s, ids[i]);
+
+      // the block API serves the same memory
+      svtkDataObject *block = nullptr;
+      if (replay->GetMeshBlock("mesh", ids[i], false, block) ||
+        replay->AddArrayToBlock(block, "mesh", ids[i], svtkDataObject::POINT, "pdata") ||
+        replay->AddArrayToBlock(block, "mesh", ids[i], svtkDataObject::CELL, "data"))
+        {
+        SENSEI_ERROR("Failed to get block " << ids[i] << " of step " << s)
+        status = -1;
+        }
+      else if (checkBlock(static_cast<svtkDataSet*>(block), s, ids[i]) ||
+        (static_cast<svtkDataSet*>(block)->GetCellData()->GetArray("data")->GetVoidPointer(0) !=
+        ds->GetCellData()->GetArray("data")->GetVoidPointer(0)))
+        {
+        SENSEI_ERROR("Block " << ids[i] << " of step " << s << " differs")
+        status = -1;
+        }
+
+      if (block)
+        block->Delete();
+      }
+
+    replay->ReleaseMeshBlocks();
+    replay->ReleaseData();
+    mesh->Delete();
+
+    s += 1;
+    }
+  while (!replay->AdvanceStream());
+
+  if (s != gNumSteps)
+    {
+    SENSEI_ERROR("Replayed " << s << " steps, expected " << gNumSteps)
+    status = -1;
+    }
+
+  replay->CloseStream();
+  replay->Finalize();
+  replay->Delete();
+
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  // a simulation whose mesh is flagged static
+  int step = 0;
+
+  sensei::ProgrammableDataAdaptor *sim = sensei::ProgrammableDataAdaptor::New();
+  sim->SetCommunicator(MPI_COMM_WORLD);
+
+  sim->SetGetNumberOfMeshesCallback([](unsigned int &n) -> int
+    {
+    n = 1;
+    return 0;
+    });
+
+  sim->SetGetMeshMetadataCallback([&](unsigned int, sensei::MeshMetadataPtr &md) -> int
+    {
+    svtkMultiBlockDataSet *mb = newMesh(step, rank, nRanks);
+    md->MeshName = "mesh";
+    int ierr = sensei::SVTKUtils::GetMetadata(MPI_COMM_WORLD, mb, md);
+    md->StaticMesh = 1;
+    mb->Delete();
+    return ierr;
+    });
+
+  sim->SetGetMeshCallback([&](const std::string &, bool, svtkDataObject *&mesh) -> int
+    {
+    mesh = newMesh(step, rank, nRanks);
+    return 0;
+    });
+
+  sim->SetAddArrayCallback([](svtkDataObject *, const std::string &, int,
+    const std::string &) -> int
+    {
+    return 0;
+    });
+
+  sim->SetReleaseDataCallback([]() -> int { return 0; });
+
+  // record, the last step is past the number requested and is skipped
+  sensei::ReplayAnalysisAdaptor *recorder = sensei::ReplayAnalysisAdaptor::New();
+  recorder->SetCommunicator(MPI_COMM_WORLD);
+  recorder->SetFileName("testReplay");
+  recorder->SetNumberOfSteps(gNumSteps);
+
+  for (step = 0; step <= gNumSteps; ++step)
+    {
+    sim->SetDataTimeStep(10 + step);
+    sim->SetDataTime(0.5*step);
+
+    if (!recorder->Execute(sim, nullptr))
+      {
+      SENSEI_ERROR("Failed to record step " << step)
+      MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+    }
+
+  recorder->Finalize();
+  recorder->Delete();
+  sim->Delete();
+
+  MPI_Barrier(MPI_COMM_WORLD);
+
+  // the structure of the static blocks is written once
+  int status = 0;
+  sensei::ReplaySchema::Reader reader;
+  if (reader.Open(sensei::ReplaySchema::GetFileName("./testReplay", rank)))
+    {
+    status = -1;
+    }
+  else
+    {
+    const sensei::ReplaySchema::BlockRecord *b0 =
+      reader.GetStep().GetMesh("mesh")->GetBlock(2*rank + 1);
+    uint64_t points = b0->Structure[0].Offset;
+    uint64_t data = b0->Arrays[0].Offset;
+
+    reader.Seek(gNumSteps - 1);
+    const sensei::ReplaySchema::BlockRecord *b2 =
+      reader.GetStep().GetMesh("mesh")->GetBlock(2*rank + 1);
+
+    if ((b2->Structure[0].Offset != points) || (b2->Arrays[0].Offset == data) ||
+      !reader.Good() || !reader.Advance())
+      {
+      SENSEI_ERROR("The recording of rank " << rank << " has the wrong layout")
+      status = -1;
+      }
+    }
+
+  // replay where the blocks were recorded
+  status |= checkReplay(MPI_COMM_WORLD, nRanks);
+
+  // replay all of the blocks on one rank, reading every rank's recording
+  if (rank == 0)
+    status |= checkReplay(MPI_COMM_SELF, nRanks);
+
+  MPI_Allreduce(MPI_IN_PLACE, &status, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+  if (rank == 0)
+    std::cerr << "testReplay " << (status ? "failed" : "passed") << std::endl;
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
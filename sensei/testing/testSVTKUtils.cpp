@@ -0,0 +1,286 @@
+#include <array>
+#include <iostream>
+#include <vector>
+#include <mpi.h>
+#include <svtkCellData.h>
+#include <svtkDataArray.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include <svtkUnsignedCharArray.h>
+#include "Error.h"
+#include "MeshMetadata.h"
+#include "SVTKDataAdaptor.h"
+#include "SVTKUtils.h"
+
+// the number of leaves in the test mesh
+const int gNumLeaves = 5;
+
+// an image of n points in x with values that don't sum exactly in floating
+// point
+svtkImageData *newImage(int id, int n)
+{
+  svtkImageData *im = svtkImageData::New();
+  im->SetOrigin(id, 0.0, 0.0);
+  im->SetSpacing(1.0/n, 1.0, 1.0);
+  im->SetExtent(0, n - 1, 0, 1, 0, 1);
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetName("data");
+  da->SetNumberOfTuples(im->GetNumberOfPoints());
+  for (long i = 0; i < im->GetNumberOfPoints(); ++i)
+    da->SetValue(i, 1.0/(1.0 + id + 0.1*i));
+
+  im->GetPointData()->AddArray(da);
+  da->Delete();
+
+  return im;
+}
+
+// a multiblock with a nested multiblock and an empty block
+svtkMultiBlockDataSet *newMesh()
+{
+  svtkMultiBlockDataSet *nested = svtkMultiBlockDataSet::New();
+  nested->SetNumberOfBlocks(2);
+
+  svtkMultiBlockDataSet *mb = svtkMultiBlockDataSet::New();
+  mb->SetNumberOfBlocks(5);
+
+  int id = 0;
+  for (int i = 0; i < 5; ++i)
+    {
+    if (i == 1)
+      {
+      for (int j = 0; j < 2; ++j)
+        {
+        svtkImageData *im = newImage(id, 100*(id + 1));
+        nested->SetBlock(j, im);
+        im->Delete();
+        ++id;
+        }
+      mb->SetBlock(i, nested);
+      }
+    else if (i != 3)
+      {
+      svtkImageData *im = newImage(id, 100*(id + 1));
+      mb->SetBlock(i, im);
+      im->Delete();
+      ++id;
+      }
+    }
+
+  nested->Delete();
+
+  return mb;
+}
+
+// sums the data array of each leaf using the given number of threads
+int sum(svtkMultiBlockDataSet *mb, int nThreads, double &total, int &nLeaves)
+{
+  sensei::SVTKUtils::BlockReduction<double> sums(gNumLeaves, 0.0);
+  sensei::SVTKUtils::ThreadReduction<int> counts(nThreads, 0);
+
+  sensei::SVTKUtils::IndexedDatasetFunction func =
+    [&](int leaf, int thread, svtkDataSet *ds) -> int
+    {
+    svtkDataArray *da = ds->GetPointData()->GetArray("data");
+    for (long i = 0; i < da->GetNumberOfTuples(); ++i)
+      sums[leaf] += da->GetTuple1(i);
+    counts[thread] += 1;
+    return 0;
+    };
+
+  if (sensei::SVTKUtils::Apply(mb, func, nThreads))
+    return -1;
+
+  total = sums.Reduce(0.0, [](double a, double b) { return a + b; });
+  nLeaves = counts.Reduce(0, [](int a, int b) { return a + b; });
+
+  return 0;
+}
+
+// checks the owned extent of a block with a layer of ghost cells against
+// the ghost array generated from it
+int ownedExtent()
+{
+  int status = 0;
+
+  svtkImageData *im = svtkImageData::New();
+  im->SetExtent(2, 8, 0, 5, 0, 4);
+
+  std::array<int,6> ext;
+  std::array<int,6> ownedExt;
+  std::array<int,6> expected = {3, 6, 1, 3, 0, 3};
+
+  sensei::SVTKUtils::GetCellExtent(im, ext);
+  svtkUnsignedCharArray *ghosts = sensei::SVTKUtils::NewGhostCellsArray(ext, expected);
+  im->GetCellData()->AddArray(ghosts);
+  ghosts->Delete();
+
+  if (sensei::SVTKUtils::GetOwnedExtent(im, ownedExt) || (ownedExt != expected))
+    {
+    SENSEI_ERROR("Wrong owned extent")
+    status = -1;
+    }
+
+  // each owned cell is visited once and no ghost cell is visited
+  long nOwned = 0;
+  const unsigned char *pg = ghosts->GetPointer(0);
+  sensei::SVTKUtils::ForEachOwnedCell(ext, ownedExt, [&](long i)
+    {
+    nOwned += pg[i] ? 0 : 1;
+    });
+
+  if (nOwned != 4*3*4)
+    {
+    SENSEI_ERROR("Visited " << nOwned << " owned cells, expected 48")
+    status = -1;
+    }
+
+  // owned cells that are not a box can not be described by an extent
+  ghosts->SetValue(ghosts->GetNumberOfTuples() - 1, 0);
+  if (sensei::SVTKUtils::GetOwnedExtent(im, ownedExt) ||
+    !sensei::SVTKUtils::EmptyExtent(ownedExt))
+    {
+    SENSEI_ERROR("Irregular owned cells have an extent")
+    status = -1;
+    }
+
+  im->Delete();
+
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int status = 0;
+
+  svtkMultiBlockDataSet *mb = newMesh();
+
+  // the leaves are gathered in iteration order
+  std::vector<svtkDataSet*> serialLeaves;
+  sensei::SVTKUtils::DatasetFunction collect = [&](svtkDataSet *ds) -> int
+    {
+    serialLeaves.push_back(ds);
+    return 0;
+    };
+  sensei::SVTKUtils::Apply(mb, collect);
+
+  std::vector<svtkDataSet*> leaves;
+  if (sensei::SVTKUtils::GetLeaves(mb, leaves) ||
+    (leaves.size() != size_t(gNumLeaves)) || (leaves != serialLeaves))
+    {
+    SENSEI_ERROR("GetLeaves found " << leaves.size() << " leaves, expected "
+      << gNumLeaves << " in iteration order")
+    status = -1;
+    }
+
+  // the per leaf results are reduced in order, independent of the number of
+  // threads
+  double ref = 0.0;
+  int nLeaves = 0;
+  status |= sum(mb, 1, ref, nLeaves);
+
+  for (int nThreads = 2; nThreads <= 8; nThreads *= 2)
+    {
+    double total = 0.0;
+    status |= sum(mb, nThreads, total, nLeaves);
+    if ((total != ref) || (nLeaves != gNumLeaves))
+      {
+      SENSEI_ERROR("Sum with " << nThreads << " threads over " << nLeaves
+        << " leaves is " << total << " expected " << ref)
+      status = -1;
+      }
+    }
+
+  // a function may stop the traversal without error
+  sensei::SVTKUtils::IndexedDatasetFunction stop =
+    [](int, int, svtkDataSet*) -> int { return 1; };
+
+  if (sensei::SVTKUtils::Apply(mb, stop, 4) != 1)
+    {
+    SENSEI_ERROR("Apply did not stop")
+    status = -1;
+    }
+
+  // the metadata does not depend on the number of threads
+  sensei::MeshMetadataPtr md[2];
+  for (int i = 0; i < 2; ++i)
+    {
+    sensei::SVTKUtils::SetNumberOfThreads(i ? 4 : 1);
+    md[i] = sensei::MeshMetadata::New();
+    md[i]->Flags.SetBlockDecomp();
+    md[i]->Flags.SetBlockSize();
+    md[i]->Flags.SetBlockBounds();
+    md[i]->Flags.SetBlockArrayRange();
+    status |= sensei::SVTKUtils::GetMetadata(MPI_COMM_SELF, mb, md[i]);
+    }
+
+  if ((md[0]->NumBlocksLocal[0] != gNumLeaves) ||
+    (md[0]->BlockIds != md[1]->BlockIds) ||
+    (md[0]->BlockNumPoints != md[1]->BlockNumPoints) ||
+    (md[0]->BlockBounds != md[1]->BlockBounds) ||
+    (md[0]->BlockArrayRange != md[1]->BlockArrayRange))
+    {
+    SENSEI_ERROR("Threaded block metadata differs")
+    status = -1;
+    }
+
+  // the block index finds the same blocks as the scan, including the nested
+  // blocks, and nothing for the empty block and ids out of range
+  sensei::SVTKUtils::BlockMap blocks;
+  blocks.Initialize(mb);
+  for (long bid = -1; bid < 10; ++bid)
+    {
+    if (blocks.GetBlock(bid) != sensei::SVTKUtils::GetBlock(mb, bid))
+      {
+      SENSEI_ERROR("The block index and GetBlock differ at block " << bid)
+      status = -1;
+      }
+    }
+
+  // arrays are added to every block of the mesh using threads
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetCommunicator(MPI_COMM_SELF);
+  dataAdaptor->SetDataObject("mesh", mb);
+
+  svtkDataObject *mesh = nullptr;
+  if (dataAdaptor->GetMesh("mesh", false, mesh) ||
+    dataAdaptor->AddArray(mesh, "mesh", svtkDataObject::POINT, "data"))
+    {
+    SENSEI_ERROR("Failed to get the mesh")
+    status = -1;
+    }
+  else
+    {
+    std::vector<svtkDataSet*> meshLeaves;
+    sensei::SVTKUtils::GetLeaves(mesh, meshLeaves);
+    for (size_t i = 0; i < meshLeaves.size(); ++i)
+      {
+      if (meshLeaves[i]->GetPointData()->GetArray("data") !=
+        leaves[i]->GetPointData()->GetArray("data"))
+        {
+        SENSEI_ERROR("Array missing from block " << i)
+        status = -1;
+        }
+      }
+    mesh->Delete();
+    }
+
+  dataAdaptor->ReleaseData();
+  dataAdaptor->Delete();
+
+  mb->Delete();
+
+  status |= ownedExtent();
+
+  if (!status)
+    std::cerr << "SVTKUtils threaded apply passed" << std::endl;
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
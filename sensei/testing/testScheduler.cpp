@@ -0,0 +1,220 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <pugixml.hpp>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include "ConfigurableAnalysis.h"
+#include "Error.h"
+#include "SVTKDataAdaptor.h"
+#include "Scheduler.h"
+
+// a budget so small that only critical analyses and analyses that have not
+// been measured yet will run
+const char *gConfig =
+  "<sensei>"
+  "  <scheduler time_budget=\"1e-12\" />"
+  "  <analysis type=\"statistics\" file=\"testSchedulerCritical.csv\""
+  "    priority=\"critical\" enabled=\"1\">"
+  "    <mesh name=\"mesh\"> <point_arrays> data </point_arrays> </mesh>"
+  "  </analysis>"
+  "  <analysis type=\"statistics\" file=\"testSchedulerOptional.csv\""
+  "    priority=\"1\" enabled=\"1\">"
+  "    <mesh name=\"mesh\"> <point_arrays> data </point_arrays> </mesh>"
+  "  </analysis>"
+  "</sensei>";
+
+int validate(const char *label, long step, const std::vector<int> &run,
+  const std::vector<int> &expected)
+{
+  if (run != expected)
+    {
+    std::ostringstream oss;
+    for (size_t i = 0; i < run.size(); ++i)
+      oss << run[i] << " ";
+    SENSEI_ERROR(<< label << " step " << step << " wrong schedule " << oss.str())
+    return -1;
+    }
+  return 0;
+}
+
+long countRows(const char *fileName)
+{
+  long nRows = 0;
+  std::ifstream ifs(fileName);
+  std::string line;
+  while (std::getline(ifs, line))
+    {
+    if (!line.empty() && (line[0] != '#'))
+      ++nRows;
+    }
+  return nRows;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int status = 0;
+
+  // a fixed budget. costs are reported by each rank, the slowest rank's
+  // cost is used. one critical and three optional analyses.
+  {
+  sensei::Scheduler sched;
+  sched.SetTimeBudget(1.0);
+  sched.SetSmoothing(1.0);
+
+  sched.AddTask(sensei::Scheduler::CRITICAL);
+  sched.AddTask(1);
+  sched.AddTask(1);
+  sched.AddTask(2);
+
+  std::vector<double> cost = {0.5, 0.5, 0.5, 0.125};
+
+  // the two priority 1 analyses alternate, the priority 2 analysis is
+  // starved
+  std::vector<std::vector<int>> expected = {{1, 1, 1, 1},
+    {1, 1, 0, 0}, {1, 0, 1, 0}, {1, 1, 0, 0}};
+
+  for (long step = 0; step < long(expected.size()); ++step)
+    {
+    std::vector<int> run;
+    sched.Schedule(MPI_COMM_WORLD, run);
+
+    status |= validate("budget", step, run, expected[step]);
+
+    for (int i = 0; i < 4; ++i)
+      if (run[i])
+        sched.SetCost(i, rank == 0 ? cost[i] : 0.5*cost[i]);
+
+    sched.EndStep();
+    }
+  }
+
+  // a budget relative to the solver time. here the solver takes almost no
+  // time, hence after its cost is measured the optional analysis is
+  // deferred.
+  {
+  sensei::Scheduler sched;
+  sched.SetTimeFraction(0.5);
+
+  sched.AddTask(1);
+
+  std::vector<std::vector<int>> expected = {{1}, {0}, {0}};
+
+  for (long step = 0; step < long(expected.size()); ++step)
+    {
+    std::vector<int> run;
+    sched.Schedule(MPI_COMM_WORLD, run);
+
+    status |= validate("fraction", step, run, expected[step]);
+
+    if (run[0])
+      sched.SetCost(0, 0.1);
+
+    sched.EndStep();
+    }
+  }
+
+  // an analysis whose cost was once too high runs again after being
+  // deferred, and when it has become cheaper runs every step
+  {
+  sensei::Scheduler sched;
+  sched.SetTimeBudget(1.0);
+  sched.SetSmoothing(1.0);
+  sched.SetMaxDeferrals(2);
+
+  sched.AddTask(1);
+
+  std::vector<std::vector<int>> expected = {{1}, {0}, {0}, {1}, {1}, {1}};
+
+  for (long step = 0; step < long(expected.size()); ++step)
+    {
+    std::vector<int> run;
+    sched.Schedule(MPI_COMM_WORLD, run);
+
+    status |= validate("deferrals", step, run, expected[step]);
+
+    if (run[0])
+      sched.SetCost(0, step ? 0.1 : 2.0);
+
+    sched.EndStep();
+    }
+  }
+
+  // the scheduler driven by ConfigurableAnalysis
+  pugi::xml_document doc;
+  if (!doc.load_string(gConfig))
+    {
+    SENSEI_ERROR("Failed to parse the configuration")
+    MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+
+  sensei::ConfigurableAnalysis *analysis = sensei::ConfigurableAnalysis::New();
+  analysis->SetCommunicator(MPI_COMM_WORLD);
+  analysis->Initialize(doc.child("sensei"));
+
+  long nLocal = 100;
+  long nSteps = 4;
+  for (long step = 0; step < nSteps; ++step)
+    {
+    svtkDoubleArray *da = svtkDoubleArray::New();
+    da->SetNumberOfTuples(nLocal);
+    da->SetName("data");
+    for (long i = 0; i < nLocal; ++i)
+      da->SetValue(i, rank*nLocal + i + step);
+
+    svtkImageData *im = svtkImageData::New();
+    im->SetDimensions(nLocal, 1, 1);
+    im->GetPointData()->AddArray(da);
+    da->Delete();
+
+    sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+    dataAdaptor->SetDataObject("mesh", im);
+    dataAdaptor->SetDataTimeStep(step);
+    dataAdaptor->SetDataTime(0.1*step);
+    im->Delete();
+
+    analysis->Execute(dataAdaptor, nullptr);
+
+    dataAdaptor->ReleaseData();
+    dataAdaptor->Delete();
+    }
+
+  analysis->Finalize();
+  analysis->Delete();
+
+  // the critical analysis ran every step, the optional one only ran on the
+  // first step when its cost was unknown
+  if (rank == 0)
+    {
+    long nCritical = countRows("testSchedulerCritical.csv");
+    long nOptional = countRows("testSchedulerOptional.csv");
+
+    if ((nCritical != nSteps) || (nOptional != 1))
+      {
+      SENSEI_ERROR("The critical analysis ran " << nCritical << " of "
+        << nSteps << " steps and the optional analysis ran " << nOptional
+        << " steps, expected " << nSteps << " and 1")
+      status = -1;
+      }
+
+    remove("testSchedulerCritical.csv");
+    remove("testSchedulerOptional.csv");
+    }
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
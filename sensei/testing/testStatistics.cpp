@@ -0,0 +1,155 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <mpi.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include "Error.h"
+#include "DescriptiveStatistics.h"
+#include "SVTKDataAdaptor.h"
+
+// the global sequence is 0, 1, ..., gSequenceLen - 1 in the first component
+// and 2i + 1 in the second component. this is a discrete uniform
+// distribution with known moments.
+unsigned int gSequenceLen = 1001;
+
+int validate(const sensei::DescriptiveStatistics::Data &stats,
+  double scale, double offset)
+{
+  double n = gSequenceLen;
+  double mean = scale * (n - 1.0) / 2.0 + offset;
+  double var = scale * scale * n * (n + 1.0) / 12.0;
+  double kurt = -6.0 * (n*n + 1.0) / (5.0 * (n*n - 1.0));
+  double minv = offset;
+  double maxv = scale * (n - 1.0) + offset;
+
+  if (stats.Count != long(gSequenceLen))
+    {
+    SENSEI_ERROR("Component " << stats.Component << " wrong count "
+      << stats.Count << " expected " << gSequenceLen)
+    return -1;
+    }
+
+  if (std::fabs(stats.Mean - mean) > 1.0e-9 * mean)
+    {
+    SENSEI_ERROR("Component " << stats.Component << " wrong mean "
+      << stats.Mean << " expected " << mean)
+    return -1;
+    }
+
+  if (std::fabs(stats.Variance - var) > 1.0e-9 * var)
+    {
+    SENSEI_ERROR("Component " << stats.Component << " wrong variance "
+      << stats.Variance << " expected " << var)
+    return -1;
+    }
+
+  if (std::fabs(stats.Skewness) > 1.0e-9)
+    {
+    SENSEI_ERROR("Component " << stats.Component << " wrong skewness "
+      << stats.Skewness << " expected 0")
+    return -1;
+    }
+
+  if (std::fabs(stats.Kurtosis - kurt) > 1.0e-9)
+    {
+    SENSEI_ERROR("Component " << stats.Component << " wrong kurtosis "
+      << stats.Kurtosis << " expected " << kurt)
+    return -1;
+    }
+
+  if ((stats.Min != minv) || (stats.Max != maxv))
+    {
+    SENSEI_ERROR("Component " << stats.Component << " wrong range ["
+      << stats.Min << ", " << stats.Max << "] expected [" << minv
+      << ", " << maxv << "]")
+    return -1;
+    }
+
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  // partition the sequence
+  long blockSize = gSequenceLen/nRanks;
+  long nLarge = gSequenceLen%nRanks;
+  long nLocal = blockSize + (rank < nLarge ? 1 : 0);
+  long start = rank*blockSize + (rank < nLarge ? rank : nLarge);
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetNumberOfComponents(2);
+  da->SetNumberOfTuples(nLocal);
+  da->SetName("uniform");
+  for (long i = 0; i < nLocal; ++i)
+    {
+    double val = start + i;
+    da->SetTypedComponent(i, 0, val);
+    da->SetTypedComponent(i, 1, 2.0*val + 1.0);
+    }
+
+  svtkImageData *im = svtkImageData::New();
+  im->SetDimensions(nLocal, 1, 1);
+  im->GetPointData()->AddArray(da);
+  da->Delete();
+
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetDataObject("mesh", im);
+  im->Delete();
+
+  sensei::DescriptiveStatistics *analysisAdaptor =
+    sensei::DescriptiveStatistics::New();
+
+  analysisAdaptor->AddDataRequirement("mesh", svtkDataObject::POINT,
+    std::vector<std::string>({"uniform"}));
+
+  analysisAdaptor->SetNumberOfThreads(2);
+
+  sensei::DataAdaptor *dataOut = nullptr;
+  analysisAdaptor->Execute(dataAdaptor, &dataOut);
+  dataAdaptor->Delete();
+
+  int status = 0;
+  if (!dataOut)
+    {
+    SENSEI_ERROR("No output data adaptor was returned")
+    status = -1;
+    }
+  else
+    {
+    dataOut->ReleaseData();
+    dataOut->Delete();
+    }
+
+  if (rank == 0)
+    {
+    std::vector<sensei::DescriptiveStatistics::Data> result;
+    analysisAdaptor->GetStatistics(result);
+
+    if (result.size() != 2)
+      {
+      SENSEI_ERROR("Wrong number of results " << result.size())
+      status = -1;
+      }
+    else if (validate(result[0], 1.0, 0.0) || validate(result[1], 2.0, 1.0))
+      {
+      status = -1;
+      }
+    }
+
+  analysisAdaptor->Finalize();
+  analysisAdaptor->Delete();
+
+  MPI_Finalize();
+
+  return status;
+}
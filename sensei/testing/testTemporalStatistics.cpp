@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <svtkDataArray.h>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkMultiBlockDataSet.h>
+#include <svtkPointData.h>
+#include "Error.h"
+#include "SVTKDataAdaptor.h"
+#include "SVTKUtils.h"
+#include "TemporalStatistics.h"
+#include "TestUtils.h"
+
+// the number of points in each of the two blocks on a rank
+const int gBlockSize[2] = {37, 5000};
+
+// the value of component j at point i and step s. the second component has
+// a large offset relative to its variation.
+double value(long i, int j, int s)
+{
+  return j ? 1.0e4 + 0.5*std::sin(0.3*i + 0.11*s) :
+    std::sin(0.1*i + 0.7*s) + 0.01*s;
+}
+
+// a multiblock with two image blocks per rank
+svtkMultiBlockDataSet *newMesh(int rank, int nRanks, int step)
+{
+  return sensei::TestUtils::NewTwoBlocksPerRank(rank, nRanks,
+    [&](int block) -> svtkDataObject*
+    {
+    int b = block % 2;
+
+    svtkImageData *im = svtkImageData::New();
+    im->SetDimensions(gBlockSize[b], 1, 1);
+
+    svtkDoubleArray *da = svtkDoubleArray::New();
+    da->SetName("data");
+    da->SetNumberOfComponents(2);
+    da->SetNumberOfTuples(gBlockSize[b]);
+    for (long i = 0; i < gBlockSize[b]; ++i)
+      for (int j = 0; j < 2; ++j)
+        da->SetTypedComponent(i, j, value(i, j, step));
+
+    im->GetPointData()->AddArray(da);
+    da->Delete();
+
+    return im;
+    });
+}
+
+// the exact statistics of the steps [s0, s1] of one value
+struct Reference
+{
+  Reference(long i, int j, int s0, int s1, double decay)
+  {
+    this->Min = std::numeric_limits<double>::max();
+    this->Max = std::numeric_limits<double>::lowest();
+
+    double sum = 0.0;
+    for (int s = s0; s <= s1; ++s)
+      {
+      double x = value(i, j, s);
+      sum += x;
+      this->Min = std::min(this->Min, x);
+      this->Max = std::max(this->Max, x);
+      }
+
+    double n = s1 - s0 + 1;
+    this->Mean = sum / n;
+
+    this->Variance = 0.0;
+    for (int s = s0; s <= s1; ++s)
+      {
+      double d = value(i, j, s) - this->Mean;
+      this->Variance += d*d;
+      }
+    this->Variance = n > 1.0 ? this->Variance / (n - 1.0) : 0.0;
+
+    if (decay > 0.0)
+      {
+      this->Mean = value(i, j, s0);
+      this->Variance = 0.0;
+      for (int s = s0 + 1; s <= s1; ++s)
+        {
+        double d = value(i, j, s) - this->Mean;
+        this->Mean += decay*d;
+        this->Variance = (1.0 - decay)*(this->Variance + decay*d*d);
+        }
+      }
+  }
+
+  double Mean;
+  double Min;
+  double Max;
+  double Variance;
+};
+
+// compare the statistics returned for steps [s0, s1] to the exact values
+// using a relative tolerance for each component. the largest error in the
+// mean of each component is accumulated in meanErr
+int validate(const char *label, sensei::DataAdaptor *dataOut, int s0, int s1,
+  double decay, const double *tol, double *meanErr)
+{
+  svtkDataObject *dobj = nullptr;
+  if (dataOut->GetMesh("mesh", false, dobj))
+    {
+    SENSEI_ERROR(<< label << " has no mesh")
+    return -1;
+    }
+
+  const char *names[] = {"data_mean", "data_min", "data_max", "data_variance"};
+  for (int q = 0; q < 4; ++q)
+    {
+    if (dataOut->AddArray(dobj, "mesh", svtkDataObject::POINT, names[q]))
+      {
+      SENSEI_ERROR(<< label << " has no array " << names[q])
+      dobj->Delete();
+      return -1;
+      }
+    }
+
+  std::vector<svtkDataSet*> blocks;
+  sensei::SVTKUtils::GetLeaves(dobj, blocks);
+
+  int status = 0;
+  for (size_t b = 0; (b < blocks.size()) && !status; ++b)
+    {
+    svtkDataArray *arrays[4];
+    for (int q = 0; q < 4; ++q)
+      arrays[q] = blocks[b]->GetPointData()->GetArray(names[q]);
+
+    for (long i = 0; (i < gBlockSize[b]) && !status; ++i)
+      {
+      for (int j = 0; j < 2; ++j)
+        {
+        Reference ref(i, j, s0, s1, decay);
+        double expected[4] = {ref.Mean, ref.Min, ref.Max, ref.Variance};
+
+        meanErr[j] = std::max(meanErr[j],
+          std::abs(arrays[0]->GetComponent(i, j) - ref.Mean));
+
+        for (int q = 0; q < 4; ++q)
+          {
+          double actual = arrays[q]->GetComponent(i, j);
+          double scale = std::max(1.0e-2, std::abs(expected[q]));
+          if (std::abs(actual - expected[q]) > tol[j]*scale)
+            {
+            SENSEI_ERROR(<< label << " block " << b << " point " << i
+              << " component " << j << " " << names[q] << " is " << actual
+              << " expected " << expected[q])
+            status = -1;
+            }
+          }
+        }
+      }
+    }
+
+  dobj->Delete();
+
+  return status;
+}
+
+// run the analysis over steps [0, nSteps) and validate the outputs
+int run(const char *label, int rank, int nRanks, int nSteps, int interval,
+  int reset, double decay, int compensated, const double *tol, double *meanErr)
+{
+  sensei::TemporalStatistics *stats = sensei::TemporalStatistics::New();
+  stats->SetCommunicator(MPI_COMM_WORLD);
+  stats->AddDataRequirement("mesh", svtkDataObject::POINT,
+    std::vector<std::string>({"data"}));
+  stats->SetInterval(interval);
+  stats->SetReset(reset);
+  stats->SetDecay(decay);
+  stats->SetCompensated(compensated);
+  stats->SetNumberOfThreads(2);
+
+  int status = 0;
+  int nOutputs = 0;
+  meanErr[0] = meanErr[1] = 0.0;
+  for (int step = 0; step < nSteps; ++step)
+    {
+    svtkMultiBlockDataSet *mb = newMesh(rank, nRanks, step);
+
+    sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+    dataAdaptor->SetCommunicator(MPI_COMM_WORLD);
+    dataAdaptor->SetDataObject("mesh", mb);
+    dataAdaptor->SetDataTimeStep(step);
+    mb->Delete();
+
+    sensei::DataAdaptor *dataOut = nullptr;
+    if (!stats->Execute(dataAdaptor, &dataOut))
+      {
+      SENSEI_ERROR(<< label << " failed at step " << step)
+      MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+
+    // output is produced only at the end of each interval
+    bool expectOutput = (step + 1) % interval == 0;
+    if (bool(dataOut) != expectOutput)
+      {
+      SENSEI_ERROR(<< label << " output at step " << step << " is "
+        << (dataOut ? "present" : "missing"))
+      status = -1;
+      }
+
+    if (dataOut)
+      {
+      int s0 = reset ? step + 1 - interval : 0;
+      status |= validate(label, dataOut, s0, step, decay, tol, meanErr);
+      dataOut->ReleaseData();
+      dataOut->Delete();
+      ++nOutputs;
+      }
+
+    dataAdaptor->ReleaseData();
+    dataAdaptor->Delete();
+    }
+
+  stats->Finalize();
+  stats->Delete();
+
+  if (rank == 0)
+    std::cerr << label << " " << nOutputs << " outputs, largest difference in the mean "
+      << meanErr[0] << ", " << meanErr[1] << std::endl;
+
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  int status = 0;
+  double meanErr[2] = {0.0};
+
+  // the offset second component loses precision when the state is held in
+  // floats, unless the updates are compensated
+  const double tol[2] = {1.0e-5, 1.0e-1};
+  const double compTol[2] = {1.0e-5, 1.0e-4};
+
+  // windows of 4 steps
+  status |= run("windowed", rank, nRanks, 12, 4, 1, 0.0, 0, tol, meanErr);
+  status |= run("windowed compensated", rank, nRanks, 12, 4, 1, 0.0, 1,
+    compTol, meanErr);
+
+  // exponentially weighted over the whole run
+  status |= run("weighted", rank, nRanks, 15, 5, 0, 0.25, 0, tol, meanErr);
+  status |= run("weighted compensated", rank, nRanks, 15, 5, 0, 0.25, 1,
+    compTol, meanErr);
+
+  // a long run accumulates round off in the mean of the offset component,
+  // which the compensated update keeps near the precision of a float
+  double plainErr[2] = {0.0};
+  status |= run("uncompensated", rank, nRanks, 2000, 2000, 1, 0.0, 0, tol,
+    plainErr);
+
+  status |= run("compensated", rank, nRanks, 2000, 2000, 1, 0.0, 1, compTol,
+    meanErr);
+
+  if ((meanErr[1] > 1.0e-3) || (meanErr[1] > plainErr[1]))
+    {
+    SENSEI_ERROR("Compensated mean error " << meanErr[1]
+      << " uncompensated " << plainErr[1])
+    status = -1;
+    }
+
+  if (!status && (rank == 0))
+    std::cerr << "TemporalStatistics passed" << std::endl;
+
+  MPI_Finalize();
+
+  return status ? -1 : 0;
+}
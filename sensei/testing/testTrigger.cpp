@@ -0,0 +1,183 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include <pugixml.hpp>
+#include <svtkDoubleArray.h>
+#include <svtkImageData.h>
+#include <svtkPointData.h>
+#include "ConfigurableAnalysis.h"
+#include "Error.h"
+#include "SVTKDataAdaptor.h"
+#include "Trigger.h"
+
+// the array is scaled by these factors in successive time steps. the
+// global maximum of the array is the scale factor and the norm is
+// proportional to it.
+std::vector<double> gScale = {1.0, 1.01, 1.5, 1.52, 3.0, 3.0};
+
+// the expected results
+std::vector<int> gRangeFires = {0, 0, 0, 0, 1, 1};
+std::vector<int> gCrossFires = {0, 0, 0, 0, 1, 0};
+std::vector<int> gNormFires = {1, 0, 1, 0, 1, 0};
+std::vector<int> gIntervalFires = {1, 0, 0, 1, 0, 0};
+
+unsigned int gSequenceLen = 1001;
+
+sensei::SVTKDataAdaptor *newDataAdaptor(int rank, int nRanks, long step)
+{
+  // partition the sequence
+  long blockSize = gSequenceLen/nRanks;
+  long nLarge = gSequenceLen%nRanks;
+  long nLocal = blockSize + (rank < nLarge ? 1 : 0);
+  long start = rank*blockSize + (rank < nLarge ? rank : nLarge);
+
+  double scale = gScale[step];
+
+  svtkDoubleArray *da = svtkDoubleArray::New();
+  da->SetNumberOfTuples(nLocal);
+  da->SetName("data");
+  for (long i = 0; i < nLocal; ++i)
+    da->SetValue(i, scale*(start + i + 1)/gSequenceLen);
+
+  svtkImageData *im = svtkImageData::New();
+  im->SetDimensions(nLocal, 1, 1);
+  im->GetPointData()->AddArray(da);
+  da->Delete();
+
+  sensei::SVTKDataAdaptor *dataAdaptor = sensei::SVTKDataAdaptor::New();
+  dataAdaptor->SetDataObject("mesh", im);
+  dataAdaptor->SetDataTimeStep(step);
+  dataAdaptor->SetDataTime(0.1*step);
+  im->Delete();
+
+  return dataAdaptor;
+}
+
+const char *gConfig =
+  "<sensei>"
+  "  <trigger name=\"big\" type=\"range\" mesh=\"mesh\" array=\"data\""
+  "    association=\"point\" above=\"2.0\" />"
+  "  <trigger name=\"cross\" type=\"range\" mesh=\"mesh\" array=\"data\""
+  "    association=\"point\" above=\"2.0\" on_crossing=\"1\" />"
+  "  <trigger name=\"change\" type=\"norm_change\" mesh=\"mesh\""
+  "    array=\"data\" association=\"point\" threshold=\"0.1\" />"
+  "  <trigger name=\"every\" type=\"interval\" interval=\"0.25\" />"
+  "  <analysis type=\"statistics\" file=\"testTrigger.csv\""
+  "    trigger=\"change\" enabled=\"1\">"
+  "    <mesh name=\"mesh\">"
+  "      <point_arrays> data </point_arrays>"
+  "    </mesh>"
+  "  </analysis>"
+  "</sensei>";
+
+int main(int argc, char **argv)
+{
+  MPI_Init(&argc, &argv);
+
+  int rank = 0;
+  int nRanks = 1;
+
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nRanks);
+
+  pugi::xml_document doc;
+  if (!doc.load_string(gConfig))
+    {
+    SENSEI_ERROR("Failed to parse the configuration")
+    MPI_Abort(MPI_COMM_WORLD, -1);
+    }
+
+  pugi::xml_node root = doc.child("sensei");
+
+  // evaluate each of the triggers directly
+  std::vector<sensei::Trigger*> triggers;
+  for (pugi::xml_node node = root.child("trigger");
+    node; node = node.next_sibling("trigger"))
+    {
+    sensei::Trigger *trigger = new sensei::Trigger;
+    if (trigger->Initialize(node))
+      {
+      SENSEI_ERROR("Failed to initialize trigger")
+      MPI_Abort(MPI_COMM_WORLD, -1);
+      }
+    triggers.push_back(trigger);
+    }
+
+  std::vector<std::vector<int>> expected = {gRangeFires, gCrossFires,
+    gNormFires, gIntervalFires};
+
+  // the statistics are only computed when the "change" trigger fires
+  sensei::ConfigurableAnalysis *analysis = sensei::ConfigurableAnalysis::New();
+  analysis->SetCommunicator(MPI_COMM_WORLD);
+  analysis->Initialize(root);
+
+  int status = 0;
+  long nSteps = gScale.size();
+  for (long step = 0; step < nSteps; ++step)
+    {
+    sensei::SVTKDataAdaptor *dataAdaptor = newDataAdaptor(rank, nRanks, step);
+
+    for (size_t i = 0; i < triggers.size(); ++i)
+      {
+      bool fire = false;
+      if (triggers[i]->Evaluate(MPI_COMM_WORLD, dataAdaptor, fire))
+        {
+        SENSEI_ERROR("Failed to evaluate trigger " << triggers[i]->GetName())
+        status = -1;
+        }
+      else if (fire != bool(expected[i][step]))
+        {
+        SENSEI_ERROR("Trigger " << triggers[i]->GetName() << " step " << step
+          << (fire ? " fired" : " did not fire") << " value "
+          << triggers[i]->GetLastValue())
+        status = -1;
+        }
+      }
+
+    analysis->Execute(dataAdaptor, nullptr);
+
+    dataAdaptor->ReleaseData();
+    dataAdaptor->Delete();
+    }
+
+  analysis->Finalize();
+  analysis->Delete();
+
+  for (size_t i = 0; i < triggers.size(); ++i)
+    delete triggers[i];
+
+  // check that the statistics were computed on the expected steps
+  if (rank == 0)
+    {
+    std::vector<long> steps;
+    std::ifstream ifs("testTrigger.csv");
+    std::string line;
+    while (std::getline(ifs, line))
+      {
+      if (line.empty() || (line[0] == '#'))
+        continue;
+      steps.push_back(std::stol(line));
+      }
+
+    std::vector<long> expectedSteps;
+    for (long step = 0; step < nSteps; ++step)
+      if (gNormFires[step])
+        expectedSteps.push_back(step);
+
+    if (steps != expectedSteps)
+      {
+      SENSEI_ERROR("The analysis ran on " << steps.size()
+        << " steps but the trigger fired on " << expectedSteps.size())
+      status = -1;
+      }
+
+    remove("testTrigger.csv");
+    }
+
+  MPI_Finalize();
+
+  return status;
+}